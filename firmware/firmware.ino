@@ -4,16 +4,22 @@
 #include "src/hal/camera_pins.h"
 #include "src/features/microphone/mulaw.h"
 #include "src/system/clock/timing.h"
+#include "src/system/clock/timer_service.h"
+#include "src/system/clock/profiler.h"
 #include "src/system/power_management/power_management.h"
+#include "src/system/power_management/duty_cycle_capture.h"
+#include "src/system/power_management/retained_state.h"
 #include "src/system/memory/memory_utils.h"
 // #include "src/utils/hotspot_manager.h"  // DISABLED: Causes BLE interference
 #include "src/system/cycles/cycle_manager.h"
 #include "src/system/cycles/specialized_cycles.h"
+#include "src/system/cycles/loop_watchdog.h"
 #include "src/hal/led/led_manager.h"
 #include "src/system/battery/battery_code.h"
 // #include "src/system/charging/charging_manager.h"  // DISABLED: Compilation issues
 #include "src/hal/constants.h"
 #include "src/status/device_status.h"
+#include "src/status/device_lifecycle.h"
 #include "src/features/camera/camera.h"
 #include "src/features/bluetooth/ble_manager.h"
 #include "src/features/microphone/microphone_manager.h"
@@ -60,12 +66,23 @@ void setup() {
   SerialSystem::initialize();
   SerialSystem::info("OpenGlass starting up...", MODULE_MAIN);
   
+  // Check for a warm boot before anything else is initialized
+  RetainedState::begin();
+  
+  // Calibrate the profiler before any profiled scope runs
+  Profiler::begin();
+  
   // Initialize LED manager first for early status indication
   initLedManager();
   
   // Print wake-up reason
   SerialSystem::infof(MODULE_MAIN, "Wake-up reason: %s", getWakeupReason());
-  
+
+#ifdef DUTY_CYCLE_CAPTURE_ENABLED
+  // Capture-only wakes take their photo and go back to sleep here
+  DutyCycleCapture::resumeFromWake();
+#endif
+
   // Initialize power management
   initializePowerManagement();
   
@@ -81,6 +98,12 @@ void setup() {
   // Initialize centralized cycle manager
   initializeCycleManager();
   
+  // Report updateCycles() passes that block (from the other core)
+  LoopWatchdog::begin();
+  
+  // Control writes queue up from here and run once setup() has finished
+  DeviceLifecycle::begin();
+  
   updateDeviceStatus(DEVICE_STATUS_BLE_INIT);
   configureBLE();
   SerialSystem::logInitialization("BLE", true, MODULE_BLE);
@@ -92,7 +115,7 @@ void setup() {
     while (1); // do nothing
   }
   
-  if (!MicrophoneManager::configure()) {
+  if (!MicrophoneManager::configure(RetainedState::isWarmBoot())) {
     SerialSystem::logError("Microphone", "Configuration failed", MODULE_MICROPHONE);
     updateDeviceStatus(DEVICE_STATUS_ERROR);
     while (1); // do nothing
@@ -100,12 +123,18 @@ void setup() {
   SerialSystem::logInitialization("Microphone", true, MODULE_MICROPHONE);
   
   updateDeviceStatus(DEVICE_STATUS_CAMERA_INIT);
-  configure_camera();
+  // Warm boots reuse the retained preset instead of probing the fallback list
+  bool fastCamera = RetainedState::isWarmBoot() &&
+                    configure_camera_preset(RetainedState::getCameraConfigIndex());
+  if (!fastCamera) {
+    configure_camera();
+  }
   SerialSystem::logInitialization("Camera", true, MODULE_CAMERA);
   
-  // Test camera functionality
-  SerialSystem::info("Testing camera functionality...", MODULE_CAMERA);
-  if (take_photo()) {
+  // Test camera functionality (already proven on warm boots)
+  if (fastCamera) {
+    SerialSystem::info("Warm boot: skipping camera test", MODULE_CAMERA);
+  } else if (take_photo()) {
     SerialSystem::logPhotoCapture(fb->len, "test");
     if (fb) {
       esp_camera_fb_return(fb);
@@ -127,11 +156,13 @@ void setup() {
     SerialSystem::info("Battery detected and connected", MODULE_BATTERY);
   }
   
-  updateDeviceStatus(DEVICE_STATUS_WARMING_UP);
-  SerialSystem::info("Device warming up...", MODULE_MAIN);
-  delay(TIMING_LONG); // Give camera and microphone time to stabilize
+  if (!RetainedState::isWarmBoot()) {
+    updateDeviceStatus(DEVICE_STATUS_WARMING_UP);
+    SerialSystem::info("Device warming up...", MODULE_MAIN);
+    delay(TIMING_LONG); // Give camera and microphone time to stabilize
+  }
   
-  deviceReady = true;
+  DeviceLifecycle::dispatch(LIFECYCLE_EVENT_BOOT_DONE);
   updateDeviceStatus(DEVICE_STATUS_READY);
   SerialSystem::info("OpenGlass ready!", MODULE_MAIN);
   
@@ -139,28 +170,34 @@ void setup() {
   initializeSpecializedCycles();
   
   SerialSystem::logInitialization("Specialized Cycle Managers", true, MODULE_CYCLES);
+  
+  // Continue cycle schedules, counters and photo capture from before sleep
+  RetainedState::restore();
 }
 
 void loop() {
   // Performance monitoring
   static unsigned long loopCount = 0;
-  static unsigned long lastPerformanceReport = 0;
-  static unsigned long totalLoopTime = 0;
-  static unsigned long maxLoopTime = 0;
+  static timer_handle_t performanceReportTimer = TimerService::createPeriodic("LoopPerformance", PROFILER_REPORT_INTERVAL_MS);
+  static uint64_t totalLoopTime = 0;
+  static uint32_t maxLoopTime = 0;
+  
+  uint32_t loopStart = profilerTicks();
   
-  unsigned long loopStart = measureStart();
+  // Fire due software timers (log throttles, delays)
+  TimerService::update();
   
   // Update all cycles using centralized cycle manager
   updateCycles();
   
   // Handle connection loss during photo/video upload
-  if (photoDataUploading && !isConnected()) {
+  if (DeviceLifecycle::isIn(LIFECYCLE_UPLOADING) && !isConnected()) {
     SerialSystem::warning("Connection lost during photo/video upload, stopping", MODULE_BLE);
-    photoDataUploading = false;
+    DeviceLifecycle::dispatch(LIFECYCLE_EVENT_DISCONNECTED);
   }
   
-  // Calculate loop performance
-  unsigned long loopDuration = measureEnd(loopStart);
+  // Calculate loop performance (cycle counter ticks)
+  uint32_t loopDuration = profilerTicks() - loopStart;
   totalLoopTime += loopDuration;
   if (loopDuration > maxLoopTime) {
     maxLoopTime = loopDuration;
@@ -168,10 +205,16 @@ void loop() {
   loopCount++;
   
   // Report performance every 30 seconds
-  if (shouldExecute(&lastPerformanceReport, 30000)) {
-    float avgLoopTime = (float)totalLoopTime / loopCount;
-    SerialSystem::infof(MODULE_SYSTEM, "🔧 Loop Performance: Avg=%.2fms, Max=%lums, Count=%lu", 
-                       avgLoopTime, maxLoopTime, loopCount);
+  if (TimerService::consume(performanceReportTimer)) {
+    float avgLoopTime = Profiler::ticksToUs((uint32_t)(totalLoopTime / loopCount)) / 1000.0;
+    SerialSystem::infof(MODULE_SYSTEM, "🔧 Loop Performance: Avg=%.3fms, Max=%.3fms, Count=%lu", 
+                       avgLoopTime, Profiler::ticksToUs(maxLoopTime) / 1000.0, loopCount);
+    if (LoopWatchdog::getStallCount() > 0) {
+      LoopWatchdog::printStats();
+    }
+#ifdef PROFILER_ENABLED
+    Profiler::printReport(true);
+#endif
     
     // Reset counters
     totalLoopTime = 0;
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "ble_transport.h"
+
+// ===================================================================
+// BLE BACKEND
+// ===================================================================
+//
+// What a BLE stack provides to ble_transport.cpp. Exactly one backend is
+// compiled in (BLE_BACKEND). Handles are assigned by the transport in
+// creation order, so a backend keeps its stack objects in arrays indexed
+// by them; UUIDs and handles have been checked before they get here.
+//
+
+namespace BleBackend {
+    /** Name in the report */
+    const char* name();
+
+    bool begin(const char* name, uint16_t mtu);
+    bool createService(ble_handle_t service, const char* uuid);
+    bool createCharacteristic(ble_handle_t characteristic, ble_handle_t service, const char* uuid,
+                              uint8_t properties);
+    bool startServices();
+
+    /**
+     * @param uuids Services to advertise, in the order they were asked for
+     */
+    void startAdvertising(const char* const* uuids, size_t count);
+    void stopAdvertising();
+
+    void setValue(ble_handle_t characteristic, const uint8_t* data, size_t length);
+
+    /**
+     * Set the value and notify it (only called while connected)
+     * @return false if the stack turned it down
+     */
+    bool notify(ble_handle_t characteristic, const uint8_t* data, size_t length);
+
+    uint16_t peerMtu();
+    void requestConnParams(uint16_t interval, uint16_t latency, uint16_t timeout);
+}
+
+// Events from the backend (BLE host task)
+namespace BleTransport {
+    void onConnected(const ble_connection_t* connection);
+    void onDisconnected();
+    void onWritten(ble_handle_t characteristic, const uint8_t* data, size_t length);
+}
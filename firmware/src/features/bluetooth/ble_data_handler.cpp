@@ -5,6 +5,7 @@
 #include "../microphone/opus_codec.h"
 #endif
 #include "../../system/memory/memory_utils.h"
+#include "../../system/clock/profiler.h"
 // #include "../../utils/hotspot_manager.h"  // DISABLED: Causes BLE interference
 #include "../camera/camera.h"
 
@@ -12,7 +13,9 @@
 uint16_t audioFrameCount = 0;
 
 void transmitAudioData(uint8_t *audioBuffer, size_t bufferSize, size_t bytesRecorded) {
+    (void)bufferSize;
     if (!bleConnected || bytesRecorded == 0) return;
+    PROFILE_SCOPE("audio_transmit");
     
     // Allocate compressed frame buffer
     static uint8_t *compressedFrame = nullptr;
@@ -29,14 +32,12 @@ void transmitAudioData(uint8_t *audioBuffer, size_t bufferSize, size_t bytesReco
     
     if (encodedBytes > 0) {
         // Add frame header
-        compressedFrame[0] = audioFrameCount & 0xFF;
-        compressedFrame[1] = (audioFrameCount >> 8) & 0xFF;
-        compressedFrame[2] = 0; // Frame type
+        bleWriteFrameHeader(compressedFrame, audioFrameCount, BLE_FRAME_TYPE_AUDIO);
         
-        size_t totalSize = encodedBytes + 3;
+        size_t totalSize = encodedBytes + BLE_FRAME_HEADER_SIZE;
         
         // For large frames, we need to split them into smaller chunks for BLE transmission
-        const size_t MAX_BLE_CHUNK = 400; // Stay well under MTU limit
+        const size_t MAX_BLE_CHUNK = AUDIO_BLE_CHUNK_SIZE;
         
         if (totalSize <= MAX_BLE_CHUNK) {
             // Small frame - send directly
@@ -47,17 +48,14 @@ void transmitAudioData(uint8_t *audioBuffer, size_t bufferSize, size_t bytesReco
             uint8_t chunkIndex = 0;
             
             while (offset < totalSize) {
-                size_t chunkSize = min(MAX_BLE_CHUNK - 4, totalSize - offset); // Leave room for chunk header
+                size_t chunkSize = min(MAX_BLE_CHUNK - BLE_AUDIO_CHUNK_HEADER_SIZE, totalSize - offset); // Leave room for chunk header
                 
                 // Create chunk with header: [frameCount_low, frameCount_high, chunkIndex, chunkType, ...data]
                 uint8_t chunkBuffer[MAX_BLE_CHUNK];
-                chunkBuffer[0] = audioFrameCount & 0xFF;
-                chunkBuffer[1] = (audioFrameCount >> 8) & 0xFF;
-                chunkBuffer[2] = chunkIndex;
-                chunkBuffer[3] = (offset + chunkSize >= totalSize) ? 0x80 : 0x00; // 0x80 = last chunk
+                bleWriteAudioChunkHeader(chunkBuffer, audioFrameCount, chunkIndex, offset + chunkSize >= totalSize);
                 
-                memcpy(&chunkBuffer[4], &compressedFrame[offset], chunkSize);
-                notifyAudioData(chunkBuffer, chunkSize + 4);
+                memcpy(&chunkBuffer[BLE_AUDIO_CHUNK_HEADER_SIZE], &compressedFrame[offset], chunkSize);
+                notifyAudioData(chunkBuffer, chunkSize + BLE_AUDIO_CHUNK_HEADER_SIZE);
                 
                 offset += chunkSize;
                 chunkIndex++;
@@ -70,6 +68,7 @@ void transmitAudioData(uint8_t *audioBuffer, size_t bufferSize, size_t bytesReco
 
 void prepareAudioFrame(uint8_t *compressedFrame, uint8_t *audioBuffer, size_t bytesRecorded, int &encodedBytes) {
     encodedBytes = 0;
+    PROFILE_SCOPE("audio_encode");
     
     // Apply audio filters to the raw audio data before encoding
     int16_t* audio_samples = (int16_t*)audioBuffer;
@@ -120,6 +119,7 @@ void prepareAudioFrame(uint8_t *compressedFrame, uint8_t *audioBuffer, size_t by
 }
 
 void transmitPhotoData(uint8_t *frameBuffer, size_t frameSize, uint16_t frameNumber, bool isStreamingFrame) {
+    (void)frameNumber;  // The headers already carry it
     if (!bleConnected || !frameBuffer || frameSize == 0) return;
     
     // Frame buffer already contains headers and data from main firmware
@@ -138,16 +138,13 @@ void transmitVideoData(uint8_t *frameBuffer, size_t frameSize, uint16_t frameNum
 void transmitEndMarker(bool isStreamingFrame) {
     if (!bleConnected) return;
     
-    uint8_t endMarker[3] = {
-        PHOTO_END_MARKER_LOW,
-        PHOTO_END_MARKER_HIGH,
-        isStreamingFrame ? 0x02 : 0x01
-    };
+    uint8_t endMarker[BLE_FRAME_HEADER_SIZE];
+    bleWriteEndMarker(endMarker, isStreamingFrame ? BLE_FRAME_TYPE_VIDEO : BLE_FRAME_TYPE_PHOTO);
     
     if (isStreamingFrame) {
-        notifyVideoData(endMarker, 3);
+        notifyVideoData(endMarker, sizeof(endMarker));
     } else {
-        notifyPhotoData(endMarker, 3);
+        notifyPhotoData(endMarker, sizeof(endMarker));
     }
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <Arduino.h>
+#include "ble_frame_format.h"
 #include "characteristics/ble_characteristics.h"
 #include "callbacks/callbacks.h"
 #include "../../hal/constants.h"
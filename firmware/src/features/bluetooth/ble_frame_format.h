@@ -0,0 +1,202 @@
+#ifndef BLE_FRAME_FORMAT_H
+#define BLE_FRAME_FORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ===================================================================
+// BLE FRAME FORMAT
+// ===================================================================
+//
+// Wire format of the audio, photo and video notifications. The host
+// stream decoder (public/host/stream) includes this header, so keep it
+// free of Arduino/ESP-IDF dependencies.
+//
+// Photo / video (one image is a run of chunks, index restarts at 0):
+//
+//   [index_lo, index_hi, type] + up to PHOTO_CHUNK_SIZE bytes of JPEG
+//   [0xFF, 0xFF, type]                                   end of image
+//
+// Block video frames (BLE_FRAME_TYPE_BLOCKS, on the video characteristic)
+// are chunked the same way; their payload is described in
+// features/camera/block_codec.h.
+//
+// Photo start header (PHOTO_START_HEADER), before the first chunk:
+//
+//   [0xFE, 0xFF, 0x01] + [flags, hash (8 bytes), length (4 bytes)]
+//
+// hash is the photo's 64-bit perceptual hash (features/camera/photo_hash.h,
+// valid if flags & BLE_PHOTO_START_HASH) and length the bytes its chunks
+// will carry, both little endian. A client that already holds a photo
+// within a few bits of the hash can write PHOTO_SKIP_UPLOAD to photo
+// control; the chunks then stop without an end marker. The other flags
+// carry the quality gate's verdict (features/camera/photo_quality.h).
+//
+// A code scan (PHOTO_SCAN_CODE) that finds a code sends, in place of the
+// photo, a BLE_FRAME_TYPE_CODE image on the photo characteristic:
+//
+//   [symbology] + decoded text          (CODE_SYMBOLOGY_*, code_scanner.h)
+//
+// Audio (frame counter wraps at 16 bits):
+//
+//   [frame_lo, frame_hi, 0x00] + encoded frame
+//
+// Frames longer than AUDIO_BLE_CHUNK_SIZE are split. Every chunk carries
+// a 4-byte header and a slice of the whole frame, 3-byte header included:
+//
+//   [frame_lo, frame_hi, chunk_index, flags] + slice
+//
+// chunk_index 0 therefore looks like an unsplit frame at the header; it
+// is told apart by the frame header repeated at the start of its slice.
+//
+// Compact images (JPEG_HEADER_COMPACTION, see features/camera/jpeg_header.h).
+// The JPEG headers (SOI up to the end of SOS) are the same in every image of
+// a stream. After one whole image the device may send only
+//
+//   [0xFF, 0x00, id0, id1, id2, id3] + entropy-coded data through EOI
+//
+// where id is the table ID (little endian) of the header left out. Clients
+// cache the header of each whole image under its ID and put it back. A
+// JPEG always starts with FF D8, and FF 00 never starts a marker, so the
+// two cannot be confused. The chunking above is unchanged.
+//
+
+#define BLE_FRAME_HEADER_SIZE 3
+#define BLE_AUDIO_CHUNK_HEADER_SIZE 4
+
+// Frame types (third header byte)
+#define BLE_FRAME_TYPE_AUDIO 0x00
+#define BLE_FRAME_TYPE_PHOTO 0x01
+#define BLE_FRAME_TYPE_VIDEO 0x02
+#define BLE_FRAME_TYPE_BLOCKS 0x03
+#define BLE_FRAME_TYPE_CODE 0x04
+
+// End of image marker (in place of the chunk index)
+#define PHOTO_END_MARKER_LOW 0xFF
+#define PHOTO_END_MARKER_HIGH 0xFF
+
+// Photo start header (in place of the chunk index)
+#define PHOTO_START_MARKER_LOW 0xFE
+#define PHOTO_START_MARKER_HIGH 0xFF
+#define BLE_PHOTO_START_SIZE (BLE_FRAME_HEADER_SIZE + 13)
+#define BLE_PHOTO_START_HASH 0x01       // Flags: the hash is valid
+#define BLE_PHOTO_START_SCORED 0x02     // The quality gate scored the photo (PHOTO_QUALITY_POLICY)
+#define BLE_PHOTO_START_BLURRY 0x04     // ... and found it blurred
+#define BLE_PHOTO_START_DARK 0x08       // ... underexposed
+#define BLE_PHOTO_START_BRIGHT 0x10     // ... overexposed
+
+// Audio chunk flags
+#define BLE_AUDIO_CHUNK_LAST 0x80
+
+// Compact image prefix
+#define BLE_JPEG_COMPACT_MARKER_0 0xFF
+#define BLE_JPEG_COMPACT_MARKER_1 0x00
+#define BLE_JPEG_COMPACT_PREFIX_SIZE 6
+
+/**
+ * Write a [index_lo, index_hi, type] frame header
+ */
+static inline void bleWriteFrameHeader(uint8_t* buffer, uint16_t index, uint8_t type) {
+    buffer[0] = index & 0xFF;
+    buffer[1] = (index >> 8) & 0xFF;
+    buffer[2] = type;
+}
+
+/**
+ * Write the end of image marker
+ */
+static inline void bleWriteEndMarker(uint8_t* buffer, uint8_t type) {
+    buffer[0] = PHOTO_END_MARKER_LOW;
+    buffer[1] = PHOTO_END_MARKER_HIGH;
+    buffer[2] = type;
+}
+
+/**
+ * Write a photo start header (BLE_PHOTO_START_SIZE bytes)
+ */
+static inline void bleWritePhotoStart(uint8_t* buffer, uint8_t type, uint8_t flags, uint64_t hash, uint32_t length) {
+    buffer[0] = PHOTO_START_MARKER_LOW;
+    buffer[1] = PHOTO_START_MARKER_HIGH;
+    buffer[2] = type;
+    buffer[3] = flags;
+    for (int i = 0; i < 8; i++) buffer[4 + i] = (uint8_t)(hash >> (8 * i));
+    for (int i = 0; i < 4; i++) buffer[12 + i] = (uint8_t)(length >> (8 * i));
+}
+
+static inline bool bleIsPhotoStart(const uint8_t* data, size_t length) {
+    return length == BLE_PHOTO_START_SIZE &&
+           data[0] == PHOTO_START_MARKER_LOW && data[1] == PHOTO_START_MARKER_HIGH;
+}
+
+static inline uint64_t blePhotoStartHash(const uint8_t* data) {
+    uint64_t hash = 0;
+    for (int i = 7; i >= 0; i--) hash = (hash << 8) | data[4 + i];
+    return hash;
+}
+
+static inline uint32_t blePhotoStartLength(const uint8_t* data) {
+    return (uint32_t)data[12] | ((uint32_t)data[13] << 8) | ((uint32_t)data[14] << 16) | ((uint32_t)data[15] << 24);
+}
+
+/**
+ * Write a [frame_lo, frame_hi, chunk_index, flags] audio chunk header
+ */
+static inline void bleWriteAudioChunkHeader(uint8_t* buffer, uint16_t frame, uint8_t chunkIndex, bool last) {
+    buffer[0] = frame & 0xFF;
+    buffer[1] = (frame >> 8) & 0xFF;
+    buffer[2] = chunkIndex;
+    buffer[3] = last ? BLE_AUDIO_CHUNK_LAST : 0x00;
+}
+
+/**
+ * Chunk index / audio frame counter of a notification
+ */
+static inline uint16_t bleFrameIndex(const uint8_t* data) {
+    return data[0] | (data[1] << 8);
+}
+
+static inline bool bleIsEndMarker(const uint8_t* data, size_t length) {
+    return length == BLE_FRAME_HEADER_SIZE &&
+           data[0] == PHOTO_END_MARKER_LOW && data[1] == PHOTO_END_MARKER_HIGH;
+}
+
+/**
+ * Whether an audio notification is a chunk of a split frame (see above)
+ */
+static inline bool bleIsAudioChunk(const uint8_t* data, size_t length) {
+    if (length < BLE_AUDIO_CHUNK_HEADER_SIZE) return false;
+    if (data[2] != 0) return true;
+    return length >= BLE_AUDIO_CHUNK_HEADER_SIZE + BLE_FRAME_HEADER_SIZE &&
+           (data[3] & ~BLE_AUDIO_CHUNK_LAST) == 0 &&
+           data[4] == data[0] && data[5] == data[1] && data[6] == BLE_FRAME_TYPE_AUDIO;
+}
+
+/**
+ * Write the [0xFF, 0x00, id0..id3] compact image prefix
+ */
+static inline void bleWriteJpegCompactPrefix(uint8_t* buffer, uint32_t tableId) {
+    buffer[0] = BLE_JPEG_COMPACT_MARKER_0;
+    buffer[1] = BLE_JPEG_COMPACT_MARKER_1;
+    buffer[2] = tableId & 0xFF;
+    buffer[3] = (tableId >> 8) & 0xFF;
+    buffer[4] = (tableId >> 16) & 0xFF;
+    buffer[5] = (tableId >> 24) & 0xFF;
+}
+
+/**
+ * Whether a reassembled image is compact (starts with the prefix)
+ */
+static inline bool bleIsJpegCompact(const uint8_t* image, size_t length) {
+    return length >= BLE_JPEG_COMPACT_PREFIX_SIZE &&
+           image[0] == BLE_JPEG_COMPACT_MARKER_0 && image[1] == BLE_JPEG_COMPACT_MARKER_1;
+}
+
+/**
+ * Table ID of a compact image
+ */
+static inline uint32_t bleJpegCompactId(const uint8_t* image) {
+    return (uint32_t)image[2] | ((uint32_t)image[3] << 8) |
+           ((uint32_t)image[4] << 16) | ((uint32_t)image[5] << 24);
+}
+
+#endif // BLE_FRAME_FORMAT_H
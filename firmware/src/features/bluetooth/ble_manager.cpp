@@ -11,7 +11,6 @@ void BLEManager::initialize() {
     Serial.println("BLE Manager: Initializing...");
     
     // Initialize BLE components
-    initializeBLEUUIDs();
     initializeBLEServer();
     initializeBLECallbacks();
     initializeBLECharacteristics();
@@ -1,33 +1,26 @@
 #include "ble_server.h"
 #include "services/ble_services.h"
+#include "l2cap_channel.h"
 #include "../../status/device_status.h"
 #include "../../system/battery/battery_code.h"
 // #include "../../system/charging/charging_manager.h"  // DISABLED: Charging system removed
 
-// BLE Server instance
-BLEServer *bleServer = nullptr;
+// BLE server state
+static bool bleServerRunning = false;
+static bool advertisingConfigured = false;
 // BLE advertising state
 bool bleAdvertisingActive = false;
 
 // BLE Services
-BLEService *mainService = nullptr;
-BLEService *videoService = nullptr;
-BLEService *deviceInfoService = nullptr;
+ble_handle_t mainService = BLE_HANDLE_NONE;
+ble_handle_t videoService = BLE_HANDLE_NONE;
+ble_handle_t deviceInfoService = BLE_HANDLE_NONE;
 
 void initializeBLEServer() {
     Serial.println("Initializing BLE server...");
     
-    // Initialize BLE device
-    BLEDevice::init(BLE_DEVICE_NAME);
-    
-    // Create BLE server
-    bleServer = BLEDevice::createServer();
-    
-    // Set larger MTU for better throughput
-    BLEDevice::setMTU(BLE_MTU_SIZE);
-    
-    // Set server callbacks
-    bleServer->setCallbacks(new BLEServerHandler());
+    // Bring up the stack (BLE_BACKEND) with a larger MTU for better throughput
+    bleServerRunning = BleTransport::begin(BLE_DEVICE_NAME, BLE_MTU_SIZE, onBLEConnectionEvent);
     
     Serial.println("BLE server initialized");
 }
@@ -36,13 +29,13 @@ void configureBLEServer() {
     Serial.println("Configuring BLE services...");
     
     // Create main service
-    mainService = bleServer->createService(serviceUUID);
+    mainService = BleTransport::createService(SERVICE_UUID);
     
     // Create video service
-    videoService = bleServer->createService(videoServiceUUID);
+    videoService = BleTransport::createService(VIDEO_SERVICE_UUID);
     
     // Create device information service
-    deviceInfoService = bleServer->createService(DEVICE_INFORMATION_SERVICE_UUID);
+    deviceInfoService = BleTransport::createService(DEVICE_INFORMATION_SERVICE_UUID);
     
     // Create characteristics for each service
     createAudioCharacteristics(mainService);
@@ -55,10 +48,10 @@ void configureBLEServer() {
     setupDeviceStatusService(mainService);
     
     // Setup battery service
-    setupBatteryService(bleServer);
+    setupBatteryService();
     
     // Setup charging service
-    // setupChargingService(bleServer);  // DISABLED: Charging system removed
+    // setupChargingService();  // DISABLED: Charging system removed
     
     Serial.println("BLE services configured");
 }
@@ -66,21 +59,16 @@ void configureBLEServer() {
 void startBLEServices() {
     Serial.println("Starting BLE services...");
     
-    // Start all services
-    if (mainService) {
-        mainService->start();
-        Serial.println("Main service started");
+    // Start all services (the stack takes the whole table at once)
+    if (!BleTransport::startServices()) {
+        bleServerRunning = false;
+        return;
     }
     
-    if (videoService) {
-        videoService->start();
-        Serial.println("Video service started");
-    }
-    
-    if (deviceInfoService) {
-        deviceInfoService->start();
-        Serial.println("Device info service started");
-    }
+#ifdef L2CAP_BULK_CHANNEL
+    // Photos can leave GATT once a client asks (PHOTO_BULK_CHANNEL)
+    L2capChannel::initialize();
+#endif
     
     Serial.println("All BLE services started");
 }
@@ -88,41 +76,37 @@ void startBLEServices() {
 void startBLEAdvertising() {
     Serial.println("Starting BLE advertising...");
     
-    BLEAdvertising *advertising = BLEDevice::getAdvertising();
-    
-    // Add service UUIDs to advertising
-    advertising->addServiceUUID(BATTERY_SERVICE_UUID);
-    advertising->addServiceUUID(DEVICE_INFORMATION_SERVICE_UUID);
-    // advertising->addServiceUUID(CHARGING_SERVICE_UUID);  // DISABLED: Charging system removed
-    
-    if (mainService) {
-        advertising->addServiceUUID(mainService->getUUID());
+    // Add service UUIDs to advertising (once: a restart after a disconnect reuses them)
+    if (!advertisingConfigured) {
+        BleTransport::advertiseService(BATTERY_SERVICE_UUID);
+        BleTransport::advertiseService(DEVICE_INFORMATION_SERVICE_UUID);
+        // BleTransport::advertiseService(CHARGING_SERVICE_UUID);  // DISABLED: Charging system removed
+        
+        if (mainService != BLE_HANDLE_NONE) {
+            BleTransport::advertiseService(SERVICE_UUID);
+        }
+        
+        if (videoService != BLE_HANDLE_NONE) {
+            BleTransport::advertiseService(VIDEO_SERVICE_UUID);
+        }
+        advertisingConfigured = true;
     }
     
-    if (videoService) {
-        advertising->addServiceUUID(videoService->getUUID());
-    }
-    
-    // Configure advertising parameters
-    advertising->setScanResponse(true);
-    advertising->setMinPreferred(0x06);
-    advertising->setMaxPreferred(0x12);
-    
     // Start advertising
-    BLEDevice::startAdvertising();
+    BleTransport::startAdvertising();
     bleAdvertisingActive = true;
     
     Serial.println("BLE advertising started");
 }
 
 void stopBLEAdvertising() {
-    BLEDevice::stopAdvertising();
+    BleTransport::stopAdvertising();
     bleAdvertisingActive = false;
     Serial.println("BLE advertising stopped");
 }
 
 bool isBLEServerRunning() {
-    return bleServer != nullptr;
+    return bleServerRunning;
 }
 
 bool isBLEAdvertising() {
@@ -1,22 +1,18 @@
 #pragma once
 
 #include <Arduino.h>
-#include <BLEDevice.h>
-#include <BLEServer.h>
-#include <BLEAdvertising.h>
+#include "ble_transport.h"
 #include "services/ble_services.h"
 #include "characteristics/ble_characteristics.h"
 #include "callbacks/callbacks.h"
 
-// BLE Server instance
-extern BLEServer *bleServer;
 // BLE advertising state
 extern bool bleAdvertisingActive;
 
 // BLE Services
-extern BLEService *mainService;
-extern BLEService *videoService;
-extern BLEService *deviceInfoService;
+extern ble_handle_t mainService;
+extern ble_handle_t videoService;
+extern ble_handle_t deviceInfoService;
 
 // BLE Server management functions
 void initializeBLEServer();
@@ -0,0 +1,200 @@
+#include "ble_backend.h"
+#include "../../system/clock/timing.h"
+#include <esp_heap_caps.h>
+#include <ctype.h>
+#include <string.h>
+
+static ble_connection_handler_t connectionHandler = nullptr;
+static ble_handle_t serviceCount = 0;
+static ble_handle_t characteristicCount = 0;
+static ble_write_handler_t writeHandlers[BLE_TRANSPORT_MAX_CHARACTERISTICS];
+static bool started = false;
+static volatile bool connected = false;
+static volatile uint64_t connectedAt = 0;
+
+static const char* advertised[BLE_TRANSPORT_MAX_SERVICES];
+static size_t advertisedCount = 0;
+
+static ble_transport_stats_t transportStats;
+
+static size_t freeDram() {
+    return heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+}
+
+// What the stack took from begin() to the services running
+static size_t dramUsed(const ble_transport_stats_t* s) {
+    return s->dram_free_after && s->dram_free_before > s->dram_free_after ? s->dram_free_before - s->dram_free_after : 0;
+}
+
+// 4 hex digits, or 8-4-4-4-12
+static bool isValidUuid(const char* uuid) {
+    size_t length = uuid ? strlen(uuid) : 0;
+    if (length != 4 && length != 36) return false;
+    for (size_t i = 0; i < length; i++) {
+        bool dash = length == 36 && (i == 8 || i == 13 || i == 18 || i == 23);
+        if (dash ? uuid[i] != '-' : !isxdigit((unsigned char)uuid[i])) return false;
+    }
+    return true;
+}
+
+static bool isCharacteristic(ble_handle_t handle) {
+    return handle >= 0 && handle < characteristicCount;
+}
+
+// ===================================================================
+// EVENTS (BLE host task)
+// ===================================================================
+
+namespace BleTransport {
+    void onConnected(const ble_connection_t* connection) {
+        connectedAt = monotonicMillis();
+        connected = true;
+        if (connectionHandler) connectionHandler(true, connection);
+    }
+
+    void onDisconnected() {
+        if (connected) transportStats.connected_ms += monotonicMillis() - connectedAt;
+        connected = false;
+        if (connectionHandler) connectionHandler(false, nullptr);
+    }
+
+    void onWritten(ble_handle_t characteristic, const uint8_t* data, size_t length) {
+        if (isCharacteristic(characteristic) && writeHandlers[characteristic]) {
+            writeHandlers[characteristic](data, length);
+        }
+    }
+}
+
+// ===================================================================
+// TRANSPORT
+// ===================================================================
+
+namespace BleTransport {
+    bool begin(const char* name, uint16_t mtu, ble_connection_handler_t onConnection) {
+        memset(&transportStats, 0, sizeof(transportStats));
+        transportStats.backend = BleBackend::name();
+        transportStats.dram_free_before = freeDram();
+        connectionHandler = onConnection;
+        serviceCount = 0;
+        characteristicCount = 0;
+        advertisedCount = 0;
+        started = false;
+        connected = false;
+        if (!BleBackend::begin(name, mtu)) {
+            Serial.printf("BLE transport: %s stack failed to start\n", BleBackend::name());
+            return false;
+        }
+        return true;
+    }
+
+    ble_handle_t createService(const char* uuid) {
+        if (started || serviceCount >= BLE_TRANSPORT_MAX_SERVICES || !isValidUuid(uuid)) {
+            Serial.printf("BLE transport: cannot create service %s\n", uuid ? uuid : "(null)");
+            return BLE_HANDLE_NONE;
+        }
+        if (!BleBackend::createService(serviceCount, uuid)) return BLE_HANDLE_NONE;
+        return serviceCount++;
+    }
+
+    ble_handle_t createCharacteristic(ble_handle_t service, const char* uuid, uint8_t properties,
+                                      ble_write_handler_t onWrite) {
+        if (started || service < 0 || service >= serviceCount ||
+            characteristicCount >= BLE_TRANSPORT_MAX_CHARACTERISTICS || !isValidUuid(uuid)) {
+            Serial.printf("BLE transport: cannot create characteristic %s\n", uuid ? uuid : "(null)");
+            return BLE_HANDLE_NONE;
+        }
+        if (!BleBackend::createCharacteristic(characteristicCount, service, uuid, properties)) {
+            return BLE_HANDLE_NONE;
+        }
+        writeHandlers[characteristicCount] = onWrite;
+        return characteristicCount++;
+    }
+
+    bool startServices() {
+        if (started) return true;
+        if (!BleBackend::startServices()) {
+            Serial.printf("BLE transport: %s could not start the services\n", BleBackend::name());
+            return false;
+        }
+        started = true;
+        transportStats.dram_free_after = freeDram();
+        Serial.printf("BLE transport: %s, %d services, %d characteristics, %u bytes of DRAM (%u free)\n",
+                      BleBackend::name(), serviceCount, characteristicCount,
+                      (unsigned)dramUsed(&transportStats),
+                      (unsigned)transportStats.dram_free_after);
+        return true;
+    }
+
+    void advertiseService(const char* uuid) {
+        if (advertisedCount < BLE_TRANSPORT_MAX_SERVICES && isValidUuid(uuid)) {
+            advertised[advertisedCount++] = uuid;
+        }
+    }
+
+    void startAdvertising() {
+        BleBackend::startAdvertising(advertised, advertisedCount);
+    }
+
+    void stopAdvertising() {
+        BleBackend::stopAdvertising();
+    }
+
+    void setValue(ble_handle_t characteristic, const uint8_t* data, size_t length) {
+        if (isCharacteristic(characteristic)) BleBackend::setValue(characteristic, data, length);
+    }
+
+    void setValue(ble_handle_t characteristic, const char* text) {
+        setValue(characteristic, (const uint8_t*)text, strlen(text));
+    }
+
+    bool notify(ble_handle_t characteristic, const uint8_t* data, size_t length) {
+        if (!isCharacteristic(characteristic)) return false;
+        if (!connected) {
+            BleBackend::setValue(characteristic, data, length);
+            return false;
+        }
+
+        uint64_t start = monotonicMicros();
+        bool sent = BleBackend::notify(characteristic, data, length);
+        transportStats.notify_us += elapsedMicros(start);
+        if (sent) {
+            transportStats.notifications++;
+            transportStats.notify_bytes += length;
+        } else {
+            transportStats.notify_failures++;
+        }
+        return sent;
+    }
+
+    bool isConnected() {
+        return connected;
+    }
+
+    uint16_t peerMtu() {
+        return connected ? BleBackend::peerMtu() : 23;
+    }
+
+    void requestConnParams(uint16_t interval, uint16_t latency, uint16_t timeout) {
+        if (connected) BleBackend::requestConnParams(interval, latency, timeout);
+    }
+
+    const ble_transport_stats_t* stats() {
+        static ble_transport_stats_t snapshot;
+        snapshot = transportStats;
+        if (connected) snapshot.connected_ms += monotonicMillis() - connectedAt;
+        return &snapshot;
+    }
+
+    void printReport() {
+        const ble_transport_stats_t* s = stats();
+        double notifySeconds = s->notify_us / 1e6;
+        double connectedSeconds = s->connected_ms / 1e3;
+        Serial.printf("BLE transport: %s uses %u bytes of DRAM (%u free); %lu notifications, %llu bytes, "
+                      "%lu dropped; notify takes %.1f KB/s, %.1f KB/s over %.1f s connected\n",
+                      s->backend, (unsigned)dramUsed(s),
+                      (unsigned)s->dram_free_after, (unsigned long)s->notifications,
+                      (unsigned long long)s->notify_bytes, (unsigned long)s->notify_failures,
+                      notifySeconds > 0 ? s->notify_bytes / notifySeconds / 1024 : 0.0,
+                      connectedSeconds > 0 ? s->notify_bytes / connectedSeconds / 1024 : 0.0, connectedSeconds);
+    }
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <Arduino.h>
+#include "../../hal/constants.h"
+
+// ===================================================================
+// BLE TRANSPORT
+// ===================================================================
+//
+// The GATT server the firmware talks to, on the BLE host BLE_BACKEND
+// selects (hal/constants.h):
+//
+//   BLE_BACKEND_BLUEDROID  ble_transport_bluedroid.cpp: the Arduino BLEDevice classes
+//   BLE_BACKEND_NIMBLE     ble_transport_nimble.cpp: the NimBLE host's GATT server
+//   BLE_BACKEND_MOCK       public/host/sim/ble_central.cpp: the virtual device's central
+//
+// Services and characteristics are created between begin() and
+// startServices() and referred to by handle afterwards. UUIDs are text:
+// "180F" for a 16-bit UUID, the full 36 characters otherwise. Write
+// handlers and connection events run on the BLE host task; notify() is
+// called from the loop. One central at a time.
+//
+// What is common to the backends lives in ble_transport.cpp; a backend
+// implements ble_backend.h. Notifications are counted and timed there,
+// and free internal DRAM is sampled before begin() and once the services
+// are up, so the stacks compare on the same build (printReport()).
+//
+
+#define BLE_PROPERTY_READ (1 << 0)
+#define BLE_PROPERTY_WRITE (1 << 1)
+#define BLE_PROPERTY_NOTIFY (1 << 2)
+
+#define BLE_TRANSPORT_MAX_SERVICES 6
+#define BLE_TRANSPORT_MAX_CHARACTERISTICS 24
+
+typedef int ble_handle_t;
+#define BLE_HANDLE_NONE -1
+
+/**
+ * A central wrote a characteristic (BLE host task)
+ */
+typedef void (*ble_write_handler_t)(const uint8_t* data, size_t length);
+
+/**
+ * The central that connected and the link parameters it chose
+ */
+typedef struct {
+    uint8_t address[6];
+    uint16_t interval;      // 1.25 ms units
+    uint16_t latency;
+    uint16_t timeout;       // 10 ms units
+} ble_connection_t;
+
+/**
+ * Connected (with the connection) or disconnected (nullptr) (BLE host task)
+ */
+typedef void (*ble_connection_handler_t)(bool connected, const ble_connection_t* connection);
+
+/**
+ * Memory and notify figures of the backend
+ */
+typedef struct {
+    const char* backend;
+    size_t dram_free_before;        // Free internal DRAM before begin()
+    size_t dram_free_after;         // ... once the services were started
+    uint32_t notifications;         // Handed to the stack
+    uint32_t notify_failures;       // Turned down by the stack (dropped)
+    uint64_t notify_bytes;
+    uint64_t notify_us;             // Time spent in notify()
+    uint64_t connected_ms;          // Time connected, including the current connection
+} ble_transport_stats_t;
+
+namespace BleTransport {
+    /**
+     * Bring the stack up
+     * @param mtu ATT MTU to offer
+     */
+    bool begin(const char* name, uint16_t mtu, ble_connection_handler_t onConnection);
+
+    /**
+     * @return Handle, or BLE_HANDLE_NONE when out of room
+     */
+    ble_handle_t createService(const char* uuid);
+
+    /**
+     * @param properties BLE_PROPERTY_* flags; notify characteristics need no
+     *        descriptor, the backend adds it
+     * @param onWrite Called for writes (BLE_PROPERTY_WRITE)
+     * @return Handle, or BLE_HANDLE_NONE when out of room
+     */
+    ble_handle_t createCharacteristic(ble_handle_t service, const char* uuid, uint8_t properties,
+                                      ble_write_handler_t onWrite = nullptr);
+
+    /**
+     * Start every service created so far (no more can be created)
+     */
+    bool startServices();
+
+    /** Put a service in the advertising data (before startAdvertising()) */
+    void advertiseService(const char* uuid);
+    void startAdvertising();
+    void stopAdvertising();
+
+    /**
+     * Value returned to reads
+     */
+    void setValue(ble_handle_t characteristic, const uint8_t* data, size_t length);
+    void setValue(ble_handle_t characteristic, const char* text);
+
+    /**
+     * Set the value and notify it if a central is connected
+     * @return false if not connected or the stack turned it down
+     */
+    bool notify(ble_handle_t characteristic, const uint8_t* data, size_t length);
+
+    bool isConnected();
+
+    /** ATT MTU of the connection (23 when not connected) */
+    uint16_t peerMtu();
+
+    /**
+     * Ask the central for new link parameters (units as in ble_connection_t)
+     */
+    void requestConnParams(uint16_t interval, uint16_t latency, uint16_t timeout);
+
+    const ble_transport_stats_t* stats();
+
+    /** Print the backend, its DRAM use and notify throughput */
+    void printReport();
+}
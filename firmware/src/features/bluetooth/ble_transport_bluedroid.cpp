@@ -0,0 +1,142 @@
+#include "ble_backend.h"
+
+#if BLE_BACKEND == BLE_BACKEND_BLUEDROID
+
+#include <BLEDevice.h>
+#include <BLEServer.h>
+#include <BLE2902.h>
+
+// ===================================================================
+// BLUEDROID BACKEND
+// ===================================================================
+//
+// The Arduino BLEDevice classes. The stack copies every value into the
+// attribute table and then into its notify queue; notify() does not say
+// whether the queue took it, so nothing counts as dropped here.
+//
+
+static BLEServer* server = nullptr;
+static BLEService* services[BLE_TRANSPORT_MAX_SERVICES];
+static BLECharacteristic* characteristics[BLE_TRANSPORT_MAX_CHARACTERISTICS];
+static ble_handle_t serviceCount = 0;
+static bool advertisingConfigured = false;
+static esp_bd_addr_t peerAddress;
+
+class ServerEvents : public BLEServerCallbacks {
+    void onConnect(BLEServer* server, esp_ble_gatts_cb_param_t* param) override {
+        (void)server;
+        ble_connection_t connection;
+        memcpy(connection.address, param->connect.remote_bda, sizeof(connection.address));
+        memcpy(peerAddress, param->connect.remote_bda, sizeof(peerAddress));
+        connection.interval = param->connect.conn_params.interval;
+        connection.latency = param->connect.conn_params.latency;
+        connection.timeout = param->connect.conn_params.timeout;
+        BleTransport::onConnected(&connection);
+    }
+
+    void onDisconnect(BLEServer* server) override {
+        (void)server;
+        BleTransport::onDisconnected();
+    }
+};
+
+class CharacteristicEvents : public BLECharacteristicCallbacks {
+public:
+    explicit CharacteristicEvents(ble_handle_t handle) : handle(handle) {}
+
+    void onWrite(BLECharacteristic* characteristic) override {
+        BleTransport::onWritten(handle, characteristic->getData(), characteristic->getLength());
+    }
+
+private:
+    ble_handle_t handle;
+};
+
+namespace BleBackend {
+    const char* name() {
+        return "Bluedroid";
+    }
+
+    bool begin(const char* name, uint16_t mtu) {
+        BLEDevice::init(name);
+        server = BLEDevice::createServer();
+        BLEDevice::setMTU(mtu);
+        server->setCallbacks(new ServerEvents());
+        serviceCount = 0;
+        advertisingConfigured = false;
+        return server != nullptr;
+    }
+
+    bool createService(ble_handle_t service, const char* uuid) {
+        services[service] = server->createService(BLEUUID(uuid));
+        serviceCount = service + 1;
+        return services[service] != nullptr;
+    }
+
+    bool createCharacteristic(ble_handle_t characteristic, ble_handle_t service, const char* uuid,
+                              uint8_t properties) {
+        uint32_t flags = 0;
+        if (properties & BLE_PROPERTY_READ) flags |= BLECharacteristic::PROPERTY_READ;
+        if (properties & BLE_PROPERTY_WRITE) flags |= BLECharacteristic::PROPERTY_WRITE;
+        if (properties & BLE_PROPERTY_NOTIFY) flags |= BLECharacteristic::PROPERTY_NOTIFY;
+
+        BLECharacteristic* created = services[service]->createCharacteristic(BLEUUID(uuid), flags);
+        if (!created) return false;
+        if (properties & BLE_PROPERTY_NOTIFY) {
+            BLE2902* ccc = new BLE2902();
+            ccc->setNotifications(true);
+            created->addDescriptor(ccc);
+        }
+        if (properties & BLE_PROPERTY_WRITE) {
+            created->setCallbacks(new CharacteristicEvents(characteristic));
+        }
+        characteristics[characteristic] = created;
+        return true;
+    }
+
+    bool startServices() {
+        for (ble_handle_t i = 0; i < serviceCount; i++) {
+            services[i]->start();
+        }
+        return true;
+    }
+
+    void startAdvertising(const char* const* uuids, size_t count) {
+        // The stack keeps the data: a restart after a disconnect only starts it
+        if (!advertisingConfigured) {
+            BLEAdvertising* advertising = BLEDevice::getAdvertising();
+            for (size_t i = 0; i < count; i++) {
+                advertising->addServiceUUID(BLEUUID(uuids[i]));
+            }
+            advertising->setScanResponse(true);
+            advertising->setMinPreferred(0x06);
+            advertising->setMaxPreferred(0x12);
+            advertisingConfigured = true;
+        }
+        BLEDevice::startAdvertising();
+    }
+
+    void stopAdvertising() {
+        BLEDevice::stopAdvertising();
+    }
+
+    void setValue(ble_handle_t characteristic, const uint8_t* data, size_t length) {
+        characteristics[characteristic]->setValue((uint8_t*)data, length);
+    }
+
+    bool notify(ble_handle_t characteristic, const uint8_t* data, size_t length) {
+        characteristics[characteristic]->setValue((uint8_t*)data, length);
+        characteristics[characteristic]->notify();
+        return true;
+    }
+
+    uint16_t peerMtu() {
+        return server->getPeerMTU(server->getConnId());
+    }
+
+    void requestConnParams(uint16_t interval, uint16_t latency, uint16_t timeout) {
+        server->updateConnParams(peerAddress, interval, interval, latency, timeout);
+    }
+}
+
+#endif // BLE_BACKEND_BLUEDROID
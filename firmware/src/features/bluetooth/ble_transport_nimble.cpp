@@ -0,0 +1,356 @@
+#include "ble_backend.h"
+
+#if BLE_BACKEND == BLE_BACKEND_NIMBLE
+
+#if !CONFIG_BT_NIMBLE_ENABLED
+#error "BLE_BACKEND_NIMBLE needs a core built with the NimBLE host (CONFIG_BT_NIMBLE_ENABLED)"
+#endif
+
+#include "nimble/nimble_port.h"
+#include "nimble/nimble_port_freertos.h"
+#include "host/ble_hs.h"
+#include "host/util/util.h"
+#include "services/gap/ble_svc_gap.h"
+#include "services/gatt/ble_svc_gatt.h"
+#include <freertos/semphr.h>
+
+// ===================================================================
+// NIMBLE BACKEND
+// ===================================================================
+//
+// The NimBLE host's GATT server, without a C++ wrapper. The service table
+// is handed to the host in one go by startServices(), which then starts
+// the host task. A notification is one mbuf copied straight from the
+// caller's data; when the host is out of mbufs, notify() turns it down
+// straight away instead of waiting for completed ones. The photo upload
+// sends the frame again on its next pass, as it does for a stalled L2CAP
+// channel; the streams drop it.
+//
+
+typedef struct {
+    ble_uuid_any_t uuid;
+} service_t;
+
+typedef struct {
+    ble_uuid_any_t uuid;
+    ble_handle_t service;
+    uint8_t properties;
+    uint16_t valueHandle;
+    uint8_t* value;             // For reads; grows, under valueLock
+    size_t length;
+    size_t capacity;
+} characteristic_t;
+
+static service_t services[BLE_TRANSPORT_MAX_SERVICES];
+static characteristic_t characteristics[BLE_TRANSPORT_MAX_CHARACTERISTICS];
+static ble_handle_t serviceCount = 0;
+static ble_handle_t characteristicCount = 0;
+
+// Handed to the host: every service's characteristics end with an empty entry
+static struct ble_gatt_svc_def serviceDefs[BLE_TRANSPORT_MAX_SERVICES + 1];
+static struct ble_gatt_chr_def characteristicDefs[BLE_TRANSPORT_MAX_CHARACTERISTICS + BLE_TRANSPORT_MAX_SERVICES];
+
+static SemaphoreHandle_t valueLock = nullptr;
+static uint8_t writeBuffer[BLE_ATT_ATTR_MAX_LEN];      // Host task only
+
+// Connection and advertising: written by the host task
+static volatile uint16_t connHandle = BLE_HS_CONN_HANDLE_NONE;
+static volatile bool synced = false;
+static volatile bool advertiseOnSync = false;
+static uint8_t ownAddressType = 0;
+static ble_uuid16_t advertised16[BLE_TRANSPORT_MAX_SERVICES];
+static ble_uuid128_t advertised128[BLE_TRANSPORT_MAX_SERVICES];
+static size_t advertised16Count = 0;
+static size_t advertised128Count = 0;
+
+static int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return c - 'A' + 10;
+}
+
+// Checked by the transport: 4 hex digits, or 8-4-4-4-12 (little endian on air)
+static void parseUuid(const char* text, ble_uuid_any_t* uuid) {
+    memset(uuid, 0, sizeof(*uuid));
+    if (strlen(text) == 4) {
+        uuid->u16.u.type = BLE_UUID_TYPE_16;
+        uuid->u16.value = (uint16_t)(hexDigit(text[0]) << 12 | hexDigit(text[1]) << 8 |
+                                     hexDigit(text[2]) << 4 | hexDigit(text[3]));
+        return;
+    }
+    uuid->u128.u.type = BLE_UUID_TYPE_128;
+    int byte = 15;
+    for (const char* p = text; *p && byte >= 0; p++) {
+        if (*p == '-') continue;
+        uuid->u128.value[byte--] = (uint8_t)(hexDigit(p[0]) << 4 | hexDigit(p[1]));
+        p++;
+    }
+}
+
+static void storeValue(ble_handle_t characteristic, const uint8_t* data, size_t length) {
+    characteristic_t* c = &characteristics[characteristic];
+    xSemaphoreTake(valueLock, portMAX_DELAY);
+    if (length > c->capacity) {
+        uint8_t* grown = (uint8_t*)realloc(c->value, length);
+        if (grown) {
+            c->value = grown;
+            c->capacity = length;
+        }
+    }
+    c->length = length <= c->capacity ? length : 0;
+    if (c->length) memcpy(c->value, data, c->length);
+    xSemaphoreGive(valueLock);
+}
+
+// ===================================================================
+// EVENTS (NimBLE host task)
+// ===================================================================
+
+static int onAccess(uint16_t conn, uint16_t attribute, struct ble_gatt_access_ctxt* ctxt, void* arg) {
+    (void)conn;
+    (void)attribute;
+    ble_handle_t handle = (ble_handle_t)(intptr_t)arg;
+    characteristic_t* c = &characteristics[handle];
+
+    switch (ctxt->op) {
+        case BLE_GATT_ACCESS_OP_READ_CHR: {
+            xSemaphoreTake(valueLock, portMAX_DELAY);
+            int rc = os_mbuf_append(ctxt->om, c->value, c->length);
+            xSemaphoreGive(valueLock);
+            return rc == 0 ? 0 : BLE_ATT_ERR_INSUFFICIENT_RES;
+        }
+
+        case BLE_GATT_ACCESS_OP_WRITE_CHR: {
+            uint16_t length = 0;
+            if (ble_hs_mbuf_to_flat(ctxt->om, writeBuffer, sizeof(writeBuffer), &length) != 0) {
+                return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+            }
+            storeValue(handle, writeBuffer, length);
+            BleTransport::onWritten(handle, writeBuffer, length);
+            return 0;
+        }
+
+        default:
+            return BLE_ATT_ERR_UNLIKELY;
+    }
+}
+
+static void advertise();
+
+static int onGapEvent(struct ble_gap_event* event, void* arg) {
+    (void)arg;
+    switch (event->type) {
+        case BLE_GAP_EVENT_CONNECT: {
+            if (event->connect.status != 0) {
+                advertise();
+                return 0;
+            }
+            ble_connection_t connection;
+            memset(&connection, 0, sizeof(connection));
+            struct ble_gap_conn_desc desc;
+            if (ble_gap_conn_find(event->connect.conn_handle, &desc) == 0) {
+                memcpy(connection.address, desc.peer_id_addr.val, sizeof(connection.address));
+                connection.interval = desc.conn_itvl;
+                connection.latency = desc.conn_latency;
+                connection.timeout = desc.supervision_timeout;
+            }
+            connHandle = event->connect.conn_handle;
+            BleTransport::onConnected(&connection);
+            return 0;
+        }
+
+        case BLE_GAP_EVENT_DISCONNECT:
+            connHandle = BLE_HS_CONN_HANDLE_NONE;
+            BleTransport::onDisconnected();
+            return 0;
+
+        default:
+            return 0;
+    }
+}
+
+static void onSync() {
+    ble_hs_util_ensure_addr(0);
+    ble_hs_id_infer_auto(0, &ownAddressType);
+    synced = true;
+    if (advertiseOnSync) advertise();
+}
+
+static void onReset(int reason) {
+    synced = false;
+    Serial.printf("BLE transport: NimBLE host reset (%d)\n", reason);
+}
+
+static void hostTask(void* param) {
+    (void)param;
+    nimble_port_run();
+    nimble_port_freertos_deinit();
+}
+
+// Flags, the 16-bit services and the first 128-bit one; the name and the
+// next 128-bit service in the scan response (31 bytes each)
+static void advertise() {
+    if (!synced) {
+        advertiseOnSync = true;
+        return;
+    }
+
+    struct ble_hs_adv_fields fields;
+    memset(&fields, 0, sizeof(fields));
+    fields.flags = BLE_HS_ADV_F_DISC_GEN | BLE_HS_ADV_F_BREDR_UNSUP;
+    fields.uuids16 = advertised16;
+    fields.num_uuids16 = advertised16Count;
+    fields.uuids128 = advertised128;
+    fields.num_uuids128 = advertised128Count > 0 ? 1 : 0;
+    int rc = ble_gap_adv_set_fields(&fields);
+    if (rc != 0) Serial.printf("BLE transport: advertising data too long (%d)\n", rc);
+
+    struct ble_hs_adv_fields response;
+    memset(&response, 0, sizeof(response));
+    const char* name = ble_svc_gap_device_name();
+    response.name = (const uint8_t*)name;
+    response.name_len = strlen(name);
+    response.name_is_complete = 1;
+    if (advertised128Count > 1) {
+        response.uuids128 = &advertised128[1];
+        response.num_uuids128 = 1;
+    }
+    ble_gap_adv_rsp_set_fields(&response);
+
+    struct ble_gap_adv_params params;
+    memset(&params, 0, sizeof(params));
+    params.conn_mode = BLE_GAP_CONN_MODE_UND;
+    params.disc_mode = BLE_GAP_DISC_MODE_GEN;
+    rc = ble_gap_adv_start(ownAddressType, nullptr, BLE_HS_FOREVER, &params, onGapEvent, nullptr);
+    if (rc != 0 && rc != BLE_HS_EALREADY) Serial.printf("BLE transport: cannot advertise (%d)\n", rc);
+}
+
+// ===================================================================
+// BACKEND
+// ===================================================================
+
+namespace BleBackend {
+    const char* name() {
+        return "NimBLE";
+    }
+
+    bool begin(const char* name, uint16_t mtu) {
+        if (nimble_port_init() != 0) return false;
+        ble_hs_cfg.sync_cb = onSync;
+        ble_hs_cfg.reset_cb = onReset;
+        ble_svc_gap_init();
+        ble_svc_gatt_init();
+        ble_svc_gap_device_name_set(name);
+        ble_att_set_preferred_mtu(mtu);
+        valueLock = xSemaphoreCreateMutex();
+        serviceCount = 0;
+        characteristicCount = 0;
+        return valueLock != nullptr;
+    }
+
+    bool createService(ble_handle_t service, const char* uuid) {
+        parseUuid(uuid, &services[service].uuid);
+        serviceCount = service + 1;
+        return true;
+    }
+
+    bool createCharacteristic(ble_handle_t characteristic, ble_handle_t service, const char* uuid,
+                              uint8_t properties) {
+        characteristic_t* c = &characteristics[characteristic];
+        memset(c, 0, sizeof(*c));
+        parseUuid(uuid, &c->uuid);
+        c->service = service;
+        c->properties = properties;
+        characteristicCount = characteristic + 1;
+        return true;
+    }
+
+    bool startServices() {
+        memset(serviceDefs, 0, sizeof(serviceDefs));
+        memset(characteristicDefs, 0, sizeof(characteristicDefs));
+
+        size_t next = 0;
+        for (ble_handle_t s = 0; s < serviceCount; s++) {
+            serviceDefs[s].type = BLE_GATT_SVC_TYPE_PRIMARY;
+            serviceDefs[s].uuid = &services[s].uuid.u;
+            serviceDefs[s].characteristics = &characteristicDefs[next];
+            for (ble_handle_t i = 0; i < characteristicCount; i++) {
+                characteristic_t* c = &characteristics[i];
+                if (c->service != s) continue;
+                struct ble_gatt_chr_def* def = &characteristicDefs[next++];
+                def->uuid = &c->uuid.u;
+                def->access_cb = onAccess;
+                def->arg = (void*)(intptr_t)i;
+                def->val_handle = &c->valueHandle;
+                if (c->properties & BLE_PROPERTY_READ) def->flags |= BLE_GATT_CHR_F_READ;
+                if (c->properties & BLE_PROPERTY_WRITE) def->flags |= BLE_GATT_CHR_F_WRITE;
+                if (c->properties & BLE_PROPERTY_NOTIFY) def->flags |= BLE_GATT_CHR_F_NOTIFY;
+            }
+            next++;     // End of this service's characteristics
+        }
+
+        int rc = ble_gatts_count_cfg(serviceDefs);
+        if (rc == 0) rc = ble_gatts_add_svcs(serviceDefs);
+        if (rc != 0) {
+            Serial.printf("BLE transport: NimBLE rejected the service table (%d)\n", rc);
+            return false;
+        }
+        nimble_port_freertos_init(hostTask);
+        return true;
+    }
+
+    void startAdvertising(const char* const* uuids, size_t count) {
+        advertised16Count = 0;
+        advertised128Count = 0;
+        for (size_t i = 0; i < count; i++) {
+            ble_uuid_any_t uuid;
+            parseUuid(uuids[i], &uuid);
+            if (uuid.u.type == BLE_UUID_TYPE_16) {
+                advertised16[advertised16Count++] = uuid.u16;
+            } else {
+                advertised128[advertised128Count++] = uuid.u128;
+            }
+        }
+        advertise();
+    }
+
+    void stopAdvertising() {
+        advertiseOnSync = false;
+        if (synced) ble_gap_adv_stop();
+    }
+
+    void setValue(ble_handle_t characteristic, const uint8_t* data, size_t length) {
+        storeValue(characteristic, data, length);
+    }
+
+    bool notify(ble_handle_t characteristic, const uint8_t* data, size_t length) {
+        storeValue(characteristic, data, length);
+
+        uint16_t conn = connHandle;
+        if (conn == BLE_HS_CONN_HANDLE_NONE) return false;
+
+        // The host frees the mbuf whatever happens
+        struct os_mbuf* om = ble_hs_mbuf_from_flat(data, length);
+        if (!om) return false;
+        return ble_gatts_notify_custom(conn, characteristics[characteristic].valueHandle, om) == 0;
+    }
+
+    uint16_t peerMtu() {
+        uint16_t conn = connHandle;
+        return conn == BLE_HS_CONN_HANDLE_NONE ? BLE_ATT_MTU_DFLT : ble_att_mtu(conn);
+    }
+
+    void requestConnParams(uint16_t interval, uint16_t latency, uint16_t timeout) {
+        uint16_t conn = connHandle;
+        if (conn == BLE_HS_CONN_HANDLE_NONE) return;
+        struct ble_gap_upd_params params;
+        memset(&params, 0, sizeof(params));
+        params.itvl_min = interval;
+        params.itvl_max = interval;
+        params.latency = latency;
+        params.supervision_timeout = timeout;
+        ble_gap_update_params(conn, &params);
+    }
+}
+
+#endif // BLE_BACKEND_NIMBLE
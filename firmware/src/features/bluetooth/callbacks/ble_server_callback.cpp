@@ -1,28 +1,43 @@
 #include "ble_server_callback.h"
 #include "../../../hal/led/led_manager.h"
 #include "../../../status/device_status.h"
+#include "../../../status/device_lifecycle.h"
+#include "../../../system/power_management/retained_state.h"
 
 // Connection state
 bool bleConnected = false;
+volatile uint32_t bleConnectionCount = 0;
 
-// BLE Server Connection Handler Implementation
-void BLEServerHandler::onConnect(BLEServer *server) {
+// BLE Connection Handler Implementation
+void onBLEConnectionEvent(bool connected, const ble_connection_t *connection) {
+    if (!connected) {
+        bleConnected = false;
+        Serial.println("BLE Client disconnected, restarting advertising");
+        setLedPattern(LED_DISCONNECTED);
+        BleTransport::printReport();
+        BleTransport::startAdvertising();
+        
+        // Update hotspot statistics with BLE disconnection
+        // updateBLEConnectionStatus(false);  // DISABLED: Causes BLE interference
+        return;
+    }
+    
     bleConnected = true;
+    bleConnectionCount++;
     Serial.println("BLE Client connected");
     setLedPattern(LED_CONNECTED);
-    updateDeviceStatus(deviceReady ? DEVICE_STATUS_READY : deviceStatus);
+    updateDeviceStatus(DeviceLifecycle::isReady() ? DEVICE_STATUS_READY : deviceStatus);
     
-    // Update hotspot statistics with BLE connection
-    // String client_info = "BLE Client " + String(server->getConnId());
-    // updateBLEConnectionStatus(true, client_info);  // DISABLED: Causes BLE interference
-}
-
-void BLEServerHandler::onDisconnect(BLEServer *server) {
-    bleConnected = false;
-    Serial.println("BLE Client disconnected, restarting advertising");
-    setLedPattern(LED_DISCONNECTED);
-    BLEDevice::startAdvertising();
+    // A peer returning after a warm boot gets its previous link parameters right away
+    if (RetainedState::isWarmBoot() && RetainedState::isRetainedPeer(connection->address)) {
+        const retained_state_t* state = RetainedState::get();
+        BleTransport::requestConnParams(state->conn_interval, state->conn_latency, state->supervision_timeout);
+        Serial.println("Requested retained connection parameters");
+    }
     
-    // Update hotspot statistics with BLE disconnection
-    // updateBLEConnectionStatus(false);  // DISABLED: Causes BLE interference
-} 
\ No newline at end of file
+    RetainedState::recordPeer(connection->address, connection->interval,
+                              connection->latency, connection->timeout);
+    
+    // Update hotspot statistics with BLE connection
+    // updateBLEConnectionStatus(true, "BLE Client");  // DISABLED: Causes BLE interference
+}
\ No newline at end of file
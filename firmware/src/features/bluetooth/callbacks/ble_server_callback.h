@@ -1,16 +1,12 @@
 #pragma once
 
 #include <Arduino.h>
-#include <BLEDevice.h>
-#include <BLEServer.h>
+#include "../ble_transport.h"
 #include "../services/ble_services.h"
 
-// BLE Server Connection Handler
-class BLEServerHandler : public BLEServerCallbacks {
-public:
-    void onConnect(BLEServer *server) override;
-    void onDisconnect(BLEServer *server) override;
-};
+// BLE connection handler (BleTransport::begin(), BLE task)
+void onBLEConnectionEvent(bool connected, const ble_connection_t *connection);
 
 // Connection state management
-extern bool bleConnected; 
\ No newline at end of file
+extern bool bleConnected;
+extern volatile uint32_t bleConnectionCount;   // Connections so far (client caches start empty on each)
\ No newline at end of file
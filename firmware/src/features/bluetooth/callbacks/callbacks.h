@@ -1,9 +1,6 @@
 #pragma once
 
 #include <Arduino.h>
-#include <BLEDevice.h>
-#include <BLEServer.h>
-#include <BLECharacteristic.h>
 #include "../services/ble_services.h"
 
 // Include all individual callback headers
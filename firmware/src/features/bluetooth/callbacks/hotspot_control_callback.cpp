@@ -1,15 +1,15 @@
 #include "hotspot_control_callback.h"
 #include "../characteristics/ble_characteristics.h"
 
-// Hotspot Control Callback Implementation
-void HotspotControlCallback::onWrite(BLECharacteristic *characteristic) {
-    Serial.printf("Hotspot control write received, length: %d\n", characteristic->getLength());
+// Hotspot Control Write Handler
+void onHotspotControlWrite(const uint8_t *data, size_t length) {
+    Serial.printf("Hotspot control write received, length: %d\n", (int)length);
     
     // Record BLE command received
     // recordBLECommandReceived();  // DISABLED: Function not defined and causes BLE interference
     
-    if (characteristic->getLength() == 1) {
-        uint8_t value = characteristic->getData()[0];
+    if (length == 1) {
+        uint8_t value = data[0];
         Serial.printf("Hotspot control value: %d (0x%02X)\n", value, value);
         handleHotspotControl(value);
     } else {
@@ -52,12 +52,11 @@ void handleHotspotControl(uint8_t controlValue) {
 
 // Update hotspot status characteristic - DISABLED: Causes BLE interference
 void updateHotspotStatus() {
-    if (!hotspotStatusCharacteristic || !bleConnected) return;
+    if (hotspotStatusCharacteristic == BLE_HANDLE_NONE || !bleConnected) return;
     
     // Send minimal status to indicate hotspot is disabled
     uint8_t statusData[8] = {0, 0, 0, 0, 0, 0, 0, 0}; // All zeros = disabled
-    hotspotStatusCharacteristic->setValue(statusData, 8);
-    hotspotStatusCharacteristic->notify();
+    BleTransport::notify(hotspotStatusCharacteristic, statusData, 8);
     
     Serial.println("Hotspot status updated: DISABLED (prevents BLE interference)");
     
@@ -107,8 +106,7 @@ void updateHotspotStatus() {
         pos += ipLen;
     }
     
-    hotspotStatusCharacteristic->setValue(statusData, pos);
-    hotspotStatusCharacteristic->notify();
+    BleTransport::notify(hotspotStatusCharacteristic, statusData, pos);
     
     // Record BLE data transmission for this status update
     recordBLEDataTransmission(pos);
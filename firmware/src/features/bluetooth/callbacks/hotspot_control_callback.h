@@ -1,15 +1,10 @@
 #pragma once
 
 #include <Arduino.h>
-#include <BLEDevice.h>
-#include <BLECharacteristic.h>
 
 // Forward declarations
 void handleHotspotControl(uint8_t controlValue);
 void updateHotspotStatus();
 
-// Hotspot Control Callback Handler
-class HotspotControlCallback : public BLECharacteristicCallbacks {
-public:
-    void onWrite(BLECharacteristic *characteristic) override;
-}; 
\ No newline at end of file
+// Hotspot control write handler (BLE task)
+void onHotspotControlWrite(const uint8_t *data, size_t length); 
\ No newline at end of file
@@ -1,14 +1,9 @@
 #pragma once
 
 #include <Arduino.h>
-#include <BLEDevice.h>
-#include <BLECharacteristic.h>
 
 // Forward declaration
 void handlePhotoControl(int8_t controlValue);
 
-// Photo Control Callback Handler
-class PhotoControlCallback : public BLECharacteristicCallbacks {
-public:
-    void onWrite(BLECharacteristic *characteristic) override;
-}; 
\ No newline at end of file
+// Photo control write handler (BLE task)
+void onPhotoControlWrite(const uint8_t *data, size_t length); 
\ No newline at end of file
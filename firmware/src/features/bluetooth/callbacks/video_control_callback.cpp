@@ -1,10 +1,10 @@
 #include "video_control_callback.h"
 
-// Video Control Callback Implementation
-void VideoControlCallback::onWrite(BLECharacteristic *characteristic) {
-    Serial.printf("Video control write received, length: %d\n", characteristic->getLength());
-    if (characteristic->getLength() == 1) {
-        uint8_t value = characteristic->getData()[0];
+// Video Control Write Handler
+void onVideoControlWrite(const uint8_t *data, size_t length) {
+    Serial.printf("Video control write received, length: %d\n", (int)length);
+    if (length == 1) {
+        uint8_t value = data[0];
         Serial.printf("Video control value: %d (0x%02X)\n", value, value);
         handleVideoControl(value);
     } else {
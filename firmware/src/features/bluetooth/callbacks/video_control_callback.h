@@ -1,14 +1,9 @@
 #pragma once
 
 #include <Arduino.h>
-#include <BLEDevice.h>
-#include <BLECharacteristic.h>
 
 // Forward declaration
 void handleVideoControl(uint8_t controlValue);
 
-// Video Control Callback Handler
-class VideoControlCallback : public BLECharacteristicCallbacks {
-public:
-    void onWrite(BLECharacteristic *characteristic) override;
-}; 
\ No newline at end of file
+// Video control write handler (BLE task)
+void onVideoControlWrite(const uint8_t *data, size_t length); 
\ No newline at end of file
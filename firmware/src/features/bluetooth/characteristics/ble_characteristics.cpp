@@ -1,202 +1,184 @@
 #include "ble_characteristics.h"
 #include "../../../status/device_status.h"
+#include "../../../status/device_lifecycle.h"
 #include "../../../system/battery/battery_code.h"
 #include "../../camera/camera.h"
 // #include "../utils/hotspot_manager.h"  // DISABLED: Causes BLE interference
 
 // BLE Characteristics - Audio
-BLECharacteristic *audioDataCharacteristic = nullptr;
-BLECharacteristic *audioCodecCharacteristic = nullptr;
+ble_handle_t audioDataCharacteristic = BLE_HANDLE_NONE;
+ble_handle_t audioCodecCharacteristic = BLE_HANDLE_NONE;
 
 // BLE Characteristics - Photo
-BLECharacteristic *photoDataCharacteristic = nullptr;
-BLECharacteristic *photoControlCharacteristic = nullptr;
+ble_handle_t photoDataCharacteristic = BLE_HANDLE_NONE;
+ble_handle_t photoControlCharacteristic = BLE_HANDLE_NONE;
 
 // BLE Characteristics - Video
-BLECharacteristic *videoDataCharacteristic = nullptr;
-BLECharacteristic *videoControlCharacteristic = nullptr;
-BLECharacteristic *videoStatusCharacteristic = nullptr;
+ble_handle_t videoDataCharacteristic = BLE_HANDLE_NONE;
+ble_handle_t videoControlCharacteristic = BLE_HANDLE_NONE;
+ble_handle_t videoStatusCharacteristic = BLE_HANDLE_NONE;
 
 // BLE Characteristics - Device Info
-BLECharacteristic *manufacturerNameCharacteristic = nullptr;
-BLECharacteristic *modelNumberCharacteristic = nullptr;
-BLECharacteristic *firmwareRevisionCharacteristic = nullptr;
-BLECharacteristic *hardwareRevisionCharacteristic = nullptr;
+ble_handle_t manufacturerNameCharacteristic = BLE_HANDLE_NONE;
+ble_handle_t modelNumberCharacteristic = BLE_HANDLE_NONE;
+ble_handle_t firmwareRevisionCharacteristic = BLE_HANDLE_NONE;
+ble_handle_t hardwareRevisionCharacteristic = BLE_HANDLE_NONE;
 
 // BLE Characteristics - Hotspot Control
-BLECharacteristic *hotspotControlCharacteristic = nullptr;
-BLECharacteristic *hotspotStatusCharacteristic = nullptr;
+ble_handle_t hotspotControlCharacteristic = BLE_HANDLE_NONE;
+ble_handle_t hotspotStatusCharacteristic = BLE_HANDLE_NONE;
 
-void createAudioCharacteristics(BLEService *service) {
+void createAudioCharacteristics(ble_handle_t service) {
     // Audio data characteristic
-    audioDataCharacteristic = service->createCharacteristic(
-        audioDataUUID,
-        BLECharacteristic::PROPERTY_READ | BLECharacteristic::PROPERTY_NOTIFY
+    audioDataCharacteristic = BleTransport::createCharacteristic(
+        service, AUDIO_DATA_UUID,
+        BLE_PROPERTY_READ | BLE_PROPERTY_NOTIFY
     );
-    BLE2902 *ccc = new BLE2902();
-    ccc->setNotifications(true);
-    audioDataCharacteristic->addDescriptor(ccc);
 
     // Audio codec characteristic
-    audioCodecCharacteristic = service->createCharacteristic(
-        audioCodecUUID,
-        BLECharacteristic::PROPERTY_READ
+    audioCodecCharacteristic = BleTransport::createCharacteristic(
+        service, AUDIO_CODEC_UUID,
+        BLE_PROPERTY_READ
     );
     uint8_t codecId = CODEC_ID;
-    audioCodecCharacteristic->setValue(&codecId, 1);
+    BleTransport::setValue(audioCodecCharacteristic, &codecId, 1);
     
     Serial.println("Audio characteristics created");
 }
 
-void createPhotoCharacteristics(BLEService *service) {
+void createPhotoCharacteristics(ble_handle_t service) {
     // Photo data characteristic
-    photoDataCharacteristic = service->createCharacteristic(
-        photoDataUUID,
-        BLECharacteristic::PROPERTY_READ | BLECharacteristic::PROPERTY_NOTIFY
+    photoDataCharacteristic = BleTransport::createCharacteristic(
+        service, PHOTO_DATA_UUID,
+        BLE_PROPERTY_READ | BLE_PROPERTY_NOTIFY
     );
-    BLE2902 *ccc = new BLE2902();
-    ccc->setNotifications(true);
-    photoDataCharacteristic->addDescriptor(ccc);
 
     // Photo control characteristic
-    photoControlCharacteristic = service->createCharacteristic(
-        photoControlUUID,
-        BLECharacteristic::PROPERTY_WRITE
+    photoControlCharacteristic = BleTransport::createCharacteristic(
+        service, PHOTO_CONTROL_UUID,
+        BLE_PROPERTY_WRITE,
+        onPhotoControlWrite
     );
-    photoControlCharacteristic->setCallbacks(new PhotoControlCallback());
     uint8_t controlValue = 0;
-    photoControlCharacteristic->setValue(&controlValue, 1);
+    BleTransport::setValue(photoControlCharacteristic, &controlValue, 1);
     
     Serial.println("Photo characteristics created");
 }
 
-void createVideoCharacteristics(BLEService *videoService) {
+void createVideoCharacteristics(ble_handle_t videoService) {
     // Video data characteristic
-    videoDataCharacteristic = videoService->createCharacteristic(
-        videoDataUUID,
-        BLECharacteristic::PROPERTY_READ | BLECharacteristic::PROPERTY_NOTIFY
+    videoDataCharacteristic = BleTransport::createCharacteristic(
+        videoService, VIDEO_DATA_UUID,
+        BLE_PROPERTY_READ | BLE_PROPERTY_NOTIFY
     );
-    BLE2902 *ccc = new BLE2902();
-    ccc->setNotifications(true);
-    videoDataCharacteristic->addDescriptor(ccc);
 
     // Video control characteristic
-    videoControlCharacteristic = videoService->createCharacteristic(
-        videoControlUUID,
-        BLECharacteristic::PROPERTY_WRITE
+    videoControlCharacteristic = BleTransport::createCharacteristic(
+        videoService, VIDEO_CONTROL_UUID,
+        BLE_PROPERTY_WRITE,
+        onVideoControlWrite
     );
-    videoControlCharacteristic->setCallbacks(new VideoControlCallback());
     uint8_t videoControlValue = 0;
-    videoControlCharacteristic->setValue(&videoControlValue, 1);
+    BleTransport::setValue(videoControlCharacteristic, &videoControlValue, 1);
 
     // Video status characteristic
-    videoStatusCharacteristic = videoService->createCharacteristic(
-        videoStatusUUID,
-        BLECharacteristic::PROPERTY_READ | BLECharacteristic::PROPERTY_NOTIFY
+    videoStatusCharacteristic = BleTransport::createCharacteristic(
+        videoService, VIDEO_STATUS_UUID,
+        BLE_PROPERTY_READ | BLE_PROPERTY_NOTIFY
     );
-    ccc = new BLE2902();
-    ccc->setNotifications(true);
-    videoStatusCharacteristic->addDescriptor(ccc);
     
     Serial.println("Video characteristics created");
 }
 
-void createDeviceInfoCharacteristics(BLEService *deviceInfoService) {
+void createDeviceInfoCharacteristics(ble_handle_t deviceInfoService) {
     // Manufacturer name characteristic
-    manufacturerNameCharacteristic = deviceInfoService->createCharacteristic(
-        MANUFACTURER_NAME_STRING_CHAR_UUID,
-        BLECharacteristic::PROPERTY_READ
+    manufacturerNameCharacteristic = BleTransport::createCharacteristic(
+        deviceInfoService, MANUFACTURER_NAME_STRING_CHAR_UUID,
+        BLE_PROPERTY_READ
     );
     
     // Model number characteristic
-    modelNumberCharacteristic = deviceInfoService->createCharacteristic(
-        MODEL_NUMBER_STRING_CHAR_UUID,
-        BLECharacteristic::PROPERTY_READ
+    modelNumberCharacteristic = BleTransport::createCharacteristic(
+        deviceInfoService, MODEL_NUMBER_STRING_CHAR_UUID,
+        BLE_PROPERTY_READ
     );
     
     // Firmware revision characteristic
-    firmwareRevisionCharacteristic = deviceInfoService->createCharacteristic(
-        FIRMWARE_REVISION_STRING_CHAR_UUID,
-        BLECharacteristic::PROPERTY_READ
+    firmwareRevisionCharacteristic = BleTransport::createCharacteristic(
+        deviceInfoService, FIRMWARE_REVISION_STRING_CHAR_UUID,
+        BLE_PROPERTY_READ
     );
     
     // Hardware revision characteristic
-    hardwareRevisionCharacteristic = deviceInfoService->createCharacteristic(
-        HARDWARE_REVISION_STRING_CHAR_UUID,
-        BLECharacteristic::PROPERTY_READ
+    hardwareRevisionCharacteristic = BleTransport::createCharacteristic(
+        deviceInfoService, HARDWARE_REVISION_STRING_CHAR_UUID,
+        BLE_PROPERTY_READ
     );
 
     // Set values
-    manufacturerNameCharacteristic->setValue(MANUFACTURER_NAME);
-    modelNumberCharacteristic->setValue(MODEL_NUMBER);
-    firmwareRevisionCharacteristic->setValue(FIRMWARE_VERSION);
-    hardwareRevisionCharacteristic->setValue(HARDWARE_VERSION);
+    BleTransport::setValue(manufacturerNameCharacteristic, MANUFACTURER_NAME);
+    BleTransport::setValue(modelNumberCharacteristic, MODEL_NUMBER);
+    BleTransport::setValue(firmwareRevisionCharacteristic, FIRMWARE_VERSION);
+    BleTransport::setValue(hardwareRevisionCharacteristic, HARDWARE_VERSION);
     
     Serial.println("Device info characteristics created");
 }
 
 void updateVideoStatus() {
-    if (!videoStatusCharacteristic) return;
+    if (videoStatusCharacteristic == BLE_HANDLE_NONE) return;
     
     video_status_t status = {
-        .streaming = isStreamingVideo ? 1 : 0,
-        .fps = streamingFPS,
-        .frameCount = totalStreamingFrames,
-        .droppedFrames = droppedFrames
+        .streaming = (uint8_t)(DeviceLifecycle::isIn(LIFECYCLE_STREAMING) ? 1 : 0),
+        .fps = (uint8_t)streamingFPS,
+        .frameCount = (uint16_t)totalStreamingFrames,
+        .droppedFrames = (uint16_t)droppedFrames
     };
     
-    videoStatusCharacteristic->setValue((uint8_t*)&status, sizeof(status));
-    videoStatusCharacteristic->notify();
+    BleTransport::notify(videoStatusCharacteristic, (uint8_t*)&status, sizeof(status));
 }
 
 void notifyAudioData(uint8_t *data, size_t length) {
-    if (audioDataCharacteristic && bleConnected) {
-        audioDataCharacteristic->setValue(data, length);
-        audioDataCharacteristic->notify();
+    if (audioDataCharacteristic != BLE_HANDLE_NONE && bleConnected) {
+        BleTransport::notify(audioDataCharacteristic, data, length);
         
         // Record BLE data transmission
         // recordBLEDataTransmission(length);  // DISABLED: Causes BLE interference
     }
 }
 
-void notifyPhotoData(uint8_t *data, size_t length) {
-    if (photoDataCharacteristic && bleConnected) {
-        photoDataCharacteristic->setValue(data, length);
-        photoDataCharacteristic->notify();
-        
+bool notifyPhotoData(uint8_t *data, size_t length) {
+    if (photoDataCharacteristic != BLE_HANDLE_NONE && bleConnected) {
         // Record BLE data transmission
         // recordBLEDataTransmission(length);  // DISABLED: Causes BLE interference
+        return BleTransport::notify(photoDataCharacteristic, data, length);
     }
+    return false;
 }
 
 void notifyVideoData(uint8_t *data, size_t length) {
-    if (videoDataCharacteristic && bleConnected) {
-        videoDataCharacteristic->setValue(data, length);
-        videoDataCharacteristic->notify();
+    if (videoDataCharacteristic != BLE_HANDLE_NONE && bleConnected) {
+        BleTransport::notify(videoDataCharacteristic, data, length);
         
         // Record BLE data transmission
         // recordBLEDataTransmission(length);  // DISABLED: Causes BLE interference
     }
 }
 
-void createHotspotCharacteristics(BLEService *service) {
+void createHotspotCharacteristics(ble_handle_t service) {
     // Hotspot control characteristic
-    hotspotControlCharacteristic = service->createCharacteristic(
-        HOTSPOT_CONTROL_UUID,
-        BLECharacteristic::PROPERTY_WRITE
+    hotspotControlCharacteristic = BleTransport::createCharacteristic(
+        service, HOTSPOT_CONTROL_UUID,
+        BLE_PROPERTY_WRITE,
+        onHotspotControlWrite
     );
-    hotspotControlCharacteristic->setCallbacks(new HotspotControlCallback());
     uint8_t controlValue = 0;
-    hotspotControlCharacteristic->setValue(&controlValue, 1);
+    BleTransport::setValue(hotspotControlCharacteristic, &controlValue, 1);
 
     // Hotspot status characteristic
-    hotspotStatusCharacteristic = service->createCharacteristic(
-        HOTSPOT_STATUS_UUID,
-        BLECharacteristic::PROPERTY_READ | BLECharacteristic::PROPERTY_NOTIFY
+    hotspotStatusCharacteristic = BleTransport::createCharacteristic(
+        service, HOTSPOT_STATUS_UUID,
+        BLE_PROPERTY_READ | BLE_PROPERTY_NOTIFY
     );
-    BLE2902 *ccc = new BLE2902();
-    ccc->setNotifications(true);
-    hotspotStatusCharacteristic->addDescriptor(ccc);
     
     Serial.println("Hotspot characteristics created");
 }
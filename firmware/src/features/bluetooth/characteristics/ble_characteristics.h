@@ -1,50 +1,46 @@
 #pragma once
 
 #include <Arduino.h>
-#include <BLEDevice.h>
-#include <BLEServer.h>
-#include <BLEService.h>
-#include <BLECharacteristic.h>
-#include <BLE2902.h>
+#include "../ble_transport.h"
 #include "../services/ble_services.h"
 #include "../callbacks/callbacks.h"
 #include "../../../hal/constants.h"
 #include "../../camera/camera.h"
 
 // BLE Characteristics - Audio
-extern BLECharacteristic *audioDataCharacteristic;
-extern BLECharacteristic *audioCodecCharacteristic;
+extern ble_handle_t audioDataCharacteristic;
+extern ble_handle_t audioCodecCharacteristic;
 
 // BLE Characteristics - Photo
-extern BLECharacteristic *photoDataCharacteristic;
-extern BLECharacteristic *photoControlCharacteristic;
+extern ble_handle_t photoDataCharacteristic;
+extern ble_handle_t photoControlCharacteristic;
 
 // BLE Characteristics - Video
-extern BLECharacteristic *videoDataCharacteristic;
-extern BLECharacteristic *videoControlCharacteristic;
-extern BLECharacteristic *videoStatusCharacteristic;
+extern ble_handle_t videoDataCharacteristic;
+extern ble_handle_t videoControlCharacteristic;
+extern ble_handle_t videoStatusCharacteristic;
 
 // BLE Characteristics - Device Info
-extern BLECharacteristic *manufacturerNameCharacteristic;
-extern BLECharacteristic *modelNumberCharacteristic;
-extern BLECharacteristic *firmwareRevisionCharacteristic;
-extern BLECharacteristic *hardwareRevisionCharacteristic;
+extern ble_handle_t manufacturerNameCharacteristic;
+extern ble_handle_t modelNumberCharacteristic;
+extern ble_handle_t firmwareRevisionCharacteristic;
+extern ble_handle_t hardwareRevisionCharacteristic;
 
 // BLE Characteristics - Hotspot Control
-extern BLECharacteristic *hotspotControlCharacteristic;
-extern BLECharacteristic *hotspotStatusCharacteristic;
+extern ble_handle_t hotspotControlCharacteristic;
+extern ble_handle_t hotspotStatusCharacteristic;
 
 // Characteristic creation functions
-void createAudioCharacteristics(BLEService *service);
-void createPhotoCharacteristics(BLEService *service);
-void createVideoCharacteristics(BLEService *videoService);
-void createDeviceInfoCharacteristics(BLEService *deviceInfoService);
-void createHotspotCharacteristics(BLEService *service);
+void createAudioCharacteristics(ble_handle_t service);
+void createPhotoCharacteristics(ble_handle_t service);
+void createVideoCharacteristics(ble_handle_t videoService);
+void createDeviceInfoCharacteristics(ble_handle_t deviceInfoService);
+void createHotspotCharacteristics(ble_handle_t service);
 
 // Characteristic utility functions
 void updateVideoStatus();
 void notifyAudioData(uint8_t *data, size_t length);
-void notifyPhotoData(uint8_t *data, size_t length);
+bool notifyPhotoData(uint8_t *data, size_t length);     // false if not sent; send it again
 void notifyVideoData(uint8_t *data, size_t length);
 
 // Initialize all BLE characteristics
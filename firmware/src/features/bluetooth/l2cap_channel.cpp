@@ -0,0 +1,181 @@
+#include "l2cap_channel.h"
+#include "characteristics/ble_characteristics.h"
+#include "../../system/clock/timing.h"
+
+#ifdef L2CAP_BULK_CHANNEL
+
+#if BLE_BACKEND != BLE_BACKEND_NIMBLE
+#error "L2CAP_BULK_CHANNEL needs the NimBLE host (BLE_BACKEND_NIMBLE)"
+#endif
+#if !defined(CONFIG_BT_NIMBLE_L2CAP_COC_MAX_NUM) || CONFIG_BT_NIMBLE_L2CAP_COC_MAX_NUM < 1
+#error "L2CAP_BULK_CHANNEL needs CONFIG_BT_NIMBLE_L2CAP_COC_MAX_NUM >= 1"
+#endif
+
+#include "host/ble_hs.h"
+#include "host/ble_l2cap.h"
+#include "os/os_mbuf.h"
+
+// Channel state: written by the NimBLE host task, read by the loop task
+static struct ble_l2cap_chan* volatile channel = nullptr;
+static volatile bool stalled = false;
+static volatile bool expected = false;
+static volatile unsigned long expectedAt = 0;
+static volatile uint16_t sduSize = 0;
+
+// Counters for the report when the channel closes
+static uint32_t sdusSent = 0;
+static uint32_t stallCount = 0;
+static uint32_t refusedCount = 0;
+static unsigned long openedAt = 0;
+static uint64_t bytesSent = 0;
+
+// ===================================================================
+// EVENTS (NimBLE host task)
+// ===================================================================
+
+// Nothing is read from the channel, but the stack needs somewhere to put it
+static void giveReceiveBuffer(struct ble_l2cap_chan* chan) {
+    struct os_mbuf* sdu = os_msys_get_pkthdr(L2CAP_BULK_RX_MTU, 0);
+    if (sdu && ble_l2cap_recv_ready(chan, sdu) != 0) os_mbuf_free_chain(sdu);
+}
+
+static int onChannelEvent(struct ble_l2cap_event* event, void* arg) {
+    (void)arg;
+    switch (event->type) {
+        case BLE_L2CAP_EVENT_COC_ACCEPT:
+            // Only a client that asked on photo control gets the channel
+            if (!expected || getElapsedTime(expectedAt) > L2CAP_BULK_ACCEPT_MS || channel) {
+                Serial.println("L2CAP: connect refused (not requested with PHOTO_BULK_CHANNEL)");
+                return BLE_HS_EREJECT;
+            }
+            giveReceiveBuffer(event->accept.chan);
+            return 0;
+
+        case BLE_L2CAP_EVENT_COC_CONNECTED: {
+            expected = false;
+            if (event->connect.status != 0) {
+                Serial.printf("L2CAP: connect failed (%d)\n", event->connect.status);
+                return 0;
+            }
+            struct ble_l2cap_chan_info info;
+            if (ble_l2cap_get_chan_info(event->connect.chan, &info) != 0) return 0;
+            sduSize = info.peer_coc_mtu < L2CAP_BULK_SDU_SIZE ? info.peer_coc_mtu : L2CAP_BULK_SDU_SIZE;
+            stalled = false;
+            sdusSent = 0;
+            stallCount = 0;
+            refusedCount = 0;
+            bytesSent = 0;
+            openedAt = millis();
+            channel = event->connect.chan;
+            Serial.printf("L2CAP: channel open on PSM 0x%04X, %u-byte SDUs (client MTU %u, MPS %u)\n",
+                          L2CAP_BULK_PSM, sduSize, info.peer_coc_mtu, info.peer_l2cap_mtu);
+            return 0;
+        }
+
+        case BLE_L2CAP_EVENT_COC_DISCONNECTED: {
+            if (event->disconnect.chan != channel) return 0;
+            channel = nullptr;
+            stalled = false;
+            unsigned long elapsed = getElapsedTime(openedAt);
+            Serial.printf("L2CAP: channel closed after %lu SDUs, %llu bytes (%.1f KB/s), %lu credit stalls, "
+                          "%lu sends turned down; photos back on GATT\n",
+                          (unsigned long)sdusSent, (unsigned long long)bytesSent,
+                          elapsed ? bytesSent / (double)elapsed : 0.0, (unsigned long)stallCount,
+                          (unsigned long)refusedCount);
+            return 0;
+        }
+
+        case BLE_L2CAP_EVENT_COC_TX_UNSTALLED:
+            stalled = false;
+            return 0;
+
+        case BLE_L2CAP_EVENT_COC_DATA_RECEIVED:
+            if (event->receive.sdu_rx) os_mbuf_free_chain(event->receive.sdu_rx);
+            giveReceiveBuffer(event->receive.chan);
+            return 0;
+
+        default:
+            return 0;
+    }
+}
+
+// ===================================================================
+// CHANNEL
+// ===================================================================
+
+namespace L2capChannel {
+    void initialize() {
+        int rc = ble_l2cap_create_server(L2CAP_BULK_PSM, L2CAP_BULK_RX_MTU, onChannelEvent, nullptr);
+        if (rc != 0) {
+            Serial.printf("L2CAP: cannot listen on PSM 0x%04X (%d)\n", L2CAP_BULK_PSM, rc);
+            return;
+        }
+        Serial.printf("L2CAP: bulk channel server on PSM 0x%04X\n", L2CAP_BULK_PSM);
+    }
+
+    void expect() {
+        expectedAt = millis();
+        expected = true;
+        Serial.printf("L2CAP: accepting a connect on PSM 0x%04X for %d ms\n", L2CAP_BULK_PSM, L2CAP_BULK_ACCEPT_MS);
+    }
+
+    bool isOpen() {
+        return channel != nullptr;
+    }
+}
+
+bool sendPhotoFrame(uint8_t* frame, size_t length) {
+    struct ble_l2cap_chan* chan = channel;
+    if (!chan) {
+        // Sized for a channel that has closed since: the caller chunks it again
+        if (length > PHOTO_CHUNK_SIZE + BLE_FRAME_HEADER_SIZE) return false;
+        return notifyPhotoData(frame, length);
+    }
+    if (stalled) return false;
+
+    // Copied into mbufs: the frame buffer can be reused straight away
+    struct os_mbuf* sdu = os_msys_get_pkthdr(length, 0);
+    if (!sdu) {
+        refusedCount++;
+        return false;
+    }
+    if (os_mbuf_append(sdu, frame, length) != 0) {
+        os_mbuf_free_chain(sdu);
+        refusedCount++;
+        return false;
+    }
+
+    // ESTALLED: taken, but waiting for credits. Set first: COC_TX_UNSTALLED
+    // may come before ble_l2cap_send() returns
+    stalled = true;
+    int rc = ble_l2cap_send(chan, sdu);
+    if (rc == BLE_HS_ESTALLED) {
+        stallCount++;
+    } else if (rc != 0) {
+        stalled = false;
+        os_mbuf_free_chain(sdu);
+        refusedCount++;
+        return false;
+    } else {
+        stalled = false;
+    }
+    sdusSent++;
+    bytesSent += length;
+    return true;
+}
+
+size_t photoFrameChunkSize() {
+    return channel ? sduSize - BLE_FRAME_HEADER_SIZE : PHOTO_CHUNK_SIZE;
+}
+
+#else
+
+bool sendPhotoFrame(uint8_t* frame, size_t length) {
+    return notifyPhotoData(frame, length);
+}
+
+size_t photoFrameChunkSize() {
+    return PHOTO_CHUNK_SIZE;
+}
+
+#endif // L2CAP_BULK_CHANNEL
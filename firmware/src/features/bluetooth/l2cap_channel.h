@@ -0,0 +1,61 @@
+#pragma once
+
+#include <Arduino.h>
+#include "ble_frame_format.h"
+#include "../../hal/constants.h"
+
+// ===================================================================
+// L2CAP BULK CHANNEL
+// ===================================================================
+//
+// With L2CAP_BULK_CHANNEL defined, photos, scanned codes and the
+// duty-cycle backlog go over an LE credit-based L2CAP channel when the
+// client has opened one, and as photo data notifications otherwise. The
+// client asks by writing PHOTO_BULK_CHANNEL to photo control and then
+// connects to L2CAP_BULK_PSM; connect requests that were not asked for
+// are refused. Closing the channel (or the link) falls back to GATT.
+//
+// Every SDU is one ble_frame_format.h frame, so clients reassemble the
+// same way; a frame carries up to L2CAP_BULK_SDU_SIZE bytes (or the
+// client's SDU MTU) instead of PHOTO_CHUNK_SIZE. The NimBLE host does the
+// segmentation and credits (modelled in public/host/l2cap/l2cap_bulk.h).
+// When the client's credits run out the SDU waits in the stack, and the next
+// sendPhotoFrame() is turned down until they come back: the caller sends
+// the same frame again on its next pass instead of blocking the loop.
+//
+
+#ifdef L2CAP_BULK_CHANNEL
+#define PHOTO_FRAME_MAX_SIZE L2CAP_BULK_SDU_SIZE
+#else
+#define PHOTO_FRAME_MAX_SIZE (PHOTO_CHUNK_SIZE + BLE_FRAME_HEADER_SIZE)
+#endif
+
+/**
+ * Send a frame of the photo stream on the channel, or notify it
+ * @return false if the channel or the BLE stack cannot take it yet; send
+ *         it again later
+ */
+bool sendPhotoFrame(uint8_t* frame, size_t length);
+
+/**
+ * Photo bytes per frame on the current path (at most
+ * PHOTO_FRAME_MAX_SIZE - BLE_FRAME_HEADER_SIZE)
+ */
+size_t photoFrameChunkSize();
+
+#ifdef L2CAP_BULK_CHANNEL
+namespace L2capChannel {
+    /**
+     * Register the server on L2CAP_BULK_PSM (after the BLE stack is up)
+     */
+    void initialize();
+
+    /**
+     * Photo control asked for the channel: accept a connect within
+     * L2CAP_BULK_ACCEPT_MS (BLE task)
+     */
+    void expect();
+
+    bool isOpen();
+}
+#endif
@@ -0,0 +1,374 @@
+#include "block_codec.h"
+#include "image_kernels.h"
+#include <string.h>
+
+// ===================================================================
+// TABLES
+// ===================================================================
+
+// round(4096 * c(k) * cos((2n + 1) k pi / 16)), c(0) = sqrt(1/8), c(k) = 1/2
+static const int32_t DCT_MATRIX[8][8] = {
+    { 1448,  1448,  1448,  1448,  1448,  1448,  1448,  1448},
+    { 2009,  1703,  1138,   400,  -400, -1138, -1703, -2009},
+    { 1892,   784,  -784, -1892, -1892,  -784,   784,  1892},
+    { 1703,  -400, -2009, -1138,  1138,  2009,   400, -1703},
+    { 1448, -1448, -1448,  1448,  1448, -1448, -1448,  1448},
+    { 1138, -2009,   400,  1703, -1703,  -400,  2009, -1138},
+    {  784, -1892,  1892,  -784,  -784,  1892, -1892,   784},
+    {  400, -1138,  1703, -2009,  2009, -1703,  1138,  -400},
+};
+
+// Matrix is Q12: the first pass keeps 3 fractional bits, the second drops the rest
+#define DCT_PASS1_SHIFT 9
+#define DCT_PASS2_SHIFT 15
+
+// JPEG Annex K luminance table, row-major
+static const uint8_t LUMINANCE_QUANT[64] = {
+    16, 11, 10, 16,  24,  40,  51,  61,
+    12, 12, 14, 19,  26,  58,  60,  55,
+    14, 13, 16, 24,  40,  57,  69,  56,
+    14, 17, 22, 29,  51,  87,  80,  62,
+    18, 22, 37, 56,  68, 109, 103,  77,
+    24, 35, 55, 64,  81, 104, 113,  92,
+    49, 64, 78, 87, 103, 121, 120, 101,
+    72, 92, 95, 98, 112, 100, 103,  99,
+};
+
+// Zigzag position -> row-major index
+static const uint8_t ZIGZAG[64] = {
+     0,  1,  8, 16,  9,  2,  3, 10,
+    17, 24, 32, 25, 18, 11,  4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34,
+    27, 20, 13,  6,  7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36,
+    29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46,
+    53, 60, 61, 54, 47, 55, 62, 63,
+};
+
+#define BLOCK_END_OF_BLOCK 63
+#define BLOCK_COEFFICIENT_LIMIT 2047   // Dequantized values are clamped here (keeps the IDCT in int32)
+#define BLOCK_MID_GRAY 128
+
+static inline int32_t roundShift(int32_t value, int shift) {
+    return (value + (1 << (shift - 1))) >> shift;
+}
+
+static inline int32_t clampCoefficient(int32_t value) {
+    if (value > BLOCK_COEFFICIENT_LIMIT) return BLOCK_COEFFICIENT_LIMIT;
+    if (value < -BLOCK_COEFFICIENT_LIMIT) return -BLOCK_COEFFICIENT_LIMIT;
+    return value;
+}
+
+// ===================================================================
+// KERNELS
+// ===================================================================
+
+uint32_t blockSad16(const uint8_t* a, const uint8_t* b, size_t stride) {
+    return imageSad16(a, b, stride);
+}
+
+void blockForwardDct8(const uint8_t* pixels, size_t stride, int32_t out[64]) {
+    // Rows: tmp[u][y] = sum_x C[u][x] * p[y][x]
+    int32_t tmp[8][8];
+    for (int y = 0; y < 8; y++) {
+        const uint8_t* row = pixels + y * stride;
+        int32_t p[8];
+        for (int x = 0; x < 8; x++) p[x] = (int32_t)row[x] - BLOCK_MID_GRAY;
+        for (int u = 0; u < 8; u++) {
+            int32_t sum = 0;
+            for (int x = 0; x < 8; x++) sum += DCT_MATRIX[u][x] * p[x];
+            tmp[u][y] = roundShift(sum, DCT_PASS1_SHIFT);
+        }
+    }
+    // Columns: out[v][u] = sum_y C[v][y] * tmp[u][y]
+    for (int v = 0; v < 8; v++) {
+        for (int u = 0; u < 8; u++) {
+            int32_t sum = 0;
+            for (int y = 0; y < 8; y++) sum += DCT_MATRIX[v][y] * tmp[u][y];
+            out[v * 8 + u] = roundShift(sum, DCT_PASS2_SHIFT);
+        }
+    }
+}
+
+void blockInverseDct8(const int32_t coefficients[64], uint8_t* pixels, size_t stride) {
+    // Columns: tmp[y][u] = sum_v C[v][y] * F[v][u]
+    int32_t tmp[8][8];
+    for (int y = 0; y < 8; y++) {
+        for (int u = 0; u < 8; u++) {
+            int32_t sum = 0;
+            for (int v = 0; v < 8; v++) sum += DCT_MATRIX[v][y] * coefficients[v * 8 + u];
+            tmp[y][u] = roundShift(sum, DCT_PASS1_SHIFT);
+        }
+    }
+    // Rows: p[y][x] = sum_u C[u][x] * tmp[y][u]
+    for (int y = 0; y < 8; y++) {
+        uint8_t* row = pixels + y * stride;
+        for (int x = 0; x < 8; x++) {
+            int32_t sum = 0;
+            for (int u = 0; u < 8; u++) sum += DCT_MATRIX[u][x] * tmp[y][u];
+            int32_t value = roundShift(sum, DCT_PASS2_SHIFT) + BLOCK_MID_GRAY;
+            row[x] = (uint8_t)(value < 0 ? 0 : (value > 255 ? 255 : value));
+        }
+    }
+}
+
+void blockQuantTable(uint8_t quality, uint16_t table[64]) {
+    if (quality < 1) quality = 1;
+    if (quality > 100) quality = 100;
+    int32_t scale = quality < 50 ? 5000 / quality : 200 - quality * 2;
+    for (int i = 0; i < 64; i++) {
+        int32_t q = (LUMINANCE_QUANT[i] * scale + 50) / 100;
+        table[i] = (uint16_t)(q < 1 ? 1 : (q > 255 ? 255 : q));
+    }
+}
+
+size_t blockFrameMaxSize(uint16_t width, uint16_t height) {
+    size_t blocks = (size_t)(width / BLOCK_SIZE) * (height / BLOCK_SIZE);
+    return BLOCK_FRAME_HEADER_SIZE + (blocks + 7) / 8 + blocks * BLOCK_MAX_CODED_SIZE;
+}
+
+// ===================================================================
+// COEFFICIENT CODING
+// ===================================================================
+
+static inline size_t putVarint(uint8_t* out, int32_t value) {
+    uint32_t zigzag = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+    size_t n = 0;
+    while (zigzag >= 0x80) {
+        out[n++] = (uint8_t)(zigzag | 0x80);
+        zigzag >>= 7;
+    }
+    out[n++] = (uint8_t)zigzag;
+    return n;
+}
+
+static inline bool getVarint(const uint8_t* data, size_t length, size_t* pos, int32_t* value) {
+    uint32_t zigzag = 0;
+    for (int shift = 0; shift < 32; shift += 7) {
+        if (*pos >= length) return false;
+        uint8_t byte = data[(*pos)++];
+        zigzag |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Quantize, code and reconstruct one 8x8 (reconstructs into recon)
+ * @return Bytes written
+ */
+static size_t encodeBlock8(const uint8_t* pixels, uint8_t* recon, size_t stride, const uint16_t quant[64],
+                           int32_t* previousDc, uint8_t* out) {
+    int32_t coefficients[64];
+    blockForwardDct8(pixels, stride, coefficients);
+
+    int32_t levels[64];
+    for (int i = 0; i < 64; i++) {
+        int32_t c = coefficients[i];
+        int32_t q = quant[i];
+        levels[i] = c >= 0 ? (c + q / 2) / q : -((-c + q / 2) / q);
+    }
+
+    size_t n = putVarint(out, levels[0] - *previousDc);
+    *previousDc = levels[0];
+    int run = 0;
+    for (int k = 1; k < 64; k++) {
+        int32_t level = levels[ZIGZAG[k]];
+        if (level == 0) {
+            run++;
+            continue;
+        }
+        out[n++] = (uint8_t)run;
+        n += putVarint(out + n, level);
+        run = 0;
+    }
+    out[n++] = BLOCK_END_OF_BLOCK;
+
+    // What the decoder will show
+    for (int i = 0; i < 64; i++) coefficients[i] = clampCoefficient(levels[i] * quant[i]);
+    blockInverseDct8(coefficients, recon, stride);
+    return n;
+}
+
+static bool decodeBlock8(const uint8_t* data, size_t length, size_t* pos, const uint16_t quant[64],
+                         int32_t* previousDc, uint8_t* pixels, size_t stride) {
+    int32_t coefficients[64];
+    memset(coefficients, 0, sizeof(coefficients));
+
+    int32_t delta;
+    if (!getVarint(data, length, pos, &delta)) return false;
+    if (delta > 2 * BLOCK_COEFFICIENT_LIMIT || delta < -2 * BLOCK_COEFFICIENT_LIMIT) return false;
+    *previousDc += delta;
+    if (*previousDc > BLOCK_COEFFICIENT_LIMIT || *previousDc < -BLOCK_COEFFICIENT_LIMIT) return false;
+    coefficients[0] = clampCoefficient(*previousDc * quant[0]);
+
+    int k = 1;
+    for (;;) {
+        if (*pos >= length) return false;
+        uint8_t run = data[(*pos)++];
+        if (run == BLOCK_END_OF_BLOCK) break;
+        k += run;
+        if (k > 63) return false;
+        int32_t level;
+        if (!getVarint(data, length, pos, &level)) return false;
+        if (level > BLOCK_COEFFICIENT_LIMIT || level < -BLOCK_COEFFICIENT_LIMIT) return false;
+        coefficients[ZIGZAG[k]] = clampCoefficient(level * quant[ZIGZAG[k]]);
+        k++;
+    }
+
+    blockInverseDct8(coefficients, pixels, stride);
+    return true;
+}
+
+static bool validSize(uint16_t width, uint16_t height) {
+    return width >= BLOCK_SIZE && height >= BLOCK_SIZE && width <= BLOCK_MAX_WIDTH && height <= BLOCK_MAX_HEIGHT &&
+           width % BLOCK_SIZE == 0 && height % BLOCK_SIZE == 0;
+}
+
+// ===================================================================
+// ENCODER
+// ===================================================================
+
+BlockEncoder::BlockEncoder() : reference(nullptr), blocksX(0), blocksY(0) {
+    memset(&config, 0, sizeof(config));
+    resetStats();
+}
+
+bool BlockEncoder::begin(const block_codec_config_t& newConfig, uint8_t* referenceBuffer) {
+    if (!referenceBuffer || !validSize(newConfig.width, newConfig.height)) return false;
+
+    config = newConfig;
+    reference = referenceBuffer;
+    blocksX = config.width / BLOCK_SIZE;
+    blocksY = config.height / BLOCK_SIZE;
+    blockQuantTable(config.quality, quant);
+    memset(reference, BLOCK_MID_GRAY, (size_t)config.width * config.height);
+    frameNumber = 0;
+    sinceKey = 0;
+    keyRequested = true;
+    memset(pending, 0, sizeof(pending));
+    return true;
+}
+
+void BlockEncoder::requestKeyFrame() {
+    keyRequested = true;
+}
+
+void BlockEncoder::resetStats() {
+    memset(&counters, 0, sizeof(counters));
+}
+
+size_t BlockEncoder::encode(const uint8_t* frame, uint8_t* out, size_t capacity) {
+    if (!reference || !frame || !out) return 0;
+
+    size_t blocks = (size_t)blocksX * blocksY;
+    size_t bitmapSize = (blocks + 7) / 8;
+    if (capacity < BLOCK_FRAME_HEADER_SIZE + bitmapSize) return 0;
+
+    bool key = keyRequested || (config.refresh_frames > 0 && sinceKey >= config.refresh_frames);
+    if (key) {
+        memset(pending, 0xFF, bitmapSize);
+        keyRequested = false;
+        sinceKey = 0;
+    }
+
+    uint8_t* bitmap = out + BLOCK_FRAME_HEADER_SIZE;
+    memset(bitmap, 0, bitmapSize);
+    size_t pos = BLOCK_FRAME_HEADER_SIZE + bitmapSize;
+    size_t stride = config.width;
+    int32_t previousDc = 0;
+    uint32_t deferred = 0;
+
+    for (size_t i = 0; i < blocks; i++) {
+        size_t offset = (i / blocksX) * BLOCK_SIZE * stride + (i % blocksX) * BLOCK_SIZE;
+        bool forced = pending[i / 8] & (1 << (i % 8));
+        if (!forced && blockSad16(frame + offset, reference + offset, stride) <= config.sad_threshold) continue;
+
+        if (capacity - pos < BLOCK_MAX_CODED_SIZE) {
+            deferred++;
+            continue;
+        }
+
+        for (int sub = 0; sub < 4; sub++) {
+            size_t subOffset = offset + (sub / 2) * 8 * stride + (sub % 2) * 8;
+            pos += encodeBlock8(frame + subOffset, reference + subOffset, stride, quant, &previousDc, out + pos);
+        }
+        bitmap[i / 8] |= (uint8_t)(1 << (i % 8));
+        pending[i / 8] &= (uint8_t)~(1 << (i % 8));
+        counters.blocks_sent++;
+    }
+
+    // A key frame cut short finishes in the next frames and is not marked
+    bool complete = key && deferred == 0;
+    out[0] = BLOCK_FRAME_MAGIC;
+    out[1] = complete ? BLOCK_FRAME_KEY : 0;
+    out[2] = frameNumber & 0xFF;
+    out[3] = (frameNumber >> 8) & 0xFF;
+    out[4] = (uint8_t)blocksX;
+    out[5] = (uint8_t)blocksY;
+    out[6] = config.quality;
+    out[7] = 0;
+
+    frameNumber++;
+    sinceKey++;
+    counters.frames++;
+    if (complete) counters.key_frames++;
+    counters.blocks += blocks;
+    counters.blocks_deferred += deferred;
+    counters.bytes += pos;
+    return pos;
+}
+
+// ===================================================================
+// DECODER
+// ===================================================================
+
+BlockDecoder::BlockDecoder() : width(0), height(0), frame(nullptr), quality(0), keyed(false), lastFrame(0) {}
+
+bool BlockDecoder::begin(uint16_t frameWidth, uint16_t frameHeight, uint8_t* frameBuffer) {
+    if (!frameBuffer || !validSize(frameWidth, frameHeight)) return false;
+    width = frameWidth;
+    height = frameHeight;
+    frame = frameBuffer;
+    quality = 0;
+    keyed = false;
+    lastFrame = 0;
+    memset(frame, BLOCK_MID_GRAY, (size_t)width * height);
+    return true;
+}
+
+bool BlockDecoder::decode(const uint8_t* data, size_t length) {
+    if (!frame || !data || length < BLOCK_FRAME_HEADER_SIZE || data[0] != BLOCK_FRAME_MAGIC) return false;
+
+    uint16_t blocksX = width / BLOCK_SIZE;
+    uint16_t blocksY = height / BLOCK_SIZE;
+    if (data[4] != blocksX || data[5] != blocksY || data[6] == 0 || data[6] > 100) return false;
+    size_t blocks = (size_t)blocksX * blocksY;
+    size_t bitmapSize = (blocks + 7) / 8;
+    if (length < BLOCK_FRAME_HEADER_SIZE + bitmapSize) return false;
+
+    if (data[6] != quality) {
+        quality = data[6];
+        blockQuantTable(quality, quant);
+    }
+
+    const uint8_t* bitmap = data + BLOCK_FRAME_HEADER_SIZE;
+    size_t pos = BLOCK_FRAME_HEADER_SIZE + bitmapSize;
+    int32_t previousDc = 0;
+    for (size_t i = 0; i < blocks; i++) {
+        if (!(bitmap[i / 8] & (1 << (i % 8)))) continue;
+        size_t offset = (i / blocksX) * BLOCK_SIZE * width + (i % blocksX) * BLOCK_SIZE;
+        for (int sub = 0; sub < 4; sub++) {
+            size_t subOffset = offset + (sub / 2) * 8 * width + (sub % 2) * 8;
+            if (!decodeBlock8(data, length, &pos, quant, &previousDc, frame + subOffset, width)) return false;
+        }
+    }
+
+    if (data[1] & BLOCK_FRAME_KEY) keyed = true;
+    lastFrame = data[2] | (data[3] << 8);
+    return pos == length;
+}
@@ -0,0 +1,178 @@
+#ifndef BLOCK_CODEC_H
+#define BLOCK_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ===================================================================
+// BLOCK CODEC (conditional replenishment)
+// ===================================================================
+//
+// Grayscale video in 16x16 blocks. The encoder keeps the picture the
+// client has (its reference) and each frame sends only the blocks whose
+// sum of absolute differences (SAD) from it exceeds a threshold. A block
+// is four 8x8 DCTs quantized with the JPEG luminance table, so a desk
+// that does not move costs a few bytes of bitmap per frame. Key frames
+// (all blocks) go out every refresh_frames frames for clients that joined
+// late or lost a frame.
+//
+// The reference is updated from the quantized coefficients, exactly as
+// BlockDecoder does, so encoder and client never drift apart.
+//
+// Frame (sent as BLE_FRAME_TYPE_BLOCKS images, see ble_frame_format.h):
+//
+//   [0xB1, flags, frame_lo, frame_hi, blocks_x, blocks_y, quality, 0]
+//   bitmap: one bit per block in raster order, LSB first
+//   per set bit, the four 8x8s (top left, top right, bottom left,
+//   bottom right), each:
+//     DC - previous DC in the frame         signed varint
+//     (zeros before, level)*                byte 0..62, signed varint
+//     63                                    end of block
+//
+// Signed varints are zigzag-mapped LEB128.
+//
+// The SAD is imageSad16() (image_kernels.h); the DCTs are plain
+// fixed-size loops over int32 with no data-dependent branches, so
+// compilers vectorize them. tools/block_bench times them on the host. No
+// Arduino dependencies.
+//
+
+#define BLOCK_FRAME_MAGIC 0xB1
+#define BLOCK_FRAME_HEADER_SIZE 8
+#define BLOCK_FRAME_KEY 0x01           // Every block is in this frame
+
+#define BLOCK_SIZE 16
+#define BLOCK_MAX_WIDTH 640
+#define BLOCK_MAX_HEIGHT 480
+#define BLOCK_MAX_BLOCKS ((BLOCK_MAX_WIDTH / BLOCK_SIZE) * (BLOCK_MAX_HEIGHT / BLOCK_SIZE))
+
+// Largest coded 16x16 block: 4 x (DC + 63 x (run + level) + end of block)
+#define BLOCK_MAX_CODED_SIZE (4 * (3 + 63 * 3 + 1))
+
+typedef struct {
+    uint16_t width;                 // Multiple of 16, at most BLOCK_MAX_WIDTH
+    uint16_t height;                // Multiple of 16, at most BLOCK_MAX_HEIGHT
+    uint8_t quality;                // 1-100, as JPEG
+    uint32_t sad_threshold;         // Per 16x16 block (256 pixels)
+    uint16_t refresh_frames;        // Key frame at least this often (0: first frame only)
+} block_codec_config_t;
+
+typedef struct {
+    uint32_t frames;
+    uint32_t key_frames;
+    uint32_t blocks;                // Blocks looked at
+    uint32_t blocks_sent;
+    uint32_t blocks_deferred;       // Changed but out of room, sent later
+    uint64_t bytes;
+} block_codec_stats_t;
+
+// ===================================================================
+// KERNELS
+// ===================================================================
+
+/**
+ * Sum of absolute differences of two 16x16 blocks
+ * @param stride Bytes per row of both images
+ */
+uint32_t blockSad16(const uint8_t* a, const uint8_t* b, size_t stride);
+
+/**
+ * 8x8 forward DCT (orthonormal, fixed point) of pixels - 128
+ * @param out Coefficients in row-major order, DC first
+ */
+void blockForwardDct8(const uint8_t* pixels, size_t stride, int32_t out[64]);
+
+/**
+ * 8x8 inverse DCT, + 128 and clamped to 0-255
+ */
+void blockInverseDct8(const int32_t coefficients[64], uint8_t* pixels, size_t stride);
+
+/**
+ * JPEG luminance quantization table scaled for quality (libjpeg's
+ * formula), row-major
+ */
+void blockQuantTable(uint8_t quality, uint16_t table[64]);
+
+/**
+ * Largest frame encode() can write for a frame size
+ */
+size_t blockFrameMaxSize(uint16_t width, uint16_t height);
+
+// ===================================================================
+// ENCODER / DECODER
+// ===================================================================
+
+class BlockEncoder {
+public:
+    BlockEncoder();
+
+    /**
+     * @param reference width x height bytes the encoder keeps the client's
+     *        picture in (caller-owned, e.g. PSRAM); set to mid gray
+     * @return false if the configuration is out of range
+     */
+    bool begin(const block_codec_config_t& config, uint8_t* reference);
+
+    /**
+     * Send every block in the next frame
+     */
+    void requestKeyFrame();
+
+    /**
+     * Encode one grayscale frame (width x height bytes, no row padding)
+     * @param capacity Room in out; blocks that do not fit wait for the
+     *        next frame (blockFrameMaxSize() always fits)
+     * @return Bytes written (0 if capacity cannot hold the header and bitmap)
+     */
+    size_t encode(const uint8_t* frame, uint8_t* out, size_t capacity);
+
+    const uint8_t* getReference() const { return reference; }
+    const block_codec_config_t& getConfig() const { return config; }
+    const block_codec_stats_t& stats() const { return counters; }
+    void resetStats();
+
+private:
+    block_codec_config_t config;
+    uint8_t* reference;
+    uint16_t quant[64];
+    uint16_t blocksX;
+    uint16_t blocksY;
+    uint16_t frameNumber;
+    uint16_t sinceKey;
+    bool keyRequested;
+    uint8_t pending[BLOCK_MAX_BLOCKS / 8];     // Key frame blocks still to send
+    block_codec_stats_t counters;
+};
+
+class BlockDecoder {
+public:
+    BlockDecoder();
+
+    /**
+     * @param frame width x height bytes the picture is kept in; set to mid gray
+     */
+    bool begin(uint16_t width, uint16_t height, uint8_t* frame);
+
+    /**
+     * Apply one frame
+     * @return false if it is malformed or for another frame size (blocks
+     *         before the error are applied)
+     */
+    bool decode(const uint8_t* data, size_t length);
+
+    /** Whether a key frame arrived since begin() */
+    bool hasKeyFrame() const { return keyed; }
+
+    uint16_t lastFrameNumber() const { return lastFrame; }
+
+private:
+    uint16_t width;
+    uint16_t height;
+    uint8_t* frame;
+    uint8_t quality;
+    uint16_t quant[64];
+    bool keyed;
+    uint16_t lastFrame;
+};
+
+#endif // BLOCK_CODEC_H
@@ -0,0 +1,168 @@
+#include "block_video.h"
+#include "camera.h"
+#include "../bluetooth/ble_data_handler.h"
+#include "../../system/clock/timing.h"
+#include "../../system/clock/profiler.h"
+#include "../../system/memory/memory_utils.h"
+
+// ===================================================================
+// STATE
+// ===================================================================
+
+static BlockEncoder encoder;
+static bool active = false;
+static bool encoderReady = false;
+static uint8_t* reference = nullptr;        // Encoder reference, allocated at the first frame
+static uint8_t* coded = nullptr;            // Coded frame being sent
+static size_t codedLength = 0;
+static size_t codedSent = 0;
+static uint16_t chunkIndex = 0;
+
+// ===================================================================
+// STREAM
+// ===================================================================
+
+namespace BlockVideo {
+    bool begin() {
+        if (active) return true;
+
+        coded = (uint8_t*)SAFE_ALLOCATE(VIDEO_BLOCK_BUFFER_SIZE, MEM_PREFER_PSRAM, "BlockVideoFrame");
+        if (!coded) {
+            Serial.println("Block video: no memory for the frame buffer");
+            return false;
+        }
+        if (!configure_camera_for_blocks()) {
+            SAFE_FREE(coded);
+            coded = nullptr;
+            Serial.println("Block video: grayscale camera not available");
+            return false;
+        }
+
+        encoder.resetStats();
+        encoderReady = false;
+        codedLength = 0;
+        codedSent = 0;
+        active = true;
+        Serial.println("Block video started");
+        return true;
+    }
+
+    void end() {
+        if (!active) return;
+        active = false;
+        encoderReady = false;
+        SAFE_FREE(coded);
+        coded = nullptr;
+        if (reference) {
+            SAFE_FREE(reference);
+            reference = nullptr;
+        }
+        codedLength = 0;
+        codedSent = 0;
+        restore_camera_jpeg();
+        Serial.printf("Block video stopped: %u frames, %u of %u blocks sent\n",
+                      encoder.stats().frames, encoder.stats().blocks_sent, encoder.stats().blocks);
+    }
+
+    bool isActive() {
+        return active;
+    }
+
+    void requestKeyFrame() {
+        encoder.requestKeyFrame();
+    }
+
+    const block_codec_stats_t* getStats() {
+        return &encoder.stats();
+    }
+
+    /**
+     * Size the encoder from the first frame (16x16 blocks; leftover rows
+     * at the bottom are not coded)
+     */
+    static bool setupEncoder(const camera_fb_t* frame) {
+        block_codec_config_t config;
+        config.width = (uint16_t)(frame->width / BLOCK_SIZE * BLOCK_SIZE);
+        config.height = (uint16_t)(frame->height / BLOCK_SIZE * BLOCK_SIZE);
+        config.quality = VIDEO_BLOCK_QUALITY;
+        config.sad_threshold = VIDEO_BLOCK_SAD_THRESHOLD;
+        config.refresh_frames = VIDEO_BLOCK_REFRESH_FRAMES;
+        if (config.width != frame->width || config.height == 0) {
+            Serial.printf("Block video: %dx%d frames cannot be coded\n", frame->width, frame->height);
+            return false;
+        }
+
+        reference = (uint8_t*)SAFE_ALLOCATE((size_t)config.width * config.height, MEM_PREFER_PSRAM,
+                                            "BlockVideoReference");
+        if (!reference || !encoder.begin(config, reference)) {
+            Serial.println("Block video: encoder setup failed");
+            if (reference) SAFE_FREE(reference);
+            reference = nullptr;
+            return false;
+        }
+        Serial.printf("Block video: %dx%d in %dx%d blocks, quality %d\n", config.width, config.height,
+                      config.width / BLOCK_SIZE, config.height / BLOCK_SIZE, config.quality);
+        encoderReady = true;
+        return true;
+    }
+
+    static void captureFrame() {
+        camera_fb_t* frame = esp_camera_fb_get();
+        if (!frame) {
+            droppedFrames++;
+            return;
+        }
+        if (frame->format != PIXFORMAT_GRAYSCALE || (!encoderReady && !setupEncoder(frame))) {
+            esp_camera_fb_return(frame);
+            droppedFrames++;
+            return;
+        }
+        if (frame->len < (size_t)encoder.getConfig().width * encoder.getConfig().height) {
+            esp_camera_fb_return(frame);
+            droppedFrames++;
+            return;
+        }
+
+        {
+            PROFILE_SCOPE("block_encode");
+            codedLength = encoder.encode(frame->buf, coded, VIDEO_BLOCK_BUFFER_SIZE);
+        }
+        esp_camera_fb_return(frame);
+        codedSent = 0;
+        chunkIndex = 0;
+    }
+
+    void update() {
+        if (!active) return;
+
+        // Current frame: one chunk per run, then the end marker
+        if (codedLength > 0) {
+            if (codedSent < codedLength) {
+                uint8_t chunk[PHOTO_CHUNK_SIZE + BLE_FRAME_HEADER_SIZE];
+                size_t length = min(codedLength - codedSent, (size_t)PHOTO_CHUNK_SIZE);
+                bleWriteFrameHeader(chunk, chunkIndex++, BLE_FRAME_TYPE_BLOCKS);
+                memcpy(&chunk[BLE_FRAME_HEADER_SIZE], coded + codedSent, length);
+                notifyVideoData(chunk, length + BLE_FRAME_HEADER_SIZE);
+                codedSent += length;
+                return;
+            }
+            uint8_t endMarker[BLE_FRAME_HEADER_SIZE];
+            bleWriteEndMarker(endMarker, BLE_FRAME_TYPE_BLOCKS);
+            notifyVideoData(endMarker, sizeof(endMarker));
+            codedLength = 0;
+            totalStreamingFrames++;
+            return;
+        }
+
+        if (getElapsedTime(lastStreamFrame) < (unsigned long)VIDEO_STREAM_FRAME_INTERVAL(streamingFPS)) return;
+        lastStreamFrame = measureStart();
+        captureFrame();
+    }
+
+    void printStatus() {
+        const block_codec_stats_t& s = encoder.stats();
+        Serial.printf("Block video: %s, %u frames (%u key), %u/%u blocks sent, %u deferred, %llu bytes\n",
+                      active ? "active" : "stopped", s.frames, s.key_frames, s.blocks_sent, s.blocks,
+                      s.blocks_deferred, (unsigned long long)s.bytes);
+    }
+}
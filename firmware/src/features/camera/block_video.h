@@ -0,0 +1,49 @@
+#pragma once
+
+#include <Arduino.h>
+#include "block_codec.h"
+
+// ===================================================================
+// BLOCK VIDEO
+// ===================================================================
+//
+// The VIDEO_STREAM_START_BLOCKS stream: the camera runs in grayscale at
+// VIDEO_BLOCK_FRAME_SIZE, BlockEncoder (block_codec.h) codes each frame
+// against what the client already has, and the frame goes out as
+// BLE_FRAME_TYPE_BLOCKS chunks on the video characteristic, one chunk
+// per VideoStream cycle run like the photo upload.
+//
+// The encoder's reference (one byte per pixel) and the coded frame
+// buffer live in PSRAM while the stream runs.
+//
+
+namespace BlockVideo {
+    /**
+     * Restart the camera in grayscale and allocate the frame buffer
+     * (STREAMING entry in block mode)
+     * @return false if the camera or memory is not available (JPEG camera kept)
+     */
+    bool begin();
+
+    /**
+     * Free the buffers and restart the camera in JPEG (STREAMING exit)
+     */
+    void end();
+
+    bool isActive();
+
+    /**
+     * VideoStream cycle body: capture and encode a frame when one is due,
+     * otherwise send the next chunk of the current one
+     */
+    void update();
+
+    /**
+     * Send every block in the next frame (a client asked to resync)
+     */
+    void requestKeyFrame();
+
+    const block_codec_stats_t* getStats();
+
+    void printStatus();
+}
@@ -1,38 +1,80 @@
 #define CAMERA_MODEL_XIAO_ESP32S3
 #include "camera.h"
 #include "../../system/clock/timing.h"
+#include "../../system/clock/profiler.h"
 #include "../../hal/led/led_manager.h"
 #include "../../status/device_status.h"
+#include "../../status/device_lifecycle.h"
+#include "../../system/power_management/duty_cycle_capture.h"
+#include "../../system/power_management/retained_state.h"
+#include "../../system/memory/memory_utils.h"
+#include "block_video.h"
+#include "code_scanner.h"
+#include "photo_hash.h"
+#include "img_converters.h"
 
 // External reference to connection status
 // Note: BLE connection state is now managed by BLE manager
 #include "../bluetooth/callbacks/callbacks.h"
+#include "../bluetooth/l2cap_channel.h"
 
 // Camera state variables (defined here, declared in header)
 camera_fb_t *fb = nullptr;
-bool isCapturingPhotos = false;
 int captureInterval = 0;
 unsigned long lastCaptureTime = 0;
 size_t sent_photo_bytes = 0;
 size_t sent_photo_frames = 0;
-bool photoDataUploading = false;
+bool photoStartPending = false;
+#ifdef PHOTO_START_HEADER
+uint8_t photoStartHeader[BLE_PHOTO_START_SIZE];
+#endif
+JpegHeaderCompactor photoHeaderCompactor(JPEG_HEADER_REFRESH_IMAGES);
+
+// Photo quality gate state
+photo_quality_t photoQuality;
+bool photoQualityScored = false;
+int photoQualityRetakes = 0;
+#if PHOTO_QUALITY_POLICY == PHOTO_QUALITY_RECAPTURE
+static unsigned long qualityFirstShot = 0;
+#endif
+#if PHOTO_QUALITY_POLICY != PHOTO_QUALITY_OFF
+static uint8_t* qualityWork = nullptr;         // Downscaled luma (PHOTO_QUALITY_WORK_SIZE)
+#endif
+
+// Code scan state
+bool scanNextCapture = false;
+uint8_t codePayload[CODE_PAYLOAD_SIZE];
+size_t codePayloadLength = 0;
+
+// Pyramid photo state
+int pyramidNextLevel = -1;
+static camera_fb_t pyramidPhoto;               // fb while it holds an encoded level (buf from fmt2jpg)
 
 // Video streaming state variables
-bool isStreamingVideo = false;
 int streamingFPS = VIDEO_STREAM_DEFAULT_FPS;
 unsigned long lastStreamFrame = 0;
 bool isStreamingFrame = false;
 unsigned long streamingStartTime = 0;
 size_t totalStreamingFrames = 0;
 size_t droppedFrames = 0;
-camera_mode_t currentCameraMode = CAMERA_MODE_IDLE;
+
+// Camera configurations tried in order of preference
+static const CameraConfig cameraConfigs[] = {
+  {FRAMESIZE_QVGA, 15, CAMERA_FB_IN_PSRAM, 20000000, "QVGA + PSRAM"},
+  {FRAMESIZE_QQVGA, 20, CAMERA_FB_IN_PSRAM, 20000000, "QQVGA + PSRAM"},
+  {FRAMESIZE_QQVGA, 25, CAMERA_FB_IN_DRAM, 20000000, "QQVGA + DRAM"},
+  {FRAMESIZE_96X96, 30, CAMERA_FB_IN_DRAM, 10000000, "96x96 + DRAM (minimal)"},
+};
+static const int cameraConfigCount = sizeof(cameraConfigs) / sizeof(cameraConfigs[0]);
+
+// Index into cameraConfigs of the configuration that initialized (-1 = none)
+int activeCameraConfigIndex = -1;
 
 bool take_photo() {
+  PROFILE_SCOPE("photo_capture");
+  
   // Release previous buffer if exists
-  if (fb) {
-    esp_camera_fb_return(fb);
-    fb = nullptr;
-  }
+  release_photo();
 
   // Flash LED to indicate photo capture
   setLedPattern(LED_PHOTO_CAPTURE);
@@ -49,6 +91,7 @@ bool take_photo() {
     if (fb && fb->len > 0) {
       unsigned long totalDuration = measureEnd(captureStartTime);
       Serial.printf("Photo captured successfully, size: %d bytes (took %lu ms)\n", fb->len, totalDuration);
+      RetainedState::notePhotoCaptured();
       return true;
     }
     
@@ -60,10 +103,8 @@ bool take_photo() {
     retries--;
     Serial.printf("Photo capture failed (attempt took %lu ms), retries left: %d\n", attemptDuration, retries);
     
-    // Use timing utility for retry delay
-    static unsigned long retryDelayTime = 0;
-    if (!nonBlockingDelayStateful(&retryDelayTime, TIMING_SHORT)) {
-      // Still waiting, but for this synchronous function we'll use blocking delay
+    // take_photo() is synchronous: wait before the next attempt
+    if (retries > 0) {
       delay(TIMING_SHORT);
     }
   }
@@ -73,45 +114,143 @@ bool take_photo() {
   return false;
 }
 
+#if PHOTO_QUALITY_POLICY != PHOTO_QUALITY_OFF
+static const photo_quality_config_t qualityConfig = {
+  PHOTO_QUALITY_FACTOR, PHOTO_QUALITY_MIN_SHARPNESS, PHOTO_QUALITY_DARK_LEVEL,
+  PHOTO_QUALITY_BRIGHT_LEVEL, PHOTO_QUALITY_MAX_CLIPPED_PERCENT,
+};
+
+static void printPhotoQuality() {
+  Serial.printf("Photo quality: sharpness %u, mean %u, clipped %u%% dark %u%% bright%s%s%s\n",
+                photoQuality.sharpness, photoQuality.mean, photoQuality.dark_percent, photoQuality.bright_percent,
+                photoQuality.flags & PHOTO_QUALITY_BLURRY ? ", blurry" : "",
+                photoQuality.flags & PHOTO_QUALITY_DARK ? ", dark" : "",
+                photoQuality.flags & PHOTO_QUALITY_BRIGHT ? ", bright" : "");
+}
+#endif
+
+void release_photo() {
+  if (!fb) return;
+  if (fb == &pyramidPhoto) {
+    free(pyramidPhoto.buf);
+    pyramidPhoto.buf = nullptr;
+  } else {
+    esp_camera_fb_return(fb);
+  }
+  fb = nullptr;
+}
+
+bool check_photo_quality(bool mayRetake) {
+  photoQualityScored = false;
+#if PHOTO_QUALITY_POLICY == PHOTO_QUALITY_OFF
+  (void)mayRetake;
+  return true;
+#else
+  if (!qualityWork) {
+    qualityWork = (uint8_t*)SAFE_ALLOCATE(PHOTO_QUALITY_WORK_SIZE, MEM_PREFER_PSRAM, "PhotoQuality");
+    if (!qualityWork) return true;
+  }
+
+  {
+    PROFILE_SCOPE("photo_quality");
+    photoQualityScored = photoQualityJpeg(fb->buf, fb->len, qualityConfig, qualityWork, PHOTO_QUALITY_WORK_SIZE,
+                                          &photoQuality);
+  }
+  if (!photoQualityScored) {
+    Serial.println("Photo quality: not scored (unsupported JPEG)");
+    photoQualityRetakes = 0;
+    return true;
+  }
+  printPhotoQuality();
+
+#if PHOTO_QUALITY_POLICY == PHOTO_QUALITY_RECAPTURE
+  if (photoQualityRetakes == 0) qualityFirstShot = measureStart();
+  if (photoQuality.flags && mayRetake) {
+    if (getElapsedTime(qualityFirstShot) < PHOTO_QUALITY_BUDGET_MS) {
+      photoQualityRetakes++;
+      Serial.printf("Photo rejected, retaking (%d so far)\n", photoQualityRetakes);
+      release_photo();
+      photoQualityScored = false;
+      return false;
+    }
+    Serial.printf("Photo quality: no good shot in %d ms, sending the last\n", PHOTO_QUALITY_BUDGET_MS);
+  }
+#else
+  (void)mayRetake;
+#endif
+  photoQualityRetakes = 0;
+  return true;
+#endif
+}
+
+#ifdef PHOTO_START_HEADER
+void prepare_photo_start() {
+  uint64_t hash = 0;
+  bool hashed;
+  {
+    PROFILE_SCOPE("photo_hash");
+    hashed = photoHashJpeg(fb->buf, fb->len, &hash);
+  }
+  uint8_t flags = hashed ? BLE_PHOTO_START_HASH : 0;
+  if (photoQualityScored) {
+    flags |= BLE_PHOTO_START_SCORED;
+    if (photoQuality.flags & PHOTO_QUALITY_BLURRY) flags |= BLE_PHOTO_START_BLURRY;
+    if (photoQuality.flags & PHOTO_QUALITY_DARK) flags |= BLE_PHOTO_START_DARK;
+    if (photoQuality.flags & PHOTO_QUALITY_BRIGHT) flags |= BLE_PHOTO_START_BRIGHT;
+  }
+  bleWritePhotoStart(photoStartHeader, BLE_FRAME_TYPE_PHOTO, flags, hash, photoHeaderCompactor.length(fb->len));
+}
+#endif
+
+/**
+ * A command that changes the capture mode ends duty-cycled capture
+ */
+static void endDutyCycle()
+{
+#ifdef DUTY_CYCLE_CAPTURE_ENABLED
+  DutyCycleCapture::cancel();
+#endif
+}
+
 void handlePhotoControl(int8_t controlValue)
 {
   Serial.printf("Photo control command: %d\n", controlValue);
   
-  // Check if device is ready before processing photo commands
-  if (!deviceReady) {
-    Serial.println("Device not ready, ignoring photo control command");
-    return;
-  }
-  
+  // Runs on the BLE task: the Lifecycle cycle applies the request (an
+  // upload in progress or a video stream turns it down). A skip or a
+  // bulk channel request leaves duty-cycled capture running
   if (controlValue == PHOTO_SINGLE_SHOT)
   {
-    // Take a single photo
-    if (!photoDataUploading) {
-      isCapturingPhotos = true;
-      captureInterval = 0;
-      Serial.println("Single photo capture requested");
-    } else {
-      Serial.println("Photo upload in progress, ignoring single photo request");
-    }
+    endDutyCycle();
+    DeviceLifecycle::post(LIFECYCLE_EVENT_PHOTO_SINGLE);
   }
+  else if (controlValue == PHOTO_SCAN_CODE ||
+           (controlValue <= PHOTO_PYRAMID_SHOT && controlValue > PHOTO_PYRAMID_SHOT - IMAGE_PYRAMID_LEVELS))
+  {
+    endDutyCycle();
+    DeviceLifecycle::post(LIFECYCLE_EVENT_PHOTO_SINGLE, controlValue);
+  }
+  else if (controlValue == PHOTO_SKIP_UPLOAD)
+  {
+    DeviceLifecycle::post(LIFECYCLE_EVENT_UPLOAD_SKIP);
+  }
+#ifdef L2CAP_BULK_CHANNEL
+  else if (controlValue == PHOTO_BULK_CHANNEL)
+  {
+    L2capChannel::expect();
+  }
+#endif
   else if (controlValue == PHOTO_STOP)
   {
-    // Stop taking photos
-    isCapturingPhotos = false;
-    captureInterval = 0;
-    Serial.println("Photo capture stopped");
+    endDutyCycle();
+    DeviceLifecycle::post(LIFECYCLE_EVENT_PHOTO_STOP);
   }
   else if (controlValue >= PHOTO_MIN_INTERVAL && controlValue <= PHOTO_MAX_INTERVAL)
   {
-    // Start taking photos at specified interval
-    if (!photoDataUploading) {
-      captureInterval = (controlValue / PHOTO_MIN_INTERVAL) * (PHOTO_MIN_INTERVAL * 1000); // Round to nearest 5 seconds and convert to milliseconds
-      isCapturingPhotos = true;
-      lastCaptureTime = measureStart() - captureInterval;
-      Serial.printf("Interval photo capture started: %d seconds\n", captureInterval / 1000);
-    } else {
-      Serial.println("Photo upload in progress, ignoring interval photo request");
-    }
+    if (controlValue < DUTY_CYCLE_MIN_INTERVAL_S) endDutyCycle();
+    // Round to nearest 5 seconds and convert to milliseconds
+    int interval = (controlValue / PHOTO_MIN_INTERVAL) * (PHOTO_MIN_INTERVAL * 1000);
+    DeviceLifecycle::post(LIFECYCLE_EVENT_PHOTO_INTERVAL, interval);
   }
   else
   {
@@ -138,18 +277,10 @@ void configure_camera() {
   }
   
   // Try multiple configurations in order of preference
-  CameraConfig configs[] = {
-    {FRAMESIZE_QVGA, 15, CAMERA_FB_IN_PSRAM, 20000000, "QVGA + PSRAM"},
-    {FRAMESIZE_QQVGA, 20, CAMERA_FB_IN_PSRAM, 20000000, "QQVGA + PSRAM"},
-    {FRAMESIZE_QQVGA, 25, CAMERA_FB_IN_DRAM, 20000000, "QQVGA + DRAM"},
-    {FRAMESIZE_96X96, 30, CAMERA_FB_IN_DRAM, 10000000, "96x96 + DRAM (minimal)"},
-  };
-  
-  int num_configs = sizeof(configs) / sizeof(configs[0]);
   bool camera_initialized = false;
   
-  for (int i = 0; i < num_configs; i++) {
-    CameraConfig& config = configs[i];
+  for (int i = 0; i < cameraConfigCount; i++) {
+    const CameraConfig& config = cameraConfigs[i];
     
     // Skip PSRAM configs if PSRAM not available
     if (!psram_available && config.fb_location == CAMERA_FB_IN_PSRAM) {
@@ -161,6 +292,7 @@ void configure_camera() {
     
     if (initCameraWithConfig(config)) {
       Serial.printf("✅ Camera initialized successfully with: %s\n", config.description);
+      activeCameraConfigIndex = i;
       camera_initialized = true;
       break;
     } else {
@@ -188,7 +320,22 @@ void configure_camera() {
   Serial.println("=== Camera Configuration Complete ===");
 }
 
-bool initCameraWithConfig(const CameraConfig& config) {
+bool configure_camera_preset(int index) {
+  if (index < 0 || index >= cameraConfigCount) {
+    return false;
+  }
+  
+  // Known-good configuration from a previous boot: no PSRAM probing or fallback
+  if (!initCameraWithConfig(cameraConfigs[index])) {
+    Serial.printf("❌ Camera preset %d (%s) failed\n", index, cameraConfigs[index].description);
+    return false;
+  }
+  
+  activeCameraConfigIndex = index;
+  return true;
+}
+
+bool initCameraWithConfig(const CameraConfig& config, pixformat_t format) {
   camera_config_t cam_config;
   cam_config.ledc_channel = LEDC_CHANNEL_0;
   cam_config.ledc_timer = LEDC_TIMER_0;
@@ -210,7 +357,7 @@ bool initCameraWithConfig(const CameraConfig& config) {
   cam_config.pin_reset = RESET_GPIO_NUM;
   cam_config.xclk_freq_hz = config.xclk_freq_hz;
   cam_config.frame_size = config.frame_size;
-  cam_config.pixel_format = PIXFORMAT_JPEG;
+  cam_config.pixel_format = format;
   cam_config.fb_count = 1;
   cam_config.jpeg_quality = config.jpeg_quality;
   cam_config.fb_location = config.fb_location;
@@ -234,15 +381,11 @@ bool initCameraWithConfig(const CameraConfig& config) {
 void handleVideoControl(uint8_t controlValue) {
   Serial.printf("Video control command: %d\n", controlValue);
   
-  if (!deviceReady) {
-    Serial.println("Device not ready, ignoring video control command");
-    return;
-  }
-  
-  if (controlValue == VIDEO_STREAM_START) {
-    startVideoStreaming();
+  // Start and stop are lifecycle transitions (refused during a photo upload)
+  if (controlValue == VIDEO_STREAM_START || controlValue == VIDEO_STREAM_START_BLOCKS) {
+    DeviceLifecycle::post(LIFECYCLE_EVENT_VIDEO_START, controlValue);
   } else if (controlValue == VIDEO_STREAM_STOP) {
-    stopVideoStreaming();
+    DeviceLifecycle::post(LIFECYCLE_EVENT_VIDEO_STOP);
   } else if (controlValue >= VIDEO_STREAM_FPS_MIN && controlValue <= VIDEO_STREAM_FPS_MAX) {
     setVideoFPS(controlValue);
   } else {
@@ -250,27 +393,24 @@ void handleVideoControl(uint8_t controlValue) {
   }
 }
 
-void startVideoStreaming() {
-  if (!photoDataUploading && !isStreamingVideo) {
-    isStreamingVideo = true;
-    currentCameraMode = CAMERA_MODE_VIDEO_STREAMING;
-    streamingFPS = VIDEO_STREAM_DEFAULT_FPS;
-    lastStreamFrame = measureStart();
-    streamingStartTime = measureStart();
-    totalStreamingFrames = 0;
-    droppedFrames = 0;
+void startVideoStreaming(uint8_t mode) {
+  streamingFPS = VIDEO_STREAM_DEFAULT_FPS;
+  lastStreamFrame = measureStart();
+  streamingStartTime = measureStart();
+  totalStreamingFrames = 0;
+  droppedFrames = 0;
+  // Block video falls back to JPEG frames when grayscale is not available
+  if (mode != VIDEO_STREAM_START_BLOCKS || !BlockVideo::begin()) {
     configure_camera_for_streaming();
-    setLedPattern(LED_STREAMING);
-    Serial.println("Video streaming started");
-    updateVideoStatus();
-  } else {
-    Serial.println("Cannot start video streaming - photo upload in progress or already streaming");
   }
+  setLedPattern(LED_STREAMING);
+  Serial.println("Video streaming started");
+  updateVideoStatus();
 }
 
 void stopVideoStreaming() {
-  isStreamingVideo = false;
-  currentCameraMode = CAMERA_MODE_IDLE;
+  // The status notify follows once the lifecycle has left STREAMING
+  BlockVideo::end();
   configure_camera_for_photo();
   // Return to connection status LED
   if (bleConnected) {
@@ -279,7 +419,6 @@ void stopVideoStreaming() {
     setLedPattern(LED_DISCONNECTED);
   }
   Serial.println("Video streaming stopped");
-  updateVideoStatus();
 }
 
 void setVideoFPS(uint8_t fps) {
@@ -315,16 +454,142 @@ void configure_camera_for_photo() {
   }
 }
 
-bool shouldDropFrame() {
-  // Drop frames more aggressively during streaming to maintain performance
-  if (photoDataUploading && isStreamingVideo) {
-    droppedFrames++;
-    Serial.printf("Dropping frame #%d (upload in progress)\n", droppedFrames);
+// The pixel format is fixed at init: restart the driver in grayscale (or YUV422)
+static bool restartCameraRaw(framesize_t frameSize, pixformat_t format = PIXFORMAT_GRAYSCALE) {
+  if (activeCameraConfigIndex < 0) return false;
+
+  CameraConfig config = cameraConfigs[activeCameraConfigIndex];
+  config.frame_size = frameSize;
+  esp_camera_deinit();
+  return initCameraWithConfig(config, format);
+}
+
+bool configure_camera_for_blocks() {
+  if (restartCameraRaw(VIDEO_BLOCK_FRAME_SIZE)) {
+    Serial.println("Camera configured for block video (grayscale)");
     return true;
   }
-  
-  // Also drop frames if we're behind on the streaming schedule
-  if (isStreamingVideo && totalStreamingFrames > 0) {
+  restore_camera_jpeg();
+  return false;
+}
+
+bool scan_for_code() {
+  PROFILE_SCOPE("code_scan");
+  codePayloadLength = 0;
+
+  if (!restartCameraRaw(CODE_SCAN_FRAME_SIZE)) {
+    Serial.println("Code scan: grayscale capture unavailable");
+    restore_camera_jpeg();
+    return false;
+  }
+
+  // The first frames after a restart may still be settling exposure
+  static code_result_t result;
+  bool found = false;
+  for (int attempt = 0; attempt < CODE_SCAN_ATTEMPTS && !found; attempt++) {
+    camera_fb_t *frame = esp_camera_fb_get();
+    if (!frame) continue;
+    found = codeScan(frame->buf, frame->width, frame->height, frame->width, &result);
+    esp_camera_fb_return(frame);
+  }
+  restore_camera_jpeg();
+
+  if (!found) {
+    Serial.println("Code scan: no code in view");
+    return false;
+  }
+
+  codePayload[0] = result.symbology;
+  memcpy(&codePayload[1], result.payload, result.length);
+  codePayloadLength = 1 + result.length;
+  Serial.printf("Code scan: %s, %u bytes (%u codewords corrected)\n", codeSymbologyName(result.symbology),
+                result.length, result.corrected);
+  return true;
+}
+
+bool capture_pyramid_photo(int level) {
+  PROFILE_SCOPE("photo_pyramid");
+  release_photo();
+  photoQualityScored = false;
+  setLedPattern(LED_PHOTO_CAPTURE);
+
+  if (!restartCameraRaw(PHOTO_PYRAMID_FRAME_SIZE, PHOTO_PYRAMID_PIXFORMAT)) {
+    Serial.println("Pyramid photo: raw capture unavailable");
+    restore_camera_jpeg();
+    return false;
+  }
+
+  camera_fb_t *frame = nullptr;
+  for (int attempt = 0; attempt < 3 && !frame; attempt++) {
+    frame = esp_camera_fb_get();
+  }
+  if (!frame) {
+    Serial.println("Pyramid photo: capture failed");
+    restore_camera_jpeg();
+    return false;
+  }
+
+  // Levels 1-3 (and YUV422 luma) in PSRAM for this shot only
+  bool yuv422 = frame->format == PIXFORMAT_YUV422;
+  size_t storageSize = imagePyramidSize(frame->width, frame->height, yuv422);
+  uint8_t *storage = (uint8_t*)SAFE_ALLOCATE(storageSize, MEM_PREFER_PSRAM, "PhotoPyramid");
+  image_pyramid_t pyramid;
+  bool built;
+  {
+    PROFILE_SCOPE("pyramid_build");
+    built = storage && imagePyramidBuild(frame->buf, frame->width, frame->height, yuv422, storage, storageSize,
+                                         &pyramid);
+  }
+
+  uint8_t *jpeg = nullptr;
+  size_t jpegLength = 0;
+  if (built) {
+#if PHOTO_QUALITY_POLICY != PHOTO_QUALITY_OFF
+    // The quality gate scores a level instead of decoding the JPEG
+    const image_level_t& scored = pyramid.level[imagePyramidFit(pyramid, PHOTO_QUALITY_WORK_SIZE)];
+    photoQualityGray(scored.pixels, scored.stride, scored.width, scored.height, qualityConfig, &photoQuality);
+    photoQualityScored = true;
+    printPhotoQuality();
+#endif
+    const image_level_t& sent = pyramid.level[level];
+    PROFILE_SCOPE("pyramid_encode");
+    if (!fmt2jpg((uint8_t*)sent.pixels, (size_t)sent.width * sent.height, sent.width, sent.height,
+                 PIXFORMAT_GRAYSCALE, PHOTO_PYRAMID_JPEG_QUALITY, &jpeg, &jpegLength)) {
+      jpeg = nullptr;
+    }
+  }
+  uint16_t width = built ? pyramid.level[level].width : 0, height = built ? pyramid.level[level].height : 0;
+  pyramidPhoto.timestamp = frame->timestamp;
+  esp_camera_fb_return(frame);
+  if (storage) SAFE_FREE(storage);
+  restore_camera_jpeg();
+
+  if (!jpeg) {
+    Serial.println(built ? "Pyramid photo: JPEG encode failed" : "Pyramid photo: out of memory");
+    photoQualityScored = false;
+    return false;
+  }
+
+  pyramidPhoto.buf = jpeg;
+  pyramidPhoto.len = jpegLength;
+  pyramidPhoto.width = width;
+  pyramidPhoto.height = height;
+  pyramidPhoto.format = PIXFORMAT_JPEG;
+  fb = &pyramidPhoto;
+  RetainedState::notePhotoCaptured();
+  Serial.printf("Pyramid photo: level %d, %ux%u, %u bytes\n", level, width, height, (unsigned)jpegLength);
+  return true;
+}
+
+bool restore_camera_jpeg() {
+  esp_camera_deinit();
+  return configure_camera_preset(activeCameraConfigIndex);
+}
+
+bool shouldDropFrame() {
+  // Drop frames if we're behind on the streaming schedule (photo uploads
+  // cannot run during a stream)
+  if (DeviceLifecycle::isIn(LIFECYCLE_STREAMING) && totalStreamingFrames > 0) {
     unsigned long expectedFrames = getElapsedTime(streamingStartTime) / VIDEO_STREAM_FRAME_INTERVAL(streamingFPS);
     if (totalStreamingFrames < expectedFrames * 0.5) { // If we're less than 50% of expected rate
       droppedFrames++;
@@ -5,18 +5,35 @@
 #include "esp_camera.h"
 #include "../../hal/camera_pins.h"
 #include "../../hal/constants.h"
+#include "jpeg_header.h"
+#include "photo_quality.h"
+#include "image_pyramid.h"
 
 // Camera state variables (extern declarations)
+// Capturing, uploading and streaming are lifecycle states (status/device_lifecycle.h)
 extern camera_fb_t *fb;
-extern bool isCapturingPhotos;
 extern int captureInterval;
 extern unsigned long lastCaptureTime;
 extern size_t sent_photo_bytes;
 extern size_t sent_photo_frames;
-extern bool photoDataUploading;
+extern bool photoStartPending;                     // Start header not sent yet (PHOTO_START_HEADER)
+extern uint8_t photoStartHeader[];                 // BLE_PHOTO_START_SIZE bytes, built by prepare_photo_start()
+extern JpegHeaderCompactor photoHeaderCompactor;   // Wire bytes of fb (JPEG_HEADER_COMPACTION)
+
+// Photo quality gate state (PHOTO_QUALITY_POLICY)
+extern photo_quality_t photoQuality;   // Score of fb, valid if photoQualityScored
+extern bool photoQualityScored;
+extern int photoQualityRetakes;        // Photos thrown away for the current shot
+
+// Code scan state (PHOTO_SCAN_CODE)
+extern bool scanNextCapture;        // The next capture tries scan_for_code() first
+extern uint8_t codePayload[];       // [symbology] + text, sent in place of fb
+extern size_t codePayloadLength;    // 0 = nothing to send
+
+// Pyramid photo state (PHOTO_PYRAMID_SHOT)
+extern int pyramidNextLevel;        // The next capture sends this pyramid level (-1 = a plain photo)
 
 // Video streaming state variables
-extern bool isStreamingVideo;
 extern int streamingFPS;
 extern unsigned long lastStreamFrame;
 extern bool isStreamingFrame;
@@ -24,14 +41,6 @@ extern unsigned long streamingStartTime;
 extern size_t totalStreamingFrames;
 extern size_t droppedFrames;
 
-// Camera mode enumeration
-typedef enum {
-    CAMERA_MODE_IDLE,
-    CAMERA_MODE_SINGLE_PHOTO,
-    CAMERA_MODE_INTERVAL_PHOTO,
-    CAMERA_MODE_VIDEO_STREAMING
-} camera_mode_t;
-
 // Camera configuration structure for fallback initialization
 typedef struct {
     framesize_t frame_size;
@@ -41,7 +50,7 @@ typedef struct {
     const char* description;
 } CameraConfig;
 
-extern camera_mode_t currentCameraMode;
+extern int activeCameraConfigIndex;
 
 // Video status structure
 typedef struct {
@@ -54,15 +63,23 @@ typedef struct {
 // Camera functions - exact same interface as firmware.ino
 void configure_camera();
 bool take_photo();
+bool check_photo_quality(bool mayRetake);  // Scores fb; false: fb was returned, take it again
+void release_photo();                      // Returns fb to the driver (or frees an encoded pyramid level)
+void prepare_photo_start();                // Hashes fb into photoStartHeader (PHOTO_START_HEADER)
 void handlePhotoControl(int8_t controlValue);
-bool initCameraWithConfig(const CameraConfig& config);
+bool initCameraWithConfig(const CameraConfig& config, pixformat_t format = PIXFORMAT_JPEG);
+bool configure_camera_preset(int index);
 
 // Video streaming functions
 void handleVideoControl(uint8_t controlValue);
-void startVideoStreaming();
-void stopVideoStreaming();
+void startVideoStreaming(uint8_t mode = VIDEO_STREAM_START);  // STREAMING entry action
+void stopVideoStreaming();      // STREAMING exit action
 void setVideoFPS(uint8_t fps);
 void configure_camera_for_streaming();
 void configure_camera_for_photo();
+bool configure_camera_for_blocks();   // Restarts the driver in grayscale (block video)
+bool restore_camera_jpeg();           // Back to the JPEG configuration found at boot
+bool scan_for_code();                 // Grayscale capture + code_scanner.h: fills codePayload if a code is in view
+bool capture_pyramid_photo(int level);  // Raw capture + image_pyramid.h: fb holds the level as a JPEG
 bool shouldDropFrame();
 void updateVideoStatus(); 
\ No newline at end of file
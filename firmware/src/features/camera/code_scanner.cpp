@@ -0,0 +1,1290 @@
+#include "code_scanner.h"
+#include <math.h>
+#include <string.h>
+
+// ===================================================================
+// THRESHOLD
+// ===================================================================
+
+static uint8_t tileThreshold[CODE_MAX_TILES * CODE_MAX_TILES];
+static uint16_t tilesX = 0;
+static uint16_t tilesY = 0;
+
+/**
+ * Per tile: the mean of its 3x3 tile neighbourhood
+ */
+static bool buildThresholds(const uint8_t* gray, uint16_t width, uint16_t height, size_t stride) {
+    tilesX = (uint16_t)((width + CODE_TILE_SIZE - 1) / CODE_TILE_SIZE);
+    tilesY = (uint16_t)((height + CODE_TILE_SIZE - 1) / CODE_TILE_SIZE);
+    if (tilesX == 0 || tilesY == 0 || tilesX > CODE_MAX_TILES || tilesY > CODE_MAX_TILES) return false;
+
+    static uint8_t means[CODE_MAX_TILES * CODE_MAX_TILES];
+    for (uint16_t ty = 0; ty < tilesY; ty++) {
+        for (uint16_t tx = 0; tx < tilesX; tx++) {
+            uint16_t x0 = tx * CODE_TILE_SIZE, y0 = ty * CODE_TILE_SIZE;
+            uint16_t x1 = x0 + CODE_TILE_SIZE < width ? x0 + CODE_TILE_SIZE : width;
+            uint16_t y1 = y0 + CODE_TILE_SIZE < height ? y0 + CODE_TILE_SIZE : height;
+            uint32_t sum = 0;
+            for (uint16_t y = y0; y < y1; y++) {
+                const uint8_t* row = gray + (size_t)y * stride;
+                for (uint16_t x = x0; x < x1; x++) sum += row[x];
+            }
+            means[ty * tilesX + tx] = (uint8_t)(sum / ((uint32_t)(x1 - x0) * (y1 - y0)));
+        }
+    }
+    for (int ty = 0; ty < tilesY; ty++) {
+        for (int tx = 0; tx < tilesX; tx++) {
+            uint32_t sum = 0, count = 0;
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    int x = tx + dx, y = ty + dy;
+                    if (x < 0 || y < 0 || x >= tilesX || y >= tilesY) continue;
+                    sum += means[y * tilesX + x];
+                    count++;
+                }
+            }
+            tileThreshold[ty * tilesX + tx] = (uint8_t)(sum / count);
+        }
+    }
+    return true;
+}
+
+typedef struct {
+    const uint8_t* gray;
+    uint16_t width;
+    uint16_t height;
+    size_t stride;
+} code_image_t;
+
+static inline bool isBlack(const code_image_t& image, int x, int y) {
+    return image.gray[(size_t)y * image.stride + x] <
+           tileThreshold[(y / CODE_TILE_SIZE) * tilesX + x / CODE_TILE_SIZE];
+}
+
+static inline bool isBlackAt(const code_image_t& image, float x, float y, bool* inside) {
+    int ix = (int)floorf(x), iy = (int)floorf(y);
+    if (ix < 0 || iy < 0 || ix >= image.width || iy >= image.height) {
+        *inside = false;
+        return false;
+    }
+    return isBlack(image, ix, iy);
+}
+
+// ===================================================================
+// GALOIS FIELD / REED-SOLOMON
+// ===================================================================
+
+static uint8_t gfExp[512];
+static uint8_t gfLog[256];
+static bool gfReady = false;
+
+static void gfInit() {
+    if (gfReady) return;
+    int x = 1;
+    for (int i = 0; i < 255; i++) {
+        gfExp[i] = (uint8_t)x;
+        gfLog[x] = (uint8_t)i;
+        x <<= 1;
+        if (x & 0x100) x ^= 0x11D;
+    }
+    for (int i = 255; i < 512; i++) gfExp[i] = gfExp[i - 255];
+    gfLog[0] = 0;
+    gfReady = true;
+}
+
+uint8_t qrGfExp(int n) {
+    gfInit();
+    n %= 255;
+    if (n < 0) n += 255;
+    return gfExp[n];
+}
+
+uint8_t qrGfMultiply(uint8_t a, uint8_t b) {
+    gfInit();
+    if (a == 0 || b == 0) return 0;
+    return gfExp[gfLog[a] + gfLog[b]];
+}
+
+static inline uint8_t gfDivide(uint8_t a, uint8_t b) {
+    if (a == 0) return 0;
+    return gfExp[(gfLog[a] + 255 - gfLog[b]) % 255];
+}
+
+static inline uint8_t gfInverse(uint8_t a) {
+    return gfExp[255 - gfLog[a]];
+}
+
+#define QR_MAX_EC_PER_BLOCK 30
+
+int qrCorrectBlock(uint8_t* block, size_t length, size_t ecCount) {
+    gfInit();
+    if (ecCount == 0 || ecCount > QR_MAX_EC_PER_BLOCK || length > 255 || ecCount >= length) return -1;
+
+    // Syndromes S_i = r(a^i)
+    uint8_t syndromes[QR_MAX_EC_PER_BLOCK];
+    bool clean = true;
+    for (size_t i = 0; i < ecCount; i++) {
+        uint8_t s = 0;
+        for (size_t j = 0; j < length; j++) s = qrGfMultiply(s, gfExp[i]) ^ block[j];
+        syndromes[i] = s;
+        if (s) clean = false;
+    }
+    if (clean) return 0;
+
+    // Berlekamp-Massey: error locator (coefficients from x^0)
+    uint8_t locator[QR_MAX_EC_PER_BLOCK + 1], previous[QR_MAX_EC_PER_BLOCK + 1], saved[QR_MAX_EC_PER_BLOCK + 1];
+    memset(locator, 0, sizeof(locator));
+    memset(previous, 0, sizeof(previous));
+    locator[0] = previous[0] = 1;
+    size_t errors = 0;
+    int shift = 1;
+    uint8_t lastDiscrepancy = 1;
+    for (size_t n = 0; n < ecCount; n++) {
+        uint8_t d = syndromes[n];
+        for (size_t i = 1; i <= errors; i++) d ^= qrGfMultiply(locator[i], syndromes[n - i]);
+        if (d == 0) {
+            shift++;
+            continue;
+        }
+        uint8_t scale = gfDivide(d, lastDiscrepancy);
+        if (2 * errors <= n) {
+            memcpy(saved, locator, sizeof(locator));
+            for (size_t i = 0; i + shift <= ecCount; i++) locator[i + shift] ^= qrGfMultiply(scale, previous[i]);
+            errors = n + 1 - errors;
+            memcpy(previous, saved, sizeof(previous));
+            lastDiscrepancy = d;
+            shift = 1;
+        } else {
+            for (size_t i = 0; i + shift <= ecCount; i++) locator[i + shift] ^= qrGfMultiply(scale, previous[i]);
+            shift++;
+        }
+    }
+    if (errors == 0 || 2 * errors > ecCount) return -1;
+
+    // Evaluator: S(x) * locator(x) mod x^ecCount
+    uint8_t evaluator[QR_MAX_EC_PER_BLOCK];
+    for (size_t i = 0; i < ecCount; i++) {
+        uint8_t v = 0;
+        for (size_t j = 0; j <= i && j <= errors; j++) v ^= qrGfMultiply(locator[j], syndromes[i - j]);
+        evaluator[i] = v;
+    }
+
+    // Chien search and Forney: position j has locator X = a^(length - 1 - j)
+    size_t found = 0;
+    for (size_t j = 0; j < length; j++) {
+        int power = (int)(length - 1 - j);
+        uint8_t xInverse = gfExp[(255 - power % 255) % 255];
+        uint8_t value = 0, xPower = 1;
+        for (size_t i = 0; i <= errors; i++) {
+            value ^= qrGfMultiply(locator[i], xPower);
+            xPower = qrGfMultiply(xPower, xInverse);
+        }
+        if (value != 0) continue;
+
+        uint8_t omega = 0, derivative = 0;
+        xPower = 1;
+        for (size_t i = 0; i < ecCount; i++) {
+            omega ^= qrGfMultiply(evaluator[i], xPower);
+            xPower = qrGfMultiply(xPower, xInverse);
+        }
+        // Formal derivative: odd terms, x^(i - 1)
+        xPower = 1;
+        uint8_t xInverseSquared = qrGfMultiply(xInverse, xInverse);
+        for (size_t i = 1; i <= errors; i += 2) {
+            derivative ^= qrGfMultiply(locator[i], xPower);
+            xPower = qrGfMultiply(xPower, xInverseSquared);
+        }
+        if (derivative == 0) return -1;
+        uint8_t magnitude = qrGfMultiply(gfInverse(xInverse), gfDivide(omega, derivative));
+        block[j] ^= magnitude;
+        found++;
+    }
+    if (found != errors) return -1;
+    return (int)errors;
+}
+
+// ===================================================================
+// QR TABLES
+// ===================================================================
+
+// Per version 1-10, per level L M Q H: {blocks, long blocks, short block data, EC per block}
+static const uint8_t QR_BLOCKS[QR_MAX_VERSION][4][4] = {
+    {{1, 0, 19, 7},   {1, 0, 16, 10},  {1, 0, 13, 13},  {1, 0, 9, 17}},
+    {{1, 0, 34, 10},  {1, 0, 28, 16},  {1, 0, 22, 22},  {1, 0, 16, 28}},
+    {{1, 0, 55, 15},  {1, 0, 44, 26},  {2, 0, 17, 18},  {2, 0, 13, 22}},
+    {{1, 0, 80, 20},  {2, 0, 32, 18},  {2, 0, 24, 26},  {4, 0, 9, 16}},
+    {{1, 0, 108, 26}, {2, 0, 43, 24},  {4, 2, 15, 18},  {4, 2, 11, 22}},
+    {{2, 0, 68, 18},  {4, 0, 27, 16},  {4, 0, 19, 24},  {4, 0, 15, 28}},
+    {{2, 0, 78, 20},  {4, 0, 31, 18},  {6, 4, 14, 18},  {5, 1, 13, 26}},
+    {{2, 0, 97, 24},  {4, 2, 38, 22},  {6, 2, 18, 22},  {6, 2, 14, 26}},
+    {{2, 0, 116, 30}, {5, 2, 36, 22},  {8, 4, 16, 20},  {8, 4, 12, 24}},
+    {{4, 2, 68, 18},  {5, 1, 43, 26},  {8, 2, 19, 24},  {8, 2, 15, 28}},
+};
+
+// Alignment pattern centres (beyond the first at 6), versions 2-10
+static const uint8_t QR_ALIGNMENT[QR_MAX_VERSION][3] = {
+    {0, 0, 0}, {18, 0, 0}, {22, 0, 0}, {26, 0, 0}, {30, 0, 0},
+    {34, 0, 0}, {22, 38, 0}, {24, 42, 0}, {26, 46, 0}, {28, 50, 0},
+};
+
+// Format indicator bits of L, M, Q, H
+static const uint8_t QR_EC_INDICATOR[4] = {1, 0, 3, 2};
+
+static const char QR_ALPHANUMERIC[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ $%*+-./:";
+
+uint16_t qrFormatBits(qr_ec_level_t level, uint8_t mask) {
+    uint32_t data = ((uint32_t)QR_EC_INDICATOR[level & 3] << 3) | (mask & 7);
+    uint32_t bits = data << 10;
+    for (int i = 14; i >= 10; i--) {
+        if (bits & (1u << i)) bits ^= 0x537u << (i - 10);
+    }
+    return (uint16_t)(((data << 10) | bits) ^ 0x5412);
+}
+
+uint32_t qrVersionBits(uint8_t version) {
+    uint32_t bits = (uint32_t)version << 12;
+    for (int i = 17; i >= 12; i--) {
+        if (bits & (1u << i)) bits ^= 0x1F25u << (i - 12);
+    }
+    return ((uint32_t)version << 12) | bits;
+}
+
+static int qrAlignmentCentres(uint8_t version, uint8_t centres[4]) {
+    if (version < 2) return 0;
+    int count = 0;
+    centres[count++] = 6;
+    for (int i = 0; i < 3 && QR_ALIGNMENT[version - 1][i]; i++) centres[count++] = QR_ALIGNMENT[version - 1][i];
+    return count;
+}
+
+bool qrIsFunctionModule(uint8_t version, int x, int y) {
+    int dimension = 17 + 4 * version;
+    // Finders, separators and format areas
+    if (x < 9 && y < 9) return true;
+    if (x >= dimension - 8 && y < 9) return true;
+    if (x < 9 && y >= dimension - 8) return true;
+    // Timing
+    if (x == 6 || y == 6) return true;
+    // Version information
+    if (version >= 7) {
+        if (y < 6 && x >= dimension - 11 && x < dimension - 8) return true;
+        if (x < 6 && y >= dimension - 11 && y < dimension - 8) return true;
+    }
+    // Alignment patterns, except where they would overlap the finders
+    uint8_t centres[4];
+    int count = qrAlignmentCentres(version, centres);
+    for (int i = 0; i < count; i++) {
+        for (int j = 0; j < count; j++) {
+            if ((i == 0 && j == 0) || (i == 0 && j == count - 1) || (i == count - 1 && j == 0)) continue;
+            if (x >= centres[i] - 2 && x <= centres[i] + 2 && y >= centres[j] - 2 && y <= centres[j] + 2) return true;
+        }
+    }
+    return false;
+}
+
+bool qrMaskBit(uint8_t mask, int x, int y) {
+    int i = y, j = x;
+    switch (mask & 7) {
+        case 0: return (i + j) % 2 == 0;
+        case 1: return i % 2 == 0;
+        case 2: return j % 3 == 0;
+        case 3: return (i + j) % 3 == 0;
+        case 4: return (i / 2 + j / 3) % 2 == 0;
+        case 5: return (i * j) % 2 + (i * j) % 3 == 0;
+        case 6: return ((i * j) % 2 + (i * j) % 3) % 2 == 0;
+        default: return ((i + j) % 2 + (i * j) % 3) % 2 == 0;
+    }
+}
+
+uint16_t qrTotalCodewords(uint8_t version) {
+    int dimension = 17 + 4 * version;
+    int modules = 0;
+    for (int y = 0; y < dimension; y++) {
+        for (int x = 0; x < dimension; x++) {
+            if (!qrIsFunctionModule(version, x, y)) modules++;
+        }
+    }
+    return (uint16_t)(modules / 8);
+}
+
+void qrBlockLayout(uint8_t version, qr_ec_level_t level, uint8_t* blocks, uint8_t* longBlocks, uint8_t* shortData,
+                   uint8_t* ecPerBlock) {
+    const uint8_t* entry = QR_BLOCKS[version - 1][level & 3];
+    *blocks = entry[0];
+    *longBlocks = entry[1];
+    *shortData = entry[2];
+    *ecPerBlock = entry[3];
+}
+
+// ===================================================================
+// QR: FINDER PATTERNS
+// ===================================================================
+
+typedef struct {
+    float x;
+    float y;
+    float size;         // Width of the 7-module pattern along a row, pixels
+    uint16_t count;     // Rows that found it
+} qr_finder_t;
+
+#define QR_MAX_FINDERS 24
+
+static qr_finder_t finders[QR_MAX_FINDERS];
+static int finderCount = 0;
+
+static bool finderRatio(const int counts[5]) {
+    int total = counts[0] + counts[1] + counts[2] + counts[3] + counts[4];
+    if (total < 7) return false;
+    float module = total / 7.0f;
+    float tolerance = module * 0.6f;
+    return fabsf(module - counts[0]) < tolerance && fabsf(module - counts[1]) < tolerance &&
+           fabsf(3 * module - counts[2]) < 3 * tolerance && fabsf(module - counts[3]) < tolerance &&
+           fabsf(module - counts[4]) < tolerance;
+}
+
+/**
+ * Runs of a finder pattern through (x, y) along (dx, dy), both ways
+ * @return Centre offset along the line (pixels from (x, y)), or NAN
+ */
+static float crossCheck(const code_image_t& image, int x, int y, int dx, int dy, int maxRun, int* totalOut) {
+    int counts[5] = {0, 0, 0, 0, 0};
+    int cx = x, cy = y;
+    bool inside = true;
+    // Back from the centre: black, white, black
+    while (inside && isBlackAt(image, (float)cx, (float)cy, &inside)) {
+        counts[2]++;
+        cx -= dx;
+        cy -= dy;
+    }
+    if (!inside) return NAN;
+    while (inside && !isBlackAt(image, (float)cx, (float)cy, &inside) && counts[1] <= maxRun) {
+        counts[1]++;
+        cx -= dx;
+        cy -= dy;
+    }
+    if (!inside || counts[1] > maxRun) return NAN;
+    while (inside && isBlackAt(image, (float)cx, (float)cy, &inside) && counts[0] <= maxRun) {
+        counts[0]++;
+        cx -= dx;
+        cy -= dy;
+    }
+    if (counts[0] > maxRun) return NAN;
+
+    // Forward
+    cx = x + dx;
+    cy = y + dy;
+    inside = true;
+    while (inside && isBlackAt(image, (float)cx, (float)cy, &inside)) {
+        counts[2]++;
+        cx += dx;
+        cy += dy;
+    }
+    if (!inside) return NAN;
+    while (inside && !isBlackAt(image, (float)cx, (float)cy, &inside) && counts[3] <= maxRun) {
+        counts[3]++;
+        cx += dx;
+        cy += dy;
+    }
+    if (!inside || counts[3] > maxRun) return NAN;
+    while (inside && isBlackAt(image, (float)cx, (float)cy, &inside) && counts[4] <= maxRun) {
+        counts[4]++;
+        cx += dx;
+        cy += dy;
+    }
+    if (counts[4] > maxRun) return NAN;
+
+    if (!finderRatio(counts)) return NAN;
+    *totalOut = counts[0] + counts[1] + counts[2] + counts[3] + counts[4];
+    // End of the pattern along the line, minus half the pattern
+    int end = (dx ? (cx - x) * dx : (cy - y) * dy);
+    return (float)end - counts[4] - counts[3] - counts[2] / 2.0f;
+}
+
+static void addFinder(float x, float y, float size) {
+    for (int i = 0; i < finderCount; i++) {
+        qr_finder_t& f = finders[i];
+        if (fabsf(f.x - x) <= f.size / 7 * 2 && fabsf(f.y - y) <= f.size / 7 * 2 &&
+            fabsf(f.size - size) <= f.size * 0.5f) {
+            float n = f.count;
+            f.x = (f.x * n + x) / (n + 1);
+            f.y = (f.y * n + y) / (n + 1);
+            f.size = (f.size * n + size) / (n + 1);
+            f.count++;
+            return;
+        }
+    }
+    if (finderCount < QR_MAX_FINDERS) {
+        finders[finderCount].x = x;
+        finders[finderCount].y = y;
+        finders[finderCount].size = size;
+        finders[finderCount].count = 1;
+        finderCount++;
+    }
+}
+
+static void checkFinderCandidate(const code_image_t& image, const int counts[5], int endX, int y) {
+    int total = counts[0] + counts[1] + counts[2] + counts[3] + counts[4];
+    float centreX = endX - counts[4] - counts[3] - counts[2] / 2.0f;
+    int maxRun = counts[2] * 2 + 2;
+
+    int verticalTotal = 0;
+    float offsetY = crossCheck(image, (int)centreX, y, 0, 1, maxRun, &verticalTotal);
+    if (isnan(offsetY) || 5 * abs(verticalTotal - total) >= 2 * total) return;
+    float centreY = y + offsetY;
+
+    int horizontalTotal = 0;
+    float offsetX = crossCheck(image, (int)centreX, (int)centreY, 1, 0, maxRun, &horizontalTotal);
+    if (isnan(offsetX)) return;
+    centreX = (int)centreX + offsetX;
+
+    addFinder(centreX, centreY, (horizontalTotal + verticalTotal) / 2.0f);
+}
+
+static void findFinders(const code_image_t& image) {
+    finderCount = 0;
+    int step = image.height >= 240 ? 2 : 1;
+    for (int y = 0; y < image.height; y += step) {
+        int counts[5] = {0, 0, 0, 0, 0};
+        int state = 0;
+        for (int x = 0; x < image.width; x++) {
+            if (isBlack(image, x, y)) {
+                if (state & 1) state++;
+                counts[state]++;
+            } else if (state & 1) {
+                counts[state]++;
+            } else if (state == 4) {
+                if (finderRatio(counts)) checkFinderCandidate(image, counts, x, y);
+                counts[0] = counts[2];
+                counts[1] = counts[3];
+                counts[2] = counts[4];
+                counts[3] = 1;
+                counts[4] = 0;
+                state = 3;
+            } else if (state > 0 || counts[0] > 0) {
+                state++;
+                counts[state]++;
+            }
+        }
+        if (state == 4 && finderRatio(counts)) checkFinderCandidate(image, counts, image.width, y);
+    }
+}
+
+// ===================================================================
+// QR: GEOMETRY
+// ===================================================================
+
+typedef struct {
+    double m[9];        // Module (u, v) -> image: x = (m0 u + m1 v + m2) / (m6 u + m7 v + m8)
+} qr_transform_t;
+
+static inline void transformPoint(const qr_transform_t& t, float u, float v, float* x, float* y) {
+    double w = t.m[6] * u + t.m[7] * v + t.m[8];
+    *x = (float)((t.m[0] * u + t.m[1] * v + t.m[2]) / w);
+    *y = (float)((t.m[3] * u + t.m[4] * v + t.m[5]) / w);
+}
+
+static qr_transform_t affineTransform(const qr_finder_t& tl, const qr_finder_t& tr, const qr_finder_t& bl,
+                                      int dimension) {
+    // Finder centres sit 3.5 modules in from the corners
+    float span = dimension - 7.0f;
+    qr_transform_t t;
+    t.m[0] = (tr.x - tl.x) / span;
+    t.m[1] = (bl.x - tl.x) / span;
+    t.m[2] = tl.x - 3.5 * (t.m[0] + t.m[1]);
+    t.m[3] = (tr.y - tl.y) / span;
+    t.m[4] = (bl.y - tl.y) / span;
+    t.m[5] = tl.y - 3.5 * (t.m[3] + t.m[4]);
+    t.m[6] = 0;
+    t.m[7] = 0;
+    t.m[8] = 1;
+    return t;
+}
+
+#define QR_MAX_FIT_POINTS 24
+
+/**
+ * Least-squares homography through n >= 4 point pairs (normal equations,
+ * Gaussian elimination)
+ */
+static bool fitTransform(const float* u, const float* v, const float* x, const float* y, int n, qr_transform_t* t) {
+    double a[8][9];
+    memset(a, 0, sizeof(a));
+    for (int i = 0; i < n; i++) {
+        double rows[2][9] = {
+            {u[i], v[i], 1, 0, 0, 0, -u[i] * x[i], -v[i] * x[i], x[i]},
+            {0, 0, 0, u[i], v[i], 1, -u[i] * y[i], -v[i] * y[i], y[i]},
+        };
+        for (int r = 0; r < 2; r++) {
+            for (int j = 0; j < 8; j++) {
+                if (rows[r][j] == 0) continue;
+                for (int k = 0; k < 9; k++) a[j][k] += rows[r][j] * rows[r][k];
+            }
+        }
+    }
+    for (int col = 0; col < 8; col++) {
+        int pivot = col;
+        for (int r = col + 1; r < 8; r++) {
+            if (fabs(a[r][col]) > fabs(a[pivot][col])) pivot = r;
+        }
+        if (fabs(a[pivot][col]) < 1e-9) return false;
+        if (pivot != col) {
+            for (int k = 0; k < 9; k++) {
+                double tmp = a[col][k];
+                a[col][k] = a[pivot][k];
+                a[pivot][k] = tmp;
+            }
+        }
+        for (int r = 0; r < 8; r++) {
+            if (r == col) continue;
+            double f = a[r][col] / a[col][col];
+            for (int k = col; k < 9; k++) a[r][k] -= f * a[col][k];
+        }
+    }
+    for (int i = 0; i < 8; i++) t->m[i] = a[i][8] / a[i][i];
+    t->m[8] = 1;
+    return true;
+}
+
+typedef struct {
+    float x[4];         // Outer corners: -u-v, +u-v, -u+v, +u+v
+    float y[4];
+} qr_corners_t;
+
+/**
+ * Outer corners of a finder pattern: the black pixels furthest along each
+ * diagonal, inside its separator
+ * @param ux, uy, vx, vy One module along each axis of the symbol
+ */
+static bool finderCorners(const code_image_t& image, const qr_finder_t& f, float ux, float uy, float vx, float vy,
+                          qr_corners_t* corners) {
+    float det = ux * vy - uy * vx;
+    if (fabsf(det) < 0.5f) return false;
+    float reach = 4.5f * (fabsf(ux) + fabsf(vx) > fabsf(uy) + fabsf(vy) ? fabsf(ux) + fabsf(vx) : fabsf(uy) + fabsf(vy));
+    int x0 = (int)(f.x - reach), x1 = (int)(f.x + reach), y0 = (int)(f.y - reach), y1 = (int)(f.y + reach);
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 >= image.width) x1 = image.width - 1;
+    if (y1 >= image.height) y1 = image.height - 1;
+
+    float best[4] = {-1e9f, -1e9f, -1e9f, -1e9f};
+    for (int y = y0; y <= y1; y++) {
+        for (int x = x0; x <= x1; x++) {
+            float dx = x + 0.5f - f.x, dy = y + 0.5f - f.y;
+            float du = (vy * dx - vx * dy) / det, dv = (-uy * dx + ux * dy) / det;
+            if (fabsf(du) >= 4.0f || fabsf(dv) >= 4.0f || !isBlack(image, x, y)) continue;
+            for (int k = 0; k < 4; k++) {
+                float along = (k & 1 ? du : -du) + (k & 2 ? dv : -dv);
+                if (along > best[k]) {
+                    best[k] = along;
+                    // Out to the pixel's own corner
+                    float ox = (k & 1 ? ux : -ux) + (k & 2 ? vx : -vx);
+                    float oy = (k & 1 ? uy : -uy) + (k & 2 ? vy : -vy);
+                    corners->x[k] = x + 0.5f + (ox > 0 ? 0.5f : -0.5f);
+                    corners->y[k] = y + 0.5f + (oy > 0 ? 0.5f : -0.5f);
+                }
+            }
+        }
+    }
+    // A 7x7 square reaches 3.5 + 3.5 modules along each diagonal
+    for (int k = 0; k < 4; k++) {
+        if (best[k] < 5.5f) return false;
+    }
+    return true;
+}
+
+/**
+ * Fraction of the two timing patterns that alternate as they should
+ */
+static float timingScore(const code_image_t& image, const qr_transform_t& t, int dimension) {
+    int good = 0, total = 0;
+    for (int i = 8; i < dimension - 8; i++) {
+        bool expected = (i % 2) == 0;
+        float x, y;
+        bool inside = true;
+        transformPoint(t, i + 0.5f, 6.5f, &x, &y);
+        if (isBlackAt(image, x, y, &inside) == expected && inside) good++;
+        inside = true;
+        transformPoint(t, 6.5f, i + 0.5f, &x, &y);
+        if (isBlackAt(image, x, y, &inside) == expected && inside) good++;
+        total += 2;
+    }
+    return total ? (float)good / total : 0;
+}
+
+/**
+ * Find the alignment pattern within reach modules of (u, v): a black
+ * module inside a white ring inside a black ring, nearest first
+ */
+static bool findAlignment(const code_image_t& image, const qr_transform_t& t, float u, float v, int reach,
+                          float* outX, float* outY) {
+    float cx, cy, ux, uy, vx, vy;
+    transformPoint(t, u, v, &cx, &cy);
+    transformPoint(t, u + 1, v, &ux, &uy);
+    transformPoint(t, u, v + 1, &vx, &vy);
+    ux -= cx;
+    uy -= cy;
+    vx -= cx;
+    vy -= cy;
+    float module = sqrtf((ux * ux + uy * uy + vx * vx + vy * vy) / 2);
+    int radius = (int)(module * reach) + 2;
+
+    static const int8_t RING[8][2] = {{1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}};
+    static const float SCALES[3] = {1.0f, 0.8f, 1.25f};
+    // Score pixel centres around the prediction
+    static uint8_t scores[(2 * 80 + 1) * (2 * 80 + 1)];
+    if (radius > 80) radius = 80;
+    int side = 2 * radius + 1;
+    float baseX = floorf(cx) + 0.5f, baseY = floorf(cy) + 0.5f;
+    int bestScore = -1, bestDistance = 0, bestIndex = -1;
+    for (int dy = -radius; dy <= radius; dy++) {
+        for (int dx = -radius; dx <= radius; dx++) {
+            float px = baseX + dx, py = baseY + dy;
+            int index = (dy + radius) * side + dx + radius;
+            scores[index] = 0;
+            bool inside = true;
+            if (!isBlackAt(image, px, py, &inside) || !inside) continue;
+            // Perspective makes the modules here larger or smaller than
+            // the guess; take the best of three scales
+            int score = 0;
+            for (int k = 0; k < 3 && score < 17; k++) {
+                int matched = 1;
+                for (int r = 0; r < 8; r++) {
+                    float ax = (RING[r][0] * ux + RING[r][1] * vx) * SCALES[k];
+                    float ay = (RING[r][0] * uy + RING[r][1] * vy) * SCALES[k];
+                    inside = true;
+                    if (!isBlackAt(image, px + ax, py + ay, &inside) && inside) matched++;
+                    inside = true;
+                    if (isBlackAt(image, px + 2 * ax, py + 2 * ay, &inside) && inside) matched++;
+                }
+                if (matched > score) score = matched;
+            }
+            scores[index] = (uint8_t)score;
+            int distance = dx * dx + dy * dy;
+            if (score > bestScore || (score == bestScore && distance < bestDistance)) {
+                bestScore = score;
+                bestDistance = distance;
+                bestIndex = index;
+            }
+        }
+    }
+    if (bestScore < 16) return false;
+
+    // Centre of the equally good pixels within a module of the nearest
+    int bx = bestIndex % side, by = bestIndex / side;
+    int near = (int)module + 1;
+    float sumX = 0, sumY = 0;
+    int sumCount = 0;
+    for (int y = by - near; y <= by + near; y++) {
+        for (int x = bx - near; x <= bx + near; x++) {
+            if (x < 0 || y < 0 || x >= side || y >= side || scores[y * side + x] != bestScore) continue;
+            sumX += x;
+            sumY += y;
+            sumCount++;
+        }
+    }
+    *outX = baseX - radius + sumX / sumCount;
+    *outY = baseY - radius + sumY / sumCount;
+    return true;
+}
+
+// ===================================================================
+// QR: DECODING
+// ===================================================================
+
+static uint8_t modules[QR_MAX_DIMENSION * QR_MAX_DIMENSION];
+
+static void sampleGrid(const code_image_t& image, const qr_transform_t& t, int dimension) {
+    for (int y = 0; y < dimension; y++) {
+        for (int x = 0; x < dimension; x++) {
+            float px, py;
+            bool inside = true;
+            transformPoint(t, x + 0.5f, y + 0.5f, &px, &py);
+            modules[y * dimension + x] = isBlackAt(image, px, py, &inside) ? 1 : 0;
+        }
+    }
+}
+
+static int hammingDistance(uint32_t a, uint32_t b) {
+    uint32_t d = a ^ b;
+    int count = 0;
+    while (d) {
+        d &= d - 1;
+        count++;
+    }
+    return count;
+}
+
+static bool readFormat(int dimension, qr_ec_level_t* level, uint8_t* mask) {
+    uint32_t first = 0, second = 0;
+    static const uint8_t FIRST[15][2] = {
+        {0, 8}, {1, 8}, {2, 8}, {3, 8}, {4, 8}, {5, 8}, {7, 8}, {8, 8},
+        {8, 7}, {8, 5}, {8, 4}, {8, 3}, {8, 2}, {8, 1}, {8, 0},
+    };
+    for (int i = 0; i < 15; i++) first = (first << 1) | modules[FIRST[i][1] * dimension + FIRST[i][0]];
+    for (int y = dimension - 1; y >= dimension - 7; y--) second = (second << 1) | modules[y * dimension + 8];
+    for (int x = dimension - 8; x < dimension; x++) second = (second << 1) | modules[8 * dimension + x];
+
+    int best = 16;
+    for (int l = 0; l < 4; l++) {
+        for (int m = 0; m < 8; m++) {
+            uint16_t bits = qrFormatBits((qr_ec_level_t)l, (uint8_t)m);
+            int d = hammingDistance(first, bits);
+            int d2 = hammingDistance(second, bits);
+            if (d2 < d) d = d2;
+            if (d < best) {
+                best = d;
+                *level = (qr_ec_level_t)l;
+                *mask = (uint8_t)m;
+            }
+        }
+    }
+    return best <= 3;
+}
+
+typedef struct {
+    const uint8_t* data;
+    size_t length;
+    size_t bit;
+} bit_reader_t;
+
+static inline bool bitsLeft(const bit_reader_t& r, size_t n) {
+    return r.bit + n <= r.length * 8;
+}
+
+static uint32_t readBits(bit_reader_t& r, int n) {
+    uint32_t value = 0;
+    for (int i = 0; i < n; i++) {
+        value = (value << 1) | ((r.data[r.bit / 8] >> (7 - r.bit % 8)) & 1);
+        r.bit++;
+    }
+    return value;
+}
+
+static bool emit(code_result_t* result, uint8_t byte) {
+    if (result->length >= CODE_MAX_PAYLOAD) return false;
+    result->payload[result->length++] = byte;
+    return true;
+}
+
+static bool parseSegments(const uint8_t* data, size_t length, uint8_t version, code_result_t* result) {
+    bit_reader_t r = {data, length, 0};
+    bool large = version >= 10;
+    while (bitsLeft(r, 4)) {
+        uint32_t mode = readBits(r, 4);
+        if (mode == 0) break;
+
+        if (mode == 7) {            // ECI: skip the designator
+            if (!bitsLeft(r, 8)) return false;
+            uint32_t first = readBits(r, 8);
+            int extra = (first & 0x80) == 0 ? 0 : ((first & 0xC0) == 0x80 ? 8 : 16);
+            if (!bitsLeft(r, extra)) return false;
+            readBits(r, extra);
+            continue;
+        }
+        if (mode == 3) {            // Structured append header
+            if (!bitsLeft(r, 16)) return false;
+            readBits(r, 16);
+            continue;
+        }
+        if (mode == 5) continue;    // FNC1, first position
+        if (mode == 9) {            // FNC1, second position
+            if (!bitsLeft(r, 8)) return false;
+            readBits(r, 8);
+            continue;
+        }
+
+        int countBits;
+        switch (mode) {
+            case 1: countBits = large ? 12 : 10; break;
+            case 2: countBits = large ? 11 : 9; break;
+            case 4: countBits = large ? 16 : 8; break;
+            case 8: countBits = large ? 10 : 8; break;
+            default: return false;
+        }
+        if (!bitsLeft(r, countBits)) return false;
+        uint32_t count = readBits(r, countBits);
+
+        if (mode == 1) {
+            while (count >= 3) {
+                if (!bitsLeft(r, 10)) return false;
+                uint32_t v = readBits(r, 10);
+                if (v > 999) return false;
+                if (!emit(result, '0' + v / 100) || !emit(result, '0' + v / 10 % 10) || !emit(result, '0' + v % 10)) return false;
+                count -= 3;
+            }
+            if (count == 2) {
+                if (!bitsLeft(r, 7)) return false;
+                uint32_t v = readBits(r, 7);
+                if (v > 99) return false;
+                if (!emit(result, '0' + v / 10) || !emit(result, '0' + v % 10)) return false;
+            } else if (count == 1) {
+                if (!bitsLeft(r, 4)) return false;
+                uint32_t v = readBits(r, 4);
+                if (v > 9) return false;
+                if (!emit(result, '0' + v)) return false;
+            }
+        } else if (mode == 2) {
+            while (count >= 2) {
+                if (!bitsLeft(r, 11)) return false;
+                uint32_t v = readBits(r, 11);
+                if (v >= 45 * 45) return false;
+                if (!emit(result, QR_ALPHANUMERIC[v / 45]) || !emit(result, QR_ALPHANUMERIC[v % 45])) return false;
+                count -= 2;
+            }
+            if (count == 1) {
+                if (!bitsLeft(r, 6)) return false;
+                uint32_t v = readBits(r, 6);
+                if (v >= 45) return false;
+                if (!emit(result, QR_ALPHANUMERIC[v])) return false;
+            }
+        } else if (mode == 4) {
+            if (!bitsLeft(r, 8 * count)) return false;
+            for (uint32_t i = 0; i < count; i++) {
+                if (!emit(result, (uint8_t)readBits(r, 8))) return false;
+            }
+        } else {                    // Kanji, as Shift JIS
+            if (!bitsLeft(r, 13 * count)) return false;
+            for (uint32_t i = 0; i < count; i++) {
+                uint32_t v = readBits(r, 13);
+                uint32_t c = ((v / 0xC0) << 8) | (v % 0xC0);
+                c += c < 0x1F00 ? 0x8140 : 0xC140;
+                if (!emit(result, (uint8_t)(c >> 8)) || !emit(result, (uint8_t)c)) return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Read, correct and parse the sampled grid
+ */
+static bool decodeGrid(uint8_t version, code_result_t* result) {
+    int dimension = 17 + 4 * version;
+    qr_ec_level_t level = QR_EC_L;
+    uint8_t mask = 0;
+    if (!readFormat(dimension, &level, &mask)) return false;
+
+    // Codewords in placement order: column pairs from the right, snaking up and down
+    static uint8_t codewords[400];
+    uint16_t total = qrTotalCodewords(version);
+    memset(codewords, 0, total);
+    size_t bit = 0;
+    bool upward = true;
+    for (int right = dimension - 1; right > 0; right -= 2) {
+        if (right == 6) right = 5;
+        for (int i = 0; i < dimension; i++) {
+            int y = upward ? dimension - 1 - i : i;
+            for (int c = 0; c < 2; c++) {
+                int x = right - c;
+                if (qrIsFunctionModule(version, x, y)) continue;
+                if (bit < (size_t)total * 8) {
+                    uint8_t value = modules[y * dimension + x] ^ (qrMaskBit(mask, x, y) ? 1 : 0);
+                    if (value) codewords[bit / 8] |= (uint8_t)(0x80 >> (bit % 8));
+                }
+                bit++;
+            }
+        }
+        upward = !upward;
+    }
+
+    // De-interleave into blocks, correct, and gather the data codewords
+    uint8_t blocks, longBlocks, shortData, ecPerBlock;
+    qrBlockLayout(version, level, &blocks, &longBlocks, &shortData, &ecPerBlock);
+    uint8_t shortBlocks = blocks - longBlocks;
+    static uint8_t data[400];
+    static uint8_t block[160];
+    size_t dataLength = 0;
+    int corrected = 0;
+    size_t totalData = (size_t)shortBlocks * shortData + (size_t)longBlocks * (shortData + 1);
+    for (uint8_t b = 0; b < blocks; b++) {
+        uint8_t blockData = shortData + (b >= shortBlocks ? 1 : 0);
+        size_t n = 0;
+        for (uint8_t i = 0; i < blockData; i++) {
+            // Short blocks have no codeword in the last data column
+            size_t index = (size_t)i * blocks + b;
+            if (i == shortData) index = (size_t)shortData * blocks + (b - shortBlocks);
+            block[n++] = codewords[index];
+        }
+        for (uint8_t i = 0; i < ecPerBlock; i++) block[n++] = codewords[totalData + (size_t)i * blocks + b];
+        int fixed = qrCorrectBlock(block, n, ecPerBlock);
+        if (fixed < 0) return false;
+        corrected += fixed;
+        memcpy(&data[dataLength], block, blockData);
+        dataLength += blockData;
+    }
+
+    result->symbology = CODE_SYMBOLOGY_QR;
+    result->version = version;
+    result->length = 0;
+    result->corrected = (uint16_t)corrected;
+    return parseSegments(data, dataLength, version, result);
+}
+
+static bool decodeAt(const code_image_t& image, const qr_finder_t& tl, const qr_finder_t& tr,
+                     const qr_finder_t& bl, code_result_t* result) {
+    // Module size from the pattern widths, corrected for rotation
+    float angle = atan2f(tr.y - tl.y, tr.x - tl.x);
+    float c = fabsf(cosf(angle)), s = fabsf(sinf(angle));
+    float module = (tl.size + tr.size + bl.size) / 3.0f / 7.0f * (c > s ? c : s);
+    if (module < 1.0f) return false;
+    float top = sqrtf((tr.x - tl.x) * (tr.x - tl.x) + (tr.y - tl.y) * (tr.y - tl.y));
+    float left = sqrtf((bl.x - tl.x) * (bl.x - tl.x) + (bl.y - tl.y) * (bl.y - tl.y));
+    int estimate = (int)lroundf((top + left) / 2 / module) + 7;
+
+    // Finder corners: twelve points that carry the perspective, so even
+    // version 1 (no alignment pattern) is sampled square
+    float ux = (tr.x - tl.x) / top * module, uy = (tr.y - tl.y) / top * module;
+    float vx = (bl.x - tl.x) / left * module, vy = (bl.y - tl.y) / left * module;
+    qr_corners_t corners[3];
+    bool haveCorners = finderCorners(image, tl, ux, uy, vx, vy, &corners[0]) &&
+                       finderCorners(image, tr, ux, uy, vx, vy, &corners[1]) &&
+                       finderCorners(image, bl, ux, uy, vx, vy, &corners[2]);
+
+    // Candidate sizes near the estimate, each with its best transform
+    int dims[6];
+    float scores[6];
+    qr_transform_t transforms[6];
+    int count = 0;
+    int base = estimate - ((estimate - 21) % 4 + 4) % 4;
+    for (int d = base - 8; d <= base + 12 && count < 6; d += 4) {
+        if (d < 21 || d > QR_MAX_DIMENSION) continue;
+        qr_transform_t t = affineTransform(tl, tr, bl, d);
+        float pu[QR_MAX_FIT_POINTS], pv[QR_MAX_FIT_POINTS], px[QR_MAX_FIT_POINTS], py[QR_MAX_FIT_POINTS];
+        int n = 0;
+        if (haveCorners) {
+            // Module position of each finder's top-left corner
+            const float origin[3][2] = {{0, 0}, {(float)d - 7, 0}, {0, (float)d - 7}};
+            for (int f = 0; f < 3; f++) {
+                for (int k = 0; k < 4; k++) {
+                    pu[n] = origin[f][0] + (k & 1 ? 7 : 0);
+                    pv[n] = origin[f][1] + (k & 2 ? 7 : 0);
+                    px[n] = corners[f].x[k];
+                    py[n] = corners[f].y[k];
+                    n++;
+                }
+            }
+            qr_transform_t fitted;
+            if (!fitTransform(pu, pv, px, py, n, &fitted)) n = 0;
+            else t = fitted;
+        }
+        float score = timingScore(image, t, d);
+
+        // From version 2 the bottom-right alignment pattern pins the far
+        // corner; perspective moves it from the guess, so look close first
+        float ax, ay;
+        float centre = d - 6.5f;
+        if (d >= 25 && (findAlignment(image, t, centre, centre, 3, &ax, &ay) ||
+                        findAlignment(image, t, centre, centre, 8, &ax, &ay))) {
+            if (n == 0) {
+                const float u[3] = {3.5f, d - 3.5f, 3.5f}, v[3] = {3.5f, 3.5f, d - 3.5f};
+                const qr_finder_t* f[3] = {&tl, &tr, &bl};
+                for (; n < 3; n++) {
+                    pu[n] = u[n];
+                    pv[n] = v[n];
+                    px[n] = f[n]->x;
+                    py[n] = f[n]->y;
+                }
+            }
+            // Weighted as all the finder corners together: it is the only
+            // point near the far corner
+            for (int i = 0; i < 12; i++, n++) {
+                pu[n] = centre;
+                pv[n] = centre;
+                px[n] = ax;
+                py[n] = ay;
+            }
+            qr_transform_t p;
+            if (fitTransform(pu, pv, px, py, n, &p)) {
+                float perspectiveScore = timingScore(image, p, d);
+                if (perspectiveScore >= score) {
+                    t = p;
+                    score = perspectiveScore;
+                }
+            }
+        }
+        dims[count] = d;
+        scores[count] = score;
+        transforms[count] = t;
+        count++;
+    }
+
+    // Best timing patterns first
+    for (int attempt = 0; attempt < count; attempt++) {
+        int best = -1;
+        for (int i = 0; i < count; i++) {
+            if (scores[i] >= 0 && (best < 0 || scores[i] > scores[best])) best = i;
+        }
+        if (best < 0 || scores[best] < 0.75f) return false;
+        scores[best] = -1;
+        sampleGrid(image, transforms[best], dims[best]);
+        if (decodeGrid((uint8_t)((dims[best] - 17) / 4), result)) return true;
+    }
+    return false;
+}
+
+bool qrDecode(const uint8_t* gray, uint16_t width, uint16_t height, size_t stride, code_result_t* result) {
+    if (!gray || !result || width < 21 || height < 21 || !buildThresholds(gray, width, height, stride)) return false;
+    code_image_t image = {gray, width, height, stride};
+    findFinders(image);
+    if (finderCount < 3) return false;
+
+    // Triples forming a right isosceles triangle, best first
+    typedef struct {
+        uint8_t tl, tr, bl;
+        float score;
+    } triple_t;
+    triple_t triples[8];
+    int tripleCount = 0;
+    for (int a = 0; a < finderCount; a++) {
+        for (int b = a + 1; b < finderCount; b++) {
+            for (int c = b + 1; c < finderCount; c++) {
+                const qr_finder_t* p[3] = {&finders[a], &finders[b], &finders[c]};
+                int index[3] = {a, b, c};
+                float maxSize = 0, minSize = 1e9f;
+                for (int i = 0; i < 3; i++) {
+                    if (p[i]->size > maxSize) maxSize = p[i]->size;
+                    if (p[i]->size < minSize) minSize = p[i]->size;
+                }
+                if (maxSize > minSize * 1.5f) continue;
+
+                // The corner is opposite the longest side
+                float d[3];
+                for (int i = 0; i < 3; i++) {
+                    const qr_finder_t* q = p[(i + 1) % 3];
+                    const qr_finder_t* r = p[(i + 2) % 3];
+                    d[i] = (q->x - r->x) * (q->x - r->x) + (q->y - r->y) * (q->y - r->y);
+                }
+                int corner = d[0] > d[1] ? (d[0] > d[2] ? 0 : 2) : (d[1] > d[2] ? 1 : 2);
+                float leg1 = d[(corner + 1) % 3], leg2 = d[(corner + 2) % 3];
+                if (leg1 < 100 || leg2 < 100) continue;
+                float legRatio = fabsf(sqrtf(leg1) - sqrtf(leg2)) / sqrtf(leg1 > leg2 ? leg1 : leg2);
+                float rightAngle = fabsf(d[corner] - leg1 - leg2) / d[corner];
+                if (legRatio > 0.3f || rightAngle > 0.3f) continue;
+
+                const qr_finder_t* tl = p[corner];
+                const qr_finder_t* b1 = p[(corner + 1) % 3];
+                const qr_finder_t* b2 = p[(corner + 2) % 3];
+                float cross = (b1->x - tl->x) * (b2->y - tl->y) - (b1->y - tl->y) * (b2->x - tl->x);
+                triple_t t;
+                t.tl = (uint8_t)index[corner];
+                t.tr = (uint8_t)(cross > 0 ? index[(corner + 1) % 3] : index[(corner + 2) % 3]);
+                t.bl = (uint8_t)(cross > 0 ? index[(corner + 2) % 3] : index[(corner + 1) % 3]);
+                t.score = legRatio + rightAngle + (maxSize - minSize) / maxSize;
+
+                // Keep the best few, sorted
+                int pos = tripleCount < 8 ? tripleCount++ : 8;
+                while (pos > 0 && triples[pos - 1].score > t.score) {
+                    if (pos < 8) triples[pos] = triples[pos - 1];
+                    pos--;
+                }
+                if (pos < 8) triples[pos] = t;
+            }
+        }
+    }
+
+    for (int i = 0; i < tripleCount && i < 4; i++) {
+        if (decodeAt(image, finders[triples[i].tl], finders[triples[i].tr], finders[triples[i].bl], result)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// ===================================================================
+// EAN-13
+// ===================================================================
+
+// Bar/space widths of the L codes (space first); G codes are these
+// reversed, R codes the same widths bar first
+static const uint8_t EAN_L[10][4] = {
+    {3, 2, 1, 1}, {2, 2, 2, 1}, {2, 1, 2, 2}, {1, 4, 1, 1}, {1, 1, 3, 2},
+    {1, 2, 3, 1}, {1, 1, 1, 4}, {1, 3, 1, 2}, {1, 2, 1, 3}, {3, 1, 1, 2},
+};
+
+// Parity of the left digits (bit 5 = first digit, 1 = G) for each leading digit
+static const uint8_t EAN_PARITY[10] = {0x00, 0x0B, 0x0D, 0x0E, 0x13, 0x19, 0x1C, 0x15, 0x16, 0x1A};
+
+#define EAN_MAX_RUNS 1100
+#define EAN_RUNS 59     // Start guard, 6 digits, middle guard, 6 digits, end guard
+
+static uint16_t runs[EAN_MAX_RUNS];
+
+/**
+ * Best digit for four widths
+ * @param reversed Compare against the G codes
+ * @return Digit, or -1 if none is close
+ */
+static int matchDigit(const uint16_t* w, bool reversed, float* variance) {
+    float total = (float)(w[0] + w[1] + w[2] + w[3]);
+    if (total < 7) return -1;
+    float unit = total / 7.0f;
+    int best = -1;
+    float bestVariance = 1e9f;
+    for (int d = 0; d < 10; d++) {
+        float v = 0, worst = 0;
+        for (int i = 0; i < 4; i++) {
+            float expected = reversed ? EAN_L[d][3 - i] : EAN_L[d][i];
+            float e = fabsf(w[i] / unit - expected);
+            v += e;
+            if (e > worst) worst = e;
+        }
+        if (worst < 0.8f && v < bestVariance) {
+            bestVariance = v;
+            best = d;
+        }
+    }
+    *variance = bestVariance;
+    return bestVariance <= 1.6f ? best : -1;
+}
+
+static bool guardMatches(const uint16_t* w, int count, float unit) {
+    for (int i = 0; i < count; i++) {
+        if (w[i] < unit * 0.4f || w[i] > unit * 1.8f) return false;
+    }
+    return true;
+}
+
+/**
+ * Decode 59 runs starting at the first bar of the start guard
+ */
+static bool decodeEanRuns(const uint16_t* r, code_result_t* result) {
+    float unit = (r[0] + r[1] + r[2]) / 3.0f;
+    if (!guardMatches(r, 3, unit)) return false;
+
+    uint8_t digits[13];
+    uint8_t parity = 0;
+    float variance;
+    for (int i = 0; i < 6; i++) {
+        const uint16_t* w = &r[3 + 4 * i];
+        float vl, vg;
+        int l = matchDigit(w, false, &vl);
+        int g = matchDigit(w, true, &vg);
+        if (l < 0 && g < 0) return false;
+        bool useG = g >= 0 && (l < 0 || vg < vl);
+        digits[1 + i] = (uint8_t)(useG ? g : l);
+        parity = (uint8_t)((parity << 1) | (useG ? 1 : 0));
+    }
+    float middleUnit = (r[27] + r[28] + r[29] + r[30] + r[31]) / 5.0f;
+    if (!guardMatches(&r[27], 5, middleUnit)) return false;
+    for (int i = 0; i < 6; i++) {
+        int d = matchDigit(&r[32 + 4 * i], false, &variance);
+        if (d < 0) return false;
+        digits[7 + i] = (uint8_t)d;
+    }
+    float endUnit = (r[56] + r[57] + r[58]) / 3.0f;
+    if (!guardMatches(&r[56], 3, endUnit)) return false;
+
+    int first = -1;
+    for (int d = 0; d < 10; d++) {
+        if (EAN_PARITY[d] == parity) first = d;
+    }
+    if (first < 0) return false;
+    digits[0] = (uint8_t)first;
+
+    int sum = 0;
+    for (int i = 0; i < 12; i++) sum += digits[i] * (i % 2 ? 3 : 1);
+    if ((10 - sum % 10) % 10 != digits[12]) return false;
+
+    result->symbology = CODE_SYMBOLOGY_EAN13;
+    result->version = 0;
+    result->corrected = 0;
+    result->length = 13;
+    for (int i = 0; i < 13; i++) result->payload[i] = (uint8_t)('0' + digits[i]);
+    return true;
+}
+
+/**
+ * Runs along a line; the first run is white
+ * @return Number of runs
+ */
+static int lineRuns(const code_image_t& image, int x, int y, int dx, int dy, int length) {
+    int count = 0;
+    bool black = false;
+    uint16_t run = 0;
+    for (int i = 0; i < length; i++, x += dx, y += dy) {
+        bool b = isBlack(image, x, y);
+        if (b == black) {
+            if (run < 0xFFFF) run++;
+        } else {
+            if (count >= EAN_MAX_RUNS) return count;
+            runs[count++] = run;
+            run = 1;
+            black = b;
+        }
+    }
+    if (count < EAN_MAX_RUNS) runs[count++] = run;
+    return count;
+}
+
+static bool scanRuns(int count, code_result_t* result) {
+    // Odd indices are bars. Need a quiet zone before the start guard
+    for (int k = 1; k + EAN_RUNS <= count; k += 2) {
+        float unit = (runs[k] + runs[k + 1] + runs[k + 2]) / 3.0f;
+        if (runs[k - 1] < unit * 3) continue;
+        if (decodeEanRuns(&runs[k], result)) return true;
+    }
+    return false;
+}
+
+static bool scanLine(const code_image_t& image, int x, int y, int dx, int dy, int length, code_result_t* result) {
+    int count = lineRuns(image, x, y, dx, dy, length);
+    if (scanRuns(count, result)) return true;
+
+    // Upside down: the same runs backwards, white first
+    for (int i = 0; i < count / 2; i++) {
+        uint16_t tmp = runs[i];
+        runs[i] = runs[count - 1 - i];
+        runs[count - 1 - i] = tmp;
+    }
+    if (count % 2 == 0) {
+        // Ended on a bar: put an empty white run in front
+        if (count >= EAN_MAX_RUNS) return false;
+        memmove(&runs[1], &runs[0], count * sizeof(runs[0]));
+        runs[0] = 0;
+        count++;
+    }
+    return scanRuns(count, result);
+}
+
+bool ean13Decode(const uint8_t* gray, uint16_t width, uint16_t height, size_t stride, code_result_t* result) {
+    if (!gray || !result || width < 95 || height < 8 || !buildThresholds(gray, width, height, stride)) return false;
+    code_image_t image = {gray, width, height, stride};
+
+    // Rows, then columns, from the middle out
+    for (int i = 0; i < 16; i++) {
+        int offset = ((i + 1) / 2) * (height / 32) * (i % 2 ? 1 : -1);
+        int y = height / 2 + offset;
+        if (y >= 0 && y < height && scanLine(image, 0, y, 1, 0, width, result)) return true;
+    }
+    if (height >= 95) {
+        for (int i = 0; i < 16; i++) {
+            int offset = ((i + 1) / 2) * (width / 32) * (i % 2 ? 1 : -1);
+            int x = width / 2 + offset;
+            if (x >= 0 && x < width && scanLine(image, x, 0, 0, 1, height, result)) return true;
+        }
+    }
+    return false;
+}
+
+// ===================================================================
+// SCAN
+// ===================================================================
+
+bool codeScan(const uint8_t* gray, uint16_t width, uint16_t height, size_t stride, code_result_t* result) {
+    if (!result) return false;
+    result->symbology = CODE_SYMBOLOGY_NONE;
+    result->length = 0;
+    if (qrDecode(gray, width, height, stride, result)) return true;
+    if (ean13Decode(gray, width, height, stride, result)) return true;
+    result->symbology = CODE_SYMBOLOGY_NONE;
+    result->length = 0;
+    return false;
+}
+
+const char* codeSymbologyName(uint8_t symbology) {
+    switch (symbology) {
+        case CODE_SYMBOLOGY_QR: return "QR";
+        case CODE_SYMBOLOGY_EAN13: return "EAN-13";
+        default: return "none";
+    }
+}
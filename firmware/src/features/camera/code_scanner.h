@@ -0,0 +1,120 @@
+#ifndef CODE_SCANNER_H
+#define CODE_SCANNER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ===================================================================
+// CODE SCANNER
+// ===================================================================
+//
+// QR and EAN-13 / UPC-A decoding on a grayscale frame, so a scan can send
+// the decoded text instead of the photo (PHOTO_SCAN_CODE).
+//
+// Both decoders threshold against the local mean (16x16 tiles, smoothed
+// over their neighbours), so uneven light across the frame is fine.
+//
+// QR: models 2, versions 1-10 (up to 57x57 modules), all EC levels and
+// masks, numeric, alphanumeric and byte segments (ECI headers are
+// skipped). Finder patterns are found by their 1:1:3:1:1 runs along
+// rows and checked down the column and along the row. The outer corners
+// of the three finders (and from version 2 the bottom-right alignment
+// pattern) give a perspective transform by least squares, so a tilted
+// code still samples cleanly. Blocks are Reed-Solomon corrected.
+//
+// EAN-13 (UPC-A is EAN-13 with a leading 0): rows and then columns from
+// the centre of the frame outwards are read in both directions, digit by
+// digit, and a result is only accepted with a valid check digit.
+//
+// Work memory is static (a few KB); no allocation. No Arduino
+// dependencies.
+//
+
+#define CODE_SYMBOLOGY_NONE 0
+#define CODE_SYMBOLOGY_QR 1
+#define CODE_SYMBOLOGY_EAN13 2
+
+#define CODE_MAX_PAYLOAD 512        // Bytes of text kept (QR 10-L holds 271 bytes)
+
+#define QR_MIN_VERSION 1
+#define QR_MAX_VERSION 10
+#define QR_MAX_DIMENSION (17 + 4 * QR_MAX_VERSION)
+
+// Threshold tiles (frames up to 1024 pixels on each side)
+#define CODE_TILE_SIZE 16
+#define CODE_MAX_TILES 64
+
+typedef enum {
+    QR_EC_L = 0,
+    QR_EC_M = 1,
+    QR_EC_Q = 2,
+    QR_EC_H = 3
+} qr_ec_level_t;
+
+typedef struct {
+    uint8_t symbology;              // CODE_SYMBOLOGY_*
+    uint8_t version;                // QR version (0 for EAN-13)
+    uint16_t length;                // Bytes in payload
+    uint16_t corrected;             // Codewords Reed-Solomon corrected (QR)
+    uint8_t payload[CODE_MAX_PAYLOAD];
+} code_result_t;
+
+/**
+ * Look for a QR code, then an EAN-13 barcode
+ * @param gray width x height, rows stride bytes apart
+ * @return true if one was decoded (result filled)
+ */
+bool codeScan(const uint8_t* gray, uint16_t width, uint16_t height, size_t stride, code_result_t* result);
+
+/** QR code only */
+bool qrDecode(const uint8_t* gray, uint16_t width, uint16_t height, size_t stride, code_result_t* result);
+
+/** EAN-13 / UPC-A only; the payload is the 13 digits */
+bool ean13Decode(const uint8_t* gray, uint16_t width, uint16_t height, size_t stride, code_result_t* result);
+
+/** "QR", "EAN-13" or "none" */
+const char* codeSymbologyName(uint8_t symbology);
+
+// ===================================================================
+// QR BUILDING BLOCKS (shared with the host tests' encoder)
+// ===================================================================
+
+/** 15-bit format information (BCH coded and masked) for a level and mask */
+uint16_t qrFormatBits(qr_ec_level_t level, uint8_t mask);
+
+/** 18-bit version information (versions 7 and up) */
+uint32_t qrVersionBits(uint8_t version);
+
+/**
+ * Whether module (x, y) is a finder, separator, timing, alignment, format,
+ * version or dark module rather than data
+ */
+bool qrIsFunctionModule(uint8_t version, int x, int y);
+
+/** Whether mask pattern mask flips module (x, y) */
+bool qrMaskBit(uint8_t mask, int x, int y);
+
+/** Codewords (data + EC) in a symbol */
+uint16_t qrTotalCodewords(uint8_t version);
+
+/**
+ * Block layout of a version and level
+ * @param blocks Number of blocks (the last longBlocks hold one more data codeword)
+ * @param shortData Data codewords in each short block
+ * @param ecPerBlock EC codewords in every block
+ */
+void qrBlockLayout(uint8_t version, qr_ec_level_t level, uint8_t* blocks, uint8_t* longBlocks, uint8_t* shortData,
+                   uint8_t* ecPerBlock);
+
+/**
+ * Correct a Reed-Solomon block in place (data then EC codewords, generator
+ * roots a^0 .. a^(ecCount - 1) over GF(256) / 0x11D)
+ * @return Codewords corrected, or -1 if there are too many errors
+ */
+int qrCorrectBlock(uint8_t* block, size_t length, size_t ecCount);
+
+/** a^n in GF(256) / 0x11D, and the product of two elements */
+uint8_t qrGfExp(int n);
+uint8_t qrGfMultiply(uint8_t a, uint8_t b);
+
+#endif // CODE_SCANNER_H
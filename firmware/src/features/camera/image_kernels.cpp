@@ -0,0 +1,476 @@
+#include "image_kernels.h"
+#include <string.h>
+
+#if defined(IMAGE_KERNELS_SSE2)
+#include <emmintrin.h>
+#elif defined(IMAGE_KERNELS_NEON)
+#include <arm_neon.h>
+#endif
+
+// ===================================================================
+// SCALAR
+// ===================================================================
+
+static inline uint8_t grayFromRgb565(uint8_t high, uint8_t low) {
+    uint32_t pixel = ((uint32_t)high << 8) | low;
+    uint32_t r = pixel >> 11, g = (pixel >> 5) & 0x3F, b = pixel & 0x1F;
+    r = (r << 3) | (r >> 2);
+    g = (g << 2) | (g >> 4);
+    b = (b << 3) | (b >> 2);
+    return (uint8_t)((77 * r + 150 * g + 29 * b + 128) >> 8);
+}
+
+static inline int32_t laplacian(const uint8_t* p, size_t stride) {
+    return 4 * (int32_t)p[0] - p[-1] - p[1] - p[-(ptrdiff_t)stride] - p[stride];
+}
+
+/** Sharpness of one row from column x on */
+static inline uint64_t sharpnessTail(const uint8_t* row, size_t stride, uint16_t x, uint16_t width) {
+    uint64_t sum = 0;
+    for (; x + 1 < width; x++) {
+        int32_t l = laplacian(row + x, stride);
+        sum += (uint32_t)(l * l);
+    }
+    return sum;
+}
+
+/** Directional energy of one row from column x on (see imageDirectionalSharpness) */
+static inline void directionalTail(const uint8_t* row, size_t stride, uint16_t x, uint16_t width, uint64_t energy[4]) {
+    const ptrdiff_t s = (ptrdiff_t)stride;
+    for (; x + 1 < width; x++) {
+        const uint8_t* p = row + x;
+        int32_t c = 2 * (int32_t)p[0];
+        int32_t h = p[-1] + p[1] - c;
+        int32_t v = p[-s] + p[s] - c;
+        int32_t d = p[-s - 1] + p[s + 1] - c;
+        int32_t a = p[-s + 1] + p[s - 1] - c;
+        energy[0] += (uint32_t)(h * h);
+        energy[1] += (uint32_t)(v * v);
+        energy[2] += (uint32_t)(d * d);
+        energy[3] += (uint32_t)(a * a);
+    }
+}
+
+uint32_t imageSad16Scalar(const uint8_t* a, const uint8_t* b, size_t stride) {
+    uint32_t sad = 0;
+    for (int y = 0; y < 16; y++) {
+        for (int x = 0; x < 16; x++) {
+            int32_t d = (int32_t)a[x] - (int32_t)b[x];
+            sad += (uint32_t)(d < 0 ? -d : d);
+        }
+        a += stride;
+        b += stride;
+    }
+    return sad;
+}
+
+void imageDownscale2xScalar(const uint8_t* src, size_t srcStride, uint16_t width, uint16_t height, uint8_t* dst,
+                            size_t dstStride) {
+    uint16_t outWidth = width / 2, outHeight = height / 2;
+    for (uint16_t y = 0; y < outHeight; y++) {
+        const uint8_t* top = src + (size_t)2 * y * srcStride;
+        const uint8_t* bottom = top + srcStride;
+        uint8_t* out = dst + (size_t)y * dstStride;
+        for (uint16_t x = 0; x < outWidth; x++) {
+            out[x] = (uint8_t)((top[2 * x] + top[2 * x + 1] + bottom[2 * x] + bottom[2 * x + 1] + 2) >> 2);
+        }
+    }
+}
+
+void imageRgb565ToGrayScalar(const uint8_t* rgb565, size_t pixels, uint8_t* gray) {
+    for (size_t i = 0; i < pixels; i++) gray[i] = grayFromRgb565(rgb565[2 * i], rgb565[2 * i + 1]);
+}
+
+void imageYuv422ToGrayScalar(const uint8_t* yuv, size_t pixels, uint8_t* gray) {
+    for (size_t i = 0; i < pixels; i++) gray[i] = yuv[2 * i];
+}
+
+void imageHistogramScalar(const uint8_t* pixels, size_t stride, uint16_t width, uint16_t height,
+                          uint32_t histogram[256]) {
+    for (uint16_t y = 0; y < height; y++) {
+        const uint8_t* row = pixels + (size_t)y * stride;
+        for (uint16_t x = 0; x < width; x++) histogram[row[x]]++;
+    }
+}
+
+uint64_t imageSharpnessScalar(const uint8_t* pixels, size_t stride, uint16_t width, uint16_t height) {
+    if (width < 3 || height < 3) return 0;
+    uint64_t sum = 0;
+    for (uint16_t y = 1; y + 1 < height; y++) sum += sharpnessTail(pixels + (size_t)y * stride, stride, 1, width);
+    return sum;
+}
+
+void imageDirectionalSharpnessScalar(const uint8_t* pixels, size_t stride, uint16_t width, uint16_t height,
+                                     uint64_t energy[4]) {
+    energy[0] = energy[1] = energy[2] = energy[3] = 0;
+    if (width < 3 || height < 3) return;
+    for (uint16_t y = 1; y + 1 < height; y++) directionalTail(pixels + (size_t)y * stride, stride, 1, width, energy);
+}
+
+// ===================================================================
+// VECTOR
+// ===================================================================
+
+#if defined(IMAGE_KERNELS_SSE2)
+
+const char* imageKernelsBackend() {
+    return "sse2";
+}
+
+uint32_t imageSad16(const uint8_t* a, const uint8_t* b, size_t stride) {
+    __m128i sum = _mm_setzero_si128();
+    for (int y = 0; y < 16; y++) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + y * stride));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + y * stride));
+        sum = _mm_add_epi64(sum, _mm_sad_epu8(va, vb));
+    }
+    return (uint32_t)(_mm_cvtsi128_si32(sum) + _mm_cvtsi128_si32(_mm_srli_si128(sum, 8)));
+}
+
+/** Rounded 2x2 means of 16 source columns of two rows: 8 16-bit lanes */
+static inline __m128i downscale8(const uint8_t* top, const uint8_t* bottom) {
+    const __m128i lowBytes = _mm_set1_epi16(0x00FF);
+    __m128i t = _mm_loadu_si128((const __m128i*)top);
+    __m128i b = _mm_loadu_si128((const __m128i*)bottom);
+    __m128i sum = _mm_add_epi16(_mm_and_si128(t, lowBytes), _mm_srli_epi16(t, 8));
+    sum = _mm_add_epi16(sum, _mm_add_epi16(_mm_and_si128(b, lowBytes), _mm_srli_epi16(b, 8)));
+    return _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(2)), 2);
+}
+
+void imageDownscale2x(const uint8_t* src, size_t srcStride, uint16_t width, uint16_t height, uint8_t* dst,
+                      size_t dstStride) {
+    uint16_t outWidth = width / 2, outHeight = height / 2;
+    for (uint16_t y = 0; y < outHeight; y++) {
+        const uint8_t* top = src + (size_t)2 * y * srcStride;
+        const uint8_t* bottom = top + srcStride;
+        uint8_t* out = dst + (size_t)y * dstStride;
+        uint16_t x = 0;
+        for (; x + 16 <= outWidth; x += 16) {
+            __m128i left = downscale8(top + 2 * x, bottom + 2 * x);
+            __m128i right = downscale8(top + 2 * x + 16, bottom + 2 * x + 16);
+            _mm_storeu_si128((__m128i*)(out + x), _mm_packus_epi16(left, right));
+        }
+        for (; x < outWidth; x++) {
+            out[x] = (uint8_t)((top[2 * x] + top[2 * x + 1] + bottom[2 * x] + bottom[2 * x + 1] + 2) >> 2);
+        }
+    }
+}
+
+/** Gray values of 8 RGB565 pixels: 8 16-bit lanes */
+static inline __m128i gray8(const uint8_t* rgb565) {
+    const __m128i mask5 = _mm_set1_epi16(0x1F), mask6 = _mm_set1_epi16(0x3F);
+    __m128i v = _mm_loadu_si128((const __m128i*)rgb565);
+    __m128i pixel = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));     // High byte first
+    __m128i r = _mm_srli_epi16(pixel, 11);
+    __m128i g = _mm_and_si128(_mm_srli_epi16(pixel, 5), mask6);
+    __m128i b = _mm_and_si128(pixel, mask5);
+    r = _mm_or_si128(_mm_slli_epi16(r, 3), _mm_srli_epi16(r, 2));
+    g = _mm_or_si128(_mm_slli_epi16(g, 2), _mm_srli_epi16(g, 4));
+    b = _mm_or_si128(_mm_slli_epi16(b, 3), _mm_srli_epi16(b, 2));
+    // At most 256 * 255 + 128: fits unsigned 16-bit
+    __m128i y = _mm_add_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(77)), _mm_mullo_epi16(g, _mm_set1_epi16(150)));
+    y = _mm_add_epi16(y, _mm_mullo_epi16(b, _mm_set1_epi16(29)));
+    return _mm_srli_epi16(_mm_add_epi16(y, _mm_set1_epi16(128)), 8);
+}
+
+void imageRgb565ToGray(const uint8_t* rgb565, size_t pixels, uint8_t* gray) {
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        _mm_storeu_si128((__m128i*)(gray + i), _mm_packus_epi16(gray8(rgb565 + 2 * i), gray8(rgb565 + 2 * i + 16)));
+    }
+    for (; i < pixels; i++) gray[i] = grayFromRgb565(rgb565[2 * i], rgb565[2 * i + 1]);
+}
+
+void imageYuv422ToGray(const uint8_t* yuv, size_t pixels, uint8_t* gray) {
+    const __m128i luma = _mm_set1_epi16(0x00FF);
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        __m128i lo = _mm_and_si128(_mm_loadu_si128((const __m128i*)(yuv + 2 * i)), luma);
+        __m128i hi = _mm_and_si128(_mm_loadu_si128((const __m128i*)(yuv + 2 * i + 16)), luma);
+        _mm_storeu_si128((__m128i*)(gray + i), _mm_packus_epi16(lo, hi));
+    }
+    for (; i < pixels; i++) gray[i] = yuv[2 * i];
+}
+
+uint64_t imageSharpness(const uint8_t* pixels, size_t stride, uint16_t width, uint16_t height) {
+    if (width < 3 || height < 3) return 0;
+    const __m128i zero = _mm_setzero_si128();
+    uint64_t total = 0;
+    for (uint16_t y = 1; y + 1 < height; y++) {
+        const uint8_t* row = pixels + (size_t)y * stride;
+        // Per lane at most 2 x 1020^2 per step and width / 8 steps: fits int32
+        __m128i sum = zero;
+        uint16_t x = 1;
+        for (; x + 9 <= width; x += 8) {
+            const uint8_t* p = row + x;
+            __m128i c = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)p), zero);
+            __m128i l = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(p - 1)), zero);
+            __m128i r = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(p + 1)), zero);
+            __m128i u = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(p - stride)), zero);
+            __m128i d = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(p + stride)), zero);
+            __m128i lap = _mm_sub_epi16(_mm_slli_epi16(c, 2), _mm_add_epi16(_mm_add_epi16(l, r), _mm_add_epi16(u, d)));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(lap, lap));
+        }
+        uint32_t lanes[4];
+        _mm_storeu_si128((__m128i*)lanes, sum);
+        total += (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        total += sharpnessTail(row, stride, x, width);
+    }
+    return total;
+}
+
+void imageDirectionalSharpness(const uint8_t* pixels, size_t stride, uint16_t width, uint16_t height,
+                               uint64_t energy[4]) {
+    energy[0] = energy[1] = energy[2] = energy[3] = 0;
+    if (width < 3 || height < 3) return;
+    const __m128i zero = _mm_setzero_si128();
+    for (uint16_t y = 1; y + 1 < height; y++) {
+        const uint8_t* row = pixels + (size_t)y * stride;
+        // Per lane at most 2 x 510^2 per step and width / 8 steps: fits uint32
+        __m128i sums[4] = {zero, zero, zero, zero};
+        uint16_t x = 1;
+        for (; x + 9 <= width; x += 8) {
+            const uint8_t* p = row + x;
+            const uint8_t* up = p - stride;
+            const uint8_t* down = p + stride;
+            __m128i c = _mm_slli_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)p), zero), 1);
+            __m128i pairs[4] = {
+                _mm_add_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(p - 1)), zero),
+                              _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(p + 1)), zero)),
+                _mm_add_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)up), zero),
+                              _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)down), zero)),
+                _mm_add_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(up - 1)), zero),
+                              _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(down + 1)), zero)),
+                _mm_add_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(up + 1)), zero),
+                              _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(down - 1)), zero)),
+            };
+            for (int k = 0; k < 4; k++) {
+                __m128i e = _mm_sub_epi16(pairs[k], c);
+                sums[k] = _mm_add_epi32(sums[k], _mm_madd_epi16(e, e));
+            }
+        }
+        for (int k = 0; k < 4; k++) {
+            uint32_t lanes[4];
+            _mm_storeu_si128((__m128i*)lanes, sums[k]);
+            energy[k] += (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        }
+        directionalTail(row, stride, x, width, energy);
+    }
+}
+
+#elif defined(IMAGE_KERNELS_NEON)
+
+const char* imageKernelsBackend() {
+    return "neon";
+}
+
+uint32_t imageSad16(const uint8_t* a, const uint8_t* b, size_t stride) {
+    // Per lane at most 16 rows x 2 x 255: fits uint16
+    uint16x8_t sum = vdupq_n_u16(0);
+    for (int y = 0; y < 16; y++) {
+        sum = vpadalq_u8(sum, vabdq_u8(vld1q_u8(a + y * stride), vld1q_u8(b + y * stride)));
+    }
+    uint64x2_t total = vpaddlq_u32(vpaddlq_u16(sum));
+    return (uint32_t)(vgetq_lane_u64(total, 0) + vgetq_lane_u64(total, 1));
+}
+
+void imageDownscale2x(const uint8_t* src, size_t srcStride, uint16_t width, uint16_t height, uint8_t* dst,
+                      size_t dstStride) {
+    uint16_t outWidth = width / 2, outHeight = height / 2;
+    for (uint16_t y = 0; y < outHeight; y++) {
+        const uint8_t* top = src + (size_t)2 * y * srcStride;
+        const uint8_t* bottom = top + srcStride;
+        uint8_t* out = dst + (size_t)y * dstStride;
+        uint16_t x = 0;
+        for (; x + 8 <= outWidth; x += 8) {
+            uint16x8_t sum = vaddq_u16(vpaddlq_u8(vld1q_u8(top + 2 * x)), vpaddlq_u8(vld1q_u8(bottom + 2 * x)));
+            vst1_u8(out + x, vrshrn_n_u16(sum, 2));
+        }
+        for (; x < outWidth; x++) {
+            out[x] = (uint8_t)((top[2 * x] + top[2 * x + 1] + bottom[2 * x] + bottom[2 * x + 1] + 2) >> 2);
+        }
+    }
+}
+
+void imageRgb565ToGray(const uint8_t* rgb565, size_t pixels, uint8_t* gray) {
+    const uint16x8_t mask5 = vdupq_n_u16(0x1F), mask6 = vdupq_n_u16(0x3F);
+    size_t i = 0;
+    for (; i + 8 <= pixels; i += 8) {
+        uint16x8_t pixel = vreinterpretq_u16_u8(vrev16q_u8(vld1q_u8(rgb565 + 2 * i)));     // High byte first
+        uint16x8_t r = vshrq_n_u16(pixel, 11);
+        uint16x8_t g = vandq_u16(vshrq_n_u16(pixel, 5), mask6);
+        uint16x8_t b = vandq_u16(pixel, mask5);
+        r = vorrq_u16(vshlq_n_u16(r, 3), vshrq_n_u16(r, 2));
+        g = vorrq_u16(vshlq_n_u16(g, 2), vshrq_n_u16(g, 4));
+        b = vorrq_u16(vshlq_n_u16(b, 3), vshrq_n_u16(b, 2));
+        uint16x8_t y = vmulq_n_u16(r, 77);
+        y = vmlaq_n_u16(y, g, 150);
+        y = vmlaq_n_u16(y, b, 29);
+        vst1_u8(gray + i, vshrn_n_u16(vaddq_u16(y, vdupq_n_u16(128)), 8));
+    }
+    for (; i < pixels; i++) gray[i] = grayFromRgb565(rgb565[2 * i], rgb565[2 * i + 1]);
+}
+
+void imageYuv422ToGray(const uint8_t* yuv, size_t pixels, uint8_t* gray) {
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) vst1q_u8(gray + i, vld2q_u8(yuv + 2 * i).val[0]);
+    for (; i < pixels; i++) gray[i] = yuv[2 * i];
+}
+
+uint64_t imageSharpness(const uint8_t* pixels, size_t stride, uint16_t width, uint16_t height) {
+    if (width < 3 || height < 3) return 0;
+    uint64_t total = 0;
+    for (uint16_t y = 1; y + 1 < height; y++) {
+        const uint8_t* row = pixels + (size_t)y * stride;
+        // Per lane at most 2 x 1020^2 per step and width / 8 steps: fits uint32
+        uint32x4_t sum = vdupq_n_u32(0);
+        uint16_t x = 1;
+        for (; x + 9 <= width; x += 8) {
+            const uint8_t* p = row + x;
+            int16x8_t c = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(p)));
+            uint16x8_t around = vaddl_u8(vld1_u8(p - 1), vld1_u8(p + 1));
+            around = vaddq_u16(around, vaddl_u8(vld1_u8(p - stride), vld1_u8(p + stride)));
+            int16x8_t lap = vsubq_s16(vshlq_n_s16(c, 2), vreinterpretq_s16_u16(around));
+            int32x4_t squares = vmull_s16(vget_low_s16(lap), vget_low_s16(lap));
+            squares = vmlal_s16(squares, vget_high_s16(lap), vget_high_s16(lap));
+            sum = vaddq_u32(sum, vreinterpretq_u32_s32(squares));
+        }
+        uint64x2_t lanes = vpaddlq_u32(sum);
+        total += vgetq_lane_u64(lanes, 0) + vgetq_lane_u64(lanes, 1);
+        total += sharpnessTail(row, stride, x, width);
+    }
+    return total;
+}
+
+void imageDirectionalSharpness(const uint8_t* pixels, size_t stride, uint16_t width, uint16_t height,
+                               uint64_t energy[4]) {
+    energy[0] = energy[1] = energy[2] = energy[3] = 0;
+    if (width < 3 || height < 3) return;
+    for (uint16_t y = 1; y + 1 < height; y++) {
+        const uint8_t* row = pixels + (size_t)y * stride;
+        // Per lane at most 2 x 510^2 per step and width / 8 steps: fits uint32
+        uint32x4_t sums[4] = {vdupq_n_u32(0), vdupq_n_u32(0), vdupq_n_u32(0), vdupq_n_u32(0)};
+        uint16_t x = 1;
+        for (; x + 9 <= width; x += 8) {
+            const uint8_t* p = row + x;
+            const uint8_t* up = p - stride;
+            const uint8_t* down = p + stride;
+            int16x8_t c = vreinterpretq_s16_u16(vshll_n_u8(vld1_u8(p), 1));
+            uint16x8_t pairs[4] = {
+                vaddl_u8(vld1_u8(p - 1), vld1_u8(p + 1)),
+                vaddl_u8(vld1_u8(up), vld1_u8(down)),
+                vaddl_u8(vld1_u8(up - 1), vld1_u8(down + 1)),
+                vaddl_u8(vld1_u8(up + 1), vld1_u8(down - 1)),
+            };
+            for (int k = 0; k < 4; k++) {
+                int16x8_t e = vsubq_s16(vreinterpretq_s16_u16(pairs[k]), c);
+                int32x4_t squares = vmull_s16(vget_low_s16(e), vget_low_s16(e));
+                squares = vmlal_s16(squares, vget_high_s16(e), vget_high_s16(e));
+                sums[k] = vaddq_u32(sums[k], vreinterpretq_u32_s32(squares));
+            }
+        }
+        for (int k = 0; k < 4; k++) {
+            uint64x2_t lanes = vpaddlq_u32(sums[k]);
+            energy[k] += vgetq_lane_u64(lanes, 0) + vgetq_lane_u64(lanes, 1);
+        }
+        directionalTail(row, stride, x, width, energy);
+    }
+}
+
+#else
+
+#if defined(IMAGE_KERNELS_PIE)
+
+// image_kernels_pie.S
+extern "C" uint32_t imageSad16Pie(const uint8_t* a, const uint8_t* b, size_t stride);
+extern "C" void imageDownscale2xRowPie(const uint8_t* top, const uint8_t* bottom, uint8_t* out, uint32_t groups);
+
+const char* imageKernelsBackend() {
+    return "pie";
+}
+
+uint32_t imageSad16(const uint8_t* a, const uint8_t* b, size_t stride) {
+    return imageSad16Pie(a, b, stride);
+}
+
+void imageDownscale2x(const uint8_t* src, size_t srcStride, uint16_t width, uint16_t height, uint8_t* dst,
+                      size_t dstStride) {
+    uint16_t outWidth = width / 2, outHeight = height / 2;
+    for (uint16_t y = 0; y < outHeight; y++) {
+        const uint8_t* top = src + (size_t)2 * y * srcStride;
+        const uint8_t* bottom = top + srcStride;
+        uint8_t* out = dst + (size_t)y * dstStride;
+        // The vector stores are aligned: pixels before the first 16-byte
+        // boundary of the row go one at a time
+        uint16_t x = 0;
+        uint16_t head = (uint16_t)(-(uintptr_t)out & 15);
+        for (; x < head && x < outWidth; x++) {
+            out[x] = (uint8_t)((top[2 * x] + top[2 * x + 1] + bottom[2 * x] + bottom[2 * x + 1] + 2) >> 2);
+        }
+        uint16_t groups = (uint16_t)((outWidth - x) / 16);
+        imageDownscale2xRowPie(top + 2 * x, bottom + 2 * x, out + x, groups);
+        x += 16 * groups;
+        for (; x < outWidth; x++) {
+            out[x] = (uint8_t)((top[2 * x] + top[2 * x + 1] + bottom[2 * x] + bottom[2 * x + 1] + 2) >> 2);
+        }
+    }
+}
+
+#else
+
+const char* imageKernelsBackend() {
+    return "scalar";
+}
+
+uint32_t imageSad16(const uint8_t* a, const uint8_t* b, size_t stride) {
+    return imageSad16Scalar(a, b, stride);
+}
+
+void imageDownscale2x(const uint8_t* src, size_t srcStride, uint16_t width, uint16_t height, uint8_t* dst,
+                      size_t dstStride) {
+    imageDownscale2xScalar(src, srcStride, width, height, dst, dstStride);
+}
+
+#endif
+
+void imageRgb565ToGray(const uint8_t* rgb565, size_t pixels, uint8_t* gray) {
+    imageRgb565ToGrayScalar(rgb565, pixels, gray);
+}
+
+void imageYuv422ToGray(const uint8_t* yuv, size_t pixels, uint8_t* gray) {
+    imageYuv422ToGrayScalar(yuv, pixels, gray);
+}
+
+uint64_t imageSharpness(const uint8_t* pixels, size_t stride, uint16_t width, uint16_t height) {
+    return imageSharpnessScalar(pixels, stride, width, height);
+}
+
+void imageDirectionalSharpness(const uint8_t* pixels, size_t stride, uint16_t width, uint16_t height,
+                               uint64_t energy[4]) {
+    imageDirectionalSharpnessScalar(pixels, stride, width, height, energy);
+}
+
+#endif
+
+// ===================================================================
+// HISTOGRAM
+// ===================================================================
+
+void imageHistogram(const uint8_t* pixels, size_t stride, uint16_t width, uint16_t height, uint32_t histogram[256]) {
+    // Two tables, even and odd pixels: runs of equal values (flat areas)
+    // do not wait on their own increments
+    uint32_t odd[256];
+    memset(odd, 0, sizeof(odd));
+    for (uint16_t y = 0; y < height; y++) {
+        const uint8_t* row = pixels + (size_t)y * stride;
+        uint16_t x = 0;
+        for (; x + 4 <= width; x += 4) {
+            histogram[row[x]]++;
+            odd[row[x + 1]]++;
+            histogram[row[x + 2]]++;
+            odd[row[x + 3]]++;
+        }
+        for (; x < width; x++) histogram[row[x]]++;
+    }
+    for (int i = 0; i < 256; i++) histogram[i] += odd[i];
+}
@@ -0,0 +1,108 @@
+#ifndef IMAGE_KERNELS_H
+#define IMAGE_KERNELS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ===================================================================
+// IMAGE KERNELS
+// ===================================================================
+//
+// 8-bit grayscale primitives for the camera features: block SAD, 2x2
+// downscale, RGB565 and YUV422 to gray, histogram and sharpness
+// (isotropic and directional). Each has a vector version for the build's
+// instruction set and a scalar version with exactly the same output (the
+// *Scalar functions, kept for tests and benchmarks). Vector versions
+// handle any size; leftover pixels at the end of a row go through the
+// scalar code. The histogram has no vector
+// form: its fast version counts into two tables instead of one.
+//
+//   SSE2   x86-64 hosts (always available there)
+//   NEON   ARM hosts (__ARM_NEON)
+//   PIE    the ESP32-S3: SAD and downscale only, the rest scalar
+//   scalar everything else
+//
+// The ESP32-S3's PIE vector instructions have no compiler intrinsics, only
+// assembly: its two kernels are in image_kernels_pie.S, and
+// examples/test_image_kernels.ino checks them on the device.
+//
+// Images are row-major, one byte per pixel, with rows stride bytes
+// apart. tools/image_bench times both versions; tests/test_image_kernels
+// checks they agree. No Arduino dependencies.
+//
+
+#if defined(__SSE2__)
+#define IMAGE_KERNELS_SSE2
+#elif defined(__ARM_NEON)
+#define IMAGE_KERNELS_NEON
+#elif defined(__XTENSA__)
+#include "sdkconfig.h"
+#if CONFIG_IDF_TARGET_ESP32S3
+#define IMAGE_KERNELS_PIE
+#endif
+#endif
+
+/** "sse2", "neon", "pie" or "scalar" */
+const char* imageKernelsBackend();
+
+/**
+ * Sum of absolute differences of two 16x16 blocks
+ * @param stride Bytes per row of both images
+ */
+uint32_t imageSad16(const uint8_t* a, const uint8_t* b, size_t stride);
+
+/**
+ * Halve an image: each output pixel is the rounded mean of a 2x2 square.
+ * An odd last row or column is dropped.
+ * @param width, height Source size; the output is width / 2 x height / 2
+ */
+void imageDownscale2x(const uint8_t* src, size_t srcStride, uint16_t width, uint16_t height, uint8_t* dst,
+                      size_t dstStride);
+
+/**
+ * RGB565 (as the camera stores it, high byte first) to 8-bit gray with
+ * BT.601 weights: (77 R + 150 G + 29 B + 128) >> 8 on 8-bit channels
+ */
+void imageRgb565ToGray(const uint8_t* rgb565, size_t pixels, uint8_t* gray);
+
+/**
+ * YUV422 (Y0 U Y1 V, as the camera stores it) to 8-bit gray: the Y bytes
+ */
+void imageYuv422ToGray(const uint8_t* yuv, size_t pixels, uint8_t* gray);
+
+/**
+ * Add the pixel values of an image to a 256-bin histogram (not cleared)
+ */
+void imageHistogram(const uint8_t* pixels, size_t stride, uint16_t width, uint16_t height, uint32_t histogram[256]);
+
+/**
+ * Sum of the squared 4-neighbour Laplacian (4c - up - down - left - right)
+ * over the interior pixels; divide by (width - 2) x (height - 2) for its
+ * mean. High for sharp edges, low for blur.
+ */
+uint64_t imageSharpness(const uint8_t* pixels, size_t stride, uint16_t width, uint16_t height);
+
+/**
+ * Sums of the squared second difference (a + b - 2c, a and b the
+ * neighbours on either side) over the interior pixels, in four
+ * directions: [0] horizontal, [1] vertical, [2] down-right diagonal,
+ * [3] down-left diagonal. Motion blur flattens the direction it runs in
+ * while the others keep their edges, so the smallest of the four finds it
+ * where the 4-neighbour Laplacian does not.
+ */
+void imageDirectionalSharpness(const uint8_t* pixels, size_t stride, uint16_t width, uint16_t height,
+                               uint64_t energy[4]);
+
+// Scalar versions, the reference for the above
+uint32_t imageSad16Scalar(const uint8_t* a, const uint8_t* b, size_t stride);
+void imageDownscale2xScalar(const uint8_t* src, size_t srcStride, uint16_t width, uint16_t height, uint8_t* dst,
+                            size_t dstStride);
+void imageRgb565ToGrayScalar(const uint8_t* rgb565, size_t pixels, uint8_t* gray);
+void imageYuv422ToGrayScalar(const uint8_t* yuv, size_t pixels, uint8_t* gray);
+void imageHistogramScalar(const uint8_t* pixels, size_t stride, uint16_t width, uint16_t height,
+                          uint32_t histogram[256]);
+uint64_t imageSharpnessScalar(const uint8_t* pixels, size_t stride, uint16_t width, uint16_t height);
+void imageDirectionalSharpnessScalar(const uint8_t* pixels, size_t stride, uint16_t width, uint16_t height,
+                                     uint64_t energy[4]);
+
+#endif // IMAGE_KERNELS_H
@@ -0,0 +1,61 @@
+#include "image_pyramid.h"
+#include "image_kernels.h"
+
+size_t imagePyramidSize(uint16_t width, uint16_t height, bool yuv422) {
+    size_t size = yuv422 ? (size_t)width * height : 0;
+    for (int k = 1; k < IMAGE_PYRAMID_LEVELS; k++) size += (size_t)(width >> k) * (height >> k);
+    return size;
+}
+
+bool imagePyramidBuild(const uint8_t* frame, uint16_t width, uint16_t height, bool yuv422, uint8_t* storage,
+                       size_t capacity, image_pyramid_t* pyramid) {
+    if (width < 8 || height < 8 || capacity < imagePyramidSize(width, height, yuv422)) return false;
+
+    uint8_t* next = storage;
+    pyramid->level[0].pixels = yuv422 ? next : frame;
+    pyramid->level[0].width = width;
+    pyramid->level[0].height = height;
+    pyramid->level[0].stride = width;
+    if (yuv422) next += (size_t)width * height;
+    uint8_t* rows[IMAGE_PYRAMID_LEVELS];
+    rows[0] = (uint8_t*)pyramid->level[0].pixels;
+    for (int k = 1; k < IMAGE_PYRAMID_LEVELS; k++) {
+        image_level_t& level = pyramid->level[k];
+        level.pixels = rows[k] = next;
+        level.width = width >> k;
+        level.height = height >> k;
+        level.stride = level.width;
+        next += (size_t)level.width * level.height;
+    }
+
+    // A band of 16 frame rows at a time, while it is in cache: 8 rows of
+    // 1/2, 4 of 1/4, 2 of 1/8
+    const uint16_t band = 1 << (IMAGE_PYRAMID_LEVELS - 1);
+    for (uint16_t y = 0; y < pyramid->level[1].height; y += band) {
+        uint16_t end = y + band < pyramid->level[1].height ? y + band : pyramid->level[1].height;
+        if (yuv422) {
+            imageYuv422ToGray(frame + (size_t)(2 * y) * width * 2, (size_t)2 * (end - y) * width,
+                              rows[0] + (size_t)(2 * y) * width);
+        }
+        for (int k = 1; k < IMAGE_PYRAMID_LEVELS; k++) {
+            const image_level_t& above = pyramid->level[k - 1];
+            const image_level_t& level = pyramid->level[k];
+            uint16_t first = y >> (k - 1), last = end >> (k - 1);
+            if (last > level.height) last = level.height;
+            if (last <= first) break;
+            imageDownscale2x(above.pixels + (size_t)(2 * first) * above.stride, above.stride, above.width,
+                             2 * (last - first), rows[k] + (size_t)first * level.stride, level.stride);
+        }
+    }
+    if (yuv422 && (height & 1)) {
+        imageYuv422ToGray(frame + (size_t)(height - 1) * width * 2, width, rows[0] + (size_t)(height - 1) * width);
+    }
+    return true;
+}
+
+int imagePyramidFit(const image_pyramid_t& pyramid, size_t maxPixels) {
+    for (int k = 0; k < IMAGE_PYRAMID_LEVELS; k++) {
+        if ((size_t)pyramid.level[k].width * pyramid.level[k].height <= maxPixels) return k;
+    }
+    return IMAGE_PYRAMID_LEVELS - 1;
+}
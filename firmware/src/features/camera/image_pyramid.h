@@ -0,0 +1,59 @@
+#ifndef IMAGE_PYRAMID_H
+#define IMAGE_PYRAMID_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ===================================================================
+// IMAGE PYRAMID
+// ===================================================================
+//
+// Luma at full, 1/2, 1/4 and 1/8 scale from one raw camera frame
+// (grayscale, or YUV422 with Y in the even bytes), for analysis kernels
+// and for uploading one level as a JPEG (PHOTO_PYRAMID_SHOT).
+//
+// All levels are built in one pass down the frame: each pair of rows
+// halved makes a 1/2 row, each pair of those a 1/4 row, and so on, while
+// the rows are still in cache. Every level is the rounded 2x2 mean of the
+// one above (imageDownscale2x, image_kernels.h); odd last rows and
+// columns are dropped.
+//
+// Storage is the caller's (PSRAM on the device, imagePyramidSize() bytes).
+// A grayscale frame is its own level 0; YUV422 luma is copied out in the
+// same pass. No Arduino dependencies.
+//
+
+#define IMAGE_PYRAMID_LEVELS 4
+
+typedef struct {
+    const uint8_t* pixels;
+    uint16_t width;
+    uint16_t height;
+    size_t stride;
+} image_level_t;
+
+typedef struct {
+    image_level_t level[IMAGE_PYRAMID_LEVELS];   // [0] full size ... [3] 1/8
+} image_pyramid_t;
+
+/**
+ * Storage imagePyramidBuild() needs for a width x height frame
+ * @param yuv422 Frame is YUV422 (level 0 is copied out) rather than grayscale
+ */
+size_t imagePyramidSize(uint16_t width, uint16_t height, bool yuv422);
+
+/**
+ * Build all levels of a frame
+ * @param frame width x height grayscale bytes, or width x 2 YUV422 bytes per row
+ * @return false if storage is smaller than imagePyramidSize() or the frame
+ *         is smaller than 8x8
+ */
+bool imagePyramidBuild(const uint8_t* frame, uint16_t width, uint16_t height, bool yuv422, uint8_t* storage,
+                       size_t capacity, image_pyramid_t* pyramid);
+
+/**
+ * The largest level with at most maxPixels pixels (the smallest if none fits)
+ */
+int imagePyramidFit(const image_pyramid_t& pyramid, size_t maxPixels);
+
+#endif // IMAGE_PYRAMID_H
@@ -0,0 +1,190 @@
+#ifndef JPEG_HEADER_H
+#define JPEG_HEADER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "../bluetooth/ble_frame_format.h"
+
+// ===================================================================
+// JPEG HEADER COMPACTION
+// ===================================================================
+//
+// Everything the OV2640 writes before the entropy-coded data (SOI, APP0,
+// DQT, SOF0, DHT, SOS) depends only on the frame size and quality, so it
+// is the same in every image of a stream: 623 bytes at QVGA, a large part
+// of a few-KB streaming frame. With JPEG_HEADER_COMPACTION the device sends
+// it once per stream and afterwards only the compact prefix (table ID) and
+// the entropy-coded data; see ble_frame_format.h for the wire format and
+// public/host/stream for the client side.
+//
+//   jpegHeaderLength()     SOI up to the end of the SOS segment
+//   jpegHeaderId()         Table ID of a header (FNV-1a)
+//   JpegHeaderCompactor    Per image: send whole, or prefix + data
+//
+// The image itself is not copied or changed; read() hands out the bytes
+// to send at any offset, so the upload loop keeps its chunking.
+//
+// No Arduino dependencies: the host stream decoder and tools include this.
+//
+
+/**
+ * Length of the JPEG headers (SOI through the SOS segment)
+ * @return 0 if the data is not a baseline JPEG with an SOS in range
+ */
+static inline size_t jpegHeaderLength(const uint8_t* jpeg, size_t length) {
+    if (!jpeg || length < 4 || jpeg[0] != 0xFF || jpeg[1] != 0xD8) return 0;
+
+    size_t pos = 2;
+    while (pos + 4 <= length) {
+        if (jpeg[pos] != 0xFF) return 0;
+        uint8_t marker = jpeg[pos + 1];
+        if (marker == 0xFF) {                   // Fill byte
+            pos++;
+            continue;
+        }
+        if (marker == 0xD8 || marker == 0xD9 || marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {
+            return 0;                           // No standalone markers before SOS
+        }
+        size_t segment = ((size_t)jpeg[pos + 2] << 8) | jpeg[pos + 3];
+        if (segment < 2 || pos + 2 + segment > length) return 0;
+        pos += 2 + segment;
+        if (marker == 0xDA) return pos;
+    }
+    return 0;
+}
+
+/**
+ * Table ID of a header: 32-bit FNV-1a of its bytes
+ */
+static inline uint32_t jpegHeaderId(const uint8_t* header, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= header[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Compaction counters
+ */
+typedef struct {
+    uint32_t images;                // Images planned
+    uint32_t compacted;             // Sent as prefix + entropy data
+    uint32_t headers;               // Sent whole (first of a stream, new tables, refresh)
+    uint64_t bytes_saved;           // Header bytes not sent, less the prefixes
+} jpeg_compaction_stats_t;
+
+class JpegHeaderCompactor {
+public:
+    /**
+     * @param refreshImages Send a whole image at least this often, for
+     *        clients that missed the header (0: only when needed)
+     */
+    explicit JpegHeaderCompactor(uint16_t refreshImages = 0) : refresh(refreshImages) {
+        reset();
+        resetStats();
+    }
+
+    /**
+     * Next image goes out whole; read() passes images through until plan()
+     */
+    void reset() {
+        haveHeader = false;
+        sentId = 0;
+        stream = 0;
+        sinceHeader = 0;
+        skip = 0;
+        prefixLength = 0;
+    }
+
+    /**
+     * Decide how the next image is sent
+     * @param streamKey Anything that changes when the client may have lost
+     *        its cache (e.g. a connection counter)
+     * @return true if it is sent compact
+     */
+    bool plan(const uint8_t* jpeg, size_t length, uint32_t streamKey) {
+        counters.images++;
+        skip = 0;
+        prefixLength = 0;
+
+        size_t header = jpegHeaderLength(jpeg, length);
+        if (header == 0 || header <= BLE_JPEG_COMPACT_PREFIX_SIZE) {
+            haveHeader = false;                 // Not ours to shorten; start over after it
+            return false;
+        }
+
+        uint32_t id = jpegHeaderId(jpeg, header);
+        bool compact = haveHeader && streamKey == stream && id == sentId &&
+                       (refresh == 0 || sinceHeader < refresh);
+        if (!compact) {
+            haveHeader = true;
+            sentId = id;
+            stream = streamKey;
+            sinceHeader = 0;
+            counters.headers++;
+            return false;
+        }
+
+        bleWriteJpegCompactPrefix(prefix, id);
+        prefixLength = BLE_JPEG_COMPACT_PREFIX_SIZE;
+        skip = header;
+        sinceHeader++;
+        counters.compacted++;
+        counters.bytes_saved += header - BLE_JPEG_COMPACT_PREFIX_SIZE;
+        return true;
+    }
+
+    /**
+     * Bytes on the wire for the planned image
+     */
+    size_t length(size_t jpegLength) const {
+        return jpegLength - skip + prefixLength;
+    }
+
+    /**
+     * Copy up to max wire bytes from offset
+     * @return Bytes copied (0 at the end)
+     */
+    size_t read(const uint8_t* jpeg, size_t jpegLength, size_t offset, uint8_t* out, size_t max) const {
+        size_t copied = 0;
+        if (offset < prefixLength) {
+            copied = prefixLength - offset;
+            if (copied > max) copied = max;
+            memcpy(out, prefix + offset, copied);
+            offset += copied;
+        }
+        size_t source = skip + (offset - prefixLength);
+        if (copied < max && source < jpegLength) {
+            size_t run = jpegLength - source;
+            if (run > max - copied) run = max - copied;
+            memcpy(out + copied, jpeg + source, run);
+            copied += run;
+        }
+        return copied;
+    }
+
+    bool isCompact() const { return prefixLength > 0; }
+
+    const jpeg_compaction_stats_t& stats() const { return counters; }
+
+    void resetStats() { memset(&counters, 0, sizeof(counters)); }
+
+private:
+    uint16_t refresh;
+    bool haveHeader;
+    uint32_t sentId;
+    uint32_t stream;
+    uint16_t sinceHeader;
+
+    // The planned image
+    size_t skip;
+    uint8_t prefix[BLE_JPEG_COMPACT_PREFIX_SIZE];
+    size_t prefixLength;
+
+    jpeg_compaction_stats_t counters;
+};
+
+#endif // JPEG_HEADER_H
@@ -0,0 +1,525 @@
+#include "photo_hash.h"
+#include <math.h>
+#include <string.h>
+
+// ===================================================================
+// HUFFMAN TABLES
+// ===================================================================
+
+#define HUFFMAN_LOOKUP_BITS 9
+
+typedef struct {
+    uint16_t lookup[1 << HUFFMAN_LOOKUP_BITS];  // Codes up to 9 bits: length << 8 | symbol (0 = longer)
+    int32_t maxCode[18];                        // Largest code of each length (-1 = none)
+    int32_t valueOffset[17];                    // Code of each length -> index into values
+    uint8_t values[256];
+    bool defined;
+} huffman_table_t;
+
+// DC 0-1 and AC 0-1 (baseline limits)
+static huffman_table_t dcTables[2];
+static huffman_table_t acTables[2];
+
+/**
+ * Canonical codes from a DHT segment's counts and symbols
+ */
+static bool buildHuffman(huffman_table_t* table, const uint8_t counts[16], const uint8_t* symbols, size_t total) {
+    if (total > sizeof(table->values)) return false;
+    memcpy(table->values, symbols, total);
+    memset(table->lookup, 0, sizeof(table->lookup));
+
+    int32_t code = 0;
+    int32_t index = 0;
+    for (int length = 1; length <= 16; length++) {
+        table->valueOffset[length] = index - code;
+        for (int i = 0; i < counts[length - 1]; i++, code++, index++) {
+            if (length <= HUFFMAN_LOOKUP_BITS) {
+                int shift = HUFFMAN_LOOKUP_BITS - length;
+                for (int fill = 0; fill < (1 << shift); fill++) {
+                    table->lookup[(code << shift) | fill] = (uint16_t)(length << 8 | table->values[index]);
+                }
+            }
+        }
+        table->maxCode[length] = counts[length - 1] ? code - 1 : -1;
+        if (code > (1 << length)) return false;   // Over-subscribed
+        code <<= 1;
+    }
+    table->maxCode[17] = 0x7FFFFFFF;
+    table->defined = true;
+    return true;
+}
+
+// ===================================================================
+// BIT READER
+// ===================================================================
+
+typedef struct {
+    const uint8_t* data;
+    size_t position;
+    size_t end;
+    uint32_t bits;          // MSB first
+    int count;
+    bool atMarker;          // Stopped before a marker: zeros from here
+    int padding;            // Zero bytes fed past the data
+} bit_reader_t;
+
+static inline void fillBits(bit_reader_t* reader) {
+    while (reader->count <= 24) {
+        uint32_t byte = 0;
+        if (reader->atMarker || reader->position >= reader->end) {
+            reader->padding++;
+        } else {
+            byte = reader->data[reader->position];
+            if (byte == 0xFF) {
+                uint8_t next = reader->position + 1 < reader->end ? reader->data[reader->position + 1] : 0xD9;
+                if (next == 0x00) {
+                    reader->position += 2;          // Stuffed FF
+                } else {
+                    reader->atMarker = true;
+                    reader->padding++;
+                    byte = 0;
+                }
+            } else {
+                reader->position++;
+            }
+        }
+        reader->bits |= byte << (24 - reader->count);
+        reader->count += 8;
+    }
+}
+
+static inline uint32_t takeBits(bit_reader_t* reader, int n) {
+    uint32_t value = reader->bits >> (32 - n);
+    reader->bits <<= n;
+    reader->count -= n;
+    return value;
+}
+
+static inline int decodeSymbol(bit_reader_t* reader, const huffman_table_t* table) {
+    fillBits(reader);
+    uint16_t entry = table->lookup[reader->bits >> (32 - HUFFMAN_LOOKUP_BITS)];
+    if (entry) {
+        takeBits(reader, entry >> 8);
+        return entry & 0xFF;
+    }
+    for (int length = HUFFMAN_LOOKUP_BITS + 1; length <= 16; length++) {
+        int32_t code = (int32_t)(reader->bits >> (32 - length));
+        if (code <= table->maxCode[length]) {
+            takeBits(reader, length);
+            return table->values[code + table->valueOffset[length]];
+        }
+    }
+    return -1;
+}
+
+/**
+ * The s-bit magnitude that follows a DC/AC symbol, sign extended
+ */
+static inline int32_t receiveExtend(bit_reader_t* reader, int s) {
+    if (s == 0) return 0;
+    fillBits(reader);
+    int32_t value = (int32_t)takeBits(reader, s);
+    if (value < (1 << (s - 1))) value += 1 - (1 << s);
+    return value;
+}
+
+/**
+ * Skip to the restart marker the reader stopped before
+ */
+static bool restart(bit_reader_t* reader) {
+    reader->bits = 0;
+    reader->count = 0;
+    reader->padding = 0;
+    size_t p = reader->position;
+    while (p + 1 < reader->end && !(reader->data[p] == 0xFF && reader->data[p + 1] >= 0xD0 && reader->data[p + 1] <= 0xD7)) {
+        p++;
+    }
+    if (p + 1 >= reader->end) return false;
+    reader->position = p + 2;
+    reader->atMarker = false;
+    return true;
+}
+
+// ===================================================================
+// DC DECODE
+// ===================================================================
+
+#define JPEG_MAX_COMPONENTS 4
+
+// Zigzag position -> natural (row-major) position
+static const uint8_t NATURAL[64] = {
+    0,  1,  8,  16, 9,  2,  3,  10, 17, 24, 32, 25, 18, 11, 4,  5,  12, 19, 26, 33, 40, 48,
+    41, 34, 27, 20, 13, 6,  7,  14, 21, 28, 35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23,
+    30, 37, 44, 51, 58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63,
+};
+
+// DQT tables 0-3, in zigzag order
+static uint16_t quantTables[4][64];
+
+typedef struct {
+    uint8_t id;
+    uint8_t h;
+    uint8_t v;
+    uint8_t quant;
+} jpeg_component_t;
+
+typedef struct {
+    uint8_t* image;             // jpegDcImage / jpegLumaDownscale output (or null)
+    size_t capacity;
+    uint32_t* sums;             // Hash grid (or null)
+    uint32_t* counts;
+    uint16_t blocksWide;
+    uint16_t blocksHigh;
+    uint8_t size;               // Output pixels per block side: 1 (DC only), 2 or 4
+} dc_sink_t;
+
+static inline void storeBlock(dc_sink_t* sink, uint16_t bx, uint16_t by, uint8_t mean) {
+    if (bx >= sink->blocksWide || by >= sink->blocksHigh) return;   // MCU padding
+    if (sink->image) sink->image[(size_t)by * sink->blocksWide + bx] = mean;
+    if (sink->sums) {
+        int cell = (by * PHOTO_HASH_GRID_HEIGHT / sink->blocksHigh) * PHOTO_HASH_GRID_WIDTH +
+                   bx * PHOTO_HASH_GRID_WIDTH / sink->blocksWide;
+        sink->sums[cell] += mean;
+        sink->counts[cell]++;
+    }
+}
+
+/**
+ * Skip an 8x8 block's AC coefficients
+ */
+static inline bool skipAc(bit_reader_t* reader, const huffman_table_t* table) {
+    for (int k = 1; k < 64; k++) {
+        int rs = decodeSymbol(reader, table);
+        if (rs < 0) return false;
+        int run = rs >> 4, size = rs & 15;
+        if (size) {
+            k += run;
+            fillBits(reader);
+            takeBits(reader, size);
+        } else if (run == 15) {
+            k += 15;
+        } else {
+            break;                              // End of block
+        }
+    }
+    return true;
+}
+
+/**
+ * An 8x8 block's AC coefficients, dequantized into block (natural order)
+ */
+static inline bool decodeAc(bit_reader_t* reader, const huffman_table_t* table, const uint16_t* quant, int32_t* block) {
+    for (int k = 1; k < 64; k++) {
+        int rs = decodeSymbol(reader, table);
+        if (rs < 0) return false;
+        int run = rs >> 4, size = rs & 15;
+        if (size) {
+            k += run;
+            if (k > 63) return false;
+            block[NATURAL[k]] = receiveExtend(reader, size) * quant[k];
+        } else if (run == 15) {
+            k += 15;
+        } else {
+            break;
+        }
+    }
+    return true;
+}
+
+// boxBasis[size][i][u]: mean over the i-th of size equal runs of an 8-point
+// row of cosine u, with the IDCT's scale C(u) / 2
+static float boxBasis[5][4][8];
+static bool boxBasisReady = false;
+
+static void buildBoxBasis() {
+    for (int size = 2; size <= 4; size += 2) {
+        int run = 8 / size;
+        for (int i = 0; i < size; i++) {
+            for (int u = 0; u < 8; u++) {
+                float sum = 0;
+                for (int x = i * run; x < (i + 1) * run; x++) sum += cosf((2 * x + 1) * u * (float)M_PI / 16);
+                boxBasis[size][i][u] = sum / run * (u == 0 ? (float)M_SQRT1_2 : 1.0f) / 2;
+            }
+        }
+    }
+    boxBasisReady = true;
+}
+
+/**
+ * Means of the size x size equal squares of a dequantized block: the
+ * separable IDCT averaged over each square, which leaves out most of it
+ * (cosines that average to zero over a square drop out)
+ */
+static void storeBoxMeans(dc_sink_t* sink, uint16_t bx, uint16_t by, const int32_t* block) {
+    if (bx >= sink->blocksWide || by >= sink->blocksHigh) return;
+    const int size = sink->size;
+    float rows[8][4];
+    uint8_t nonzeroRows = 0;
+    for (int v = 0; v < 8; v++) {
+        const int32_t* row = &block[v * 8];
+        bool any = false;
+        for (int u = 0; u < 8; u++) any |= row[u] != 0;
+        if (!any) continue;
+        nonzeroRows |= 1 << v;
+        for (int i = 0; i < size; i++) {
+            float sum = 0;
+            for (int u = 0; u < 8; u++) sum += boxBasis[size][i][u] * row[u];
+            rows[v][i] = sum;
+        }
+    }
+    size_t stride = (size_t)sink->blocksWide * size;
+    uint8_t* out = sink->image + (size_t)by * size * stride + (size_t)bx * size;
+    for (int j = 0; j < size; j++) {
+        for (int i = 0; i < size; i++) {
+            float sum = 128.5f;
+            for (int v = 0; v < 8; v++) {
+                if (nonzeroRows & (1 << v)) sum += boxBasis[size][j][v] * rows[v][i];
+            }
+            out[(size_t)j * stride + i] = (uint8_t)(sum < 0 ? 0 : sum > 255 ? 255 : (int)sum);
+        }
+    }
+}
+
+static inline uint8_t blockMean(int32_t dc, uint16_t quant) {
+    int32_t value = 128 + ((dc * quant + 4) >> 3);
+    return (uint8_t)(value < 0 ? 0 : value > 255 ? 255 : value);
+}
+
+/**
+ * Walk the first scan (which must hold the first component, luma) and
+ * hand each luma block's mean (or its box means, sink->size > 1) to the sink
+ * @param setup Called once the dimensions are known; false stops
+ */
+static bool decodeLumaDc(const uint8_t* jpeg, size_t length, dc_sink_t* sink, bool (*setup)(dc_sink_t*)) {
+    if (!jpeg || length < 4 || jpeg[0] != 0xFF || jpeg[1] != 0xD8) return false;
+
+    memset(quantTables, 0, sizeof(quantTables));
+    jpeg_component_t components[JPEG_MAX_COMPONENTS];
+    int componentCount = 0;
+    uint16_t width = 0, height = 0;
+    uint16_t restartInterval = 0;
+    for (int i = 0; i < 2; i++) dcTables[i].defined = acTables[i].defined = false;
+
+    size_t pos = 2;
+    while (pos + 4 <= length) {
+        if (jpeg[pos] != 0xFF) return false;
+        uint8_t marker = jpeg[pos + 1];
+        if (marker == 0xFF) {
+            pos++;
+            continue;
+        }
+        if (marker == 0xD8 || marker == 0xD9 || marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {
+            return false;                                       // No image before EOI
+        }
+        size_t segment = ((size_t)jpeg[pos + 2] << 8) | jpeg[pos + 3];
+        if (segment < 2 || pos + 2 + segment > length) return false;
+        const uint8_t* p = &jpeg[pos + 4];
+        const uint8_t* end = &jpeg[pos + 2 + segment];
+
+        if (marker == 0xDB) {                                   // DQT
+            while (p < end) {
+                uint8_t precision = *p >> 4, id = *p & 3;
+                size_t size = precision ? 128 : 64;
+                if (p + 1 + size > end) return false;
+                for (int k = 0; k < 64; k++) {
+                    quantTables[id][k] = precision ? (uint16_t)(p[1 + 2 * k] << 8 | p[2 + 2 * k]) : p[1 + k];
+                }
+                p += 1 + size;
+            }
+        } else if (marker == 0xC4) {                            // DHT
+            while (p + 17 <= end) {
+                uint8_t tableClass = *p >> 4, id = *p & 15;
+                size_t total = 0;
+                for (int i = 0; i < 16; i++) total += p[1 + i];
+                if (tableClass > 1 || id > 1 || p + 17 + total > end) return false;
+                huffman_table_t* table = tableClass ? &acTables[id] : &dcTables[id];
+                if (!buildHuffman(table, p + 1, p + 17, total)) return false;
+                p += 17 + total;
+            }
+        } else if (marker == 0xDD) {                            // DRI
+            if (segment < 4) return false;
+            restartInterval = (uint16_t)(p[0] << 8 | p[1]);
+        } else if (marker == 0xC0 || marker == 0xC1) {          // SOF0/1: sequential Huffman
+            if (segment < 8) return false;
+            height = (uint16_t)(p[1] << 8 | p[2]);
+            width = (uint16_t)(p[3] << 8 | p[4]);
+            componentCount = p[5];
+            if (componentCount < 1 || componentCount > JPEG_MAX_COMPONENTS || segment < 8 + 3 * (size_t)componentCount) {
+                return false;
+            }
+            for (int i = 0; i < componentCount; i++) {
+                components[i].id = p[6 + 3 * i];
+                components[i].h = p[7 + 3 * i] >> 4;
+                components[i].v = p[7 + 3 * i] & 15;
+                components[i].quant = p[8 + 3 * i] & 3;
+                if (components[i].h < 1 || components[i].h > 4 || components[i].v < 1 || components[i].v > 4) {
+                    return false;
+                }
+            }
+        } else if ((marker >= 0xC2 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC)) {
+            return false;                                       // Progressive, lossless, arithmetic
+        } else if (marker == 0xDA) {                            // SOS
+            if (width == 0 || height == 0 || componentCount == 0) return false;
+            pos += 2 + segment;
+
+            int scanCount = p[0];
+            if (scanCount < 1 || scanCount > componentCount || segment < 6 + 2 * (size_t)scanCount) return false;
+            int scanComponents[JPEG_MAX_COMPONENTS];
+            uint8_t dcTable[JPEG_MAX_COMPONENTS], acTable[JPEG_MAX_COMPONENTS];
+            for (int s = 0; s < scanCount; s++) {
+                scanComponents[s] = -1;
+                for (int c = 0; c < componentCount; c++) {
+                    if (components[c].id == p[1 + 2 * s]) scanComponents[s] = c;
+                }
+                dcTable[s] = p[2 + 2 * s] >> 4;
+                acTable[s] = p[2 + 2 * s] & 15;
+                if (scanComponents[s] < 0 || dcTable[s] > 1 || acTable[s] > 1 ||
+                    !dcTables[dcTable[s]].defined || !acTables[acTable[s]].defined) {
+                    return false;
+                }
+            }
+            if (scanComponents[0] != 0) return false;           // Luma first
+
+            uint8_t hMax = 1, vMax = 1;
+            for (int c = 0; c < componentCount; c++) {
+                if (components[c].h > hMax) hMax = components[c].h;
+                if (components[c].v > vMax) vMax = components[c].v;
+            }
+            const jpeg_component_t& luma = components[0];
+            uint32_t lumaWidth = ((uint32_t)width * luma.h + hMax - 1) / hMax;
+            uint32_t lumaHeight = ((uint32_t)height * luma.v + vMax - 1) / vMax;
+            sink->blocksWide = (uint16_t)((lumaWidth + 7) / 8);
+            sink->blocksHigh = (uint16_t)((lumaHeight + 7) / 8);
+            if (!setup(sink)) return false;
+
+            // One component: one block per MCU in raster order. Several: MCUs of
+            // h x v blocks per component
+            bool interleaved = scanCount > 1;
+            uint32_t mcusWide = interleaved ? (width + 8 * hMax - 1) / (8 * hMax) : sink->blocksWide;
+            uint32_t mcusHigh = interleaved ? (height + 8 * vMax - 1) / (8 * vMax) : sink->blocksHigh;
+            const uint16_t* lumaQuant = quantTables[luma.quant];
+            if (sink->size > 1 && !boxBasisReady) buildBoxBasis();
+
+            bit_reader_t reader = {jpeg, pos, length, 0, 0, false, 0};
+            int32_t predictors[JPEG_MAX_COMPONENTS] = {0, 0, 0, 0};
+            int32_t block[64];
+            uint32_t mcus = mcusWide * mcusHigh;
+            for (uint32_t mcu = 0; mcu < mcus; mcu++) {
+                if (restartInterval && mcu > 0 && mcu % restartInterval == 0) {
+                    if (!restart(&reader)) return false;
+                    memset(predictors, 0, sizeof(predictors));
+                }
+                uint16_t mcuX = (uint16_t)(mcu % mcusWide), mcuY = (uint16_t)(mcu / mcusWide);
+                for (int s = 0; s < scanCount; s++) {
+                    const jpeg_component_t& component = components[scanComponents[s]];
+                    int blocks = interleaved ? component.h * component.v : 1;
+                    for (int b = 0; b < blocks; b++) {
+                        int t = decodeSymbol(&reader, &dcTables[dcTable[s]]);
+                        if (t < 0 || t > 11) return false;
+                        predictors[s] += receiveExtend(&reader, t);
+                        if (s == 0 && sink->size > 1) {
+                            memset(block, 0, sizeof(block));
+                            block[0] = predictors[0] * lumaQuant[0];
+                            if (!decodeAc(&reader, &acTables[acTable[s]], lumaQuant, block)) return false;
+                        } else if (!skipAc(&reader, &acTables[acTable[s]])) {
+                            return false;
+                        }
+                        if (s == 0) {
+                            uint16_t bx = interleaved ? mcuX * component.h + b % component.h : mcuX;
+                            uint16_t by = interleaved ? mcuY * component.v + b / component.h : mcuY;
+                            if (sink->size > 1) {
+                                storeBoxMeans(sink, bx, by, block);
+                            } else {
+                                storeBlock(sink, bx, by, blockMean(predictors[0], lumaQuant[0]));
+                            }
+                        }
+                    }
+                }
+                // Bits read past the data: truncated or corrupt
+                if (reader.padding * 8 > reader.count) return false;
+            }
+            return true;
+        }
+        pos += 2 + segment;
+    }
+    return false;
+}
+
+// ===================================================================
+// HASH
+// ===================================================================
+
+typedef struct {
+    uint32_t sums[PHOTO_HASH_GRID_WIDTH * PHOTO_HASH_GRID_HEIGHT];
+    uint32_t counts[PHOTO_HASH_GRID_WIDTH * PHOTO_HASH_GRID_HEIGHT];
+} hash_grid_t;
+
+/**
+ * Bit y * 8 + x: cell (x, y) darker than cell (x + 1, y)
+ */
+static uint64_t gridHash(const hash_grid_t& grid) {
+    uint64_t hash = 0;
+    for (int y = 0; y < PHOTO_HASH_GRID_HEIGHT; y++) {
+        for (int x = 0; x < PHOTO_HASH_GRID_WIDTH - 1; x++) {
+            int a = y * PHOTO_HASH_GRID_WIDTH + x, b = a + 1;
+            // Means compared without dividing
+            if ((uint64_t)grid.sums[a] * grid.counts[b] < (uint64_t)grid.sums[b] * grid.counts[a]) {
+                hash |= 1ULL << (y * 8 + x);
+            }
+        }
+    }
+    return hash;
+}
+
+static bool setupImage(dc_sink_t* sink) {
+    return (size_t)sink->blocksWide * sink->blocksHigh * sink->size * sink->size <= sink->capacity;
+}
+
+static bool setupGrid(dc_sink_t* sink) {
+    return sink->blocksWide >= PHOTO_HASH_GRID_WIDTH && sink->blocksHigh >= PHOTO_HASH_GRID_HEIGHT;
+}
+
+bool jpegDcImage(const uint8_t* jpeg, size_t length, uint8_t* out, size_t capacity, uint16_t* blocksWide,
+                 uint16_t* blocksHigh) {
+    dc_sink_t sink = {out, capacity, nullptr, nullptr, 0, 0, 1};
+    if (!decodeLumaDc(jpeg, length, &sink, setupImage)) return false;
+    *blocksWide = sink.blocksWide;
+    *blocksHigh = sink.blocksHigh;
+    return true;
+}
+
+bool jpegLumaDownscale(const uint8_t* jpeg, size_t length, uint8_t factor, uint8_t* out, size_t capacity,
+                       uint16_t* width, uint16_t* height) {
+    if (factor != 2 && factor != 4 && factor != 8) return false;
+    dc_sink_t sink = {out, capacity, nullptr, nullptr, 0, 0, (uint8_t)(8 / factor)};
+    if (!decodeLumaDc(jpeg, length, &sink, setupImage)) return false;
+    *width = (uint16_t)(sink.blocksWide * sink.size);
+    *height = (uint16_t)(sink.blocksHigh * sink.size);
+    return true;
+}
+
+bool photoHashJpeg(const uint8_t* jpeg, size_t length, uint64_t* hash) {
+    static hash_grid_t grid;
+    memset(&grid, 0, sizeof(grid));
+    dc_sink_t sink = {nullptr, 0, grid.sums, grid.counts, 0, 0, 1};
+    if (!decodeLumaDc(jpeg, length, &sink, setupGrid)) return false;
+    *hash = gridHash(grid);
+    return true;
+}
+
+uint64_t photoHashGray(const uint8_t* gray, size_t stride, uint16_t width, uint16_t height) {
+    if (width < PHOTO_HASH_GRID_WIDTH || height < PHOTO_HASH_GRID_HEIGHT) return 0;
+
+    static hash_grid_t grid;
+    memset(&grid, 0, sizeof(grid));
+    for (uint16_t y = 0; y < height; y++) {
+        const uint8_t* row = gray + (size_t)y * stride;
+        int cellRow = (y * PHOTO_HASH_GRID_HEIGHT / height) * PHOTO_HASH_GRID_WIDTH;
+        for (uint16_t x = 0; x < width; x++) {
+            int cell = cellRow + x * PHOTO_HASH_GRID_WIDTH / width;
+            grid.sums[cell] += row[x];
+            grid.counts[cell]++;
+        }
+    }
+    return gridHash(grid);
+}
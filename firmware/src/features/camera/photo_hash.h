@@ -0,0 +1,72 @@
+#ifndef PHOTO_HASH_H
+#define PHOTO_HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ===================================================================
+// PHOTO HASH
+// ===================================================================
+//
+// 64-bit perceptual hash (dHash) of a photo, sent ahead of it in the
+// photo start header (PHOTO_START_HEADER, see ble_frame_format.h) so a
+// client can skip near-duplicates before the body arrives.
+//
+// The JPEG is not decoded: only the Huffman stream is walked, and the DC
+// coefficient of each luma block (its mean, a 1/8 scale image) is kept.
+// The 1/8 image is averaged into 9x8 cells and each bit says whether a
+// cell is darker than its right neighbour. Brightness, contrast and JPEG
+// quality barely move the hash; a different scene flips about half of
+// the bits.
+//
+// Baseline and extended sequential Huffman JPEGs, grayscale or YCbCr at
+// any sampling, with or without restart markers. Work memory is static
+// (Huffman lookup tables, a few KB); no allocation. No Arduino
+// dependencies: the host stream decoder and tools include this.
+//
+
+#define PHOTO_HASH_BITS 64
+#define PHOTO_HASH_GRID_WIDTH 9     // 8 comparisons per row
+#define PHOTO_HASH_GRID_HEIGHT 8
+
+/**
+ * 1/8 scale luma of a JPEG: the mean of each 8x8 block from its DC
+ * coefficient alone, ceil(width / 8) x ceil(height / 8) bytes
+ * @param out Receives the image, rows of *blocksWide bytes
+ * @return false if the JPEG is unsupported or truncated, or out is too small
+ */
+bool jpegDcImage(const uint8_t* jpeg, size_t length, uint8_t* out, size_t capacity, uint16_t* blocksWide,
+                 uint16_t* blocksHigh);
+
+/**
+ * Luma of a JPEG shrunk by 2, 4 or 8: each output pixel is the mean of a
+ * factor x factor square, computed from the block's coefficients without
+ * a full IDCT (factor 8 is jpegDcImage). The photo quality gate scores
+ * this (photo_quality.h).
+ * @param out Receives *width x *height bytes: ceil(width / 8) x 8 / factor by
+ *            ceil(height / 8) x 8 / factor, edge blocks included
+ * @return false if the JPEG is unsupported or truncated, or out is too small
+ */
+bool jpegLumaDownscale(const uint8_t* jpeg, size_t length, uint8_t factor, uint8_t* out, size_t capacity,
+                       uint16_t* width, uint16_t* height);
+
+/**
+ * Hash of a JPEG from its DC coefficients
+ * @return false if the JPEG is unsupported, truncated or smaller than 72x64
+ */
+bool photoHashJpeg(const uint8_t* jpeg, size_t length, uint64_t* hash);
+
+/**
+ * Hash of a grayscale image (a probe frame, or the output of jpegDcImage)
+ * @return 0 for an image smaller than the 9x8 grid
+ */
+uint64_t photoHashGray(const uint8_t* gray, size_t stride, uint16_t width, uint16_t height);
+
+/**
+ * Bits that differ: 0 for the same picture, ~32 for unrelated ones
+ */
+static inline int photoHashDistance(uint64_t a, uint64_t b) {
+    return __builtin_popcountll(a ^ b);
+}
+
+#endif // PHOTO_HASH_H
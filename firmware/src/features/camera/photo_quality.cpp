@@ -0,0 +1,59 @@
+#include "photo_quality.h"
+#include "photo_hash.h"
+#include "image_kernels.h"
+#include <string.h>
+
+void photoQualityGray(const uint8_t* gray, size_t stride, uint16_t width, uint16_t height,
+                      const photo_quality_config_t& config, photo_quality_t* quality) {
+    memset(quality, 0, sizeof(*quality));
+    quality->factor = 1;
+    if (width < 3 || height < 3) return;
+
+    // Diagonal neighbours are sqrt(2) away: their second difference is twice as large
+    uint64_t energy[4];
+    imageDirectionalSharpness(gray, stride, width, height, energy);
+    energy[2] /= 2;
+    energy[3] /= 2;
+    int flattest = 0;
+    for (int k = 1; k < 4; k++) {
+        if (energy[k] < energy[flattest]) flattest = k;
+    }
+    uint64_t interior = (uint64_t)(width - 2) * (height - 2);
+    quality->sharpness = (uint32_t)((energy[flattest] + interior / 2) / interior);
+    quality->direction = (uint8_t)flattest;
+
+    uint32_t histogram[256];
+    memset(histogram, 0, sizeof(histogram));
+    imageHistogram(gray, stride, width, height, histogram);
+    uint64_t pixels = (uint64_t)width * height, sum = 0, dark = 0, bright = 0;
+    for (int i = 0; i < 256; i++) {
+        sum += (uint64_t)i * histogram[i];
+        if (i <= config.dark_level) dark += histogram[i];
+        if (i >= config.bright_level) bright += histogram[i];
+    }
+    quality->mean = (uint8_t)((sum + pixels / 2) / pixels);
+    quality->dark_percent = (uint8_t)(dark * 100 / pixels);
+    quality->bright_percent = (uint8_t)(bright * 100 / pixels);
+
+    if (quality->sharpness < config.min_sharpness) quality->flags |= PHOTO_QUALITY_BLURRY;
+    if (quality->dark_percent > config.max_clipped_percent) quality->flags |= PHOTO_QUALITY_DARK;
+    if (quality->bright_percent > config.max_clipped_percent) quality->flags |= PHOTO_QUALITY_BRIGHT;
+}
+
+bool photoQualityJpeg(const uint8_t* jpeg, size_t length, const photo_quality_config_t& config, uint8_t* work,
+                      size_t workSize, photo_quality_t* quality) {
+    // Automatic: the least shrink that fits PHOTO_QUALITY_WORK_SIZE, the
+    // scale the threshold is for. A factor too fine fails on the headers,
+    // before any decoding
+    uint8_t first = config.factor ? config.factor : 2, last = config.factor ? config.factor : 8;
+    size_t capacity = config.factor || workSize < PHOTO_QUALITY_WORK_SIZE ? workSize : PHOTO_QUALITY_WORK_SIZE;
+    for (uint8_t factor = first; factor <= last; factor *= 2) {
+        uint16_t width = 0, height = 0;
+        if (jpegLumaDownscale(jpeg, length, factor, work, capacity, &width, &height)) {
+            photoQualityGray(work, width, width, height, config, quality);
+            quality->factor = factor;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,74 @@
+#ifndef PHOTO_QUALITY_H
+#define PHOTO_QUALITY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ===================================================================
+// PHOTO QUALITY
+// ===================================================================
+//
+// Sharpness and exposure of a photo, scored before it is uploaded so a
+// blurred or clipped interval photo can be retaken or tagged
+// (PHOTO_QUALITY_POLICY in constants.h).
+//
+// The JPEG's luma is shrunk straight from its coefficients
+// (jpegLumaDownscale, photo_hash.h), which also averages away sensor
+// noise and JPEG ringing that would otherwise read as detail.
+//
+// Sharpness is the variance of the second difference along the flattest
+// of four directions (imageDirectionalSharpness, image_kernels.h): motion
+// blur from a turning head smears one direction only, which the
+// 4-neighbour Laplacian's sum over both axes hides. Exposure is the share
+// of pixels clipped dark or bright (imageHistogram).
+//
+// The downscaled image goes in the caller's work buffer; nothing else is
+// allocated. tools/quality_bench tunes the defaults on the desk scene and
+// the sample capture. No Arduino dependencies.
+//
+
+// Work buffer for the downscaled image. Sharpness depends on the scale it
+// is measured at, so by default photos are shrunk to about this size
+// whatever their resolution (QVGA by 2, VGA and SVGA by 4, UXGA by 8) and
+// one threshold fits them all
+#define PHOTO_QUALITY_WORK_SIZE (200 * 150)
+
+// photo_quality_t::flags
+#define PHOTO_QUALITY_BLURRY 0x01
+#define PHOTO_QUALITY_DARK 0x02
+#define PHOTO_QUALITY_BRIGHT 0x04
+
+typedef struct {
+    uint8_t factor;                 // Shrink by 2, 4 or 8 before scoring; 0: the least that fits
+    uint32_t min_sharpness;         // Below this: blurry
+    uint8_t dark_level;             // Pixels at or below this are clipped dark
+    uint8_t bright_level;           // Pixels at or above this are clipped bright
+    uint8_t max_clipped_percent;    // More clipped than this: dark / bright
+} photo_quality_config_t;
+
+typedef struct {
+    uint32_t sharpness;             // Mean squared second difference, flattest direction
+    uint8_t direction;              // Which one: 0 horizontal, 1 vertical, 2 and 3 diagonal
+    uint8_t dark_percent;
+    uint8_t bright_percent;
+    uint8_t mean;
+    uint8_t factor;                 // Shrink factor it was scored at (1: as given)
+    uint8_t flags;                  // PHOTO_QUALITY_BLURRY | _DARK | _BRIGHT, 0 = good
+} photo_quality_t;
+
+/**
+ * Score a grayscale image as it is (already downscaled, or a probe frame)
+ */
+void photoQualityGray(const uint8_t* gray, size_t stride, uint16_t width, uint16_t height,
+                      const photo_quality_config_t& config, photo_quality_t* quality);
+
+/**
+ * Score a JPEG from its luma shrunk by config.factor
+ * @param work At least PHOTO_QUALITY_WORK_SIZE bytes for the automatic factor
+ * @return false if the JPEG is unsupported or truncated, or shrunk it does
+ *         not fit in work
+ */
+bool photoQualityJpeg(const uint8_t* jpeg, size_t length, const photo_quality_config_t& config, uint8_t* work,
+                      size_t workSize, photo_quality_t* quality);
+
+#endif // PHOTO_QUALITY_H
@@ -1,5 +1,6 @@
 #include "audio_filters.h"
 #include <Arduino.h>
+#include "../../system/clock/profiler.h"
 
 // Static member definitions
 float AudioFilters::s_dc_filter_state = 0.0f;
@@ -22,6 +23,8 @@ void AudioFilters::resetFilters() {
 }
 
 void AudioFilters::applyFilters(int16_t* audio_data, size_t sample_count) {
+    PROFILE_SCOPE("audio_filters");
+    
     // Apply all filters in sequence
     applyDCBlockingFilter(audio_data, sample_count);
     // Skip high-pass filter for now - it was removing speech
@@ -46,6 +49,8 @@ void AudioFilters::applyDCBlockingFilter(int16_t* audio_data, size_t sample_coun
 }
 
 void AudioFilters::applyHighPassFilter(int16_t* audio_data, size_t sample_count) {
+    (void)audio_data;
+    (void)sample_count;
     // Currently disabled - was too aggressive and removed speech
     // for (size_t i = 0; i < sample_count; i++) {
     //     float sample = (float)audio_data[i];
@@ -76,6 +81,7 @@ float AudioFilters::dcBlockingFilter(float input, float* state) {
 }
 
 float AudioFilters::highPassFilter(float input, float* state) {
+    (void)state;
     // Disabled for now - was too aggressive
     return input;
 } 
\ No newline at end of file
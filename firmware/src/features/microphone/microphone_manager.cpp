@@ -7,6 +7,8 @@
 #include <Arduino.h>
 #include "../../hal/constants.h"
 #include "../../system/memory/memory_utils.h"
+#include "../../system/clock/timer_service.h"
+#include "../../system/clock/profiler.h"
 #include "../../status/device_status.h"
 
 // Static member definitions
@@ -42,7 +44,7 @@ bool MicrophoneManager::initialize() {
     return true;
 }
 
-bool MicrophoneManager::configure() {
+bool MicrophoneManager::configure(bool skipSelfTest) {
     if (!s_initialized) {
         Serial.println("❌ Microphone manager not initialized!");
         return false;
@@ -112,13 +114,15 @@ bool MicrophoneManager::configure() {
     Serial.println("✅ DMA buffer zeroed successfully");
     
     // Test I2S read to verify it's working
-    uint8_t test_buffer[128];
-    size_t bytes_read = 0;
-    ret = i2s_read(I2S_NUM_0, test_buffer, sizeof(test_buffer), &bytes_read, pdMS_TO_TICKS(100));
-    if (ret == ESP_OK && bytes_read > 0) {
-        Serial.printf("✅ I2S test read successful: %d bytes\n", bytes_read);
-    } else {
-        Serial.printf("⚠️  I2S test read failed or no data: %s, bytes=%d\n", esp_err_to_name(ret), bytes_read);
+    if (!skipSelfTest) {
+        uint8_t test_buffer[128];
+        size_t bytes_read = 0;
+        ret = i2s_read(I2S_NUM_0, test_buffer, sizeof(test_buffer), &bytes_read, pdMS_TO_TICKS(100));
+        if (ret == ESP_OK && bytes_read > 0) {
+            Serial.printf("✅ I2S test read successful: %d bytes\n", bytes_read);
+        } else {
+            Serial.printf("⚠️  I2S test read failed or no data: %s, bytes=%d\n", esp_err_to_name(ret), bytes_read);
+        }
     }
     
     // Allocate audio buffers
@@ -149,6 +153,7 @@ size_t MicrophoneManager::readAudio() {
     }
     
     size_t bytes_read = 0;
+    PROFILE_SCOPE("mic_read");
     
     // Read audio data using ESP-IDF I2S driver
     esp_err_t ret = i2s_read(I2S_NUM_0, s_recording_buffer, RECORDING_BUFFER_SIZE, &bytes_read, pdMS_TO_TICKS(100));
@@ -258,8 +263,8 @@ void MicrophoneManager::deallocateBuffers() {
 
 void MicrophoneManager::logAudioData(size_t bytes_recorded) {
     // Debug logging every 5 seconds
-    static unsigned long lastDebugLog = 0;
-    if (millis() - lastDebugLog > 5000) {
+    static timer_handle_t debugLogTimer = TimerService::createPeriodic("I2SDebugLog", 5000);
+    if (TimerService::consume(debugLogTimer)) {
         Serial.printf("ESP-IDF I2S read: %d bytes requested, %d bytes received (%.1f%% filled)\n", 
                       RECORDING_BUFFER_SIZE, bytes_recorded, 
                       (float)bytes_recorded / RECORDING_BUFFER_SIZE * 100.0);
@@ -276,6 +281,5 @@ void MicrophoneManager::logAudioData(size_t bytes_recorded) {
             float duration_ms = (float)bytes_recorded / 2.0 / SAMPLE_RATE * 1000.0;
             Serial.printf("Audio duration: %.1f ms (direct I2S read)\n", duration_ms);
         }
-        lastDebugLog = millis();
     }
 } 
\ No newline at end of file
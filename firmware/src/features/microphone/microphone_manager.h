@@ -10,8 +10,8 @@ public:
     // Initialize microphone system
     static bool initialize();
     
-    // Configure I2S microphone
-    static bool configure();
+    // Configure I2S microphone (warm boots skip the I2S test read)
+    static bool configure(bool skipSelfTest = false);
     
     // Read audio data from microphone
     static size_t readAudio();
@@ -49,4 +49,22 @@ static inline unsigned char linear2ulaw(int pcm_val) /* 2's complement (16-bit r
     }
 }
 
+/* Decoder (G.711), used by the host stream decoder to undo linear2ulaw() */
+static inline int ulaw2linear(unsigned char u_val)
+{
+    int t;
+
+    /* Complement to obtain normal u-law value. */
+    u_val = ~u_val;
+
+    /*
+     * Extract and bias the quantization bits. Then
+     * shift up by the segment number and subtract out the bias.
+     */
+    t = ((u_val & 0x0F) << 3) + BIAS;
+    t <<= ((unsigned)u_val & 0x70) >> 4;
+
+    return ((u_val & 0x80) ? (BIAS - t) : (t - BIAS));
+}
+
 #endif // MULAW_H
\ No newline at end of file
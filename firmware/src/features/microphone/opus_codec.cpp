@@ -5,6 +5,7 @@
 #include <opus.h>
 #include <Arduino.h>
 #include "../../hal/constants.h"
+#include "../../system/clock/timer_service.h"
 
 // Static member definitions
 OpusEncoder* OpusCodec::s_encoder = nullptr;
@@ -77,12 +78,11 @@ int OpusCodec::encode(const int16_t* input_samples, size_t sample_count, uint8_t
     }
     
     // Debug logging (reduce frequency to avoid spam)
-    static unsigned long last_debug = 0;
-    if (millis() - last_debug > 5000) {
+    static timer_handle_t encodeLogTimer = TimerService::createPeriodic("OpusEncodeLog", 5000);
+    if (TimerService::consume(encodeLogTimer)) {
         Serial.printf("🎵 Opus encoded %zu samples to %d bytes (%.1f%% compression)\n", 
                       sample_count, encoded_bytes, 
                       (float)encoded_bytes / (sample_count * 2) * 100.0);
-        last_debug = millis();
     }
     
     return encoded_bytes;
@@ -109,10 +109,9 @@ int OpusCodec::decode(const uint8_t* input_data, size_t input_size, int16_t* out
     }
     
     // Debug logging (reduce frequency to avoid spam)
-    static unsigned long last_debug = 0;
-    if (millis() - last_debug > 5000) {
+    static timer_handle_t decodeLogTimer = TimerService::createPeriodic("OpusDecodeLog", 5000);
+    if (TimerService::consume(decodeLogTimer)) {
         Serial.printf("🎵 Opus decoded %zu bytes to %d samples\n", input_size, decoded_samples);
-        last_debug = millis();
     }
     
     return decoded_samples;
@@ -45,19 +45,41 @@ static const size_t COMPRESSED_BUFFER_SIZE = RECORDING_BUFFER_SIZE + 3; /* heade
 
 #define VOLUME_GAIN 2
 
+// Audio frames larger than this are split into chunks (stay well under MTU limit)
+#ifndef AUDIO_BLE_CHUNK_SIZE
+#define AUDIO_BLE_CHUNK_SIZE 400
+#endif
+
 // Device Information - Using XIAO ESP32-S3 constants
 // Note: BLE Service UUIDs are now defined in src/features/bluetooth/services/ble_services.h
-static const char* DEVICE_NAME = "OpenGlass";
+static const char* const DEVICE_NAME = "OpenGlass";
+
+// BLE Stack Backend
+// The GATT server runs on one of these (features/bluetooth/ble_transport.h).
+// NimBLE needs a core built with CONFIG_BT_NIMBLE_ENABLED (the stock
+// Arduino core ships Bluedroid); each backend reports the DRAM it takes and
+// its notify throughput on the serial console at every disconnect
+#define BLE_BACKEND_BLUEDROID 1
+#define BLE_BACKEND_NIMBLE 2
+#define BLE_BACKEND_MOCK 3                 // Host build only: the virtual device's central
+#ifndef BLE_BACKEND
+#define BLE_BACKEND BLE_BACKEND_BLUEDROID
+#endif
 
 // Photo Control Commands
 #define PHOTO_SINGLE_SHOT -1
+#define PHOTO_SCAN_CODE -2              // One shot: send a QR/EAN-13 code's text if one is in view, else the photo
+#define PHOTO_SKIP_UPLOAD -3            // Drop the rest of the photo being sent (a near-duplicate)
+#define PHOTO_PYRAMID_SHOT -4           // -4 to -7: one raw shot, sent as pyramid level 0-3 (full, 1/2, 1/4, 1/8)
+#define PHOTO_BULK_CHANNEL -8           // Accept an L2CAP channel on L2CAP_BULK_PSM for photos (L2CAP_BULK_CHANNEL)
 #define PHOTO_STOP 0
 #define PHOTO_MIN_INTERVAL 5
-#define PHOTO_MAX_INTERVAL 300
+#define PHOTO_MAX_INTERVAL 125         // Seconds; the command is an int8_t, rounded down to 5 s
 
 // Video Control Commands
 #define VIDEO_STREAM_START 1
 #define VIDEO_STREAM_STOP 0
+#define VIDEO_STREAM_START_BLOCKS 0x80   // Grayscale block video instead of JPEG frames
 #define VIDEO_SET_FPS_1 1
 #define VIDEO_SET_FPS_2 2
 #define VIDEO_SET_FPS_5 5
@@ -69,6 +91,29 @@ static const char* DEVICE_NAME = "OpenGlass";
 #define VIDEO_STREAM_DEFAULT_FPS 5
 #define VIDEO_STREAM_FRAME_INTERVAL(fps) (1000 / fps)
 
+// Block Video (conditional replenishment, features/camera/block_codec.h)
+// Frames are coded in whole 16x16 blocks: QQVGA loses its bottom 8 rows (160x112)
+#define VIDEO_BLOCK_FRAME_SIZE FRAMESIZE_QQVGA
+#define VIDEO_BLOCK_QUALITY 50
+#define VIDEO_BLOCK_SAD_THRESHOLD 2560     // Per 16x16 block: a mean change of 10 levels, above noise + quantization
+#define VIDEO_BLOCK_REFRESH_FRAMES 50      // Key frame every 10 s at the default FPS
+#define VIDEO_BLOCK_BUFFER_SIZE 16384      // Coded frame; blocks that do not fit go in the next one
+
+// Code Scanning (features/camera/code_scanner.h)
+// VGA resolves a version 10 QR code filling half the frame at 3+ pixels per module
+#define CODE_SCAN_FRAME_SIZE FRAMESIZE_VGA
+#define CODE_SCAN_ATTEMPTS 3            // Frames scanned before falling back to a photo
+#define CODE_PAYLOAD_SIZE 513           // Symbology byte + CODE_MAX_PAYLOAD
+
+// Pyramid Photos (features/camera/image_pyramid.h)
+// A raw capture in PSRAM, halved three times in one pass; only the level the
+// client asked for is JPEG-encoded (fmt2jpg), in grayscale
+#define PHOTO_PYRAMID_FRAME_SIZE FRAMESIZE_VGA
+#ifndef PHOTO_PYRAMID_PIXFORMAT
+#define PHOTO_PYRAMID_PIXFORMAT PIXFORMAT_GRAYSCALE   // Or PIXFORMAT_YUV422: twice the bytes, luma used
+#endif
+#define PHOTO_PYRAMID_JPEG_QUALITY 80                 // fmt2jpg scale: 1-100, higher is better
+
 // Camera Configuration
 #define CAMERA_JPEG_QUALITY 10
 #define CAMERA_FRAME_SIZE_HIGH FRAMESIZE_UXGA
@@ -81,13 +126,93 @@ static const char* DEVICE_NAME = "OpenGlass";
 #define CAMERA_STREAMING_FRAME_SIZE FRAMESIZE_QQVGA  // Even smaller for streaming (160x120)
 
 // Photo Transfer Configuration
+// Transfer sizes and the loop delay can be overridden from the build (e.g. host link sweeps)
+#ifndef PHOTO_CHUNK_SIZE
 #define PHOTO_CHUNK_SIZE 400  // Increased from 200 for better throughput
-#define PHOTO_END_MARKER_LOW 0xFF
-#define PHOTO_END_MARKER_HIGH 0xFF
+#endif
+// Frame headers and end marker: features/bluetooth/ble_frame_format.h
+// CPU budget of the upload cycle: when notify() blocks on a congested link the
+// upload is deferred so audio capture keeps its deadlines
+#define PHOTO_UPLOAD_BUDGET_US 10000
+#define PHOTO_UPLOAD_BUDGET_PERIOD_MS 50
+// Send the JPEG headers once per stream, then only the entropy-coded data and a
+// table ID (features/camera/jpeg_header.h). Clients must put the header back,
+// so this is off until they do
+// #define JPEG_HEADER_COMPACTION
+#define JPEG_HEADER_REFRESH_IMAGES 30      // A whole image at least this often
+
+// Send a start header with the photo's perceptual hash and length before its
+// chunks (features/camera/photo_hash.h), so clients can skip near-duplicates
+// with PHOTO_SKIP_UPLOAD. Clients must expect the header, so this is off until
+// they do
+// #define PHOTO_START_HEADER
+
+// L2CAP Bulk Channel
+// Uncomment to carry photos and the duty-cycle backlog over an L2CAP
+// connection-oriented channel with credit-based flow control instead of
+// photo data notifications (features/bluetooth/l2cap_channel.h). A client
+// writes PHOTO_BULK_CHANNEL to photo control, then connects to the PSM;
+// control, status and audio stay on GATT. Needs BLE_BACKEND_NIMBLE;
+// Bluedroid has no LE channels
+// #define L2CAP_BULK_CHANNEL
+#define L2CAP_BULK_PSM 0x0081              // LE dynamic range, 0x0080-0x00FF
+#define L2CAP_BULK_SDU_SIZE 2048           // Frame header + photo bytes per SDU (less if the client's MTU is)
+#define L2CAP_BULK_RX_MTU 64               // Nothing is read from the channel
+#define L2CAP_BULK_ACCEPT_MS 10000         // The connect must follow PHOTO_BULK_CHANNEL within this
+
+// Photo Quality Gate
+// Photos are scored for motion blur and clipped exposure before upload
+// (features/camera/photo_quality.h, tuned with tools/quality_bench)
+#define PHOTO_QUALITY_OFF 0
+#define PHOTO_QUALITY_TAG 1                // Upload every photo, flags in the start header (PHOTO_START_HEADER)
+#define PHOTO_QUALITY_RECAPTURE 2          // Retake rejected interval photos, then upload the last one
+#ifndef PHOTO_QUALITY_POLICY
+#ifdef PHOTO_START_HEADER
+#define PHOTO_QUALITY_POLICY PHOTO_QUALITY_TAG     // The sample captures all score as blurry: opt in to retakes
+#else
+#define PHOTO_QUALITY_POLICY PHOTO_QUALITY_OFF     // Without the start header the flags would only reach Serial
+#endif
+#endif
+#define PHOTO_QUALITY_BUDGET_MS 1500       // No retakes once this long has passed since the first shot
+#define PHOTO_QUALITY_FACTOR 0             // Shrink before scoring: 2, 4, 8, or 0 for about 200x150
+#define PHOTO_QUALITY_MIN_SHARPNESS 140    // Sharp desk frames score 260+, blurred by 6 px 80 or less
+#define PHOTO_QUALITY_DARK_LEVEL 16
+#define PHOTO_QUALITY_BRIGHT_LEVEL 240
+#define PHOTO_QUALITY_MAX_CLIPPED_PERCENT 25
+
+// Duty-Cycled Capture Configuration
+// Uncomment to deep sleep between photos for long capture intervals (audio is not captured)
+// #define DUTY_CYCLE_CAPTURE_ENABLED
+#define DUTY_CYCLE_MIN_INTERVAL_S 60       // Intervals at or above this are duty-cycled
+#define DUTY_CYCLE_FLUSH_EVERY 10          // Boot BLE on every Nth wake to upload the batch
+#define DUTY_CYCLE_FLUSH_WINDOW_MS 30000   // How long a flush wake waits for a client
+#define DUTY_CYCLE_MAX_STORED_PHOTOS 32    // Oldest stored photo is dropped beyond this
+#define DUTY_CYCLE_CAPTURE_CURRENT_MA 70   // Estimated draw during a camera-only wake
+
+// Profiling Configuration
+// Scoped cycle-counter timers (system/clock/profiler.h); define PROFILER_DISABLED to compile them out
+#ifndef PROFILER_DISABLED
+#define PROFILER_ENABLED
+#endif
+#define PROFILER_REPORT_INTERVAL_MS 30000  // Printed with the loop performance report
+
+// Loop Stall Watchdog
+// A task on the other core reports updateCycles() passes over the threshold and
+// the cycle that caused them (system/cycles/loop_watchdog.h)
+#define LOOP_WATCHDOG_THRESHOLD_MS 200     // Audio DMA buffers cover a little more than this
+#define LOOP_WATCHDOG_CHECK_MS 20
+// Uncomment to print the loop core's backtrace on every stall
+// #define LOOP_WATCHDOG_BACKTRACE
+
+// Device Lifecycle
+// Control writes from the BLE task wait here for the Lifecycle cycle (status/device_lifecycle.h)
+#define LIFECYCLE_EVENT_QUEUE_SIZE 8       // Power of two
 
 // Timing Configuration
 #define BATTERY_UPDATE_INTERVAL 60000  // 60 seconds
+#ifndef MAIN_LOOP_DELAY
 #define MAIN_LOOP_DELAY 20             // Reduced to 20ms for better audio capture continuity
+#endif
 
 // I2S Pin Configuration - Using XIAO ESP32-S3 constants
 #define I2S_WS_PIN XIAO_ESP32S3_SENSE_PIN_D11   // GPIO42
@@ -1,8 +1,19 @@
 #include "led_manager.h"
+#include "led_patterns.h"
+#include <esp_timer.h>
+#include <driver/ledc.h>
 
 // Global dual LED state variable
 dual_led_state_t dualLedState;
 
+// Pattern engine timer (see PATTERN ENGINE below)
+static esp_timer_handle_t ledTimer = nullptr;
+static void ledTimerCallback(void* arg);
+
+// User LED PWM state
+static bool userLedPwm = false;
+static uint16_t gammaTable[256];
+
 #ifdef RGB_LED_ENABLED
 // RGB LED array for FastLED
 CRGB leds[RGB_LED_COUNT];
@@ -12,10 +23,55 @@ CRGB leds[RGB_LED_COUNT];
 // LED MANAGER IMPLEMENTATION
 // ===================================================================
 
+/**
+ * Drive the User LED from LEDC so brightness and fades are real.
+ * Falls back to digital on/off if LEDC cannot be configured.
+ */
+static bool initUserLedPwm() {
+    ledc_timer_config_t timer_config = {};
+    timer_config.speed_mode = LEDC_LOW_SPEED_MODE;
+    timer_config.duty_resolution = USER_LED_PWM_RESOLUTION;
+    timer_config.timer_num = USER_LED_LEDC_TIMER;
+    timer_config.freq_hz = USER_LED_PWM_FREQ_HZ;
+    timer_config.clk_cfg = LEDC_AUTO_CLK;
+    if (ledc_timer_config(&timer_config) != ESP_OK) {
+        return false;
+    }
+    
+    ledc_channel_config_t channel_config = {};
+    channel_config.gpio_num = XIAO_ESP32S3_USER_LED_PIN;
+    channel_config.speed_mode = LEDC_LOW_SPEED_MODE;
+    channel_config.channel = USER_LED_LEDC_CHANNEL;
+    channel_config.intr_type = LEDC_INTR_DISABLE;
+    channel_config.timer_sel = USER_LED_LEDC_TIMER;
+    channel_config.duty = 0;
+    channel_config.hpoint = 0;
+    if (ledc_channel_config(&channel_config) != ESP_OK) {
+        return false;
+    }
+    
+    // Hardware fade support (ESP_ERR_INVALID_STATE: already installed)
+    esp_err_t err = ledc_fade_func_install(0);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+        return false;
+    }
+    
+    // Perceived brightness -> duty
+    for (int i = 0; i < 256; i++) {
+        gammaTable[i] = (uint16_t)(powf(i / 255.0f, USER_LED_GAMMA) * USER_LED_PWM_MAX_DUTY + 0.5f);
+    }
+    
+    return true;
+}
+
 void initLedManager() {
     // Initialize User LED (GPIO21)
-    pinMode(XIAO_ESP32S3_USER_LED_PIN, OUTPUT);
-    digitalWrite(XIAO_ESP32S3_USER_LED_PIN, LOW);
+    userLedPwm = initUserLedPwm();
+    if (!userLedPwm) {
+        Serial.println("User LED PWM unavailable, using on/off output");
+        pinMode(XIAO_ESP32S3_USER_LED_PIN, OUTPUT);
+        digitalWrite(XIAO_ESP32S3_USER_LED_PIN, LOW);
+    }
     
 #ifdef RGB_LED_ENABLED
     // Initialize external RGB LED
@@ -35,29 +91,80 @@ void initLedManager() {
     dualLedState.primary_color = (rgb_color_t)LED_COLOR_WHITE;
     dualLedState.secondary_color = (rgb_color_t)LED_COLOR_BLUE;
     dualLedState.enabled = true;
-    dualLedState.lastUpdate = measureStart();
+    dualLedState.lastUpdateUs = monotonicMicros();
     dualLedState.step = 0;
     dualLedState.brightness = 255;
     dualLedState.user_led_state = false;
     dualLedState.charge_led_detected = false;
+    
+    // Pattern steps are played from a high-resolution timer
+    esp_timer_create_args_t timer_args = {};
+    timer_args.callback = ledTimerCallback;
+    timer_args.name = "led_pattern";
+    if (esp_timer_create(&timer_args, &ledTimer) != ESP_OK) {
+        ledTimer = nullptr;
+        Serial.println("LED pattern timer unavailable, patterns will run from the main loop");
+    }
+}
+
+/**
+ * Brightness of a colour on the single-colour User LED
+ */
+static uint8_t colorIntensity(rgb_color_t color) {
+    uint8_t intensity = color.r;
+    if (color.g > intensity) intensity = color.g;
+    if (color.b > intensity) intensity = color.b;
+    return intensity;
 }
 
 void setUserLed(rgb_color_t color, bool show) {
-    // For single LED, use brightness based on color intensity
-    int intensity = (color.r + color.g + color.b) / 3;
-    if (intensity > 0) {
-        digitalWrite(XIAO_ESP32S3_USER_LED_PIN, HIGH);
-        dualLedState.user_led_state = true;
+    (void)show;  // The User LED has no frame buffer to push
+    uint8_t intensity = colorIntensity(color);
+    dualLedState.user_led_state = intensity > 0;
+    
+    if (userLedPwm) {
+        ledc_set_duty_and_update(LEDC_LOW_SPEED_MODE, USER_LED_LEDC_CHANNEL, gammaTable[intensity], 0);
     } else {
-        digitalWrite(XIAO_ESP32S3_USER_LED_PIN, LOW);
-        dualLedState.user_led_state = false;
+        digitalWrite(XIAO_ESP32S3_USER_LED_PIN, intensity > 0 ? HIGH : LOW);
     }
 }
 
+void fadeUserLed(rgb_color_t color, uint32_t duration_ms) {
+    if (!userLedPwm || duration_ms == 0) {
+        setUserLed(color);
+        return;
+    }
+    
+    uint8_t intensity = colorIntensity(color);
+    dualLedState.user_led_state = intensity > 0;
+    
+    // LEDC steps the duty in hardware; nothing runs until the next step
+    ledc_set_fade_time_and_start(LEDC_LOW_SPEED_MODE, USER_LED_LEDC_CHANNEL,
+                                 gammaTable[intensity], duration_ms, LEDC_FADE_NO_WAIT);
+}
+
+uint32_t getUserLedDuty() {
+    if (!userLedPwm) {
+        return dualLedState.user_led_state ? USER_LED_PWM_MAX_DUTY : 0;
+    }
+    return ledc_get_duty(LEDC_LOW_SPEED_MODE, USER_LED_LEDC_CHANNEL);
+}
+
+uint32_t getUserLedMaxDuty() {
+    return USER_LED_PWM_MAX_DUTY;
+}
+
+uint32_t ledLevelToDuty(uint8_t level) {
+    return userLedPwm ? gammaTable[level] : (level > 0 ? USER_LED_PWM_MAX_DUTY : 0);
+}
+
 void setRgbLed(rgb_color_t color, bool show) {
 #ifdef RGB_LED_ENABLED
     leds[0] = CRGB(color.r, color.g, color.b);
     if (show) FastLED.show();
+#else
+    (void)color;
+    (void)show;
 #endif
 }
 
@@ -69,173 +176,156 @@ void setDualLedColors(rgb_color_t primary, rgb_color_t secondary, bool show) {
     }
 }
 
-void setLedPattern(led_pattern_t pattern, rgb_color_t primary_color, rgb_color_t secondary_color) {
+// ===================================================================
+// PATTERN ENGINE
+// ===================================================================
+//
+// Steps are played from the tables in led_patterns.h by a one-shot
+// esp_timer that re-arms itself for the next step's duration. LED output
+// therefore keeps its timing while the main loop is blocked (photo
+// capture, BLE uploads) and costs no loop time. If the timer cannot be
+// created, updateLed() falls back to advancing steps from the loop.
+//
+
+static_assert(LED_PATTERN_COUNT == LED_DUAL_INDICATION + 1, "LED pattern table out of sync with led_pattern_t");
+
+static portMUX_TYPE ledMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Pattern interrupted by a LED_END_RESUME pattern
+static led_pattern_t resumePattern = LED_OFF;
+static rgb_color_t resumePrimary = LED_COLOR_OFF;
+static rgb_color_t resumeSecondary = LED_COLOR_OFF;
+
+// Step duration override for flashDualLed() (0 = use the table)
+static uint16_t tickOverrideMs = 0;
+
+static rgb_color_t scaleColor(rgb_color_t color, uint8_t level) {
+    rgb_color_t scaled = {
+        (uint8_t)(color.r * level / 255),
+        (uint8_t)(color.g * level / 255),
+        (uint8_t)(color.b * level / 255)
+    };
+    return scaled;
+}
+
+/**
+ * Output the current step and return its duration in ms
+ */
+static uint32_t applyCurrentStep() {
+    portENTER_CRITICAL(&ledMux);
+    const led_pattern_def_t& def = LED_PATTERN_TABLE[dualLedState.pattern];
+    const led_step_t step = def.steps[dualLedState.step];
+    rgb_color_t primary = scaleColor(dualLedState.primary_color, step.primary);
+    rgb_color_t secondary = scaleColor(dualLedState.secondary_color, step.secondary);
+    uint32_t duration_ms = step.ticks * (tickOverrideMs ? tickOverrideMs : def.tick_ms);
+    portEXIT_CRITICAL(&ledMux);
+    
+    if (!dualLedState.enabled) {
+        primary = (rgb_color_t)LED_COLOR_OFF;
+        secondary = (rgb_color_t)LED_COLOR_OFF;
+    }
+    
+    if (step.flags & LED_STEP_FADE) {
+        fadeUserLed(primary, duration_ms);
+    } else {
+        setUserLed(primary);
+    }
+    if (dualLedState.mode == DUAL_LED_MODE_RGB_ENHANCED) {
+        setRgbLed(secondary);
+    }
+    
+    return duration_ms;
+}
+
+/**
+ * Move to the next step, handling the end of the pattern
+ */
+static void advanceStep() {
+    portENTER_CRITICAL(&ledMux);
+    const led_pattern_def_t& def = LED_PATTERN_TABLE[dualLedState.pattern];
+    dualLedState.step++;
+    if (dualLedState.step >= def.length) {
+        dualLedState.step = 0;
+        switch (def.end) {
+            case LED_END_OFF:
+                dualLedState.pattern = LED_OFF;
+                tickOverrideMs = 0;
+                break;
+            case LED_END_RESUME:
+                dualLedState.pattern = resumePattern;
+                dualLedState.primary_color = resumePrimary;
+                dualLedState.secondary_color = resumeSecondary;
+                tickOverrideMs = 0;
+                break;
+            case LED_END_LOOP:
+            default:
+                break;
+        }
+    }
+    dualLedState.lastUpdateUs = monotonicMicros();
+    portEXIT_CRITICAL(&ledMux);
+}
+
+static void armLedTimer(uint32_t duration_ms) {
+    esp_timer_stop(ledTimer);
+    esp_timer_start_once(ledTimer, (uint64_t)duration_ms * 1000ULL);
+}
+
+static void ledTimerCallback(void* arg) {
+    (void)arg;
+    advanceStep();
+    armLedTimer(applyCurrentStep());
+}
+
+static void startPattern(led_pattern_t pattern, rgb_color_t primary_color, rgb_color_t secondary_color, uint16_t tick_override_ms) {
+    if ((size_t)pattern >= LED_PATTERN_COUNT) {
+        pattern = LED_BLINK_SLOW;
+    }
+    
+    portENTER_CRITICAL(&ledMux);
+    if (LED_PATTERN_TABLE[pattern].end == LED_END_RESUME &&
+        LED_PATTERN_TABLE[dualLedState.pattern].end != LED_END_RESUME) {
+        resumePattern = dualLedState.pattern;
+        resumePrimary = dualLedState.primary_color;
+        resumeSecondary = dualLedState.secondary_color;
+    }
     dualLedState.pattern = pattern;
     dualLedState.primary_color = primary_color;
     dualLedState.secondary_color = secondary_color;
     dualLedState.step = 0;
-    dualLedState.lastUpdate = measureStart();
+    dualLedState.lastUpdateUs = monotonicMicros();
+    tickOverrideMs = tick_override_ms;
+    portEXIT_CRITICAL(&ledMux);
+    
+    uint32_t duration_ms = applyCurrentStep();
+    if (ledTimer) {
+        armLedTimer(duration_ms);
+    }
+}
+
+void setLedPattern(led_pattern_t pattern, rgb_color_t primary_color, rgb_color_t secondary_color) {
+    startPattern(pattern, primary_color, secondary_color, 0);
 }
 
 void updateLed() {
-    if (!dualLedState.enabled) return;
+    // Timer-driven patterns need no loop work
+    if (ledTimer) return;
     
-    unsigned long elapsed = getElapsedTime(dualLedState.lastUpdate);
-    
-    switch (dualLedState.pattern) {
-        case LED_OFF:
-            setDualLedColors((rgb_color_t)LED_COLOR_OFF, (rgb_color_t)LED_COLOR_OFF);
-            break;
-            
-        case LED_ON:
-            setDualLedColors(dualLedState.primary_color, dualLedState.secondary_color);
-            break;
-            
-        case LED_BLINK_SLOW:
-            if (elapsed > TIMING_MEDIUM) {
-                if (dualLedState.step % 2 == 0) {
-                    setDualLedColors(dualLedState.primary_color, dualLedState.secondary_color);
-                } else {
-                    setDualLedColors((rgb_color_t)LED_COLOR_OFF, (rgb_color_t)LED_COLOR_OFF);
-                }
-                dualLedState.step++;
-                dualLedState.lastUpdate = measureStart();
-            }
-            break;
-            
-        case LED_BLINK_FAST:
-            if (elapsed > TIMING_SHORT) {
-                if (dualLedState.step % 2 == 0) {
-                    setDualLedColors(dualLedState.primary_color, dualLedState.secondary_color);
-                } else {
-                    setDualLedColors((rgb_color_t)LED_COLOR_OFF, (rgb_color_t)LED_COLOR_OFF);
-                }
-                dualLedState.step++;
-                dualLedState.lastUpdate = measureStart();
-            }
-            break;
-            
-        case LED_BLINK_VERY_FAST:
-            if (elapsed > TIMING_VERY_SHORT) {
-                if (dualLedState.step % 2 == 0) {
-                    setDualLedColors(dualLedState.primary_color, dualLedState.secondary_color);
-                } else {
-                    setDualLedColors((rgb_color_t)LED_COLOR_OFF, (rgb_color_t)LED_COLOR_OFF);
-                }
-                dualLedState.step++;
-                dualLedState.lastUpdate = measureStart();
-            }
-            break;
-            
-        case LED_PULSE:
-            if (elapsed > 20) {
-                int brightness = (sin(dualLedState.step * 0.1) + 1) * 127.5;
-                rgb_color_t dimmed_primary = {
-                    (uint8_t)(dualLedState.primary_color.r * brightness / 255),
-                    (uint8_t)(dualLedState.primary_color.g * brightness / 255),
-                    (uint8_t)(dualLedState.primary_color.b * brightness / 255)
-                };
-                rgb_color_t dimmed_secondary = {
-                    (uint8_t)(dualLedState.secondary_color.r * brightness / 255),
-                    (uint8_t)(dualLedState.secondary_color.g * brightness / 255),
-                    (uint8_t)(dualLedState.secondary_color.b * brightness / 255)
-                };
-                setDualLedColors(dimmed_primary, dimmed_secondary);
-                dualLedState.step++;
-                dualLedState.lastUpdate = measureStart();
-            }
-            break;
-            
-        case LED_HEARTBEAT:
-            if (elapsed > TIMING_SHORT) {
-                int pattern[] = {1, 0, 1, 0, 0, 0, 0, 0};
-                int index = dualLedState.step % 8;
-                if (pattern[index]) {
-                    setDualLedColors(dualLedState.primary_color, dualLedState.secondary_color);
-                } else {
-                    setDualLedColors((rgb_color_t)LED_COLOR_OFF, (rgb_color_t)LED_COLOR_OFF);
-                }
-                dualLedState.step++;
-                dualLedState.lastUpdate = measureStart();
-            }
-            break;
-            
-        case LED_SOS:
-            if (elapsed > 200) {
-                // SOS pattern: ... --- ...
-                int pattern[] = {1,0,1,0,1,0,0,1,1,0,1,1,0,1,1,0,0,1,0,1,0,1,0,0,0,0};
-                int index = dualLedState.step % 26;
-                if (pattern[index]) {
-                    setDualLedColors(dualLedState.primary_color, dualLedState.secondary_color);
-                } else {
-                    setDualLedColors((rgb_color_t)LED_COLOR_OFF, (rgb_color_t)LED_COLOR_OFF);
-                }
-                dualLedState.step++;
-                dualLedState.lastUpdate = measureStart();
-            }
-            break;
-            
-        case LED_STARTUP:
-            if (elapsed > TIMING_SHORT) {
-                // Startup sequence: alternating pattern between LEDs
-                if (dualLedState.step < 10) {
-                    if (dualLedState.step % 2 == 0) {
-                        setDualLedColors(dualLedState.primary_color, (rgb_color_t)LED_COLOR_OFF);
-                    } else {
-                        setDualLedColors((rgb_color_t)LED_COLOR_OFF, dualLedState.secondary_color);
-                    }
-                } else if (dualLedState.step < 15) {
-                    // Final flash both
-                    setDualLedColors(dualLedState.primary_color, dualLedState.secondary_color);
-                } else {
-                    setDualLedColors((rgb_color_t)LED_COLOR_OFF, (rgb_color_t)LED_COLOR_OFF);
-                    dualLedState.pattern = LED_OFF; // End pattern
-                }
-                dualLedState.step++;
-                dualLedState.lastUpdate = measureStart();
-            }
-            break;
-            
-        case LED_DUAL_INDICATION:
-            // Special pattern: User LED shows primary status, RGB LED shows secondary
-            if (elapsed > 250) {
-                if (dualLedState.step % 4 < 2) {
-                    setUserLed(dualLedState.primary_color);
-                } else {
-                    setUserLed((rgb_color_t)LED_COLOR_OFF);
-                }
-                
-                if ((dualLedState.step + 2) % 4 < 2) {
-                    setRgbLed(dualLedState.secondary_color);
-                } else {
-                    setRgbLed((rgb_color_t)LED_COLOR_OFF);
-                }
-                
-                dualLedState.step++;
-                dualLedState.lastUpdate = measureStart();
-            }
-            break;
-            
-        default:
-            // Default to simple blink
-            if (elapsed > TIMING_MEDIUM) {
-                if (dualLedState.step % 2 == 0) {
-                    setDualLedColors(dualLedState.primary_color, dualLedState.secondary_color);
-                } else {
-                    setDualLedColors((rgb_color_t)LED_COLOR_OFF, (rgb_color_t)LED_COLOR_OFF);
-                }
-                dualLedState.step++;
-                dualLedState.lastUpdate = measureStart();
-            }
-            break;
+    const led_pattern_def_t& def = LED_PATTERN_TABLE[dualLedState.pattern];
+    uint32_t duration_ms = def.steps[dualLedState.step].ticks * (tickOverrideMs ? tickOverrideMs : def.tick_ms);
+    if (hasTimedOutUs(dualLedState.lastUpdateUs, (uint64_t)duration_ms * 1000ULL)) {
+        advanceStep();
+        applyCurrentStep();
     }
 }
 
+bool isLedTimerDriven() {
+    return ledTimer != nullptr;
+}
+
 void setLedEnabled(bool enabled) {
     dualLedState.enabled = enabled;
-    if (!enabled) {
-        setDualLedColors((rgb_color_t)LED_COLOR_OFF, (rgb_color_t)LED_COLOR_OFF);
-    }
+    applyCurrentStep();
 }
 
 led_pattern_t getCurrentLedPattern() {
@@ -247,19 +337,7 @@ dual_led_mode_t getCurrentLedMode() {
 }
 
 void flashDualLed(rgb_color_t primary, rgb_color_t secondary, int duration_ms) {
-    static unsigned long flashStartTime = 0;
-    static bool flashActive = false;
-    
-    if (!flashActive) {
-        // Start flash
-        setDualLedColors(primary, secondary);
-        flashStartTime = measureStart();
-        flashActive = true;
-    } else if (getElapsedTime(flashStartTime) >= duration_ms) {
-        // End flash
-        setDualLedColors((rgb_color_t)LED_COLOR_OFF, (rgb_color_t)LED_COLOR_OFF);
-        flashActive = false;
-    }
+    startPattern(LED_PHOTO_CAPTURE, primary, secondary, duration_ms);
 }
 
 void setLedForDeviceStatus(uint8_t status) {
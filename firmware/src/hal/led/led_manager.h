@@ -2,6 +2,7 @@
 #define LED_MANAGER_H
 
 #include <Arduino.h>
+#include <driver/ledc.h>
 #include "../xiao_esp32s3_constants.h"
 #include "../../system/clock/timing.h"
 
@@ -24,6 +25,14 @@
  * For enhanced RGB support, connect an external WS2812/NeoPixel LED to any GPIO
  */
 
+// User LED PWM (the camera XCLK uses LEDC timer 0 / channel 0)
+#define USER_LED_LEDC_TIMER LEDC_TIMER_1
+#define USER_LED_LEDC_CHANNEL LEDC_CHANNEL_1
+#define USER_LED_PWM_FREQ_HZ 5000
+#define USER_LED_PWM_RESOLUTION LEDC_TIMER_12_BIT
+#define USER_LED_PWM_MAX_DUTY ((1 << 12) - 1)
+#define USER_LED_GAMMA 2.2f          // Perceived brightness correction
+
 // Uncomment the next line to enable external RGB LED support
 // #define RGB_LED_ENABLED
 
@@ -108,7 +117,7 @@ typedef struct {
     rgb_color_t secondary_color;  // Color for RGB LED (if enabled)
     dual_led_mode_t mode;
     bool enabled;
-    unsigned long lastUpdate;
+    uint64_t lastUpdateUs;         // Start of the current step (monotonicMicros())
     int step;
     int brightness;
     bool user_led_state;
@@ -132,10 +141,32 @@ extern CRGB leds[RGB_LED_COUNT];
 void initLedManager();
 
 /**
- * Set User LED state with intensity-based color simulation
+ * Set User LED brightness from the colour's intensity (gamma-corrected PWM)
  */
 void setUserLed(rgb_color_t color, bool show = true);
 
+/**
+ * Fade the User LED to a colour's intensity using LEDC hardware fade
+ * @param duration_ms Fade time; the CPU is not involved while it runs
+ */
+void fadeUserLed(rgb_color_t color, uint32_t duration_ms);
+
+/**
+ * Get the User LED's PWM duty as currently output by LEDC (follows fades)
+ * @return Duty in 0..getUserLedMaxDuty()
+ */
+uint32_t getUserLedDuty();
+
+/**
+ * Get the User LED's full-scale duty
+ */
+uint32_t getUserLedMaxDuty();
+
+/**
+ * Convert a 0-255 brightness level to the gamma-corrected duty
+ */
+uint32_t ledLevelToDuty(uint8_t level);
+
 /**
  * Set external RGB LED (if enabled)
  */
@@ -152,10 +183,16 @@ void setDualLedColors(rgb_color_t primary, rgb_color_t secondary = (rgb_color_t)
 void setLedPattern(led_pattern_t pattern, rgb_color_t primary_color = (rgb_color_t)LED_COLOR_WHITE, rgb_color_t secondary_color = (rgb_color_t)LED_COLOR_BLUE);
 
 /**
- * Update LED patterns (call this in main loop)
+ * Update LED patterns from the main loop. Only needed when the pattern
+ * timer could not be created; otherwise patterns run on their own.
  */
 void updateLed();
 
+/**
+ * Check whether patterns are played by the high-resolution timer
+ */
+bool isLedTimerDriven();
+
 /**
  * Enable/disable LED system
  */
@@ -0,0 +1,133 @@
+#ifndef LED_PATTERNS_H
+#define LED_PATTERNS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ===================================================================
+// LED PATTERN TABLES
+// ===================================================================
+//
+// Every pattern is a constant step table played by the LED engine in
+// led_manager.cpp. A step holds the brightness of the primary (User LED)
+// and secondary (RGB LED) channel for a number of ticks; the pattern's
+// tick length sets its speed, so one table can serve several patterns.
+//
+
+/**
+ * What happens after the last step
+ */
+typedef enum {
+    LED_END_LOOP,               // Start again at step 0
+    LED_END_OFF,                // Switch to LED_OFF
+    LED_END_RESUME              // Go back to the pattern that was interrupted
+} led_pattern_end_t;
+
+/**
+ * Step flags
+ */
+#define LED_STEP_FADE 0x01      // Fade the User LED to this level over the step (LEDC hardware fade)
+
+/**
+ * One step of a pattern
+ */
+typedef struct {
+    uint8_t ticks;              // Duration in pattern ticks
+    uint8_t primary;            // Primary channel brightness (0-255)
+    uint8_t secondary;          // Secondary channel brightness (0-255)
+    uint8_t flags;              // LED_STEP_* flags
+} led_step_t;
+
+/**
+ * Pattern definition
+ */
+typedef struct {
+    const led_step_t* steps;
+    uint8_t length;
+    uint16_t tick_ms;
+    led_pattern_end_t end;
+} led_pattern_def_t;
+
+#define LED_STEPS(table) table, (uint8_t)(sizeof(table) / sizeof(table[0]))
+
+// A step that holds both channels (no flags)
+#define LED_STEP(ticks, primary, secondary) {ticks, primary, secondary, 0}
+
+// Steady states
+static constexpr led_step_t LED_STEPS_OFF[] = {LED_STEP(1, 0, 0)};
+static constexpr led_step_t LED_STEPS_ON[] = {LED_STEP(1, 255, 255)};
+
+// Blinks
+static constexpr led_step_t LED_STEPS_BLINK[] = {LED_STEP(1, 255, 255), LED_STEP(1, 0, 0)};
+static constexpr led_step_t LED_STEPS_HEARTBEAT[] = {
+    LED_STEP(1, 255, 255), LED_STEP(1, 0, 0), LED_STEP(1, 255, 255), LED_STEP(5, 0, 0),
+};
+static constexpr led_step_t LED_STEPS_DOUBLE_BLINK[] = {
+    LED_STEP(1, 255, 255), LED_STEP(1, 0, 0), LED_STEP(1, 255, 255), LED_STEP(7, 0, 0),
+};
+static constexpr led_step_t LED_STEPS_SINGLE_BLINK[] = {LED_STEP(1, 255, 255), LED_STEP(19, 0, 0)};
+static constexpr led_step_t LED_STEPS_FLASH[] = {LED_STEP(1, 255, 255)};
+
+// SOS: ... --- ...
+static constexpr led_step_t LED_STEPS_SOS[] = {
+    LED_STEP(1, 255, 255), LED_STEP(1, 0, 0), LED_STEP(1, 255, 255),
+    LED_STEP(1, 0, 0),     LED_STEP(1, 255, 255), LED_STEP(2, 0, 0),
+    LED_STEP(2, 255, 255), LED_STEP(1, 0, 0), LED_STEP(2, 255, 255),
+    LED_STEP(1, 0, 0),     LED_STEP(2, 255, 255), LED_STEP(2, 0, 0),
+    LED_STEP(1, 255, 255), LED_STEP(1, 0, 0), LED_STEP(1, 255, 255),
+    LED_STEP(1, 0, 0),     LED_STEP(1, 255, 255), LED_STEP(4, 0, 0),
+};
+
+// Alternate between the two LEDs, then flash both
+static constexpr led_step_t LED_STEPS_STARTUP[] = {
+    LED_STEP(1, 255, 0), LED_STEP(1, 0, 255), LED_STEP(1, 255, 0), LED_STEP(1, 0, 255),
+    LED_STEP(1, 255, 0), LED_STEP(1, 0, 255), LED_STEP(1, 255, 0), LED_STEP(1, 0, 255),
+    LED_STEP(1, 255, 0), LED_STEP(1, 0, 255),
+    LED_STEP(5, 255, 255),
+};
+
+static constexpr led_step_t LED_STEPS_DUAL[] = {LED_STEP(2, 255, 0), LED_STEP(2, 0, 255)};
+
+// Breathing: one sine period as 32 hardware fades, each ending at the
+// listed level. Levels are perceived brightness; gamma is applied on output.
+#define LED_FADE_TO(level) {1, level, level, LED_STEP_FADE}
+static constexpr led_step_t LED_STEPS_PULSE[] = {
+    LED_FADE_TO(2),   LED_FADE_TO(10),  LED_FADE_TO(21),  LED_FADE_TO(37),
+    LED_FADE_TO(57),  LED_FADE_TO(79),  LED_FADE_TO(103), LED_FADE_TO(128),
+    LED_FADE_TO(152), LED_FADE_TO(176), LED_FADE_TO(198), LED_FADE_TO(218),
+    LED_FADE_TO(234), LED_FADE_TO(245), LED_FADE_TO(253), LED_FADE_TO(255),
+    LED_FADE_TO(253), LED_FADE_TO(245), LED_FADE_TO(234), LED_FADE_TO(218),
+    LED_FADE_TO(198), LED_FADE_TO(176), LED_FADE_TO(152), LED_FADE_TO(128),
+    LED_FADE_TO(103), LED_FADE_TO(79),  LED_FADE_TO(57),  LED_FADE_TO(37),
+    LED_FADE_TO(21),  LED_FADE_TO(10),  LED_FADE_TO(2),   LED_FADE_TO(0),
+};
+#undef LED_FADE_TO
+#undef LED_STEP
+
+/**
+ * Pattern table, indexed by led_pattern_t
+ */
+static constexpr led_pattern_def_t LED_PATTERN_TABLE[] = {
+    {LED_STEPS(LED_STEPS_OFF),          1000, LED_END_LOOP},    // LED_OFF
+    {LED_STEPS(LED_STEPS_ON),           1000, LED_END_LOOP},    // LED_ON
+    {LED_STEPS(LED_STEPS_BLINK),        500,  LED_END_LOOP},    // LED_BLINK_SLOW
+    {LED_STEPS(LED_STEPS_BLINK),        250,  LED_END_LOOP},    // LED_BLINK_FAST
+    {LED_STEPS(LED_STEPS_BLINK),        100,  LED_END_LOOP},    // LED_BLINK_VERY_FAST
+    {LED_STEPS(LED_STEPS_PULSE),        40,   LED_END_LOOP},    // LED_PULSE
+    {LED_STEPS(LED_STEPS_HEARTBEAT),    250,  LED_END_LOOP},    // LED_HEARTBEAT
+    {LED_STEPS(LED_STEPS_SOS),          200,  LED_END_LOOP},    // LED_SOS
+    {LED_STEPS(LED_STEPS_STARTUP),      250,  LED_END_OFF},     // LED_STARTUP
+    {LED_STEPS(LED_STEPS_BLINK),        100,  LED_END_LOOP},    // LED_ERROR
+    {LED_STEPS(LED_STEPS_PULSE),        80,   LED_END_LOOP},    // LED_CONNECTED
+    {LED_STEPS(LED_STEPS_SINGLE_BLINK), 100,  LED_END_LOOP},    // LED_DISCONNECTED
+    {LED_STEPS(LED_STEPS_OFF),          1000, LED_END_LOOP},    // LED_CHARGING (hardware charge LED)
+    {LED_STEPS(LED_STEPS_DOUBLE_BLINK), 200,  LED_END_LOOP},    // LED_LOW_BATTERY
+    {LED_STEPS(LED_STEPS_PULSE),        20,   LED_END_LOOP},    // LED_STREAMING
+    {LED_STEPS(LED_STEPS_FLASH),        100,  LED_END_RESUME},  // LED_PHOTO_CAPTURE
+    {LED_STEPS(LED_STEPS_BLINK),        50,   LED_END_LOOP},    // LED_FACTORY_RESET
+    {LED_STEPS(LED_STEPS_DUAL),         250,  LED_END_LOOP},    // LED_DUAL_INDICATION
+};
+
+#define LED_PATTERN_COUNT (sizeof(LED_PATTERN_TABLE) / sizeof(LED_PATTERN_TABLE[0]))
+
+#endif // LED_PATTERNS_H
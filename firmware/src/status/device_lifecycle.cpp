@@ -0,0 +1,374 @@
+#include "device_lifecycle.h"
+#include "../features/camera/camera.h"
+#include "../features/bluetooth/callbacks/ble_server_callback.h"
+#include "../system/clock/timing.h"
+#include "../system/cycles/cycle_manager.h"
+#include "../system/power_management/power_management.h"
+#include <freertos/FreeRTOS.h>
+
+// ===================================================================
+// ACTIONS
+// ===================================================================
+
+static void armSingle(int32_t arg) {
+    captureInterval = 0;
+    scanNextCapture = arg == PHOTO_SCAN_CODE;
+    bool pyramid = arg <= PHOTO_PYRAMID_SHOT && arg > PHOTO_PYRAMID_SHOT - IMAGE_PYRAMID_LEVELS;
+    pyramidNextLevel = pyramid ? PHOTO_PYRAMID_SHOT - arg : -1;
+    photoQualityRetakes = 0;
+    if (pyramidNextLevel >= 0) {
+        Serial.printf("Pyramid photo requested (level %d)\n", pyramidNextLevel);
+    } else {
+        Serial.println(scanNextCapture ? "Code scan requested" : "Single photo capture requested");
+    }
+}
+
+static void armInterval(int32_t arg) {
+    captureInterval = arg;
+    scanNextCapture = false;
+    pyramidNextLevel = -1;
+    photoQualityRetakes = 0;
+    lastCaptureTime = measureStart() - captureInterval;   // First shot right away
+    Serial.printf("Interval photo capture started: %d seconds\n", captureInterval / 1000);
+}
+
+static void stopAfterUpload(int32_t arg) {
+    (void)arg;
+    captureInterval = 0;
+    Serial.println("Photo capture stopped, finishing the current upload");
+}
+
+static bool hasInterval(int32_t arg) {
+    (void)arg;
+    return captureInterval > 0;
+}
+
+static void endPhotoSession(int32_t arg) {
+    (void)arg;
+    captureInterval = 0;
+    Serial.println("Photo session ended");
+}
+
+static void beginUpload(int32_t arg) {
+    (void)arg;
+    lastCaptureTime = measureStart();
+    sent_photo_bytes = 0;
+    sent_photo_frames = 0;
+#ifdef JPEG_HEADER_COMPACTION
+    // Headers again after a reconnect: the new client has no cache
+    if (fb) photoHeaderCompactor.plan(fb->buf, fb->len, bleConnectionCount);
+#endif
+#ifdef PHOTO_START_HEADER
+    // Hashed here, once: the upload cycle only sends it (after the plan, for the length)
+    photoStartPending = fb != nullptr;
+    if (photoStartPending) prepare_photo_start();
+#endif
+}
+
+static void endUpload(int32_t arg) {
+    (void)arg;
+    if (fb && sent_photo_bytes < photoHeaderCompactor.length(fb->len)) {
+        Serial.printf("Upload ended after %d of %d bytes\n", sent_photo_bytes, photoHeaderCompactor.length(fb->len));
+#ifdef JPEG_HEADER_COMPACTION
+        // A whole image cut short (a skip): the client may not have its
+        // header, so the next image carries one again
+        if (!photoHeaderCompactor.isCompact()) photoHeaderCompactor.reset();
+#endif
+    }
+    release_photo();
+    codePayloadLength = 0;
+    photoStartPending = false;
+    photoQualityScored = false;
+    sent_photo_bytes = 0;
+    sent_photo_frames = 0;
+}
+
+static void enterStreaming(int32_t arg) {
+    startVideoStreaming((uint8_t)arg);
+}
+
+static void exitStreaming(int32_t arg) {
+    (void)arg;
+    stopVideoStreaming();
+}
+
+static void notifyVideoStatus(int32_t arg) {
+    (void)arg;
+    updateVideoStatus();
+}
+
+static void enterSleep(int32_t arg) {
+    (void)arg;
+    prepareForSleep();
+}
+
+static void exitSleep(int32_t arg) {
+    (void)arg;
+    wakeFromSleep();
+}
+
+// ===================================================================
+// TABLES
+// ===================================================================
+
+static const hsm_state_t STATES[LIFECYCLE_STATE_COUNT] = {
+    // name         parent              entry           exit
+    {"BOOT",        HSM_NO_STATE,       nullptr,        nullptr},
+    {"RUNNING",     HSM_NO_STATE,       nullptr,        nullptr},
+    {"IDLE",        LIFECYCLE_RUNNING,  nullptr,        nullptr},
+    {"PHOTO",       LIFECYCLE_RUNNING,  nullptr,        endPhotoSession},
+    {"CAPTURING",   LIFECYCLE_PHOTO,    nullptr,        nullptr},
+    {"UPLOADING",   LIFECYCLE_PHOTO,    beginUpload,    endUpload},
+    {"STREAMING",   LIFECYCLE_RUNNING,  enterStreaming, exitStreaming},
+    {"SLEEPING",    LIFECYCLE_RUNNING,  enterSleep,     exitSleep},
+};
+
+// UP: ask the parent state (an event nobody handles is ignored)
+#define UP HSM_UNHANDLED_CELL
+
+static const hsm_transition_t TRANSITIONS[LIFECYCLE_STATE_COUNT][LIFECYCLE_EVENT_COUNT] = {
+    /* BOOT */ {
+        /* BOOT_DONE      */ hsmGo(LIFECYCLE_IDLE),
+        /* PHOTO_SINGLE   */ UP,
+        /* PHOTO_INTERVAL */ UP,
+        /* PHOTO_RESUME   */ UP,
+        /* PHOTO_STOP     */ UP,
+        /* PHOTO_CAPTURED */ UP,
+        /* UPLOAD_DONE    */ UP,
+        /* UPLOAD_SKIP    */ UP,
+        /* DISCONNECTED   */ UP,
+        /* VIDEO_START    */ UP,
+        /* VIDEO_STOP     */ UP,
+        /* SLEEP          */ UP,
+        /* WAKE           */ UP
+    },
+    /* RUNNING */ {
+        /* BOOT_DONE      */ UP,
+        /* PHOTO_SINGLE   */ UP,
+        /* PHOTO_INTERVAL */ UP,
+        /* PHOTO_RESUME   */ UP,
+        /* PHOTO_STOP     */ UP,
+        /* PHOTO_CAPTURED */ UP,
+        /* UPLOAD_DONE    */ UP,
+        /* UPLOAD_SKIP    */ UP,
+        /* DISCONNECTED   */ UP,
+        /* VIDEO_START    */ UP,
+        /* VIDEO_STOP     */ UP,
+        /* SLEEP          */ UP,
+        /* WAKE           */ UP
+    },
+    /* IDLE */ {
+        /* BOOT_DONE      */ UP,
+        /* PHOTO_SINGLE   */ hsmGo(LIFECYCLE_CAPTURING, armSingle),
+        /* PHOTO_INTERVAL */ hsmGo(LIFECYCLE_CAPTURING, armInterval),
+        /* PHOTO_RESUME   */ hsmChoose(hasInterval, LIFECYCLE_CAPTURING, HSM_NO_STATE),
+        /* PHOTO_STOP     */ UP,
+        /* PHOTO_CAPTURED */ UP,
+        /* UPLOAD_DONE    */ UP,
+        /* UPLOAD_SKIP    */ UP,
+        /* DISCONNECTED   */ UP,
+        /* VIDEO_START    */ hsmGo(LIFECYCLE_STREAMING),
+        /* VIDEO_STOP     */ UP,
+        /* SLEEP          */ hsmGo(LIFECYCLE_SLEEPING),
+        /* WAKE           */ UP
+    },
+    /* PHOTO */ {
+        /* BOOT_DONE      */ UP,
+        /* PHOTO_SINGLE   */ UP,
+        /* PHOTO_INTERVAL */ UP,
+        /* PHOTO_RESUME   */ UP,
+        /* PHOTO_STOP     */ hsmGo(LIFECYCLE_IDLE),
+        /* PHOTO_CAPTURED */ UP,
+        /* UPLOAD_DONE    */ UP,
+        /* UPLOAD_SKIP    */ UP,
+        /* DISCONNECTED   */ UP,
+        /* VIDEO_START    */ UP,
+        /* VIDEO_STOP     */ UP,
+        /* SLEEP          */ UP,
+        /* WAKE           */ UP
+    },
+    /* CAPTURING */ {
+        /* BOOT_DONE      */ UP,
+        /* PHOTO_SINGLE   */ hsmInternal(armSingle),
+        /* PHOTO_INTERVAL */ hsmInternal(armInterval),
+        /* PHOTO_RESUME   */ UP,
+        /* PHOTO_STOP     */ UP,
+        /* PHOTO_CAPTURED */ hsmGo(LIFECYCLE_UPLOADING),
+        /* UPLOAD_DONE    */ UP,
+        /* UPLOAD_SKIP    */ UP,
+        /* DISCONNECTED   */ UP,
+        /* VIDEO_START    */ hsmGo(LIFECYCLE_STREAMING),
+        /* VIDEO_STOP     */ UP,
+        /* SLEEP          */ UP,
+        /* WAKE           */ UP
+    },
+    // New requests wait for the upload to finish; video is refused
+    /* UPLOADING */ {
+        /* BOOT_DONE      */ UP,
+        /* PHOTO_SINGLE   */ UP,
+        /* PHOTO_INTERVAL */ UP,
+        /* PHOTO_RESUME   */ UP,
+        /* PHOTO_STOP     */ hsmInternal(stopAfterUpload),
+        /* PHOTO_CAPTURED */ UP,
+        /* UPLOAD_DONE    */ hsmChoose(hasInterval, LIFECYCLE_CAPTURING, LIFECYCLE_IDLE),
+        /* UPLOAD_SKIP    */ hsmChoose(hasInterval, LIFECYCLE_CAPTURING, LIFECYCLE_IDLE),
+        /* DISCONNECTED   */ hsmChoose(hasInterval, LIFECYCLE_CAPTURING, LIFECYCLE_IDLE),
+        /* VIDEO_START    */ UP,
+        /* VIDEO_STOP     */ UP,
+        /* SLEEP          */ UP,
+        /* WAKE           */ UP
+    },
+    // Photo requests are refused until the stream stops
+    /* STREAMING */ {
+        /* BOOT_DONE      */ UP,
+        /* PHOTO_SINGLE   */ UP,
+        /* PHOTO_INTERVAL */ UP,
+        /* PHOTO_RESUME   */ UP,
+        /* PHOTO_STOP     */ UP,
+        /* PHOTO_CAPTURED */ UP,
+        /* UPLOAD_DONE    */ UP,
+        /* UPLOAD_SKIP    */ UP,
+        /* DISCONNECTED   */ UP,
+        /* VIDEO_START    */ UP,
+        /* VIDEO_STOP     */ hsmGo(LIFECYCLE_IDLE, notifyVideoStatus),
+        /* SLEEP          */ UP,
+        /* WAKE           */ UP
+    },
+    /* SLEEPING */ {
+        /* BOOT_DONE      */ UP,
+        /* PHOTO_SINGLE   */ UP,
+        /* PHOTO_INTERVAL */ UP,
+        /* PHOTO_RESUME   */ UP,
+        /* PHOTO_STOP     */ UP,
+        /* PHOTO_CAPTURED */ UP,
+        /* UPLOAD_DONE    */ UP,
+        /* UPLOAD_SKIP    */ UP,
+        /* DISCONNECTED   */ UP,
+        /* VIDEO_START    */ UP,
+        /* VIDEO_STOP     */ UP,
+        /* SLEEP          */ UP,
+        /* WAKE           */ hsmGo(LIFECYCLE_IDLE)
+    },
+};
+
+#undef UP
+
+static const char* const EVENT_NAMES[LIFECYCLE_EVENT_COUNT] = {
+    "BOOT_DONE", "PHOTO_SINGLE", "PHOTO_INTERVAL", "PHOTO_RESUME", "PHOTO_STOP", "PHOTO_CAPTURED",
+    "UPLOAD_DONE", "UPLOAD_SKIP", "DISCONNECTED", "VIDEO_START", "VIDEO_STOP", "SLEEP", "WAKE",
+};
+
+// ===================================================================
+// LIFECYCLE STATE
+// ===================================================================
+
+static HierarchicalStateMachine<LIFECYCLE_STATE_COUNT, LIFECYCLE_EVENT_COUNT, LIFECYCLE_EVENT_QUEUE_SIZE>
+    machine(STATES, TRANSITIONS, LIFECYCLE_BOOT);
+
+// post() may be called from the BLE task and the loop task
+static portMUX_TYPE postMux = portMUX_INITIALIZER_UNLOCKED;
+
+static int lifecycleCycleId = -1;
+
+static void traceTransition(uint8_t from, uint8_t event, uint8_t to, bool handled) {
+    if (!handled) {
+        Serial.printf("Lifecycle: %s ignored in %s\n", EVENT_NAMES[event], machine.getStateName(from));
+    } else if (to != from) {
+        Serial.printf("Lifecycle: %s -> %s (%s)\n", machine.getStateName(from), machine.getStateName(to),
+                      EVENT_NAMES[event]);
+    }
+}
+
+namespace DeviceLifecycle {
+    void begin() {
+        if (!machine.validate()) {
+            Serial.println("Lifecycle: invalid transition table");
+        }
+        machine.setTrace(traceTransition);
+
+        if (lifecycleCycleId < 0) {
+            lifecycleCycleId = registerStateMachineCycle(
+                "Lifecycle",
+                []() {
+                    return machine.pending() > 0;
+                },
+                []() {
+                    machine.process();
+                },
+                CYCLE_PRIORITY_CRITICAL
+            );
+        }
+    }
+
+    int getCycleId() {
+        return lifecycleCycleId;
+    }
+
+    bool dispatch(lifecycle_event_t event, int32_t arg) {
+        return machine.dispatch(event, arg);
+    }
+
+    bool post(lifecycle_event_t event, int32_t arg) {
+        portENTER_CRITICAL(&postMux);
+        bool queued = machine.post(event, arg);
+        portEXIT_CRITICAL(&postMux);
+        if (!queued) {
+            Serial.printf("Lifecycle: queue full, dropped %s\n", getEventName(event));
+        }
+        return queued;
+    }
+
+    size_t process() {
+        return machine.process();
+    }
+
+    lifecycle_state_t getState() {
+        return (lifecycle_state_t)machine.getState();
+    }
+
+    bool isIn(lifecycle_state_t state) {
+        return machine.isIn(state);
+    }
+
+    bool isReady() {
+        return machine.isIn(LIFECYCLE_RUNNING);
+    }
+
+    const char* getStateName(lifecycle_state_t state) {
+        return machine.getStateName(state);
+    }
+
+    const char* getEventName(lifecycle_event_t event) {
+        return event < LIFECYCLE_EVENT_COUNT ? EVENT_NAMES[event] : "NONE";
+    }
+
+    lifecycle_state_t getTarget(lifecycle_state_t state, lifecycle_event_t event) {
+        const hsm_transition_t* t = machine.getTransition(state, event);
+        if (!t || t->kind == HSM_UNHANDLED || t->kind == HSM_IGNORED) {
+            return LIFECYCLE_STATE_COUNT;
+        }
+        return t->kind == HSM_INTERNAL ? state : (lifecycle_state_t)t->target;
+    }
+
+    bool validate() {
+        return machine.validate();
+    }
+
+    const hsm_stats_t* getStats() {
+        return machine.getStats();
+    }
+
+    void reset() {
+        machine.reset();
+    }
+
+    void printStatus() {
+        const hsm_stats_t* stats = machine.getStats();
+        Serial.println("=== Device Lifecycle ===");
+        Serial.printf("State: %s\n", machine.getStateName(machine.getState()));
+        Serial.printf("Events: %lu dispatched, %lu handled, %lu ignored, %lu dropped\n",
+                      (unsigned long)stats->dispatched, (unsigned long)stats->handled,
+                      (unsigned long)stats->ignored, (unsigned long)stats->dropped);
+        Serial.println("========================");
+    }
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <Arduino.h>
+#include "../hal/constants.h"
+#include "../system/state_machine/hsm.h"
+
+// ===================================================================
+// DEVICE LIFECYCLE
+// ===================================================================
+//
+// What the device is doing, as one hierarchical state machine (see
+// system/state_machine/hsm.h):
+//
+//   BOOT                       setup() running
+//   RUNNING                    setup() finished
+//     IDLE
+//     PHOTO                    A photo session
+//       CAPTURING                Waiting for the next shot
+//       UPLOADING                Sending fb to the client
+//     STREAMING                Video
+//     SLEEPING                 Light sleep (deep sleep ends the program)
+//
+// Capturing, uploading and streaming used to be separate flags that any
+// module could set; now only transitions change them, and combinations
+// such as streaming during an upload cannot be expressed. The camera
+// settings, upload buffers and video status follow from the entry and
+// exit actions. captureInterval stays plain data: 0 ends the session
+// after the current upload, otherwise the session goes back to CAPTURING.
+//
+// Control writes arrive on the BLE task and are post()ed; the Lifecycle
+// cycle runs them. The cycles themselves dispatch() directly.
+//
+
+typedef enum {
+    LIFECYCLE_BOOT,
+    LIFECYCLE_RUNNING,
+    LIFECYCLE_IDLE,
+    LIFECYCLE_PHOTO,
+    LIFECYCLE_CAPTURING,
+    LIFECYCLE_UPLOADING,
+    LIFECYCLE_STREAMING,
+    LIFECYCLE_SLEEPING,
+    LIFECYCLE_STATE_COUNT
+} lifecycle_state_t;
+
+typedef enum {
+    LIFECYCLE_EVENT_BOOT_DONE,          // setup() finished
+    LIFECYCLE_EVENT_PHOTO_SINGLE,       // Photo control: one shot (arg PHOTO_SCAN_CODE or PHOTO_PYRAMID_SHOT - level)
+    LIFECYCLE_EVENT_PHOTO_INTERVAL,     // Photo control: arg = interval in ms, first shot now
+    LIFECYCLE_EVENT_PHOTO_RESUME,       // Restored session (captureInterval and lastCaptureTime already set)
+    LIFECYCLE_EVENT_PHOTO_STOP,         // Photo control: stop (an upload in progress finishes)
+    LIFECYCLE_EVENT_PHOTO_CAPTURED,     // fb holds a new photo, or codePayload a scanned code
+    LIFECYCLE_EVENT_UPLOAD_DONE,        // fb / codePayload sent, or nothing to send
+    LIFECYCLE_EVENT_UPLOAD_SKIP,        // Photo control: drop the rest of fb (a near-duplicate)
+    LIFECYCLE_EVENT_DISCONNECTED,       // Client gone
+    LIFECYCLE_EVENT_VIDEO_START,        // arg = VIDEO_STREAM_START or VIDEO_STREAM_START_BLOCKS
+    LIFECYCLE_EVENT_VIDEO_STOP,
+    LIFECYCLE_EVENT_SLEEP,              // Idle long enough for light sleep
+    LIFECYCLE_EVENT_WAKE,
+    LIFECYCLE_EVENT_COUNT
+} lifecycle_event_t;
+
+namespace DeviceLifecycle {
+    /**
+     * Register the Lifecycle cycle that runs posted events
+     * Call after initializeCycleManager()
+     */
+    void begin();
+
+    /**
+     * Lifecycle cycle ID (-1 before begin())
+     */
+    int getCycleId();
+
+    /**
+     * Run an event now (loop task only)
+     * @param arg Event argument (interval for PHOTO_INTERVAL)
+     * @return true if it changed state or ran an action; false if ignored
+     */
+    bool dispatch(lifecycle_event_t event, int32_t arg = 0);
+
+    /**
+     * Queue an event for the Lifecycle cycle (any task)
+     * @return false if the queue is full
+     */
+    bool post(lifecycle_event_t event, int32_t arg = 0);
+
+    /**
+     * Run posted events now (the Lifecycle cycle does this every pass)
+     * @return Number of events run
+     */
+    size_t process();
+
+    lifecycle_state_t getState();
+
+    /**
+     * Whether the current state is state or inside it (isIn(LIFECYCLE_PHOTO)
+     * holds while capturing and uploading)
+     */
+    bool isIn(lifecycle_state_t state);
+
+    /**
+     * setup() has finished (any RUNNING state)
+     */
+    bool isReady();
+
+    const char* getStateName(lifecycle_state_t state);
+    const char* getEventName(lifecycle_event_t event);
+
+    /**
+     * Transition table target for event in state, after superstate fallback
+     * @return Target state, state itself for internal actions, or
+     *         LIFECYCLE_STATE_COUNT when ignored (guards are not evaluated)
+     */
+    lifecycle_state_t getTarget(lifecycle_state_t state, lifecycle_event_t event);
+
+    /**
+     * Check the tables (see HierarchicalStateMachine::validate())
+     */
+    bool validate();
+
+    const hsm_stats_t* getStats();
+
+    /**
+     * Back to BOOT without running actions, dropping queued events (host tests)
+     */
+    void reset();
+
+    void printStatus();
+}
@@ -3,9 +3,8 @@
 #include "../hal/xiao_esp32s3_constants.h"
 #include "../hal/led/led_manager.h"
 
-BLECharacteristic *deviceStatusCharacteristic = nullptr;
+ble_handle_t deviceStatusCharacteristic = BLE_HANDLE_NONE;
 uint8_t deviceStatus = DEVICE_STATUS_INITIALIZING;
-bool deviceReady = false;
 
 void updateDeviceStatus(uint8_t status) {
   deviceStatus = status;
@@ -14,19 +13,14 @@ void updateDeviceStatus(uint8_t status) {
   // Update LED pattern based on status
   setLedForDeviceStatus(status);
   
-  if (deviceStatusCharacteristic) {
-    deviceStatusCharacteristic->setValue(&deviceStatus, 1);
-    deviceStatusCharacteristic->notify();
+  if (deviceStatusCharacteristic != BLE_HANDLE_NONE) {
+    BleTransport::notify(deviceStatusCharacteristic, &deviceStatus, 1);
   }
 }
 
-void setupDeviceStatusService(BLEService *service) {
-  deviceStatusCharacteristic = service->createCharacteristic(
-      DEVICE_STATUS_UUID,
-      BLECharacteristic::PROPERTY_READ | BLECharacteristic::PROPERTY_NOTIFY);
-  
-  BLE2902 *ccc = new BLE2902();
-  ccc->setNotifications(true);
-  deviceStatusCharacteristic->addDescriptor(ccc);
-  deviceStatusCharacteristic->setValue(&deviceStatus, 1);
+void setupDeviceStatusService(ble_handle_t service) {
+  deviceStatusCharacteristic = BleTransport::createCharacteristic(
+      service, DEVICE_STATUS_UUID,
+      BLE_PROPERTY_READ | BLE_PROPERTY_NOTIFY);
+  BleTransport::setValue(deviceStatusCharacteristic, &deviceStatus, 1);
 } 
\ No newline at end of file
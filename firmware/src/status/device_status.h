@@ -1,19 +1,16 @@
 #pragma once
 
 #include <Arduino.h>
-#include <BLEDevice.h>
-#include <BLEUtils.h>
-#include <BLEServer.h>
-#include <BLE2902.h>
+#include "../features/bluetooth/ble_transport.h"
 #include "../hal/constants.h"
 #include "../hal/xiao_esp32s3_constants.h"
 
-extern BLECharacteristic *deviceStatusCharacteristic;
+extern ble_handle_t deviceStatusCharacteristic;
 extern uint8_t deviceStatus;
-extern bool deviceReady;
+// Readiness is DeviceLifecycle::isReady() (device_lifecycle.h)
 
 // Updates and notifies the current device status. Call when status changes.
 void updateDeviceStatus(uint8_t status);
 
 // Initialize device status service. Call from BLE configuration.
-void setupDeviceStatusService(BLEService *service); 
\ No newline at end of file
+void setupDeviceStatusService(ble_handle_t service); 
\ No newline at end of file
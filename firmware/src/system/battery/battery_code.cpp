@@ -2,37 +2,30 @@
 #include "../../hal/xiao_esp32s3_constants.h"
 #include "../clock/timing.h"
 
-BLECharacteristic *batteryLevelCharacteristic = nullptr;
+ble_handle_t batteryLevelCharacteristic = BLE_HANDLE_NONE;
 uint8_t batteryLevel = 100;
 unsigned long lastBatteryUpdate = 0;
 bool batteryDetected = false;
 bool isCharging = false;
 
 // Battery connection monitoring variables
-float batteryVoltageHistory[BATTERY_STABILITY_SAMPLES] = {0};
-int voltageHistoryIndex = 0;
+RingBuffer<float, BATTERY_VOLTAGE_HISTORY_SIZE> batteryVoltageHistory;
 int unstableReadingCount = 0;
 float lastStableVoltage = 0.0;
 bool connectionStable = true;
 unsigned long lastVoltageChangeTime = 0;
 
-void setupBatteryService(BLEServer *server) {
-    BLEService *batteryService = server->createService(BATTERY_SERVICE_UUID);
-    batteryLevelCharacteristic = batteryService->createCharacteristic(
-        BATTERY_LEVEL_CHAR_UUID,
-        BLECharacteristic::PROPERTY_READ | BLECharacteristic::PROPERTY_NOTIFY);
+void setupBatteryService() {
+    ble_handle_t batteryService = BleTransport::createService(BATTERY_SERVICE_UUID);
+    batteryLevelCharacteristic = BleTransport::createCharacteristic(
+        batteryService, BATTERY_LEVEL_CHAR_UUID,
+        BLE_PROPERTY_READ | BLE_PROPERTY_NOTIFY);
+    BleTransport::setValue(batteryLevelCharacteristic, &batteryLevel, 1);
 
-    BLE2902 *ccc = new BLE2902();
-    ccc->setNotifications(true);
-    batteryLevelCharacteristic->addDescriptor(ccc);
-    batteryLevelCharacteristic->setValue(&batteryLevel, 1);
-
-    batteryService->start();
+    // Started with the other services (startBLEServices())
     
     // Initialize voltage history
-    for (int i = 0; i < BATTERY_STABILITY_SAMPLES; i++) {
-        batteryVoltageHistory[i] = 0.0;
-    }
+    batteryVoltageHistory.clear();
 }
 
 bool detectRapidVoltageChange(float currentVoltage) {
@@ -58,9 +51,8 @@ bool detectRapidVoltageChange(float currentVoltage) {
 }
 
 bool analyzeBatteryConnectionStability(float currentVoltage) {
-    // Store voltage in circular buffer
-    batteryVoltageHistory[voltageHistoryIndex] = currentVoltage;
-    voltageHistoryIndex = (voltageHistoryIndex + 1) % BATTERY_STABILITY_SAMPLES;
+    // Store voltage in the history (oldest reading dropped when full)
+    batteryVoltageHistory.pushOverwrite(currentVoltage);
     
     // Check for rapid voltage changes
     bool rapidChange = detectRapidVoltageChange(currentVoltage);
@@ -69,11 +61,14 @@ bool analyzeBatteryConnectionStability(float currentVoltage) {
     float minVoltage = 4.3, maxVoltage = 0.0;
     int validSamples = 0;
     
-    for (int i = 0; i < BATTERY_STABILITY_SAMPLES; i++) {
-        if (batteryVoltageHistory[i] > 0.0) {
+    size_t count = batteryVoltageHistory.size();
+    size_t first = count > BATTERY_STABILITY_SAMPLES ? count - BATTERY_STABILITY_SAMPLES : 0;
+    for (size_t i = first; i < count; i++) {
+        float voltage = batteryVoltageHistory.at(i);
+        if (voltage > 0.0) {
             validSamples++;
-            if (batteryVoltageHistory[i] < minVoltage) minVoltage = batteryVoltageHistory[i];
-            if (batteryVoltageHistory[i] > maxVoltage) maxVoltage = batteryVoltageHistory[i];
+            if (voltage < minVoltage) minVoltage = voltage;
+            if (voltage > maxVoltage) maxVoltage = voltage;
         }
     }
     
@@ -224,7 +219,6 @@ bool checkBatteryPresence() {
         
         // Ensure battery level is within bounds
         if (batteryLevel > 100) batteryLevel = 100;
-        if (batteryLevel < 0) batteryLevel = 0;
         
         Serial.printf("Calculated battery level: %d%% (%.2fV) - Connection: %s\n", 
                      batteryLevel, batteryVoltage, getBatteryConnectionStatus());
@@ -242,7 +236,7 @@ bool checkBatteryPresence() {
 }
 
 void updateBatteryLevel() {
-    if (!batteryLevelCharacteristic) return;
+    if (batteryLevelCharacteristic == BLE_HANDLE_NONE) return;
     
     // Check battery presence and update level
     batteryDetected = checkBatteryPresence();
@@ -250,8 +244,7 @@ void updateBatteryLevel() {
     // Check charging status
     isCharging = checkChargingStatus();
     
-    batteryLevelCharacteristic->setValue(&batteryLevel, 1);
-    batteryLevelCharacteristic->notify();
+    BleTransport::notify(batteryLevelCharacteristic, &batteryLevel, 1);
     lastBatteryUpdate = measureStart();
     
     Serial.printf("Battery status: %s | Level: %d%% | Charging: %s\n", 
@@ -1,33 +1,34 @@
 #pragma once
 
 #include <Arduino.h>
-#include <BLEDevice.h>
-#include <BLEUtils.h>
-#include <BLEServer.h>
-#include <BLE2902.h>
+#include "../../features/bluetooth/ble_transport.h"
 #include "../../hal/constants.h"
 #include "../../hal/xiao_esp32s3_constants.h"
+#include "../memory/ring_buffer.h"
 
 // Battery Level Service UUIDs
-#define BATTERY_SERVICE_UUID (uint16_t)0x180F
-#define BATTERY_LEVEL_CHAR_UUID (uint16_t)0x2A19
+#define BATTERY_SERVICE_UUID "180F"
+#define BATTERY_LEVEL_CHAR_UUID "2A19"
 
-extern BLECharacteristic *batteryLevelCharacteristic;
+extern ble_handle_t batteryLevelCharacteristic;
 extern uint8_t batteryLevel;
 extern unsigned long lastBatteryUpdate;
 extern bool batteryDetected;
 extern bool isCharging;
 
+// Recent voltage readings; stability looks at the last BATTERY_STABILITY_SAMPLES
+#define BATTERY_VOLTAGE_HISTORY_SIZE 8
+static_assert(BATTERY_VOLTAGE_HISTORY_SIZE >= BATTERY_STABILITY_SAMPLES, "Voltage history too short");
+
 // Battery connection monitoring variables
-extern float batteryVoltageHistory[BATTERY_STABILITY_SAMPLES];
-extern int voltageHistoryIndex;
+extern RingBuffer<float, BATTERY_VOLTAGE_HISTORY_SIZE> batteryVoltageHistory;
 extern int unstableReadingCount;
 extern float lastStableVoltage;
 extern bool connectionStable;
 extern unsigned long lastVoltageChangeTime;
 
 // Initializes the battery service. Call from BLE configuration.
-void setupBatteryService(BLEServer *server);
+void setupBatteryService();
 
 // Updates and notifies the current battery level. Call periodically.
 void updateBatteryLevel();
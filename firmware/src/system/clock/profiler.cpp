@@ -0,0 +1,141 @@
+#include "profiler.h"
+
+#if !defined(__XTENSA__) && (defined(__x86_64__) || defined(__i386__))
+#include <chrono>
+#endif
+
+// ===================================================================
+// PROFILER STATE
+// ===================================================================
+
+static profile_site_t* siteList = nullptr;
+static size_t siteCount = 0;
+static uint32_t ticksPerUs = 0;
+
+static uint64_t ticksToNs(uint64_t ticks) {
+    return ticks * 1000ULL / ticksPerUs;
+}
+
+/**
+ * Counter ticks per microsecond
+ */
+static uint32_t measureTickRate() {
+#if defined(__XTENSA__)
+    // CCOUNT runs at the CPU clock
+    return getCpuFrequencyMhz();
+#elif defined(__x86_64__) || defined(__i386__)
+    // rdtsc runs at a constant rate; time it against steady_clock
+    typedef std::chrono::steady_clock clock;
+    clock::time_point start = clock::now();
+    uint64_t startTicks = __rdtsc();
+    while (clock::now() - start < std::chrono::milliseconds(10)) {
+    }
+    uint64_t ticks = __rdtsc() - startTicks;
+    uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count();
+    uint32_t rate = (uint32_t)((ticks * 1000ULL + ns / 2) / ns);
+    return rate > 0 ? rate : 1;
+#else
+    // steady_clock nanoseconds
+    return 1000;
+#endif
+}
+
+// ===================================================================
+// PROFILER
+// ===================================================================
+
+namespace Profiler {
+    void begin() {
+        if (ticksPerUs == 0) {
+            ticksPerUs = measureTickRate();
+        }
+    }
+
+    void registerSite(profile_site_t* site) {
+        if (site->registered) return;
+        begin();
+        site->registered = true;
+        site->next = siteList;
+        siteList = site;
+        siteCount++;
+    }
+
+    void onCpuFrequencyChange() {
+#if defined(__XTENSA__)
+        setTickRate(measureTickRate());
+#endif
+    }
+
+    void setTickRate(uint32_t ticks_per_us) {
+        if (ticks_per_us == 0 || ticks_per_us == ticksPerUs) return;
+
+        // Ticks so far were taken at the old rate
+        if (ticksPerUs != 0) {
+            for (profile_site_t* site = siteList; site; site = site->next) {
+                site->folded_ns += ticksToNs(site->total_ticks);
+                uint32_t max_ns = (uint32_t)ticksToNs(site->max_ticks);
+                if (max_ns > site->folded_max_ns) site->folded_max_ns = max_ns;
+                site->total_ticks = 0;
+                site->max_ticks = 0;
+            }
+        }
+        ticksPerUs = ticks_per_us;
+    }
+
+    uint32_t getTickRate() {
+        begin();
+        return ticksPerUs;
+    }
+
+    float ticksToUs(uint32_t ticks) {
+        begin();
+        return (float)ticks / ticksPerUs;
+    }
+
+    uint64_t totalNs(const profile_site_t* site) {
+        begin();
+        return site->folded_ns + ticksToNs(site->total_ticks);
+    }
+
+    uint32_t maxNs(const profile_site_t* site) {
+        begin();
+        uint32_t max_ns = (uint32_t)ticksToNs(site->max_ticks);
+        return max_ns > site->folded_max_ns ? max_ns : site->folded_max_ns;
+    }
+
+    const profile_site_t* findSite(const char* name) {
+        for (profile_site_t* site = siteList; site; site = site->next) {
+            if (strcmp(site->name, name) == 0) return site;
+        }
+        return nullptr;
+    }
+
+    size_t getSiteCount() {
+        return siteCount;
+    }
+
+    void reset() {
+        for (profile_site_t* site = siteList; site; site = site->next) {
+            site->count = 0;
+            site->total_ticks = 0;
+            site->max_ticks = 0;
+            site->folded_ns = 0;
+            site->folded_max_ns = 0;
+        }
+    }
+
+    void printReport(bool reset_after) {
+        Serial.println("\n=== Profiler ===");
+        Serial.printf("Tick rate: %lu per us, %u sites\n", (unsigned long)getTickRate(), (unsigned)siteCount);
+        for (profile_site_t* site = siteList; site; site = site->next) {
+            if (site->count == 0) continue;
+            uint64_t total_ns = totalNs(site);
+            Serial.printf("  %-20s %8lu x  total %10.3f ms  avg %9.3f us  max %9.3f us\n",
+                          site->name, (unsigned long)site->count, total_ns / 1000000.0,
+                          total_ns / 1000.0 / site->count, maxNs(site) / 1000.0);
+        }
+        if (reset_after) {
+            reset();
+        }
+    }
+}
@@ -0,0 +1,178 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+#include "../../hal/constants.h"
+
+#if !defined(__XTENSA__)
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+#endif
+
+// ===================================================================
+// PROFILER
+// ===================================================================
+//
+// Scoped timers on the CPU cycle counter, for code that runs in well
+// under a millisecond (cycle bodies, audio stages, BLE sends):
+//
+//   void encodeFrame() {
+//       PROFILE_SCOPE("opus_encode");
+//       ...
+//   }
+//
+// Each PROFILE_SCOPE owns a static profile_site_t, constant-initialized
+// at compile time (no guard, no lookup). Entering a scope reads the
+// counter; leaving it reads it again and adds the difference to the
+// site: a handful of instructions. A site links itself into the report
+// the first time it is left.
+//
+// Ticks are converted with the tick rate in force when they were taken.
+// On the device the counter is Xtensa CCOUNT, which runs at the CPU
+// clock; setPowerMode() calls Profiler::onCpuFrequencyChange() so ticks
+// from before a frequency change are folded into time at the old rate.
+// On the host the counter is rdtsc (calibrated against steady_clock) or
+// steady_clock itself.
+//
+// CCOUNT is per core and 32 bits (17.9 s at 240 MHz): scopes are for
+// short code on one task. A site's counters are not atomic, so each site
+// is entered from one task only.
+//
+
+/**
+ * Read the cycle counter (wraps modulo 2^32; take differences)
+ */
+static inline __attribute__((always_inline)) uint32_t profilerTicks() {
+#if defined(__XTENSA__)
+    uint32_t ccount;
+    __asm__ __volatile__("rsr %0, ccount" : "=a"(ccount));
+    return ccount;
+#elif defined(__x86_64__) || defined(__i386__)
+    return (uint32_t)__rdtsc();
+#else
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/**
+ * Accumulator for one profiled site
+ */
+struct profile_site_t {
+    const char* name;
+    uint32_t count;             // Times the scope was left
+    uint32_t max_ticks;         // Longest pass at the current tick rate
+    uint64_t total_ticks;       // Ticks at the current tick rate
+    uint64_t folded_ns;         // Time taken at earlier tick rates
+    uint32_t folded_max_ns;     // Longest pass at earlier tick rates
+    bool registered;
+    profile_site_t* next;
+
+    constexpr profile_site_t(const char* site_name)
+        : name(site_name), count(0), max_ticks(0), total_ticks(0),
+          folded_ns(0), folded_max_ns(0), registered(false), next(nullptr) {}
+};
+
+namespace Profiler {
+    /**
+     * Link a site into the report (done on its first record)
+     */
+    void registerSite(profile_site_t* site);
+
+    /**
+     * Add one pass of the given length to a site
+     */
+    static inline __attribute__((always_inline)) void record(profile_site_t* site, uint32_t ticks) {
+        site->count++;
+        site->total_ticks += ticks;
+        if (ticks > site->max_ticks) site->max_ticks = ticks;
+        if (__builtin_expect(!site->registered, 0)) registerSite(site);
+    }
+
+    /**
+     * Calibrate the tick rate (device: current CPU frequency; host: rdtsc
+     * against steady_clock). Called on the first registerSite().
+     */
+    void begin();
+
+    /**
+     * Re-read the CPU frequency after setCpuFrequencyMhz()
+     */
+    void onCpuFrequencyChange();
+
+    /**
+     * Fold every site's ticks into time and switch to a new tick rate
+     * @param ticks_per_us Counter ticks per microsecond
+     */
+    void setTickRate(uint32_t ticks_per_us);
+    uint32_t getTickRate();
+
+    /**
+     * Convert a tick count at the current rate to microseconds
+     */
+    float ticksToUs(uint32_t ticks);
+
+    /**
+     * Totals of a site in nanoseconds
+     */
+    uint64_t totalNs(const profile_site_t* site);
+    uint32_t maxNs(const profile_site_t* site);
+
+    /**
+     * Find a registered site by name (nullptr if it has not run yet)
+     */
+    const profile_site_t* findSite(const char* name);
+    size_t getSiteCount();
+
+    /**
+     * Clear every site's counters (sites stay registered)
+     */
+    void reset();
+
+    /**
+     * Print count, total, average and max per site
+     * @param reset_after Clear the counters after printing
+     */
+    void printReport(bool reset_after = false);
+}
+
+/**
+ * Times its enclosing scope into a site
+ */
+class ProfileScope {
+public:
+    explicit __attribute__((always_inline)) ProfileScope(profile_site_t* site)
+        : site(site), start(profilerTicks()) {}
+    __attribute__((always_inline)) ~ProfileScope() {
+        Profiler::record(site, profilerTicks() - start);
+    }
+
+private:
+    ProfileScope(const ProfileScope&);
+    ProfileScope& operator=(const ProfileScope&);
+
+    profile_site_t* site;
+    uint32_t start;
+};
+
+// ===================================================================
+// PROFILING MACROS
+// ===================================================================
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef PROFILER_ENABLED
+#define PROFILE_SCOPE(name) \
+    static profile_site_t PROFILE_CONCAT(profile_site_, __LINE__)(name); \
+    ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)(&PROFILE_CONCAT(profile_site_, __LINE__))
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+#else
+#define PROFILE_SCOPE(name) do {} while (0)
+#define PROFILE_FUNCTION() do {} while (0)
+#endif
+
+#endif // PROFILER_H
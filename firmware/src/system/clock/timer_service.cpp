@@ -0,0 +1,268 @@
+#include "timer_service.h"
+#include "timing.h"
+
+// ===================================================================
+// TIMER SERVICE STATE
+// ===================================================================
+
+typedef struct {
+    const char* name;
+    timer_callback_t callback;
+    void* arg;
+    uint64_t deadline_us;       // Next firing (monotonicMicros())
+    uint64_t period_us;         // Delay (one-shot) or period (periodic)
+    uint16_t generation;        // Bumped on release; part of the handle
+    int8_t heap_index;          // Position in the heap, -1 if not armed
+    uint8_t kind;               // timer_kind_t
+    bool used;
+    bool fired;                 // Fired since the last consume()
+    uint32_t fire_count;
+} service_timer_t;
+
+static service_timer_t timers[MAX_SERVICE_TIMERS];
+static uint8_t heap[MAX_SERVICE_TIMERS];       // Slot indices, earliest deadline first
+static size_t heapSize = 0;
+static size_t timerCount = 0;
+
+// Handle: generation in the high half, slot + 1 in the low half (0 is never valid)
+static timer_handle_t makeHandle(size_t slot) {
+    return ((timer_handle_t)timers[slot].generation << 16) | (timer_handle_t)(slot + 1);
+}
+
+static service_timer_t* lookup(timer_handle_t handle) {
+    size_t slot = (handle & 0xFFFF) - 1;
+    if (handle == TIMER_HANDLE_NONE || slot >= MAX_SERVICE_TIMERS) {
+        return nullptr;
+    }
+    service_timer_t* timer = &timers[slot];
+    if (!timer->used || timer->generation != (handle >> 16)) {
+        return nullptr;
+    }
+    return timer;
+}
+
+// ===================================================================
+// HEAP
+// ===================================================================
+
+static bool earlier(size_t a, size_t b) {
+    return timers[heap[a]].deadline_us < timers[heap[b]].deadline_us;
+}
+
+static void swapEntries(size_t a, size_t b) {
+    uint8_t slot = heap[a];
+    heap[a] = heap[b];
+    heap[b] = slot;
+    timers[heap[a]].heap_index = (int8_t)a;
+    timers[heap[b]].heap_index = (int8_t)b;
+}
+
+static void siftUp(size_t index) {
+    while (index > 0) {
+        size_t parent = (index - 1) / 2;
+        if (!earlier(index, parent)) break;
+        swapEntries(index, parent);
+        index = parent;
+    }
+}
+
+static void siftDown(size_t index) {
+    while (true) {
+        size_t left = 2 * index + 1;
+        size_t right = left + 1;
+        size_t smallest = index;
+        if (left < heapSize && earlier(left, smallest)) smallest = left;
+        if (right < heapSize && earlier(right, smallest)) smallest = right;
+        if (smallest == index) break;
+        swapEntries(index, smallest);
+        index = smallest;
+    }
+}
+
+static void heapRemove(service_timer_t* timer) {
+    if (timer->heap_index < 0) {
+        return;
+    }
+    size_t index = timer->heap_index;
+    timer->heap_index = -1;
+    heapSize--;
+    if (index == heapSize) {
+        return;
+    }
+    heap[index] = heap[heapSize];
+    timers[heap[index]].heap_index = (int8_t)index;
+    siftUp(index);
+    siftDown(timers[heap[index]].heap_index);
+}
+
+static void arm(service_timer_t* timer, uint64_t deadline_us) {
+    heapRemove(timer);
+    timer->deadline_us = deadline_us;
+    size_t index = heapSize++;
+    heap[index] = (uint8_t)(timer - timers);
+    timer->heap_index = (int8_t)index;
+    siftUp(index);
+}
+
+static timer_handle_t createTimer(const char* name, timer_kind_t kind, uint64_t period_us, uint64_t deadline_us,
+                                  timer_callback_t callback, void* arg) {
+    for (size_t slot = 0; slot < MAX_SERVICE_TIMERS; slot++) {
+        service_timer_t* timer = &timers[slot];
+        if (timer->used) continue;
+
+        timer->name = name;
+        timer->callback = callback;
+        timer->arg = arg;
+        timer->period_us = period_us;
+        timer->kind = kind;
+        timer->used = true;
+        timer->fired = false;
+        timer->fire_count = 0;
+        timer->heap_index = -1;
+        if (timer->generation == 0) timer->generation = 1;
+        timerCount++;
+
+        arm(timer, deadline_us);
+        return makeHandle(slot);
+    }
+
+    Serial.printf("Timer service full (%d), cannot create '%s'\n", MAX_SERVICE_TIMERS, name ? name : "?");
+    return TIMER_HANDLE_NONE;
+}
+
+// ===================================================================
+// TIMER SERVICE
+// ===================================================================
+
+namespace TimerService {
+    timer_handle_t createOneShot(const char* name, uint32_t delay_ms, timer_callback_t callback, void* arg) {
+        uint64_t delay_us = (uint64_t)delay_ms * 1000ULL;
+        return createTimer(name, TIMER_KIND_ONE_SHOT, delay_us, monotonicMicros() + delay_us, callback, arg);
+    }
+
+    timer_handle_t createPeriodic(const char* name, uint32_t period_ms, timer_callback_t callback, void* arg) {
+        if (period_ms == 0) {
+            return TIMER_HANDLE_NONE;
+        }
+        uint64_t period_us = (uint64_t)period_ms * 1000ULL;
+        return createTimer(name, TIMER_KIND_PERIODIC, period_us, monotonicMicros() + period_us, callback, arg);
+    }
+
+    timer_handle_t createDeadline(const char* name, uint64_t deadline_us, timer_callback_t callback, void* arg) {
+        return createTimer(name, TIMER_KIND_DEADLINE, 0, deadline_us, callback, arg);
+    }
+
+    void release(timer_handle_t* handle) {
+        service_timer_t* timer = handle ? lookup(*handle) : nullptr;
+        if (timer) {
+            heapRemove(timer);
+            timer->used = false;
+            timer->generation = timer->generation == 0xFFFF ? 1 : timer->generation + 1;
+            timerCount--;
+        }
+        if (handle) {
+            *handle = TIMER_HANDLE_NONE;
+        }
+    }
+
+    bool consume(timer_handle_t handle) {
+        service_timer_t* timer = lookup(handle);
+        if (!timer || !timer->fired) {
+            return false;
+        }
+        timer->fired = false;
+        return true;
+    }
+
+    bool restart(timer_handle_t handle, uint64_t deadline_us) {
+        service_timer_t* timer = lookup(handle);
+        if (!timer) {
+            return false;
+        }
+        timer->fired = false;
+        arm(timer, timer->kind == TIMER_KIND_DEADLINE ? deadline_us : monotonicMicros() + timer->period_us);
+        return true;
+    }
+
+    bool cancel(timer_handle_t handle) {
+        service_timer_t* timer = lookup(handle);
+        if (!timer) {
+            return false;
+        }
+        heapRemove(timer);
+        timer->fired = false;
+        return true;
+    }
+
+    bool isArmed(timer_handle_t handle) {
+        service_timer_t* timer = lookup(handle);
+        return timer && timer->heap_index >= 0;
+    }
+
+    uint64_t remainingUs(timer_handle_t handle) {
+        service_timer_t* timer = lookup(handle);
+        if (!timer || timer->heap_index < 0) {
+            return 0;
+        }
+        uint64_t now_us = monotonicMicros();
+        return timer->deadline_us > now_us ? timer->deadline_us - now_us : 0;
+    }
+
+    void update() {
+        if (heapSize == 0) {
+            return;
+        }
+        uint64_t now_us = monotonicMicros();
+
+        while (heapSize > 0 && timers[heap[0]].deadline_us <= now_us) {
+            service_timer_t* timer = &timers[heap[0]];
+
+            if (timer->kind == TIMER_KIND_PERIODIC) {
+                // Keep the phase; periods missed while the loop was busy fire once
+                uint64_t next_us = timer->deadline_us + timer->period_us;
+                if (next_us <= now_us) {
+                    next_us += ((now_us - next_us) / timer->period_us + 1) * timer->period_us;
+                }
+                timer->deadline_us = next_us;
+                siftDown(0);
+            } else {
+                heapRemove(timer);
+            }
+
+            timer->fired = true;
+            timer->fire_count++;
+            if (timer->callback) {
+                // The callback may release or restart its own timer
+                timer->callback(timer->arg);
+            }
+        }
+    }
+
+    uint64_t nextDeadlineUs() {
+        return heapSize > 0 ? timers[heap[0]].deadline_us : UINT64_MAX;
+    }
+
+    size_t getTimerCount() {
+        return timerCount;
+    }
+
+    void printStats() {
+        static const char* kindNames[] = {"one-shot", "periodic", "deadline"};
+        uint64_t now_us = monotonicMicros();
+
+        Serial.println("\n=== Timer Service ===");
+        Serial.printf("Timers: %u of %d, %u armed\n", (unsigned)timerCount, MAX_SERVICE_TIMERS, (unsigned)heapSize);
+        for (size_t slot = 0; slot < MAX_SERVICE_TIMERS; slot++) {
+            const service_timer_t* timer = &timers[slot];
+            if (!timer->used) continue;
+            if (timer->heap_index >= 0) {
+                uint64_t due_us = timer->deadline_us > now_us ? timer->deadline_us - now_us : 0;
+                Serial.printf("  %s: %s, fired %lu, next in %.1f ms\n", timer->name ? timer->name : "?",
+                              kindNames[timer->kind], (unsigned long)timer->fire_count, due_us / 1000.0);
+            } else {
+                Serial.printf("  %s: %s, fired %lu, idle\n", timer->name ? timer->name : "?",
+                              kindNames[timer->kind], (unsigned long)timer->fire_count);
+            }
+        }
+    }
+}
@@ -0,0 +1,133 @@
+#ifndef TIMER_SERVICE_H
+#define TIMER_SERVICE_H
+
+#include <Arduino.h>
+
+// ===================================================================
+// TIMER SERVICE
+// ===================================================================
+//
+// Software timers with explicit handles, on the 64-bit monotonic clock
+// (timing.h). All armed timers sit in one binary min-heap ordered by
+// deadline, so TimerService::update() reads the clock once per loop pass
+// and only touches the heap when the earliest timer is due.
+//
+//   - One-shot: fires once, delay_ms after it was (re)started
+//   - Periodic: fires every period_ms, phase-locked to its start
+//   - Deadline: fires once at an absolute monotonicMicros() time
+//
+// A timer either runs a callback from update() or is polled with
+// consume(), which costs no clock read: a log throttle is
+//
+//   static timer_handle_t logTimer = TimerService::createPeriodic("log", 5000);
+//   if (TimerService::consume(logTimer)) { ... }
+//
+// Loop task only: timers are created, polled and serviced from loop().
+//
+
+typedef uint32_t timer_handle_t;
+typedef void (*timer_callback_t)(void* arg);
+
+#define TIMER_HANDLE_NONE 0
+
+// Maximum number of timers that can exist at once
+#define MAX_SERVICE_TIMERS 24
+
+typedef enum {
+    TIMER_KIND_ONE_SHOT,
+    TIMER_KIND_PERIODIC,
+    TIMER_KIND_DEADLINE
+} timer_kind_t;
+
+namespace TimerService {
+    /**
+     * Create and start a one-shot timer
+     * @param name Timer name for debugging
+     * @param delay_ms Delay until it fires
+     * @param callback Called from update() when it fires (optional)
+     * @param arg Passed to the callback
+     * @return Handle, or TIMER_HANDLE_NONE if all timers are in use
+     */
+    timer_handle_t createOneShot(const char* name, uint32_t delay_ms,
+                                 timer_callback_t callback = nullptr, void* arg = nullptr);
+
+    /**
+     * Create and start a periodic timer
+     * @param name Timer name for debugging
+     * @param period_ms Period (> 0)
+     * @param callback Called from update() on every period (optional)
+     * @param arg Passed to the callback
+     * @return Handle, or TIMER_HANDLE_NONE if all timers are in use
+     */
+    timer_handle_t createPeriodic(const char* name, uint32_t period_ms,
+                                  timer_callback_t callback = nullptr, void* arg = nullptr);
+
+    /**
+     * Create and start a timer for an absolute time
+     * @param name Timer name for debugging
+     * @param deadline_us monotonicMicros() time to fire at
+     * @param callback Called from update() when it fires (optional)
+     * @param arg Passed to the callback
+     * @return Handle, or TIMER_HANDLE_NONE if all timers are in use
+     */
+    timer_handle_t createDeadline(const char* name, uint64_t deadline_us,
+                                  timer_callback_t callback = nullptr, void* arg = nullptr);
+
+    /**
+     * Free a timer; the handle is set to TIMER_HANDLE_NONE. Stale handles
+     * are rejected by every call, so a freed slot can be reused safely.
+     */
+    void release(timer_handle_t* handle);
+
+    /**
+     * Check whether the timer fired since the last call, and clear it
+     * @return true once per firing (periods missed in between count once)
+     */
+    bool consume(timer_handle_t handle);
+
+    /**
+     * Restart from now: one-shot and periodic timers with their delay or
+     * period, deadline timers at a new deadline
+     * @param deadline_us New deadline (deadline timers only)
+     * @return false for an invalid handle
+     */
+    bool restart(timer_handle_t handle, uint64_t deadline_us = 0);
+
+    /**
+     * Stop a timer without freeing it (restart() arms it again)
+     * @return false for an invalid handle
+     */
+    bool cancel(timer_handle_t handle);
+
+    /**
+     * Check whether a timer is armed
+     */
+    bool isArmed(timer_handle_t handle);
+
+    /**
+     * Time until the timer fires (0 if due or not armed)
+     */
+    uint64_t remainingUs(timer_handle_t handle);
+
+    /**
+     * Fire every due timer (call from the main loop)
+     */
+    void update();
+
+    /**
+     * Earliest armed deadline (UINT64_MAX if none is armed)
+     */
+    uint64_t nextDeadlineUs();
+
+    /**
+     * Number of timers in use
+     */
+    size_t getTimerCount();
+
+    /**
+     * Print every timer with its state and next deadline
+     */
+    void printStats();
+}
+
+#endif // TIMER_SERVICE_H
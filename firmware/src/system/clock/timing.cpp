@@ -1,46 +1,63 @@
 #include "timing.h"
+#include <esp_timer.h>
+
+// ===================================================================
+// MONOTONIC CLOCK IMPLEMENTATION
+// ===================================================================
+
+uint64_t monotonicMicros() {
+    return (uint64_t)esp_timer_get_time();
+}
+
+uint64_t monotonicMillis() {
+    return monotonicMicros() / 1000ULL;
+}
+
+uint64_t elapsedMicros(uint64_t start_us) {
+    uint64_t now = monotonicMicros();
+    return now > start_us ? now - start_us : 0;
+}
+
+bool hasTimedOutUs(uint64_t start_us, uint64_t timeout_us) {
+    return elapsedMicros(start_us) >= timeout_us;
+}
+
+bool deadlineReached(uint64_t deadline_us) {
+    return monotonicMicros() >= deadline_us;
+}
+
+uint64_t deadlineAfterMs(uint32_t delay_ms) {
+    return monotonicMicros() + (uint64_t)delay_ms * 1000ULL;
+}
 
 // ===================================================================
 // TIMING UTILITIES IMPLEMENTATION
 // ===================================================================
 
+// Differences in 32 bits, as millis()/micros() count
+static inline uint32_t elapsed32(unsigned long now, unsigned long start) {
+    return (uint32_t)(now - start);
+}
+
 bool hasTimedOut(unsigned long startTime, unsigned long timeout) {
-    return (millis() - startTime) >= timeout;
+    return elapsed32(millis(), startTime) >= timeout;
 }
 
 unsigned long getElapsedTime(unsigned long startTime) {
-    return millis() - startTime;
+    return elapsed32(millis(), startTime);
 }
 
 bool hasTimedOutMicros(unsigned long startTime, unsigned long timeout) {
-    return (micros() - startTime) >= timeout;
+    return elapsed32(micros(), startTime) >= timeout;
 }
 
 unsigned long getElapsedTimeMicros(unsigned long startTime) {
-    return micros() - startTime;
-}
-
-bool nonBlockingDelay(unsigned long duration) {
-    static unsigned long lastTime = 0;
-    static bool initialized = false;
-    
-    if (!initialized) {
-        lastTime = millis();
-        initialized = true;
-        return false;
-    }
-    
-    if (millis() - lastTime >= duration) {
-        initialized = false;
-        return true;
-    }
-    
-    return false;
+    return elapsed32(micros(), startTime);
 }
 
 bool nonBlockingDelayStateful(unsigned long* lastTime, unsigned long duration) {
     unsigned long currentTime = millis();
-    if (currentTime - *lastTime >= duration) {
+    if (elapsed32(currentTime, *lastTime) >= duration) {
         *lastTime = currentTime;
         return true;
     }
@@ -49,7 +66,7 @@ bool nonBlockingDelayStateful(unsigned long* lastTime, unsigned long duration) {
 
 bool shouldExecute(unsigned long* lastTime, unsigned long interval) {
     unsigned long currentTime = millis();
-    if (currentTime - *lastTime >= interval) {
+    if (elapsed32(currentTime, *lastTime) >= interval) {
         *lastTime = currentTime;
         return true;
     }
@@ -61,7 +78,7 @@ unsigned long measureStart() {
 }
 
 unsigned long measureEnd(unsigned long startTime) {
-    return millis() - startTime;
+    return elapsed32(millis(), startTime);
 }
 
 unsigned long measureStartMicros() {
@@ -69,7 +86,7 @@ unsigned long measureStartMicros() {
 }
 
 unsigned long measureEndMicros(unsigned long startTime) {
-    return micros() - startTime;
+    return elapsed32(micros(), startTime);
 }
 
 bool waitForCondition(bool (*condition)(), unsigned long timeout) {
@@ -89,7 +106,7 @@ bool debounce(bool currentState, bool* lastState, unsigned long* lastChangeTime,
         *lastState = currentState;
     }
     
-    return (millis() - *lastChangeTime) > debounceDelay;
+    return elapsed32(millis(), *lastChangeTime) > debounceDelay;
 }
 
 unsigned long getTimeRemaining(unsigned long startTime, unsigned long timeout) {
@@ -103,7 +120,7 @@ bool isWithinTimeWindow(unsigned long startTime, unsigned long windowDuration) {
 
 bool throttle(unsigned long* lastCallTime, unsigned long minInterval) {
     unsigned long currentTime = millis();
-    if (currentTime - *lastCallTime >= minInterval) {
+    if (elapsed32(currentTime, *lastCallTime) >= minInterval) {
         *lastCallTime = currentTime;
         return true;
     }
@@ -3,9 +3,64 @@
 
 #include <Arduino.h>
 
+// ===================================================================
+// MONOTONIC CLOCK
+// ===================================================================
+//
+// 64-bit microseconds since boot (esp_timer_get_time()). millis() is 32
+// bits and wraps after 49.7 days, micros() after 71.6 minutes; anything
+// that schedules ahead or outlives those (cycles, LED steps, uptime,
+// telemetry) uses this clock. It does not wrap in the lifetime of a
+// device, so deadlines compare with plain < and >=.
+//
+
+/**
+ * Microseconds since boot
+ */
+uint64_t monotonicMicros();
+
+/**
+ * Milliseconds since boot (64-bit, does not wrap)
+ */
+uint64_t monotonicMillis();
+
+/**
+ * Time elapsed since a monotonicMicros() timestamp
+ * @param start_us Start time (0 if it lies in the future)
+ * @return Elapsed microseconds
+ */
+uint64_t elapsedMicros(uint64_t start_us);
+
+/**
+ * Check if a timeout has occurred since a monotonicMicros() timestamp
+ * @param start_us Start time
+ * @param timeout_us Timeout in microseconds
+ * @return true if timeout has occurred
+ */
+bool hasTimedOutUs(uint64_t start_us, uint64_t timeout_us);
+
+/**
+ * Check if a monotonicMicros() deadline has been reached
+ * @param deadline_us Deadline
+ * @return true if now >= deadline
+ */
+bool deadlineReached(uint64_t deadline_us);
+
+/**
+ * Deadline a number of milliseconds from now
+ * @param delay_ms Delay in milliseconds
+ * @return monotonicMicros() deadline
+ */
+uint64_t deadlineAfterMs(uint32_t delay_ms);
+
 // ===================================================================
 // TIMING UTILITIES
 // ===================================================================
+//
+// 32-bit millis()/micros() helpers. Differences are taken modulo 2^32,
+// so they stay correct across the wrap for durations below 49.7 days
+// (71.6 minutes for the micros() variants).
+//
 
 /**
  * Check if a timeout has occurred since a start time
@@ -37,16 +92,9 @@ bool hasTimedOutMicros(unsigned long startTime, unsigned long timeout);
  */
 unsigned long getElapsedTimeMicros(unsigned long startTime);
 
-/**
- * Non-blocking delay implementation
- * Use this in loops where you need to wait without blocking other operations
- * @param duration Duration to wait in milliseconds
- * @return true if delay period has completed, false if still waiting
- */
-bool nonBlockingDelay(unsigned long duration);
-
 /**
  * Stateful non-blocking delay for multiple instances
+ * (TimerService in timer_service.h keeps such state behind a handle)
  * @param lastTime Pointer to store the last time (pass a static variable)
  * @param duration Duration to wait in milliseconds
  * @return true if delay period has completed, false if still waiting
@@ -1,20 +1,21 @@
 #include "comm_cycles.h"
 #include "cycle_manager.h"
 #include "../../features/bluetooth/ble_data_handler.h"
+#include "../../features/bluetooth/l2cap_channel.h"
 #include "../../hal/led/led_manager.h"
 #include "../../hal/constants.h"
+#include "../../status/device_lifecycle.h"
+#include "../../features/camera/camera.h"
 #include "esp_camera.h"
 #include <Arduino.h>
 
 // External variables
-extern bool photoDataUploading;
 extern camera_fb_t *fb;
 extern size_t sent_photo_bytes;
 extern size_t sent_photo_frames;
 
 // Function declarations
 extern bool isConnected();
-extern void notifyPhotoData(uint8_t* data, size_t length);
 
 // ===================================================================
 // COMMUNICATION CYCLE MANAGER
@@ -24,6 +25,46 @@ namespace CommCycles {
     int data_transmission_cycle_id = -1;
     int connection_monitor_cycle_id = -1;
     
+    // Photo, code and start header frames (notifications carry PHOTO_CHUNK_SIZE,
+    // the L2CAP channel up to L2CAP_BULK_SDU_SIZE)
+    static uint8_t frame_buffer[PHOTO_FRAME_MAX_SIZE];
+    
+#ifdef PHOTO_START_HEADER
+    // Hash, quality and length ahead of the chunks, so the client can skip a near-duplicate
+    static void sendPhotoStart() {
+        // Built once when the upload began; a stalled channel gets the same header next pass
+        if (!sendPhotoFrame(photoStartHeader, BLE_PHOTO_START_SIZE)) return;
+        photoStartPending = false;
+        uint64_t hash = blePhotoStartHash(photoStartHeader);
+        Serial.printf("Photo start: hash %08x%08x%s\n", (unsigned)(hash >> 32), (unsigned)(hash & 0xFFFFFFFF),
+                      photoStartHeader[3] & BLE_PHOTO_START_HASH ? "" : " (not a baseline JPEG)");
+    }
+#endif
+    
+    // A scanned code goes out like a photo: [symbology] + text, then the end marker
+    static void sendCodeChunk() {
+        if (sent_photo_bytes < codePayloadLength) {
+            size_t chunk_size = codePayloadLength - sent_photo_bytes;
+            if (chunk_size > photoFrameChunkSize()) chunk_size = photoFrameChunkSize();
+            
+            bleWriteFrameHeader(frame_buffer, sent_photo_frames, BLE_FRAME_TYPE_CODE);
+            memcpy(&frame_buffer[BLE_FRAME_HEADER_SIZE], &codePayload[sent_photo_bytes], chunk_size);
+            if (!sendPhotoFrame(frame_buffer, chunk_size + BLE_FRAME_HEADER_SIZE)) return;
+            
+            sent_photo_bytes += chunk_size;
+            sent_photo_frames++;
+            return;
+        }
+        
+        uint8_t endMarker[BLE_FRAME_HEADER_SIZE];
+        bleWriteEndMarker(endMarker, BLE_FRAME_TYPE_CODE);
+        if (!sendPhotoFrame(endMarker, sizeof(endMarker))) return;
+        Serial.printf("Code transmission complete: %d bytes in %d frames\n", sent_photo_bytes, sent_photo_frames);
+        
+        // Clears codePayloadLength; a single shot's session ends with it
+        DeviceLifecycle::dispatch(LIFECYCLE_EVENT_UPLOAD_DONE);
+    }
+    
     void initialize() {
         Serial.println("Initializing Communication Cycles...");
         registerDataTransmissionCycle();
@@ -34,68 +75,73 @@ namespace CommCycles {
         data_transmission_cycle_id = registerConditionCycle(
             "DataTransmission",
             []() {
-                return photoDataUploading && fb && isConnected();
+                return DeviceLifecycle::isIn(LIFECYCLE_UPLOADING) && (fb || codePayloadLength > 0) && isConnected();
             },
             []() {
-                if (!fb || !isConnected()) {
-                    photoDataUploading = false;
-                    sent_photo_bytes = 0;
-                    sent_photo_frames = 0;
+                bool pending = fb || codePayloadLength > 0;
+                if (!pending || !isConnected()) {
+                    // Leaving UPLOADING returns fb and clears the counters
+                    DeviceLifecycle::dispatch(pending ? LIFECYCLE_EVENT_DISCONNECTED : LIFECYCLE_EVENT_UPLOAD_DONE);
                     return;
                 }
                 
-                // Calculate remaining data to send
-                size_t remaining = fb->len - sent_photo_bytes;
+                if (!fb) {
+                    sendCodeChunk();
+                    return;
+                }
+                
+#ifdef PHOTO_START_HEADER
+                if (photoStartPending) {
+                    sendPhotoStart();
+                    return;
+                }
+#endif
+                
+                // Calculate remaining data to send (fb less the JPEG headers when compacted)
+                size_t remaining = photoHeaderCompactor.length(fb->len) - sent_photo_bytes;
                 
                 if (remaining > 0) {
-                    // Prepare frame with header
-                    uint8_t frame_buffer[PHOTO_CHUNK_SIZE + 3]; // +3 for header
-                    
                     // Frame header: [frame_number_low, frame_number_high, frame_type]
-                    frame_buffer[0] = sent_photo_frames & 0xFF;
-                    frame_buffer[1] = (sent_photo_frames >> 8) & 0xFF;
-                    frame_buffer[2] = 0x01; // Photo frame type
+                    bleWriteFrameHeader(frame_buffer, sent_photo_frames, BLE_FRAME_TYPE_PHOTO);
                     
-                    // Calculate chunk size (leave room for header)
-                    size_t chunk_size = min(remaining, (size_t)PHOTO_CHUNK_SIZE);
+                    // Copy photo data after header (leave room for header)
+                    size_t chunk_size = photoHeaderCompactor.read(fb->buf, fb->len, sent_photo_bytes,
+                                                                  &frame_buffer[BLE_FRAME_HEADER_SIZE],
+                                                                  photoFrameChunkSize());
                     
-                    // Copy photo data after header
-                    memcpy(&frame_buffer[3], fb->buf + sent_photo_bytes, chunk_size);
-                    
-                    // Send frame with header + data
-                    notifyPhotoData(frame_buffer, chunk_size + 3);
+                    // Send frame with header + data; a stalled channel gets it again next pass
+                    if (!sendPhotoFrame(frame_buffer, chunk_size + BLE_FRAME_HEADER_SIZE)) return;
                     
                     sent_photo_bytes += chunk_size;
                     sent_photo_frames++;
                     
                     Serial.printf("Sent photo frame %d: %d bytes (total: %d/%d)\n", 
-                                 sent_photo_frames, chunk_size, sent_photo_bytes, fb->len);
+                                 sent_photo_frames, chunk_size, sent_photo_bytes,
+                                 photoHeaderCompactor.length(fb->len));
                     
                     // Note: BLE transmission throttling is handled by the cycle manager timing
                 } else {
-                    // Transmission complete - send end marker
-                    Serial.printf("Photo transmission complete: %d bytes in %d frames\n", 
-                                 sent_photo_bytes, sent_photo_frames);
-                    
-                    // Send end marker: [0xFF, 0xFF, 0x01]
-                    uint8_t endMarker[3] = {0xFF, 0xFF, 0x01};
-                    notifyPhotoData(endMarker, 3);
+                    // Transmission complete - send end marker: [0xFF, 0xFF, 0x01]
+                    uint8_t endMarker[BLE_FRAME_HEADER_SIZE];
+                    bleWriteEndMarker(endMarker, BLE_FRAME_TYPE_PHOTO);
+                    if (!sendPhotoFrame(endMarker, sizeof(endMarker))) return;
                     
-                    // Clean up
-                    if (fb) {
-                        esp_camera_fb_return(fb);
-                        fb = nullptr;
-                    }
+                    Serial.printf("Photo transmission complete: %d bytes in %d frames%s\n", 
+                                 sent_photo_bytes, sent_photo_frames,
+                                 photoHeaderCompactor.isCompact() ? " (headers cached)" : "");
                     
-                    photoDataUploading = false;
-                    sent_photo_bytes = 0;
-                    sent_photo_frames = 0;
+                    // Returns fb; an interval session goes back to CAPTURING
+                    DeviceLifecycle::dispatch(LIFECYCLE_EVENT_UPLOAD_DONE);
                     
                     Serial.println("Photo transmission cycle completed");
                 }
             },
             CYCLE_PRIORITY_HIGH
         );
+        
+        // Same priority as audio capture: the budget keeps a slow link from starving it
+        setCycleBudget(data_transmission_cycle_id, PHOTO_UPLOAD_BUDGET_US, PHOTO_UPLOAD_BUDGET_PERIOD_MS,
+                       CYCLE_OVERRUN_DEFER);
     }
     
     void registerConnectionMonitorCycle() {
@@ -115,15 +161,9 @@ namespace CommCycles {
                         setLedPattern(LED_DISCONNECTED);
                         
                         // Clean up any ongoing operations
-                        if (photoDataUploading) {
+                        if (DeviceLifecycle::isIn(LIFECYCLE_UPLOADING)) {
                             Serial.println("Cleaning up photo upload due to disconnection");
-                            if (fb) {
-                                esp_camera_fb_return(fb);
-                                fb = nullptr;
-                            }
-                            photoDataUploading = false;
-                            sent_photo_bytes = 0;
-                            sent_photo_frames = 0;
+                            DeviceLifecycle::dispatch(LIFECYCLE_EVENT_DISCONNECTED);
                         }
                     }
                     lastConnected = currentConnected;
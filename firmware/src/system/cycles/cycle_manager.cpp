@@ -1,6 +1,8 @@
 #include "cycle_manager.h"
 #include <Arduino.h>
 #include "../clock/timing.h"
+#include "loop_watchdog.h"
+#include <freertos/FreeRTOS.h>
 
 // ===================================================================
 // GLOBAL CYCLE MANAGER STATE
@@ -12,8 +14,218 @@ bool cycle_manager_initialized = false;
 
 // Statistics
 unsigned long total_cycles_executed = 0;
-unsigned long total_execution_time = 0;
-unsigned long last_manager_update = 0;
+uint64_t total_execution_time_us = 0;
+uint64_t last_manager_update_us = 0;
+
+// Active list: slots updateCycles() visits, by priority then registration
+// order. Rebuilt at the start of a pass after anything changed, so it is
+// stable while cycles run; disabled and paused cycles are not on it.
+static uint8_t active_slots[MAX_CYCLES];
+static uint16_t active_generations[MAX_CYCLES];
+static size_t active_count = 0;
+static bool active_list_dirty = true;
+
+static uint32_t next_sequence = 0;
+static int executing_slot = -1;
+static uint64_t executing_start_us = 0;
+
+// Read by the loop watchdog task on the other core (getCycleActivity())
+static portMUX_TYPE activityMux = portMUX_INITIALIZER_UNLOCKED;
+static cycle_activity_t activity = {0, -1, nullptr, 0};
+
+static int makeCycleId(size_t slot) {
+    return (int)(((uint32_t)cycles[slot].generation << 8) | slot);
+}
+
+static bool isRunnable(const cycle_t* cycle) {
+    return cycle->registered && !cycle->release_pending &&
+           cycle->config.enabled && cycle->runtime.state == CYCLE_STATE_ACTIVE;
+}
+
+static bool runsBefore(const cycle_t* a, const cycle_t* b) {
+    if (a->config.priority != b->config.priority) {
+        return a->config.priority < b->config.priority;
+    }
+    return a->sequence < b->sequence;
+}
+
+static void rebuildActiveList() {
+    active_count = 0;
+    for (size_t slot = 0; slot < MAX_CYCLES; slot++) {
+        if (!isRunnable(&cycles[slot])) continue;
+        
+        // Insertion sort: a few dozen entries, only after a change
+        size_t index = active_count++;
+        while (index > 0 && runsBefore(&cycles[slot], &cycles[active_slots[index - 1]])) {
+            active_slots[index] = active_slots[index - 1];
+            active_generations[index] = active_generations[index - 1];
+            index--;
+        }
+        active_slots[index] = (uint8_t)slot;
+        active_generations[index] = cycles[slot].generation;
+    }
+    active_list_dirty = false;
+}
+
+// ===================================================================
+// CPU BUDGETS
+// ===================================================================
+
+static uint64_t budgetPeriodUs(const cycle_config_t& config) {
+    uint32_t period_ms = config.budget_period_ms;
+    if (period_ms == 0) {
+        period_ms = config.mode == CYCLE_MODE_INTERVAL && config.interval_ms > 0 ?
+                    config.interval_ms : CYCLE_BUDGET_DEFAULT_PERIOD_MS;
+    }
+    return (uint64_t)period_ms * 1000ULL;
+}
+
+static uint32_t utilizationPpm(const cycle_config_t& config) {
+    if (config.budget_us == 0) {
+        return 0;
+    }
+    uint64_t ppm = (uint64_t)config.budget_us * 1000000ULL / budgetPeriodUs(config);
+    return ppm > 1000000ULL ? 1000000 : (uint32_t)ppm;
+}
+
+/**
+ * Check that budgets of this much more utilisation still fit the bound
+ */
+static bool admitUtilization(uint32_t added_ppm, const cycle_t* replacing) {
+    uint32_t total_ppm = added_ppm;
+    for (size_t slot = 0; slot < MAX_CYCLES; slot++) {
+        const cycle_t* cycle = &cycles[slot];
+        if (!cycle->registered || cycle->release_pending || cycle == replacing) continue;
+        total_ppm += utilizationPpm(cycle->config);
+    }
+    return total_ppm <= CYCLE_UTILIZATION_BOUND_PPM;
+}
+
+static void resetBudget(cycle_t* cycle, uint64_t now_us) {
+    cycle->runtime.budget_tokens_us = cycle->config.budget_us;
+    cycle->runtime.budget_refill_us = now_us;
+}
+
+/**
+ * Refill the token bucket up to now
+ * @return true if the cycle may run
+ */
+static bool budgetAvailable(cycle_t* cycle, uint64_t now_us) {
+    uint32_t budget_us = cycle->config.budget_us;
+    if (budget_us == 0) {
+        return true;
+    }
+    
+    cycle_runtime_t* runtime = &cycle->runtime;
+    if (now_us > runtime->budget_refill_us) {
+        uint64_t period_us = budgetPeriodUs(cycle->config);
+        uint64_t refill_us = (now_us - runtime->budget_refill_us) * budget_us / period_us;
+        if (runtime->budget_tokens_us + (int64_t)refill_us >= (int64_t)budget_us) {
+            runtime->budget_tokens_us = budget_us;
+            runtime->budget_refill_us = now_us;
+        } else if (refill_us > 0) {
+            // Advance only by the time actually turned into budget
+            runtime->budget_tokens_us += refill_us;
+            runtime->budget_refill_us += refill_us * period_us / budget_us;
+        }
+    }
+    return runtime->budget_tokens_us > 0;
+}
+
+static void chargeBudget(cycle_t* cycle, uint64_t execution_time_us) {
+    if (cycle->config.budget_us == 0) {
+        return;
+    }
+    cycle->runtime.budget_tokens_us -= (int64_t)execution_time_us;
+    if (cycle->runtime.budget_tokens_us < 0) {
+        cycle->runtime.overrun_count++;
+    }
+}
+
+/**
+ * Check whether a runnable cycle is due in this pass
+ */
+static bool cycleDue(cycle_t* cycle, uint64_t current_time_us) {
+    switch (cycle->config.mode) {
+        case CYCLE_MODE_INTERVAL:
+            return current_time_us >= cycle->runtime.next_execution_us;
+            
+        case CYCLE_MODE_TIMEOUT:
+            if (current_time_us >= cycle->runtime.next_execution_us) {
+                if (cycle->config.one_shot) {
+                    cycle->runtime.state = CYCLE_STATE_COMPLETED;
+                    active_list_dirty = true;
+                }
+                return true;
+            }
+            return false;
+            
+        case CYCLE_MODE_CONDITION:
+            return cycle->config.condition && cycle->config.condition();
+            
+        case CYCLE_MODE_PATTERN:
+            return updatePatternCycle(cycle, current_time_us);
+            
+        case CYCLE_MODE_CIRCULAR_BUFFER: {
+            // Run once enough elements are waiting
+            const circular_buffer_config_t& buffer = cycle->config.buffer_config;
+            size_t needed = buffer.batch > 0 ? buffer.batch : 1;
+            return !buffer.pending || buffer.pending() >= needed;
+        }
+            
+        case CYCLE_MODE_STATE_MACHINE:
+            // Run while events are waiting; without a check, every pass
+            return !cycle->config.condition || cycle->config.condition();
+    }
+    return false;
+}
+
+static void releaseSlot(cycle_t* cycle) {
+    cycle->config = cycle_config_t();
+    cycle->registered = false;
+    cycle->release_pending = false;
+    cycle->runtime.state = CYCLE_STATE_INACTIVE;
+    cycle_count--;
+    active_list_dirty = true;
+}
+
+/**
+ * Make the cycle the executing one: cycleShouldYield(), the loop watchdog
+ * and an unregister from inside the cycle all refer to it
+ */
+static void enterCycle(cycle_t* cycle, uint64_t start_us) {
+    executing_slot = (int)(cycle - cycles);
+    executing_start_us = start_us;
+    portENTER_CRITICAL(&activityMux);
+    activity.cycle_id = makeCycleId(executing_slot);
+    activity.cycle_name = cycle->config.name;
+    activity.cycle_start_us = start_us;
+    portEXIT_CRITICAL(&activityMux);
+}
+
+static void leaveCycle(cycle_t* cycle) {
+    executing_slot = -1;
+    portENTER_CRITICAL(&activityMux);
+    activity.cycle_id = -1;
+    activity.cycle_name = nullptr;
+    portEXIT_CRITICAL(&activityMux);
+    if (cycle->release_pending) {
+        releaseSlot(cycle);
+    }
+}
+
+/**
+ * Run a runnable cycle if it is due. Its condition() is part of the
+ * cycle's time, so a stall inside it is blamed on the cycle.
+ */
+static void runIfDue(cycle_t* cycle, uint64_t current_time_us) {
+    enterCycle(cycle, monotonicMicros());
+    bool due = cycleDue(cycle, current_time_us);
+    leaveCycle(cycle);
+    if (due && cycle->registered) {
+        executeCycle(cycle, current_time_us);
+    }
+}
 
 // ===================================================================
 // CORE CYCLE MANAGER FUNCTIONS
@@ -30,22 +242,20 @@ void initializeCycleManager() {
     for (size_t i = 0; i < MAX_CYCLES; i++) {
         cycles[i].config.name = nullptr;
         cycles[i].config.enabled = false;
+        cycles[i].runtime = cycle_runtime_t();
         cycles[i].runtime.state = CYCLE_STATE_INACTIVE;
-        cycles[i].runtime.last_execution = 0;
-        cycles[i].runtime.next_execution = 0;
-        cycles[i].runtime.execution_count = 0;
-        cycles[i].runtime.error_count = 0;
-        cycles[i].runtime.total_execution_time = 0;
-        cycles[i].runtime.max_execution_time = 0;
-        cycles[i].runtime.pattern_step = 0;
-        cycles[i].runtime.pattern_step_active = false;
-        cycles[i].runtime.pattern_step_start = 0;
+        cycles[i].generation = 1;
+        cycles[i].sequence = 0;
+        cycles[i].registered = false;
+        cycles[i].release_pending = false;
     }
     
     cycle_count = 0;
+    active_count = 0;
+    active_list_dirty = true;
     total_cycles_executed = 0;
-    total_execution_time = 0;
-    last_manager_update = measureStart();
+    total_execution_time_us = 0;
+    last_manager_update_us = monotonicMicros();
     
     cycle_manager_initialized = true;
     Serial.println("Cycle Manager initialized");
@@ -57,122 +267,252 @@ int registerCycle(const cycle_config_t& config) {
         return -1;
     }
     
-    if (cycle_count >= MAX_CYCLES) {
-        Serial.printf("Maximum cycles reached (%d)\n", MAX_CYCLES);
+    if (!config.name || !config.execute) {
+        Serial.println("Invalid cycle configuration");
         return -1;
     }
     
-    if (!config.name || !config.execute) {
-        Serial.println("Invalid cycle configuration");
+    if (!admitUtilization(utilizationPpm(config), nullptr)) {
+        Serial.printf("Cycle '%s' rejected: budget %lu us per %llu ms exceeds the CPU bound\n",
+                      config.name, (unsigned long)config.budget_us,
+                      (unsigned long long)(budgetPeriodUs(config) / 1000ULL));
         return -1;
     }
     
-    int cycle_id = cycle_count++;
-    cycles[cycle_id].config = config;
-    cycles[cycle_id].runtime.state = config.enabled ? CYCLE_STATE_ACTIVE : CYCLE_STATE_INACTIVE;
-    cycles[cycle_id].runtime.last_execution = measureStart();
-    cycles[cycle_id].runtime.next_execution = measureStart() + config.interval_ms;
+    size_t slot = 0;
+    while (slot < MAX_CYCLES && cycles[slot].registered) {
+        slot++;
+    }
+    if (slot >= MAX_CYCLES) {
+        Serial.printf("Maximum cycles reached (%d)\n", MAX_CYCLES);
+        return -1;
+    }
     
-    Serial.printf("Registered cycle '%s' (ID: %d, Priority: %d)\n", 
-                  config.name, cycle_id, config.priority);
+    cycle_t* cycle = &cycles[slot];
+    uint64_t now_us = monotonicMicros();
+    cycle->config = config;
+    cycle->runtime = cycle_runtime_t();
+    cycle->runtime.state = config.enabled ? CYCLE_STATE_ACTIVE : CYCLE_STATE_INACTIVE;
+    cycle->runtime.last_execution_us = now_us;
+    cycle->runtime.next_execution_us = now_us + getCyclePeriodUs(cycle);
+    resetBudget(cycle, now_us);
+    cycle->sequence = next_sequence++;
+    cycle->registered = true;
+    cycle->release_pending = false;
+    cycle_count++;
+    active_list_dirty = true;
+    
+    int cycle_id = makeCycleId(slot);
+    Serial.printf("Registered cycle '%s' (ID: %d, slot %u, Priority: %d)\n", 
+                  config.name, cycle_id, (unsigned)slot, config.priority);
     
     return cycle_id;
 }
 
+bool unregisterCycle(int cycle_id) {
+    cycle_t* cycle = getCycle(cycle_id);
+    if (!cycle) {
+        return false;
+    }
+    
+    size_t slot = CYCLE_ID_SLOT(cycle_id);
+    Serial.printf("Unregistered cycle '%s' (ID: %d)\n", cycle->config.name, cycle_id);
+    
+    // The ID goes stale right away; the slot is reused once it is free
+    cycle->generation = cycle->generation == 0xFFFF ? 1 : cycle->generation + 1;
+    if ((int)slot == executing_slot) {
+        // Still inside its execute function: free the slot after it returns
+        cycle->release_pending = true;
+        active_list_dirty = true;
+    } else {
+        releaseSlot(cycle);
+    }
+    return true;
+}
+
+cycle_t* getCycle(int cycle_id) {
+    if (cycle_id < 0) {
+        return nullptr;
+    }
+    size_t slot = CYCLE_ID_SLOT(cycle_id);
+    if (slot >= MAX_CYCLES) {
+        return nullptr;
+    }
+    cycle_t* cycle = &cycles[slot];
+    if (!cycle->registered || cycle->release_pending || makeCycleId(slot) != cycle_id) {
+        return nullptr;
+    }
+    return cycle;
+}
+
+size_t getActiveCycleCount() {
+    if (active_list_dirty) {
+        rebuildActiveList();
+    }
+    return active_count;
+}
+
+bool setCycleBudget(int cycle_id, uint32_t budget_us, uint32_t period_ms, cycle_overrun_policy_t policy) {
+    cycle_t* cycle = getCycle(cycle_id);
+    if (!cycle) {
+        return false;
+    }
+    
+    cycle_config_t config = cycle->config;
+    config.budget_us = budget_us;
+    config.budget_period_ms = period_ms;
+    if (!admitUtilization(utilizationPpm(config), cycle)) {
+        Serial.printf("Cycle '%s' budget rejected: %lu us per %llu ms exceeds the CPU bound\n",
+                      config.name, (unsigned long)budget_us,
+                      (unsigned long long)(budgetPeriodUs(config) / 1000ULL));
+        return false;
+    }
+    
+    cycle->config.budget_us = budget_us;
+    cycle->config.budget_period_ms = period_ms;
+    cycle->config.overrun_policy = policy;
+    resetBudget(cycle, monotonicMicros());
+    return true;
+}
+
+uint32_t getCycleUtilizationPpm() {
+    uint32_t total_ppm = 0;
+    for (size_t slot = 0; slot < MAX_CYCLES; slot++) {
+        if (!cycles[slot].registered || cycles[slot].release_pending) continue;
+        total_ppm += utilizationPpm(cycles[slot].config);
+    }
+    return total_ppm;
+}
+
+bool cycleShouldYield() {
+    if (executing_slot < 0) {
+        return false;
+    }
+    const cycle_t* cycle = &cycles[executing_slot];
+    if (cycle->config.budget_us == 0) {
+        return false;
+    }
+    return cycle->runtime.budget_tokens_us - (int64_t)elapsedMicros(executing_start_us) <= 0;
+}
+
+int getExecutingCycleId() {
+    cycle_activity_t snapshot;
+    getCycleActivity(&snapshot);
+    return snapshot.cycle_id;
+}
+
+uint32_t getCyclePassSequence() {
+    cycle_activity_t snapshot;
+    getCycleActivity(&snapshot);
+    return snapshot.pass_sequence;
+}
+
+void getCycleActivity(cycle_activity_t* snapshot) {
+    portENTER_CRITICAL(&activityMux);
+    *snapshot = activity;
+    portEXIT_CRITICAL(&activityMux);
+}
+
+static void advancePassSequence() {
+    portENTER_CRITICAL(&activityMux);
+    activity.pass_sequence++;
+    portEXIT_CRITICAL(&activityMux);
+}
+
 void updateCycles() {
     if (!cycle_manager_initialized) {
         return;
     }
     
-    unsigned long current_time = measureStart();
-    unsigned long manager_start = current_time;
+    advancePassSequence();
+    uint64_t current_time_us = monotonicMicros();
     
-    // Process cycles by priority
-    for (int priority = CYCLE_PRIORITY_CRITICAL; priority <= CYCLE_PRIORITY_BACKGROUND; priority++) {
-        for (size_t i = 0; i < cycle_count; i++) {
-            cycle_t* cycle = &cycles[i];
-            
-            // Skip if wrong priority or not active
-            if (cycle->config.priority != priority || 
-                cycle->runtime.state != CYCLE_STATE_ACTIVE ||
-                !cycle->config.enabled) {
-                continue;
-            }
-            
-            bool should_execute = false;
-            
-            // Check execution condition based on mode
-            switch (cycle->config.mode) {
-                case CYCLE_MODE_INTERVAL:
-                    should_execute = hasTimedOut(cycle->runtime.last_execution, cycle->config.interval_ms);
-                    break;
-                    
-                case CYCLE_MODE_TIMEOUT:
-                    should_execute = hasTimedOut(cycle->runtime.last_execution, cycle->config.timeout_ms);
-                    if (should_execute && cycle->config.one_shot) {
-                        cycle->runtime.state = CYCLE_STATE_COMPLETED;
-                    }
-                    break;
-                    
-                case CYCLE_MODE_CONDITION:
-                    if (cycle->config.condition) {
-                        should_execute = cycle->config.condition();
-                    }
-                    break;
-                    
-                case CYCLE_MODE_PATTERN:
-                    should_execute = updatePatternCycle(cycle, current_time);
-                    break;
-                    
-                case CYCLE_MODE_CIRCULAR_BUFFER:
-                    should_execute = true; // Always execute for buffer management
-                    break;
-                    
-                case CYCLE_MODE_STATE_MACHINE:
-                    should_execute = true; // State machines manage their own timing
-                    break;
-            }
-            
-            if (should_execute) {
-                executeCycle(cycle, current_time);
+    if (active_list_dirty) {
+        rebuildActiveList();
+    }
+    
+    // Process active cycles by priority; cycles out of budget either sit
+    // this pass out or wait until everything else has run
+    uint8_t demoted[MAX_CYCLES];
+    uint16_t demoted_generations[MAX_CYCLES];
+    size_t demoted_count = 0;
+    
+    for (size_t i = 0; i < active_count; i++) {
+        cycle_t* cycle = &cycles[active_slots[i]];
+        
+        // Skip anything disabled, paused or replaced earlier in this pass
+        if (cycle->generation != active_generations[i] || !isRunnable(cycle)) {
+            continue;
+        }
+        
+        if (!budgetAvailable(cycle, current_time_us)) {
+            cycle->runtime.deferred_count++;
+            if (cycle->config.overrun_policy == CYCLE_OVERRUN_DEMOTE) {
+                demoted[demoted_count] = active_slots[i];
+                demoted_generations[demoted_count] = active_generations[i];
+                demoted_count++;
             }
+            continue;
         }
+        
+        runIfDue(cycle, current_time_us);
+    }
+    
+    for (size_t i = 0; i < demoted_count; i++) {
+        cycle_t* cycle = &cycles[demoted[i]];
+        if (cycle->generation != demoted_generations[i] || !isRunnable(cycle)) {
+            continue;
+        }
+        runIfDue(cycle, current_time_us);
     }
     
     // Update manager statistics
-    unsigned long manager_duration = measureEnd(manager_start);
-    total_execution_time += manager_duration;
-    last_manager_update = current_time;
+    total_execution_time_us += elapsedMicros(current_time_us);
+    last_manager_update_us = current_time_us;
+    advancePassSequence();
 }
 
-void executeCycle(cycle_t* cycle, unsigned long current_time) {
-    unsigned long execution_start = current_time;
+uint64_t getCyclePeriodUs(const cycle_t* cycle) {
+    uint32_t period_ms = cycle->config.mode == CYCLE_MODE_TIMEOUT ?
+                         cycle->config.timeout_ms : cycle->config.interval_ms;
+    return (uint64_t)period_ms * 1000ULL;
+}
+
+void executeCycle(cycle_t* cycle, uint64_t current_time_us) {
+    uint64_t execution_start_us = monotonicMicros();
+    enterCycle(cycle, execution_start_us);
     
     try {
         // Execute the cycle
         cycle->config.execute();
         
-        // Update statistics
+        // Update statistics; the next run is one period after this pass started
         cycle->runtime.execution_count++;
-        cycle->runtime.last_execution = current_time;
+        cycle->runtime.last_execution_us = current_time_us;
+        cycle->runtime.next_execution_us = current_time_us + getCyclePeriodUs(cycle);
         total_cycles_executed++;
         
         // Calculate execution time
-        unsigned long execution_time = measureEnd(execution_start);
-        cycle->runtime.total_execution_time += execution_time;
-        if (execution_time > cycle->runtime.max_execution_time) {
-            cycle->runtime.max_execution_time = execution_time;
+        uint64_t execution_time_us = elapsedMicros(execution_start_us);
+        chargeBudget(cycle, execution_time_us);
+        cycle->runtime.total_execution_time_us += execution_time_us;
+        if (execution_time_us > cycle->runtime.max_execution_time_us) {
+            cycle->runtime.max_execution_time_us = execution_time_us > UINT32_MAX ?
+                                                   UINT32_MAX : (uint32_t)execution_time_us;
         }
         
         // Handle one-shot cycles
         if (cycle->config.one_shot) {
             cycle->runtime.state = CYCLE_STATE_COMPLETED;
+            active_list_dirty = true;
         }
         
     } catch (...) {
         // Handle execution error
+        chargeBudget(cycle, elapsedMicros(execution_start_us));
         cycle->runtime.error_count++;
         cycle->runtime.state = CYCLE_STATE_ERROR;
+        active_list_dirty = true;
         
         Serial.printf("Cycle '%s' execution error!\n", cycle->config.name);
         
@@ -180,21 +520,23 @@ void executeCycle(cycle_t* cycle, unsigned long current_time) {
             cycle->config.on_error();
         }
     }
+    
+    leaveCycle(cycle);
 }
 
-bool updatePatternCycle(cycle_t* cycle, unsigned long current_time) {
+bool updatePatternCycle(cycle_t* cycle, uint64_t current_time_us) {
     if (!cycle->config.pattern || cycle->config.pattern_length == 0) {
         return false;
     }
     
     // Check if current pattern step is complete
     pattern_step_t* current_step = &cycle->config.pattern[cycle->runtime.pattern_step];
-    unsigned long step_elapsed = getElapsedTime(cycle->runtime.pattern_step_start);
+    uint64_t step_end_us = cycle->runtime.pattern_step_start_us + (uint64_t)current_step->duration_ms * 1000ULL;
     
-    if (step_elapsed >= current_step->duration_ms) {
+    if (current_time_us >= step_end_us) {
         // Move to next pattern step
         cycle->runtime.pattern_step = (cycle->runtime.pattern_step + 1) % cycle->config.pattern_length;
-        cycle->runtime.pattern_step_start = current_time;
+        cycle->runtime.pattern_step_start_us = current_time_us;
         cycle->runtime.pattern_step_active = cycle->config.pattern[cycle->runtime.pattern_step].active;
         return true;
     }
@@ -203,82 +545,112 @@ bool updatePatternCycle(cycle_t* cycle, unsigned long current_time) {
 }
 
 void setCycleEnabled(int cycle_id, bool enabled) {
-    if (cycle_id < 0 || cycle_id >= (int)cycle_count) {
+    cycle_t* cycle = getCycle(cycle_id);
+    if (!cycle) {
         return;
     }
     
-    cycles[cycle_id].config.enabled = enabled;
-    if (enabled && cycles[cycle_id].runtime.state == CYCLE_STATE_INACTIVE) {
-        cycles[cycle_id].runtime.state = CYCLE_STATE_ACTIVE;
+    cycle->config.enabled = enabled;
+    if (enabled && cycle->runtime.state == CYCLE_STATE_INACTIVE) {
+        cycle->runtime.state = CYCLE_STATE_ACTIVE;
     } else if (!enabled) {
-        cycles[cycle_id].runtime.state = CYCLE_STATE_INACTIVE;
+        cycle->runtime.state = CYCLE_STATE_INACTIVE;
     }
+    active_list_dirty = true;
 }
 
 void setCyclePaused(int cycle_id, bool paused) {
-    if (cycle_id < 0 || cycle_id >= (int)cycle_count) {
+    cycle_t* cycle = getCycle(cycle_id);
+    if (!cycle) {
         return;
     }
     
     if (paused) {
-        cycles[cycle_id].runtime.state = CYCLE_STATE_PAUSED;
-    } else if (cycles[cycle_id].config.enabled) {
-        cycles[cycle_id].runtime.state = CYCLE_STATE_ACTIVE;
+        cycle->runtime.state = CYCLE_STATE_PAUSED;
+    } else if (cycle->config.enabled) {
+        cycle->runtime.state = CYCLE_STATE_ACTIVE;
     }
+    active_list_dirty = true;
 }
 
 cycle_state_t getCycleState(int cycle_id) {
-    if (cycle_id < 0 || cycle_id >= (int)cycle_count) {
+    cycle_t* cycle = getCycle(cycle_id);
+    if (!cycle) {
         return CYCLE_STATE_INACTIVE;
     }
     
-    return cycles[cycle_id].runtime.state;
+    return cycle->runtime.state;
 }
 
 const cycle_runtime_t* getCycleStats(int cycle_id) {
-    if (cycle_id < 0 || cycle_id >= (int)cycle_count) {
+    cycle_t* cycle = getCycle(cycle_id);
+    if (!cycle) {
         return nullptr;
     }
     
-    return &cycles[cycle_id].runtime;
+    return &cycle->runtime;
 }
 
 void resetCycleStats(int cycle_id) {
-    if (cycle_id < 0 || cycle_id >= (int)cycle_count) {
+    cycle_t* cycle = getCycle(cycle_id);
+    if (!cycle) {
         return;
     }
     
-    cycles[cycle_id].runtime.execution_count = 0;
-    cycles[cycle_id].runtime.error_count = 0;
-    cycles[cycle_id].runtime.total_execution_time = 0;
-    cycles[cycle_id].runtime.max_execution_time = 0;
+    cycle->runtime.execution_count = 0;
+    cycle->runtime.error_count = 0;
+    cycle->runtime.total_execution_time_us = 0;
+    cycle->runtime.max_execution_time_us = 0;
+    cycle->runtime.overrun_count = 0;
+    cycle->runtime.deferred_count = 0;
+    LoopWatchdog::resetCycleStalls(cycle_id);
 }
 
 void printCycleManagerStats() {
     Serial.println("\n=== Cycle Manager Statistics ===");
-    Serial.printf("Total cycles: %d\n", cycle_count);
+    Serial.printf("Total cycles: %u of %d slots, %u active\n",
+                  (unsigned)cycle_count, MAX_CYCLES, (unsigned)getActiveCycleCount());
     Serial.printf("Total executions: %lu\n", total_cycles_executed);
-    Serial.printf("Total execution time: %lu ms\n", total_execution_time);
-    Serial.printf("Last update: %lu ms ago\n", getElapsedTime(last_manager_update));
+    Serial.printf("Total execution time: %.1f ms\n", total_execution_time_us / 1000.0);
+    Serial.printf("Last update: %.1f ms ago\n", elapsedMicros(last_manager_update_us) / 1000.0);
+    Serial.printf("Uptime: %llu ms\n", (unsigned long long)monotonicMillis());
+    Serial.printf("Budgeted CPU: %.1f%% (bound %.1f%%)\n",
+                  getCycleUtilizationPpm() / 10000.0, CYCLE_UTILIZATION_BOUND_PPM / 10000.0);
     
     Serial.println("\nCycle Summary:");
-    for (size_t i = 0; i < cycle_count; i++) {
-        cycle_t* cycle = &cycles[i];
-        Serial.printf("  %s: %s, %lu executions, %lu errors\n",
+    for (size_t slot = 0; slot < MAX_CYCLES; slot++) {
+        cycle_t* cycle = &cycles[slot];
+        if (!cycle->registered) continue;
+        Serial.printf("  [%d] %s: %s, %lu executions, %lu errors\n",
+                      makeCycleId(slot),
                       cycle->config.name,
                       getCycleStateString(cycle->runtime.state),
                       cycle->runtime.execution_count,
                       cycle->runtime.error_count);
+        if (cycle->config.budget_us > 0) {
+            Serial.printf("      budget %lu us / %llu ms, %lu overruns, %lu deferred\n",
+                          (unsigned long)cycle->config.budget_us,
+                          (unsigned long long)(budgetPeriodUs(cycle->config) / 1000ULL),
+                          (unsigned long)cycle->runtime.overrun_count,
+                          (unsigned long)cycle->runtime.deferred_count);
+        }
+        uint32_t stalls, longest_stall_ms;
+        if (LoopWatchdog::getCycleStalls(makeCycleId(slot), &stalls, &longest_stall_ms)) {
+            Serial.printf("      %lu loop stalls, longest %lu ms\n",
+                          (unsigned long)stalls, (unsigned long)longest_stall_ms);
+        }
     }
+    
+    LoopWatchdog::printStats();
 }
 
 void printCycleStats(int cycle_id) {
-    if (cycle_id < 0 || cycle_id >= (int)cycle_count) {
+    cycle_t* cycle = getCycle(cycle_id);
+    if (!cycle) {
         Serial.printf("Invalid cycle ID: %d\n", cycle_id);
         return;
     }
     
-    cycle_t* cycle = &cycles[cycle_id];
     Serial.printf("\n=== Cycle '%s' Statistics ===\n", cycle->config.name);
     Serial.printf("State: %s\n", getCycleStateString(cycle->runtime.state));
     Serial.printf("Priority: %d\n", cycle->config.priority);
@@ -286,11 +658,32 @@ void printCycleStats(int cycle_id) {
     Serial.printf("Enabled: %s\n", cycle->config.enabled ? "Yes" : "No");
     Serial.printf("Executions: %lu\n", cycle->runtime.execution_count);
     Serial.printf("Errors: %lu\n", cycle->runtime.error_count);
-    Serial.printf("Total execution time: %lu ms\n", cycle->runtime.total_execution_time);
-    Serial.printf("Max execution time: %lu ms\n", cycle->runtime.max_execution_time);
+    Serial.printf("Total execution time: %.1f ms\n", cycle->runtime.total_execution_time_us / 1000.0);
+    Serial.printf("Max execution time: %lu us\n", (unsigned long)cycle->runtime.max_execution_time_us);
     if (cycle->runtime.execution_count > 0) {
-        Serial.printf("Average execution time: %lu ms\n", 
-                      cycle->runtime.total_execution_time / cycle->runtime.execution_count);
+        Serial.printf("Average execution time: %llu us\n", 
+                      (unsigned long long)(cycle->runtime.total_execution_time_us / cycle->runtime.execution_count));
+    }
+    if (cycle->config.budget_us > 0) {
+        static const char* policyNames[] = {"defer", "demote", "split"};
+        Serial.printf("CPU budget: %lu us per %llu ms (%s), %lld us left\n",
+                      (unsigned long)cycle->config.budget_us,
+                      (unsigned long long)(budgetPeriodUs(cycle->config) / 1000ULL),
+                      policyNames[cycle->config.overrun_policy],
+                      (long long)cycle->runtime.budget_tokens_us);
+        Serial.printf("Overruns: %lu, deferred passes: %lu\n",
+                      (unsigned long)cycle->runtime.overrun_count,
+                      (unsigned long)cycle->runtime.deferred_count);
+    }
+    uint32_t stalls, longest_stall_ms;
+    if (LoopWatchdog::getCycleStalls(cycle_id, &stalls, &longest_stall_ms)) {
+        Serial.printf("Loop stalls: %lu, longest %lu ms\n",
+                      (unsigned long)stalls, (unsigned long)longest_stall_ms);
+    }
+    if (cycle->config.mode == CYCLE_MODE_INTERVAL || cycle->config.mode == CYCLE_MODE_TIMEOUT) {
+        uint64_t now_us = monotonicMicros();
+        uint64_t next_us = cycle->runtime.next_execution_us;
+        Serial.printf("Next execution: in %.1f ms\n", next_us > now_us ? (next_us - now_us) / 1000.0 : 0.0);
     }
 }
 
@@ -382,7 +775,7 @@ int registerPatternCycle(const char* name, pattern_step_t* pattern, size_t patte
     return registerCycle(config);
 }
 
-int registerCircularBufferCycle(const char* name, circular_buffer_config_t* buffer_config,
+int registerCircularBufferCycle(const char* name, const circular_buffer_config_t& buffer_config,
                                std::function<void()> execute,
                                cycle_priority_t priority) {
     cycle_config_t config = {};
@@ -394,5 +787,20 @@ int registerCircularBufferCycle(const char* name, circular_buffer_config_t* buff
     config.enabled = true;
     config.one_shot = false;
     
+    return registerCycle(config);
+}
+
+int registerStateMachineCycle(const char* name, std::function<bool()> pending,
+                             std::function<void()> execute,
+                             cycle_priority_t priority) {
+    cycle_config_t config = {};
+    config.name = name;
+    config.mode = CYCLE_MODE_STATE_MACHINE;
+    config.priority = priority;
+    config.condition = pending;
+    config.execute = execute;
+    config.enabled = true;
+    config.one_shot = false;
+    
     return registerCycle(config);
 } 
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include <Arduino.h>
 #include <functional>
+#include "../memory/ring_buffer.h"
 
 // ===================================================================
 // CENTRALIZED CYCLE MANAGEMENT SYSTEM
@@ -16,8 +17,8 @@ typedef enum {
     CYCLE_MODE_TIMEOUT,         // Execute after timeout
     CYCLE_MODE_CONDITION,       // Execute when condition is met
     CYCLE_MODE_PATTERN,         // Execute following a pattern
-    CYCLE_MODE_CIRCULAR_BUFFER, // Manage circular buffer updates
-    CYCLE_MODE_STATE_MACHINE    // State machine transitions
+    CYCLE_MODE_CIRCULAR_BUFFER, // Drain a ring buffer when it has data
+    CYCLE_MODE_STATE_MACHINE    // Run a state machine's queued events
 } cycle_mode_t;
 
 /**
@@ -42,6 +43,15 @@ typedef enum {
     CYCLE_STATE_COMPLETED       // One-shot cycle completed
 } cycle_state_t;
 
+/**
+ * What happens when a budgeted cycle has spent its CPU budget
+ */
+typedef enum {
+    CYCLE_OVERRUN_DEFER,        // Skip it until the budget has refilled
+    CYCLE_OVERRUN_DEMOTE,       // Run it after every other cycle in the pass
+    CYCLE_OVERRUN_SPLIT         // Defer, and the cycle cuts its own work with cycleShouldYield()
+} cycle_overrun_policy_t;
+
 /**
  * Pattern step definition for pattern cycles
  */
@@ -52,14 +62,12 @@ typedef struct {
 } pattern_step_t;
 
 /**
- * Circular buffer configuration
+ * Circular buffer configuration: the cycle runs when its ring buffer
+ * (RingBuffer<T, N>) holds at least batch elements
  */
 typedef struct {
-    void* buffer;              // Pointer to buffer
-    size_t element_size;       // Size of each element
-    size_t buffer_size;        // Total number of elements
-    size_t* index;             // Pointer to current index
-    std::function<void(void*)> on_wrap; // Callback when buffer wraps
+    std::function<size_t()> pending;            // Elements waiting (RingBuffer::size())
+    size_t batch;                               // Elements needed to run (0 = any)
 } circular_buffer_config_t;
 
 /**
@@ -71,52 +79,86 @@ typedef struct {
     cycle_priority_t priority;                  // Priority level
     uint32_t interval_ms;                       // Interval for INTERVAL mode
     uint32_t timeout_ms;                        // Timeout for TIMEOUT mode
-    std::function<bool()> condition;            // Condition function for CONDITION mode
+    std::function<bool()> condition;            // Condition function for CONDITION mode (events waiting for STATE_MACHINE)
     std::function<void()> execute;              // Execution function
     std::function<void()> on_error;             // Error handler
     pattern_step_t* pattern;                    // Pattern steps for PATTERN mode
     size_t pattern_length;                      // Number of pattern steps
-    circular_buffer_config_t* buffer_config;    // Buffer config for CIRCULAR_BUFFER mode
+    circular_buffer_config_t buffer_config;     // Buffer config for CIRCULAR_BUFFER mode
     bool enabled;                               // Whether cycle is enabled
     bool one_shot;                              // Execute only once
+    uint32_t budget_us;                         // CPU time per budget period (0 = unbudgeted)
+    uint32_t budget_period_ms;                  // Budget period (0 = interval_ms, else CYCLE_BUDGET_DEFAULT_PERIOD_MS)
+    cycle_overrun_policy_t overrun_policy;      // When the budget is spent
 } cycle_config_t;
 
 /**
  * Cycle runtime state
+ * Times are monotonicMicros() (64-bit, no wrap)
  */
 typedef struct {
     cycle_state_t state;                        // Current state
-    unsigned long last_execution;               // Last execution time
-    unsigned long next_execution;               // Next scheduled execution
+    uint64_t last_execution_us;                 // Last execution time
+    uint64_t next_execution_us;                 // Next scheduled execution (INTERVAL/TIMEOUT)
     size_t execution_count;                     // Number of executions
     size_t error_count;                         // Number of errors
-    unsigned long total_execution_time;         // Total time spent executing
-    unsigned long max_execution_time;           // Maximum single execution time
+    uint64_t total_execution_time_us;           // Total time spent executing
+    uint32_t max_execution_time_us;             // Maximum single execution time
     size_t pattern_step;                        // Current pattern step
     bool pattern_step_active;                   // Whether current pattern step is active
-    unsigned long pattern_step_start;           // When current pattern step started
+    uint64_t pattern_step_start_us;             // When current pattern step started
+    int64_t budget_tokens_us;                   // CPU budget left (negative after an overrun)
+    uint64_t budget_refill_us;                  // Budget refilled up to this time
+    size_t overrun_count;                       // Executions that overdrew the budget
+    size_t deferred_count;                      // Passes skipped or demoted for lack of budget
 } cycle_runtime_t;
 
+/**
+ * What updateCycles() is doing, as the loop watchdog on the other core
+ * sees it: written and read as one snapshot
+ */
+typedef struct {
+    uint32_t pass_sequence;                     // updateCycles() entries and exits: odd during a pass
+    int cycle_id;                               // Cycle in its condition or execute function, -1 between cycles
+    const char* cycle_name;
+    uint64_t cycle_start_us;                    // When that cycle was entered
+} cycle_activity_t;
+
 /**
  * Main cycle structure
  */
 typedef struct {
     cycle_config_t config;                      // Configuration
     cycle_runtime_t runtime;                    // Runtime state
+    uint16_t generation;                        // Bumped on unregister; part of the cycle ID
+    uint32_t sequence;                          // Registration order within a priority
+    bool registered;                            // Slot is in use
+    bool release_pending;                       // Unregistered while executing
 } cycle_t;
 
 // Maximum number of cycles that can be managed
 #define MAX_CYCLES 32
 
-// Global cycle manager state
+// CPU budgets: a budgeted cycle gets budget_us of execution time per
+// budget period, refilled continuously (a token bucket). Registration is
+// refused when the budgeted cycles together would exceed this share of
+// the CPU (parts per million; the Liu-Layland bound for many tasks).
+#define CYCLE_UTILIZATION_BOUND_PPM 690000
+#define CYCLE_BUDGET_DEFAULT_PERIOD_MS 100
+
+// Cycle IDs: slot in the low 8 bits, the slot's generation above it. An ID
+// kept after unregisterCycle() is rejected even once the slot is reused.
+#define CYCLE_ID_SLOT(cycle_id) ((cycle_id) & 0xFF)
+
+// Global cycle manager state (cycles[] is indexed by slot; check .registered)
 extern cycle_t cycles[MAX_CYCLES];
 extern size_t cycle_count;
 extern bool cycle_manager_initialized;
 
 // Statistics
 extern unsigned long total_cycles_executed;
-extern unsigned long total_execution_time;
-extern unsigned long last_manager_update;
+extern uint64_t total_execution_time_us;
+extern uint64_t last_manager_update_us;
 
 /**
  * Initialize the cycle manager
@@ -124,12 +166,75 @@ extern unsigned long last_manager_update;
 void initializeCycleManager();
 
 /**
- * Register a new cycle
+ * Register a new cycle in the first free slot
  * @param config Cycle configuration
- * @return Cycle ID (index) or -1 if failed
+ * @return Cycle ID or -1 if failed
  */
 int registerCycle(const cycle_config_t& config);
 
+/**
+ * Unregister a cycle and free its slot. A cycle may unregister itself
+ * from its execute function; the slot is freed once that returns.
+ * @param cycle_id Cycle ID
+ * @return false if the ID is stale or invalid
+ */
+bool unregisterCycle(int cycle_id);
+
+/**
+ * Look up a cycle by ID
+ * @param cycle_id Cycle ID
+ * @return The cycle, or nullptr if the ID is stale or invalid
+ */
+cycle_t* getCycle(int cycle_id);
+
+/**
+ * Number of cycles updateCycles() visits (enabled and active)
+ */
+size_t getActiveCycleCount();
+
+/**
+ * Change a cycle's CPU budget (subject to admission like registration)
+ * @param cycle_id Cycle ID
+ * @param budget_us CPU time per period (0 = unbudgeted)
+ * @param period_ms Budget period (0 = default)
+ * @param policy What happens when the budget is spent
+ * @return false if the ID is invalid or the utilisation bound would be exceeded
+ */
+bool setCycleBudget(int cycle_id, uint32_t budget_us, uint32_t period_ms,
+                    cycle_overrun_policy_t policy = CYCLE_OVERRUN_DEFER);
+
+/**
+ * CPU share reserved by all budgeted cycles
+ * @return Parts per million
+ */
+uint32_t getCycleUtilizationPpm();
+
+/**
+ * For the executing cycle: true once it has used up its budget, so a
+ * cycle with divisible work (CYCLE_OVERRUN_SPLIT) can stop and continue
+ * on a later pass. Always false for unbudgeted cycles.
+ */
+bool cycleShouldYield();
+
+/**
+ * ID of the cycle whose condition or execute function is running, for
+ * the loop watchdog on the other core
+ * @return Cycle ID, or -1 between cycles
+ */
+int getExecutingCycleId();
+
+/**
+ * Count of updateCycles() entries and exits: odd while a pass is running.
+ * The loop watchdog reads it from the other core to time passes.
+ */
+uint32_t getCyclePassSequence();
+
+/**
+ * Pass sequence and executing cycle in one consistent copy (safe from
+ * the other core)
+ */
+void getCycleActivity(cycle_activity_t* activity);
+
 /**
  * Update all cycles (call this in main loop)
  */
@@ -183,8 +288,9 @@ void printCycleStats(int cycle_id);
 /**
  * Internal functions (used by cycle manager)
  */
-void executeCycle(cycle_t* cycle, unsigned long current_time);
-bool updatePatternCycle(cycle_t* cycle, unsigned long current_time);
+void executeCycle(cycle_t* cycle, uint64_t current_time_us);
+bool updatePatternCycle(cycle_t* cycle, uint64_t current_time_us);
+uint64_t getCyclePeriodUs(const cycle_t* cycle);
 const char* getCycleStateString(cycle_state_t state);
 const char* getCycleModeString(cycle_mode_t mode);
 
@@ -245,14 +351,58 @@ int registerPatternCycle(const char* name, pattern_step_t* pattern, size_t patte
  * Register a circular buffer cycle
  * @param name Cycle name
  * @param buffer_config Buffer configuration
- * @param execute Execution function
+ * @param execute Execution function (consumes from the buffer)
  * @param priority Priority level
  * @return Cycle ID or -1 if failed
  */
-int registerCircularBufferCycle(const char* name, circular_buffer_config_t* buffer_config,
+int registerCircularBufferCycle(const char* name, const circular_buffer_config_t& buffer_config,
                                std::function<void()> execute,
                                cycle_priority_t priority = CYCLE_PRIORITY_NORMAL);
 
+/**
+ * Register the consumer of a ring buffer: once batch elements are waiting
+ * it hands them to consume() as contiguous spans, in place, and releases
+ * them. Elements pushed while it drains wait for the next pass.
+ * @param name Cycle name
+ * @param ring Ring buffer (outlives the cycle); the cycle is its consumer
+ * @param batch Elements needed to run (0 = any)
+ * @param consume Called with each span (one or two per run)
+ * @param priority Priority level
+ * @return Cycle ID or -1 if failed
+ */
+template <typename T, size_t N>
+int registerRingBufferCycle(const char* name, RingBuffer<T, N>* ring, size_t batch,
+                            std::function<void(const T*, size_t)> consume,
+                            cycle_priority_t priority = CYCLE_PRIORITY_NORMAL) {
+    circular_buffer_config_t buffer_config;
+    buffer_config.pending = [ring]() { return ring->size(); };
+    buffer_config.batch = batch;
+    return registerCircularBufferCycle(name, buffer_config, [ring, consume]() {
+        size_t remaining = ring->size();
+        while (remaining > 0) {
+            size_t count;
+            const T* span = ring->readSpan(&count);
+            if (!span) break;
+            if (count > remaining) count = remaining;
+            consume(span, count);
+            ring->consume(count);
+            remaining -= count;
+        }
+    }, priority);
+}
+
+/**
+ * Register the cycle that runs a state machine's posted events
+ * @param name Cycle name
+ * @param pending Whether events are waiting (nullptr: run every pass)
+ * @param execute Execution function (dispatches the waiting events)
+ * @param priority Priority level
+ * @return Cycle ID or -1 if failed
+ */
+int registerStateMachineCycle(const char* name, std::function<bool()> pending,
+                             std::function<void()> execute,
+                             cycle_priority_t priority = CYCLE_PRIORITY_NORMAL);
+
 // ===================================================================
 // SPECIALIZED CYCLE MANAGERS
 // ===================================================================
@@ -1,23 +1,24 @@
 #include "data_cycles.h"
 #include "cycle_manager.h"
 #include "../../features/camera/camera.h"
+#include "../../features/camera/block_video.h"
 #include "../../features/bluetooth/ble_data_handler.h"
 #include "../../features/microphone/microphone_manager.h"
+#include "../../status/device_lifecycle.h"
 #include "../../hal/constants.h"
 #include "../clock/timing.h"
+#include "../clock/timer_service.h"
+#include "../power_management/duty_cycle_capture.h"
+#include "../power_management/retained_state.h"
 #include "esp_camera.h"
 #include <Arduino.h>
 
 // External variables
-extern bool deviceReady;
-extern bool isCapturingPhotos;
 extern int captureInterval;
 extern unsigned long lastCaptureTime;
 extern size_t sent_photo_bytes;
 extern size_t sent_photo_frames;
-extern bool photoDataUploading;
 extern bool isStreamingFrame;
-extern bool isStreamingVideo;
 extern int streamingFPS;
 extern unsigned long lastStreamFrame;
 extern size_t totalStreamingFrames;
@@ -37,28 +38,53 @@ namespace DataCycles {
     int photo_cycle_id = -1;
     int video_stream_cycle_id = -1;
     
+    // Log throttles (TimerService handles)
+    static timer_handle_t conditionLogTimer = TIMER_HANDLE_NONE;
+    static timer_handle_t captureLogTimer = TIMER_HANDLE_NONE;
+    static timer_handle_t audioLogTimer = TIMER_HANDLE_NONE;
+    static timer_handle_t noAudioLogTimer = TIMER_HANDLE_NONE;
+    int duty_cycle_cycle_id = -1;
+    
     void initialize() {
         Serial.println("Initializing Data Cycles...");
         registerAudioCaptureCycle();
         registerPhotoCycle();
-        // registerVideoStreamCycle();   // DISABLED: Not needed for photo capture
-        Serial.println("Data cycles: Audio capture and photo capture enabled");
+#ifdef DUTY_CYCLE_CAPTURE_ENABLED
+        registerDutyCycleCycle();
+#endif
+        registerVideoStreamCycle();
+        Serial.println("Data cycles: Audio capture, photo capture and block video enabled");
     }
     
     void registerAudioCaptureCycle() {
+        TimerService::release(&conditionLogTimer);
+        TimerService::release(&captureLogTimer);
+        TimerService::release(&audioLogTimer);
+        TimerService::release(&noAudioLogTimer);
+        conditionLogTimer = TimerService::createPeriodic("AudioConditionLog", 5000);
+        captureLogTimer = TimerService::createPeriodic("AudioCaptureLog", 2000);
+        audioLogTimer = TimerService::createPeriodic("AudioStatsLog", 3000);
+        noAudioLogTimer = TimerService::createPeriodic("NoAudioLog", 5000);
+        
         audio_capture_cycle_id = registerConditionCycle(
             "AudioCapture",
             []() {
                 // Always capture audio when microphone is ready
                 bool micReady = MicrophoneManager::isReady();
                 
+#ifdef DUTY_CYCLE_CAPTURE_ENABLED
+                // Audio is not captured while photos are duty-cycled
+                if (DutyCycleCapture::isActive()) {
+                    return false;
+                }
+#endif
+                
                 // Debug logging every 5 seconds
-                static unsigned long lastConditionLog = 0;
-                if (shouldExecute(&lastConditionLog, 5000)) {
+                if (TimerService::consume(conditionLogTimer)) {
                     Serial.printf("🎤 Audio Capture Condition: micReady=%s\n", micReady ? "YES" : "NO");
-                    Serial.printf("🎤 Connected=%s, deviceReady=%s\n", 
+                    Serial.printf("🎤 Connected=%s, lifecycle=%s\n", 
                                   isConnected() ? "YES" : "NO", 
-                                  deviceReady ? "YES" : "NO");
+                                  DeviceLifecycle::getStateName(DeviceLifecycle::getState()));
                 }
                 
                 // Always capture when microphone is ready
@@ -66,8 +92,7 @@ namespace DataCycles {
             },
             []() {
                 // Add debug logging for audio capture attempts
-                static unsigned long lastCaptureLog = 0;
-                if (shouldExecute(&lastCaptureLog, 2000)) {
+                if (TimerService::consume(captureLogTimer)) {
                     Serial.println("🎤 Audio capture cycle executing...");
                 }
                 
@@ -76,6 +101,7 @@ namespace DataCycles {
                 
                 if (bytes_recorded > 0) {
                     Serial.printf("🎤 Got %d bytes of audio data!\n", bytes_recorded);
+                    RetainedState::noteAudioFrame();
                     
                     uint8_t* recording_buffer = MicrophoneManager::getRecordingBuffer();
                     if (recording_buffer) {
@@ -87,17 +113,16 @@ namespace DataCycles {
                         }
                         
                         // Enhanced logging for audio capture
-                        static unsigned long lastAudioLog = 0;
                         static size_t totalBytesRecorded = 0;
-                        static unsigned long audioStartTime = 0;
+                        static uint64_t audioStartTime = 0;
                         static size_t frameCount = 0;
                         
-                        if (audioStartTime == 0) audioStartTime = millis();
+                        if (audioStartTime == 0) audioStartTime = monotonicMicros();
                         totalBytesRecorded += bytes_recorded;
                         frameCount++;
                         
-                        if (shouldExecute(&lastAudioLog, 3000)) { // Log every 3 seconds
-                            float duration_s = (millis() - audioStartTime) / 1000.0;
+                        if (TimerService::consume(audioLogTimer)) { // Log every 3 seconds
+                            float duration_s = elapsedMicros(audioStartTime) / 1000000.0;
                             float expected_bytes = duration_s * SAMPLE_RATE * 2; // 16-bit samples
                             float capture_rate = (totalBytesRecorded / expected_bytes) * 100.0;
                             
@@ -107,8 +132,7 @@ namespace DataCycles {
                     }
                 } else {
                     // Log when no audio data is captured
-                    static unsigned long lastNoAudioLog = 0;
-                    if (shouldExecute(&lastNoAudioLog, 5000)) {
+                    if (TimerService::consume(noAudioLogTimer)) {
                         Serial.println("⚠️  No audio data captured in this cycle");
                     }
                 }
@@ -121,33 +145,47 @@ namespace DataCycles {
         photo_cycle_id = registerConditionCycle(
             "PhotoCapture",
             []() {
-                if (!deviceReady || !isConnected() || photoDataUploading) {
+                if (!DeviceLifecycle::isIn(LIFECYCLE_CAPTURING) || !isConnected()) {
                     return false;
                 }
                 
-                // Check if we should capture based on control flags
-                bool should_capture = isCapturingPhotos && (captureInterval == 0 || 
-                    getElapsedTime(lastCaptureTime) >= (captureInterval * 1000));
-                
-                return should_capture;
+                // Single shots are due right away, intervals once they have elapsed
+                return captureInterval == 0 ||
+                    getElapsedTime(lastCaptureTime) >= (unsigned long)captureInterval;
             },
             []() {
+                // A code scan sends the decoded text if a code is in view, else the photo
+                if (scanNextCapture) {
+                    scanNextCapture = false;
+                    if (scan_for_code()) {
+                        DeviceLifecycle::dispatch(LIFECYCLE_EVENT_PHOTO_CAPTURED);
+                        return;
+                    }
+                }
+                
+                // A pyramid shot sends one level of a raw capture, else the photo
+                if (pyramidNextLevel >= 0) {
+                    int level = pyramidNextLevel;
+                    pyramidNextLevel = -1;
+                    if (capture_pyramid_photo(level)) {
+                        DeviceLifecycle::dispatch(LIFECYCLE_EVENT_PHOTO_CAPTURED);
+                        return;
+                    }
+                }
+                
                 Serial.println("Taking photo...");
                 
                 // Take photo
                 if (take_photo()) {
+                    // A rejected interval photo is taken again on the next run
+                    if (!check_photo_quality(captureInterval > 0)) return;
                     Serial.printf("Photo captured: %d bytes\n", fb->len);
                     
-                    // Set flags for data transmission
-                    photoDataUploading = true;
-                    lastCaptureTime = measureStart();
-                    
-                    // Update capture count
+                    // Hand fb to the upload; a single shot's session ends with it
                     if (captureInterval == 0) {
-                        // Single capture mode - stop after one photo
-                        isCapturingPhotos = false;
                         Serial.println("Single photo capture completed");
                     }
+                    DeviceLifecycle::dispatch(LIFECYCLE_EVENT_PHOTO_CAPTURED);
                 } else {
                     Serial.println("Photo capture failed");
                 }
@@ -156,16 +194,34 @@ namespace DataCycles {
         );
     }
     
+#ifdef DUTY_CYCLE_CAPTURE_ENABLED
+    void registerDutyCycleCycle() {
+        duty_cycle_cycle_id = registerConditionCycle(
+            "DutyCycle",
+            []() {
+                return DutyCycleCapture::isFlushPending() || DutyCycleCapture::shouldEnterSleep();
+            },
+            []() {
+                if (DutyCycleCapture::isFlushPending()) {
+                    DutyCycleCapture::update();
+                } else {
+                    DutyCycleCapture::enterSleep(); // Does not return
+                }
+            },
+            CYCLE_PRIORITY_NORMAL
+        );
+    }
+#endif
+    
     void registerVideoStreamCycle() {
         video_stream_cycle_id = registerConditionCycle(
             "VideoStream",
             []() {
-                // Video streaming when connected and streaming is active
-                return isConnected() && deviceReady && isStreamingVideo && !photoDataUploading;
+                // Block video only: JPEG streaming sets up the camera but sends no frames yet
+                return isConnected() && DeviceLifecycle::isIn(LIFECYCLE_STREAMING) && BlockVideo::isActive();
             },
             []() {
-                // Video streaming logic would go here
-                Serial.println("Video stream cycle (placeholder)");
+                BlockVideo::update();
             },
             CYCLE_PRIORITY_HIGH
         );
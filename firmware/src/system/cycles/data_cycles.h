@@ -6,10 +6,12 @@ namespace DataCycles {
     void registerAudioCaptureCycle();
     void registerPhotoCycle();
     void registerVideoStreamCycle();
+    void registerDutyCycleCycle();
     
     extern int audio_capture_cycle_id;
     extern int photo_cycle_id;
     extern int video_stream_cycle_id;
+    extern int duty_cycle_cycle_id;
 }
 
 #endif // DATA_CYCLES_H 
\ No newline at end of file
@@ -17,6 +17,12 @@ namespace LEDCycles {
     }
     
     void registerLEDUpdateCycle() {
+        // Patterns are played by their own timer; poll only as a fallback
+        if (isLedTimerDriven()) {
+            Serial.println("LED patterns are timer driven, no update cycle needed");
+            return;
+        }
+        
         led_update_cycle_id = registerIntervalCycle(
             "LEDUpdate",
             20, // 20ms for smooth LED updates
@@ -0,0 +1,292 @@
+#include "loop_watchdog.h"
+#include "cycle_manager.h"
+#include "../clock/timing.h"
+#include <freertos/FreeRTOS.h>
+
+#if defined(ARDUINO_ARCH_ESP32) && !CONFIG_FREERTOS_UNICORE && __has_include(<esp_private/crosscore_int.h>)
+#include <esp_private/crosscore_int.h>
+#define LOOP_WATCHDOG_CAN_BACKTRACE
+#endif
+
+// ===================================================================
+// WATCHDOG STATE
+// ===================================================================
+
+// Written by the watchdog task, read by printStats() on the loop task
+static portMUX_TYPE stallMux = portMUX_INITIALIZER_UNLOCKED;
+static loop_stall_t history[LOOP_WATCHDOG_HISTORY];
+static size_t historyCount = 0;
+static size_t historyNext = 0;
+static uint32_t stallCount = 0;
+static uint32_t maxStallMs = 0;
+
+/**
+ * Stalls counted against the cycle in one slot; cycle_id tells whether
+ * they belong to the cycle that holds the slot now
+ */
+typedef struct {
+    int cycle_id;
+    uint32_t count;
+    uint32_t max_ms;
+} cycle_stalls_t;
+
+static cycle_stalls_t cycleStalls[MAX_CYCLES];
+
+// Watchdog task only
+static bool watching = false;
+static uint32_t watchedSequence = 0;
+static uint64_t watchedSinceMs = 0;
+static uint64_t lastCheckMs = 0;
+static loop_stall_t* currentStall = nullptr;
+
+#ifdef LOOP_WATCHDOG_BACKTRACE
+static volatile bool backtraceEnabled = true;
+#else
+static volatile bool backtraceEnabled = false;
+#endif
+
+#if defined(ARDUINO_ARCH_ESP32)
+static TaskHandle_t watchdogTask = nullptr;
+static int loopCore = 0;
+
+static void watchdogTaskMain(void* arg) {
+    (void)arg;
+    TickType_t lastWake = xTaskGetTickCount();
+    for (;;) {
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(LOOP_WATCHDOG_CHECK_MS));
+        LoopWatchdog::check();
+    }
+}
+#endif
+
+/**
+ * The watched pass ended (or the watch was lost): close its stall record
+ */
+static void endStall() {
+    if (currentStall) {
+        portENTER_CRITICAL(&stallMux);
+        currentStall->ended = true;
+        portEXIT_CRITICAL(&stallMux);
+        currentStall = nullptr;
+    }
+    watching = false;
+}
+
+/**
+ * A pass crossed the threshold: record the culprit and count the stall
+ */
+static void startStall(uint64_t now_ms, uint32_t duration_ms, const cycle_activity_t* activity) {
+    int cycle_id = activity->cycle_id;
+    const char* name = cycle_id >= 0 && activity->cycle_name ? activity->cycle_name : "cycle manager";
+    uint64_t in_cycle_ms = cycle_id >= 0 ? now_ms - activity->cycle_start_us / 1000ULL : 0;
+    bool backtrace = false;
+#ifdef LOOP_WATCHDOG_CAN_BACKTRACE
+    backtrace = backtraceEnabled;
+#endif
+
+    portENTER_CRITICAL(&stallMux);
+    loop_stall_t* stall = &history[historyNext];
+    historyNext = (historyNext + 1) % LOOP_WATCHDOG_HISTORY;
+    if (historyCount < LOOP_WATCHDOG_HISTORY) historyCount++;
+    stall->cycle_id = cycle_id;
+    stall->cycle_name = name;
+    stall->detected_ms = now_ms;
+    stall->duration_ms = duration_ms;
+    stall->ended = false;
+    stall->backtrace = backtrace;
+    stallCount++;
+    if (duration_ms > maxStallMs) maxStallMs = duration_ms;
+    if (cycle_id >= 0) {
+        cycle_stalls_t* stalls = &cycleStalls[CYCLE_ID_SLOT(cycle_id)];
+        if (stalls->cycle_id != cycle_id) {
+            stalls->cycle_id = cycle_id;
+            stalls->count = 0;
+            stalls->max_ms = 0;
+        }
+        stalls->count++;
+        if (duration_ms > stalls->max_ms) stalls->max_ms = duration_ms;
+    }
+    portEXIT_CRITICAL(&stallMux);
+    currentStall = stall;
+
+    if (cycle_id >= 0) {
+        Serial.printf("[LoopWatchdog] updateCycles() stalled %lu ms in '%s' (%lu ms of it in the cycle)\n",
+                      (unsigned long)duration_ms, name, (unsigned long)in_cycle_ms);
+    } else {
+        Serial.printf("[LoopWatchdog] updateCycles() stalled %lu ms in '%s'\n", (unsigned long)duration_ms, name);
+    }
+#ifdef LOOP_WATCHDOG_CAN_BACKTRACE
+    if (backtrace) {
+        esp_crosscore_int_send_print_backtrace(loopCore);
+    }
+#endif
+}
+
+/**
+ * The stall goes on: extend its record and the culprit's longest stall
+ */
+static void extendStall(uint32_t duration_ms) {
+    int cycle_id = currentStall->cycle_id;
+
+    portENTER_CRITICAL(&stallMux);
+    currentStall->duration_ms = duration_ms;
+    if (duration_ms > maxStallMs) maxStallMs = duration_ms;
+    if (cycle_id >= 0) {
+        cycle_stalls_t* stalls = &cycleStalls[CYCLE_ID_SLOT(cycle_id)];
+        if (stalls->cycle_id == cycle_id && duration_ms > stalls->max_ms) stalls->max_ms = duration_ms;
+    }
+    portEXIT_CRITICAL(&stallMux);
+}
+
+// ===================================================================
+// LOOP WATCHDOG
+// ===================================================================
+
+namespace LoopWatchdog {
+    bool begin() {
+#if defined(ARDUINO_ARCH_ESP32)
+        if (watchdogTask) {
+            return true;
+        }
+
+        // Sample from the other core so a loop that never yields is still seen
+        loopCore = xPortGetCoreID();
+        int watchCore = portNUM_PROCESSORS > 1 ? 1 - loopCore : loopCore;
+        if (xTaskCreatePinnedToCore(watchdogTaskMain, "loop_wdt", 3072, nullptr, 5,
+                                    &watchdogTask, watchCore) != pdPASS) {
+            watchdogTask = nullptr;
+            Serial.println("[LoopWatchdog] Failed to create task");
+            return false;
+        }
+        Serial.printf("[LoopWatchdog] Watching core %d from core %d (threshold %d ms)\n",
+                      loopCore, watchCore, LOOP_WATCHDOG_THRESHOLD_MS);
+#endif
+        return true;
+    }
+
+    void end() {
+#if defined(ARDUINO_ARCH_ESP32)
+        if (watchdogTask) {
+            vTaskDelete(watchdogTask);
+            watchdogTask = nullptr;
+        }
+#endif
+        endStall();
+        lastCheckMs = 0;
+    }
+
+    void check() {
+        uint64_t now_ms = monotonicMillis();
+        cycle_activity_t activity;
+        getCycleActivity(&activity);
+        uint32_t sequence = activity.pass_sequence;
+
+        // A gap longer than the threshold means this task did not run
+        // (light sleep stops both cores): start watching afresh
+        bool missed = lastCheckMs != 0 && now_ms - lastCheckMs > LOOP_WATCHDOG_THRESHOLD_MS;
+        lastCheckMs = now_ms;
+
+        // Between passes, or a pass other than the watched one
+        if ((sequence & 1) == 0 || !watching || sequence != watchedSequence || missed) {
+            endStall();
+            if (sequence & 1) {
+                watching = true;
+                watchedSequence = sequence;
+                watchedSinceMs = now_ms;
+            }
+            return;
+        }
+
+        uint64_t elapsed_ms = now_ms - watchedSinceMs;
+        uint32_t duration_ms = elapsed_ms > UINT32_MAX ? UINT32_MAX : (uint32_t)elapsed_ms;
+        if (currentStall) {
+            extendStall(duration_ms);
+        } else if (duration_ms >= LOOP_WATCHDOG_THRESHOLD_MS) {
+            startStall(now_ms, duration_ms, &activity);
+        }
+    }
+
+    void setBacktraceEnabled(bool enabled) {
+        backtraceEnabled = enabled;
+    }
+
+    uint32_t getStallCount() {
+        return stallCount;
+    }
+
+    uint32_t getMaxStallMs() {
+        return maxStallMs;
+    }
+
+    bool getLastStall(loop_stall_t* stall) {
+        portENTER_CRITICAL(&stallMux);
+        bool found = historyCount > 0;
+        if (found) {
+            *stall = history[(historyNext + LOOP_WATCHDOG_HISTORY - 1) % LOOP_WATCHDOG_HISTORY];
+        }
+        portEXIT_CRITICAL(&stallMux);
+        return found;
+    }
+
+    bool getCycleStalls(int cycle_id, uint32_t* count, uint32_t* max_ms) {
+        *count = 0;
+        *max_ms = 0;
+        if (!getCycle(cycle_id)) return false;     // Unregistered: its stalls went with it
+
+        portENTER_CRITICAL(&stallMux);
+        const cycle_stalls_t* stalls = &cycleStalls[CYCLE_ID_SLOT(cycle_id)];
+        if (stalls->cycle_id == cycle_id) {
+            *count = stalls->count;
+            *max_ms = stalls->max_ms;
+        }
+        portEXIT_CRITICAL(&stallMux);
+        return *count > 0;
+    }
+
+    void resetCycleStalls(int cycle_id) {
+        if (cycle_id < 0 || CYCLE_ID_SLOT(cycle_id) >= MAX_CYCLES) return;
+
+        portENTER_CRITICAL(&stallMux);
+        cycle_stalls_t* stalls = &cycleStalls[CYCLE_ID_SLOT(cycle_id)];
+        if (stalls->cycle_id == cycle_id) {
+            stalls->count = 0;
+            stalls->max_ms = 0;
+        }
+        portEXIT_CRITICAL(&stallMux);
+    }
+
+    void reset() {
+        portENTER_CRITICAL(&stallMux);
+        historyCount = 0;
+        historyNext = 0;
+        stallCount = 0;
+        maxStallMs = 0;
+        portEXIT_CRITICAL(&stallMux);
+    }
+
+    void printStats() {
+        loop_stall_t recent[LOOP_WATCHDOG_HISTORY];
+        size_t count;
+        uint32_t total;
+        uint32_t longest;
+
+        portENTER_CRITICAL(&stallMux);
+        count = historyCount;
+        total = stallCount;
+        longest = maxStallMs;
+        for (size_t i = 0; i < count; i++) {
+            recent[i] = history[(historyNext + LOOP_WATCHDOG_HISTORY - count + i) % LOOP_WATCHDOG_HISTORY];
+        }
+        portEXIT_CRITICAL(&stallMux);
+
+        Serial.printf("Loop stalls: %lu over %d ms, longest %lu ms\n",
+                      (unsigned long)total, LOOP_WATCHDOG_THRESHOLD_MS, (unsigned long)longest);
+        uint64_t now_ms = monotonicMillis();
+        for (size_t i = 0; i < count; i++) {
+            Serial.printf("  %.1f s ago: %lu ms%s in '%s'%s\n",
+                          (now_ms - recent[i].detected_ms) / 1000.0,
+                          (unsigned long)recent[i].duration_ms, recent[i].ended ? "" : " (ongoing)",
+                          recent[i].cycle_name, recent[i].backtrace ? ", backtrace printed" : "");
+        }
+    }
+}
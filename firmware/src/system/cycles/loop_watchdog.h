@@ -0,0 +1,97 @@
+#ifndef LOOP_WATCHDOG_H
+#define LOOP_WATCHDOG_H
+
+#include <Arduino.h>
+#include "../../hal/constants.h"
+
+// ===================================================================
+// LOOP STALL WATCHDOG
+// ===================================================================
+//
+// A small task on the other core that notices when updateCycles() has
+// not returned within LOOP_WATCHDOG_THRESHOLD_MS. A blocked pass (a
+// camera retry, a slow I2C read, a notify() on a congested link) is
+// otherwise only visible as dropped audio.
+//
+// Every LOOP_WATCHDOG_CHECK_MS the task takes a snapshot of the cycle
+// manager's pass sequence and executing cycle (getCycleActivity()); a
+// pass whose sequence has not moved past the threshold is a stall. Each
+// stall is recorded once, with the cycle that was executing (the
+// culprit), and counted against that cycle here (getCycleStalls()), not
+// in the cycle's runtime, which belongs to the loop. Its length keeps
+// growing until the pass ends. With LOOP_WATCHDOG_BACKTRACE (or setBacktraceEnabled()) the
+// loop core is also interrupted to print its backtrace, the same way
+// the task watchdog does.
+//
+// Durations are accurate to one check interval. The host build has no
+// task: tests call check() while a cycle holds the virtual clock.
+//
+
+// Stalls kept for printStats()
+#define LOOP_WATCHDOG_HISTORY 4
+
+/**
+ * One stalled updateCycles() pass
+ */
+typedef struct {
+    int cycle_id;                   // Executing cycle when caught (-1: the manager itself)
+    const char* cycle_name;
+    uint64_t detected_ms;           // monotonicMillis() when the threshold was crossed
+    uint32_t duration_ms;           // Pass length so far (final once the pass ended)
+    bool ended;
+    bool backtrace;                 // Backtrace printed on the loop core
+} loop_stall_t;
+
+namespace LoopWatchdog {
+    /**
+     * Start the watchdog task on the core that is not running loop()
+     * (call from setup(), after initializeCycleManager())
+     * @return false if the task could not be created
+     */
+    bool begin();
+
+    /**
+     * Stop the watchdog task (e.g. before deep sleep)
+     */
+    void end();
+
+    /**
+     * Sample the loop once; the task calls this every LOOP_WATCHDOG_CHECK_MS
+     */
+    void check();
+
+    /**
+     * Print the loop core's backtrace on each stall (off unless LOOP_WATCHDOG_BACKTRACE)
+     */
+    void setBacktraceEnabled(bool enabled);
+
+    /**
+     * Stall statistics
+     */
+    uint32_t getStallCount();
+    uint32_t getMaxStallMs();
+    bool getLastStall(loop_stall_t* stall);
+
+    /**
+     * Stalls caught while a cycle was executing
+     * @return false if there were none
+     */
+    bool getCycleStalls(int cycle_id, uint32_t* count, uint32_t* max_ms);
+
+    /**
+     * Clear one cycle's stall counts (part of resetCycleStats())
+     */
+    void resetCycleStalls(int cycle_id);
+
+    /**
+     * Clear stall statistics (per-cycle counts are reset with resetCycleStats())
+     */
+    void reset();
+
+    /**
+     * Print stall totals and recent stalls (part of printCycleManagerStats())
+     */
+    void printStats();
+}
+
+#endif // LOOP_WATCHDOG_H
@@ -2,6 +2,7 @@
 #include "cycle_manager.h"
 #include "../battery/battery_code.h"
 #include "../../status/device_status.h"
+#include "../../status/device_lifecycle.h"
 #include "../power_management/power_management.h"
 #include "../memory/memory_utils.h"
 #include "../clock/timing.h"
@@ -9,15 +10,11 @@
 #include <Arduino.h>
 
 // External variables
-extern bool deviceReady;
 extern uint8_t deviceStatus;
 extern uint8_t batteryLevel;
 extern bool batteryDetected;
 extern bool connectionStable;
 extern bool isCharging;
-extern bool isCapturingPhotos;
-extern bool photoDataUploading;
-extern bool isStreamingVideo;
 
 // Function declarations
 extern bool isConnected();
@@ -60,7 +57,7 @@ namespace PowerCycles {
                 
                 // Update power statistics
                 float batteryVoltage = readBatteryVoltage();
-                bool cameraActive = isCapturingPhotos || photoDataUploading;
+                bool cameraActive = DeviceLifecycle::isIn(LIFECYCLE_PHOTO);
                 updatePowerStats(batteryVoltage, false, isConnected(), cameraActive);
                 
                 // Optimize power based on battery level (charging state disabled)
@@ -71,7 +68,7 @@ namespace PowerCycles {
                 static bool lastConnectionStable = true;
                 static bool lastIsCharging = false;
                 
-                if (!batteryDetected && lastBatteryDetected && deviceReady) {
+                if (!batteryDetected && lastBatteryDetected && DeviceLifecycle::isReady()) {
                     Serial.println("Battery disconnected during operation!");
                     updateDeviceStatus(DEVICE_STATUS_BATTERY_NOT_DETECTED);
                 } else if (batteryDetected && !lastBatteryDetected && deviceStatus == DEVICE_STATUS_BATTERY_NOT_DETECTED) {
@@ -79,7 +76,7 @@ namespace PowerCycles {
                     updateDeviceStatus(DEVICE_STATUS_READY);
                 }
                 
-                if (batteryDetected && !connectionStable && lastConnectionStable && deviceReady) {
+                if (batteryDetected && !connectionStable && lastConnectionStable && DeviceLifecycle::isReady()) {
                     Serial.println("⚠️  Unstable battery connection detected!");
                     updateDeviceStatus(DEVICE_STATUS_BATTERY_UNSTABLE);
                 } else if (batteryDetected && connectionStable && !lastConnectionStable && deviceStatus == DEVICE_STATUS_BATTERY_UNSTABLE) {
@@ -87,7 +84,7 @@ namespace PowerCycles {
                     updateDeviceStatus(DEVICE_STATUS_READY);
                 }
                 
-                if (isCharging && !lastIsCharging && deviceReady && deviceStatus != DEVICE_STATUS_CHARGING) {
+                if (isCharging && !lastIsCharging && DeviceLifecycle::isReady() && deviceStatus != DEVICE_STATUS_CHARGING) {
                     Serial.println("Device is now charging!");
                     updateDeviceStatus(DEVICE_STATUS_CHARGING);
                 } else if (!isCharging && lastIsCharging && deviceStatus == DEVICE_STATUS_CHARGING) {
@@ -122,7 +119,7 @@ namespace PowerCycles {
                 static unsigned long lastActivityTime = measureStart();
                 
                 // Update activity time if there's active operation
-                if (isConnected() || isCapturingPhotos || photoDataUploading || isStreamingVideo) {
+                if (isConnected() || !DeviceLifecycle::isIn(LIFECYCLE_IDLE)) {
                     lastActivityTime = measureStart();
                 }
                 
@@ -130,11 +127,13 @@ namespace PowerCycles {
                 unsigned long idleTime = getElapsedTime(lastActivityTime);
                 if (shouldEnterPowerSaving(batteryLevel, idleTime)) {
                     // Enter light sleep for a short period if idle
+                    // SLEEPING saves retained state on entry and marks the wake on exit
                     if (idleTime > POWER_IDLE_TIMEOUT_MS && !isConnected()) {
                         Serial.println("Device idle, entering light sleep...");
-                        prepareForSleep();
-                        enterLightSleep(1000); // Sleep for 1 second
-                        wakeFromSleep();
+                        if (DeviceLifecycle::dispatch(LIFECYCLE_EVENT_SLEEP)) {
+                            enterLightSleep(1000); // Sleep for 1 second
+                            DeviceLifecycle::dispatch(LIFECYCLE_EVENT_WAKE);
+                        }
                     }
                 }
             },
@@ -6,7 +6,7 @@
 // ===================================================================
 
 // Global memory statistics
-memory_stats_t memoryStats = {0};
+memory_stats_t memoryStats = {};
 
 // Memory allocation tracking array
 memory_allocation_t trackedAllocations[MAX_TRACKED_ALLOCATIONS];
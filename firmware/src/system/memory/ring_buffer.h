@@ -0,0 +1,224 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <stddef.h>
+#include <atomic>
+
+// ===================================================================
+// RING BUFFER
+// ===================================================================
+//
+// Fixed-size FIFO of N elements (N a power of two), lock-free for one
+// producer and one consumer, which may run on different tasks or cores:
+//
+//   static RingBuffer<audio_frame_t, 8> frames;
+//
+//   // Producer (e.g. the I2S task)
+//   if (!frames.push(frame)) dropped++;
+//
+//   // Consumer (e.g. a cycle; see registerRingBufferCycle())
+//   audio_frame_t frame;
+//   while (frames.pop(&frame)) send(frame);
+//
+// head and tail run freely and are only masked on access, so all N slots
+// are usable and size() is head - tail. The producer only writes head and
+// the consumer only writes tail; each publishes with a release store
+// after touching the elements, and reads the other's index with acquire.
+//
+// Batch push()/pop() copy up to a count in at most two runs (one at the
+// wrap). writeSpan()/commit() and readSpan()/consume() hand out the
+// contiguous run at the current position instead, for zero-copy fills
+// (DMA, encoders) and drains (notify()).
+//
+// pushOverwrite() and at() are for histories kept on a single task (the
+// battery voltage window, memory samples): they touch both ends and are
+// not safe with a concurrent consumer.
+//
+
+// Keep head and tail on separate cache lines on the host. Internal RAM is
+// not cached on the ESP32-S3, so there only the size matters
+#if defined(__XTENSA__)
+#define RING_BUFFER_INDEX_ALIGN 4
+#else
+#define RING_BUFFER_INDEX_ALIGN 64
+#endif
+
+template <typename T, size_t N>
+class RingBuffer {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "RingBuffer size must be a power of two");
+
+public:
+    RingBuffer() : head(0), tail(0) {}
+
+    static constexpr size_t capacity() { return N; }
+
+    // ===================================================================
+    // PRODUCER
+    // ===================================================================
+
+    /**
+     * Append one element
+     * @return false if the buffer is full
+     */
+    bool push(const T& item) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= N) {
+            return false;
+        }
+        items[h & MASK] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Append up to count elements
+     * @return Number appended (less than count when the buffer fills)
+     */
+    size_t push(const T* source, size_t count) {
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t room = N - (h - tail.load(std::memory_order_acquire));
+        if (count > room) count = room;
+        size_t first = N - (h & MASK);
+        if (first > count) first = count;
+        copyItems(&items[h & MASK], source, first);
+        copyItems(&items[0], source + first, count - first);
+        head.store(h + count, std::memory_order_release);
+        return count;
+    }
+
+    /**
+     * Contiguous free run at the write position, to fill in place
+     * @param count Set to the run length (0 when full)
+     * @return Start of the run, or nullptr when full
+     */
+    T* writeSpan(size_t* count) {
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t room = N - (h - tail.load(std::memory_order_acquire));
+        size_t run = N - (h & MASK);
+        *count = room < run ? room : run;
+        return *count ? &items[h & MASK] : nullptr;
+    }
+
+    /**
+     * Publish elements written through writeSpan()
+     * @param count At most the span's length
+     */
+    void commit(size_t count) {
+        head.store(head.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    }
+
+    /**
+     * Append one element, dropping the oldest when full (single task only)
+     */
+    void pushOverwrite(const T& item) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_relaxed) >= N) {
+            tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        items[h & MASK] = item;
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    // ===================================================================
+    // CONSUMER
+    // ===================================================================
+
+    /**
+     * Remove the oldest element
+     * @return false if the buffer is empty
+     */
+    bool pop(T* item) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (head.load(std::memory_order_acquire) == t) {
+            return false;
+        }
+        *item = items[t & MASK];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Remove up to count elements, oldest first
+     * @return Number removed
+     */
+    size_t pop(T* destination, size_t count) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t available = head.load(std::memory_order_acquire) - t;
+        if (count > available) count = available;
+        size_t first = N - (t & MASK);
+        if (first > count) first = count;
+        copyItems(destination, &items[t & MASK], first);
+        copyItems(destination + first, &items[0], count - first);
+        tail.store(t + count, std::memory_order_release);
+        return count;
+    }
+
+    /**
+     * Contiguous run of waiting elements at the read position
+     * @param count Set to the run length (0 when empty)
+     * @return Start of the run, or nullptr when empty
+     */
+    const T* readSpan(size_t* count) const {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t available = head.load(std::memory_order_acquire) - t;
+        size_t run = N - (t & MASK);
+        *count = available < run ? available : run;
+        return *count ? &items[t & MASK] : nullptr;
+    }
+
+    /**
+     * Release elements read through readSpan()
+     * @param count At most the span's length
+     */
+    void consume(size_t count) {
+        tail.store(tail.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    }
+
+    /**
+     * Element i from the oldest (i < size(); single task only)
+     */
+    const T& at(size_t i) const {
+        return items[(tail.load(std::memory_order_relaxed) + i) & MASK];
+    }
+
+    // ===================================================================
+    // EITHER SIDE
+    // ===================================================================
+
+    /**
+     * Elements waiting, as a snapshot: the consumer may see fewer than the
+     * producer has added, the producer more than the consumer has left
+     */
+    size_t size() const {
+        size_t t = tail.load(std::memory_order_acquire);
+        return head.load(std::memory_order_acquire) - t;
+    }
+
+    bool empty() const { return size() == 0; }
+    bool full() const { return size() >= N; }
+
+    /**
+     * Drop everything (consumer side)
+     */
+    void clear() {
+        tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+private:
+    static const size_t MASK = N - 1;
+
+    static void copyItems(T* destination, const T* source, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            destination[i] = source[i];
+        }
+    }
+
+    RingBuffer(const RingBuffer&);
+    RingBuffer& operator=(const RingBuffer&);
+
+    T items[N];
+    alignas(RING_BUFFER_INDEX_ALIGN) std::atomic<size_t> head;     // Written by the producer
+    alignas(RING_BUFFER_INDEX_ALIGN) std::atomic<size_t> tail;     // Written by the consumer
+};
+
+#endif // RING_BUFFER_H
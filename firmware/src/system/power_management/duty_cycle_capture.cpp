@@ -0,0 +1,371 @@
+#include "duty_cycle_capture.h"
+
+#ifdef DUTY_CYCLE_CAPTURE_ENABLED
+
+#include <LittleFS.h>
+#include <esp_timer.h>
+#include "esp_camera.h"
+#include "power_management.h"
+#include "retained_state.h"
+#include "../clock/timing.h"
+#include "../../features/camera/camera.h"
+#include "../../features/bluetooth/ble_frame_format.h"
+#include "../../features/bluetooth/l2cap_channel.h"
+#include "../../status/device_lifecycle.h"
+
+// Function declarations
+extern bool isConnected();
+
+#define DUTY_CYCLE_STATE_MAGIC 0x44435931   // "DCY1"
+#define DUTY_CYCLE_REPORT_VOLTAGE 3.7       // Nominal Li-ion voltage for energy figures
+
+/**
+ * State kept in RTC slow memory across deep sleep
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t interval_ms;           // Capture interval being duty-cycled
+    uint32_t wake_count;            // Timer wakes since the mode was armed
+    uint32_t first_photo_seq;       // Sequence number of the oldest stored photo
+    uint32_t next_photo_seq;        // Sequence number for the next stored photo
+
+    // Energy accounting
+    uint32_t photos_captured;
+    uint32_t capture_wakes;
+    uint64_t capture_awake_us;
+    uint32_t flush_wakes;
+    uint64_t flush_awake_us;
+} duty_cycle_state_t;
+
+RTC_DATA_ATTR static duty_cycle_state_t rtcState = {};
+
+// Flush state (this boot only)
+static bool flushWake = false;
+static bool flushPending = false;
+static unsigned long flushWindowStart = 0;
+static File uploadFile;
+static size_t uploadFrames = 0;
+
+// ===================================================================
+// PHOTO STORAGE
+// ===================================================================
+
+static const char* photoPath(uint32_t seq) {
+    static char path[24];
+    snprintf(path, sizeof(path), "/dc_%08lu.jpg", (unsigned long)seq);
+    return path;
+}
+
+static void findStoredPhotos() {
+    // The batch range is kept in RTC memory, which a power-on reset (a flat
+    // battery) clears: the file names are the record that survives
+    File root = LittleFS.open("/");
+    if (!root || !root.isDirectory()) {
+        return;
+    }
+
+    size_t found = 0;
+    uint32_t first_seq = 0;
+    uint32_t last_seq = 0;
+    for (File file = root.openNextFile(); file; file = root.openNextFile()) {
+        const char* name = strrchr(file.name(), '/');
+        name = name ? name + 1 : file.name();
+        file.close();
+
+        char* end;
+        if (strncmp(name, "dc_", 3) != 0) continue;
+        uint32_t seq = strtoul(name + 3, &end, 10);
+        if (end != name + 11 || strcmp(end, ".jpg") != 0) continue;
+
+        if (found == 0 || seq < first_seq) first_seq = seq;
+        if (found == 0 || seq > last_seq) last_seq = seq;
+        found++;
+    }
+    root.close();
+
+    if (found == 0) {
+        rtcState.first_photo_seq = rtcState.next_photo_seq;
+        return;
+    }
+
+    // Missing sequence numbers in between are skipped by the upload
+    rtcState.first_photo_seq = first_seq;
+    rtcState.next_photo_seq = last_seq + 1;
+}
+
+static bool storePhoto(const uint8_t* data, size_t length) {
+    // Drop the oldest photo once the batch is full
+    if (rtcState.next_photo_seq - rtcState.first_photo_seq >= DUTY_CYCLE_MAX_STORED_PHOTOS) {
+        LittleFS.remove(photoPath(rtcState.first_photo_seq));
+        rtcState.first_photo_seq++;
+    }
+
+    const char* path = photoPath(rtcState.next_photo_seq);
+    File file = LittleFS.open(path, FILE_WRITE);
+    if (!file) {
+        Serial.printf("Duty cycle: cannot create %s\n", path);
+        return false;
+    }
+
+    size_t written = file.write(data, length);
+    file.close();
+
+    if (written != length) {
+        Serial.printf("Duty cycle: short write %u/%u bytes, flash full?\n", written, length);
+        LittleFS.remove(path);
+        return false;
+    }
+
+    rtcState.next_photo_seq++;
+    return true;
+}
+
+static void captureAndStore() {
+    if (!LittleFS.begin(true)) {
+        Serial.println("Duty cycle: LittleFS mount failed, photo skipped");
+        return;
+    }
+
+    // Reuse the preset that worked before sleeping; fall back to full probing
+    if (!configure_camera_preset(RetainedState::getCameraConfigIndex())) {
+        configure_camera();
+        if (activeCameraConfigIndex < 0) {
+            return;
+        }
+    }
+
+    // The first frame after sensor init is usually badly exposed
+    camera_fb_t* warmup = esp_camera_fb_get();
+    if (warmup) {
+        esp_camera_fb_return(warmup);
+    }
+
+    if (take_photo()) {
+        if (storePhoto(fb->buf, fb->len)) {
+            rtcState.photos_captured++;
+            Serial.printf("Duty cycle: stored photo %lu (%u bytes), %u in batch\n",
+                          (unsigned long)rtcState.next_photo_seq - 1, fb->len,
+                          (unsigned)DutyCycleCapture::getStoredPhotoCount());
+        }
+        esp_camera_fb_return(fb);
+        fb = nullptr;
+    }
+
+    esp_camera_deinit();
+}
+
+static void sleepFor(uint32_t sleep_ms) {
+    prepareForSleep();
+    enterDeepSleep(sleep_ms);
+}
+
+// ===================================================================
+// DUTY-CYCLED CAPTURE
+// ===================================================================
+
+namespace DutyCycleCapture {
+    void resumeFromWake() {
+        if (esp_sleep_get_wakeup_cause() != ESP_SLEEP_WAKEUP_TIMER ||
+            rtcState.magic != DUTY_CYCLE_STATE_MAGIC) {
+            // Cold boot or a sleep this module did not schedule. Photos an
+            // earlier batch left behind go out once a client connects.
+            if (LittleFS.begin(true)) {
+                findStoredPhotos();
+                if (getStoredPhotoCount() > 0) {
+                    Serial.printf("Duty cycle: %u photos left from an earlier batch\n",
+                                  (unsigned)getStoredPhotoCount());
+                    flushPending = true;
+                    flushWindowStart = measureStart();
+                }
+            }
+            return;
+        }
+
+        rtcState.wake_count++;
+        flushWake = (rtcState.wake_count % DUTY_CYCLE_FLUSH_EVERY) == 0;
+        Serial.printf("Duty cycle: wake %lu (%s)\n", (unsigned long)rtcState.wake_count,
+                      flushWake ? "flush" : "capture only");
+
+        captureAndStore();
+
+        if (!flushWake) {
+            uint32_t awake_ms = esp_timer_get_time() / 1000;
+            rtcState.capture_wakes++;
+            rtcState.capture_awake_us += esp_timer_get_time();
+            sleepFor(rtcState.interval_ms > awake_ms ? rtcState.interval_ms - awake_ms : TIMING_LONG);
+        }
+
+        // Flush wake: continue the normal boot, keep interval capture running
+        // (the session resumes once the Lifecycle cycle runs, after setup())
+        captureInterval = rtcState.interval_ms;
+        lastCaptureTime = measureStart();
+        DeviceLifecycle::post(LIFECYCLE_EVENT_PHOTO_RESUME);
+        flushPending = true;
+        flushWindowStart = measureStart();
+    }
+
+    bool isActive() {
+        return DeviceLifecycle::isIn(LIFECYCLE_PHOTO) && captureInterval >= DUTY_CYCLE_MIN_INTERVAL_S * 1000;
+    }
+
+    bool isFlushPending() {
+        return flushPending;
+    }
+
+    bool isFlushWake() {
+        return flushWake;
+    }
+
+    bool shouldEnterSleep() {
+        // Never sleep while the next photo is already due
+        // Deep sleep from CAPTURING: not a lifecycle transition, the next boot starts over
+        return isActive() && !DeviceLifecycle::isIn(LIFECYCLE_UPLOADING) && !flushPending &&
+               getElapsedTime(lastCaptureTime) < (unsigned long)captureInterval;
+    }
+
+    void enterSleep() {
+        if (rtcState.magic != DUTY_CYCLE_STATE_MAGIC) {
+            // Arming: fresh accounting. Photos a cancelled batch did not get
+            // to upload stay in the new batch and go out with its first flush.
+            uint32_t first_photo_seq = rtcState.first_photo_seq;
+            uint32_t next_photo_seq = rtcState.next_photo_seq;
+            memset(&rtcState, 0, sizeof(rtcState));
+            rtcState.magic = DUTY_CYCLE_STATE_MAGIC;
+            rtcState.first_photo_seq = first_photo_seq;
+            rtcState.next_photo_seq = next_photo_seq;
+            Serial.printf("Duty cycle: armed, %d s interval, flush every %d wakes, %u photos kept\n",
+                          captureInterval / 1000, DUTY_CYCLE_FLUSH_EVERY, (unsigned)getStoredPhotoCount());
+        }
+
+        rtcState.interval_ms = captureInterval;
+
+        if (flushWake) {
+            rtcState.flush_wakes++;
+            rtcState.flush_awake_us += esp_timer_get_time();
+            printEnergyReport();
+        }
+
+        if (uploadFile) {
+            uploadFile.close();
+        }
+
+        unsigned long elapsed = getElapsedTime(lastCaptureTime);
+        sleepFor(elapsed < rtcState.interval_ms ? rtcState.interval_ms - elapsed : TIMING_LONG);
+    }
+
+    void update() {
+        if (!flushPending) return;
+
+        if (!isConnected()) {
+            // Restart the current photo from the beginning on reconnect
+            if (uploadFile) {
+                uploadFile.close();
+            }
+            if (hasTimedOut(flushWindowStart, DUTY_CYCLE_FLUSH_WINDOW_MS)) {
+                Serial.printf("Duty cycle: no client within %d ms, keeping %u photos\n",
+                              DUTY_CYCLE_FLUSH_WINDOW_MS, (unsigned)getStoredPhotoCount());
+                flushPending = false;
+            }
+            return;
+        }
+
+        // Live photo uploads share the photo characteristic
+        if (DeviceLifecycle::isIn(LIFECYCLE_UPLOADING)) return;
+
+        if (!uploadFile) {
+            if (getStoredPhotoCount() == 0) {
+                Serial.println("Duty cycle: batch upload complete");
+                flushPending = false;
+                return;
+            }
+
+            uploadFile = LittleFS.open(photoPath(rtcState.first_photo_seq), FILE_READ);
+            if (!uploadFile) {
+                Serial.printf("Duty cycle: stored photo %lu missing, skipping\n",
+                              (unsigned long)rtcState.first_photo_seq);
+                rtcState.first_photo_seq++;
+                return;
+            }
+            uploadFrames = 0;
+        }
+
+        // Same framing as the DataTransmission cycle: [frame_lo, frame_hi, type] + data,
+        // on the L2CAP channel if the client opened one
+        static uint8_t frame[PHOTO_FRAME_MAX_SIZE];
+        size_t chunk = uploadFile.read(&frame[BLE_FRAME_HEADER_SIZE], photoFrameChunkSize());
+        if (chunk > 0) {
+            bleWriteFrameHeader(frame, uploadFrames, BLE_FRAME_TYPE_PHOTO);
+            if (!sendPhotoFrame(frame, chunk + BLE_FRAME_HEADER_SIZE)) {
+                // Stalled on credits: read it again next time
+                uploadFile.seek(uploadFile.position() - chunk);
+                return;
+            }
+            uploadFrames++;
+            return;
+        }
+
+        uint8_t endMarker[BLE_FRAME_HEADER_SIZE];
+        bleWriteEndMarker(endMarker, BLE_FRAME_TYPE_PHOTO);
+        if (!sendPhotoFrame(endMarker, sizeof(endMarker))) return;
+
+        Serial.printf("Duty cycle: uploaded stored photo %lu in %u frames\n",
+                      (unsigned long)rtcState.first_photo_seq, (unsigned)uploadFrames);
+
+        uploadFile.close();
+        LittleFS.remove(photoPath(rtcState.first_photo_seq));
+        rtcState.first_photo_seq++;
+    }
+
+    void cancel() {
+        if (rtcState.magic == DUTY_CYCLE_STATE_MAGIC) {
+            Serial.printf("Duty cycle: cancelled by photo control, %u photos still to upload\n",
+                          (unsigned)getStoredPhotoCount());
+        }
+        rtcState.magic = 0;
+    }
+
+    size_t getStoredPhotoCount() {
+        return rtcState.next_photo_seq - rtcState.first_photo_seq;
+    }
+
+    void printEnergyReport() {
+        Serial.println("=== Duty Cycle Energy Report ===");
+        if (rtcState.capture_wakes == 0) {
+            Serial.println("No capture wakes measured yet");
+            Serial.println("================================");
+            return;
+        }
+
+        float interval_ms = rtcState.interval_ms;
+        float capture_awake_ms = rtcState.capture_awake_us / 1000.0 / rtcState.capture_wakes;
+        float flush_awake_ms = rtcState.flush_wakes > 0 ?
+            rtcState.flush_awake_us / 1000.0 / rtcState.flush_wakes : 0;
+
+        float always_on_ma = estimateCurrentConsumption(false, true, false);
+        float flush_ma = estimateCurrentConsumption(false, true, true);
+
+        // Charge per photo in mA*ms; the flush wake is shared by the whole batch
+        float capture_charge = capture_awake_ms * DUTY_CYCLE_CAPTURE_CURRENT_MA +
+                               (interval_ms - capture_awake_ms) * POWER_CONSUMPTION_DEEP_SLEEP;
+        float flush_charge = flush_awake_ms * flush_ma / DUTY_CYCLE_FLUSH_EVERY;
+        float duty_charge = capture_charge + flush_charge;
+        float always_on_charge = interval_ms * always_on_ma;
+
+        Serial.printf("Interval: %lu s, photos captured: %lu, stored: %u\n",
+                      (unsigned long)rtcState.interval_ms / 1000,
+                      (unsigned long)rtcState.photos_captured,
+                      (unsigned)getStoredPhotoCount());
+        Serial.printf("Capture wake: %.0f ms avg over %lu wakes\n",
+                      capture_awake_ms, (unsigned long)rtcState.capture_wakes);
+        Serial.printf("Flush wake: %.0f ms avg over %lu wakes\n",
+                      flush_awake_ms, (unsigned long)rtcState.flush_wakes);
+        Serial.printf("Duty-cycled: %.2f uAh (%.1f mJ) per photo\n",
+                      duty_charge / 3600.0, duty_charge * DUTY_CYCLE_REPORT_VOLTAGE / 1000.0);
+        Serial.printf("Always-on:   %.2f uAh (%.1f mJ) per photo\n",
+                      always_on_charge / 3600.0, always_on_charge * DUTY_CYCLE_REPORT_VOLTAGE / 1000.0);
+        Serial.printf("Energy saving: %.1fx\n", always_on_charge / duty_charge);
+        Serial.println("================================");
+    }
+}
+
+#endif // DUTY_CYCLE_CAPTURE_ENABLED
@@ -0,0 +1,92 @@
+#ifndef DUTY_CYCLE_CAPTURE_H
+#define DUTY_CYCLE_CAPTURE_H
+
+#include <Arduino.h>
+#include "../../hal/constants.h"
+
+// ===================================================================
+// DUTY-CYCLED INTERVAL CAPTURE
+// ===================================================================
+//
+// Opt-in with DUTY_CYCLE_CAPTURE_ENABLED in constants.h. When a client
+// requests a photo interval of at least DUTY_CYCLE_MIN_INTERVAL_S, the
+// device deep sleeps between photos instead of idling with BLE up:
+//
+//   - Timer wakes run a camera-only boot, store the JPEG in flash
+//     (LittleFS) and go straight back to sleep.
+//   - Every DUTY_CYCLE_FLUSH_EVERY wakes the device boots fully,
+//     advertises for DUTY_CYCLE_FLUSH_WINDOW_MS and uploads the stored
+//     batch over the photo characteristic using the normal framing.
+//   - A stop, a single shot or an interval below the threshold written
+//     during a flush wake cancels the mode; skipping an upload or
+//     opening the bulk channel does not.
+//
+// Audio is not captured while duty-cycled.
+//
+
+#ifdef DUTY_CYCLE_CAPTURE_ENABLED
+
+namespace DutyCycleCapture {
+    /**
+     * Handle a timer wake from a duty-cycled sleep. Call early in setup().
+     * Capture-only wakes do not return: the device goes back to sleep.
+     * Returns on cold boots and on flush wakes, where setup() continues.
+     * A cold boot finds stored photos by their file names and uploads
+     * them once a client connects.
+     */
+    void resumeFromWake();
+
+    /**
+     * Check whether the current photo settings qualify for duty-cycling
+     * @return true if interval capture is long enough to sleep between photos
+     */
+    bool isActive();
+
+    /**
+     * Check whether a flush wake is still waiting for or uploading the batch
+     */
+    bool isFlushPending();
+
+    /**
+     * Check whether this boot is a flush wake. Its photo is already
+     * taken and the interval session resumed from the duty-cycle state.
+     */
+    bool isFlushWake();
+
+    /**
+     * Check whether the device can go to sleep until the next photo
+     */
+    bool shouldEnterSleep();
+
+    /**
+     * Save state and deep sleep until the next photo is due (does not return)
+     */
+    void enterSleep();
+
+    /**
+     * Advance the batch upload by one chunk (call from the cycle manager)
+     */
+    void update();
+
+    /**
+     * Leave duty-cycled mode and forget the retained accounting.
+     * Stored photos stay in flash: a flush in progress carries on, and
+     * whatever is left goes out after the next boot (or with the first
+     * flush if the mode is armed again).
+     */
+    void cancel();
+
+    /**
+     * Get the number of photos waiting in flash
+     */
+    size_t getStoredPhotoCount();
+
+    /**
+     * Print measured energy per photo versus always-on interval capture
+     */
+    void printEnergyReport();
+}
+
+#endif // DUTY_CYCLE_CAPTURE_ENABLED
+
+#endif // DUTY_CYCLE_CAPTURE_H
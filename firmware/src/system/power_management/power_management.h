@@ -7,6 +7,9 @@
 #include <esp_wifi.h>
 #include <esp_bt.h>
 #include "../../hal/xiao_esp32s3_constants.h"
+#include "retained_state.h"
+#include "../clock/timing.h"
+#include "../clock/profiler.h"
 
 // ===================================================================
 // POWER MANAGEMENT UTILITIES
@@ -46,14 +49,14 @@ typedef struct {
     float voltage;             // Battery voltage
     float current_ma;          // Estimated current consumption in mA
     float power_mw;            // Estimated power consumption in mW
-    unsigned long timestamp;   // Timestamp of measurement
+    uint64_t timestamp_ms;     // Timestamp of measurement (monotonicMillis())
     power_mode_t mode;         // Current power mode
 } power_stats_t;
 
 // Global power statistics - defined only once
 #ifndef POWER_MANAGEMENT_GLOBALS_DEFINED
 #define POWER_MANAGEMENT_GLOBALS_DEFINED
-static power_stats_t currentPowerStats = {0};
+static power_stats_t currentPowerStats = {};
 static power_mode_t currentPowerMode = POWER_MODE_BALANCED;
 #endif
 
@@ -189,6 +192,9 @@ static inline void setPowerMode(power_mode_t mode) {
             Serial.println("Power mode: ULTRA_LOW");
             break;
     }
+    
+    // CCOUNT follows the CPU clock
+    Profiler::onCpuFrequencyChange();
 }
 
 /**
@@ -252,7 +258,7 @@ static inline void updatePowerStats(float battery_voltage, bool wifi_active = fa
     currentPowerStats.voltage = battery_voltage;
     currentPowerStats.current_ma = estimateCurrentConsumption(wifi_active, ble_active, camera_active);
     currentPowerStats.power_mw = currentPowerStats.voltage * currentPowerStats.current_ma;
-    currentPowerStats.timestamp = millis();
+    currentPowerStats.timestamp_ms = monotonicMillis();
     currentPowerStats.mode = currentPowerMode;
 }
 
@@ -277,7 +283,7 @@ static inline void printPowerStats() {
         currentPowerMode == POWER_MODE_PERFORMANCE ? "PERFORMANCE" :
         currentPowerMode == POWER_MODE_BALANCED ? "BALANCED" :
         currentPowerMode == POWER_MODE_POWER_SAVE ? "POWER_SAVE" : "ULTRA_LOW");
-    Serial.printf("Timestamp: %lu ms\n", currentPowerStats.timestamp);
+    Serial.printf("Timestamp: %llu ms\n", (unsigned long long)currentPowerStats.timestamp_ms);
     Serial.println("========================");
 }
 
@@ -355,25 +361,25 @@ static inline bool shouldEnterPowerSaving(uint8_t battery_level, unsigned long i
 
 /**
  * Prepare for sleep mode
- * Saves current state and configures wake-up sources
+ * Saves camera, BLE, codec and cycle state to RTC memory for fast resume
  */
 static inline void prepareForSleep() {
-    // Flush serial output
-    Serial.flush();
-    
-    // Save current power mode
-    // (This would be expanded to save more state as needed)
+    // Save retained state (survives light and deep sleep)
+    RetainedState::save();
     
     Serial.println("Device prepared for sleep");
+    
+    // Flush serial output
+    Serial.flush();
 }
 
 /**
  * Wake up from sleep mode
- * Restores state and re-initializes peripherals
+ * Light sleep keeps RAM, so only wake latency measurement restarts here;
+ * deep sleep wakes are restored by RetainedState::restore() in setup()
  */
 static inline void wakeFromSleep() {
-    // Restore power mode
-    // (This would be expanded to restore more state as needed)
+    RetainedState::markWake();
     
     Serial.println("Device woke from sleep");
     
@@ -0,0 +1,255 @@
+#include "retained_state.h"
+#include <esp_sleep.h>
+#include <esp_timer.h>
+#include <esp_rom_crc.h>
+#include <sys/time.h>
+#include "../clock/timing.h"
+#include "duty_cycle_capture.h"
+#include "../../hal/constants.h"
+#include "../../features/camera/camera.h"
+#include "../../features/bluetooth/ble_server.h"
+#include "../../features/bluetooth/ble_data_handler.h"
+#include "../../status/device_lifecycle.h"
+
+// External variables
+extern bool bleConnected;
+
+RTC_DATA_ATTR static retained_state_t block;
+
+// This boot only
+static bool warmBoot = false;
+static int64_t wakeUs = 0;
+static bool photoPending = false;
+static bool audioPending = false;
+
+// ===================================================================
+// HELPERS
+// ===================================================================
+
+static uint32_t blockCrc() {
+    return esp_rom_crc32_le(0, (const uint8_t*)&block, offsetof(retained_state_t, crc));
+}
+
+static bool blockValid() {
+    return block.magic == RETAINED_STATE_MAGIC &&
+           block.version == RETAINED_STATE_VERSION &&
+           block.size == sizeof(retained_state_t) &&
+           block.crc == blockCrc();
+}
+
+static int64_t wallClockUs() {
+    // System time keeps running on the RTC timer during deep sleep
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+static uint32_t hashName(const char* name) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    while (*name) {
+        hash ^= (uint8_t)*name++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static uint32_t clampElapsed(uint32_t since_last_ms, uint32_t asleep_ms, uint32_t period_ms) {
+    uint64_t elapsed = (uint64_t)since_last_ms + asleep_ms;
+    return elapsed > period_ms ? period_ms : (uint32_t)elapsed;
+}
+
+// ===================================================================
+// RETAINED STATE
+// ===================================================================
+
+namespace RetainedState {
+    void begin() {
+        bool valid = blockValid();
+        warmBoot = valid && esp_sleep_get_wakeup_cause() != ESP_SLEEP_WAKEUP_UNDEFINED;
+
+        if (!valid) {
+            memset(&block, 0, sizeof(block));
+            block.magic = RETAINED_STATE_MAGIC;
+            block.version = RETAINED_STATE_VERSION;
+            block.size = sizeof(retained_state_t);
+            block.camera_config_index = -1;
+        }
+
+        if (warmBoot) {
+            block.warm_boots++;
+        }
+
+        // Boot is the wake; esp_timer starts at zero
+        wakeUs = 0;
+        photoPending = true;
+        audioPending = true;
+
+        Serial.printf("Retained state: %s boot\n", warmBoot ? "warm" : "cold");
+    }
+
+    bool isWarmBoot() {
+        return warmBoot;
+    }
+
+    int getCameraConfigIndex() {
+        return block.camera_config_index;
+    }
+
+    void save() {
+        // The camera preset is kept by camera-only wakes as well
+        if (activeCameraConfigIndex >= 0) {
+            block.camera_config_index = activeCameraConfigIndex;
+        }
+
+        // Everything else only once setup() has brought the modules up
+        if (DeviceLifecycle::isReady()) {
+            unsigned long now = measureStart();
+            uint64_t now_us = monotonicMicros();
+
+            block.capturing_photos = DeviceLifecycle::isIn(LIFECYCLE_PHOTO);
+            block.capture_interval_ms = captureInterval;
+            block.since_last_photo_ms = now - lastCaptureTime;
+
+            if (bleConnected) {
+                block.peer_mtu = BleTransport::peerMtu();
+            }
+
+            block.codec_id = CODEC_ID;
+            block.audio_frame_count = audioFrameCount;
+
+            block.cycle_count = 0;
+            for (size_t i = 0; i < MAX_CYCLES; i++) {
+                if (!cycles[i].registered) continue;
+                retained_cycle_t* saved = &block.cycles[block.cycle_count++];
+                saved->name_hash = hashName(cycles[i].config.name);
+                uint64_t since_last_ms = (now_us - cycles[i].runtime.last_execution_us) / 1000ULL;
+                saved->since_last_ms = since_last_ms > UINT32_MAX ? UINT32_MAX : (uint32_t)since_last_ms;
+                saved->execution_count = cycles[i].runtime.execution_count;
+                saved->error_count = cycles[i].runtime.error_count;
+            }
+
+            block.saved_at_us = wallClockUs();
+        }
+
+        block.crc = blockCrc();
+    }
+
+    void restore() {
+        if (!warmBoot || block.saved_at_us == 0) {
+            return;
+        }
+
+        int64_t asleep_us = wallClockUs() - block.saved_at_us;
+        uint32_t asleep_ms = asleep_us > 0 ? (uint32_t)(asleep_us / 1000) : 0;
+        unsigned long now = measureStart();
+        uint64_t now_us = monotonicMicros();
+
+        // Interval cycles keep their phase; anything overdue runs right away
+        size_t restored = 0;
+        for (size_t i = 0; i < MAX_CYCLES; i++) {
+            if (!cycles[i].registered) continue;
+            uint32_t hash = hashName(cycles[i].config.name);
+            for (size_t j = 0; j < block.cycle_count; j++) {
+                const retained_cycle_t* saved = &block.cycles[j];
+                if (saved->name_hash != hash) continue;
+
+                uint32_t period = cycles[i].config.mode == CYCLE_MODE_TIMEOUT ?
+                                  cycles[i].config.timeout_ms : cycles[i].config.interval_ms;
+                uint64_t elapsed_us = (uint64_t)clampElapsed(saved->since_last_ms, asleep_ms, period) * 1000ULL;
+                cycles[i].runtime.last_execution_us = now_us > elapsed_us ? now_us - elapsed_us : 0;
+                cycles[i].runtime.next_execution_us = now_us + (uint64_t)period * 1000ULL - elapsed_us;
+                cycles[i].runtime.execution_count = saved->execution_count;
+                cycles[i].runtime.error_count = saved->error_count;
+                restored++;
+                break;
+            }
+        }
+
+        // A flush wake has taken this interval's photo and resumed the
+        // session itself; the block is as old as the last full boot
+        bool sessionResumed = false;
+#ifdef DUTY_CYCLE_CAPTURE_ENABLED
+        sessionResumed = DutyCycleCapture::isFlushWake();
+#endif
+
+        if (!sessionResumed && block.capturing_photos && block.capture_interval_ms > 0) {
+            captureInterval = block.capture_interval_ms;
+            lastCaptureTime = now - clampElapsed(block.since_last_photo_ms, asleep_ms, captureInterval);
+            DeviceLifecycle::dispatch(LIFECYCLE_EVENT_PHOTO_RESUME);
+        }
+
+        if (block.codec_id == CODEC_ID) {
+            audioFrameCount = block.audio_frame_count;
+        }
+
+        Serial.printf("Retained state: restored %u/%u cycles after %lu ms asleep\n",
+                      (unsigned)restored, (unsigned)cycle_count, (unsigned long)asleep_ms);
+    }
+
+    void markWake() {
+        wakeUs = esp_timer_get_time();
+        photoPending = true;
+        audioPending = true;
+    }
+
+    void notePhotoCaptured() {
+        if (!photoPending) return;
+        photoPending = false;
+
+        uint32_t latency = esp_timer_get_time() - wakeUs;
+        block.timing.wake_to_photo_us[warmBoot ? 1 : 0] = latency;
+        Serial.printf("Resume: first photo %.1f ms after wake (%s)\n",
+                      latency / 1000.0, warmBoot ? "warm" : "cold");
+    }
+
+    void noteAudioFrame() {
+        if (!audioPending) return;
+        audioPending = false;
+
+        uint32_t latency = esp_timer_get_time() - wakeUs;
+        block.timing.wake_to_audio_us[warmBoot ? 1 : 0] = latency;
+        Serial.printf("Resume: first audio frame %.1f ms after wake (%s)\n",
+                      latency / 1000.0, warmBoot ? "warm" : "cold");
+    }
+
+    void recordPeer(const uint8_t* address, uint16_t interval, uint16_t latency, uint16_t timeout) {
+        memcpy(block.peer_address, address, sizeof(block.peer_address));
+        block.conn_interval = interval;
+        block.conn_latency = latency;
+        block.supervision_timeout = timeout;
+        block.peer_valid = true;
+    }
+
+    bool isRetainedPeer(const uint8_t* address) {
+        return block.peer_valid && block.conn_interval > 0 &&
+               memcmp(block.peer_address, address, sizeof(block.peer_address)) == 0;
+    }
+
+    const retained_state_t* get() {
+        return &block;
+    }
+
+    void printStatus() {
+        Serial.println("=== Retained State ===");
+        Serial.printf("Boot: %s, warm boots: %lu\n", warmBoot ? "warm" : "cold",
+                      (unsigned long)block.warm_boots);
+        Serial.printf("Camera preset: %d\n", block.camera_config_index);
+        Serial.printf("Photo schedule: %s, interval %ld ms\n",
+                      block.capturing_photos ? "on" : "off", (long)block.capture_interval_ms);
+        if (block.peer_valid) {
+            Serial.printf("Peer: %02x:%02x:%02x:%02x:%02x:%02x, MTU %u, interval %.2f ms, latency %u, timeout %u ms\n",
+                          block.peer_address[0], block.peer_address[1], block.peer_address[2],
+                          block.peer_address[3], block.peer_address[4], block.peer_address[5],
+                          block.peer_mtu, block.conn_interval * 1.25, block.conn_latency,
+                          block.supervision_timeout * 10);
+        }
+        Serial.printf("Codec: %u, audio frame: %u, cycles: %u\n",
+                      block.codec_id, block.audio_frame_count, block.cycle_count);
+        Serial.printf("Wake to first photo: cold %.1f ms, warm %.1f ms\n",
+                      block.timing.wake_to_photo_us[0] / 1000.0, block.timing.wake_to_photo_us[1] / 1000.0);
+        Serial.printf("Wake to first audio: cold %.1f ms, warm %.1f ms\n",
+                      block.timing.wake_to_audio_us[0] / 1000.0, block.timing.wake_to_audio_us[1] / 1000.0);
+        Serial.println("======================");
+    }
+}
@@ -0,0 +1,149 @@
+#ifndef RETAINED_STATE_H
+#define RETAINED_STATE_H
+
+#include <Arduino.h>
+#include "../cycles/cycle_manager.h"
+
+// ===================================================================
+// RETAINED STATE (FAST RESUME)
+// ===================================================================
+//
+// A single block in RTC slow memory that survives light and deep sleep.
+// It is filled by prepareForSleep() and validated at the start of
+// setup(). A valid block after a sleep wake makes the boot "warm":
+//
+//   - the camera is brought up with the last working preset instead of
+//     probing the fallback list, and the test photo is skipped
+//   - the microphone skips its I2S self-test read
+//   - interval cycles, the photo schedule and the audio frame counter
+//     continue where they left off (time asleep is taken into account)
+//   - the last peer's connection parameters are requested again as
+//     soon as that peer reconnects
+//
+// Cold boots (power-on, reset, reflash) always take the full path.
+//
+
+#define RETAINED_STATE_MAGIC 0x4F475253     // "OGRS"
+#define RETAINED_STATE_VERSION 1
+
+/**
+ * Saved schedule of one registered cycle, matched by name on restore
+ */
+typedef struct {
+    uint32_t name_hash;
+    uint32_t since_last_ms;         // Time since last execution when saved
+    uint32_t execution_count;
+    uint32_t error_count;
+} retained_cycle_t;
+
+/**
+ * Wake latency measurements (index 0 = cold boot, 1 = warm boot)
+ */
+typedef struct {
+    uint32_t wake_to_photo_us[2];
+    uint32_t wake_to_audio_us[2];
+} resume_timing_t;
+
+/**
+ * Retained state block
+ */
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;
+    uint32_t warm_boots;
+    int64_t saved_at_us;            // gettimeofday() when saved (keeps running in deep sleep)
+
+    // Camera
+    int8_t camera_config_index;
+
+    // Photo schedule
+    bool capturing_photos;
+    int32_t capture_interval_ms;
+    uint32_t since_last_photo_ms;
+
+    // BLE
+    bool peer_valid;
+    uint8_t peer_address[6];
+    uint16_t peer_mtu;
+    uint16_t conn_interval;         // 1.25 ms units
+    uint16_t conn_latency;
+    uint16_t supervision_timeout;   // 10 ms units
+
+    // Audio
+    uint8_t codec_id;
+    uint16_t audio_frame_count;
+
+    // Cycle schedules and counters
+    uint8_t cycle_count;
+    retained_cycle_t cycles[MAX_CYCLES];
+
+    resume_timing_t timing;
+    uint32_t crc;
+} retained_state_t;
+
+namespace RetainedState {
+    /**
+     * Validate the block and start wake latency measurement.
+     * Call at the very start of setup().
+     */
+    void begin();
+
+    /**
+     * Check whether this boot resumed from sleep with a valid block
+     * @return true if discovery and fallback logic can be skipped
+     */
+    bool isWarmBoot();
+
+    /**
+     * Get the retained camera preset
+     * @return Index into the camera config table or -1 if unknown
+     */
+    int getCameraConfigIndex();
+
+    /**
+     * Capture current module state into RTC memory (called by prepareForSleep)
+     */
+    void save();
+
+    /**
+     * Apply retained schedules and counters. Call after all cycles
+     * have been registered. The photo session is left alone on a
+     * duty-cycled flush wake, which resumes it itself.
+     */
+    void restore();
+
+    /**
+     * Restart wake latency measurement after a light sleep
+     */
+    void markWake();
+
+    /**
+     * Record the first photo / audio frame after a wake
+     */
+    void notePhotoCaptured();
+    void noteAudioFrame();
+
+    /**
+     * Remember the connected peer and its connection parameters
+     */
+    void recordPeer(const uint8_t* address, uint16_t interval, uint16_t latency, uint16_t timeout);
+
+    /**
+     * Check whether a connecting peer is the one retained from before sleep
+     * @return true if its connection parameters can be requested again
+     */
+    bool isRetainedPeer(const uint8_t* address);
+
+    /**
+     * Get the retained state block (read-only)
+     */
+    const retained_state_t* get();
+
+    /**
+     * Print retained state and wake latency measurements
+     */
+    void printStatus();
+}
+
+#endif // RETAINED_STATE_H
@@ -13,12 +13,11 @@ uint8_t DebugLogger::timing_entry_count = 0;
 unsigned long DebugLogger::total_timing_operations = 0;
 
 // Memory tracking
-MemorySample DebugLogger::memory_samples[10];
-uint8_t DebugLogger::memory_sample_count = 0;
-unsigned long DebugLogger::last_memory_sample = 0;
+RingBuffer<MemorySample, MEMORY_SAMPLE_HISTORY> DebugLogger::memory_samples;
+uint64_t DebugLogger::last_memory_sample_ms = 0;
 
 // Performance monitoring
-unsigned long DebugLogger::last_performance_report = 0;
+uint64_t DebugLogger::last_performance_report_ms = 0;
 unsigned long DebugLogger::total_debug_messages = 0;
 unsigned long DebugLogger::total_debug_bytes = 0;
 
@@ -35,27 +34,21 @@ void DebugLogger::initialize(uint8_t categories) {
     // Reset counters
     timing_entry_count = 0;
     total_timing_operations = 0;
-    memory_sample_count = 0;
-    last_memory_sample = 0;
-    last_performance_report = millis();
+    last_memory_sample_ms = 0;
+    last_performance_report_ms = monotonicMillis();
     total_debug_messages = 0;
     total_debug_bytes = 0;
     
     // Initialize timing entries
     for (int i = 0; i < MAX_TIMING_ENTRIES; i++) {
         timing_entries[i].operation = nullptr;
-        timing_entries[i].start_time = 0;
-        timing_entries[i].duration = 0;
+        timing_entries[i].start_us = 0;
+        timing_entries[i].duration_us = 0;
         timing_entries[i].active = false;
     }
     
     // Initialize memory samples
-    for (int i = 0; i < 10; i++) {
-        memory_samples[i].timestamp = 0;
-        memory_samples[i].free_heap = 0;
-        memory_samples[i].free_psram = 0;
-        memory_samples[i].largest_free_block = 0;
-    }
+    memory_samples.clear();
     
     SerialManager::info("Debug Logger initialized", MODULE_SYSTEM);
 }
@@ -296,10 +289,9 @@ void DebugLogger::logTimingf(const char* format, ...) {
 // TIMING AND PERFORMANCE MONITORING
 // ===================================================================
 
-unsigned long DebugLogger::startTiming(const char* operation) {
-    if (!timing_enabled) return millis();
-    
-    unsigned long start_time = millis();
+uint64_t DebugLogger::startTiming(const char* operation) {
+    uint64_t start_us = monotonicMicros();
+    if (!timing_enabled) return start_us;
     
     // Find or create timing entry
     int index = findTimingEntry(operation);
@@ -309,40 +301,39 @@ unsigned long DebugLogger::startTiming(const char* operation) {
     }
     
     if (index != -1) {
-        timing_entries[index].start_time = start_time;
+        timing_entries[index].start_us = start_us;
         timing_entries[index].active = true;
     }
     
-    return start_time;
+    return start_us;
 }
 
-void DebugLogger::endTiming(unsigned long start_time, const char* operation) {
+void DebugLogger::endTiming(uint64_t start_us, const char* operation) {
     if (!timing_enabled) return;
     
-    unsigned long end_time = millis();
-    unsigned long duration = end_time - start_time;
+    uint64_t duration_us = elapsedMicros(start_us);
     
     // Update timing entry
     int index = findTimingEntry(operation);
     if (index != -1) {
-        timing_entries[index].duration = duration;
+        timing_entries[index].duration_us = duration_us;
         timing_entries[index].active = false;
     }
     
-    logTimingResult(operation, duration);
+    logTimingResult(operation, duration_us);
     total_timing_operations++;
 }
 
-void DebugLogger::logTimingResult(const char* operation, unsigned long duration) {
+void DebugLogger::logTimingResult(const char* operation, uint64_t duration_us) {
     if (timing_enabled && (debug_categories & DEBUG_TIMING)) {
-        SerialManager::debugf(MODULE_SYSTEM, "⏱️ %s: %lu ms", operation, duration);
+        SerialManager::debugf(MODULE_SYSTEM, "⏱️ %s: %.3f ms", operation, duration_us / 1000.0);
     }
 }
 
 void DebugLogger::measureOperation(const char* operation, void (*func)()) {
     if (!func) return;
     
-    unsigned long start = startTiming(operation);
+    uint64_t start = startTiming(operation);
     func();
     endTiming(start, operation);
 }
@@ -350,7 +341,7 @@ void DebugLogger::measureOperation(const char* operation, void (*func)()) {
 void DebugLogger::measureOperationWithResult(const char* operation, bool (*func)(), bool& result) {
     if (!func) return;
     
-    unsigned long start = startTiming(operation);
+    uint64_t start = startTiming(operation);
     result = func();
     endTiming(start, operation);
 }
@@ -420,7 +411,7 @@ void DebugLogger::dumpSystemInfo() {
     SerialManager::infof(MODULE_SYSTEM, "CPU Frequency: %lu MHz", ESP.getCpuFreqMHz());
     SerialManager::infof(MODULE_SYSTEM, "Flash Size: %lu KB", ESP.getFlashChipSize() / 1024);
     SerialManager::infof(MODULE_SYSTEM, "PSRAM Size: %lu KB", ESP.getPsramSize() / 1024);
-    SerialManager::infof(MODULE_SYSTEM, "Uptime: %lu ms", millis());
+    SerialManager::infof(MODULE_SYSTEM, "Uptime: %llu ms", (unsigned long long)monotonicMillis());
     
     SerialManager::printSeparator();
 }
@@ -462,9 +453,9 @@ void DebugLogger::dumpTimingInfo() {
     
     for (int i = 0; i < timing_entry_count; i++) {
         if (timing_entries[i].operation) {
-            SerialManager::infof(MODULE_SYSTEM, "  %s: %lu ms %s",
+            SerialManager::infof(MODULE_SYSTEM, "  %s: %.3f ms %s",
                                timing_entries[i].operation,
-                               timing_entries[i].duration,
+                               timing_entries[i].duration_us / 1000.0,
                                timing_entries[i].active ? "(active)" : "");
         }
     }
@@ -480,12 +471,12 @@ void DebugLogger::dumpPerformanceInfo() {
     SerialManager::infof(MODULE_SYSTEM, "Debug messages sent: %lu", total_debug_messages);
     SerialManager::infof(MODULE_SYSTEM, "Debug bytes sent: %lu", total_debug_bytes);
     
-    unsigned long uptime = millis();
-    if (uptime > 0) {
+    uint64_t uptime_ms = monotonicMillis();
+    if (uptime_ms > 0) {
         SerialManager::infof(MODULE_SYSTEM, "Messages per second: %.2f", 
-                           (float)total_debug_messages / (uptime / 1000.0));
+                           (float)total_debug_messages / (uptime_ms / 1000.0));
         SerialManager::infof(MODULE_SYSTEM, "Bytes per second: %.2f", 
-                           (float)total_debug_bytes / (uptime / 1000.0));
+                           (float)total_debug_bytes / (uptime_ms / 1000.0));
     }
     
     SerialManager::printSeparator();
@@ -566,20 +557,20 @@ void DebugLogger::update() {
 void DebugLogger::periodicMemoryCheck() {
     if (!memory_tracking_enabled) return;
     
-    unsigned long current_time = millis();
-    if (current_time - last_memory_sample >= MEMORY_SAMPLE_INTERVAL_MS) {
+    uint64_t current_time_ms = monotonicMillis();
+    if (current_time_ms - last_memory_sample_ms >= MEMORY_SAMPLE_INTERVAL_MS) {
         addMemorySample();
-        last_memory_sample = current_time;
+        last_memory_sample_ms = current_time_ms;
     }
 }
 
 void DebugLogger::periodicPerformanceReport() {
     if (!performance_monitoring_enabled) return;
     
-    unsigned long current_time = millis();
-    if (current_time - last_performance_report >= PERFORMANCE_REPORT_INTERVAL_MS) {
+    uint64_t current_time_ms = monotonicMillis();
+    if (current_time_ms - last_performance_report_ms >= PERFORMANCE_REPORT_INTERVAL_MS) {
         reportPerformanceMetrics();
-        last_performance_report = current_time;
+        last_performance_report_ms = current_time_ms;
     }
 }
 
@@ -659,19 +650,13 @@ int DebugLogger::findTimingEntry(const char* operation) {
 }
 
 void DebugLogger::addMemorySample() {
-    if (memory_sample_count >= 10) {
-        // Shift samples down
-        for (int i = 0; i < 9; i++) {
-            memory_samples[i] = memory_samples[i + 1];
-        }
-        memory_sample_count = 9;
-    }
-    
-    MemorySample& sample = memory_samples[memory_sample_count++];
-    sample.timestamp = millis();
+    // The oldest sample is dropped once the history is full
+    MemorySample sample;
+    sample.timestamp_ms = monotonicMillis();
     sample.free_heap = ESP.getFreeHeap();
     sample.free_psram = ESP.getFreePsram();
     sample.largest_free_block = ESP.getMaxAllocHeap();
+    memory_samples.pushOverwrite(sample);
 }
 
 void DebugLogger::reportPerformanceMetrics() {
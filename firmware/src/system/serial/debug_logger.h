@@ -3,6 +3,8 @@
 
 #include <Arduino.h>
 #include "serial_manager.h"
+#include "../clock/timing.h"
+#include "../memory/ring_buffer.h"
 
 // Debug categories for filtering
 #define DEBUG_NONE       0x00
@@ -19,19 +21,20 @@
 // Performance monitoring constants
 #define MAX_TIMING_ENTRIES 20
 #define MEMORY_SAMPLE_INTERVAL_MS 5000
+#define MEMORY_SAMPLE_HISTORY 16        // Power of two: 80 s of samples
 #define PERFORMANCE_REPORT_INTERVAL_MS 30000
 
-// Timing entry structure
+// Timing entry structure (monotonicMicros())
 struct TimingEntry {
     const char* operation;
-    unsigned long start_time;
-    unsigned long duration;
+    uint64_t start_us;
+    uint64_t duration_us;
     bool active;
 };
 
 // Memory sample structure
 struct MemorySample {
-    unsigned long timestamp;
+    uint64_t timestamp_ms;      // monotonicMillis()
     size_t free_heap;
     size_t free_psram;
     size_t largest_free_block;
@@ -50,12 +53,11 @@ private:
     static unsigned long total_timing_operations;
     
     // Memory tracking
-    static MemorySample memory_samples[10];
-    static uint8_t memory_sample_count;
-    static unsigned long last_memory_sample;
+    static RingBuffer<MemorySample, MEMORY_SAMPLE_HISTORY> memory_samples;
+    static uint64_t last_memory_sample_ms;
     
     // Performance monitoring
-    static unsigned long last_performance_report;
+    static uint64_t last_performance_report_ms;
     static unsigned long total_debug_messages;
     static unsigned long total_debug_bytes;
     
@@ -109,9 +111,9 @@ public:
     // TIMING AND PERFORMANCE MONITORING
     // ===================================================================
     
-    static unsigned long startTiming(const char* operation);
-    static void endTiming(unsigned long start_time, const char* operation);
-    static void logTimingResult(const char* operation, unsigned long duration);
+    static uint64_t startTiming(const char* operation);
+    static void endTiming(uint64_t start_us, const char* operation);
+    static void logTimingResult(const char* operation, uint64_t duration_us);
     
     static void measureOperation(const char* operation, void (*func)());
     static void measureOperationWithResult(const char* operation, bool (*func)(), bool& result);
@@ -196,13 +198,15 @@ public:
 // ===================================================================
 // TIMING MEASUREMENT MACROS
 // ===================================================================
+// These look entries up by name and log every result; for hot paths use
+// PROFILE_SCOPE (system/clock/profiler.h)
 
-#define DEBUG_TIME_START(operation) unsigned long __debug_start_##operation = DebugLogger::startTiming(#operation)
+#define DEBUG_TIME_START(operation) uint64_t __debug_start_##operation = DebugLogger::startTiming(#operation)
 #define DEBUG_TIME_END(operation) DebugLogger::endTiming(__debug_start_##operation, #operation)
 
 #define DEBUG_TIME_BLOCK(operation, block) \
     do { \
-        unsigned long __start = DebugLogger::startTiming(operation); \
+        uint64_t __start = DebugLogger::startTiming(operation); \
         block; \
         DebugLogger::endTiming(__start, operation); \
     } while(0)
@@ -155,12 +155,12 @@ public:
     }
     
     // Timing measurements
-    static unsigned long startTiming(const char* operation) {
+    static uint64_t startTiming(const char* operation) {
         return DebugLogger::startTiming(operation);
     }
     
-    static void endTiming(unsigned long start_time, const char* operation) {
-        DebugLogger::endTiming(start_time, operation);
+    static void endTiming(uint64_t start_us, const char* operation) {
+        DebugLogger::endTiming(start_us, operation);
     }
     
     // Memory tracking
@@ -297,7 +297,7 @@ RECOMMENDED USAGE:
 
 3. For performance monitoring:
    ```cpp
-   unsigned long start = SerialSystem::startTiming("operation");
+   uint64_t start = SerialSystem::startTiming("operation");
    // ... do work ...
    SerialSystem::endTiming(start, "operation");
    ```
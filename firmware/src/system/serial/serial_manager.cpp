@@ -1,11 +1,12 @@
 #include "serial_manager.h"
 #include "../../hal/xiao_esp32s3_constants.h"
+#include "../clock/timing.h"
 #include <stdarg.h>
 
 // Static member definitions
 bool SerialManager::initialized = false;
 LogLevel SerialManager::current_log_level = LOG_LEVEL_INFO;
-unsigned long SerialManager::last_performance_report = 0;
+uint64_t SerialManager::last_performance_report_ms = 0;
 unsigned long SerialManager::total_bytes_sent = 0;
 unsigned long SerialManager::message_count = 0;
 
@@ -29,7 +30,7 @@ bool SerialManager::initialize(unsigned long baud_rate) {
     initialized = true;
     total_bytes_sent = 0;
     message_count = 0;
-    last_performance_report = millis();
+    last_performance_report_ms = monotonicMillis();
     
     // Print initialization message
     printHeader("Serial Manager Initialized");
@@ -69,8 +70,8 @@ void SerialManager::printLogPrefix(LogLevel level, const char* module) {
     if (!initialized) return;
     
     // Timestamp
-    unsigned long timestamp = millis();
-    Serial.printf("[%8lu] ", timestamp);
+    uint64_t timestamp_ms = monotonicMillis();
+    Serial.printf("[%8llu] ", (unsigned long long)timestamp_ms);
     
     // Log level
     const char* level_str = getLogLevelString(level);
@@ -255,13 +256,13 @@ void SerialManager::verbosef(const char* module, const char* format, ...) {
 void SerialManager::reportPerformance() {
     if (!initialized) return;
     
-    unsigned long current_time = millis();
-    unsigned long elapsed = current_time - last_performance_report;
+    uint64_t current_time_ms = monotonicMillis();
+    uint64_t elapsed_ms = current_time_ms - last_performance_report_ms;
     
-    if (elapsed >= 30000) { // Report every 30 seconds
-        infof(MODULE_SYSTEM, "Performance: %lu messages, %lu bytes in %lu ms", 
-              message_count, total_bytes_sent, elapsed);
-        last_performance_report = current_time;
+    if (elapsed_ms >= 30000) { // Report every 30 seconds
+        infof(MODULE_SYSTEM, "Performance: %lu messages, %lu bytes in %llu ms", 
+              message_count, total_bytes_sent, (unsigned long long)elapsed_ms);
+        last_performance_report_ms = current_time_ms;
     }
 }
 
@@ -37,7 +37,7 @@ class SerialManager {
 private:
     static bool initialized;
     static LogLevel current_log_level;
-    static unsigned long last_performance_report;
+    static uint64_t last_performance_report_ms;
     static unsigned long total_bytes_sent;
     static unsigned long message_count;
     
@@ -0,0 +1,363 @@
+#ifndef HSM_H
+#define HSM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../memory/ring_buffer.h"
+
+// ===================================================================
+// HIERARCHICAL STATE MACHINE
+// ===================================================================
+//
+// Table-driven state machine with nested states. A machine is two
+// constant tables, indexed by state and by event:
+//
+//   static const hsm_state_t STATES[STATE_COUNT] = {
+//       // name       parent         entry        exit
+//       {"OFF",      HSM_NO_STATE,  nullptr,     nullptr},
+//       {"ON",       HSM_NO_STATE,  powerUp,     powerDown},   // Superstate
+//       {"DIM",      STATE_ON,      nullptr,     nullptr},
+//       {"BRIGHT",   STATE_ON,      nullptr,     nullptr},
+//   };
+//   static const hsm_transition_t TRANSITIONS[STATE_COUNT][EVENT_COUNT] = {
+//       //            SWITCH                 BUTTON
+//       /* OFF */    {hsmGo(STATE_DIM),      HSM_UNHANDLED_CELL},
+//       /* ON */     {hsmGo(STATE_OFF),      HSM_UNHANDLED_CELL},
+//       /* DIM */    {HSM_UNHANDLED_CELL,    hsmGo(STATE_BRIGHT)},
+//       /* BRIGHT */ {HSM_UNHANDLED_CELL,    hsmGo(STATE_DIM)},
+//   };
+//   static HierarchicalStateMachine<STATE_COUNT, EVENT_COUNT, 8> machine(STATES, TRANSITIONS, STATE_OFF);
+//
+// Only leaf states are ever current; a superstate groups its leaves for
+// isIn() and supplies the cells they leave unhandled (SWITCH above turns
+// off from DIM and BRIGHT alike). The fallback is resolved once in the
+// constructor, so dispatch() is a single table lookup, and isIn() is a
+// bit test against the current leaf's ancestor mask.
+//
+// An external transition exits from the current leaf up to, not
+// including, the innermost state containing both ends, then runs the
+// action and the entries down to the target. From the action on, the
+// machine is in the target. A guard chooses between target and
+// alt_target; HSM_NO_STATE as the alternative ignores the event.
+//
+// dispatch() runs on the machine's task. Events from elsewhere go through
+// post() (one producer at a time) and are run by process(). An event
+// dispatched from inside an action waits until the current one has run to
+// completion.
+//
+
+#define HSM_NO_STATE 0xFF
+#define HSM_MAX_DEPTH 4                 // Nesting levels, top-level states included
+#define HSM_DEFERRED_EVENTS 4           // Dispatched from inside actions
+
+typedef void (*hsm_action_t)(int32_t arg);
+typedef bool (*hsm_guard_t)(int32_t arg);
+
+/**
+ * What a table cell does with its event
+ */
+typedef enum {
+    HSM_UNHANDLED = 0,          // Ask the parent state (ignored at the top)
+    HSM_IGNORED,                // Consumed here, nothing happens
+    HSM_INTERNAL,               // Action only, no exit or entry
+    HSM_EXTERNAL                // Exits, action, entries
+} hsm_kind_t;
+
+typedef struct {
+    hsm_kind_t kind;
+    uint8_t target;             // Leaf state (EXTERNAL)
+    uint8_t alt_target;         // When the guard fails (HSM_NO_STATE: ignore)
+    hsm_guard_t guard;          // nullptr: always target
+    hsm_action_t action;        // nullptr: none
+} hsm_transition_t;
+
+typedef struct {
+    const char* name;
+    uint8_t parent;             // HSM_NO_STATE at the top
+    hsm_action_t on_entry;
+    hsm_action_t on_exit;
+} hsm_state_t;
+
+typedef struct {
+    uint8_t event;
+    int32_t arg;
+} hsm_event_t;
+
+typedef struct {
+    uint32_t dispatched;        // Events run
+    uint32_t handled;           // Transitions and internal actions taken
+    uint32_t ignored;           // Unhandled, ignored or guarded off
+    uint32_t deferred;          // Dispatched from inside an action
+    uint32_t dropped;           // post() or a deferral with the queue full
+} hsm_stats_t;
+
+/**
+ * Called after every dispatched event
+ * @param to Equal to from for internal and ignored events
+ */
+typedef void (*hsm_trace_t)(uint8_t from, uint8_t event, uint8_t to, bool handled);
+
+// Table cells
+#define HSM_UNHANDLED_CELL {HSM_UNHANDLED, HSM_NO_STATE, HSM_NO_STATE, nullptr, nullptr}
+#define HSM_IGNORED_CELL {HSM_IGNORED, HSM_NO_STATE, HSM_NO_STATE, nullptr, nullptr}
+
+constexpr hsm_transition_t hsmGo(uint8_t target, hsm_action_t action = nullptr) {
+    return hsm_transition_t{HSM_EXTERNAL, target, HSM_NO_STATE, nullptr, action};
+}
+
+constexpr hsm_transition_t hsmChoose(hsm_guard_t guard, uint8_t target, uint8_t alt_target,
+                                     hsm_action_t action = nullptr) {
+    return hsm_transition_t{HSM_EXTERNAL, target, alt_target, guard, action};
+}
+
+constexpr hsm_transition_t hsmInternal(hsm_action_t action, hsm_guard_t guard = nullptr) {
+    return hsm_transition_t{HSM_INTERNAL, HSM_NO_STATE, HSM_NO_STATE, guard, action};
+}
+
+template <size_t S, size_t E, size_t Q>
+class HierarchicalStateMachine {
+    static_assert(S > 0 && S <= 32, "isIn() keeps ancestors in a 32-bit mask");
+    static_assert(E > 0 && E < 256, "Events are 8-bit");
+
+public:
+    typedef hsm_transition_t transition_table_t[S][E];
+    typedef hsm_state_t state_table_t[S];
+
+    /**
+     * @param states Outlives the machine
+     * @param transitions Outlives the machine
+     * @param initial Leaf state to start in (its entry action does not run)
+     */
+    HierarchicalStateMachine(const state_table_t& states, const transition_table_t& transitions,
+                             uint8_t initial)
+        : states(states), transitions(transitions), initial(initial), current(initial),
+          dispatching(false), trace(nullptr) {
+        for (size_t s = 0; s < S; s++) {
+            depth[s] = 0;
+            ancestors[s] = 0;
+            for (uint8_t a = (uint8_t)s; a < S && depth[s] <= HSM_MAX_DEPTH; a = states[a].parent) {
+                ancestors[s] |= 1u << a;
+                depth[s]++;
+            }
+        }
+        // Each cell falls back to the nearest ancestor that handles the event
+        for (size_t s = 0; s < S; s++) {
+            for (size_t e = 0; e < E; e++) {
+                resolved[s][e] = nullptr;
+                uint8_t a = (uint8_t)s;
+                for (size_t level = 0; a < S && level <= HSM_MAX_DEPTH; level++, a = states[a].parent) {
+                    if (transitions[a][e].kind != HSM_UNHANDLED) {
+                        resolved[s][e] = &transitions[a][e];
+                        break;
+                    }
+                }
+            }
+        }
+        resetStats();
+    }
+
+    /**
+     * Run one event now (on the machine's task)
+     * @return true if a transition or internal action was taken; an event
+     *         dispatched from inside an action is deferred and returns false
+     */
+    bool dispatch(uint8_t event, int32_t arg = 0) {
+        if (event >= E) {
+            stats.ignored++;
+            return false;
+        }
+        if (dispatching) {
+            hsm_event_t deferred_event = {event, arg};
+            if (deferred.push(deferred_event)) {
+                stats.deferred++;
+            } else {
+                stats.dropped++;
+            }
+            return false;
+        }
+
+        dispatching = true;
+        bool handled = run(event, arg);
+        hsm_event_t next;
+        while (deferred.pop(&next)) {
+            run(next.event, next.arg);
+        }
+        dispatching = false;
+        return handled;
+    }
+
+    /**
+     * Queue an event for process() (one producer at a time)
+     * @return false if the queue is full
+     */
+    bool post(uint8_t event, int32_t arg = 0) {
+        hsm_event_t queued = {event, arg};
+        if (!queue.push(queued)) {
+            stats.dropped++;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Run posted events, oldest first (on the machine's task)
+     * @return Number of events run
+     */
+    size_t process() {
+        size_t count = 0;
+        hsm_event_t next;
+        while (queue.pop(&next)) {
+            dispatch(next.event, next.arg);
+            count++;
+        }
+        return count;
+    }
+
+    size_t pending() const { return queue.size(); }
+
+    uint8_t getState() const { return current; }
+
+    /**
+     * Whether the current leaf is state or lies inside it
+     */
+    bool isIn(uint8_t state) const {
+        return state < S && (ancestors[current] & (1u << state)) != 0;
+    }
+
+    bool isLeaf(uint8_t state) const {
+        for (size_t s = 0; s < S; s++) {
+            if (states[s].parent == state) return false;
+        }
+        return state < S;
+    }
+
+    const char* getStateName(uint8_t state) const {
+        return state < S ? states[state].name : "NONE";
+    }
+
+    /**
+     * The cell dispatch() would use for event in state (after fallback)
+     * @return nullptr if no state up the chain handles it
+     */
+    const hsm_transition_t* getTransition(uint8_t state, uint8_t event) const {
+        return state < S && event < E ? resolved[state][event] : nullptr;
+    }
+
+    /**
+     * Check the tables: parents exist and nest at most HSM_MAX_DEPTH deep,
+     * the initial state and every transition target are leaves
+     */
+    bool validate() const {
+        if (!isLeaf(initial)) return false;
+        for (size_t s = 0; s < S; s++) {
+            if (states[s].parent != HSM_NO_STATE && states[s].parent >= S) return false;
+            if (depth[s] > HSM_MAX_DEPTH) return false;
+            for (size_t e = 0; e < E; e++) {
+                const hsm_transition_t& t = transitions[s][e];
+                if (t.kind != HSM_EXTERNAL) continue;
+                if (!isLeaf(t.target)) return false;
+                if (t.alt_target != HSM_NO_STATE && !isLeaf(t.alt_target)) return false;
+                if (!t.guard && t.alt_target != HSM_NO_STATE) return false;
+            }
+        }
+        return true;
+    }
+
+    void setTrace(hsm_trace_t callback) { trace = callback; }
+
+    const hsm_stats_t* getStats() const { return &stats; }
+
+    void resetStats() {
+        hsm_stats_t cleared = {};
+        stats = cleared;
+    }
+
+    /**
+     * Back to the initial state without running actions; drops queued events
+     */
+    void reset() {
+        current = initial;
+        queue.clear();
+        deferred.clear();
+        resetStats();
+    }
+
+private:
+    bool run(uint8_t event, int32_t arg) {
+        stats.dispatched++;
+        uint8_t from = current;
+        const hsm_transition_t* t = resolved[current][event];
+        bool handled = false;
+
+        if (t && t->kind == HSM_INTERNAL) {
+            if (!t->guard || t->guard(arg)) {
+                if (t->action) t->action(arg);
+                handled = true;
+            }
+        } else if (t && t->kind == HSM_EXTERNAL) {
+            uint8_t target = (!t->guard || t->guard(arg)) ? t->target : t->alt_target;
+            if (target != HSM_NO_STATE) {
+                transition(target, t->action, arg);
+                handled = true;
+            }
+        }
+
+        if (handled) {
+            stats.handled++;
+        } else {
+            stats.ignored++;
+        }
+        if (trace) trace(from, event, current, handled);
+        return handled;
+    }
+
+    void transition(uint8_t target, hsm_action_t action, int32_t arg) {
+        // A self-transition leaves and re-enters the state
+        uint8_t lca = target == current ? states[current].parent : commonAncestor(current, target);
+
+        for (uint8_t s = current; s != lca; s = states[s].parent) {
+            if (states[s].on_exit) states[s].on_exit(arg);
+        }
+
+        current = target;
+        if (action) action(arg);
+
+        uint8_t path[HSM_MAX_DEPTH];
+        size_t count = 0;
+        for (uint8_t s = target; s != lca && count < HSM_MAX_DEPTH; s = states[s].parent) {
+            path[count++] = s;
+        }
+        while (count > 0) {
+            const hsm_state_t& entered = states[path[--count]];
+            if (entered.on_entry) entered.on_entry(arg);
+        }
+    }
+
+    uint8_t commonAncestor(uint8_t a, uint8_t b) const {
+        while (depth[a] > depth[b]) a = states[a].parent;
+        while (depth[b] > depth[a]) b = states[b].parent;
+        while (a != b) {
+            a = states[a].parent;
+            b = states[b].parent;
+        }
+        return a;           // HSM_NO_STATE when only the root is shared
+    }
+
+    HierarchicalStateMachine(const HierarchicalStateMachine&);
+    HierarchicalStateMachine& operator=(const HierarchicalStateMachine&);
+
+    const state_table_t& states;
+    const transition_table_t& transitions;
+    const uint8_t initial;
+    uint8_t current;
+    bool dispatching;
+    hsm_trace_t trace;
+    uint8_t depth[S];                           // 1 for top-level states
+    uint32_t ancestors[S];                      // Bit per state, the state itself included
+    const hsm_transition_t* resolved[S][E];
+    RingBuffer<hsm_event_t, Q> queue;
+    RingBuffer<hsm_event_t, HSM_DEFERRED_EVENTS> deferred;
+    hsm_stats_t stats;
+};
+
+#endif // HSM_H
@@ -8,6 +8,7 @@
 #include "../src/hal/constants.h"
 #include "../src/system/battery/battery_code.h"
 #include "../src/status/device_status.h"
+#include "../src/status/device_lifecycle.h"
 #include "../firmware/src/features/microphone/mulaw.h"
 
 void setup() {
@@ -17,7 +18,7 @@ void setup() {
   // Test device status functions
   updateDeviceStatus(DEVICE_STATUS_INITIALIZING);
   Serial.print("Device Status: "); Serial.println(deviceStatus);
-  Serial.print("Device Ready: "); Serial.println(deviceReady ? "Yes" : "No");
+  Serial.print("Device Ready: "); Serial.println(DeviceLifecycle::isReady() ? "Yes" : "No");
   
   // Test battery functions
   float voltage = readBatteryVoltage();
@@ -141,17 +141,19 @@ void handleSerialCommand(char cmd) {
             Serial.println("=== CYCLE STATISTICS ===");
             printCycleManagerStats();
             Serial.println("\nIndividual cycle details:");
-            for (int i = 0; i < 4; i++) {
-                printCycleStats(i);
-            }
+            printCycleStats(test_interval_cycle_id);
+            printCycleStats(test_condition_cycle_id);
+            printCycleStats(test_pattern_cycle_id);
+            printCycleStats(test_timeout_cycle_id);
             break;
             
         case 'r':
         case 'R':
             Serial.println("Resetting cycle statistics...");
-            for (int i = 0; i < 4; i++) {
-                resetCycleStats(i);
-            }
+            resetCycleStats(test_interval_cycle_id);
+            resetCycleStats(test_condition_cycle_id);
+            resetCycleStats(test_pattern_cycle_id);
+            resetCycleStats(test_timeout_cycle_id);
             counter = 0;
             Serial.println("Statistics reset!");
             break;
@@ -176,6 +178,11 @@ void handleSerialCommand(char cmd) {
             }
             break;
             
+        case 'u':
+        case 'U':
+            testUnregister();
+            break;
+            
         case 't':
         case 'T':
             testCyclePerformance();
@@ -193,6 +200,29 @@ void handleSerialCommand(char cmd) {
     }
 }
 
+void testUnregister() {
+    Serial.println("\n=== UNREGISTER TEST ===");
+    
+    // Re-register the timeout cycle: the old ID must go stale, the slot is reused
+    int old_id = test_timeout_cycle_id;
+    bool removed = unregisterCycle(old_id);
+    test_timeout_cycle_id = registerTimeoutCycle(
+        "TestTimeout",
+        5000,
+        []() {
+            Serial.println("Timeout cycle executed (re-registered)!");
+        },
+        CYCLE_PRIORITY_LOW
+    );
+    
+    Serial.printf("  Unregistered %d: %s\n", old_id, removed ? "PASS" : "FAIL");
+    Serial.printf("  New ID %d, same slot: %s\n", test_timeout_cycle_id,
+                  CYCLE_ID_SLOT(test_timeout_cycle_id) == CYCLE_ID_SLOT(old_id) ? "PASS" : "FAIL");
+    Serial.printf("  Old ID rejected: %s\n",
+                  getCycleStats(old_id) == nullptr && !unregisterCycle(old_id) ? "PASS" : "FAIL");
+    Serial.printf("  Active cycles: %u of %u\n", (unsigned)getActiveCycleCount(), (unsigned)cycle_count);
+}
+
 void testCyclePerformance() {
     Serial.println("\n=== PERFORMANCE TEST ===");
     
@@ -213,7 +243,7 @@ void testCyclePerformance() {
     Serial.printf("  Cycles executed: %lu\n", cycles_after - cycles_before);
     Serial.printf("  Cycles per second: %.2f\n", 
                   (float)(cycles_after - cycles_before) / ((end_time - start_time) / 1000.0));
-    Serial.printf("  Total execution time: %lu ms\n", total_execution_time);
+    Serial.printf("  Total execution time: %.1f ms\n", total_execution_time_us / 1000.0);
 }
 
 void printHelp() {
@@ -223,6 +253,7 @@ void printHelp() {
     Serial.println("r - Reset cycle statistics");
     Serial.println("p - Pause/Resume interval cycle");
     Serial.println("e - Enable/Disable interval cycle");
+    Serial.println("u - Unregister and re-register the timeout cycle");
     Serial.println("t - Run performance test");
     Serial.println("h - Show this help");
 } 
\ No newline at end of file
@@ -0,0 +1,125 @@
+// Test sketch for the image kernels
+// Checks each kernel against its scalar version and reports pixels per
+// CPU cycle on the device
+
+#define CAMERA_MODEL_XIAO_ESP32S3
+#define XIAO_ESP32S3_SENSE
+
+#include "../firmware/src/features/camera/image_kernels.h"
+#include "../firmware/src/hal/xiao_esp32s3_constants.h"
+
+#define BENCH_WIDTH 320
+#define BENCH_HEIGHT 240
+#define BENCH_RUNS 5
+
+static uint8_t* frame = nullptr;
+static uint8_t* previous = nullptr;
+static uint8_t* output = nullptr;
+static uint8_t* rgb565 = nullptr;
+static uint32_t histogram[256];
+
+static void report(const char* name, uint32_t pixels, uint32_t cycles, bool match) {
+    Serial.printf("%s %-16s %6.3f px/cycle  %7.2f ms/frame\n", match ? "✅" : "❌", name,
+                  (float)pixels / cycles, cycles / (float)ESP.getCpuFreqMHz() / 1000.0f / BENCH_RUNS);
+}
+
+void setup() {
+    Serial.begin(XIAO_ESP32S3_SERIAL_BAUD_RATE);
+    Serial.println("Testing Image Kernels...");
+    Serial.println("========================");
+    Serial.printf("Backend: %s, %dx%d, CPU %u MHz\n", imageKernelsBackend(), BENCH_WIDTH, BENCH_HEIGHT,
+                  ESP.getCpuFreqMHz());
+
+    const size_t pixels = BENCH_WIDTH * BENCH_HEIGHT;
+    frame = (uint8_t*)ps_malloc(pixels);
+    previous = (uint8_t*)ps_malloc(pixels);
+    output = (uint8_t*)ps_malloc(pixels);
+    rgb565 = (uint8_t*)ps_malloc(pixels * 2);
+    if (!frame || !previous || !output || !rgb565) {
+        Serial.println("❌ Not enough PSRAM");
+        return;
+    }
+    for (size_t i = 0; i < pixels; i++) {
+        frame[i] = (uint8_t)esp_random();
+        previous[i] = (uint8_t)(frame[i] + (esp_random() & 7));
+        rgb565[2 * i] = (uint8_t)esp_random();
+        rgb565[2 * i + 1] = (uint8_t)esp_random();
+    }
+
+    // SAD over every 16x16 block
+    uint32_t start = ESP.getCycleCount();
+    uint32_t sad = 0;
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        for (int y = 0; y + 16 <= BENCH_HEIGHT; y += 16) {
+            for (int x = 0; x + 16 <= BENCH_WIDTH; x += 16) {
+                sad += imageSad16(&frame[y * BENCH_WIDTH + x], &previous[y * BENCH_WIDTH + x], BENCH_WIDTH);
+            }
+        }
+    }
+    uint32_t cycles = ESP.getCycleCount() - start;
+    // Every block, then every alignment of either image against unrelated
+    // data (the full range of differences)
+    bool match = sad > 0;
+    for (int y = 0; y + 16 <= BENCH_HEIGHT; y += 16) {
+        for (int x = 0; x + 16 <= BENCH_WIDTH; x += 16) {
+            const uint8_t* a = &frame[y * BENCH_WIDTH + x];
+            const uint8_t* b = &previous[y * BENCH_WIDTH + x];
+            match = match && imageSad16(a, b, BENCH_WIDTH) == imageSad16Scalar(a, b, BENCH_WIDTH);
+        }
+    }
+    for (int a = 0; a < 16; a++) {
+        for (int b = 0; b < 16; b++) {
+            match = match && imageSad16(frame + a, rgb565 + b, BENCH_WIDTH + 1) ==
+                                 imageSad16Scalar(frame + a, rgb565 + b, BENCH_WIDTH + 1);
+        }
+    }
+    report("sad 16x16", pixels * BENCH_RUNS, cycles, match);
+
+    start = ESP.getCycleCount();
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        imageDownscale2x(frame, BENCH_WIDTH, BENCH_WIDTH, BENCH_HEIGHT, output, BENCH_WIDTH / 2);
+    }
+    cycles = ESP.getCycleCount() - start;
+    imageDownscale2xScalar(frame, BENCH_WIDTH, BENCH_WIDTH, BENCH_HEIGHT, previous, BENCH_WIDTH / 2);
+    match = memcmp(output, previous, pixels / 4) == 0;
+    // Odd sizes and strides, source and output off alignment
+    const size_t stride = BENCH_WIDTH / 2 + 3;
+    for (int offset = 1; offset < 16; offset += 3) {
+        uint16_t width = BENCH_WIDTH - 2 * offset - 1;
+        imageDownscale2x(frame + offset, BENCH_WIDTH + 1, width, 61, output + offset, stride);
+        imageDownscale2xScalar(frame + offset, BENCH_WIDTH + 1, width, 61, previous + offset, stride);
+        for (int y = 0; y < 30; y++) {
+            match = match && memcmp(output + offset + y * stride, previous + offset + y * stride, width / 2) == 0;
+        }
+    }
+    report("downscale 2x", pixels * BENCH_RUNS, cycles, match);
+
+    start = ESP.getCycleCount();
+    for (int run = 0; run < BENCH_RUNS; run++) imageRgb565ToGray(rgb565, pixels, output);
+    cycles = ESP.getCycleCount() - start;
+    imageRgb565ToGrayScalar(rgb565, pixels, previous);
+    report("rgb565 to gray", pixels * BENCH_RUNS, cycles, memcmp(output, previous, pixels) == 0);
+
+    start = ESP.getCycleCount();
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        memset(histogram, 0, sizeof(histogram));
+        imageHistogram(frame, BENCH_WIDTH, BENCH_WIDTH, BENCH_HEIGHT, histogram);
+    }
+    cycles = ESP.getCycleCount() - start;
+    uint32_t total = 0;
+    for (int i = 0; i < 256; i++) total += histogram[i];
+    report("histogram", pixels * BENCH_RUNS, cycles, total == pixels);
+
+    start = ESP.getCycleCount();
+    uint64_t sharpness = 0;
+    for (int run = 0; run < BENCH_RUNS; run++) sharpness = imageSharpness(frame, BENCH_WIDTH, BENCH_WIDTH, BENCH_HEIGHT);
+    cycles = ESP.getCycleCount() - start;
+    report("sharpness", pixels * BENCH_RUNS, cycles,
+           sharpness == imageSharpnessScalar(frame, BENCH_WIDTH, BENCH_WIDTH, BENCH_HEIGHT));
+
+    Serial.println("\nImage kernel tests completed");
+}
+
+void loop() {
+    delay(1000);
+}
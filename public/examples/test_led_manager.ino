@@ -37,6 +37,9 @@ void setup() {
   
   // Test convenience functions
   testConvenienceFunctions();
+  
+  // Verify the PWM duty actually driven on GPIO21
+  testPwmDuty();
 }
 
 void loop() {
@@ -176,6 +179,50 @@ void testConvenienceFunctions() {
   setLedPattern(LED_OFF);
 }
 
+void testPwmDuty() {
+  Serial.println("\n=== Testing User LED PWM Duty ===");
+  
+  uint32_t maxDuty = getUserLedMaxDuty();
+  int failures = 0;
+  
+  setLedPattern(LED_ON, (rgb_color_t)LED_COLOR_WHITE);
+  delay(10);
+  Serial.printf("LED_ON duty: %u / %u\n", getUserLedDuty(), maxDuty);
+  if (getUserLedDuty() != maxDuty) failures++;
+  
+  setLedPattern(LED_OFF);
+  delay(10);
+  Serial.printf("LED_OFF duty: %u\n", getUserLedDuty());
+  if (getUserLedDuty() != 0) failures++;
+  
+  // Half perceived brightness is well below half duty after gamma
+  setUserLed((rgb_color_t){128, 0, 0});
+  Serial.printf("Level 128 duty: %u (expected %u)\n", getUserLedDuty(), ledLevelToDuty(128));
+  if (getUserLedDuty() != ledLevelToDuty(128)) failures++;
+  
+  // Breathing must pass through intermediate duties without any updateLed() calls
+  const led_pattern_t breathing[] = {LED_PULSE, LED_CONNECTED, LED_STREAMING};
+  const char* breathingNames[] = {"PULSE", "CONNECTED", "STREAMING"};
+  for (int i = 0; i < 3; i++) {
+    setLedPattern(breathing[i], (rgb_color_t)LED_COLOR_WHITE);
+    uint32_t minDuty = maxDuty, peakDuty = 0, distinct = 0, lastDuty = UINT32_MAX;
+    unsigned long start = millis();
+    while (millis() - start < 3000) {
+      uint32_t duty = getUserLedDuty();
+      if (duty < minDuty) minDuty = duty;
+      if (duty > peakDuty) peakDuty = duty;
+      if (duty != lastDuty) distinct++;
+      lastDuty = duty;
+      delay(5);
+    }
+    Serial.printf("%s: duty %u..%u, %u distinct readings\n", breathingNames[i], minDuty, peakDuty, distinct);
+    if (peakDuty < maxDuty / 2 || minDuty > maxDuty / 20 || distinct < 50) failures++;
+  }
+  
+  setLedPattern(LED_OFF);
+  Serial.printf("PWM duty test %s (%d failures)\n", failures == 0 ? "PASSED" : "FAILED", failures);
+}
+
 void cycleDualPatternsWithColors(int patternIndex, int colorSet) {
   rgb_color_t primaryColorSets[][2] = {
     {(rgb_color_t)LED_COLOR_RED, (rgb_color_t)LED_COLOR_GREEN},
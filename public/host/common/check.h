@@ -0,0 +1,54 @@
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+// ===================================================================
+// TEST CHECKS
+// ===================================================================
+//
+// What every host test (one executable each) needs: CHECK() reports a
+// failed condition with its location and carries on, finishChecks()
+// prints the one-line summary and gives main() its exit code.
+//
+
+static int failures = 0;
+
+#define CHECK(condition)                                                        \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            failures++;                                                         \
+        }                                                                       \
+    } while (0)
+
+/**
+ * Print "<name>: all checks passed" or the number of failed checks
+ * @return Exit code for main()
+ */
+static inline int finishChecks(const char* name) {
+    if (failures) {
+        printf("%s: %d checks failed\n", name, failures);
+        return 1;
+    }
+    printf("%s: all checks passed\n", name);
+    return 0;
+}
+
+/**
+ * Read a whole file (empty if it cannot be read)
+ */
+static inline std::vector<uint8_t> readFile(const char* path) {
+    std::vector<uint8_t> data;
+    FILE* fp = fopen(path, "rb");
+    if (!fp) return data;
+    uint8_t buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), fp)) > 0) data.insert(data.end(), buffer, buffer + n);
+    fclose(fp);
+    return data;
+}
+
+#endif // CHECK_H
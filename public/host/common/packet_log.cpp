@@ -0,0 +1,92 @@
+#include "packet_log.h"
+#include <stdlib.h>
+#include <string.h>
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool PacketLogReader::open(const char* path) {
+    close();
+    fp = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    lineNo = 0;
+    badLines = 0;
+    return fp != nullptr;
+}
+
+bool PacketLogReader::open(FILE* stream) {
+    close();
+    fp = stream;
+    lineNo = 0;
+    badLines = 0;
+    return fp != nullptr;
+}
+
+void PacketLogReader::close() {
+    if (fp && fp != stdin) fclose(fp);
+    fp = nullptr;
+    free(line);
+    line = nullptr;
+    lineCapacity = 0;
+}
+
+bool PacketLogReader::next(packet_record_t* record) {
+    if (!fp) return false;
+
+    ssize_t length;
+    while ((length = getline(&line, &lineCapacity, fp)) >= 0) {
+        lineNo++;
+        if (length == 0 || line[0] == '#' || line[0] == '\n') continue;
+
+        // time_us
+        char* p = line;
+        char* end;
+        unsigned long long time = strtoull(p, &end, 10);
+        if (end == p || *end != ' ') { badLines++; continue; }
+        p = end + 1;
+
+        // characteristic
+        char* space = strchr(p, ' ');
+        if (!space) { badLines++; continue; }
+        record->time_us = time;
+        record->stream.assign(p, space - p);
+        p = space + 1;
+
+        // length
+        unsigned long count = strtoul(p, &end, 10);
+        if (end == p) { badLines++; continue; }
+        p = end;
+        while (*p == ' ') p++;
+
+        // data (the length must fit the line before anything is allocated)
+        if (count > (size_t)(line + length - p) / 2) { badLines++; continue; }
+        record->data.resize(count);
+        size_t i = 0;
+        for (; i < count; i++) {
+            int hi = hexValue(p[2 * i]);
+            int lo = hi < 0 ? -1 : hexValue(p[2 * i + 1]);
+            if (lo < 0) break;
+            record->data[i] = (uint8_t)((hi << 4) | lo);
+        }
+        if (i != count) { badLines++; continue; }
+        return true;
+    }
+    return false;
+}
+
+void writePacketLogHeader(FILE* out) {
+    fprintf(out, "# time_us characteristic length data\n");
+}
+
+void writePacketLogLine(FILE* out, uint64_t time_us, const char* stream, const uint8_t* data, size_t length) {
+    static const char digits[] = "0123456789abcdef";
+    fprintf(out, "%llu %s %u ", (unsigned long long)time_us, stream, (unsigned)length);
+    for (size_t i = 0; i < length; i++) {
+        fputc(digits[data[i] >> 4], out);
+        fputc(digits[data[i] & 0x0F], out);
+    }
+    fputc('\n', out);
+}
@@ -0,0 +1,64 @@
+#ifndef PACKET_LOG_H
+#define PACKET_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// ===================================================================
+// PACKET LOG
+// ===================================================================
+//
+// Text log of BLE notifications as the central received them, one per
+// line:
+//
+//   # time_us characteristic length data
+//   3068000 audio 400 00000000000000ffff...
+//
+// time_us is microseconds since boot, characteristic a stream name
+// (audio, photo, video, ...) or a UUID, data the payload in hex.
+//
+
+/**
+ * One notification
+ */
+typedef struct {
+    uint64_t time_us;
+    std::string stream;
+    std::vector<uint8_t> data;
+} packet_record_t;
+
+class PacketLogReader {
+public:
+    PacketLogReader() : fp(nullptr), line(nullptr), lineCapacity(0), lineNo(0), badLines(0) {}
+    ~PacketLogReader() { close(); }
+
+    /** Open a log ("-" reads stdin) */
+    bool open(const char* path);
+    /** Read from an open stream (closed by the reader) */
+    bool open(FILE* stream);
+    void close();
+
+    /**
+     * Read the next notification (comments, blank and malformed lines are skipped)
+     * @return false at end of file
+     */
+    bool next(packet_record_t* record);
+
+    size_t lineNumber() const { return lineNo; }
+    size_t malformedLines() const { return badLines; }
+
+private:
+    FILE* fp;
+    char* line;
+    size_t lineCapacity;
+    size_t lineNo;
+    size_t badLines;
+};
+
+void writePacketLogHeader(FILE* out);
+void writePacketLogLine(FILE* out, uint64_t time_us, const char* stream, const uint8_t* data, size_t length);
+
+#endif // PACKET_LOG_H
@@ -0,0 +1,75 @@
+#include "fuzz_target.h"
+#include "stream_reassembly.h"
+#include "features/bluetooth/ble_frame_format.h"
+#include <string.h>
+
+// ===================================================================
+// AUDIO STREAM
+// ===================================================================
+//
+// Audio notifications through the frame parser (ble_frame_format.h) and
+// AudioReassembler / AudioDecoder. The first byte picks the codec and the
+// reorder window, the rest are packets.
+//
+
+static const uint8_t MULAW_SILENCE = 0xFF;
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (size < 1) return 0;
+    audio_codec_t codec = (data[0] & 0x80) ? AUDIO_CODEC_PCM16 : AUDIO_CODEC_MULAW;
+    size_t window = data[0] & 0x0F;
+
+    AudioReassembler audio(window);
+    AudioDecoder decoder(codec, 0);
+    decoder.setConcealment((data[0] & 0x40) == 0);
+    audio.setCallbacks(AudioDecoder::onFrame, AudioDecoder::onGap, &decoder);
+
+    uint32_t count = 0;
+    FuzzPackets packets(data + 1, size - 1);
+    const uint8_t* packet;
+    size_t length;
+    while (packets.next(&packet, &length)) {
+        audio.push(packet, length);
+        count++;
+    }
+    audio.flush();
+
+    const audio_stream_stats_t& s = audio.stats();
+    FUZZ_CHECK(s.packets == count);
+    FUZZ_CHECK(s.payload_bytes <= size);
+    FUZZ_CHECK(s.chunked_frames <= s.frames + s.duplicates + s.late_frames);
+    size_t decoded = codec == AUDIO_CODEC_MULAW ? s.payload_bytes : s.payload_bytes / 2;
+    FUZZ_CHECK(decoder.samples().size() >= decoded);
+    FUZZ_CHECK(decoder.samples().size() - decoded == decoder.concealedSamples() ||
+               codec == AUDIO_CODEC_PCM16);
+    return 0;
+}
+
+extern "C" size_t fuzzBenchInput(uint8_t* data, size_t capacity, uint32_t seed) {
+    // μ-law frames as the firmware sends them: 1600 samples split in 400-byte chunks
+    const size_t samples = 1600;
+    const size_t chunkSize = 400;
+    uint8_t frame[BLE_FRAME_HEADER_SIZE + samples];
+    uint8_t chunk[chunkSize];
+    size_t offset = 0;
+
+    data[offset++] = 4;     // μ-law, reorder window 4
+    for (uint16_t number = (uint16_t)(seed * 37); offset < capacity; number++) {
+        bleWriteFrameHeader(frame, number, BLE_FRAME_TYPE_AUDIO);
+        memset(&frame[BLE_FRAME_HEADER_SIZE], MULAW_SILENCE - (number & 0x0F), samples);
+
+        size_t total = sizeof(frame);
+        uint8_t index = 0;
+        for (size_t sent = 0; sent < total; index++) {
+            size_t slice = total - sent < chunkSize - BLE_AUDIO_CHUNK_HEADER_SIZE ?
+                           total - sent : chunkSize - BLE_AUDIO_CHUNK_HEADER_SIZE;
+            bleWriteAudioChunkHeader(chunk, number, index, sent + slice >= total);
+            memcpy(&chunk[BLE_AUDIO_CHUNK_HEADER_SIZE], &frame[sent], slice);
+            size_t next = fuzzAppendPacket(data, offset, capacity, chunk, slice + BLE_AUDIO_CHUNK_HEADER_SIZE);
+            if (next == capacity) return offset;
+            offset = next;
+            sent += slice;
+        }
+    }
+    return offset;
+}
@@ -0,0 +1,49 @@
+#include "fuzz_target.h"
+#include "virtual_device.h"
+#include "features/bluetooth/callbacks/hotspot_control_callback.h"
+#include "features/bluetooth/services/ble_services.h"
+
+// ===================================================================
+// HOTSPOT CONTROL
+// ===================================================================
+//
+// Writes to the hotspot control characteristic. The hotspot is disabled
+// in the firmware, so any write must leave the device untouched: no
+// notification may go out.
+//
+
+extern "C" int LLVMFuzzerInitialize(int* argc, char*** argv) {
+    (void)argc;
+    (void)argv;
+    VirtualDevice::setConsole(nullptr);
+    return 0;
+}
+
+static uint64_t notifications() {
+    uint64_t total = 0;
+    for (size_t i = 0; i < VirtualDevice::streamCount(); i++) total += VirtualDevice::streamStats(i)->packets;
+    return total;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    uint64_t before = notifications();
+    FuzzPackets packets(data, size);
+    const uint8_t* packet;
+    size_t length;
+    while (packets.next(&packet, &length)) {
+        onHotspotControlWrite(packet, length);
+    }
+    FUZZ_CHECK(notifications() == before);
+    return 0;
+}
+
+extern "C" size_t fuzzBenchInput(uint8_t* data, size_t capacity, uint32_t seed) {
+    size_t offset = 0;
+    for (size_t i = 0; i < 64; i++) {
+        uint8_t value = (uint8_t)((seed + i) % 4);
+        size_t next = fuzzAppendPacket(data, offset, capacity, &value, 1);
+        if (next == capacity) break;
+        offset = next;
+    }
+    return offset;
+}
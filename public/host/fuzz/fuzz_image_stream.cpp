@@ -0,0 +1,90 @@
+#include "fuzz_target.h"
+#include "stream_reassembly.h"
+#include "features/bluetooth/ble_frame_format.h"
+#include <string.h>
+
+// ===================================================================
+// IMAGE STREAM
+// ===================================================================
+//
+// Photo / video notifications through ImageReassembler. The first byte
+// picks the stream type, the rest are packets. Images reported complete
+// must be whole JPEGs, compact ones included once their header is back.
+//
+
+typedef struct {
+    uint32_t images;
+    uint32_t complete;
+    uint64_t bytes;
+} image_check_t;
+
+static void checkImage(void* ctx, uint32_t number, const uint8_t* data, size_t length, bool complete) {
+    image_check_t* check = (image_check_t*)ctx;
+    FUZZ_CHECK(number == check->images);
+    FUZZ_CHECK(length == 0 || data != nullptr);
+    if (complete) {
+        FUZZ_CHECK(length >= 4 && data[0] == 0xFF && data[1] == 0xD8);
+        FUZZ_CHECK(data[length - 2] == 0xFF && data[length - 1] == 0xD9);
+        check->complete++;
+    }
+    check->images++;
+    check->bytes += length;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (size < 1) return 0;
+    ImageReassembler images((data[0] & 1) ? BLE_FRAME_TYPE_VIDEO : BLE_FRAME_TYPE_PHOTO);
+    image_check_t check = {0, 0, 0};
+    images.setCallback(checkImage, &check);
+
+    FuzzPackets packets(data + 1, size - 1);
+    const uint8_t* packet;
+    size_t length;
+    while (packets.next(&packet, &length)) {
+        images.push(packet, length);
+    }
+    images.flush();
+
+    const image_stream_stats_t& s = images.stats();
+    FUZZ_CHECK(s.images == check.images && s.complete == check.complete && s.bytes == check.bytes);
+    FUZZ_CHECK(s.wire_bytes <= size);
+    // A restored header is one received before
+    FUZZ_CHECK(s.bytes <= s.wire_bytes * (1 + (uint64_t)s.compacted));
+    return 0;
+}
+
+extern "C" size_t fuzzBenchInput(uint8_t* data, size_t capacity, uint32_t seed) {
+    // JPEG-sized photos in PHOTO_CHUNK_SIZE chunks, each closed by the end marker
+    const size_t chunkSize = 400;
+    const size_t imageSize = 5000 + (seed % 7) * 300;
+    uint8_t chunk[BLE_FRAME_HEADER_SIZE + chunkSize];
+    size_t offset = 0;
+
+    data[offset++] = 0;     // Photo
+    while (offset < capacity) {
+        uint16_t index = 0;
+        for (size_t sent = 0; sent < imageSize; index++) {
+            size_t slice = imageSize - sent < chunkSize ? imageSize - sent : chunkSize;
+            bleWriteFrameHeader(chunk, index, BLE_FRAME_TYPE_PHOTO);
+            memset(&chunk[BLE_FRAME_HEADER_SIZE], (uint8_t)(seed + index), slice);
+            if (sent == 0) {
+                chunk[BLE_FRAME_HEADER_SIZE] = 0xFF;
+                chunk[BLE_FRAME_HEADER_SIZE + 1] = 0xD8;
+            }
+            if (sent + slice == imageSize) {
+                chunk[BLE_FRAME_HEADER_SIZE + slice - 2] = 0xFF;
+                chunk[BLE_FRAME_HEADER_SIZE + slice - 1] = 0xD9;
+            }
+            size_t next = fuzzAppendPacket(data, offset, capacity, chunk, BLE_FRAME_HEADER_SIZE + slice);
+            if (next == capacity) return offset;
+            offset = next;
+            sent += slice;
+        }
+        uint8_t marker[BLE_FRAME_HEADER_SIZE];
+        bleWriteEndMarker(marker, BLE_FRAME_TYPE_PHOTO);
+        size_t next = fuzzAppendPacket(data, offset, capacity, marker, sizeof(marker));
+        if (next == capacity) return offset;
+        offset = next;
+    }
+    return offset;
+}
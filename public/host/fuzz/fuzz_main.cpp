@@ -0,0 +1,206 @@
+#include "fuzz_target.h"
+#include <dirent.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// ===================================================================
+// STANDALONE FUZZ DRIVER
+// ===================================================================
+//
+// Stands in for libFuzzer where it is not available (GCC builds):
+//
+//   fuzz_target FILE|DIR...     run each input once (corpus, crash repro)
+//   fuzz_target --runs N        random and mutated inputs
+//   fuzz_target --bench SEC     throughput over representative inputs
+//
+// There is no coverage feedback; mutations start from the corpus and the
+// target's benchmark inputs, so the valid framing is exercised as well.
+//
+
+typedef std::vector<uint8_t> fuzz_input_t;
+
+static uint32_t rngState = 1;
+
+static uint32_t nextRandom() {
+    // xorshift32
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+static bool readFile(const std::string& path, fuzz_input_t* out) {
+    FILE* fp = fopen(path.c_str(), "rb");
+    if (!fp) return false;
+    out->clear();
+    uint8_t buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), fp)) > 0) out->insert(out->end(), buffer, buffer + n);
+    fclose(fp);
+    return true;
+}
+
+static void collectInputs(const std::string& path, std::vector<fuzz_input_t>* inputs) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        fprintf(stderr, "fuzz: cannot open %s\n", path.c_str());
+        return;
+    }
+    if (S_ISDIR(st.st_mode)) {
+        DIR* dir = opendir(path.c_str());
+        if (!dir) return;
+        std::vector<std::string> names;
+        while (struct dirent* entry = readdir(dir)) {
+            if (entry->d_name[0] != '.') names.push_back(entry->d_name);
+        }
+        closedir(dir);
+        for (size_t i = 0; i < names.size(); i++) collectInputs(path + "/" + names[i], inputs);
+        return;
+    }
+    fuzz_input_t input;
+    if (readFile(path, &input)) inputs->push_back(input);
+}
+
+static void benchInputs(size_t count, size_t maxLength, std::vector<fuzz_input_t>* inputs) {
+    std::vector<uint8_t> buffer(65536);
+    for (size_t i = 0; i < count; i++) {
+        fuzz_input_t input;
+        if (fuzzBenchInput) {
+            size_t length = fuzzBenchInput(&buffer[0], buffer.size(), (uint32_t)i + 1);
+            input.assign(buffer.begin(), buffer.begin() + length);
+        } else {
+            input.resize(nextRandom() % (maxLength + 1));
+            for (size_t j = 0; j < input.size(); j++) input[j] = (uint8_t)nextRandom();
+        }
+        inputs->push_back(input);
+    }
+}
+
+static void mutate(fuzz_input_t* input, size_t maxLength) {
+    static const uint8_t interesting[] = {0x00, 0x01, 0x02, 0x03, 0x05, 0x7F, 0x80, 0x81, 0xFE, 0xFF};
+    int mutations = 1 + nextRandom() % 4;
+    for (int m = 0; m < mutations; m++) {
+        size_t size = input->size();
+        switch (nextRandom() % 6) {
+            case 0:     // Flip a bit
+                if (size) (*input)[nextRandom() % size] ^= 1 << (nextRandom() % 8);
+                break;
+            case 1:     // Interesting byte
+                if (size) (*input)[nextRandom() % size] = interesting[nextRandom() % sizeof(interesting)];
+                break;
+            case 2:     // Random byte
+                if (size) (*input)[nextRandom() % size] = (uint8_t)nextRandom();
+                break;
+            case 3:     // Insert
+                if (size < maxLength) input->insert(input->begin() + (size ? nextRandom() % (size + 1) : 0), (uint8_t)nextRandom());
+                break;
+            case 4:     // Erase a range
+                if (size) {
+                    size_t at = nextRandom() % size;
+                    size_t count = 1 + nextRandom() % (size - at < 16 ? size - at : 16);
+                    input->erase(input->begin() + at, input->begin() + at + count);
+                }
+                break;
+            case 5:     // Truncate
+                if (size) input->resize(nextRandom() % size);
+                break;
+        }
+    }
+}
+
+static void usage(const char* argv0) {
+    fprintf(stderr,
+            "Usage: %s [options] [FILE|DIR ...]\n"
+            "  FILE|DIR        Run each input once\n"
+            "  --runs N        Random and mutated inputs (default 0)\n"
+            "  --max-len N     Longest generated input (default 4096)\n"
+            "  --seed N        Random seed (default 1)\n"
+            "  --bench SEC     Measure throughput over representative inputs\n",
+            argv0);
+}
+
+int main(int argc, char** argv) {
+    unsigned long runs = 0;
+    size_t maxLength = 4096;
+    double benchSeconds = 0;
+    std::vector<fuzz_input_t> corpus;
+
+    if (LLVMFuzzerInitialize) LLVMFuzzerInitialize(&argc, &argv);
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) {
+            usage(argv[0]);
+            return 0;
+        } else if (strncmp(arg, "--", 2) != 0) {
+            collectInputs(arg, &corpus);
+            continue;
+        } else if (!value) {
+            usage(argv[0]);
+            return 2;
+        }
+        i++;
+        if (strcmp(arg, "--runs") == 0) runs = strtoul(value, nullptr, 10);
+        else if (strcmp(arg, "--max-len") == 0) maxLength = strtoul(value, nullptr, 10);
+        else if (strcmp(arg, "--seed") == 0) rngState = (uint32_t)strtoul(value, nullptr, 10) | 1;
+        else if (strcmp(arg, "--bench") == 0) benchSeconds = atof(value);
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    // Corpus replay
+    for (size_t i = 0; i < corpus.size(); i++) {
+        LLVMFuzzerTestOneInput(corpus[i].empty() ? nullptr : &corpus[i][0], corpus[i].size());
+    }
+    if (!corpus.empty()) printf("fuzz: %u corpus inputs OK\n", (unsigned)corpus.size());
+
+    // Random and mutated inputs
+    if (runs > 0) {
+        std::vector<fuzz_input_t> seeds = corpus;
+        benchInputs(16, maxLength, &seeds);
+        fuzz_input_t input;
+        for (unsigned long run = 0; run < runs; run++) {
+            if (run % 4 == 0 || seeds.empty()) {
+                input.resize(nextRandom() % (maxLength + 1));
+                for (size_t j = 0; j < input.size(); j++) input[j] = (uint8_t)nextRandom();
+            } else {
+                input = seeds[nextRandom() % seeds.size()];
+                mutate(&input, maxLength);
+            }
+            LLVMFuzzerTestOneInput(input.empty() ? nullptr : &input[0], input.size());
+        }
+        printf("fuzz: %lu runs OK\n", runs);
+    }
+
+    // Throughput
+    if (benchSeconds > 0) {
+        std::vector<fuzz_input_t> inputs;
+        benchInputs(64, maxLength, &inputs);
+        uint64_t execs = 0, bytes = 0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        double elapsed = 0;
+        do {
+            for (size_t i = 0; i < inputs.size(); i++) {
+                LLVMFuzzerTestOneInput(inputs[i].empty() ? nullptr : &inputs[i][0], inputs[i].size());
+                bytes += inputs[i].size();
+            }
+            execs += inputs.size();
+            elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        } while (elapsed < benchSeconds);
+        printf("bench: %llu execs in %.2f s, %.0f execs/s, %.0f ns/exec, %.1f MB/s%s\n", (unsigned long long)execs,
+               elapsed, execs / elapsed, elapsed * 1e9 / execs, bytes / elapsed / 1e6,
+               fuzzBenchInput ? "" : " (random inputs)");
+    }
+
+    if (corpus.empty() && runs == 0 && benchSeconds <= 0) {
+        usage(argv[0]);
+        return 2;
+    }
+    return 0;
+}
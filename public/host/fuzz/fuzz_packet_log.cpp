@@ -0,0 +1,52 @@
+#include "fuzz_target.h"
+#include "packet_log.h"
+#include <string.h>
+
+// ===================================================================
+// PACKET LOG
+// ===================================================================
+//
+// PacketLogReader on arbitrary text: the input of stream_decode and
+// link_sweep, often produced by other tools.
+//
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (size == 0) return 0;
+    FILE* fp = fmemopen((void*)data, size, "r");
+    if (!fp) return 0;
+
+    PacketLogReader reader;
+    reader.open(fp);
+    packet_record_t record;
+    size_t records = 0;
+    size_t lastLine = 0;
+    while (reader.next(&record)) {
+        FUZZ_CHECK(reader.lineNumber() > lastLine);
+        FUZZ_CHECK(record.data.size() * 2 <= size);
+        FUZZ_CHECK(!record.stream.empty() || size > 0);
+        lastLine = reader.lineNumber();
+        records++;
+    }
+    FUZZ_CHECK(records + reader.malformedLines() <= reader.lineNumber());
+    return 0;
+}
+
+extern "C" size_t fuzzBenchInput(uint8_t* data, size_t capacity, uint32_t seed) {
+    // Audio lines as virtual_device writes them
+    static const char digits[] = "0123456789abcdef";
+    size_t offset = 0;
+    for (uint32_t line = 0;; line++) {
+        char header[64];
+        int n = snprintf(header, sizeof(header), "%u audio 400 ", (unsigned)(seed * 1000000u + line * 20000u));
+        if (offset + n + 801 > capacity) break;
+        memcpy(data + offset, header, n);
+        offset += n;
+        for (int i = 0; i < 400; i++) {
+            uint8_t value = (uint8_t)(line + i);
+            data[offset++] = digits[value >> 4];
+            data[offset++] = digits[value & 0x0F];
+        }
+        data[offset++] = '\n';
+    }
+    return offset;
+}
@@ -0,0 +1,97 @@
+#include "fuzz_target.h"
+#include "virtual_device.h"
+#include "features/bluetooth/callbacks/photo_control_callback.h"
+#include "features/bluetooth/services/ble_services.h"
+#include "features/camera/camera.h"
+#include "status/device_lifecycle.h"
+
+// ===================================================================
+// PHOTO CONTROL
+// ===================================================================
+//
+// Writes to the photo control characteristic: onPhotoControlWrite()'s
+// length check, then handlePhotoControl()'s value decoding and interval
+// arithmetic, then the lifecycle transition it posts. Each packet is one
+// write; an empty packet also moves a session along (capture, then
+// upload done), and requests during an upload must be turned down (a
+// skip ends it).
+//
+
+extern "C" int LLVMFuzzerInitialize(int* argc, char*** argv) {
+    (void)argc;
+    (void)argv;
+    VirtualDevice::setConsole(nullptr);
+    return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    DeviceLifecycle::reset();
+    DeviceLifecycle::dispatch(LIFECYCLE_EVENT_BOOT_DONE);
+    captureInterval = 0;
+
+    FuzzPackets packets(data, size);
+    const uint8_t* packet;
+    size_t length;
+    while (packets.next(&packet, &length)) {
+        lifecycle_state_t was = DeviceLifecycle::getState();
+        int wasInterval = captureInterval;
+
+        onPhotoControlWrite(packet, length);
+        DeviceLifecycle::process();
+
+        FUZZ_CHECK(captureInterval >= 0);
+        FUZZ_CHECK(DeviceLifecycle::isReady());
+        if (length != 1) {
+            FUZZ_CHECK(DeviceLifecycle::getState() == was && captureInterval == wasInterval);
+            if (length == 0) {
+                // What the capture and upload cycles would do next
+                if (was == LIFECYCLE_CAPTURING) {
+                    DeviceLifecycle::dispatch(LIFECYCLE_EVENT_PHOTO_CAPTURED);
+                    FUZZ_CHECK(DeviceLifecycle::isIn(LIFECYCLE_UPLOADING));
+                } else if (was == LIFECYCLE_UPLOADING) {
+                    DeviceLifecycle::dispatch(LIFECYCLE_EVENT_UPLOAD_DONE);
+                    FUZZ_CHECK(DeviceLifecycle::isIn(captureInterval > 0 ? LIFECYCLE_CAPTURING : LIFECYCLE_IDLE));
+                }
+            }
+            continue;
+        }
+
+        int8_t value = (int8_t)packet[0];
+        if (value == PHOTO_STOP) {
+            // An upload in progress finishes, then the session ends
+            FUZZ_CHECK(DeviceLifecycle::getState() == (was == LIFECYCLE_UPLOADING ? LIFECYCLE_UPLOADING : LIFECYCLE_IDLE));
+            FUZZ_CHECK(captureInterval == 0);
+        } else if (value == PHOTO_SKIP_UPLOAD && was == LIFECYCLE_UPLOADING) {
+            // Like the end of the upload
+            FUZZ_CHECK(DeviceLifecycle::isIn(wasInterval > 0 ? LIFECYCLE_CAPTURING : LIFECYCLE_IDLE));
+        } else if (was == LIFECYCLE_UPLOADING) {
+            FUZZ_CHECK(DeviceLifecycle::getState() == was && captureInterval == wasInterval);
+        } else if (value == PHOTO_SINGLE_SHOT || value == PHOTO_SCAN_CODE ||
+                   (value <= PHOTO_PYRAMID_SHOT && value > PHOTO_PYRAMID_SHOT - IMAGE_PYRAMID_LEVELS)) {
+            FUZZ_CHECK(DeviceLifecycle::isIn(LIFECYCLE_CAPTURING) && captureInterval == 0);
+            FUZZ_CHECK(scanNextCapture == (value == PHOTO_SCAN_CODE));
+            FUZZ_CHECK(pyramidNextLevel == (value <= PHOTO_PYRAMID_SHOT ? PHOTO_PYRAMID_SHOT - value : -1));
+        } else if (value >= PHOTO_MIN_INTERVAL && value <= PHOTO_MAX_INTERVAL) {
+            FUZZ_CHECK(DeviceLifecycle::isIn(LIFECYCLE_CAPTURING));
+            FUZZ_CHECK(captureInterval % (PHOTO_MIN_INTERVAL * 1000) == 0);
+            FUZZ_CHECK(captureInterval >= PHOTO_MIN_INTERVAL * 1000 && captureInterval <= value * 1000);
+        } else {
+            FUZZ_CHECK(DeviceLifecycle::getState() == was && captureInterval == wasInterval);
+        }
+    }
+    return 0;
+}
+
+extern "C" size_t fuzzBenchInput(uint8_t* data, size_t capacity, uint32_t seed) {
+    // A client cycling through single shots, intervals and stops
+    static const int8_t writes[] = {PHOTO_SINGLE_SHOT, 5, 10, 30, PHOTO_STOP, PHOTO_SCAN_CODE, PHOTO_SKIP_UPLOAD, 60,
+                                    PHOTO_PYRAMID_SHOT - 2, 127, PHOTO_STOP};
+    size_t offset = 0;
+    for (size_t i = 0; i < 64; i++) {
+        uint8_t value = (uint8_t)writes[(seed + i) % sizeof(writes)];
+        size_t next = fuzzAppendPacket(data, offset, capacity, &value, 1);
+        if (next == capacity) break;
+        offset = next;
+    }
+    return offset;
+}
@@ -0,0 +1,78 @@
+#ifndef FUZZ_TARGET_H
+#define FUZZ_TARGET_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// ===================================================================
+// FUZZ TARGETS
+// ===================================================================
+//
+// Every fuzz_*.cpp defines the libFuzzer entry point and, optionally, a
+// generator of representative valid inputs for its benchmark:
+//
+//   extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+//   extern "C" int LLVMFuzzerInitialize(int* argc, char*** argv);
+//   extern "C" size_t fuzzBenchInput(uint8_t* data, size_t capacity, uint32_t seed);
+//
+// With clang and -DOPENGLASS_FUZZ=ON they link against libFuzzer; otherwise
+// against fuzz_main.cpp, which replays corpora, runs random/mutated inputs
+// and measures throughput (see README.md).
+//
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+extern "C" int LLVMFuzzerInitialize(int* argc, char*** argv) __attribute__((weak));
+extern "C" size_t fuzzBenchInput(uint8_t* data, size_t capacity, uint32_t seed) __attribute__((weak));
+
+/**
+ * Invariant check: a failure is a finding, so abort like a sanitizer would
+ */
+#define FUZZ_CHECK(condition)                                                           \
+    do {                                                                                \
+        if (!(condition)) {                                                             \
+            fprintf(stderr, "%s:%d: invariant failed: %s\n", __FILE__, __LINE__, #condition); \
+            abort();                                                                    \
+        }                                                                               \
+    } while (0)
+
+/**
+ * Splits a fuzz input into packets: [length_lo, length_hi][bytes]...
+ */
+class FuzzPackets {
+public:
+    FuzzPackets(const uint8_t* data, size_t size) : data(data), size(size), offset(0) {}
+
+    /** @return false when the input is used up */
+    bool next(const uint8_t** packet, size_t* length) {
+        if (offset >= size) return false;
+        size_t wanted = data[offset++];
+        if (offset < size) wanted |= (size_t)data[offset++] << 8;
+        size_t available = size - offset;
+        *length = wanted < available ? wanted : available;
+        *packet = data + offset;
+        offset += *length;
+        return true;
+    }
+
+private:
+    const uint8_t* data;
+    size_t size;
+    size_t offset;
+};
+
+/**
+ * Appends a packet in FuzzPackets form (for fuzzBenchInput)
+ * @return New write offset, or capacity if it did not fit
+ */
+static inline size_t fuzzAppendPacket(uint8_t* out, size_t offset, size_t capacity, const uint8_t* packet,
+                                      size_t length) {
+    if (length > 0xFFFF || offset + 2 + length > capacity) return capacity;
+    out[offset++] = length & 0xFF;
+    out[offset++] = (length >> 8) & 0xFF;
+    for (size_t i = 0; i < length; i++) out[offset++] = packet[i];
+    return offset;
+}
+
+#endif // FUZZ_TARGET_H
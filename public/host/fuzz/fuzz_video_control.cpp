@@ -0,0 +1,86 @@
+#include "fuzz_target.h"
+#include "virtual_device.h"
+#include "features/bluetooth/callbacks/video_control_callback.h"
+#include "features/bluetooth/services/ble_services.h"
+#include "features/camera/camera.h"
+#include "status/device_lifecycle.h"
+
+// ===================================================================
+// VIDEO CONTROL
+// ===================================================================
+//
+// Writes to the video control characteristic: onVideoControlWrite()'s
+// length check, then handleVideoControl() (start, block video start,
+// stop, FPS) and the lifecycle transitions it posts. The frame interval
+// divides by streamingFPS, so it must stay in range. Each packet is one write; an
+// empty packet also starts or finishes a photo upload, which refuses
+// a stream.
+//
+
+extern "C" int LLVMFuzzerInitialize(int* argc, char*** argv) {
+    (void)argc;
+    (void)argv;
+    VirtualDevice::setConsole(nullptr);
+    return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    DeviceLifecycle::reset();
+    DeviceLifecycle::dispatch(LIFECYCLE_EVENT_BOOT_DONE);
+    captureInterval = 0;
+    streamingFPS = VIDEO_STREAM_DEFAULT_FPS;
+
+    FuzzPackets packets(data, size);
+    const uint8_t* packet;
+    size_t length;
+    while (packets.next(&packet, &length)) {
+        lifecycle_state_t was = DeviceLifecycle::getState();
+        bool wasStreaming = was == LIFECYCLE_STREAMING;
+        int wasFps = streamingFPS;
+
+        onVideoControlWrite(packet, length);
+        DeviceLifecycle::process();
+        bool streaming = DeviceLifecycle::isIn(LIFECYCLE_STREAMING);
+
+        FUZZ_CHECK(streamingFPS >= VIDEO_STREAM_FPS_MIN && streamingFPS <= VIDEO_STREAM_FPS_MAX);
+        if (length != 1) {
+            FUZZ_CHECK(DeviceLifecycle::getState() == was && streamingFPS == wasFps);
+            if (length == 0) {
+                if (was == LIFECYCLE_IDLE) {
+                    DeviceLifecycle::dispatch(LIFECYCLE_EVENT_PHOTO_SINGLE);
+                    DeviceLifecycle::dispatch(LIFECYCLE_EVENT_PHOTO_CAPTURED);
+                    FUZZ_CHECK(DeviceLifecycle::isIn(LIFECYCLE_UPLOADING));
+                } else if (was == LIFECYCLE_UPLOADING) {
+                    DeviceLifecycle::dispatch(LIFECYCLE_EVENT_UPLOAD_DONE);
+                    FUZZ_CHECK(DeviceLifecycle::isIn(LIFECYCLE_IDLE));
+                }
+            }
+            continue;
+        }
+
+        uint8_t value = packet[0];
+        if (value == VIDEO_STREAM_STOP) {
+            FUZZ_CHECK(!streaming);
+            FUZZ_CHECK(DeviceLifecycle::getState() == (wasStreaming ? LIFECYCLE_IDLE : was));
+        } else if (value == VIDEO_STREAM_START || value == VIDEO_STREAM_START_BLOCKS) {
+            FUZZ_CHECK(streaming == (was != LIFECYCLE_UPLOADING));
+        } else if (value <= VIDEO_STREAM_FPS_MAX) {
+            FUZZ_CHECK(streamingFPS == value && streaming == wasStreaming);
+        } else {
+            FUZZ_CHECK(streaming == wasStreaming && streamingFPS == wasFps);
+        }
+    }
+    return 0;
+}
+
+extern "C" size_t fuzzBenchInput(uint8_t* data, size_t capacity, uint32_t seed) {
+    static const uint8_t writes[] = {VIDEO_STREAM_START, 2, 5, 10, VIDEO_STREAM_STOP};
+    size_t offset = 0;
+    for (size_t i = 0; i < 64; i++) {
+        uint8_t value = writes[(seed + i) % sizeof(writes)];
+        size_t next = fuzzAppendPacket(data, offset, capacity, &value, 1);
+        if (next == capacity) break;
+        offset = next;
+    }
+    return offset;
+}
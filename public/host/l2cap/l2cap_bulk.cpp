@@ -0,0 +1,190 @@
+#include "l2cap_bulk.h"
+#include <string.h>
+
+static inline void put16(uint8_t* p, uint16_t value) {
+    p[0] = value & 0xFF;
+    p[1] = (value >> 8) & 0xFF;
+}
+
+static inline uint16_t get16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+void l2capWriteCredit(uint8_t* pdu, uint8_t identifier, uint16_t cid, uint16_t credits) {
+    put16(pdu, L2CAP_CREDIT_PDU_SIZE - L2CAP_HEADER_SIZE);
+    put16(pdu + 2, L2CAP_LE_SIGNALING_CID);
+    pdu[4] = L2CAP_FLOW_CONTROL_CREDIT;
+    pdu[5] = identifier;
+    put16(pdu + 6, 4);
+    put16(pdu + 8, cid);
+    put16(pdu + 10, credits);
+}
+
+// ===================================================================
+// SENDER
+// ===================================================================
+
+L2capBulkSender::L2capBulkSender() {
+    close();
+    sdus = 0;
+    pdus = 0;
+}
+
+bool L2capBulkSender::open(uint16_t cid, uint16_t mtu, uint16_t mps, uint16_t credits) {
+    close();
+    if (mtu < L2CAP_MIN_MTU || mps < L2CAP_MIN_MTU || mps > L2CAP_MAX_MPS) return false;
+    this->cid = cid;
+    peerMtu = mtu;
+    peerMps = mps;
+    peerCredits = credits;
+    opened = true;
+    return true;
+}
+
+void L2capBulkSender::close() {
+    opened = false;
+    cid = 0;
+    peerMtu = 0;
+    peerMps = 0;
+    peerCredits = 0;
+    sending = false;
+    sdu = nullptr;
+    sduLength = 0;
+    sduOffset = 0;
+}
+
+bool L2capBulkSender::write(const uint8_t* data, size_t length) {
+    if (!opened || sending || length > peerMtu) return false;
+    sending = true;
+    sdu = data;
+    sduLength = length;
+    sduOffset = 0;
+    return true;
+}
+
+size_t L2capBulkSender::nextPdu(uint8_t* pdu, size_t capacity) {
+    if (!sending || peerCredits == 0 || capacity < l2capMaxPdu(peerMps)) return 0;
+
+    // The first K-frame spends two of its MPS bytes on the SDU length
+    bool first = sduOffset == 0;
+    size_t room = first ? peerMps - L2CAP_SDU_LENGTH_SIZE : peerMps;
+    size_t part = sduLength - sduOffset < room ? sduLength - sduOffset : room;
+    size_t payload = part + (first ? L2CAP_SDU_LENGTH_SIZE : 0);
+
+    put16(pdu, (uint16_t)payload);
+    put16(pdu + 2, cid);
+    uint8_t* out = pdu + L2CAP_HEADER_SIZE;
+    if (first) {
+        put16(out, (uint16_t)sduLength);
+        out += L2CAP_SDU_LENGTH_SIZE;
+    }
+    if (part) memcpy(out, sdu + sduOffset, part);
+
+    sduOffset += part;
+    peerCredits--;
+    pdus++;
+    if (sduOffset == sduLength) {
+        sending = false;
+        sdu = nullptr;
+        sdus++;
+    }
+    return L2CAP_HEADER_SIZE + payload;
+}
+
+bool L2capBulkSender::receive(const uint8_t* pdu, size_t length) {
+    if (length != L2CAP_CREDIT_PDU_SIZE || get16(pdu) != L2CAP_CREDIT_PDU_SIZE - L2CAP_HEADER_SIZE ||
+        get16(pdu + 2) != L2CAP_LE_SIGNALING_CID || pdu[4] != L2CAP_FLOW_CONTROL_CREDIT || get16(pdu + 8) != cid) {
+        return true;    // Not ours: ignored
+    }
+    uint32_t total = (uint32_t)peerCredits + get16(pdu + 10);
+    if (total > L2CAP_MAX_CREDITS) {
+        close();
+        return false;
+    }
+    peerCredits = (uint16_t)total;
+    return true;
+}
+
+// ===================================================================
+// RECEIVER
+// ===================================================================
+
+L2capBulkReceiver::L2capBulkReceiver() {
+    close();
+}
+
+bool L2capBulkReceiver::open(uint16_t cid, uint16_t mtu, uint16_t mps, uint16_t credits, uint8_t* buffer) {
+    close();
+    if (mtu < L2CAP_MIN_MTU || mps < L2CAP_MIN_MTU || mps > L2CAP_MAX_MPS || !buffer) return false;
+    this->cid = cid;
+    localMtu = mtu;
+    localMps = mps;
+    window = credits;
+    localCredits = credits;
+    this->buffer = buffer;
+    opened = true;
+    return true;
+}
+
+void L2capBulkReceiver::close() {
+    opened = false;
+    cid = 0;
+    localMtu = 0;
+    localMps = 0;
+    window = 0;
+    localCredits = 0;
+    owed = 0;
+    sduDone = false;
+    buffer = nullptr;
+    sduExpected = 0;
+    sduFilled = 0;
+}
+
+int L2capBulkReceiver::receive(const uint8_t* pdu, size_t length) {
+    if (!opened || length < L2CAP_HEADER_SIZE || get16(pdu + 2) != cid) return RECEIVE_MORE;
+
+    size_t payload = get16(pdu);
+    bool first = sduExpected == 0;
+    if (payload != length - L2CAP_HEADER_SIZE || payload > localMps || localCredits == 0 ||
+        (first && payload < L2CAP_SDU_LENGTH_SIZE)) {
+        close();
+        return RECEIVE_ERROR;
+    }
+    localCredits--;
+    owed++;
+
+    const uint8_t* data = pdu + L2CAP_HEADER_SIZE;
+    if (first) {
+        sduExpected = get16(data);
+        sduFilled = 0;
+        data += L2CAP_SDU_LENGTH_SIZE;
+        payload -= L2CAP_SDU_LENGTH_SIZE;
+        if (sduExpected > localMtu) {
+            close();
+            return RECEIVE_ERROR;
+        }
+    }
+    if (sduFilled + payload > sduExpected) {
+        close();
+        return RECEIVE_ERROR;
+    }
+    memcpy(buffer + sduFilled, data, payload);
+    sduFilled += payload;
+
+    // An empty SDU is one K-frame with only the length
+    if (sduFilled == sduExpected) {
+        sduExpected = 0;
+        sduDone = true;
+        return RECEIVE_SDU;
+    }
+    return RECEIVE_MORE;
+}
+
+size_t L2capBulkReceiver::creditPdu(uint8_t* pdu, uint8_t identifier) {
+    if (!opened || owed == 0 || (!sduDone && owed < (window + 1) / 2)) return 0;
+    l2capWriteCredit(pdu, identifier, cid, owed);
+    localCredits += owed;
+    owed = 0;
+    sduDone = false;
+    return L2CAP_CREDIT_PDU_SIZE;
+}
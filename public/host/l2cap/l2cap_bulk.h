@@ -0,0 +1,174 @@
+#ifndef L2CAP_BULK_H
+#define L2CAP_BULK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ===================================================================
+// L2CAP BULK CHANNEL FRAMING
+// ===================================================================
+//
+// The data path of an LE credit-based connection-oriented channel (Core
+// spec Vol 3 Part A, 3.4.3 and 10.1), which carries photos and the
+// duty-cycle backlog when a client opens one (L2CAP_BULK_CHANNEL, see
+// features/bluetooth/l2cap_channel.h in the firmware). Each SDU holds
+// exactly what one photo notification would: a ble_frame_format.h
+// frame, only with up to the peer's SDU MTU of photo bytes instead of
+// the ATT MTU, and no ATT header per packet.
+//
+// An SDU goes out as K-frames of at most MPS payload bytes, the first
+// led by the SDU length. Every K-frame costs the sender one credit; the
+// receiver hands credits back in LE Flow Control Credit packets as it
+// frees room, so a slow client throttles the device instead of the
+// stack's notify queue. PDUs, little endian:
+//
+//   K-frame  [length, cid] + [sdu_length, first K-frame only] + payload
+//   credit   [8, 0x0005]   + [0x16, identifier, 4, 0, cid, credits]
+//
+// On the device the NimBLE host runs this protocol. The sender and
+// receiver below are the host build's stand-in for it: the unit test
+// runs them against each other over a socket pair (one PDU per packet)
+// to check segmentation, reassembly and credit accounting, including
+// the protocol errors that close a channel. No Arduino dependencies.
+//
+
+#define L2CAP_HEADER_SIZE 4
+#define L2CAP_SDU_LENGTH_SIZE 2
+#define L2CAP_LE_SIGNALING_CID 0x0005
+#define L2CAP_FLOW_CONTROL_CREDIT 0x16
+#define L2CAP_CREDIT_PDU_SIZE (L2CAP_HEADER_SIZE + 8)
+#define L2CAP_MIN_MTU 23            // Smallest SDU MTU and MPS either side may announce
+#define L2CAP_MAX_MPS 65533
+#define L2CAP_MAX_CREDITS 65535
+
+/**
+ * Largest PDU for an MPS (a first K-frame)
+ */
+static inline size_t l2capMaxPdu(uint16_t mps) {
+    return L2CAP_HEADER_SIZE + L2CAP_SDU_LENGTH_SIZE + mps;
+}
+
+/**
+ * K-frames (and so credits) an SDU of this length takes
+ */
+static inline size_t l2capSduFrames(size_t length, uint16_t mps) {
+    return (length + L2CAP_SDU_LENGTH_SIZE + mps - 1) / mps;
+}
+
+/**
+ * Write an LE Flow Control Credit packet (L2CAP_CREDIT_PDU_SIZE bytes)
+ */
+void l2capWriteCredit(uint8_t* pdu, uint8_t identifier, uint16_t cid, uint16_t credits);
+
+/**
+ * Segments SDUs into K-frames as the peer's credits allow
+ */
+class L2capBulkSender {
+public:
+    L2capBulkSender();
+
+    /**
+     * Channel connected: the peer's CID, SDU MTU, MPS and initial credits
+     * @return false for an MTU or MPS under L2CAP_MIN_MTU
+     */
+    bool open(uint16_t cid, uint16_t mtu, uint16_t mps, uint16_t credits);
+    void close();
+    bool isOpen() const { return opened; }
+
+    /**
+     * Start sending an SDU. It is not copied: keep it until busy() is false
+     * @return false while the previous SDU is going out, or if it is over the MTU
+     */
+    bool write(const uint8_t* sdu, size_t length);
+
+    /**
+     * The next K-frame of the SDU, if a credit is left for it
+     * @param pdu Room for l2capMaxPdu(mps) bytes
+     * @return PDU length; 0 when the SDU is out or the credits are
+     */
+    size_t nextPdu(uint8_t* pdu, size_t capacity);
+
+    /**
+     * A PDU from the peer: credit packets for this channel add credits
+     * @return false on a credit count over L2CAP_MAX_CREDITS (the channel
+     *         is closed, as the spec requires)
+     */
+    bool receive(const uint8_t* pdu, size_t length);
+
+    bool busy() const { return sending; }
+    bool stalled() const { return sending && peerCredits == 0; }
+    uint16_t credits() const { return peerCredits; }
+    uint16_t mtu() const { return peerMtu; }
+    uint16_t mps() const { return peerMps; }
+
+    uint32_t sdusSent() const { return sdus; }
+    uint32_t pdusSent() const { return pdus; }
+
+private:
+    bool opened;
+    uint16_t cid;
+    uint16_t peerMtu;
+    uint16_t peerMps;
+    uint16_t peerCredits;
+    bool sending;
+    const uint8_t* sdu;
+    size_t sduLength;
+    size_t sduOffset;
+    uint32_t sdus;
+    uint32_t pdus;
+};
+
+/**
+ * Reassembles SDUs from K-frames and gives the credits back
+ */
+class L2capBulkReceiver {
+public:
+    enum { RECEIVE_ERROR = -1, RECEIVE_MORE = 0, RECEIVE_SDU = 1 };
+
+    L2capBulkReceiver();
+
+    /**
+     * Channel connected: our CID, SDU MTU, MPS and the credits granted
+     * @param buffer Room for one SDU of mtu bytes
+     */
+    bool open(uint16_t cid, uint16_t mtu, uint16_t mps, uint16_t credits, uint8_t* buffer);
+    void close();
+    bool isOpen() const { return opened; }
+
+    /**
+     * A K-frame from the peer
+     * @return RECEIVE_SDU when it completes an SDU (sdu() until the next
+     *         call), RECEIVE_MORE, or RECEIVE_ERROR on a K-frame without a
+     *         credit, over the MPS, or an SDU over the MTU or longer than
+     *         announced (the channel is closed)
+     */
+    int receive(const uint8_t* pdu, size_t length);
+
+    const uint8_t* sdu() const { return buffer; }
+    size_t sduLength() const { return sduFilled; }
+
+    /**
+     * Credits owed for consumed K-frames, as a credit packet once half the
+     * initial credits are owed or an SDU has completed
+     * @param pdu Room for L2CAP_CREDIT_PDU_SIZE bytes
+     * @return PDU length, or 0 if nothing is due
+     */
+    size_t creditPdu(uint8_t* pdu, uint8_t identifier);
+
+    uint16_t credits() const { return localCredits; }
+
+private:
+    bool opened;
+    uint16_t cid;
+    uint16_t localMtu;
+    uint16_t localMps;
+    uint16_t window;
+    uint16_t localCredits;
+    uint16_t owed;
+    bool sduDone;
+    uint8_t* buffer;
+    size_t sduExpected;
+    size_t sduFilled;
+};
+
+#endif // L2CAP_BULK_H
@@ -0,0 +1,263 @@
+#include "ble_link_model.h"
+#include <string.h>
+#include <algorithm>
+
+// Inter-frame space between PDUs
+#define BLE_T_IFS_US 150
+
+ble_link_config_t BleLinkModel::defaultConfig() {
+    ble_link_config_t config;
+    config.conn_interval_ms = 30.0f;
+    config.packets_per_event = 6;
+    config.mtu = 247;
+    config.ll_octets = 251;
+    config.phy = BLE_PHY_1M;
+    config.loss = 0.0f;
+    config.burst_enter = 0.0f;
+    config.burst_exit = 1.0f;
+    config.burst_loss = 0.0f;
+    config.queue_packets = 20;
+    config.block_when_full = false;
+    config.seed = 1;
+    return config;
+}
+
+bool BleLinkModel::parsePhy(const char* text, ble_phy_t* phy) {
+    if (strcmp(text, "1M") == 0) *phy = BLE_PHY_1M;
+    else if (strcmp(text, "2M") == 0) *phy = BLE_PHY_2M;
+    else if (strcmp(text, "S2") == 0) *phy = BLE_PHY_CODED_S2;
+    else if (strcmp(text, "S8") == 0) *phy = BLE_PHY_CODED_S8;
+    else return false;
+    return true;
+}
+
+const char* BleLinkModel::phyName(ble_phy_t phy) {
+    switch (phy) {
+        case BLE_PHY_1M: return "1M";
+        case BLE_PHY_2M: return "2M";
+        case BLE_PHY_CODED_S2: return "S2";
+        case BLE_PHY_CODED_S8: return "S8";
+    }
+    return "?";
+}
+
+uint32_t BleLinkModel::pduAirtimeUs(ble_phy_t phy, size_t payload) {
+    // Header (2) + payload + CRC (3)
+    size_t bits = (2 + payload + 3) * 8;
+    switch (phy) {
+        case BLE_PHY_1M:
+            return (uint32_t)(8 + 32 + bits);                   // Preamble 1 B + access address 4 B
+        case BLE_PHY_2M:
+            return (uint32_t)((16 + 32 + bits) / 2);
+        case BLE_PHY_CODED_S2:
+            return (uint32_t)(80 + 256 + 16 + 24 + bits * 2 + 3 * 2);
+        case BLE_PHY_CODED_S8:
+            return (uint32_t)(80 + 256 + 16 + 24 + bits * 8 + 3 * 8);
+    }
+    return 0;
+}
+
+BleLinkModel::BleLinkModel(const ble_link_config_t& config)
+    : config(config),
+      intervalUs((uint64_t)(config.conn_interval_ms * 1000.0f + 0.5f)),
+      connected(false),
+      nextEvent(0),
+      badState(false),
+      rng(config.seed ? config.seed : 1),
+      events(0),
+      retransmits(0),
+      deliver(nullptr),
+      deliverCtx(nullptr) {
+    if (this->config.queue_packets == 0) this->config.queue_packets = 1;
+    if (this->config.packets_per_event == 0) this->config.packets_per_event = 1;
+    if (this->config.ll_octets < 27) this->config.ll_octets = 27;
+    if (this->config.mtu < 23) this->config.mtu = 23;
+    // Data length update: the controllers settle on a PDU that fits the
+    // connection event (long PDUs at coded PHY do not fit short intervals)
+    while (this->config.ll_octets > 27 &&
+           pduAirtimeUs(this->config.phy, this->config.ll_octets) + BLE_T_IFS_US +
+           pduAirtimeUs(this->config.phy, 0) + BLE_T_IFS_US > intervalUs) {
+        this->config.ll_octets--;
+    }
+    for (int i = 0; i < BLE_LINK_MAX_STREAMS; i++) {
+        streams[i] = ble_link_stream_stats_t();
+    }
+}
+
+void BleLinkModel::setDeliveryCallback(ble_link_deliver_cb_t callback, void* ctx) {
+    deliver = callback;
+    deliverCtx = ctx;
+}
+
+void BleLinkModel::connect(uint64_t now_us) {
+    connected = true;
+    nextEvent = now_us + intervalUs;
+    badState = false;
+}
+
+void BleLinkModel::disconnect(uint64_t now_us) {
+    service(now_us);
+    for (size_t i = 0; i < queue.size(); i++) {
+        streams[queue[i].stream].dropped++;
+    }
+    queue.clear();
+    connected = false;
+}
+
+ble_link_result_t BleLinkModel::send(uint8_t stream, uint64_t now_us, const uint8_t* data, size_t length) {
+    if (stream >= BLE_LINK_MAX_STREAMS) stream = BLE_LINK_MAX_STREAMS - 1;
+    if (!connected) return BLE_LINK_NOT_CONNECTED;
+
+    ble_link_stream_stats_t* s = &streams[stream];
+    if (isFull()) {
+        if (config.block_when_full) {
+            return BLE_LINK_FULL;
+        }
+        s->queued++;
+        s->bytes_offered += length;
+        s->dropped++;
+        return BLE_LINK_DROPPED;
+    }
+
+    s->queued++;
+    s->bytes_offered += length;
+
+    // The stack cuts notifications to what fits in one ATT PDU
+    size_t maxPayload = config.mtu - BLE_ATT_NOTIFY_HEADER;
+    if (length > maxPayload) {
+        s->truncated++;
+        length = maxPayload;
+    }
+
+    queued_packet_t packet;
+    packet.stream = stream;
+    packet.sent_us = now_us;
+    packet.ll_bytes = length + BLE_ATT_NOTIFY_HEADER + BLE_L2CAP_HEADER;
+    packet.ll_sent = 0;
+    if (deliver) {
+        packet.data.assign(data, data + length);
+    } else {
+        packet.data.resize(length);
+    }
+    queue.push_back(packet);
+    return BLE_LINK_QUEUED;
+}
+
+float BleLinkModel::random01() {
+    // xorshift32
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return (rng >> 8) * (1.0f / 16777216.0f);
+}
+
+bool BleLinkModel::pduLost() {
+    if (badState) {
+        if (random01() < config.burst_exit) badState = false;
+    } else {
+        if (config.burst_enter > 0 && random01() < config.burst_enter) badState = true;
+    }
+    float per = badState ? config.burst_loss : config.loss;
+    return per > 0 && random01() < per;
+}
+
+void BleLinkModel::runEvent(uint64_t event_us) {
+    events++;
+    uint64_t used = 0;
+    int pdus = 0;
+
+    while (!queue.empty() && pdus < config.packets_per_event) {
+        queued_packet_t& packet = queue.front();
+        size_t fragment = std::min(packet.ll_bytes - packet.ll_sent, (size_t)config.ll_octets);
+
+        // PDU, IFS, empty ACK from the central, IFS
+        uint64_t cost = pduAirtimeUs(config.phy, fragment) + BLE_T_IFS_US +
+                        pduAirtimeUs(config.phy, 0) + BLE_T_IFS_US;
+        if (used + cost > intervalUs) break;
+        used += cost;
+        pdus++;
+
+        // A CRC error closes the event; the PDU is sent again next time
+        if (pduLost()) {
+            retransmits++;
+            break;
+        }
+
+        packet.ll_sent += fragment;
+        if (packet.ll_sent >= packet.ll_bytes) {
+            uint64_t delivered_us = event_us + used;
+            ble_link_stream_stats_t* s = &streams[packet.stream];
+            s->delivered++;
+            s->bytes_delivered += packet.data.size();
+            s->latency_us.push_back((uint32_t)(delivered_us - packet.sent_us));
+            if (deliver) {
+                deliver(deliverCtx, packet.stream, packet.sent_us, delivered_us,
+                        packet.data.data(), packet.data.size());
+            }
+            queue.pop_front();
+        }
+    }
+}
+
+void BleLinkModel::service(uint64_t now_us) {
+    if (!connected) return;
+    while (nextEvent <= now_us) {
+        if (queue.empty()) {
+            // Idle events only move the anchor
+            nextEvent += (now_us - nextEvent) / intervalUs * intervalUs + intervalUs;
+            break;
+        }
+        runEvent(nextEvent);
+        nextEvent += intervalUs;
+    }
+}
+
+uint64_t BleLinkModel::waitForSpace(uint8_t stream, uint64_t now_us) {
+    if (stream >= BLE_LINK_MAX_STREAMS) stream = BLE_LINK_MAX_STREAMS - 1;
+    uint64_t ready_us = now_us;
+    while (connected && isFull()) {
+        ready_us = nextEvent;
+        runEvent(nextEvent);
+        nextEvent += intervalUs;
+    }
+    if (ready_us > now_us) {
+        streams[stream].blocked++;
+        streams[stream].blocked_us += ready_us - now_us;
+    }
+    return ready_us;
+}
+
+void BleLinkModel::drain(uint64_t limit_us) {
+    while (connected && !queue.empty() && nextEvent <= limit_us) {
+        runEvent(nextEvent);
+        nextEvent += intervalUs;
+    }
+}
+
+uint32_t BleLinkModel::latencyPercentile(uint8_t stream, float percentile) const {
+    const std::vector<uint32_t>& latencies = streams[stream].latency_us;
+    if (latencies.empty()) return 0;
+    std::vector<uint32_t> sorted(latencies);
+    size_t index = (size_t)(percentile / 100.0f * (sorted.size() - 1) + 0.5f);
+    std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+    return sorted[index];
+}
+
+void BleLinkModel::printReport(FILE* out, const char* const* names, double elapsed_s) const {
+    fprintf(out, "Link: %.2f ms interval, %u PDUs/event, MTU %u, LL %u, PHY %s, loss %.3f, burst %.3f/%.3f/%.3f, queue %u (%s)\n",
+            config.conn_interval_ms, config.packets_per_event, config.mtu, config.ll_octets,
+            phyName(config.phy), config.loss, config.burst_enter, config.burst_exit, config.burst_loss,
+            config.queue_packets, config.block_when_full ? "block" : "drop");
+    fprintf(out, "Connection events: %u, retransmissions: %u\n", events, retransmits);
+    fprintf(out, "%-14s %8s %8s %7s %7s %7s %9s %12s %8s %8s %8s %8s\n",
+            "stream", "queued", "deliv", "drop", "trunc", "block", "wait ms", "goodput B/s", "p50 ms", "p90 ms", "p99 ms", "max ms");
+    for (uint8_t i = 0; i < BLE_LINK_MAX_STREAMS; i++) {
+        const ble_link_stream_stats_t& s = streams[i];
+        if (!names[i] || (s.queued == 0 && s.blocked == 0)) continue;
+        fprintf(out, "%-14s %8u %8u %7u %7u %7u %9.1f %12.1f %8.1f %8.1f %8.1f %8.1f\n",
+                names[i], s.queued, s.delivered, s.dropped, s.truncated, s.blocked, s.blocked_us / 1000.0,
+                elapsed_s > 0 ? s.bytes_delivered / elapsed_s : 0.0,
+                latencyPercentile(i, 50) / 1000.0, latencyPercentile(i, 90) / 1000.0,
+                latencyPercentile(i, 99) / 1000.0, latencyPercentile(i, 100) / 1000.0);
+    }
+}
@@ -0,0 +1,182 @@
+#ifndef BLE_LINK_MODEL_H
+#define BLE_LINK_MODEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <deque>
+#include <vector>
+
+// ===================================================================
+// BLE LINK MODEL
+// ===================================================================
+//
+// Models the path from a notify() call to the central:
+//
+//   notify() -> host/controller queue -> connection events -> central
+//
+// Every connection interval the peripheral may send up to
+// packets_per_event LL PDUs, as long as they fit in the interval at the
+// chosen PHY. A notification is split into LL PDUs of at most ll_octets
+// (ATT + L2CAP headers included) and is delivered once its last PDU is
+// acknowledged. Lost PDUs are retransmitted by the link layer and close
+// the connection event, so loss shows up as latency, not as missing data.
+// ll_octets is reduced until one PDU and its ACK fit in an interval.
+// Data is lost only when the queue is full (unless the sender blocks),
+// when a notification exceeds MTU - 3 (it is truncated, as Bluedroid
+// does) or on disconnect.
+//
+// Loss follows a Gilbert-Elliott model: independent loss in the good
+// state, burst loss in the bad state.
+//
+
+#define BLE_LINK_MAX_STREAMS 8
+#define BLE_ATT_NOTIFY_HEADER 3     // ATT opcode + handle
+#define BLE_L2CAP_HEADER 4
+
+typedef enum {
+    BLE_PHY_1M,
+    BLE_PHY_2M,
+    BLE_PHY_CODED_S2,
+    BLE_PHY_CODED_S8
+} ble_phy_t;
+
+/**
+ * Link parameters
+ */
+typedef struct {
+    float conn_interval_ms;         // 7.5 .. 4000 ms
+    uint8_t packets_per_event;      // Controller limit on LL PDUs per connection event
+    uint16_t mtu;                   // Negotiated ATT MTU
+    uint16_t ll_octets;             // LL payload per PDU (251 with data length extension, else 27)
+    ble_phy_t phy;
+    float loss;                     // PDU error rate in the good state
+    float burst_enter;              // P(good -> bad) per PDU
+    float burst_exit;               // P(bad -> good) per PDU
+    float burst_loss;               // PDU error rate in the bad state
+    uint16_t queue_packets;         // Notifications the stack can buffer
+    bool block_when_full;           // Backpressure: sender waits for space instead of dropping
+    uint32_t seed;
+} ble_link_config_t;
+
+/**
+ * Per-stream counters
+ */
+typedef struct {
+    uint32_t queued;
+    uint32_t delivered;
+    uint32_t dropped;               // Queue full or disconnect
+    uint32_t truncated;             // Longer than MTU - 3
+    uint32_t blocked;               // Sends that had to wait for queue space
+    uint64_t blocked_us;            // Total time senders waited
+    uint64_t bytes_offered;
+    uint64_t bytes_delivered;
+    std::vector<uint32_t> latency_us;
+} ble_link_stream_stats_t;
+
+/**
+ * Delivery callback: a notification reached the central
+ */
+typedef void (*ble_link_deliver_cb_t)(void* ctx, uint8_t stream, uint64_t sent_us, uint64_t delivered_us,
+                                      const uint8_t* data, size_t length);
+
+/**
+ * Result of offering a notification to the link
+ */
+typedef enum {
+    BLE_LINK_QUEUED,
+    BLE_LINK_DROPPED,               // Queue full, packet lost
+    BLE_LINK_FULL,                  // Queue full, sender blocks (block_when_full)
+    BLE_LINK_NOT_CONNECTED
+} ble_link_result_t;
+
+class BleLinkModel {
+public:
+    /** Typical phone link: 30 ms, 6 PDUs/event, MTU 247, DLE, 1M PHY, no loss */
+    static ble_link_config_t defaultConfig();
+
+    /** Parse "1M", "2M", "S2", "S8" */
+    static bool parsePhy(const char* text, ble_phy_t* phy);
+    static const char* phyName(ble_phy_t phy);
+
+    explicit BleLinkModel(const ble_link_config_t& config);
+
+    void setDeliveryCallback(ble_link_deliver_cb_t callback, void* ctx);
+
+    /** Start connection events one interval after now */
+    void connect(uint64_t now_us);
+
+    /** Drop everything queued */
+    void disconnect(uint64_t now_us);
+
+    bool isConnected() const { return connected; }
+
+    /**
+     * Offer a notification at now_us. Run service(now_us) first so the
+     * queue reflects everything sent up to now.
+     */
+    ble_link_result_t send(uint8_t stream, uint64_t now_us, const uint8_t* data, size_t length);
+
+    /**
+     * Run connection events until the queue has room (after BLE_LINK_FULL)
+     * @return Time at which the blocked sender can continue
+     */
+    uint64_t waitForSpace(uint8_t stream, uint64_t now_us);
+
+    /** Run all connection events up to and including now_us */
+    void service(uint64_t now_us);
+
+    /** Run connection events until the queue is empty or until limit_us */
+    void drain(uint64_t limit_us);
+
+    /** Time of the next connection event */
+    uint64_t nextEventUs() const { return nextEvent; }
+
+    size_t queueDepth() const { return queue.size(); }
+    bool isFull() const { return queue.size() >= config.queue_packets; }
+
+    const ble_link_config_t& getConfig() const { return config; }
+    const ble_link_stream_stats_t& streamStats(uint8_t stream) const { return streams[stream]; }
+    uint32_t connectionEvents() const { return events; }
+    uint32_t retransmissions() const { return retransmits; }
+
+    /** Latency percentile (0..100) of a stream in µs, 0 if nothing delivered */
+    uint32_t latencyPercentile(uint8_t stream, float percentile) const;
+
+    /**
+     * Print goodput, latency distribution and drops per stream
+     * @param names Stream names indexed by stream id (nullptr entries are skipped)
+     */
+    void printReport(FILE* out, const char* const* names, double elapsed_s) const;
+
+    /** Airtime of one LL PDU carrying payload bytes */
+    static uint32_t pduAirtimeUs(ble_phy_t phy, size_t payload);
+
+private:
+    typedef struct {
+        uint8_t stream;
+        uint64_t sent_us;
+        size_t ll_bytes;            // Notification + ATT + L2CAP headers
+        size_t ll_sent;
+        std::vector<uint8_t> data;
+    } queued_packet_t;
+
+    void runEvent(uint64_t event_us);
+    bool pduLost();
+    float random01();
+
+    ble_link_config_t config;
+    uint64_t intervalUs;
+    bool connected;
+    uint64_t nextEvent;
+    bool badState;
+    uint32_t rng;
+    uint32_t events;
+    uint32_t retransmits;
+    std::deque<queued_packet_t> queue;
+    ble_link_stream_stats_t streams[BLE_LINK_MAX_STREAMS];
+    ble_link_deliver_cb_t deliver;
+    void* deliverCtx;
+};
+
+#endif // BLE_LINK_MODEL_H
@@ -0,0 +1,88 @@
+#ifndef SHIM_ARDUINO_H
+#define SHIM_ARDUINO_H
+
+// ===================================================================
+// HOST ARDUINO CORE
+// ===================================================================
+//
+// Just enough of the ESP32 Arduino core for the firmware to build on the
+// host. Time is virtual: millis()/micros() read the simulator clock and
+// delay() advances it, so setup()/loop() run faster than real time.
+//
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+#include "esp_attr.h"
+#include "esp_err.h"
+#include "esp_system.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "WString.h"
+#include "HardwareSerial.h"
+
+using std::min;
+using std::max;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+#define PI 3.1415926535897932384626433832795
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define F(string_literal) (string_literal)
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+uint16_t analogRead(uint8_t pin);
+uint32_t analogReadMilliVolts(uint8_t pin);
+
+long random(long max);
+long random(long min, long max);
+long map(long x, long in_min, long in_max, long out_min, long out_max);
+
+bool setCpuFrequencyMhz(uint32_t mhz);
+uint32_t getCpuFrequencyMhz();
+
+bool psramFound();
+void* ps_malloc(size_t size);
+void* ps_calloc(size_t n, size_t size);
+
+/**
+ * Chip information (reports the XIAO ESP32S3 Sense)
+ */
+class EspClass {
+public:
+    uint32_t getHeapSize();
+    uint32_t getFreeHeap();
+    uint32_t getMaxAllocHeap();
+    uint32_t getPsramSize();
+    uint32_t getFreePsram();
+    uint32_t getFlashChipSize() { return 8 * 1024 * 1024; }
+    uint32_t getCpuFreqMHz();
+    uint8_t getChipRevision() { return 0; }
+    const char* getChipModel() { return "ESP32-S3 (host)"; }
+    void restart() { esp_restart(); }
+};
+
+extern EspClass ESP;
+
+#endif // SHIM_ARDUINO_H
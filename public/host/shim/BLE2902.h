@@ -0,0 +1,21 @@
+#ifndef SHIM_BLE2902_H
+#define SHIM_BLE2902_H
+
+#include "BLECharacteristic.h"
+
+/**
+ * Client Characteristic Configuration descriptor
+ */
+class BLE2902 : public BLEDescriptor {
+public:
+    BLE2902() : BLEDescriptor(BLEUUID((uint16_t)0x2902)) {}
+    void setNotifications(bool enabled) { notifications = enabled; }
+    void setIndications(bool enabled) { indications = enabled; }
+    bool getNotifications() const { return notifications; }
+
+private:
+    bool notifications = false;
+    bool indications = false;
+};
+
+#endif // SHIM_BLE2902_H
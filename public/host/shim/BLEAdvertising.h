@@ -0,0 +1,16 @@
+#ifndef SHIM_BLE_ADVERTISING_H
+#define SHIM_BLE_ADVERTISING_H
+
+#include "BLEUUID.h"
+
+class BLEAdvertising {
+public:
+    void addServiceUUID(const BLEUUID& uuid) { (void)uuid; }
+    void setScanResponse(bool enabled) { (void)enabled; }
+    void setMinPreferred(uint16_t value) { (void)value; }
+    void setMaxPreferred(uint16_t value) { (void)value; }
+    void start();
+    void stop();
+};
+
+#endif // SHIM_BLE_ADVERTISING_H
@@ -0,0 +1,69 @@
+#ifndef SHIM_BLE_CHARACTERISTIC_H
+#define SHIM_BLE_CHARACTERISTIC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "BLEUUID.h"
+
+class BLECharacteristic;
+class BLEService;
+
+class BLEDescriptor {
+public:
+    explicit BLEDescriptor(const BLEUUID& uuid) : uuid(uuid) {}
+    virtual ~BLEDescriptor() {}
+    BLEUUID getUUID() const { return uuid; }
+
+private:
+    BLEUUID uuid;
+};
+
+class BLECharacteristicCallbacks {
+public:
+    virtual ~BLECharacteristicCallbacks() {}
+    virtual void onRead(BLECharacteristic* characteristic) { (void)characteristic; }
+    virtual void onWrite(BLECharacteristic* characteristic) { (void)characteristic; }
+};
+
+/**
+ * GATT characteristic
+ */
+class BLECharacteristic {
+public:
+    static const uint32_t PROPERTY_READ = 1 << 0;
+    static const uint32_t PROPERTY_WRITE = 1 << 1;
+    static const uint32_t PROPERTY_NOTIFY = 1 << 2;
+    static const uint32_t PROPERTY_BROADCAST = 1 << 3;
+    static const uint32_t PROPERTY_INDICATE = 1 << 4;
+    static const uint32_t PROPERTY_WRITE_NR = 1 << 5;
+
+    BLECharacteristic(const BLEUUID& uuid, uint32_t properties) : uuid(uuid), properties(properties) {}
+    virtual ~BLECharacteristic() {}
+
+    void setValue(const uint8_t* data, size_t length) { value.assign(data, data + length); }
+    void setValue(const std::string& text) { value.assign(text.begin(), text.end()); }
+    void setValue(uint16_t& data) { setValue((const uint8_t*)&data, sizeof(data)); }
+    void setValue(uint32_t& data) { setValue((const uint8_t*)&data, sizeof(data)); }
+    std::string getValue() const { return std::string(value.begin(), value.end()); }
+    uint8_t* getData() { return value.empty() ? nullptr : value.data(); }
+    size_t getLength() const { return value.size(); }
+
+    void notify(bool is_notification = true);
+    void indicate() { notify(false); }
+    void setCallbacks(BLECharacteristicCallbacks* callbacks) { this->callbacks = callbacks; }
+    BLECharacteristicCallbacks* getCallbacks() const { return callbacks; }
+    void addDescriptor(BLEDescriptor* descriptor) { descriptors.push_back(descriptor); }
+    BLEUUID getUUID() const { return uuid; }
+    uint32_t getProperties() const { return properties; }
+
+private:
+    BLEUUID uuid;
+    uint32_t properties;
+    std::vector<uint8_t> value;
+    BLECharacteristicCallbacks* callbacks = nullptr;
+    std::vector<BLEDescriptor*> descriptors;
+};
+
+#endif // SHIM_BLE_CHARACTERISTIC_H
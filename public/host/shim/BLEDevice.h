@@ -0,0 +1,27 @@
+#ifndef SHIM_BLE_DEVICE_H
+#define SHIM_BLE_DEVICE_H
+
+#include <string>
+#include "BLEUUID.h"
+#include "BLECharacteristic.h"
+#include "BLEService.h"
+#include "BLEServer.h"
+#include "BLEAdvertising.h"
+
+// The Arduino Bluedroid classes, for compiling the Bluedroid backend
+// (features/bluetooth/ble_transport_bluedroid.cpp) on the host. Nothing
+// links them: the host build runs BLE_BACKEND_MOCK (sim/ble_central.cpp)
+
+class BLEDevice {
+public:
+    static void init(const std::string& name);
+    static BLEServer* createServer();
+    static BLEServer* getServer();
+    static void setMTU(uint16_t mtu);
+    static uint16_t getMTU();
+    static BLEAdvertising* getAdvertising();
+    static void startAdvertising();
+    static void stopAdvertising();
+};
+
+#endif // SHIM_BLE_DEVICE_H
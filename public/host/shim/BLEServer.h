@@ -0,0 +1,70 @@
+#ifndef SHIM_BLE_SERVER_H
+#define SHIM_BLE_SERVER_H
+
+#include <stdint.h>
+#include <vector>
+#include "BLEUUID.h"
+#include "BLEService.h"
+
+typedef uint8_t esp_bd_addr_t[6];
+
+/**
+ * GATT server event parameters (connect event only)
+ */
+typedef union {
+    struct gatts_connect_evt_param {
+        uint16_t conn_id;
+        esp_bd_addr_t remote_bda;
+        struct {
+            uint16_t interval;      // 1.25 ms units
+            uint16_t latency;
+            uint16_t timeout;       // 10 ms units
+        } conn_params;
+    } connect;
+} esp_ble_gatts_cb_param_t;
+
+class BLEServer;
+
+class BLEServerCallbacks {
+public:
+    virtual ~BLEServerCallbacks() {}
+    virtual void onConnect(BLEServer* server) { (void)server; }
+    virtual void onConnect(BLEServer* server, esp_ble_gatts_cb_param_t* param) { (void)server; (void)param; }
+    virtual void onDisconnect(BLEServer* server) { (void)server; }
+};
+
+/**
+ * GATT server with a single simulated central
+ */
+class BLEServer {
+public:
+    BLEService* createService(const BLEUUID& uuid) {
+        BLEService* service = new BLEService(uuid);
+        services.push_back(service);
+        return service;
+    }
+    void setCallbacks(BLEServerCallbacks* callbacks) { this->callbacks = callbacks; }
+    BLEServerCallbacks* getCallbacks() const { return callbacks; }
+
+    uint16_t getConnId() const { return 0; }
+    uint32_t getConnectedCount() const;
+    uint16_t getPeerMTU(uint16_t conn_id) const;
+    void updateConnParams(esp_bd_addr_t remote_bda, uint16_t min_interval, uint16_t max_interval,
+                          uint16_t latency, uint16_t timeout);
+    void startAdvertising();
+
+    /** Find a characteristic in any service */
+    BLECharacteristic* findCharacteristic(const BLEUUID& uuid) {
+        for (BLEService* service : services) {
+            BLECharacteristic* characteristic = service->getCharacteristic(uuid);
+            if (characteristic) return characteristic;
+        }
+        return nullptr;
+    }
+
+private:
+    std::vector<BLEService*> services;
+    BLEServerCallbacks* callbacks = nullptr;
+};
+
+#endif // SHIM_BLE_SERVER_H
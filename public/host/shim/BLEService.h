@@ -0,0 +1,33 @@
+#ifndef SHIM_BLE_SERVICE_H
+#define SHIM_BLE_SERVICE_H
+
+#include <vector>
+#include "BLEUUID.h"
+#include "BLECharacteristic.h"
+
+class BLEService {
+public:
+    explicit BLEService(const BLEUUID& uuid) : uuid(uuid) {}
+
+    BLECharacteristic* createCharacteristic(const BLEUUID& uuid, uint32_t properties) {
+        BLECharacteristic* characteristic = new BLECharacteristic(uuid, properties);
+        characteristics.push_back(characteristic);
+        return characteristic;
+    }
+    BLECharacteristic* getCharacteristic(const BLEUUID& uuid) {
+        for (BLECharacteristic* characteristic : characteristics) {
+            if (characteristic->getUUID() == uuid) return characteristic;
+        }
+        return nullptr;
+    }
+    void start() { started = true; }
+    bool isStarted() const { return started; }
+    BLEUUID getUUID() const { return uuid; }
+
+private:
+    BLEUUID uuid;
+    std::vector<BLECharacteristic*> characteristics;
+    bool started = false;
+};
+
+#endif // SHIM_BLE_SERVICE_H
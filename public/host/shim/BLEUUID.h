@@ -0,0 +1,25 @@
+#ifndef SHIM_BLE_UUID_H
+#define SHIM_BLE_UUID_H
+
+#include <stdint.h>
+#include <string>
+
+/**
+ * UUID from its text form ("180F" for a 16-bit UUID) or a 16-bit value
+ */
+class BLEUUID {
+public:
+    BLEUUID() {}
+    BLEUUID(const char* uuid);
+    BLEUUID(const std::string& uuid) : BLEUUID(uuid.c_str()) {}
+    BLEUUID(uint16_t uuid);
+
+    bool equals(const BLEUUID& other) const { return value == other.value; }
+    bool operator==(const BLEUUID& other) const { return equals(other); }
+    std::string toString() const { return value; }
+
+private:
+    std::string value;
+};
+
+#endif // SHIM_BLE_UUID_H
@@ -0,0 +1,6 @@
+#ifndef SHIM_BLE_UTILS_H
+#define SHIM_BLE_UTILS_H
+
+#include "BLEDevice.h"
+
+#endif // SHIM_BLE_UTILS_H
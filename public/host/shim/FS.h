@@ -0,0 +1,66 @@
+#ifndef SHIM_FS_H
+#define SHIM_FS_H
+
+#include <dirent.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+/**
+ * File handle backed by a host file or directory
+ */
+class File {
+public:
+    File() : fp(nullptr), dir(nullptr) {}
+    File(FILE* fp, const std::string& name) : fp(fp), dir(nullptr), fileName(name) {}
+    File(DIR* dir, const std::string& hostPath, const std::string& name)
+        : fp(nullptr), dir(dir), hostPath(hostPath), fileName(name) {}
+
+    operator bool() const { return fp != nullptr || dir != nullptr; }
+    const char* name() const { return fileName.c_str(); }
+    bool isDirectory() const { return dir != nullptr; }
+    File openNextFile(const char* mode = FILE_READ);
+    size_t write(const uint8_t* data, size_t length) { return fp ? fwrite(data, 1, length, fp) : 0; }
+    size_t write(uint8_t c) { return write(&c, 1); }
+    size_t read(uint8_t* data, size_t length) { return fp ? fread(data, 1, length, fp) : 0; }
+    int read() { return fp ? fgetc(fp) : -1; }
+    int available();
+    size_t size();
+    size_t position() { return fp ? (size_t)ftell(fp) : 0; }
+    bool seek(size_t pos) { return fp && fseek(fp, (long)pos, SEEK_SET) == 0; }
+    void close();
+
+private:
+    FILE* fp;
+    DIR* dir;
+    std::string hostPath;       // Directories: where their entries are
+    std::string fileName;       // Without the directory, as arduino-esp32 2.x
+};
+
+/**
+ * Filesystem rooted in a host directory
+ */
+class FS {
+public:
+    bool begin(bool formatOnFail = false);
+    void end() {}
+    File open(const char* path, const char* mode = FILE_READ);
+    bool exists(const char* path);
+    bool remove(const char* path);
+    size_t totalBytes() { return 1536 * 1024; }
+    size_t usedBytes();
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
+
+#endif // SHIM_FS_H
@@ -0,0 +1,45 @@
+#ifndef SHIM_HARDWARE_SERIAL_H
+#define SHIM_HARDWARE_SERIAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "WString.h"
+
+#define DEC 10
+#define HEX 16
+
+/**
+ * Serial port backed by the simulator's console log
+ */
+class HardwareSerial {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    void end() {}
+    void flush();
+    int available() { return 0; }
+    int read() { return -1; }
+    operator bool() const { return true; }
+
+    size_t write(uint8_t c);
+    size_t write(const uint8_t* data, size_t length);
+    size_t printf(const char* format, ...);
+
+    size_t print(const char* s);
+    size_t print(const String& s) { return print(s.c_str()); }
+    size_t print(char c);
+    size_t print(int value, int base = DEC);
+    size_t print(unsigned int value, int base = DEC);
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(double value, int decimals = 2);
+
+    size_t println() { return print("\n"); }
+    template <typename T>
+    size_t println(const T& value) { return print(value) + println(); }
+    template <typename T>
+    size_t println(const T& value, int format) { return print(value, format) + println(); }
+};
+
+extern HardwareSerial Serial;
+
+#endif // SHIM_HARDWARE_SERIAL_H
@@ -0,0 +1,71 @@
+#ifndef SHIM_WSTRING_H
+#define SHIM_WSTRING_H
+
+#include <string>
+#include <stdlib.h>
+
+/**
+ * Arduino String on top of std::string (the subset the firmware uses)
+ */
+class String {
+public:
+    String() {}
+    String(const char* s) : str(s ? s : "") {}
+    String(const std::string& s) : str(s) {}
+    explicit String(char c) : str(1, c) {}
+    explicit String(int value, unsigned char base = 10) : str(fromLong(value, base)) {}
+    explicit String(unsigned int value, unsigned char base = 10) : str(fromUnsigned(value, base)) {}
+    explicit String(long value, unsigned char base = 10) : str(fromLong(value, base)) {}
+    explicit String(unsigned long value, unsigned char base = 10) : str(fromUnsigned(value, base)) {}
+    explicit String(float value, unsigned int decimals = 2) : str(fromDouble(value, decimals)) {}
+    explicit String(double value, unsigned int decimals = 2) : str(fromDouble(value, decimals)) {}
+
+    const char* c_str() const { return str.c_str(); }
+    unsigned int length() const { return (unsigned int)str.length(); }
+    bool isEmpty() const { return str.empty(); }
+    char charAt(unsigned int index) const { return index < str.length() ? str[index] : 0; }
+    char operator[](unsigned int index) const { return charAt(index); }
+
+    String& operator+=(const String& other) { str += other.str; return *this; }
+    String& operator+=(const char* other) { str += other ? other : ""; return *this; }
+    String& operator+=(char c) { str += c; return *this; }
+    bool concat(const String& other) { str += other.str; return true; }
+
+    bool operator==(const String& other) const { return str == other.str; }
+    bool operator==(const char* other) const { return str == (other ? other : ""); }
+    bool operator!=(const String& other) const { return str != other.str; }
+    bool equals(const String& other) const { return str == other.str; }
+
+    int indexOf(char c, unsigned int from = 0) const {
+        size_t pos = str.find(c, from);
+        return pos == std::string::npos ? -1 : (int)pos;
+    }
+    int indexOf(const String& s, unsigned int from = 0) const {
+        size_t pos = str.find(s.str, from);
+        return pos == std::string::npos ? -1 : (int)pos;
+    }
+    String substring(unsigned int from) const { return from < str.length() ? String(str.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const {
+        return from < to && from < str.length() ? String(str.substr(from, to - from)) : String();
+    }
+    void trim() {
+        size_t first = str.find_first_not_of(" \t\r\n");
+        size_t last = str.find_last_not_of(" \t\r\n");
+        str = first == std::string::npos ? std::string() : str.substr(first, last - first + 1);
+    }
+    long toInt() const { return strtol(str.c_str(), nullptr, 10); }
+    float toFloat() const { return strtof(str.c_str(), nullptr); }
+
+    friend String operator+(const String& a, const String& b) { return String(a.str + b.str); }
+    friend String operator+(const String& a, const char* b) { return String(a.str + (b ? b : "")); }
+    friend String operator+(const char* a, const String& b) { return String((a ? a : "") + b.str); }
+
+private:
+    static std::string fromLong(long value, unsigned char base);
+    static std::string fromUnsigned(unsigned long value, unsigned char base);
+    static std::string fromDouble(double value, unsigned int decimals);
+
+    std::string str;
+};
+
+#endif // SHIM_WSTRING_H
@@ -0,0 +1,8 @@
+#ifndef SHIM_DRIVER_GPIO_H
+#define SHIM_DRIVER_GPIO_H
+
+typedef int gpio_num_t;
+
+#define GPIO_NUM_NC -1
+
+#endif // SHIM_DRIVER_GPIO_H
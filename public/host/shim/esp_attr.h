@@ -0,0 +1,14 @@
+#ifndef SHIM_ESP_ATTR_H
+#define SHIM_ESP_ATTR_H
+
+// Section placement has no meaning on the host, except that RTC memory
+// gets a section of its own for VirtualDevice::powerOnReset() to clear
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_DATA_ATTR __attribute__((section("rtc_data")))
+#define RTC_NOINIT_ATTR
+#define RTC_FAST_ATTR
+#define RTC_SLOW_ATTR
+#define EXT_RAM_ATTR
+
+#endif // SHIM_ESP_ATTR_H
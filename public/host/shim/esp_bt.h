@@ -0,0 +1,6 @@
+#ifndef SHIM_ESP_BT_H
+#define SHIM_ESP_BT_H
+
+#include "esp_err.h"
+
+#endif // SHIM_ESP_BT_H
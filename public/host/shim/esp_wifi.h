@@ -0,0 +1,8 @@
+#ifndef SHIM_ESP_WIFI_H
+#define SHIM_ESP_WIFI_H
+
+#include "esp_err.h"
+
+// The radio is not simulated; only referenced from commented-out code paths
+
+#endif // SHIM_ESP_WIFI_H
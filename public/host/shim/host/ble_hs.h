@@ -0,0 +1,212 @@
+#ifndef SHIM_BLE_HS_H
+#define SHIM_BLE_HS_H
+
+#include <stdint.h>
+#include "os/os_mbuf.h"
+
+// The part of the NimBLE host API the firmware uses, with NimBLE's names
+// and values. Nothing here is implemented: the NimBLE backend is only
+// compiled on the host, to keep it building (the simulator's central
+// stands in for a BLE stack, sim/ble_central.cpp).
+
+// Return codes
+#define BLE_HS_EALREADY                 2
+#define BLE_HS_EINVAL                   3
+#define BLE_HS_ENOMEM                   6
+#define BLE_HS_ENOTCONN                 7
+#define BLE_HS_EBUSY                    15
+#define BLE_HS_EREJECT                  16
+#define BLE_HS_ESTALLED                 31
+
+#define BLE_HS_CONN_HANDLE_NONE         0xffff
+#define BLE_HS_FOREVER                  INT32_MAX
+
+// ===================================================================
+// UUIDS
+// ===================================================================
+
+#define BLE_UUID_TYPE_16                16
+#define BLE_UUID_TYPE_32                32
+#define BLE_UUID_TYPE_128               128
+
+typedef struct {
+    uint8_t type;
+} ble_uuid_t;
+
+typedef struct {
+    ble_uuid_t u;
+    uint16_t value;
+} ble_uuid16_t;
+
+typedef struct {
+    ble_uuid_t u;
+    uint32_t value;
+} ble_uuid32_t;
+
+typedef struct {
+    ble_uuid_t u;
+    uint8_t value[16];      // Little endian
+} ble_uuid128_t;
+
+typedef union {
+    ble_uuid_t u;
+    ble_uuid16_t u16;
+    ble_uuid32_t u32;
+    ble_uuid128_t u128;
+} ble_uuid_any_t;
+
+typedef struct {
+    uint8_t type;
+    uint8_t val[6];
+} ble_addr_t;
+
+// ===================================================================
+// ATT AND GATT SERVER
+// ===================================================================
+
+#define BLE_ATT_MTU_DFLT                        23
+#define BLE_ATT_ATTR_MAX_LEN                    512
+#define BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN      0x0d
+#define BLE_ATT_ERR_UNLIKELY                    0x0e
+#define BLE_ATT_ERR_INSUFFICIENT_RES            0x11
+
+#define BLE_GATT_ACCESS_OP_READ_CHR     0
+#define BLE_GATT_ACCESS_OP_WRITE_CHR    1
+#define BLE_GATT_ACCESS_OP_READ_DSC     2
+#define BLE_GATT_ACCESS_OP_WRITE_DSC    3
+
+#define BLE_GATT_SVC_TYPE_END           0
+#define BLE_GATT_SVC_TYPE_PRIMARY       1
+
+#define BLE_GATT_CHR_F_READ             0x0002
+#define BLE_GATT_CHR_F_WRITE_NO_RSP     0x0004
+#define BLE_GATT_CHR_F_WRITE            0x0008
+#define BLE_GATT_CHR_F_NOTIFY           0x0010
+
+typedef uint16_t ble_gatt_chr_flags;
+
+struct ble_gatt_access_ctxt {
+    uint8_t op;
+    struct os_mbuf* om;     // Read: append the value; write: the value written
+};
+
+typedef int ble_gatt_access_fn(uint16_t conn_handle, uint16_t attr_handle,
+                               struct ble_gatt_access_ctxt* ctxt, void* arg);
+
+struct ble_gatt_chr_def {
+    const ble_uuid_t* uuid;
+    ble_gatt_access_fn* access_cb;
+    void* arg;
+    ble_gatt_chr_flags flags;
+    uint16_t* val_handle;
+};
+
+struct ble_gatt_svc_def {
+    uint8_t type;
+    const ble_uuid_t* uuid;
+    const struct ble_gatt_chr_def* characteristics;     // Ends with a zeroed entry
+};
+
+int ble_gatts_count_cfg(const struct ble_gatt_svc_def* defs);
+int ble_gatts_add_svcs(const struct ble_gatt_svc_def* defs);
+
+/** Takes om whatever it returns */
+int ble_gatts_notify_custom(uint16_t conn_handle, uint16_t att_handle, struct os_mbuf* om);
+
+uint16_t ble_att_mtu(uint16_t conn_handle);
+int ble_att_set_preferred_mtu(uint16_t mtu);
+
+struct os_mbuf* ble_hs_mbuf_from_flat(const void* buf, uint16_t len);
+int ble_hs_mbuf_to_flat(const struct os_mbuf* om, void* flat, uint16_t max_len, uint16_t* out_copy_len);
+
+// ===================================================================
+// GAP
+// ===================================================================
+
+#define BLE_GAP_EVENT_CONNECT           0
+#define BLE_GAP_EVENT_DISCONNECT        1
+
+#define BLE_GAP_CONN_MODE_UND           2
+#define BLE_GAP_DISC_MODE_GEN           2
+
+#define BLE_HS_ADV_F_DISC_GEN           0x02
+#define BLE_HS_ADV_F_BREDR_UNSUP        0x04
+
+struct ble_gap_conn_desc {
+    ble_addr_t peer_id_addr;
+    uint16_t conn_handle;
+    uint16_t conn_itvl;             // 1.25 ms units
+    uint16_t conn_latency;
+    uint16_t supervision_timeout;   // 10 ms units
+};
+
+struct ble_gap_event {
+    uint8_t type;
+    union {
+        struct {
+            int status;
+            uint16_t conn_handle;
+        } connect;
+        struct {
+            int reason;
+            struct ble_gap_conn_desc conn;
+        } disconnect;
+    };
+};
+
+typedef int ble_gap_event_fn(struct ble_gap_event* event, void* arg);
+
+struct ble_gap_adv_params {
+    uint8_t conn_mode;
+    uint8_t disc_mode;
+    uint16_t itvl_min;
+    uint16_t itvl_max;
+};
+
+struct ble_gap_upd_params {
+    uint16_t itvl_min;
+    uint16_t itvl_max;
+    uint16_t latency;
+    uint16_t supervision_timeout;
+    uint16_t min_ce_len;
+    uint16_t max_ce_len;
+};
+
+struct ble_hs_adv_fields {
+    uint8_t flags;
+    const ble_uuid16_t* uuids16;
+    uint8_t num_uuids16;
+    unsigned uuids16_is_complete : 1;
+    const ble_uuid128_t* uuids128;
+    uint8_t num_uuids128;
+    unsigned uuids128_is_complete : 1;
+    const uint8_t* name;
+    uint8_t name_len;
+    unsigned name_is_complete : 1;
+};
+
+int ble_gap_conn_find(uint16_t handle, struct ble_gap_conn_desc* out_desc);
+int ble_gap_adv_set_fields(const struct ble_hs_adv_fields* fields);
+int ble_gap_adv_rsp_set_fields(const struct ble_hs_adv_fields* fields);
+int ble_gap_adv_start(uint8_t own_addr_type, const ble_addr_t* direct_addr, int32_t duration_ms,
+                      const struct ble_gap_adv_params* params, ble_gap_event_fn* cb, void* cb_arg);
+int ble_gap_adv_stop();
+int ble_gap_update_params(uint16_t conn_handle, const struct ble_gap_upd_params* params);
+
+// ===================================================================
+// HOST
+// ===================================================================
+
+typedef void ble_hs_sync_fn();
+typedef void ble_hs_reset_fn(int reason);
+
+struct ble_hs_cfg {
+    ble_hs_reset_fn* reset_cb;
+    ble_hs_sync_fn* sync_cb;
+};
+
+extern struct ble_hs_cfg ble_hs_cfg;
+
+int ble_hs_id_infer_auto(int privacy, uint8_t* out_addr_type);
+
+#endif // SHIM_BLE_HS_H
@@ -0,0 +1,71 @@
+#ifndef SHIM_BLE_L2CAP_H
+#define SHIM_BLE_L2CAP_H
+
+#include <stdint.h>
+#include "os/os_mbuf.h"
+
+// NimBLE's LE connection-oriented channels, as l2cap_channel.cpp uses
+// them. test_l2cap_channel.cpp implements these against its own client
+
+#define BLE_L2CAP_EVENT_COC_CONNECTED       0
+#define BLE_L2CAP_EVENT_COC_DISCONNECTED    1
+#define BLE_L2CAP_EVENT_COC_ACCEPT          2
+#define BLE_L2CAP_EVENT_COC_DATA_RECEIVED   3
+#define BLE_L2CAP_EVENT_COC_TX_UNSTALLED    4
+
+struct ble_l2cap_chan;
+
+struct ble_l2cap_event {
+    int type;
+    union {
+        struct {
+            int status;
+            uint16_t conn_handle;
+            struct ble_l2cap_chan* chan;
+        } connect;
+        struct {
+            uint16_t conn_handle;
+            struct ble_l2cap_chan* chan;
+        } disconnect;
+        struct {
+            uint16_t conn_handle;
+            uint16_t peer_sdu_size;
+            struct ble_l2cap_chan* chan;
+        } accept;
+        struct {
+            uint16_t conn_handle;
+            struct ble_l2cap_chan* chan;
+            struct os_mbuf* sdu_rx;
+        } receive;
+        struct {
+            uint16_t conn_handle;
+            struct ble_l2cap_chan* chan;
+            int status;
+        } tx_unstalled;
+    };
+};
+
+struct ble_l2cap_chan_info {
+    uint16_t scid;
+    uint16_t dcid;
+    uint16_t our_l2cap_mtu;
+    uint16_t peer_l2cap_mtu;        // MPS
+    uint16_t psm;
+    uint16_t our_coc_mtu;
+    uint16_t peer_coc_mtu;          // SDU MTU
+};
+
+typedef int ble_l2cap_event_fn(struct ble_l2cap_event* event, void* arg);
+
+int ble_l2cap_create_server(uint16_t psm, uint16_t mtu, ble_l2cap_event_fn* cb, void* cb_arg);
+
+/**
+ * @return 0, or BLE_HS_ESTALLED if the SDU was taken but waits for
+ *         credits (COC_TX_UNSTALLED follows); on any other error the
+ *         caller still owns sdu_tx
+ */
+int ble_l2cap_send(struct ble_l2cap_chan* chan, struct os_mbuf* sdu_tx);
+int ble_l2cap_recv_ready(struct ble_l2cap_chan* chan, struct os_mbuf* sdu_rx);
+int ble_l2cap_get_chan_info(struct ble_l2cap_chan* chan, struct ble_l2cap_chan_info* chan_info);
+
+#endif // SHIM_BLE_L2CAP_H
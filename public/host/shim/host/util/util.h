@@ -0,0 +1,6 @@
+#ifndef SHIM_HOST_UTIL_H
+#define SHIM_HOST_UTIL_H
+
+int ble_hs_util_ensure_addr(int prefer_random);
+
+#endif // SHIM_HOST_UTIL_H
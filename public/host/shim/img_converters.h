@@ -0,0 +1,15 @@
+#ifndef SHIM_IMG_CONVERTERS_H
+#define SHIM_IMG_CONVERTERS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_camera.h"
+
+// JPEG encoding of raw frames (esp32-camera's to_jpg.cpp). The host
+// encodes grayscale only, with the simulator's baseline encoder; *out is
+// malloc()ed and freed by the caller, as on the device.
+
+bool fmt2jpg(uint8_t* src, size_t src_len, uint16_t width, uint16_t height, pixformat_t format, uint8_t quality,
+             uint8_t** out, size_t* out_len);
+
+#endif // SHIM_IMG_CONVERTERS_H
@@ -0,0 +1,12 @@
+#ifndef SHIM_NIMBLE_PORT_H
+#define SHIM_NIMBLE_PORT_H
+
+#include "esp_err.h"
+
+// The NimBLE host is only type-checked on the host (see host/ble_hs.h)
+
+esp_err_t nimble_port_init();
+void nimble_port_run();
+esp_err_t nimble_port_deinit();
+
+#endif // SHIM_NIMBLE_PORT_H
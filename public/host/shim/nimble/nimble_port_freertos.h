@@ -0,0 +1,9 @@
+#ifndef SHIM_NIMBLE_PORT_FREERTOS_H
+#define SHIM_NIMBLE_PORT_FREERTOS_H
+
+#include "freertos/task.h"
+
+void nimble_port_freertos_init(TaskFunction_t hostTask);
+void nimble_port_freertos_deinit();
+
+#endif // SHIM_NIMBLE_PORT_FREERTOS_H
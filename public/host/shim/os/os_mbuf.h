@@ -0,0 +1,19 @@
+#ifndef SHIM_OS_MBUF_H
+#define SHIM_OS_MBUF_H
+
+#include <stdint.h>
+
+/**
+ * Packet buffer: one link of a chain holding an SDU or an ATT payload
+ */
+struct os_mbuf {
+    uint8_t* om_data;
+    uint16_t om_len;
+    struct os_mbuf* om_next;
+};
+
+struct os_mbuf* os_msys_get_pkthdr(uint16_t dsize, uint16_t user_hdr_len);
+int os_mbuf_append(struct os_mbuf* om, const void* data, uint16_t len);
+int os_mbuf_free_chain(struct os_mbuf* om);
+
+#endif // SHIM_OS_MBUF_H
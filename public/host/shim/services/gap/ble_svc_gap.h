@@ -0,0 +1,8 @@
+#ifndef SHIM_BLE_SVC_GAP_H
+#define SHIM_BLE_SVC_GAP_H
+
+void ble_svc_gap_init();
+const char* ble_svc_gap_device_name();
+int ble_svc_gap_device_name_set(const char* name);
+
+#endif // SHIM_BLE_SVC_GAP_H
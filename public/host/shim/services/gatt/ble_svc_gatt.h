@@ -0,0 +1,6 @@
+#ifndef SHIM_BLE_SVC_GATT_H
+#define SHIM_BLE_SVC_GATT_H
+
+void ble_svc_gatt_init();
+
+#endif // SHIM_BLE_SVC_GATT_H
@@ -0,0 +1,146 @@
+#include "virtual_device.h"
+#include <driver/i2s.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+// ===================================================================
+// MICROPHONE (WAV replay over I2S)
+// ===================================================================
+
+static std::vector<int16_t> wavSamples;
+static uint32_t wavRate = 0;
+static size_t wavPosition = 0;
+
+static bool installed = false;
+static uint32_t i2sRate = 16000;
+static size_t dmaCapacity = 0;             // Samples the DMA ring holds before overrunning
+static uint64_t startUs = 0;
+static uint64_t samplesConsumed = 0;       // Captured samples handed out or dropped
+
+static uint32_t readLe(const uint8_t* p, int bytes) {
+    uint32_t value = 0;
+    for (int i = bytes - 1; i >= 0; i--) value = (value << 8) | p[i];
+    return value;
+}
+
+namespace VirtualDevice {
+    bool loadWav(const char* path) {
+        FILE* fp = fopen(path, "rb");
+        if (!fp) return false;
+        std::vector<uint8_t> data;
+        uint8_t buffer[4096];
+        size_t n;
+        while ((n = fread(buffer, 1, sizeof(buffer), fp)) > 0) {
+            data.insert(data.end(), buffer, buffer + n);
+        }
+        fclose(fp);
+
+        if (data.size() < 12 || memcmp(&data[0], "RIFF", 4) != 0 || memcmp(&data[8], "WAVE", 4) != 0) {
+            return false;
+        }
+
+        uint16_t channels = 0, bits = 0;
+        size_t pos = 12;
+        while (pos + 8 <= data.size()) {
+            uint32_t chunkSize = readLe(&data[pos + 4], 4);
+            const uint8_t* body = &data[pos + 8];
+            size_t bodySize = std::min((size_t)chunkSize, data.size() - pos - 8);
+
+            if (memcmp(&data[pos], "fmt ", 4) == 0 && bodySize >= 16) {
+                channels = readLe(body + 2, 2);
+                wavRate = readLe(body + 4, 4);
+                bits = readLe(body + 14, 2);
+            } else if (memcmp(&data[pos], "data", 4) == 0 && channels > 0 && (bits == 8 || bits == 16)) {
+                size_t frameBytes = channels * bits / 8;
+                wavSamples.clear();
+                for (size_t i = 0; i + frameBytes <= bodySize; i += frameBytes) {
+                    int16_t sample = bits == 16 ? (int16_t)readLe(body + i, 2) : (int16_t)((body[i] - 128) << 8);
+                    wavSamples.push_back(sample);
+                }
+                wavPosition = 0;
+                return !wavSamples.empty();
+            }
+            pos += 8 + chunkSize + (chunkSize & 1);
+        }
+        return false;
+    }
+}
+
+static int16_t nextSample() {
+    if (wavSamples.empty()) return 0;
+    // Nearest-sample rate conversion from the file rate to the I2S rate
+    size_t index = (size_t)(wavPosition * (uint64_t)wavRate / i2sRate) % wavSamples.size();
+    wavPosition++;
+    return wavSamples[index];
+}
+
+static uint64_t capturedSamples() {
+    return (VirtualDevice::nowUs() - startUs) * i2sRate / 1000000;
+}
+
+esp_err_t i2s_driver_install(i2s_port_t port, const i2s_config_t* config, int queue_size, void* queue) {
+    (void)port;
+    (void)queue_size;
+    (void)queue;
+    if (!config || config->sample_rate == 0) return ESP_ERR_INVALID_ARG;
+    if (installed) return ESP_ERR_INVALID_STATE;
+    i2sRate = config->sample_rate;
+    dmaCapacity = (size_t)config->dma_buf_count * config->dma_buf_len;
+    startUs = VirtualDevice::nowUs();
+    samplesConsumed = 0;
+    installed = true;
+    return ESP_OK;
+}
+
+esp_err_t i2s_driver_uninstall(i2s_port_t port) {
+    (void)port;
+    installed = false;
+    return ESP_OK;
+}
+
+esp_err_t i2s_set_pin(i2s_port_t port, const i2s_pin_config_t* pins) {
+    (void)port;
+    return pins ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t i2s_zero_dma_buffer(i2s_port_t port) {
+    (void)port;
+    return installed ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t i2s_read(i2s_port_t port, void* dest, size_t size, size_t* bytes_read, TickType_t ticks_to_wait) {
+    (void)port;
+    if (!installed) return ESP_ERR_INVALID_STATE;
+
+    size_t wanted = size / sizeof(int16_t);
+
+    // Samples that arrived while nobody was reading overran the DMA ring
+    uint64_t available = capturedSamples() - samplesConsumed;
+    if (available > dmaCapacity) {
+        uint64_t dropped = available - dmaCapacity;
+        for (uint64_t i = 0; i < dropped; i++) nextSample();
+        samplesConsumed += dropped;
+        VirtualDevice::stats()->audio_samples_dropped += dropped;
+        available = dmaCapacity;
+    }
+
+    // Block until the rest has been captured, up to the timeout
+    if (available < wanted) {
+        uint64_t readyUs = startUs + ((samplesConsumed + wanted) * 1000000 + i2sRate - 1) / i2sRate;
+        uint64_t timeoutUs = VirtualDevice::nowUs() + (uint64_t)ticks_to_wait * portTICK_PERIOD_MS * 1000;
+        VirtualDevice::advanceTo(std::min(readyUs, timeoutUs));
+        available = capturedSamples() - samplesConsumed;
+    }
+
+    size_t count = (size_t)std::min<uint64_t>(available, wanted);
+    int16_t* out = (int16_t*)dest;
+    for (size_t i = 0; i < count; i++) {
+        out[i] = nextSample();
+    }
+    samplesConsumed += count;
+    VirtualDevice::stats()->audio_samples_read += count;
+
+    *bytes_read = count * sizeof(int16_t);
+    return count > 0 ? ESP_OK : ESP_ERR_TIMEOUT;
+}
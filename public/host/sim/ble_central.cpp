@@ -0,0 +1,331 @@
+#include "virtual_device.h"
+#include "ble_link_model.h"
+#include "packet_log.h"
+#include "features/bluetooth/ble_backend.h"
+#include <ctype.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+// ===================================================================
+// BLE (single simulated central)
+// ===================================================================
+
+// What the firmware created through the transport, by handle
+typedef struct {
+    std::string uuid;
+    uint8_t properties;
+    std::vector<uint8_t> value;
+} mock_characteristic_t;
+
+static bool servicesStarted = false;
+static std::vector<std::string> services;
+static std::vector<mock_characteristic_t> characteristics;
+static uint16_t localMtu = 23;
+static uint16_t centralMtu = 247;
+static bool connected = false;
+static bool advertisingActive = false;
+static FILE* packetLog = nullptr;
+static std::vector<VirtualDevice::stream_stats_t> streams;
+
+// Optional link model between notify() and the central
+static bool linkEnabled = false;
+static ble_link_config_t linkConfig;
+static BleLinkModel* link = nullptr;
+
+// Connection parameters the central asks for: 30 ms interval, no latency, 4 s timeout
+static const uint16_t CENTRAL_CONN_INTERVAL = 24;
+static const uint16_t CENTRAL_CONN_LATENCY = 0;
+static const uint16_t CENTRAL_SUPERVISION_TIMEOUT = 400;
+static const uint8_t CENTRAL_ADDRESS[6] = {0x5a, 0x1d, 0x00, 0x00, 0x00, 0x01};
+
+// Characteristics the OpenGlass app listens to
+static const struct {
+    const char* uuid;
+    const char* name;
+} KNOWN_STREAMS[] = {
+    {"19B10001-E8F2-537E-4F6C-D104768A1214", "audio"},
+    {"19B10005-E8F2-537E-4F6C-D104768A1214", "photo"},
+    {"19B10007-E8F2-537E-4F6C-D104768A1214", "device_status"},
+    {"19B10008-E8F2-537E-4F6C-D104768A1214", "video"},
+    {"19B1000A-E8F2-537E-4F6C-D104768A1214", "video_status"},
+    {"19B1000C-E8F2-537E-4F6C-D104768A1214", "hotspot_status"},
+    {"00002A19-0000-1000-8000-00805F9B34FB", "battery"},
+};
+static const size_t KNOWN_STREAM_COUNT = sizeof(KNOWN_STREAMS) / sizeof(KNOWN_STREAMS[0]);
+
+// ===================================================================
+// MOCK BACKEND (BLE_BACKEND_MOCK)
+// ===================================================================
+
+// Upper case; 16-bit UUIDs in the Bluetooth base UUID, as the app lists them
+static std::string canonicalUuid(const char* uuid) {
+    std::string text;
+    for (const char* p = uuid; p && *p; p++) {
+        text += (char)toupper((unsigned char)*p);
+    }
+    if (text.size() == 4) text = "0000" + text + "-0000-1000-8000-00805F9B34FB";
+    return text;
+}
+
+static int findCharacteristic(const std::string& uuid) {
+    for (size_t i = 0; i < characteristics.size(); i++) {
+        if (characteristics[i].uuid == uuid) return (int)i;
+    }
+    return -1;
+}
+
+namespace BleBackend {
+    const char* name() {
+        return "mock";
+    }
+
+    bool begin(const char* name, uint16_t mtu) {
+        (void)name;
+        localMtu = mtu;
+        servicesStarted = false;
+        services.clear();
+        characteristics.clear();
+        return true;
+    }
+
+    bool createService(ble_handle_t service, const char* uuid) {
+        (void)service;
+        services.push_back(canonicalUuid(uuid));
+        return true;
+    }
+
+    bool createCharacteristic(ble_handle_t characteristic, ble_handle_t service, const char* uuid,
+                              uint8_t properties) {
+        (void)characteristic;
+        (void)service;
+        mock_characteristic_t created = {canonicalUuid(uuid), properties, std::vector<uint8_t>()};
+        characteristics.push_back(created);
+        return true;
+    }
+
+    bool startServices() {
+        servicesStarted = true;
+        return true;
+    }
+
+    void startAdvertising(const char* const* uuids, size_t count) {
+        (void)uuids;
+        (void)count;
+        advertisingActive = true;
+    }
+
+    void stopAdvertising() {
+        advertisingActive = false;
+    }
+
+    void setValue(ble_handle_t characteristic, const uint8_t* data, size_t length) {
+        characteristics[characteristic].value.assign(data, data + length);
+    }
+
+    bool notify(ble_handle_t characteristic, const uint8_t* data, size_t length) {
+        setValue(characteristic, data, length);
+        VirtualDevice::onNotify(characteristics[characteristic].uuid, data, length);
+        return true;
+    }
+
+    uint16_t peerMtu() {
+        return std::min(localMtu, centralMtu);
+    }
+
+    void requestConnParams(uint16_t interval, uint16_t latency, uint16_t timeout) {
+        (void)interval;
+        (void)latency;
+        (void)timeout;
+    }
+}
+
+// ===================================================================
+// CENTRAL
+// ===================================================================
+
+static uint8_t linkStreamId(const std::string& uuid) {
+    for (size_t i = 0; i < KNOWN_STREAM_COUNT; i++) {
+        if (uuid == KNOWN_STREAMS[i].uuid) return (uint8_t)i;
+    }
+    return BLE_LINK_MAX_STREAMS - 1;
+}
+
+static void logPacket(uint64_t time_us, const char* name, const uint8_t* data, size_t length) {
+    if (packetLog) {
+        writePacketLogLine(packetLog, time_us, name, data, length);
+    }
+}
+
+static void onLinkDelivery(void* ctx, uint8_t stream, uint64_t sent_us, uint64_t delivered_us,
+                           const uint8_t* data, size_t length) {
+    (void)ctx;
+    (void)sent_us;
+    logPacket(delivered_us, stream < KNOWN_STREAM_COUNT ? KNOWN_STREAMS[stream].name : "other", data, length);
+}
+
+static VirtualDevice::stream_stats_t* streamFor(const std::string& uuid) {
+    for (size_t i = 0; i < streams.size(); i++) {
+        if (streams[i].uuid == uuid) return &streams[i];
+    }
+    VirtualDevice::stream_stats_t stream = {uuid, 0, 0};
+    streams.push_back(stream);
+    return &streams.back();
+}
+
+namespace VirtualDevice {
+    bool openPacketLog(const char* path) {
+        closePacketLog();
+        packetLog = strcmp(path, "-") == 0 ? stdout : fopen(path, "w");
+        if (!packetLog) return false;
+        writePacketLogHeader(packetLog);
+        return true;
+    }
+
+    void closePacketLog() {
+        if (packetLog && packetLog != stdout) fclose(packetLog);
+        packetLog = nullptr;
+    }
+
+    void setPeerMtu(uint16_t mtu) {
+        centralMtu = mtu;
+    }
+
+    uint16_t peerMtu() {
+        return centralMtu;
+    }
+
+    void connect() {
+        if (connected || !servicesStarted) return;
+        connected = true;
+        advertisingActive = false;
+
+        if (linkEnabled) {
+            if (!link) {
+                linkConfig.mtu = std::min(localMtu, centralMtu);
+                link = new BleLinkModel(linkConfig);
+                link->setDeliveryCallback(onLinkDelivery, nullptr);
+            }
+            link->connect(nowUs());
+        }
+
+        ble_connection_t connection;
+        memcpy(connection.address, CENTRAL_ADDRESS, sizeof(CENTRAL_ADDRESS));
+        connection.interval = CENTRAL_CONN_INTERVAL;
+        connection.latency = CENTRAL_CONN_LATENCY;
+        connection.timeout = CENTRAL_SUPERVISION_TIMEOUT;
+        BleTransport::onConnected(&connection);
+    }
+
+    void disconnect() {
+        if (!connected) return;
+        connected = false;
+        if (link) {
+            link->disconnect(nowUs());
+        }
+        BleTransport::onDisconnected();
+    }
+
+    bool isConnected() {
+        return connected;
+    }
+
+    bool isAdvertising() {
+        return advertisingActive;
+    }
+
+    bool writeCharacteristic(const char* uuid, const uint8_t* data, size_t length) {
+        int handle = findCharacteristic(canonicalUuid(uuid));
+        if (handle < 0 || !(characteristics[handle].properties & BLE_PROPERTY_WRITE)) return false;
+
+        characteristics[handle].value.assign(data, data + length);
+        stats()->writes++;
+        BleTransport::onWritten(handle, data, length);
+        return true;
+    }
+
+    bool readCharacteristic(const char* uuid, std::vector<uint8_t>* value) {
+        int handle = findCharacteristic(canonicalUuid(uuid));
+        if (handle < 0 || !(characteristics[handle].properties & BLE_PROPERTY_READ)) return false;
+        *value = characteristics[handle].value;
+        return true;
+    }
+
+    void onNotify(const std::string& uuid, const uint8_t* data, size_t length) {
+        // The central subscribes to everything once connected
+        if (!connected) return;
+
+        stream_stats_t* stream = streamFor(uuid);
+        stream->packets++;
+        stream->bytes += length;
+
+        if (!link) {
+            logPacket(nowUs(), streamName(uuid), data, length);
+            return;
+        }
+
+        // Logged on delivery; with backpressure the caller waits for queue space
+        uint8_t id = linkStreamId(uuid);
+        link->service(nowUs());
+        if (link->send(id, nowUs(), data, length) == BLE_LINK_FULL) {
+            advanceTo(link->waitForSpace(id, nowUs()));
+            link->send(id, nowUs(), data, length);
+        }
+    }
+
+    void enableLink(const ble_link_config_t& config) {
+        linkEnabled = true;
+        linkConfig = config;
+    }
+
+    void finishRun() {
+        if (!link) return;
+        // Whatever is still queued gets the air time it needs
+        link->service(nowUs());
+        link->drain(nowUs() + 60000000ULL);
+    }
+
+    const char* streamName(const std::string& uuid) {
+        for (size_t i = 0; i < KNOWN_STREAM_COUNT; i++) {
+            if (uuid == KNOWN_STREAMS[i].uuid) return KNOWN_STREAMS[i].name;
+        }
+        return uuid.c_str();
+    }
+
+    size_t streamCount() {
+        return streams.size();
+    }
+
+    const stream_stats_t* streamStats(size_t index) {
+        return index < streams.size() ? &streams[index] : nullptr;
+    }
+
+    void printSummary(FILE* out) {
+        double seconds = (nowUs() - runStartUs()) / 1e6;
+        const device_stats_t* s = stats();
+
+        fprintf(out, "=== Virtual Device Summary ===\n");
+        fprintf(out, "Virtual time: %.3f s%s\n", seconds, inDeepSleep() ? " (ended in deep sleep)" : "");
+        fprintf(out, "Camera frames: %u\n", s->frames_captured);
+        fprintf(out, "Audio samples: %llu read, %llu dropped\n",
+                (unsigned long long)s->audio_samples_read, (unsigned long long)s->audio_samples_dropped);
+        fprintf(out, "Timer callbacks: %u, writes: %u\n", s->timers_fired, s->writes);
+        for (size_t i = 0; i < streams.size(); i++) {
+            fprintf(out, "Notify %-14s %8u packets %10llu bytes %8.1f B/s\n",
+                    streamName(streams[i].uuid), streams[i].packets,
+                    (unsigned long long)streams[i].bytes, seconds > 0 ? streams[i].bytes / seconds : 0.0);
+        }
+        const ble_transport_stats_t* transport = BleTransport::stats();
+        fprintf(out, "BLE transport: %s, %u notifications, %llu bytes, %u dropped\n", transport->backend,
+                transport->notifications, (unsigned long long)transport->notify_bytes, transport->notify_failures);
+        if (link) {
+            const char* names[BLE_LINK_MAX_STREAMS] = {};
+            for (size_t i = 0; i < KNOWN_STREAM_COUNT && i < BLE_LINK_MAX_STREAMS; i++) {
+                names[i] = KNOWN_STREAMS[i].name;
+            }
+            names[BLE_LINK_MAX_STREAMS - 1] = "other";
+            link->printReport(out, names, seconds);
+        }
+        fprintf(out, "==============================\n");
+    }
+}
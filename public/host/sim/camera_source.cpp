@@ -0,0 +1,257 @@
+#include "virtual_device.h"
+#include <esp_camera.h>
+#include <img_converters.h>
+#include <dirent.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <algorithm>
+#include <vector>
+
+// ===================================================================
+// CAMERA (JPEG replay, synthetic grayscale and YUV422)
+// ===================================================================
+
+static std::vector<std::vector<uint8_t> > frames;
+static size_t nextFrame = 0;
+static uint32_t captureTimeUs = 60000;     // QVGA JPEG capture on the OV2640
+static bool cameraInitialized = false;
+static pixformat_t pixelFormat = PIXFORMAT_JPEG;
+static uint32_t sceneFrame = 0;
+static sensor_t sensor;
+
+// Code lying on the desk (setCameraCode)
+static std::vector<uint8_t> codeModules;
+static int codeColumns = 0;
+static int codeRows = 0;
+static bool codeIsBarcode = false;
+
+static void frameDimensions(framesize_t size, size_t* width, size_t* height) {
+    static const uint16_t DIMENSIONS[FRAMESIZE_INVALID][2] = {
+        {96, 96}, {160, 120}, {176, 144}, {240, 176}, {240, 240}, {320, 240}, {400, 296},
+        {480, 320}, {640, 480}, {800, 600}, {1024, 768}, {1280, 720}, {1280, 1024}, {1600, 1200},
+    };
+    if (size >= FRAMESIZE_INVALID) size = FRAMESIZE_QVGA;
+    *width = DIMENSIONS[size][0];
+    *height = DIMENSIONS[size][1];
+}
+
+static uint32_t hash32(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+static bool hasJpegExtension(const char* name) {
+    const char* dot = strrchr(name, '.');
+    return dot && (strcasecmp(dot, ".jpg") == 0 || strcasecmp(dot, ".jpeg") == 0);
+}
+
+static bool readFile(const std::string& path, std::vector<uint8_t>* out) {
+    FILE* fp = fopen(path.c_str(), "rb");
+    if (!fp) return false;
+    uint8_t buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), fp)) > 0) {
+        out->insert(out->end(), buffer, buffer + n);
+    }
+    fclose(fp);
+    return !out->empty();
+}
+
+namespace VirtualDevice {
+    size_t loadJpegDir(const char* dir) {
+        DIR* d = opendir(dir);
+        if (!d) return 0;
+
+        std::vector<std::string> names;
+        while (struct dirent* entry = readdir(d)) {
+            if (hasJpegExtension(entry->d_name)) {
+                names.push_back(entry->d_name);
+            }
+        }
+        closedir(d);
+        std::sort(names.begin(), names.end());
+
+        for (size_t i = 0; i < names.size(); i++) {
+            std::vector<uint8_t> data;
+            if (readFile(std::string(dir) + "/" + names[i], &data)) {
+                frames.push_back(data);
+            }
+        }
+        return frames.size();
+    }
+
+    bool setCameraCode(const std::string& text) {
+        codeModules.clear();
+        codeColumns = codeRows = 0;
+        if (text.empty()) return true;
+        if (text.compare(0, 6, "ean13:") == 0) {
+            if (!encodeEan13(text.substr(6), &codeModules)) return false;
+            codeColumns = (int)codeModules.size();
+            codeRows = 1;
+            codeIsBarcode = true;
+            return true;
+        }
+        int dimension = encodeQr(text, 1, (int)(text.size() % 8), &codeModules);
+        codeColumns = codeRows = dimension;
+        codeIsBarcode = false;
+        return dimension > 0;
+    }
+
+    void setCaptureTimeUs(uint32_t us) {
+        captureTimeUs = us;
+    }
+
+    void renderDeskScene(uint8_t* out, size_t width, size_t height, uint32_t frame) {
+        // Laid out at 320x240 and scaled
+        bool handInView = (frame / 40) % 3 != 0;
+        double handX = 220 + 60 * sin(frame * 0.15);
+        double handY = 120 + 25 * cos(frame * 0.11);
+
+        for (size_t y = 0; y < height; y++) {
+            for (size_t x = 0; x < width; x++) {
+                int u = (int)(x * 320 / width);
+                int v = (int)(y * 240 / height);
+
+                // Wood grain
+                int value = 90 + (u + v) / 16 + (int)(hash32(v / 2 * 977 + u / 24) & 7);
+                // Paper with lines of text
+                if (u >= 40 && u < 150 && v >= 30 && v < 130) {
+                    value = 205;
+                    if (u >= 50 && u < 140 && v % 12 >= 4 && v % 12 < 7 && (hash32(u / 7 * 131 + v / 12) & 3)) {
+                        value = 70;
+                    }
+                }
+                // Keyboard
+                if (u >= 170 && u < 300 && v >= 150 && v < 225) {
+                    value = ((u - 170) % 14 < 11 && (v - 150) % 14 < 11) ? 85 : 45;
+                }
+                // Hand
+                if (handInView) {
+                    double dx = (u - handX) / 45.0, dy = (v - handY) / 30.0;
+                    if (dx * dx + dy * dy < 1.0) value = 150 + (int)(25 * dy) + (int)(hash32(u * 7 + v * 3) & 3);
+                }
+                // Sensor noise
+                value += (int)(hash32((uint32_t)(y * width + x) * 2654435761U + frame) % 5) - 2;
+                out[y * width + x] = (uint8_t)(value < 0 ? 0 : (value > 255 ? 255 : value));
+            }
+        }
+    }
+}
+
+static int setFramesize(sensor_t* s, framesize_t framesize) { s->framesize = framesize; return 0; }
+static int setQuality(sensor_t* s, int quality) { s->quality = quality; return 0; }
+static int setLevel(sensor_t* s, int level) { (void)s; (void)level; return 0; }
+
+esp_err_t esp_camera_init(const camera_config_t* config) {
+    if (!config) return ESP_ERR_INVALID_ARG;
+    memset(&sensor, 0, sizeof(sensor));
+    sensor.id.PID = 0x26;                   // OV2640
+    sensor.framesize = config->frame_size;
+    sensor.quality = config->jpeg_quality;
+    sensor.set_framesize = setFramesize;
+    sensor.set_quality = setQuality;
+    sensor.set_brightness = setLevel;
+    sensor.set_contrast = setLevel;
+    pixelFormat = config->pixel_format;
+    cameraInitialized = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_camera_deinit() {
+    cameraInitialized = false;
+    return ESP_OK;
+}
+
+camera_fb_t* esp_camera_fb_get() {
+    if (!cameraInitialized) return nullptr;
+
+    // Exposure + readout + JPEG encode
+    VirtualDevice::advanceUs(captureTimeUs);
+
+    if (pixelFormat == PIXFORMAT_GRAYSCALE || pixelFormat == PIXFORMAT_YUV422) {
+        camera_fb_t* fb = new camera_fb_t();
+        frameDimensions(sensor.framesize, &fb->width, &fb->height);
+        fb->len = fb->width * fb->height;
+        fb->buf = (uint8_t*)malloc(pixelFormat == PIXFORMAT_YUV422 ? fb->len * 2 : fb->len);
+        VirtualDevice::renderDeskScene(fb->buf, fb->width, fb->height, sceneFrame);
+        if (codeColumns > 0) {
+            // On the paper, a little turned and tilted, with the scene's noise
+            VirtualDevice::code_placement_t placement = VirtualDevice::defaultCodePlacement();
+            placement.centerX = fb->width * 0.33;
+            placement.centerY = fb->height * 0.45;
+            placement.angle = 8;
+            placement.tilt = 0.05;
+            placement.noise = 3;
+            placement.seed = sceneFrame;
+            placement.dark = 50;
+            placement.light = 200;
+            if (codeIsBarcode) {
+                placement.moduleSize = fb->width / 240.0;
+                placement.rowsPerModule = 50;
+                placement.quietZone = 9;
+            } else {
+                placement.moduleSize = fb->height * 0.45 / (codeColumns + 8);
+            }
+            VirtualDevice::drawCode(fb->buf, fb->width, fb->height, codeModules, codeColumns, codeRows, placement);
+        }
+        sceneFrame++;
+        if (pixelFormat == PIXFORMAT_YUV422) {
+            // Y0 U Y1 V with neutral chroma, spread from the back in place
+            for (size_t i = fb->len; i-- > 0;) {
+                fb->buf[2 * i] = fb->buf[i];
+                fb->buf[2 * i + 1] = 128;
+            }
+            fb->len *= 2;
+        }
+        fb->format = pixelFormat;
+        uint64_t now = VirtualDevice::nowUs();
+        fb->timestamp.tv_sec = (long)(now / 1000000);
+        fb->timestamp.tv_usec = (long)(now % 1000000);
+        VirtualDevice::stats()->frames_captured++;
+        return fb;
+    }
+
+    if (frames.empty()) return nullptr;
+
+    const std::vector<uint8_t>& frame = frames[nextFrame];
+    nextFrame = (nextFrame + 1) % frames.size();
+
+    camera_fb_t* fb = new camera_fb_t();
+    fb->buf = (uint8_t*)malloc(frame.size());
+    memcpy(fb->buf, frame.data(), frame.size());
+    fb->len = frame.size();
+    fb->format = PIXFORMAT_JPEG;
+    uint64_t now = VirtualDevice::nowUs();
+    fb->timestamp.tv_sec = (long)(now / 1000000);
+    fb->timestamp.tv_usec = (long)(now % 1000000);
+    VirtualDevice::stats()->frames_captured++;
+    return fb;
+}
+
+void esp_camera_fb_return(camera_fb_t* fb) {
+    if (!fb) return;
+    free(fb->buf);
+    delete fb;
+}
+
+sensor_t* esp_camera_sensor_get() {
+    return cameraInitialized ? &sensor : nullptr;
+}
+
+bool fmt2jpg(uint8_t* src, size_t src_len, uint16_t width, uint16_t height, pixformat_t format, uint8_t quality,
+             uint8_t** out, size_t* out_len) {
+    if (!src || !out || !out_len || format != PIXFORMAT_GRAYSCALE || src_len < (size_t)width * height) return false;
+    std::vector<uint8_t> jpeg;
+    VirtualDevice::encodeJpeg(src, width, height, quality ? quality : 1, 0, &jpeg);
+    *out = (uint8_t*)malloc(jpeg.size());
+    if (!*out) return false;
+    memcpy(*out, jpeg.data(), jpeg.size());
+    *out_len = jpeg.size();
+    return true;
+}
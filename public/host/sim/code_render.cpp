@@ -0,0 +1,318 @@
+#include "virtual_device.h"
+#include "features/camera/code_scanner.h"
+#include <math.h>
+#include <string.h>
+
+// ===================================================================
+// CODE RENDERING (QR and EAN-13 reference encoders)
+// ===================================================================
+//
+// Written from the specifications (ISO/IEC 18004, ISO/IEC 15420) to feed
+// the scanner; the only things shared with the decoder are the module
+// layout helpers and the GF(256) arithmetic in code_scanner.h.
+//
+
+static uint32_t hash32(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+/**
+ * Reed-Solomon EC codewords of data (generator roots a^0 .. a^(ecCount - 1))
+ */
+static std::vector<uint8_t> reedSolomon(const std::vector<uint8_t>& data, int ecCount) {
+    // Generator coefficients, highest power first (leading 1 dropped)
+    std::vector<uint8_t> generator(ecCount, 0);
+    generator[ecCount - 1] = 1;
+    uint8_t root = 1;
+    for (int i = 0; i < ecCount; i++) {
+        for (int j = 0; j < ecCount; j++) {
+            generator[j] = qrGfMultiply(generator[j], root);
+            if (j + 1 < ecCount) generator[j] ^= generator[j + 1];
+        }
+        root = qrGfMultiply(root, 2);
+    }
+    std::vector<uint8_t> remainder(ecCount, 0);
+    for (size_t i = 0; i < data.size(); i++) {
+        uint8_t factor = data[i] ^ remainder[0];
+        remainder.erase(remainder.begin());
+        remainder.push_back(0);
+        for (int j = 0; j < ecCount; j++) remainder[j] ^= qrGfMultiply(generator[j], factor);
+    }
+    return remainder;
+}
+
+static const int ALIGNMENT[11][4] = {
+    {0}, {0}, {6, 18}, {6, 22}, {6, 26}, {6, 30}, {6, 34}, {6, 22, 38}, {6, 24, 42}, {6, 26, 46}, {6, 28, 50},
+};
+
+namespace VirtualDevice {
+    int encodeQr(const std::string& text, int level, int mask, std::vector<uint8_t>* modules) {
+        if (level < 0 || level > 3 || mask < 0 || mask > 7) return 0;
+        qr_ec_level_t ecLevel = (qr_ec_level_t)level;
+
+        // Smallest version that fits
+        int version = 0;
+        uint8_t blocks = 0, longBlocks = 0, shortData = 0, ecPerBlock = 0;
+        size_t dataCodewords = 0;
+        for (int v = QR_MIN_VERSION; v <= QR_MAX_VERSION; v++) {
+            qrBlockLayout((uint8_t)v, ecLevel, &blocks, &longBlocks, &shortData, &ecPerBlock);
+            dataCodewords = (size_t)blocks * shortData + longBlocks;
+            size_t bits = 4 + (v >= 10 ? 16 : 8) + 8 * text.size();
+            if (bits <= dataCodewords * 8) {
+                version = v;
+                break;
+            }
+        }
+        if (version == 0) return 0;
+
+        // Byte segment, terminator, padding
+        std::vector<uint8_t> data;
+        uint32_t accumulator = 0;
+        int pending = 0;
+        size_t written = 0;
+        auto put = [&](uint32_t value, int bits) {
+            for (int i = bits - 1; i >= 0; i--) {
+                accumulator = (accumulator << 1) | ((value >> i) & 1);
+                pending++;
+                written++;
+                if (pending == 8) {
+                    data.push_back((uint8_t)accumulator);
+                    accumulator = 0;
+                    pending = 0;
+                }
+            }
+        };
+        put(4, 4);
+        put((uint32_t)text.size(), version >= 10 ? 16 : 8);
+        for (size_t i = 0; i < text.size(); i++) put((uint8_t)text[i], 8);
+        size_t capacity = dataCodewords * 8;
+        put(0, (int)(capacity - written < 4 ? capacity - written : 4));
+        if (pending) put(0, 8 - pending);
+        for (uint8_t pad = 0xEC; data.size() < dataCodewords; pad ^= 0xEC ^ 0x11) data.push_back(pad);
+
+        // Blocks, then interleave
+        std::vector<std::vector<uint8_t> > dataBlocks, ecBlocks;
+        size_t offset = 0;
+        for (int b = 0; b < blocks; b++) {
+            size_t length = shortData + (b >= blocks - longBlocks ? 1 : 0);
+            std::vector<uint8_t> block(data.begin() + offset, data.begin() + offset + length);
+            offset += length;
+            ecBlocks.push_back(reedSolomon(block, ecPerBlock));
+            dataBlocks.push_back(block);
+        }
+        std::vector<uint8_t> codewords;
+        for (size_t i = 0; i <= shortData; i++) {
+            for (int b = 0; b < blocks; b++) {
+                if (i < dataBlocks[b].size()) codewords.push_back(dataBlocks[b][i]);
+            }
+        }
+        for (int i = 0; i < ecPerBlock; i++) {
+            for (int b = 0; b < blocks; b++) codewords.push_back(ecBlocks[b][i]);
+        }
+
+        int dimension = 17 + 4 * version;
+        modules->assign((size_t)dimension * dimension, 0);
+        std::vector<uint8_t>& m = *modules;
+        auto set = [&](int x, int y, bool dark) {
+            if (x >= 0 && y >= 0 && x < dimension && y < dimension) m[(size_t)y * dimension + x] = dark ? 1 : 0;
+        };
+
+        // Finders with their separators
+        const int corners[3][2] = {{3, 3}, {dimension - 4, 3}, {3, dimension - 4}};
+        for (int f = 0; f < 3; f++) {
+            for (int dy = -4; dy <= 4; dy++) {
+                for (int dx = -4; dx <= 4; dx++) {
+                    int ring = abs(dx) > abs(dy) ? abs(dx) : abs(dy);
+                    set(corners[f][0] + dx, corners[f][1] + dy, ring != 2 && ring != 4);
+                }
+            }
+        }
+        // Timing
+        for (int i = 8; i < dimension - 8; i++) {
+            set(i, 6, i % 2 == 0);
+            set(6, i, i % 2 == 0);
+        }
+        // Alignment
+        const int* centres = ALIGNMENT[version];
+        int count = 0;
+        while (count < 4 && centres[count]) count++;
+        for (int i = 0; i < count; i++) {
+            for (int j = 0; j < count; j++) {
+                if ((i == 0 && j == 0) || (i == 0 && j == count - 1) || (i == count - 1 && j == 0)) continue;
+                for (int dy = -2; dy <= 2; dy++) {
+                    for (int dx = -2; dx <= 2; dx++) {
+                        int ring = abs(dx) > abs(dy) ? abs(dx) : abs(dy);
+                        set(centres[i] + dx, centres[j] + dy, ring != 1);
+                    }
+                }
+            }
+        }
+        // Format information, both copies, and the dark module
+        uint16_t format = qrFormatBits(ecLevel, (uint8_t)mask);
+        for (int i = 0; i <= 5; i++) set(8, i, (format >> i) & 1);
+        set(8, 7, (format >> 6) & 1);
+        set(8, 8, (format >> 7) & 1);
+        set(7, 8, (format >> 8) & 1);
+        for (int i = 9; i < 15; i++) set(14 - i, 8, (format >> i) & 1);
+        for (int i = 0; i < 8; i++) set(dimension - 1 - i, 8, (format >> i) & 1);
+        for (int i = 8; i < 15; i++) set(8, dimension - 15 + i, (format >> i) & 1);
+        set(8, dimension - 8, true);
+        // Version information
+        if (version >= 7) {
+            uint32_t bits = qrVersionBits((uint8_t)version);
+            for (int i = 0; i < 18; i++) {
+                int a = dimension - 11 + i % 3, b = i / 3;
+                set(a, b, (bits >> i) & 1);
+                set(b, a, (bits >> i) & 1);
+            }
+        }
+
+        // Data, masked
+        size_t bit = 0;
+        for (int right = dimension - 1; right >= 1; right -= 2) {
+            if (right == 6) right = 5;
+            bool upward = ((right + 1) & 2) == 0;
+            for (int i = 0; i < dimension; i++) {
+                int y = upward ? dimension - 1 - i : i;
+                for (int j = 0; j < 2; j++) {
+                    int x = right - j;
+                    if (qrIsFunctionModule((uint8_t)version, x, y)) continue;
+                    bool dark = false;
+                    if (bit < codewords.size() * 8) dark = (codewords[bit / 8] >> (7 - bit % 8)) & 1;
+                    bit++;
+                    set(x, y, dark != qrMaskBit((uint8_t)mask, x, y));
+                }
+            }
+        }
+        return dimension;
+    }
+
+    bool encodeEan13(const std::string& digits, std::vector<uint8_t>* modules) {
+        static const char* L_CODES[10] = {"0001101", "0011001", "0010011", "0111101", "0100011",
+                                          "0110001", "0101111", "0111011", "0110111", "0001011"};
+        static const char* PARITY[10] = {"LLLLLL", "LLGLGG", "LLGGLG", "LLGGGL", "LGLLGG",
+                                         "LGGLLG", "LGGGLL", "LGLGLG", "LGLGGL", "LGGLGL"};
+        if (digits.size() != 12 && digits.size() != 13) return false;
+        int d[13];
+        for (size_t i = 0; i < digits.size(); i++) {
+            if (digits[i] < '0' || digits[i] > '9') return false;
+            d[i] = digits[i] - '0';
+        }
+        if (digits.size() == 12) {
+            int sum = 0;
+            for (int i = 0; i < 12; i++) sum += d[i] * (i % 2 ? 3 : 1);
+            d[12] = (10 - sum % 10) % 10;
+        }
+
+        std::string bars = "101";
+        for (int i = 1; i <= 6; i++) {
+            std::string code = L_CODES[d[i]];
+            if (PARITY[d[0]][i - 1] == 'G') {
+                // G: the R code (L inverted) read backwards
+                std::string g(7, '0');
+                for (int k = 0; k < 7; k++) g[k] = code[6 - k] == '1' ? '0' : '1';
+                code = g;
+            }
+            bars += code;
+        }
+        bars += "01010";
+        for (int i = 7; i <= 12; i++) {
+            std::string code = L_CODES[d[i]];
+            for (int k = 0; k < 7; k++) code[k] = code[k] == '1' ? '0' : '1';
+            bars += code;
+        }
+        bars += "101";
+
+        modules->assign(bars.size(), 0);
+        for (size_t i = 0; i < bars.size(); i++) (*modules)[i] = bars[i] == '1';
+        return true;
+    }
+
+    code_placement_t defaultCodePlacement() {
+        code_placement_t p;
+        p.centerX = 320;
+        p.centerY = 240;
+        p.moduleSize = 4;
+        p.angle = 0;
+        p.tilt = 0;
+        p.rowsPerModule = 1;
+        p.quietZone = 4;
+        p.dark = 30;
+        p.light = 220;
+        p.gradient = 0;
+        p.noise = 0;
+        p.seed = 1;
+        return p;
+    }
+
+    void drawCode(uint8_t* image, size_t width, size_t height, const std::vector<uint8_t>& modules,
+                  int columns, int rows, const code_placement_t& p) {
+        double codeHeight = rows * p.rowsPerModule;
+        double halfW = columns / 2.0, halfH = codeHeight / 2.0;
+        double radians = p.angle * M_PI / 180.0;
+        double c = cos(radians), s = sin(radians);
+
+        // Module coordinates about the centre -> pixels, through the tilt
+        auto forward = [&](double un, double vn, double* x, double* y) {
+            double w = 1 + p.tilt * vn / halfH;
+            double X = un / w * p.moduleSize, Y = vn / w * p.moduleSize;
+            *x = p.centerX + c * X - s * Y;
+            *y = p.centerY + s * X + c * Y;
+        };
+        double q = p.quietZone;
+        double minX = 1e9, minY = 1e9, maxX = -1e9, maxY = -1e9;
+        for (int corner = 0; corner < 4; corner++) {
+            double x, y;
+            forward(corner & 1 ? halfW + q : -halfW - q, corner & 2 ? halfH + q : -halfH - q, &x, &y);
+            if (x < minX) minX = x;
+            if (x > maxX) maxX = x;
+            if (y < minY) minY = y;
+            if (y > maxY) maxY = y;
+        }
+        int x0 = minX < 0 ? 0 : (int)minX, y0 = minY < 0 ? 0 : (int)minY;
+        int x1 = maxX + 1 > width ? (int)width : (int)maxX + 1;
+        int y1 = maxY + 1 > height ? (int)height : (int)maxY + 1;
+
+        const int SAMPLES = 4;
+        for (int y = y0; y < y1; y++) {
+            for (int x = x0; x < x1; x++) {
+                uint8_t& pixel = image[(size_t)y * width + x];
+                double total = 0;
+                bool covered = false;
+                for (int sy = 0; sy < SAMPLES; sy++) {
+                    for (int sx = 0; sx < SAMPLES; sx++) {
+                        double dx = x + (sx + 0.5) / SAMPLES - p.centerX;
+                        double dy = y + (sy + 0.5) / SAMPLES - p.centerY;
+                        double X = (c * dx + s * dy) / p.moduleSize;
+                        double Y = (-s * dx + c * dy) / p.moduleSize;
+                        double denominator = 1 - p.tilt * Y / halfH;
+                        double vn = denominator > 0.1 ? Y / denominator : 1e9;
+                        double un = X * (1 + p.tilt * vn / halfH);
+                        double u = un + halfW, v = vn + halfH;
+                        if (u < -q || v < -q || u >= columns + q || v >= codeHeight + q) {
+                            total += pixel;
+                            continue;
+                        }
+                        covered = true;
+                        int column = (int)floor(u), row = (int)floor(v / p.rowsPerModule);
+                        bool dark = column >= 0 && row >= 0 && column < columns && row < rows &&
+                                    modules[(size_t)row * columns + column];
+                        total += (dark ? p.dark : p.light) + p.gradient * (u / columns - 0.5);
+                    }
+                }
+                if (!covered) continue;
+                int value = (int)lround(total / (SAMPLES * SAMPLES));
+                if (p.noise) {
+                    value += (int)(hash32((uint32_t)(y * width + x) * 2654435761U + p.seed) % (2 * p.noise + 1)) -
+                             p.noise;
+                }
+                pixel = (uint8_t)(value < 0 ? 0 : (value > 255 ? 255 : value));
+            }
+        }
+    }
+}
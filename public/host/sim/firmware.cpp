@@ -0,0 +1,2 @@
+// The sketch itself, built unchanged as a host translation unit
+#include "../../../firmware/firmware.ino"
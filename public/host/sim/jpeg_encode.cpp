@@ -0,0 +1,241 @@
+#include "virtual_device.h"
+#include <math.h>
+#include <string.h>
+
+// ===================================================================
+// JPEG ENCODER
+// ===================================================================
+//
+// Baseline grayscale JPEG with the Annex K luma tables, for tests that
+// need JPEGs of known content (the camera itself replays captures).
+//
+
+static const uint8_t ZIGZAG[64] = {
+    0,  1,  8,  16, 9,  2,  3,  10, 17, 24, 32, 25, 18, 11, 4,  5,  12, 19, 26, 33, 40, 48,
+    41, 34, 27, 20, 13, 6,  7,  14, 21, 28, 35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23,
+    30, 37, 44, 51, 58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63,
+};
+
+static const uint8_t LUMA_QUANT[64] = {
+    16, 11, 10, 16, 24,  40,  51,  61,  12, 12, 14, 19, 26,  58,  60,  55,
+    14, 13, 16, 24, 40,  57,  69,  56,  14, 17, 22, 29, 51,  87,  80,  62,
+    18, 22, 37, 56, 68,  109, 103, 77,  24, 35, 55, 64, 81,  104, 113, 92,
+    49, 64, 78, 87, 103, 121, 120, 101, 72, 92, 95, 98, 112, 100, 103, 99,
+};
+
+static const uint8_t DC_COUNTS[16] = {0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0};
+static const uint8_t DC_VALUES[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+
+static const uint8_t AC_COUNTS[16] = {0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7D};
+static const uint8_t AC_VALUES[162] = {
+    0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07, 0x22, 0x71,
+    0x14, 0x32, 0x81, 0x91, 0xA1, 0x08, 0x23, 0x42, 0xB1, 0xC1, 0x15, 0x52, 0xD1, 0xF0, 0x24, 0x33, 0x62, 0x72,
+    0x82, 0x09, 0x0A, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x34, 0x35, 0x36, 0x37,
+    0x38, 0x39, 0x3A, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59,
+    0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x83,
+    0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0xA2, 0xA3,
+    0xA4, 0xA5, 0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3,
+    0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xE1, 0xE2,
+    0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA,
+};
+
+typedef struct {
+    uint16_t code[256];
+    uint8_t length[256];
+} huffman_code_t;
+
+static void buildCodes(const uint8_t counts[16], const uint8_t* values, huffman_code_t* table) {
+    memset(table, 0, sizeof(*table));
+    uint16_t code = 0;
+    int k = 0;
+    for (int length = 1; length <= 16; length++) {
+        for (int i = 0; i < counts[length - 1]; i++, k++) {
+            table->code[values[k]] = code++;
+            table->length[values[k]] = (uint8_t)length;
+        }
+        code <<= 1;
+    }
+}
+
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>* out) : out(out), bits(0), count(0) {}
+
+    void put(uint32_t value, int length) {
+        for (int i = length - 1; i >= 0; i--) {
+            bits = (bits << 1) | ((value >> i) & 1);
+            if (++count == 8) emit();
+        }
+    }
+
+    // Pad the last byte with 1s
+    void flush() {
+        while (count != 0) put(1, 1);
+    }
+
+private:
+    void emit() {
+        out->push_back((uint8_t)bits);
+        if (bits == 0xFF) out->push_back(0x00);
+        bits = 0;
+        count = 0;
+    }
+
+    std::vector<uint8_t>* out;
+    uint32_t bits;
+    int count;
+};
+
+static void putSegment(std::vector<uint8_t>* out, uint8_t marker, const std::vector<uint8_t>& body) {
+    out->push_back(0xFF);
+    out->push_back(marker);
+    out->push_back((uint8_t)((body.size() + 2) >> 8));
+    out->push_back((uint8_t)(body.size() + 2));
+    out->insert(out->end(), body.begin(), body.end());
+}
+
+static void putHuffmanTable(std::vector<uint8_t>* body, uint8_t classAndId, const uint8_t counts[16], const uint8_t* values) {
+    body->push_back(classAndId);
+    int total = 0;
+    for (int i = 0; i < 16; i++) {
+        body->push_back(counts[i]);
+        total += counts[i];
+    }
+    body->insert(body->end(), values, values + total);
+}
+
+static int magnitudeBits(int value) {
+    int magnitude = value < 0 ? -value : value;
+    int bits = 0;
+    while (magnitude) {
+        bits++;
+        magnitude >>= 1;
+    }
+    return bits;
+}
+
+static void putValue(BitWriter* writer, int value, int bits) {
+    if (value < 0) value += (1 << bits) - 1;
+    writer->put((uint32_t)value, bits);
+}
+
+namespace VirtualDevice {
+    void encodeJpeg(const uint8_t* gray, size_t width, size_t height, int quality, uint16_t restartInterval,
+                    std::vector<uint8_t>* out) {
+        out->clear();
+        if (quality < 1) quality = 1;
+        if (quality > 100) quality = 100;
+
+        // libjpeg's quality scaling
+        int scale = quality < 50 ? 5000 / quality : 200 - 2 * quality;
+        uint8_t quant[64];
+        for (int i = 0; i < 64; i++) {
+            int q = (LUMA_QUANT[i] * scale + 50) / 100;
+            quant[i] = (uint8_t)(q < 1 ? 1 : q > 255 ? 255 : q);
+        }
+
+        out->push_back(0xFF);
+        out->push_back(0xD8);
+
+        std::vector<uint8_t> body;
+        body.push_back(0x00);
+        for (int i = 0; i < 64; i++) body.push_back(quant[ZIGZAG[i]]);
+        putSegment(out, 0xDB, body);
+
+        body.assign({0x08, (uint8_t)(height >> 8), (uint8_t)height, (uint8_t)(width >> 8), (uint8_t)width, 0x01,
+                     0x01, 0x11, 0x00});
+        putSegment(out, 0xC0, body);
+
+        body.clear();
+        putHuffmanTable(&body, 0x00, DC_COUNTS, DC_VALUES);
+        putHuffmanTable(&body, 0x10, AC_COUNTS, AC_VALUES);
+        putSegment(out, 0xC4, body);
+
+        if (restartInterval) {
+            body.assign({(uint8_t)(restartInterval >> 8), (uint8_t)restartInterval});
+            putSegment(out, 0xDD, body);
+        }
+
+        body.assign({0x01, 0x01, 0x00, 0x00, 0x3F, 0x00});
+        putSegment(out, 0xDA, body);
+
+        huffman_code_t dc, ac;
+        buildCodes(DC_COUNTS, DC_VALUES, &dc);
+        buildCodes(AC_COUNTS, AC_VALUES, &ac);
+
+        double basis[8][8];
+        for (int u = 0; u < 8; u++) {
+            for (int x = 0; x < 8; x++) {
+                basis[u][x] = (u == 0 ? sqrt(0.125) : 0.5) * cos((2 * x + 1) * u * M_PI / 16);
+            }
+        }
+
+        BitWriter writer(out);
+        size_t blocksWide = (width + 7) / 8, blocksHigh = (height + 7) / 8;
+        int predictor = 0;
+        size_t mcu = 0;
+        for (size_t by = 0; by < blocksHigh; by++) {
+            for (size_t bx = 0; bx < blocksWide; bx++, mcu++) {
+                if (restartInterval && mcu > 0 && mcu % restartInterval == 0) {
+                    writer.flush();
+                    out->push_back(0xFF);
+                    out->push_back((uint8_t)(0xD0 + (mcu / restartInterval - 1) % 8));
+                    predictor = 0;
+                }
+
+                // Edge blocks repeat the last row and column
+                double block[8][8], rows[8][8];
+                for (int y = 0; y < 8; y++) {
+                    size_t sy = by * 8 + y < height ? by * 8 + y : height - 1;
+                    for (int x = 0; x < 8; x++) {
+                        size_t sx = bx * 8 + x < width ? bx * 8 + x : width - 1;
+                        block[y][x] = gray[sy * width + sx] - 128.0;
+                    }
+                }
+                for (int y = 0; y < 8; y++) {
+                    for (int u = 0; u < 8; u++) {
+                        double sum = 0;
+                        for (int x = 0; x < 8; x++) sum += basis[u][x] * block[y][x];
+                        rows[y][u] = sum;
+                    }
+                }
+                int coefficients[64];
+                for (int v = 0; v < 8; v++) {
+                    for (int u = 0; u < 8; u++) {
+                        double sum = 0;
+                        for (int y = 0; y < 8; y++) sum += basis[v][y] * rows[y][u];
+                        coefficients[v * 8 + u] = (int)lround(sum / quant[v * 8 + u]);
+                    }
+                }
+
+                int diff = coefficients[0] - predictor;
+                predictor = coefficients[0];
+                int bits = magnitudeBits(diff);
+                writer.put(dc.code[bits], dc.length[bits]);
+                putValue(&writer, diff, bits);
+
+                int run = 0;
+                for (int k = 1; k < 64; k++) {
+                    int value = coefficients[ZIGZAG[k]];
+                    if (value == 0) {
+                        run++;
+                        continue;
+                    }
+                    while (run > 15) {
+                        writer.put(ac.code[0xF0], ac.length[0xF0]);
+                        run -= 16;
+                    }
+                    bits = magnitudeBits(value);
+                    uint8_t symbol = (uint8_t)(run << 4 | bits);
+                    writer.put(ac.code[symbol], ac.length[symbol]);
+                    putValue(&writer, value, bits);
+                    run = 0;
+                }
+                if (run > 0) writer.put(ac.code[0x00], ac.length[0x00]);
+            }
+        }
+        writer.flush();
+        out->push_back(0xFF);
+        out->push_back(0xD9);
+    }
+}
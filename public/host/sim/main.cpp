@@ -0,0 +1,281 @@
+#include "virtual_device.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// ===================================================================
+// VIRTUAL DEVICE DRIVER
+// ===================================================================
+//
+// Boots the firmware (setup()), then calls loop() until the requested
+// virtual duration has passed. A scripted central connects, writes to
+// control characteristics and disconnects at given virtual times.
+//
+
+void setup();
+void loop();
+
+static const char* PHOTO_CONTROL_UUID = "19B10006-E8F2-537E-4F6C-D104768A1214";
+static const char* VIDEO_CONTROL_UUID = "19B10009-E8F2-537E-4F6C-D104768A1214";
+
+typedef enum {
+    EVENT_CONNECT,
+    EVENT_DISCONNECT,
+    EVENT_WRITE
+} event_type_t;
+
+typedef struct {
+    uint64_t at_us;
+    event_type_t type;
+    std::string uuid;
+    std::vector<uint8_t> data;
+} sim_event_t;
+
+static std::vector<sim_event_t> events;
+static size_t nextEvent = 0;
+
+static void usage(const char* argv0) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --duration SEC        Virtual run time (default 60)\n"
+            "  --uptime MS           Boot with the clock already at MS (e.g. 4294960000, just\n"
+            "                        before the 32-bit millis() wrap); other times are relative\n"
+            "  --jpeg-dir DIR        Camera frames (*.jpg, replayed in name order)\n"
+            "  --code TEXT           QR code (or 'ean13:DIGITS' barcode) in grayscale frames\n"
+            "  --wav FILE            Microphone input (PCM WAV, looped)\n"
+            "  --log FILE            Packet log of every notification ('-' = stdout)\n"
+            "  --serial FILE         Firmware Serial output ('-' = stdout, default)\n"
+            "  --quiet               Discard firmware Serial output\n"
+            "  --connect-at MS       Central connects at this virtual time (default 0)\n"
+            "  --no-connect          Never connect\n"
+            "  --disconnect-at MS    Central disconnects at this virtual time\n"
+            "  --photo VALUE@MS      Write photo control (-1 single, -2 code scan, -3 skip,\n"
+            "                        -4..-7 pyramid level 0-3, 0 stop, 5..125 interval)\n"
+            "  --video VALUE@MS      Write video control\n"
+            "  --write UUID=HEX@MS   Write raw bytes to any characteristic\n"
+            "  --mtu N               MTU requested by the central (default 247)\n"
+            "  --capture-ms MS       Virtual time per camera capture (default 60)\n"
+            "  --fs-dir DIR          Host directory backing LittleFS (default: temp dir)\n"
+            "Link model (any of these enables it; otherwise delivery is instant):\n"
+            "  --link                Enable with defaults (30 ms, 6 PDUs/event, 1M, DLE, queue 20)\n"
+            "  --conn-interval MS    Connection interval\n"
+            "  --ppe N               LL PDUs per connection event\n"
+            "  --phy 1M|2M|S2|S8     PHY\n"
+            "  --ll-octets N         LL payload per PDU (251 with DLE, 27 without)\n"
+            "  --loss P              PDU error rate\n"
+            "  --burst IN,OUT,P      Burst loss: P(good->bad), P(bad->good), error rate when bad\n"
+            "  --queue N             Notifications the stack can buffer\n"
+            "  --backpressure MODE   'drop' (default) or 'block' when the queue is full\n"
+            "  --seed N              Loss random seed\n",
+            argv0);
+}
+
+static bool parseTime(const char* text, uint64_t* at_us) {
+    char* end;
+    double ms = strtod(text, &end);
+    if (end == text || *end != '\0' || ms < 0) return false;
+    *at_us = (uint64_t)(ms * 1000);
+    return true;
+}
+
+static bool splitAt(const char* arg, std::string* value, uint64_t* at_us) {
+    const char* at = strrchr(arg, '@');
+    if (!at) return false;
+    *value = std::string(arg, at - arg);
+    return parseTime(at + 1, at_us);
+}
+
+static bool parseHex(const std::string& hex, std::vector<uint8_t>* out) {
+    if (hex.size() % 2 != 0) return false;
+    for (size_t i = 0; i < hex.size(); i += 2) {
+        char byte[3] = {hex[i], hex[i + 1], 0};
+        char* end;
+        long value = strtol(byte, &end, 16);
+        if (*end != '\0') return false;
+        out->push_back((uint8_t)value);
+    }
+    return true;
+}
+
+static void addEvent(uint64_t at_us, event_type_t type, const std::string& uuid = "",
+                     const std::vector<uint8_t>& data = std::vector<uint8_t>()) {
+    sim_event_t event = {at_us, type, uuid, data};
+    events.push_back(event);
+}
+
+static void dispatchEvents() {
+    uint64_t now = VirtualDevice::nowUs();
+    while (nextEvent < events.size() && events[nextEvent].at_us <= now) {
+        const sim_event_t& event = events[nextEvent++];
+        switch (event.type) {
+            case EVENT_CONNECT:
+                VirtualDevice::connect();
+                break;
+            case EVENT_DISCONNECT:
+                VirtualDevice::disconnect();
+                break;
+            case EVENT_WRITE:
+                if (!VirtualDevice::isConnected()) {
+                    fprintf(stderr, "virtual_device: write to %s at %.3f s dropped (not connected)\n",
+                            event.uuid.c_str(), now / 1e6);
+                } else if (!VirtualDevice::writeCharacteristic(event.uuid.c_str(), event.data.data(),
+                                                               event.data.size())) {
+                    fprintf(stderr, "virtual_device: no writable characteristic %s\n", event.uuid.c_str());
+                }
+                break;
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    double durationS = 60;
+    uint64_t uptimeUs = 0;
+    uint64_t connectAt = 0;
+    bool autoConnect = true;
+    static FILE* serialOut = stdout;
+    bool linkEnabled = false;
+    ble_link_config_t link = BleLinkModel::defaultConfig();
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        std::string text;
+        uint64_t at_us;
+
+        if (strcmp(arg, "--quiet") == 0) {
+            serialOut = nullptr;
+            continue;
+        } else if (strcmp(arg, "--no-connect") == 0) {
+            autoConnect = false;
+            continue;
+        } else if (strcmp(arg, "--link") == 0) {
+            linkEnabled = true;
+            continue;
+        } else if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) {
+            usage(argv[0]);
+            return 0;
+        }
+
+        if (!value) {
+            usage(argv[0]);
+            return 2;
+        }
+        i++;
+
+        bool ok = true;
+        if (strcmp(arg, "--duration") == 0) {
+            durationS = atof(value);
+            ok = durationS > 0;
+        } else if (strcmp(arg, "--uptime") == 0) {
+            ok = parseTime(value, &uptimeUs);
+        } else if (strcmp(arg, "--jpeg-dir") == 0) {
+            size_t count = VirtualDevice::loadJpegDir(value);
+            fprintf(stderr, "virtual_device: %u camera frames from %s\n", (unsigned)count, value);
+            ok = count > 0;
+        } else if (strcmp(arg, "--code") == 0) {
+            ok = VirtualDevice::setCameraCode(value);
+        } else if (strcmp(arg, "--wav") == 0) {
+            ok = VirtualDevice::loadWav(value);
+        } else if (strcmp(arg, "--log") == 0) {
+            ok = VirtualDevice::openPacketLog(value);
+        } else if (strcmp(arg, "--serial") == 0) {
+            serialOut = strcmp(value, "-") == 0 ? stdout : fopen(value, "w");
+            ok = serialOut != nullptr;
+        } else if (strcmp(arg, "--connect-at") == 0) {
+            ok = parseTime(value, &connectAt);
+        } else if (strcmp(arg, "--disconnect-at") == 0) {
+            ok = parseTime(value, &at_us);
+            addEvent(at_us, EVENT_DISCONNECT);
+        } else if (strcmp(arg, "--photo") == 0 || strcmp(arg, "--video") == 0) {
+            ok = splitAt(value, &text, &at_us);
+            if (ok) {
+                std::vector<uint8_t> data(1, (uint8_t)atoi(text.c_str()));
+                addEvent(at_us, EVENT_WRITE, arg[2] == 'p' ? PHOTO_CONTROL_UUID : VIDEO_CONTROL_UUID, data);
+            }
+        } else if (strcmp(arg, "--write") == 0) {
+            ok = splitAt(value, &text, &at_us);
+            size_t eq = text.find('=');
+            std::vector<uint8_t> data;
+            ok = ok && eq != std::string::npos && parseHex(text.substr(eq + 1), &data);
+            if (ok) {
+                addEvent(at_us, EVENT_WRITE, text.substr(0, eq), data);
+            }
+        } else if (strcmp(arg, "--mtu") == 0) {
+            int mtu = atoi(value);
+            ok = mtu >= 23 && mtu <= 517;
+            VirtualDevice::setPeerMtu((uint16_t)mtu);
+        } else if (strcmp(arg, "--capture-ms") == 0) {
+            VirtualDevice::setCaptureTimeUs((uint32_t)(atof(value) * 1000));
+        } else if (strcmp(arg, "--fs-dir") == 0) {
+            VirtualDevice::setFsRoot(value);
+        } else if (strcmp(arg, "--conn-interval") == 0) {
+            link.conn_interval_ms = atof(value);
+            ok = linkEnabled = link.conn_interval_ms >= 7.5f && link.conn_interval_ms <= 4000.0f;
+        } else if (strcmp(arg, "--ppe") == 0) {
+            link.packets_per_event = (uint8_t)atoi(value);
+            ok = linkEnabled = link.packets_per_event > 0;
+        } else if (strcmp(arg, "--phy") == 0) {
+            ok = linkEnabled = BleLinkModel::parsePhy(value, &link.phy);
+        } else if (strcmp(arg, "--ll-octets") == 0) {
+            link.ll_octets = (uint16_t)atoi(value);
+            ok = linkEnabled = link.ll_octets >= 27 && link.ll_octets <= 251;
+        } else if (strcmp(arg, "--loss") == 0) {
+            link.loss = atof(value);
+            ok = linkEnabled = link.loss >= 0 && link.loss < 1;
+        } else if (strcmp(arg, "--burst") == 0) {
+            ok = linkEnabled = sscanf(value, "%f,%f,%f", &link.burst_enter, &link.burst_exit, &link.burst_loss) == 3;
+        } else if (strcmp(arg, "--queue") == 0) {
+            link.queue_packets = (uint16_t)atoi(value);
+            ok = linkEnabled = link.queue_packets > 0;
+        } else if (strcmp(arg, "--backpressure") == 0) {
+            link.block_when_full = strcmp(value, "block") == 0;
+            ok = linkEnabled = link.block_when_full || strcmp(value, "drop") == 0;
+        } else if (strcmp(arg, "--seed") == 0) {
+            link.seed = (uint32_t)strtoul(value, nullptr, 10);
+            linkEnabled = true;
+        } else {
+            ok = false;
+        }
+
+        if (!ok) {
+            fprintf(stderr, "virtual_device: bad option %s %s\n", arg, value);
+            return 2;
+        }
+    }
+
+    if (autoConnect) {
+        addEvent(connectAt, EVENT_CONNECT);
+    }
+    for (size_t i = 0; i < events.size(); i++) {
+        events[i].at_us += uptimeUs;
+    }
+    // Same-time events keep command-line order; the connect goes first
+    std::stable_sort(events.begin(), events.end(), [](const sim_event_t& a, const sim_event_t& b) {
+        if (a.at_us != b.at_us) return a.at_us < b.at_us;
+        return a.type == EVENT_CONNECT && b.type != EVENT_CONNECT;
+    });
+
+    if (linkEnabled) {
+        VirtualDevice::enableLink(link);
+    }
+    VirtualDevice::setConsole(serialOut);
+    VirtualDevice::setUptimeUs(uptimeUs);
+    static const uint64_t endUs = uptimeUs + (uint64_t)(durationS * 1e6);
+
+    if (setjmp(VirtualDevice::deepSleepJump) == 0) {
+        setup();
+        while (VirtualDevice::nowUs() < endUs) {
+            dispatchEvents();
+            loop();
+        }
+    }
+
+    if (serialOut) fflush(serialOut);
+    VirtualDevice::finishRun();
+    VirtualDevice::closePacketLog();
+    VirtualDevice::printSummary(stderr);
+    return 0;
+}
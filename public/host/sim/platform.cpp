@@ -0,0 +1,374 @@
+#include "virtual_device.h"
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <esp_pm.h>
+#include <esp_rom_crc.h>
+#include <driver/ledc.h>
+#include <stdarg.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ===================================================================
+// CONSOLE (Serial)
+// ===================================================================
+
+HardwareSerial Serial;
+static FILE* consoleOut = stdout;
+
+namespace VirtualDevice {
+    void setConsole(FILE* out) {
+        consoleOut = out;
+    }
+
+    FILE* console() {
+        return consoleOut;
+    }
+}
+
+void HardwareSerial::flush() {
+    if (consoleOut) fflush(consoleOut);
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    if (consoleOut) fputc(c, consoleOut);
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* data, size_t length) {
+    if (consoleOut) fwrite(data, 1, length, consoleOut);
+    return length;
+}
+
+size_t HardwareSerial::printf(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int written = consoleOut ? vfprintf(consoleOut, format, args) : vsnprintf(nullptr, 0, format, args);
+    va_end(args);
+    return written > 0 ? (size_t)written : 0;
+}
+
+size_t HardwareSerial::print(const char* s) {
+    return s ? write((const uint8_t*)s, strlen(s)) : 0;
+}
+
+size_t HardwareSerial::print(char c) {
+    return write((uint8_t)c);
+}
+
+size_t HardwareSerial::print(int value, int base) {
+    return print(String((long)value, (unsigned char)base));
+}
+
+size_t HardwareSerial::print(unsigned int value, int base) {
+    return print(String((unsigned long)value, (unsigned char)base));
+}
+
+size_t HardwareSerial::print(long value, int base) {
+    return print(String(value, (unsigned char)base));
+}
+
+size_t HardwareSerial::print(unsigned long value, int base) {
+    return print(String(value, (unsigned char)base));
+}
+
+size_t HardwareSerial::print(double value, int decimals) {
+    return print(String(value, (unsigned int)decimals));
+}
+
+// ===================================================================
+// STRING
+// ===================================================================
+
+std::string String::fromLong(long value, unsigned char base) {
+    if (value < 0 && base == 10) {
+        return "-" + fromUnsigned((unsigned long)-value, base);
+    }
+    return fromUnsigned((unsigned long)value, base);
+}
+
+std::string String::fromUnsigned(unsigned long value, unsigned char base) {
+    static const char digits[] = "0123456789ABCDEF";
+    if (base < 2 || base > 16) base = 10;
+    std::string out;
+    do {
+        out.insert(out.begin(), digits[value % base]);
+        value /= base;
+    } while (value > 0);
+    return out;
+}
+
+std::string String::fromDouble(double value, unsigned int decimals) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.*f", (int)decimals, value);
+    return buffer;
+}
+
+// ===================================================================
+// CHIP, MEMORY AND PINS
+// ===================================================================
+
+EspClass ESP;
+
+// Figures of an idle XIAO ESP32S3 Sense; allocations come from the host heap
+static const uint32_t HEAP_SIZE = 320 * 1024;
+static const uint32_t HEAP_FREE = 240 * 1024;
+static const uint32_t PSRAM_SIZE = 8 * 1024 * 1024;
+
+uint32_t EspClass::getHeapSize() { return HEAP_SIZE; }
+uint32_t EspClass::getFreeHeap() { return HEAP_FREE; }
+uint32_t EspClass::getMaxAllocHeap() { return HEAP_FREE / 2; }
+uint32_t EspClass::getPsramSize() { return PSRAM_SIZE; }
+uint32_t EspClass::getFreePsram() { return PSRAM_SIZE - 512 * 1024; }
+uint32_t EspClass::getCpuFreqMHz() { return getCpuFrequencyMhz(); }
+
+uint32_t esp_get_free_heap_size() { return HEAP_FREE; }
+uint32_t esp_get_minimum_free_heap_size() { return HEAP_FREE; }
+
+void esp_restart() {
+    // A restart ends the run like deep sleep does
+    VirtualDevice::enterDeepSleep();
+}
+
+static uint32_t cpuFrequencyMhz = 240;
+
+bool setCpuFrequencyMhz(uint32_t mhz) {
+    cpuFrequencyMhz = mhz;
+    return true;
+}
+
+uint32_t getCpuFrequencyMhz() {
+    return cpuFrequencyMhz;
+}
+
+bool psramFound() { return true; }
+void* ps_malloc(size_t size) { return malloc(size); }
+void* ps_calloc(size_t n, size_t size) { return calloc(n, size); }
+
+void* heap_caps_malloc(size_t size, uint32_t caps) { (void)caps; return malloc(size); }
+void* heap_caps_calloc(size_t n, size_t size, uint32_t caps) { (void)caps; return calloc(n, size); }
+void heap_caps_free(void* ptr) { free(ptr); }
+
+size_t heap_caps_get_free_size(uint32_t caps) {
+    return (caps & MALLOC_CAP_SPIRAM) ? PSRAM_SIZE - 512 * 1024 : HEAP_FREE;
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps) {
+    return heap_caps_get_free_size(caps) / 2;
+}
+
+size_t heap_caps_get_total_size(uint32_t caps) {
+    return (caps & MALLOC_CAP_SPIRAM) ? PSRAM_SIZE : HEAP_SIZE;
+}
+
+void pinMode(uint8_t pin, uint8_t mode) { (void)pin; (void)mode; }
+void digitalWrite(uint8_t pin, uint8_t value) { (void)pin; (void)value; }
+int digitalRead(uint8_t pin) { (void)pin; return LOW; }
+uint16_t analogRead(uint8_t pin) { (void)pin; return 0; }
+uint32_t analogReadMilliVolts(uint8_t pin) { (void)pin; return 0; }
+
+long random(long max) { return max > 0 ? rand() % max : 0; }
+long random(long min, long max) { return min < max ? min + rand() % (max - min) : min; }
+
+long map(long x, long in_min, long in_max, long out_min, long out_max) {
+    return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+const char* esp_err_to_name(esp_err_t code) {
+    switch (code) {
+        case ESP_OK: return "ESP_OK";
+        case ESP_FAIL: return "ESP_FAIL";
+        case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+        case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+        default: return "UNKNOWN ERROR";
+    }
+}
+
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len) {
+    crc = ~crc;
+    while (len--) {
+        crc ^= *buf++;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+esp_err_t esp_pm_configure(const void* config) {
+    (void)config;
+    return ESP_OK;
+}
+
+// ===================================================================
+// LEDC
+// ===================================================================
+
+typedef struct {
+    uint32_t duty;
+    uint32_t fade_from;
+    uint32_t fade_to;
+    uint64_t fade_start_us;
+    uint64_t fade_end_us;
+} ledc_channel_state_t;
+
+static ledc_channel_state_t ledcChannels[LEDC_CHANNEL_MAX];
+static bool ledcFadeInstalled = false;
+
+esp_err_t ledc_timer_config(const ledc_timer_config_t* config) {
+    return config ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t ledc_channel_config(const ledc_channel_config_t* config) {
+    if (!config || config->channel >= LEDC_CHANNEL_MAX) return ESP_ERR_INVALID_ARG;
+    ledc_channel_state_t* state = &ledcChannels[config->channel];
+    state->duty = state->fade_to = config->duty;
+    state->fade_end_us = 0;
+    return ESP_OK;
+}
+
+esp_err_t ledc_fade_func_install(int intr_alloc_flags) {
+    (void)intr_alloc_flags;
+    if (ledcFadeInstalled) return ESP_ERR_INVALID_STATE;
+    ledcFadeInstalled = true;
+    return ESP_OK;
+}
+
+esp_err_t ledc_set_duty_and_update(ledc_mode_t mode, ledc_channel_t channel, uint32_t duty, uint32_t hpoint) {
+    (void)mode;
+    (void)hpoint;
+    if (channel >= LEDC_CHANNEL_MAX) return ESP_ERR_INVALID_ARG;
+    ledc_channel_state_t* state = &ledcChannels[channel];
+    state->duty = state->fade_to = duty;
+    state->fade_end_us = 0;
+    return ESP_OK;
+}
+
+esp_err_t ledc_set_fade_time_and_start(ledc_mode_t mode, ledc_channel_t channel, uint32_t target_duty,
+                                       uint32_t max_fade_time_ms, ledc_fade_mode_t fade_mode) {
+    if (channel >= LEDC_CHANNEL_MAX || !ledcFadeInstalled) return ESP_ERR_INVALID_STATE;
+    ledc_channel_state_t* state = &ledcChannels[channel];
+    state->fade_from = ledc_get_duty(mode, channel);
+    state->fade_to = target_duty;
+    state->fade_start_us = VirtualDevice::nowUs();
+    state->fade_end_us = state->fade_start_us + (uint64_t)max_fade_time_ms * 1000;
+    if (fade_mode == LEDC_FADE_WAIT_DONE) {
+        VirtualDevice::advanceTo(state->fade_end_us);
+    }
+    return ESP_OK;
+}
+
+uint32_t ledc_get_duty(ledc_mode_t mode, ledc_channel_t channel) {
+    (void)mode;
+    if (channel >= LEDC_CHANNEL_MAX) return 0;
+    ledc_channel_state_t* state = &ledcChannels[channel];
+    uint64_t now = VirtualDevice::nowUs();
+    if (state->fade_end_us == 0 || now >= state->fade_end_us) {
+        state->duty = state->fade_to;
+        state->fade_end_us = 0;
+        return state->duty;
+    }
+    // Linear hardware fade in progress
+    double progress = (double)(now - state->fade_start_us) / (state->fade_end_us - state->fade_start_us);
+    return (uint32_t)(state->fade_from + ((double)state->fade_to - state->fade_from) * progress);
+}
+
+// ===================================================================
+// LITTLEFS
+// ===================================================================
+
+fs::FS LittleFS;
+static std::string fsRoot;
+
+namespace VirtualDevice {
+    void setFsRoot(const char* dir) {
+        fsRoot = dir ? dir : "";
+    }
+
+    std::string fsPath(const char* path) {
+        return fsRoot + (path && path[0] == '/' ? "" : "/") + (path ? path : "");
+    }
+}
+
+namespace fs {
+    int File::available() {
+        if (!fp) return 0;
+        return (int)(size() - position());
+    }
+
+    File File::openNextFile(const char* mode) {
+        if (!dir) return File();
+        while (struct dirent* entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (name == "." || name == "..") continue;
+            std::string path = hostPath + "/" + name;
+            if (DIR* sub = opendir(path.c_str())) {
+                return File(sub, path, name);
+            }
+            std::string hostMode = std::string(mode) + "b";
+            return File(fopen(path.c_str(), hostMode.c_str()), name);
+        }
+        return File();
+    }
+
+    void File::close() {
+        if (fp) {
+            fclose(fp);
+            fp = nullptr;
+        }
+        if (dir) {
+            closedir(dir);
+            dir = nullptr;
+        }
+    }
+
+    size_t File::size() {
+        if (!fp) return 0;
+        long pos = ftell(fp);
+        fseek(fp, 0, SEEK_END);
+        long end = ftell(fp);
+        fseek(fp, pos, SEEK_SET);
+        return end > 0 ? (size_t)end : 0;
+    }
+
+    bool FS::begin(bool formatOnFail) {
+        (void)formatOnFail;
+        if (fsRoot.empty()) {
+            char dir[] = "/tmp/virtual_device_fs_XXXXXX";
+            if (!mkdtemp(dir)) return false;
+            fsRoot = dir;
+        }
+        mkdir(fsRoot.c_str(), 0755);
+        struct stat st;
+        return stat(fsRoot.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+    }
+
+    File FS::open(const char* path, const char* mode) {
+        std::string hostPath = VirtualDevice::fsPath(path);
+        const char* slash = strrchr(path, '/');
+        std::string name = slash ? slash + 1 : path;
+        if (strcmp(mode, FILE_READ) == 0) {
+            if (DIR* dir = opendir(hostPath.c_str())) {
+                return File(dir, hostPath, name);
+            }
+        }
+        std::string hostMode = std::string(mode) + "b";
+        return File(fopen(hostPath.c_str(), hostMode.c_str()), name);
+    }
+
+    bool FS::exists(const char* path) {
+        struct stat st;
+        return stat(VirtualDevice::fsPath(path).c_str(), &st) == 0;
+    }
+
+    bool FS::remove(const char* path) {
+        return unlink(VirtualDevice::fsPath(path).c_str()) == 0;
+    }
+
+    size_t FS::usedBytes() {
+        return 0;
+    }
+}
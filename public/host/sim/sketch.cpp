@@ -0,0 +1,22 @@
+#include "virtual_device.h"
+
+// ===================================================================
+// SKETCH
+// ===================================================================
+//
+// setup() and loop() for tests that boot the firmware more than once.
+// The driver (main.cpp) runs its own loop to dispatch scripted events.
+//
+
+void setup();
+void loop();
+
+namespace VirtualDevice {
+    bool runSketch(bool boot, uint64_t durationUs) {
+        if (setjmp(deepSleepJump) != 0) return true;
+        if (boot) setup();
+        uint64_t end = nowUs() + durationUs;
+        while (nowUs() < end) loop();
+        return false;
+    }
+}
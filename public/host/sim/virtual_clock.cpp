@@ -0,0 +1,276 @@
+#include "virtual_device.h"
+#include <map>
+#include <string.h>
+#include <esp_timer.h>
+#include <esp_sleep.h>
+#include <sys/time.h>
+#include <freertos/FreeRTOS.h>
+
+// ===================================================================
+// VIRTUAL CLOCK
+// ===================================================================
+
+struct esp_timer {
+    esp_timer_cb_t callback;
+    void* arg;
+    const char* name;
+    uint64_t period_us;         // 0 = one-shot
+    bool armed;
+    std::multimap<uint64_t, esp_timer*>::iterator slot;
+};
+
+static uint64_t clockUs = 0;
+static uint64_t startUs = 0;
+static std::multimap<uint64_t, esp_timer*> armedTimers;
+static VirtualDevice::device_stats_t deviceStats;
+
+static void arm(esp_timer* timer, uint64_t deadline) {
+    timer->slot = armedTimers.insert(std::make_pair(deadline, timer));
+    timer->armed = true;
+}
+
+static void disarm(esp_timer* timer) {
+    if (timer->armed) {
+        armedTimers.erase(timer->slot);
+        timer->armed = false;
+    }
+}
+
+namespace VirtualDevice {
+    uint64_t nowUs() {
+        return clockUs;
+    }
+
+    void advanceTo(uint64_t us) {
+        // Fire timers in deadline order; callbacks may re-arm themselves
+        while (!armedTimers.empty() && armedTimers.begin()->first <= us) {
+            esp_timer* timer = armedTimers.begin()->second;
+            uint64_t deadline = armedTimers.begin()->first;
+            disarm(timer);
+            if (deadline > clockUs) {
+                clockUs = deadline;
+            }
+            if (timer->period_us > 0) {
+                arm(timer, deadline + timer->period_us);
+            }
+            deviceStats.timers_fired++;
+            timer->callback(timer->arg);
+        }
+        if (us > clockUs) {
+            clockUs = us;
+        }
+    }
+
+    void advanceUs(uint64_t us) {
+        advanceTo(clockUs + us);
+    }
+
+    void setUptimeUs(uint64_t us) {
+        advanceTo(us);
+        startUs = clockUs;
+    }
+
+    uint64_t runStartUs() {
+        return startUs;
+    }
+
+    device_stats_t* stats() {
+        return &deviceStats;
+    }
+}
+
+// ===================================================================
+// ARDUINO / FREERTOS TIME
+// ===================================================================
+//
+// unsigned long is 32 bits on the ESP32: millis() wraps after 49.7 days
+// and micros() after 71.6 minutes. Host longs are 64 bits, so the values
+// are truncated here to wrap where the device's do.
+//
+
+unsigned long millis() {
+    return (uint32_t)(clockUs / 1000);
+}
+
+unsigned long micros() {
+    return (uint32_t)clockUs;
+}
+
+void delay(uint32_t ms) {
+    VirtualDevice::advanceUs((uint64_t)ms * 1000);
+}
+
+void delayMicroseconds(uint32_t us) {
+    VirtualDevice::advanceUs(us);
+}
+
+void yield() {}
+
+// System time keeps running through deep sleep on the device, so the
+// firmware measures time asleep with it: here it is the virtual clock
+// (from the start of 2025)
+int gettimeofday(struct timeval* tv, void* tz) noexcept {
+    (void)tz;
+    static const uint64_t EPOCH_US = 1735689600ULL * 1000000ULL;
+    uint64_t us = EPOCH_US + clockUs;
+    tv->tv_sec = (time_t)(us / 1000000ULL);
+    tv->tv_usec = (suseconds_t)(us % 1000000ULL);
+    return 0;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    VirtualDevice::advanceUs((uint64_t)ticks * portTICK_PERIOD_MS * 1000);
+}
+
+TickType_t xTaskGetTickCount() {
+    return (TickType_t)(clockUs / (portTICK_PERIOD_MS * 1000));
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    (void)task;
+    return 4096;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    return nullptr;
+}
+
+char* pcTaskGetTaskName(TaskHandle_t task) {
+    (void)task;
+    static char name[] = "loopTask";
+    return name;
+}
+
+// ===================================================================
+// ESP_TIMER
+// ===================================================================
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out_handle) {
+    if (!args || !args->callback || !out_handle) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_timer* timer = new esp_timer();
+    timer->callback = args->callback;
+    timer->arg = args->arg;
+    timer->name = args->name;
+    timer->period_us = 0;
+    timer->armed = false;
+    *out_handle = timer;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+    if (!timer) return ESP_ERR_INVALID_ARG;
+    if (timer->armed) return ESP_ERR_INVALID_STATE;
+    timer->period_us = 0;
+    arm(timer, clockUs + timeout_us);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period_us) {
+    if (!timer || period_us == 0) return ESP_ERR_INVALID_ARG;
+    if (timer->armed) return ESP_ERR_INVALID_STATE;
+    timer->period_us = period_us;
+    arm(timer, clockUs + period_us);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    if (!timer) return ESP_ERR_INVALID_ARG;
+    if (!timer->armed) return ESP_ERR_INVALID_STATE;
+    disarm(timer);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    if (!timer) return ESP_ERR_INVALID_ARG;
+    disarm(timer);
+    delete timer;
+    return ESP_OK;
+}
+
+int64_t esp_timer_get_time() {
+    return (int64_t)clockUs;
+}
+
+// ===================================================================
+// SLEEP
+// ===================================================================
+
+static uint64_t sleepTimer = 0;
+static bool deepSleeping = false;
+static esp_sleep_wakeup_cause_t wakeupCause = ESP_SLEEP_WAKEUP_UNDEFINED;
+
+// RTC_DATA_ATTR variables (shim/esp_attr.h); the linker marks the section's
+// bounds. The firmware zero-initialises all of them
+extern "C" char __start_rtc_data[] __attribute__((weak));
+extern "C" char __stop_rtc_data[] __attribute__((weak));
+
+namespace VirtualDevice {
+    jmp_buf deepSleepJump;
+
+    void setSleepTimerUs(uint64_t us) {
+        sleepTimer = us;
+    }
+
+    uint64_t sleepTimerUs() {
+        return sleepTimer;
+    }
+
+    void enterDeepSleep() {
+        deepSleeping = true;
+        longjmp(deepSleepJump, 1);
+    }
+
+    bool inDeepSleep() {
+        return deepSleeping;
+    }
+
+    void wakeFromSleep(esp_sleep_wakeup_cause_t cause, uint64_t asleepUs) {
+        if (isConnected()) disconnect();
+        advanceUs(asleepUs);
+        deepSleeping = false;
+        wakeupCause = cause;
+    }
+
+    void powerOnReset() {
+        char* start = __start_rtc_data;
+        char* stop = __stop_rtc_data;
+        if (start && stop > start) {
+            memset(start, 0, stop - start);
+        }
+        wakeFromSleep(ESP_SLEEP_WAKEUP_UNDEFINED, 0);
+    }
+}
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t time_in_us) {
+    VirtualDevice::setSleepTimerUs(time_in_us);
+    return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_ext0_wakeup(gpio_num_t gpio_num, int level) {
+    (void)gpio_num;
+    (void)level;
+    return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_ext1_wakeup(uint64_t mask, esp_sleep_ext1_wakeup_mode_t mode) {
+    (void)mask;
+    (void)mode;
+    return ESP_OK;
+}
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause() {
+    // A cold boot unless the driver woke the device (wakeFromSleep())
+    return wakeupCause;
+}
+
+esp_err_t esp_light_sleep_start() {
+    // Only the timer can wake the virtual device
+    VirtualDevice::advanceUs(sleepTimer);
+    return ESP_OK;
+}
+
+void esp_deep_sleep_start() {
+    VirtualDevice::enterDeepSleep();
+}
@@ -0,0 +1,277 @@
+#ifndef VIRTUAL_DEVICE_H
+#define VIRTUAL_DEVICE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <setjmp.h>
+#include <string>
+#include <vector>
+#include <esp_sleep.h>
+#include "ble_link_model.h"
+
+// ===================================================================
+// VIRTUAL DEVICE
+// ===================================================================
+//
+// Host-side backends for the firmware shims. The firmware sources are
+// compiled unchanged; everything below the Arduino/ESP-IDF/BLE APIs
+// lands here:
+//
+//   - a virtual clock: millis()/esp_timer read it, delay() and blocking
+//     driver calls advance it, esp_timer callbacks fire as it passes
+//   - the camera replays JPEG files from a directory; grayscale captures
+//     render a synthetic desk scene, optionally with a QR code or EAN-13
+//     barcode lying on it
+//   - the microphone replays a 16-bit PCM WAV file at the I2S rate
+//   - a simulated central subscribes to every notify characteristic and
+//     writes each notification to a timestamped packet log, optionally
+//     behind a BLE link model (link/ble_link_model.h). It is the firmware's
+//     BLE backend as well (BLE_BACKEND_MOCK, features/bluetooth/ble_transport.h)
+//
+
+namespace VirtualDevice {
+    // ===============================================================
+    // CLOCK
+    // ===============================================================
+
+    /** Current virtual time in microseconds since boot */
+    uint64_t nowUs();
+
+    /** Advance the clock, firing due esp_timer callbacks on the way */
+    void advanceUs(uint64_t us);
+    void advanceTo(uint64_t us);
+
+    /**
+     * Boot with the clock already at this uptime (before setup()); run
+     * statistics count from here
+     */
+    void setUptimeUs(uint64_t us);
+    uint64_t runStartUs();
+
+    // ===============================================================
+    // CONSOLE
+    // ===============================================================
+
+    /** Destination of Serial output (nullptr discards it) */
+    void setConsole(FILE* out);
+    FILE* console();
+
+    // ===============================================================
+    // CAMERA
+    // ===============================================================
+
+    /**
+     * Load every *.jpg / *.jpeg in a directory (sorted by name); frames
+     * are returned round-robin
+     * @return Number of frames loaded
+     */
+    size_t loadJpegDir(const char* dir);
+
+    /** Virtual time one esp_camera_fb_get() takes */
+    void setCaptureTimeUs(uint32_t us);
+
+    /**
+     * Frame n of a synthetic desk seen from a head-mounted camera: paper
+     * and a keyboard that do not move, sensor noise, and a hand that
+     * comes and goes. Grayscale captures return these
+     */
+    void renderDeskScene(uint8_t* out, size_t width, size_t height, uint32_t frame);
+
+    /**
+     * Put a code on the desk in grayscale captures: "ean13:<12 or 13
+     * digits>" for a barcode, anything else as a QR code (empty removes it)
+     * @return false if it cannot be encoded
+     */
+    bool setCameraCode(const std::string& text);
+
+    // ===============================================================
+    // CODE RENDERING (reference encoders for the code scanner)
+    // ===============================================================
+
+    /**
+     * QR symbol of text in byte mode, in the smallest version (1-10) that
+     * holds it at the level (0-3: L M Q H), with the given mask (0-7)
+     * @param modules dimension x dimension, row-major, 1 = dark
+     * @return Dimension, or 0 if it does not fit
+     */
+    int encodeQr(const std::string& text, int level, int mask, std::vector<uint8_t>* modules);
+
+    /**
+     * EAN-13 bars of 12 digits (check digit added) or 13 (used as given)
+     * @param modules 95 modules, 1 = bar
+     * @return false unless the text is 12 or 13 digits
+     */
+    bool encodeEan13(const std::string& digits, std::vector<uint8_t>* modules);
+
+    /**
+     * Where and how a code lands in the image
+     */
+    typedef struct {
+        double centerX;
+        double centerY;
+        double moduleSize;      // Pixels per module at the centre
+        double angle;           // Degrees, clockwise
+        double tilt;            // Perspective: far edge this much smaller (0 = flat)
+        double rowsPerModule;   // Bar height per module width (1D codes; 1 for QR)
+        int quietZone;          // Light modules around the code
+        int dark;               // Ink and paper levels
+        int light;
+        int gradient;           // Brightness change across the code
+        int noise;              // +/- per pixel
+        uint32_t seed;
+    } code_placement_t;
+
+    /** Defaults: centred in a 640x480 frame, 4-pixel modules, flat and clean */
+    code_placement_t defaultCodePlacement();
+
+    /**
+     * Draw columns x rows modules over the image (anti-aliased 4x4 per pixel)
+     */
+    void drawCode(uint8_t* image, size_t width, size_t height, const std::vector<uint8_t>& modules,
+                  int columns, int rows, const code_placement_t& placement);
+
+    // ===============================================================
+    // JPEG ENCODER (tests that need JPEGs of known content)
+    // ===============================================================
+
+    /**
+     * Baseline grayscale JPEG: Annex K luma tables scaled to quality 1-100
+     * as libjpeg does
+     * @param restartInterval MCUs between restart markers (0 = none)
+     */
+    void encodeJpeg(const uint8_t* gray, size_t width, size_t height, int quality, uint16_t restartInterval,
+                    std::vector<uint8_t>* out);
+
+    // ===============================================================
+    // MICROPHONE
+    // ===============================================================
+
+    /**
+     * Load a PCM WAV file (8/16-bit, any channel count; the first
+     * channel is used). Without a file the microphone reads silence.
+     * @return true if loaded
+     */
+    bool loadWav(const char* path);
+
+    // ===============================================================
+    // BLE CENTRAL
+    // ===============================================================
+
+    /** Write notifications to this file ("-" for stdout) */
+    bool openPacketLog(const char* path);
+    void closePacketLog();
+
+    /** MTU requested by the central */
+    void setPeerMtu(uint16_t mtu);
+    uint16_t peerMtu();
+
+    /** Connect / disconnect the simulated central (once the services are started) */
+    void connect();
+    void disconnect();
+    bool isConnected();
+    bool isAdvertising();
+
+    /**
+     * Write to a characteristic as the central would (runs its write handler)
+     * @param uuid 4 hex digits for a 16-bit UUID, or the full UUID
+     * @return false if the characteristic does not exist or is not writable
+     */
+    bool writeCharacteristic(const char* uuid, const uint8_t* data, size_t length);
+
+    /**
+     * Read a characteristic as the central would
+     * @return false if the characteristic does not exist or is not readable
+     */
+    bool readCharacteristic(const char* uuid, std::vector<uint8_t>* value);
+
+    /** Called by the backend's notify() */
+    void onNotify(const std::string& uuid, const uint8_t* data, size_t length);
+
+    /**
+     * Put the link model between notify() and the central. Without it
+     * every notification arrives the moment it is sent. The MTU is
+     * taken from the connection (min of both sides).
+     */
+    void enableLink(const ble_link_config_t& config);
+
+    /** Let the link deliver what is still queued (end of run) */
+    void finishRun();
+
+    // ===============================================================
+    // FILESYSTEM / SLEEP
+    // ===============================================================
+
+    /** Host directory backing LittleFS */
+    void setFsRoot(const char* dir);
+    std::string fsPath(const char* path);
+
+    /** Timer wakeup armed by esp_sleep_enable_timer_wakeup() */
+    void setSleepTimerUs(uint64_t us);
+    uint64_t sleepTimerUs();
+
+    /**
+     * Deep sleep ends the run: esp_deep_sleep_start() jumps back here
+     * (set with setjmp() by the driver before calling setup()/loop())
+     */
+    extern jmp_buf deepSleepJump;
+    [[noreturn]] void enterDeepSleep();
+    bool inDeepSleep();
+
+    /**
+     * Wake from sleep for the next boot: the clock moves on by the time
+     * asleep, the central has lost the link, RTC memory is kept and
+     * esp_sleep_get_wakeup_cause() reports this cause (every boot is
+     * cold until this is called)
+     */
+    void wakeFromSleep(esp_sleep_wakeup_cause_t cause, uint64_t asleepUs);
+
+    /**
+     * Boot again after the power was lost (a flat battery): RTC memory
+     * is cleared and the boot is cold. Flash (LittleFS) keeps its files.
+     */
+    void powerOnReset();
+
+    /**
+     * Boot the sketch (setup()), or carry on with it, and run loop() for
+     * this much virtual time (sim/sketch.cpp)
+     * @return true if it went to deep sleep on the way
+     */
+    bool runSketch(bool boot, uint64_t durationUs);
+
+    // ===============================================================
+    // STATISTICS
+    // ===============================================================
+
+    /**
+     * Per-characteristic notification counters
+     */
+    typedef struct {
+        std::string uuid;
+        uint32_t packets;
+        uint64_t bytes;
+    } stream_stats_t;
+
+    /**
+     * Run counters
+     */
+    typedef struct {
+        uint32_t frames_captured;
+        uint64_t audio_samples_read;
+        uint64_t audio_samples_dropped;
+        uint32_t timers_fired;
+        uint32_t writes;
+    } device_stats_t;
+
+    device_stats_t* stats();
+    size_t streamCount();
+    const stream_stats_t* streamStats(size_t index);
+
+    /** Friendly name of a known characteristic UUID (or the UUID itself) */
+    const char* streamName(const std::string& uuid);
+
+    /** Print the run summary */
+    void printSummary(FILE* out);
+}
+
+#endif // VIRTUAL_DEVICE_H
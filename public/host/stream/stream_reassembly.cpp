@@ -0,0 +1,487 @@
+#include "stream_reassembly.h"
+#include "features/bluetooth/ble_frame_format.h"
+#include "features/camera/block_codec.h"
+#include "features/camera/code_scanner.h"
+#include "features/camera/jpeg_header.h"
+#include "features/microphone/mulaw.h"
+#include <string.h>
+#ifdef HAVE_OPUS
+#include <opus/opus.h>
+#endif
+
+// A backwards jump this large is a counter reset, not a late packet
+#define AUDIO_RESTART_DISTANCE 64
+
+// Longest gap filled with silence (frames)
+#define AUDIO_MAX_CONCEALED_FRAMES 500
+
+// Distinct JPEG headers kept for compact images (one per frame size and quality)
+#define IMAGE_HEADER_CACHE_SIZE 16
+
+// ===================================================================
+// AUDIO REASSEMBLER
+// ===================================================================
+
+AudioReassembler::AudioReassembler(size_t reorderWindow)
+    : window(reorderWindow),
+      started(false),
+      lastSequence(0),
+      nextSequence(0),
+      frameCallback(nullptr),
+      gapCallback(nullptr),
+      callbackCtx(nullptr) {
+    memset(&counters, 0, sizeof(counters));
+    for (int i = 0; i < 256; i++) recent[i] = -1;
+}
+
+void AudioReassembler::setCallbacks(audio_frame_cb_t onFrame, audio_gap_cb_t onGap, void* ctx) {
+    frameCallback = onFrame;
+    gapCallback = onGap;
+    callbackCtx = ctx;
+}
+
+int64_t AudioReassembler::unwrap(uint16_t counter) {
+    if (!started) return counter;
+    return lastSequence + (int16_t)(counter - (uint16_t)lastSequence);
+}
+
+void AudioReassembler::push(const uint8_t* data, size_t length) {
+    counters.packets++;
+    if (length < BLE_FRAME_HEADER_SIZE) {
+        counters.malformed++;
+        return;
+    }
+
+    int64_t sequence = unwrap(bleFrameIndex(data));
+
+    // Firmware restarted the counter (reconnect): start over
+    if (started && sequence < nextSequence - AUDIO_RESTART_DISTANCE) {
+        flush();
+        counters.restarts++;
+        sequence = bleFrameIndex(data);
+        nextSequence = sequence;
+        lastSequence = sequence;
+        partials.clear();
+        for (int i = 0; i < 256; i++) recent[i] = -1;
+    }
+    if (!started) {
+        started = true;
+        nextSequence = sequence;
+        lastSequence = sequence;
+    }
+    if (sequence > lastSequence) lastSequence = sequence;
+
+    if (!bleIsAudioChunk(data, length)) {
+        accept(sequence, data + BLE_FRAME_HEADER_SIZE, length - BLE_FRAME_HEADER_SIZE, false);
+        expirePartials();
+        return;
+    }
+
+    // One slice of a split frame
+    uint8_t index = data[2];
+    partial_frame_t& frame = partials[sequence];
+    if (frame.chunks.empty()) frame.lastIndex = -1;
+    if (frame.chunks.count(index)) {
+        counters.duplicates++;
+        return;
+    }
+    frame.chunks[index].assign(data + BLE_AUDIO_CHUNK_HEADER_SIZE, data + length);
+    if (data[3] & BLE_AUDIO_CHUNK_LAST) frame.lastIndex = index;
+
+    if (frame.lastIndex >= 0 && (int)frame.chunks.size() == frame.lastIndex + 1) {
+        completeChunked(sequence, &frame);
+        partials.erase(sequence);
+    }
+    expirePartials();
+}
+
+void AudioReassembler::completeChunked(int64_t sequence, partial_frame_t* frame) {
+    std::vector<uint8_t> whole;
+    for (std::map<uint8_t, std::vector<uint8_t> >::iterator it = frame->chunks.begin();
+         it != frame->chunks.end(); ++it) {
+        whole.insert(whole.end(), it->second.begin(), it->second.end());
+    }
+    // The slices carry the frame's own [frame_lo, frame_hi, 0x00] header
+    if (whole.size() < BLE_FRAME_HEADER_SIZE || whole[2] != BLE_FRAME_TYPE_AUDIO ||
+        bleFrameIndex(&whole[0]) != (uint16_t)sequence) {
+        counters.malformed++;
+        return;
+    }
+    accept(sequence, &whole[BLE_FRAME_HEADER_SIZE], whole.size() - BLE_FRAME_HEADER_SIZE, true);
+}
+
+void AudioReassembler::expirePartials() {
+    // Split frames that fell out of the reorder window will not complete
+    while (!partials.empty() && partials.begin()->first + (int64_t)window < lastSequence) {
+        counters.incomplete_frames++;
+        partials.erase(partials.begin());
+    }
+}
+
+void AudioReassembler::accept(int64_t sequence, const uint8_t* payload, size_t length, bool chunked) {
+    if (recent[sequence & 0xFF] == sequence || pending.count(sequence)) {
+        counters.duplicates++;
+        return;
+    }
+    if (sequence < nextSequence) {
+        // Its slot was already given up as a gap
+        counters.out_of_order++;
+        counters.late_frames++;
+        return;
+    }
+    if (!pending.empty() && sequence < pending.rbegin()->first) {
+        counters.out_of_order++;
+    }
+    if (chunked) counters.chunked_frames++;
+
+    pending[sequence].assign(payload, payload + length);
+    while (pending.size() > window) {
+        std::map<int64_t, std::vector<uint8_t> >::iterator first = pending.begin();
+        emit(first->first, first->second);
+        pending.erase(first);
+    }
+}
+
+void AudioReassembler::emit(int64_t sequence, const std::vector<uint8_t>& payload) {
+    if (sequence > nextSequence) {
+        uint32_t missing = (uint32_t)(sequence - nextSequence);
+        counters.missing_frames += missing;
+        if (gapCallback) gapCallback(callbackCtx, nextSequence, missing);
+    }
+    counters.frames++;
+    counters.payload_bytes += payload.size();
+    recent[sequence & 0xFF] = sequence;
+    nextSequence = sequence + 1;
+    if (frameCallback) {
+        frameCallback(callbackCtx, sequence, payload.empty() ? nullptr : &payload[0], payload.size());
+    }
+}
+
+void AudioReassembler::flush() {
+    for (std::map<int64_t, std::vector<uint8_t> >::iterator it = pending.begin(); it != pending.end(); ++it) {
+        emit(it->first, it->second);
+    }
+    pending.clear();
+    counters.incomplete_frames += partials.size();
+    partials.clear();
+}
+
+// ===================================================================
+// AUDIO DECODER
+// ===================================================================
+
+AudioDecoder::AudioDecoder(audio_codec_t codec, uint32_t sampleRate)
+    : codec(codec),
+      rate(sampleRate ? sampleRate : defaultSampleRate(codec)),
+      concealGaps(true),
+      lastFrameSamples(0),
+      concealed(0),
+      errors(0),
+      opus(nullptr) {
+#ifdef HAVE_OPUS
+    if (codec == AUDIO_CODEC_OPUS) {
+        int error = 0;
+        opus = opus_decoder_create((opus_int32)rate, 1, &error);
+        if (error != OPUS_OK) opus = nullptr;
+    }
+#endif
+}
+
+AudioDecoder::~AudioDecoder() {
+#ifdef HAVE_OPUS
+    if (opus) opus_decoder_destroy((OpusDecoder*)opus);
+#endif
+}
+
+uint32_t AudioDecoder::defaultSampleRate(audio_codec_t codec) {
+    // SAMPLE_RATE in hal/constants.h for each codec
+    return codec == AUDIO_CODEC_MULAW ? 8000 : 16000;
+}
+
+bool AudioDecoder::parseCodec(const char* text, audio_codec_t* codec) {
+    if (strcmp(text, "pcm") == 0) *codec = AUDIO_CODEC_PCM16;
+    else if (strcmp(text, "mulaw") == 0) *codec = AUDIO_CODEC_MULAW;
+    else if (strcmp(text, "opus") == 0) *codec = AUDIO_CODEC_OPUS;
+    else return false;
+    return true;
+}
+
+const char* AudioDecoder::codecName(audio_codec_t codec) {
+    switch (codec) {
+        case AUDIO_CODEC_PCM16: return "pcm";
+        case AUDIO_CODEC_MULAW: return "mulaw";
+        case AUDIO_CODEC_OPUS: return "opus";
+    }
+    return "?";
+}
+
+bool AudioDecoder::canDecode(audio_codec_t codec) {
+#ifdef HAVE_OPUS
+    (void)codec;
+    return true;
+#else
+    return codec != AUDIO_CODEC_OPUS;
+#endif
+}
+
+void AudioDecoder::decode(const uint8_t* payload, size_t length) {
+    size_t start = pcm.size();
+
+    switch (codec) {
+        case AUDIO_CODEC_PCM16:
+            pcm.resize(start + length / 2);
+            for (size_t i = 0; i < length / 2; i++) {
+                pcm[start + i] = (int16_t)(payload[2 * i] | (payload[2 * i + 1] << 8));
+            }
+            if (length & 1) errors++;
+            break;
+
+        case AUDIO_CODEC_MULAW: {
+            // Table once instead of the bit twiddling per sample
+            static int16_t table[256];
+            static bool tableReady = false;
+            if (!tableReady) {
+                for (int i = 0; i < 256; i++) table[i] = (int16_t)ulaw2linear((unsigned char)i);
+                tableReady = true;
+            }
+            pcm.resize(start + length);
+            int16_t* out = pcm.data() + start;
+            for (size_t i = 0; i < length; i++) out[i] = table[payload[i]];
+            break;
+        }
+
+        case AUDIO_CODEC_OPUS:
+            raw.push_back(std::vector<uint8_t>(payload, payload + length));
+#ifdef HAVE_OPUS
+            if (opus) {
+                // Up to 120 ms per packet
+                pcm.resize(start + rate * 120 / 1000);
+                int decoded = opus_decode((OpusDecoder*)opus, payload, (opus_int32)length,
+                                          &pcm[start], (int)(rate * 120 / 1000), 0);
+                if (decoded < 0) {
+                    errors++;
+                    decoded = 0;
+                }
+                pcm.resize(start + decoded);
+            }
+#endif
+            break;
+    }
+
+    if (pcm.size() > start) lastFrameSamples = pcm.size() - start;
+}
+
+void AudioDecoder::conceal(uint32_t frames) {
+    if (!concealGaps || lastFrameSamples == 0) return;
+    if (frames > AUDIO_MAX_CONCEALED_FRAMES) frames = AUDIO_MAX_CONCEALED_FRAMES;
+    size_t count = frames * lastFrameSamples;
+    pcm.insert(pcm.end(), count, 0);
+    concealed += count;
+}
+
+void AudioDecoder::onFrame(void* ctx, int64_t sequence, const uint8_t* payload, size_t length) {
+    (void)sequence;
+    ((AudioDecoder*)ctx)->decode(payload, length);
+}
+
+void AudioDecoder::onGap(void* ctx, int64_t sequence, uint32_t count) {
+    (void)sequence;
+    ((AudioDecoder*)ctx)->conceal(count);
+}
+
+static void writeLe16(FILE* fp, uint16_t value) {
+    fputc(value & 0xFF, fp);
+    fputc(value >> 8, fp);
+}
+
+static void writeLe32(FILE* fp, uint32_t value) {
+    writeLe16(fp, value & 0xFFFF);
+    writeLe16(fp, value >> 16);
+}
+
+bool AudioDecoder::writeWav(const char* path) const {
+    FILE* fp = fopen(path, "wb");
+    if (!fp) return false;
+
+    uint32_t dataBytes = (uint32_t)(pcm.size() * 2);
+    fwrite("RIFF", 1, 4, fp);
+    writeLe32(fp, 36 + dataBytes);
+    fwrite("WAVEfmt ", 1, 8, fp);
+    writeLe32(fp, 16);
+    writeLe16(fp, 1);               // PCM
+    writeLe16(fp, 1);               // Mono
+    writeLe32(fp, rate);
+    writeLe32(fp, rate * 2);
+    writeLe16(fp, 2);
+    writeLe16(fp, 16);
+    fwrite("data", 1, 4, fp);
+    writeLe32(fp, dataBytes);
+    for (size_t i = 0; i < pcm.size(); i++) writeLe16(fp, (uint16_t)pcm[i]);
+
+    bool ok = !ferror(fp);
+    fclose(fp);
+    return ok;
+}
+
+bool AudioDecoder::writeRawFrames(const char* path) const {
+    FILE* fp = fopen(path, "wb");
+    if (!fp) return false;
+    for (size_t i = 0; i < raw.size(); i++) {
+        writeLe16(fp, (uint16_t)raw[i].size());
+        if (!raw[i].empty()) fwrite(&raw[i][0], 1, raw[i].size(), fp);
+    }
+    bool ok = !ferror(fp);
+    fclose(fp);
+    return ok;
+}
+
+// ===================================================================
+// IMAGE REASSEMBLER
+// ===================================================================
+
+ImageReassembler::ImageReassembler(uint8_t frameType)
+    : type(frameType),
+      active(false),
+      lastIndex(-1),
+      started(false),
+      flags(0),
+      hash(0),
+      announcedLength(0),
+      imageCallback(nullptr),
+      callbackCtx(nullptr) {
+    memset(&counters, 0, sizeof(counters));
+}
+
+void ImageReassembler::setCallback(image_cb_t callback, void* ctx) {
+    imageCallback = callback;
+    callbackCtx = ctx;
+}
+
+void ImageReassembler::push(const uint8_t* data, size_t length) {
+    counters.packets++;
+    if (length < BLE_FRAME_HEADER_SIZE) {
+        counters.malformed++;
+        return;
+    }
+
+    if (bleIsPhotoStart(data, length)) {
+        // The previous image stopped without an end marker (skipped, or lost)
+        if (active && !chunks.empty()) finish(false);
+        counters.start_headers++;
+        started = true;
+        flags = data[3];
+        hash = blePhotoStartHash(data);
+        announcedLength = blePhotoStartLength(data);
+        return;
+    }
+
+    if (bleIsEndMarker(data, length)) {
+        if (chunks.empty()) {
+            counters.stray_end_markers++;
+            return;
+        }
+        finish(true);
+        return;
+    }
+
+    if (data[2] != type) {
+        counters.malformed++;
+        return;
+    }
+
+    uint16_t index = bleFrameIndex(data);
+
+    // Chunk 0 again: the previous image lost its end marker
+    if (index == 0 && chunks.count(0)) {
+        finish(false);
+    }
+
+    if (chunks.count(index)) {
+        counters.duplicates++;
+        return;
+    }
+    if ((int)index < lastIndex) counters.out_of_order++;
+    if ((int)index > lastIndex) lastIndex = index;
+
+    chunks[index].assign(data + BLE_FRAME_HEADER_SIZE, data + length);
+    active = true;
+}
+
+void ImageReassembler::finish(bool terminated) {
+    image.clear();
+    uint32_t missing = 0;
+    int expected = 0;
+    for (std::map<uint16_t, std::vector<uint8_t> >::iterator it = chunks.begin(); it != chunks.end(); ++it) {
+        missing += it->first - expected;
+        expected = it->first + 1;
+        image.insert(image.end(), it->second.begin(), it->second.end());
+    }
+    counters.wire_bytes += image.size();
+    bool announced = !started || announcedLength == image.size();
+    bool restored = restoreHeader();
+
+    // Block video frames are checked by BlockDecoder; here only the magic
+    bool whole;
+    if (type == BLE_FRAME_TYPE_BLOCKS) {
+        whole = image.size() >= BLOCK_FRAME_HEADER_SIZE && image[0] == BLOCK_FRAME_MAGIC;
+    } else if (type == BLE_FRAME_TYPE_CODE) {
+        whole = image.size() >= 2 && (image[0] == CODE_SYMBOLOGY_QR || image[0] == CODE_SYMBOLOGY_EAN13);
+    } else {
+        whole = image.size() >= 4 && image[0] == 0xFF && image[1] == 0xD8 &&
+                image[image.size() - 2] == 0xFF && image[image.size() - 1] == 0xD9;
+    }
+    bool complete = terminated && missing == 0 && whole && restored && announced;
+
+    counters.missing_chunks += missing;
+    if (!terminated) counters.unterminated++;
+    if (complete) counters.complete++;
+    counters.bytes += image.size();
+
+    if (imageCallback) {
+        imageCallback(callbackCtx, counters.images, image.empty() ? nullptr : &image[0], image.size(), complete);
+    }
+    counters.images++;
+
+    chunks.clear();
+    lastIndex = -1;
+    active = false;
+    started = false;
+}
+
+bool ImageReassembler::startHash(uint64_t* out) const {
+    if (!started || !(flags & BLE_PHOTO_START_HASH)) return false;
+    *out = hash;
+    return true;
+}
+
+// Compact image: put the cached header back. Whole image: cache its header
+// (see features/camera/jpeg_header.h). false if the header is unknown
+bool ImageReassembler::restoreHeader() {
+    if (image.empty()) return true;
+
+    if (bleIsJpegCompact(&image[0], image.size())) {
+        std::map<uint32_t, std::vector<uint8_t> >::const_iterator it = headers.find(bleJpegCompactId(&image[0]));
+        if (it == headers.end()) {
+            counters.unknown_tables++;
+            return false;
+        }
+        image.erase(image.begin(), image.begin() + BLE_JPEG_COMPACT_PREFIX_SIZE);
+        image.insert(image.begin(), it->second.begin(), it->second.end());
+        counters.compacted++;
+        return true;
+    }
+
+    size_t header = jpegHeaderLength(&image[0], image.size());
+    if (header > 0) {
+        uint32_t id = jpegHeaderId(&image[0], header);
+        if (!headers.count(id)) {
+            if (headers.size() >= IMAGE_HEADER_CACHE_SIZE) headers.clear();
+            headers[id].assign(image.begin(), image.begin() + header);
+        }
+    }
+    return true;
+}
+
+void ImageReassembler::flush() {
+    if (active && !chunks.empty()) finish(false);
+}
@@ -0,0 +1,226 @@
+#ifndef STREAM_REASSEMBLY_H
+#define STREAM_REASSEMBLY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <map>
+#include <vector>
+
+// ===================================================================
+// STREAM REASSEMBLY
+// ===================================================================
+//
+// Rebuilds audio and images from the notifications a central received.
+// Framing comes from the firmware's features/bluetooth/ble_frame_format.h,
+// so the host and the device share one definition of the headers.
+//
+//   AudioReassembler   packets -> ordered audio frames (+ gaps)
+//   AudioDecoder       audio frames -> 16-bit PCM (PCM, μ-law, Opus)
+//   ImageReassembler   photo / video packets -> JPEG images (compact
+//                      images get their cached header back)
+//
+// All three report what went wrong on the way: missing, duplicated and
+// out-of-order packets, incomplete frames and images.
+//
+
+// ===================================================================
+// AUDIO
+// ===================================================================
+
+typedef enum {
+    AUDIO_CODEC_PCM16,
+    AUDIO_CODEC_MULAW,
+    AUDIO_CODEC_OPUS
+} audio_codec_t;
+
+/**
+ * Audio stream counters
+ */
+typedef struct {
+    uint32_t packets;
+    uint32_t frames;                // Frames delivered in order
+    uint32_t chunked_frames;        // ... of which were split across packets
+    uint64_t payload_bytes;
+    uint32_t missing_frames;        // Gaps in the frame counter
+    uint32_t duplicates;            // Frames or chunks seen twice
+    uint32_t out_of_order;          // Frames that arrived after a later one
+    uint32_t late_frames;           // Out of order beyond the reorder window (dropped)
+    uint32_t incomplete_frames;     // Split frames with chunks missing (dropped)
+    uint32_t restarts;              // Frame counter reset (reconnect)
+    uint32_t malformed;
+} audio_stream_stats_t;
+
+/** A frame is ready, in frame counter order */
+typedef void (*audio_frame_cb_t)(void* ctx, int64_t sequence, const uint8_t* payload, size_t length);
+
+/** Frames [sequence, sequence + count) never arrived */
+typedef void (*audio_gap_cb_t)(void* ctx, int64_t sequence, uint32_t count);
+
+class AudioReassembler {
+public:
+    /**
+     * @param reorderWindow Frames held back to put late packets in order
+     */
+    explicit AudioReassembler(size_t reorderWindow = 4);
+
+    void setCallbacks(audio_frame_cb_t onFrame, audio_gap_cb_t onGap, void* ctx);
+
+    /** Feed one notification of the audio characteristic */
+    void push(const uint8_t* data, size_t length);
+
+    /** Deliver everything still held back (end of capture) */
+    void flush();
+
+    const audio_stream_stats_t& stats() const { return counters; }
+
+private:
+    typedef struct {
+        std::map<uint8_t, std::vector<uint8_t> > chunks;
+        int lastIndex;              // Index of the chunk flagged last, -1 until seen
+    } partial_frame_t;
+
+    int64_t unwrap(uint16_t counter);
+    void completeChunked(int64_t sequence, partial_frame_t* frame);
+    void accept(int64_t sequence, const uint8_t* payload, size_t length, bool chunked);
+    void emit(int64_t sequence, const std::vector<uint8_t>& payload);
+    void expirePartials();
+
+    size_t window;
+    bool started;
+    int64_t lastSequence;           // Latest unwrapped counter seen
+    int64_t nextSequence;           // Next frame to deliver
+    std::map<int64_t, std::vector<uint8_t> > pending;
+    std::map<int64_t, partial_frame_t> partials;
+    int64_t recent[256];            // Delivered sequences, for duplicate detection
+    audio_stream_stats_t counters;
+    audio_frame_cb_t frameCallback;
+    audio_gap_cb_t gapCallback;
+    void* callbackCtx;
+};
+
+/**
+ * Frame decoder. Gaps are concealed with silence of the last frame's
+ * length. Without libopus (HAVE_OPUS) Opus frames are kept undecoded.
+ */
+class AudioDecoder {
+public:
+    /** @param sampleRate 0 for the firmware's rate for the codec */
+    AudioDecoder(audio_codec_t codec, uint32_t sampleRate);
+    ~AudioDecoder();
+    AudioDecoder(const AudioDecoder&) = delete;
+    AudioDecoder& operator=(const AudioDecoder&) = delete;
+
+    /** Sample rate the firmware uses for a codec */
+    static uint32_t defaultSampleRate(audio_codec_t codec);
+    static bool parseCodec(const char* text, audio_codec_t* codec);
+    static const char* codecName(audio_codec_t codec);
+    static bool canDecode(audio_codec_t codec);
+
+    void decode(const uint8_t* payload, size_t length);
+    void conceal(uint32_t frames);
+
+    /** Fill gaps with silence (default) or leave them out */
+    void setConcealment(bool enabled) { concealGaps = enabled; }
+
+    /** Hook up to an AudioReassembler */
+    static void onFrame(void* ctx, int64_t sequence, const uint8_t* payload, size_t length);
+    static void onGap(void* ctx, int64_t sequence, uint32_t count);
+
+    const std::vector<int16_t>& samples() const { return pcm; }
+    const std::vector<std::vector<uint8_t> >& rawFrames() const { return raw; }
+    uint32_t sampleRate() const { return rate; }
+    uint32_t concealedSamples() const { return concealed; }
+    uint32_t decodeErrors() const { return errors; }
+
+    /** Write the decoded samples as a mono 16-bit WAV file */
+    bool writeWav(const char* path) const;
+
+    /** Write undecoded frames, each prefixed with its 16-bit little-endian length */
+    bool writeRawFrames(const char* path) const;
+
+private:
+    audio_codec_t codec;
+    uint32_t rate;
+    bool concealGaps;
+    size_t lastFrameSamples;
+    uint32_t concealed;
+    uint32_t errors;
+    std::vector<int16_t> pcm;
+    std::vector<std::vector<uint8_t> > raw;
+    void* opus;
+};
+
+// ===================================================================
+// IMAGES
+// ===================================================================
+
+/**
+ * Photo / video stream counters
+ */
+typedef struct {
+    uint32_t packets;
+    uint32_t images;                // Images delivered (complete or not)
+    uint32_t complete;              // All chunks present, JPEG SOI/EOI intact
+    uint32_t missing_chunks;
+    uint32_t duplicates;
+    uint32_t out_of_order;
+    uint32_t unterminated;          // Next image began before the end marker
+    uint32_t stray_end_markers;     // End marker with no chunks before it
+    uint32_t malformed;
+    uint32_t compacted;             // Arrived without headers and were rebuilt
+    uint32_t unknown_tables;        // Arrived without headers we had cached
+    uint32_t start_headers;         // Photo start headers (PHOTO_START_HEADER)
+    uint64_t bytes;                 // As delivered (headers put back)
+    uint64_t wire_bytes;            // As received
+} image_stream_stats_t;
+
+/**
+ * An image is finished
+ * @param complete All chunks arrived and the data is a whole JPEG
+ */
+typedef void (*image_cb_t)(void* ctx, uint32_t number, const uint8_t* data, size_t length, bool complete);
+
+class ImageReassembler {
+public:
+    /** @param frameType BLE_FRAME_TYPE_PHOTO, _VIDEO, _BLOCKS or _CODE (scanned codes: [symbology] + text) */
+    explicit ImageReassembler(uint8_t frameType);
+
+    void setCallback(image_cb_t callback, void* ctx);
+
+    void push(const uint8_t* data, size_t length);
+
+    /** Deliver a half-received image (end of capture) */
+    void flush();
+
+    const image_stream_stats_t& stats() const { return counters; }
+
+    /**
+     * Start header of the image being delivered (call from the callback)
+     * @return false if it had none, or it carried no hash
+     */
+    bool startHash(uint64_t* hash) const;
+
+    /** BLE_PHOTO_START_* flags of the image being delivered; 0 without a start header */
+    uint8_t startFlags() const { return started ? flags : 0; }
+
+private:
+    void finish(bool terminated);
+    bool restoreHeader();
+
+    uint8_t type;
+    bool active;
+    int lastIndex;
+    std::map<uint16_t, std::vector<uint8_t> > chunks;
+    std::vector<uint8_t> image;
+    std::map<uint32_t, std::vector<uint8_t> > headers;     // JPEG headers by table ID
+    bool started;                   // A start header came before the chunks
+    uint8_t flags;                  // Its BLE_PHOTO_START_* flags
+    uint64_t hash;
+    uint32_t announcedLength;       // Wire bytes the start header announced
+    image_stream_stats_t counters;
+    image_cb_t imageCallback;
+    void* callbackCtx;
+};
+
+#endif // STREAM_REASSEMBLY_H
@@ -0,0 +1,227 @@
+#include "virtual_device.h"
+#include "features/bluetooth/ble_transport.h"
+#include "features/bluetooth/ble_manager.h"
+#include "features/camera/camera.h"
+#include "status/device_lifecycle.h"
+#include "system/battery/battery_code.h"
+#include "check.h"
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// ===================================================================
+// BLE TRANSPORT TEST
+// ===================================================================
+//
+// The transport on the mock backend (the virtual device's central):
+// handles and their limits, UUID checks, values, write dispatch,
+// connection events, and what notify() counts with and without a
+// connection. Then the firmware's GATT server on it: the values clients
+// read, a photo control write, the status notification on connect and
+// advertising again after a disconnect.
+//
+
+static const char* MAIN_SERVICE = "19B10000-E8F2-537E-4F6C-D104768A1214";
+static const char* DATA_UUID = "19B10005-E8F2-537E-4F6C-D104768A1214";
+static const char* CONTROL_UUID = "19B10006-E8F2-537E-4F6C-D104768A1214";
+
+static int controlWrites = 0;
+static int echoWrites = 0;
+static std::vector<uint8_t> lastWrite;
+static int connects = 0;
+static int disconnects = 0;
+static ble_connection_t lastConnection;
+
+static void onControlWrite(const uint8_t* data, size_t length) {
+    controlWrites++;
+    lastWrite.assign(data, data + length);
+}
+
+static void onEchoWrite(const uint8_t* data, size_t length) {
+    echoWrites++;
+    lastWrite.assign(data, data + length);
+}
+
+static void onConnection(bool connected, const ble_connection_t* connection) {
+    if (connected) {
+        connects++;
+        lastConnection = *connection;
+    } else {
+        disconnects++;
+        CHECK(connection == nullptr);
+    }
+}
+
+static std::vector<uint8_t> readValue(const char* uuid) {
+    std::vector<uint8_t> value;
+    CHECK(VirtualDevice::readCharacteristic(uuid, &value));
+    return value;
+}
+
+static std::string readText(const char* uuid) {
+    std::vector<uint8_t> value = readValue(uuid);
+    return std::string(value.begin(), value.end());
+}
+
+static uint32_t notified(const char* stream) {
+    for (size_t i = 0; i < VirtualDevice::streamCount(); i++) {
+        const VirtualDevice::stream_stats_t* s = VirtualDevice::streamStats(i);
+        if (strcmp(VirtualDevice::streamName(s->uuid), stream) == 0) return s->packets;
+    }
+    return 0;
+}
+
+// ===================================================================
+// TRANSPORT
+// ===================================================================
+
+static void testTransport() {
+    CHECK(BleTransport::begin("transport test", 185, onConnection));
+    CHECK(strcmp(BleTransport::stats()->backend, "mock") == 0);
+
+    // UUIDs: 4 hex digits or 8-4-4-4-12, either case
+    CHECK(BleTransport::createService(nullptr) == BLE_HANDLE_NONE);
+    CHECK(BleTransport::createService("18F") == BLE_HANDLE_NONE);
+    CHECK(BleTransport::createService("180G") == BLE_HANDLE_NONE);
+    CHECK(BleTransport::createService("19B10000E-8F2-537E-4F6C-D104768A1214") == BLE_HANDLE_NONE);
+    ble_handle_t service = BleTransport::createService(MAIN_SERVICE);
+    ble_handle_t battery = BleTransport::createService("180f");
+    CHECK(service == 0 && battery == 1);
+
+    CHECK(BleTransport::createCharacteristic(BLE_HANDLE_NONE, DATA_UUID, BLE_PROPERTY_READ) == BLE_HANDLE_NONE);
+    CHECK(BleTransport::createCharacteristic(7, DATA_UUID, BLE_PROPERTY_READ) == BLE_HANDLE_NONE);
+    ble_handle_t data = BleTransport::createCharacteristic(service, DATA_UUID, BLE_PROPERTY_READ | BLE_PROPERTY_NOTIFY);
+    ble_handle_t control = BleTransport::createCharacteristic(service, "19b10006-e8f2-537e-4f6c-d104768a1214",
+                                                              BLE_PROPERTY_WRITE, onControlWrite);
+    ble_handle_t level = BleTransport::createCharacteristic(battery, "2A19", BLE_PROPERTY_READ | BLE_PROPERTY_NOTIFY);
+    ble_handle_t echo = BleTransport::createCharacteristic(battery, "2A1A", BLE_PROPERTY_READ | BLE_PROPERTY_WRITE,
+                                                           onEchoWrite);
+    CHECK(data == 0 && control == 1 && level == 2 && echo == 3);
+
+    // Both tables fill up
+    int services = 2;
+    while (BleTransport::createService("FFF0") != BLE_HANDLE_NONE) services++;
+    CHECK(services == BLE_TRANSPORT_MAX_SERVICES);
+    int characteristics = 4;
+    while (BleTransport::createCharacteristic(battery, "FFF1", BLE_PROPERTY_READ) != BLE_HANDLE_NONE) characteristics++;
+    CHECK(characteristics == BLE_TRANSPORT_MAX_CHARACTERISTICS);
+
+    // Values; without a central notify() only sets the value
+    uint8_t percent = 87;
+    BleTransport::setValue(level, &percent, 1);
+    BleTransport::setValue(echo, "echo");
+    uint8_t chunk[180];
+    for (size_t i = 0; i < sizeof(chunk); i++) chunk[i] = (uint8_t)(i * 7);
+    CHECK(!BleTransport::notify(data, chunk, sizeof(chunk)));
+    CHECK(!BleTransport::notify(BLE_HANDLE_NONE, chunk, sizeof(chunk)));
+    CHECK(BleTransport::stats()->notifications == 0 && BleTransport::stats()->notify_failures == 0);
+    CHECK(readValue("2A19") == std::vector<uint8_t>(1, 87));
+    CHECK(readValue(DATA_UUID) == std::vector<uint8_t>(chunk, chunk + sizeof(chunk)));
+
+    // The central can only connect once the services are up; nothing is added after
+    VirtualDevice::setPeerMtu(247);
+    VirtualDevice::connect();
+    CHECK(!VirtualDevice::isConnected() && connects == 0);
+    CHECK(BleTransport::startServices());
+    CHECK(BleTransport::createService("FFF2") == BLE_HANDLE_NONE);
+    BleTransport::advertiseService("180F");
+    BleTransport::advertiseService(MAIN_SERVICE);
+    BleTransport::startAdvertising();
+    CHECK(VirtualDevice::isAdvertising());
+    CHECK(BleTransport::peerMtu() == 23);
+
+    VirtualDevice::connect();
+    CHECK(BleTransport::isConnected() && connects == 1 && !VirtualDevice::isAdvertising());
+    CHECK(lastConnection.address[0] == 0x5a && lastConnection.interval == 24 && lastConnection.latency == 0 &&
+          lastConnection.timeout == 400);
+    CHECK(BleTransport::peerMtu() == 185);
+
+    // Writes go to their own handler, and only to writable characteristics
+    uint8_t command = 0x7f;
+    CHECK(VirtualDevice::writeCharacteristic(CONTROL_UUID, &command, 1));
+    CHECK(controlWrites == 1 && echoWrites == 0 && lastWrite == std::vector<uint8_t>(1, 0x7f));
+    CHECK(VirtualDevice::writeCharacteristic(CONTROL_UUID, nullptr, 0));
+    CHECK(controlWrites == 2 && lastWrite.empty());
+    CHECK(!VirtualDevice::writeCharacteristic("2A19", &command, 1));
+    CHECK(!VirtualDevice::writeCharacteristic("FFFF", &command, 1));
+    std::vector<uint8_t> unreadable;
+    CHECK(!VirtualDevice::readCharacteristic(CONTROL_UUID, &unreadable));
+    CHECK(readText("2a1a") == "echo");
+    const uint8_t reply[] = {'o', 'k'};
+    CHECK(VirtualDevice::writeCharacteristic("2a1a", reply, sizeof(reply)));
+    CHECK(echoWrites == 1 && readText("2A1A") == "ok");
+
+    // Connected: notifications are counted, timed and reach the central
+    uint32_t before = notified("photo");
+    for (int i = 0; i < 10; i++) CHECK(BleTransport::notify(data, chunk, sizeof(chunk)));
+    VirtualDevice::advanceUs(2000000);
+    const ble_transport_stats_t* s = BleTransport::stats();
+    CHECK(s->notifications == 10 && s->notify_bytes == 10 * sizeof(chunk) && s->notify_failures == 0);
+    CHECK(s->connected_ms == 2000);
+    CHECK(notified("photo") == before + 10);
+
+    VirtualDevice::disconnect();
+    CHECK(!BleTransport::isConnected() && disconnects == 1);
+    CHECK(BleTransport::peerMtu() == 23);
+    CHECK(!BleTransport::notify(data, chunk, sizeof(chunk)));
+    VirtualDevice::advanceUs(1000000);
+    CHECK(BleTransport::stats()->connected_ms == 2000 && BleTransport::stats()->notifications == 10);
+}
+
+// ===================================================================
+// FIRMWARE GATT SERVER
+// ===================================================================
+
+static void testFirmwareServer() {
+    DeviceLifecycle::reset();
+    DeviceLifecycle::dispatch(LIFECYCLE_EVENT_BOOT_DONE);
+    captureInterval = 0;
+
+    configureBLE();
+    CHECK(isBLEServerRunning() && VirtualDevice::isAdvertising());
+    CHECK(strcmp(BleTransport::stats()->backend, "mock") == 0);
+
+    // What clients read without subscribing
+    CHECK(readText(MANUFACTURER_NAME_STRING_CHAR_UUID) == MANUFACTURER_NAME);
+    CHECK(readText(MODEL_NUMBER_STRING_CHAR_UUID) == MODEL_NUMBER);
+    CHECK(readText(FIRMWARE_REVISION_STRING_CHAR_UUID) == FIRMWARE_VERSION);
+    CHECK(readText(HARDWARE_REVISION_STRING_CHAR_UUID) == HARDWARE_VERSION);
+    CHECK(readValue(AUDIO_CODEC_UUID) == std::vector<uint8_t>(1, CODEC_ID));
+    CHECK(readValue(BATTERY_LEVEL_CHAR_UUID) == std::vector<uint8_t>(1, batteryLevel));
+
+    uint32_t statusBefore = notified("device_status");
+    VirtualDevice::connect();
+    CHECK(bleConnected && BLEManager::isConnected());
+    CHECK(notified("device_status") == statusBefore + 1);
+    CHECK(BleTransport::peerMtu() == 247);
+
+    // Photo control reaches handlePhotoControl()
+    uint8_t interval = 10;
+    CHECK(VirtualDevice::writeCharacteristic(PHOTO_CONTROL_UUID, &interval, 1));
+    DeviceLifecycle::process();
+    CHECK(DeviceLifecycle::isIn(LIFECYCLE_CAPTURING) && captureInterval == 10000);
+    uint8_t stop = PHOTO_STOP;
+    CHECK(VirtualDevice::writeCharacteristic(PHOTO_CONTROL_UUID, &stop, 1));
+    DeviceLifecycle::process();
+    CHECK(captureInterval == 0);
+
+    uint8_t level = batteryLevel;
+    updateBatteryLevel();
+    CHECK(readValue(BATTERY_LEVEL_CHAR_UUID) == std::vector<uint8_t>(1, batteryLevel));
+    (void)level;
+
+    VirtualDevice::disconnect();
+    CHECK(!bleConnected && VirtualDevice::isAdvertising());
+}
+
+int main() {
+    VirtualDevice::setConsole(nullptr);
+    testTransport();
+    VirtualDevice::setConsole(stdout);
+    BleTransport::printReport();
+    VirtualDevice::setConsole(nullptr);
+    testFirmwareServer();
+
+    return finishChecks("ble transport");
+}
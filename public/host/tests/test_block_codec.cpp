@@ -0,0 +1,262 @@
+#include "virtual_device.h"
+#include "features/camera/block_codec.h"
+#include "check.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+// ===================================================================
+// BLOCK CODEC TEST
+// ===================================================================
+//
+// The block codec kernels against straightforward references, then
+// BlockEncoder/BlockDecoder on small synthetic frames: static frames cost
+// the header and bitmap, changed blocks are sent and the decoder tracks
+// the encoder's reference exactly, refresh and requested key frames, key
+// frames cut short by a small buffer, and malformed frames rejected.
+//
+
+static const uint16_t WIDTH = 64;
+static const uint16_t HEIGHT = 48;
+static const size_t BLOCKS = (WIDTH / BLOCK_SIZE) * (HEIGHT / BLOCK_SIZE);
+static const size_t BITMAP_SIZE = (BLOCKS + 7) / 8;
+
+/**
+ * Gradient with some texture, shifted by phase
+ */
+static std::vector<uint8_t> makeFrame(int phase) {
+    std::vector<uint8_t> frame((size_t)WIDTH * HEIGHT);
+    for (size_t y = 0; y < HEIGHT; y++) {
+        for (size_t x = 0; x < WIDTH; x++) {
+            frame[y * WIDTH + x] = (uint8_t)(40 + x * 2 + y + ((x + y + phase) % 7) * 5);
+        }
+    }
+    return frame;
+}
+
+/** Paint a flat square over block (bx, by) */
+static void paintBlock(std::vector<uint8_t>& frame, size_t bx, size_t by, uint8_t value) {
+    for (size_t y = 0; y < BLOCK_SIZE; y++) {
+        memset(&frame[(by * BLOCK_SIZE + y) * WIDTH + bx * BLOCK_SIZE], value, BLOCK_SIZE);
+    }
+}
+
+static size_t bitCount(const uint8_t* coded) {
+    size_t count = 0;
+    for (size_t i = 0; i < BLOCKS; i++) count += (coded[BLOCK_FRAME_HEADER_SIZE + i / 8] >> (i % 8)) & 1;
+    return count;
+}
+
+static void testKernels() {
+    std::vector<uint8_t> a = makeFrame(0), b = makeFrame(3);
+    uint32_t expected = 0;
+    for (size_t y = 0; y < 16; y++) {
+        for (size_t x = 0; x < 16; x++) expected += (uint32_t)abs(a[y * WIDTH + x + 16] - b[y * WIDTH + x + 16]);
+    }
+    CHECK(blockSad16(&a[16], &b[16], WIDTH) == expected);
+    CHECK(blockSad16(&a[0], &a[0], WIDTH) == 0);
+
+    // Flat block: DC only
+    std::vector<uint8_t> flat(64, 200);
+    int32_t coefficients[64];
+    blockForwardDct8(&flat[0], 8, coefficients);
+    CHECK(coefficients[0] == (200 - 128) * 8);
+    bool acZero = true;
+    for (int i = 1; i < 64; i++) acZero &= coefficients[i] == 0;
+    CHECK(acZero);
+
+    // Forward then inverse, unquantized: within one level
+    blockForwardDct8(&a[WIDTH * 8 + 8], WIDTH, coefficients);
+    uint8_t back[64];
+    blockInverseDct8(coefficients, back, 8);
+    int worst = 0;
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < 8; x++) {
+            int d = abs(back[y * 8 + x] - a[(8 + y) * WIDTH + 8 + x]);
+            if (d > worst) worst = d;
+        }
+    }
+    CHECK(worst <= 1);
+
+    // Quality scales the table as libjpeg does
+    uint16_t q50[64], q100[64], q10[64];
+    blockQuantTable(50, q50);
+    blockQuantTable(100, q100);
+    blockQuantTable(10, q10);
+    CHECK(q50[0] == 16 && q100[0] == 1 && q10[0] == 80);
+}
+
+static void testRoundTrip() {
+    block_codec_config_t config = {WIDTH, HEIGHT, 50, 2560, 0};
+    std::vector<uint8_t> reference((size_t)WIDTH * HEIGHT), client(reference.size());
+    std::vector<uint8_t> coded(blockFrameMaxSize(WIDTH, HEIGHT));
+    BlockEncoder encoder;
+    BlockDecoder decoder;
+    CHECK(encoder.begin(config, &reference[0]));
+    CHECK(decoder.begin(WIDTH, HEIGHT, &client[0]));
+
+    // First frame: key
+    std::vector<uint8_t> frame = makeFrame(0);
+    size_t length = encoder.encode(&frame[0], &coded[0], coded.size());
+    CHECK(length > BLOCK_FRAME_HEADER_SIZE + BITMAP_SIZE);
+    CHECK(coded[0] == BLOCK_FRAME_MAGIC && (coded[1] & BLOCK_FRAME_KEY));
+    CHECK(bitCount(&coded[0]) == BLOCKS);
+    CHECK(decoder.decode(&coded[0], length));
+    CHECK(decoder.hasKeyFrame());
+    CHECK(client == reference);
+
+    // Same picture: nothing but the bitmap
+    length = encoder.encode(&frame[0], &coded[0], coded.size());
+    CHECK(length == BLOCK_FRAME_HEADER_SIZE + BITMAP_SIZE);
+    CHECK(!(coded[1] & BLOCK_FRAME_KEY));
+    CHECK(decoder.decode(&coded[0], length));
+    CHECK(decoder.lastFrameNumber() == 1);
+
+    // Two blocks change
+    paintBlock(frame, 1, 0, 250);
+    paintBlock(frame, 3, 2, 10);
+    length = encoder.encode(&frame[0], &coded[0], coded.size());
+    CHECK(bitCount(&coded[0]) == 2);
+    CHECK((coded[BLOCK_FRAME_HEADER_SIZE] >> 1) & 1);
+    CHECK(decoder.decode(&coded[0], length));
+    CHECK(client == reference);
+    CHECK(client[0 * WIDTH + 20] == 250 && client[(2 * 16 + 5) * WIDTH + 50] == 10);
+
+    const block_codec_stats_t& s = encoder.stats();
+    CHECK(s.frames == 3);
+    CHECK(s.key_frames == 1);
+    CHECK(s.blocks == 3 * BLOCKS);
+    CHECK(s.blocks_sent == BLOCKS + 2);
+    CHECK(s.blocks_deferred == 0);
+
+    // Requested key frame
+    encoder.requestKeyFrame();
+    length = encoder.encode(&frame[0], &coded[0], coded.size());
+    CHECK((coded[1] & BLOCK_FRAME_KEY) && bitCount(&coded[0]) == BLOCKS);
+    CHECK(decoder.decode(&coded[0], length));
+    CHECK(client == reference);
+
+    // Too small for the header and bitmap
+    CHECK(encoder.encode(&frame[0], &coded[0], BLOCK_FRAME_HEADER_SIZE + BITMAP_SIZE - 1) == 0);
+}
+
+static void testRefresh() {
+    block_codec_config_t config = {WIDTH, HEIGHT, 50, 2560, 4};
+    std::vector<uint8_t> reference((size_t)WIDTH * HEIGHT);
+    std::vector<uint8_t> coded(blockFrameMaxSize(WIDTH, HEIGHT));
+    BlockEncoder encoder;
+    CHECK(encoder.begin(config, &reference[0]));
+    std::vector<uint8_t> frame = makeFrame(1);
+    for (int i = 0; i < 12; i++) {
+        encoder.encode(&frame[0], &coded[0], coded.size());
+        CHECK(((coded[1] & BLOCK_FRAME_KEY) != 0) == (i % 4 == 0));
+    }
+    CHECK(encoder.stats().key_frames == 3);
+}
+
+static void testDeferral() {
+    block_codec_config_t config = {WIDTH, HEIGHT, 90, 2560, 0};
+    std::vector<uint8_t> reference((size_t)WIDTH * HEIGHT), client(reference.size());
+    std::vector<uint8_t> coded(blockFrameMaxSize(WIDTH, HEIGHT));
+    BlockEncoder encoder;
+    BlockDecoder decoder;
+    CHECK(encoder.begin(config, &reference[0]));
+    CHECK(decoder.begin(WIDTH, HEIGHT, &client[0]));
+
+    // Room for two worst-case blocks per frame: the key frame is spread
+    // over several frames and none of them is marked as one
+    std::vector<uint8_t> frame = makeFrame(2);
+    size_t capacity = BLOCK_FRAME_HEADER_SIZE + BITMAP_SIZE + 2 * BLOCK_MAX_CODED_SIZE;
+    size_t sent = 0;
+    int frames = 0;
+    while (sent < BLOCKS && frames < 20) {
+        size_t length = encoder.encode(&frame[0], &coded[0], capacity);
+        CHECK(length <= capacity);
+        CHECK(!(coded[1] & BLOCK_FRAME_KEY));
+        CHECK(decoder.decode(&coded[0], length));
+        CHECK(bitCount(&coded[0]) >= 2);
+        sent += bitCount(&coded[0]);
+        frames++;
+    }
+    CHECK(sent == BLOCKS);
+    CHECK(frames > 1 && frames <= (int)(BLOCKS / 2));
+    CHECK(client == reference);
+    CHECK(!decoder.hasKeyFrame());
+    CHECK(encoder.stats().blocks_deferred > 0);
+    CHECK(encoder.stats().key_frames == 0);
+}
+
+static void testMalformed() {
+    block_codec_config_t config = {WIDTH, HEIGHT, 50, 2560, 0};
+    std::vector<uint8_t> reference((size_t)WIDTH * HEIGHT), client(reference.size());
+    std::vector<uint8_t> coded(blockFrameMaxSize(WIDTH, HEIGHT));
+    BlockEncoder encoder;
+    BlockDecoder decoder;
+    CHECK(!encoder.begin(config, nullptr));
+    block_codec_config_t odd = config;
+    odd.width = 40;
+    CHECK(!encoder.begin(odd, &reference[0]));
+    CHECK(!decoder.begin(WIDTH, 20, &client[0]));
+    CHECK(encoder.begin(config, &reference[0]));
+    CHECK(decoder.begin(WIDTH, HEIGHT, &client[0]));
+
+    std::vector<uint8_t> frame = makeFrame(4);
+    size_t length = encoder.encode(&frame[0], &coded[0], coded.size());
+    std::vector<uint8_t> good(coded.begin(), coded.begin() + length);
+
+    std::vector<uint8_t> broken = good;
+    broken[0] = 0xB2;
+    CHECK(!decoder.decode(&broken[0], broken.size()));
+    broken = good;
+    broken[4]++;
+    CHECK(!decoder.decode(&broken[0], broken.size()));
+    broken = good;
+    broken[6] = 0;
+    CHECK(!decoder.decode(&broken[0], broken.size()));
+    CHECK(!decoder.decode(&good[0], BLOCK_FRAME_HEADER_SIZE + BITMAP_SIZE - 1));
+    CHECK(!decoder.decode(&good[0], good.size() - 1));
+
+    // Trailing bytes
+    broken = good;
+    broken.push_back(0);
+    CHECK(!decoder.decode(&broken[0], broken.size()));
+
+    // Run past the end of the block
+    broken.assign(good.begin(), good.begin() + BLOCK_FRAME_HEADER_SIZE + BITMAP_SIZE);
+    broken.push_back(0x00);     // DC delta 0
+    broken.push_back(62);
+    broken.push_back(0x02);
+    broken.push_back(1);
+    CHECK(!decoder.decode(&broken[0], broken.size()));
+
+    // Out-of-range DC
+    broken.assign(good.begin(), good.begin() + BLOCK_FRAME_HEADER_SIZE + BITMAP_SIZE);
+    broken.push_back(0xFF);
+    broken.push_back(0xFF);
+    broken.push_back(0x7F);
+    broken.push_back(63);
+    CHECK(!decoder.decode(&broken[0], broken.size()));
+
+    // Random bytes never crash and a good frame still decodes afterwards
+    srand(7);
+    for (int i = 0; i < 2000; i++) {
+        broken = good;
+        for (int k = 0; k < 4; k++) broken[BLOCK_FRAME_HEADER_SIZE + rand() % (broken.size() - BLOCK_FRAME_HEADER_SIZE)] = (uint8_t)rand();
+        decoder.decode(&broken[0], broken.size());
+    }
+    CHECK(decoder.decode(&good[0], good.size()));
+    CHECK(client == reference);
+}
+
+int main() {
+    VirtualDevice::setConsole(nullptr);
+
+    testKernels();
+    testRoundTrip();
+    testRefresh();
+    testDeferral();
+    testMalformed();
+
+    return finishChecks("block codec");
+}
@@ -0,0 +1,116 @@
+#include "virtual_device.h"
+#include "system/clock/timing.h"
+#include "system/cycles/cycle_manager.h"
+#include "check.h"
+#include <stdio.h>
+
+// ===================================================================
+// CLOCK WRAP TEST
+// ===================================================================
+//
+// Boots the virtual clock just before the 32-bit millis() wrap (49.7
+// days) and steps the cycle manager across it, as the main loop would.
+// Interval, timeout and pattern cycles must keep their rate; the 32-bit
+// timing helpers must stay correct for short durations across the wrap.
+//
+
+static const uint64_t MILLIS_WRAP_US = 4294967296ULL * 1000ULL;     // 2^32 ms
+static const uint64_t MICROS_WRAP_US = 4294967296ULL;              // 2^32 us
+
+static bool inRange(unsigned long value, unsigned long low, unsigned long high) {
+    return value >= low && value <= high;
+}
+
+static void testTimingHelpers() {
+    // millis() wrap
+    VirtualDevice::advanceTo(MILLIS_WRAP_US - 1500000ULL);
+    unsigned long start = measureStart();
+    uint64_t start_us = monotonicMicros();
+    uint64_t deadline_us = deadlineAfterMs(3000);
+    unsigned long lastTime = start;
+
+    VirtualDevice::advanceUs(1000000ULL);
+    CHECK(!hasTimedOut(start, 1500));
+    CHECK(!shouldExecute(&lastTime, 1500));
+
+    VirtualDevice::advanceUs(1000000ULL);       // 0.5 s past the wrap
+    CHECK(millis() < start);
+    CHECK(getElapsedTime(start) == 2000);
+    CHECK(measureEnd(start) == 2000);
+    CHECK(hasTimedOut(start, 1500));
+    CHECK(!hasTimedOut(start, 2500));
+    CHECK(getTimeRemaining(start, 3000) == 1000);
+    CHECK(shouldExecute(&lastTime, 1500));
+    CHECK(elapsedMicros(start_us) == 2000000ULL);
+    CHECK(hasTimedOutUs(start_us, 2000000ULL));
+    CHECK(!deadlineReached(deadline_us));
+    CHECK(monotonicMillis() == 4294967296ULL + 500);
+
+    VirtualDevice::advanceUs(1000000ULL);
+    CHECK(deadlineReached(deadline_us));
+    CHECK(elapsedMicros(monotonicMicros() + 1000) == 0);      // Start in the future
+
+    // micros() wraps every 71.6 minutes
+    uint64_t now = VirtualDevice::nowUs();
+    VirtualDevice::advanceTo(now + MICROS_WRAP_US - (now % MICROS_WRAP_US) - 300);
+    unsigned long startMicros = measureStartMicros();
+    VirtualDevice::advanceUs(1000);
+    CHECK(micros() < startMicros);
+    CHECK(getElapsedTimeMicros(startMicros) == 1000);
+    CHECK(hasTimedOutMicros(startMicros, 1000));
+}
+
+static int intervalRuns = 0;
+static int timeoutRuns = 0;
+static int patternRuns = 0;
+static uint64_t timeoutRanAt = 0;
+
+static pattern_step_t pattern[] = {
+    {200, 255, true},
+    {300, 0, false},
+};
+
+static void testCyclesAcrossWrap() {
+    // Start 10 s before the next millis() wrap
+    uint64_t now = VirtualDevice::nowUs();
+    uint64_t wrap = (now / MILLIS_WRAP_US + 1) * MILLIS_WRAP_US;
+    VirtualDevice::advanceTo(wrap - 10000000ULL);
+
+    initializeCycleManager();
+    uint64_t start_us = monotonicMicros();
+    int interval = registerIntervalCycle("wrap_interval", 100, []() { intervalRuns++; });
+    int timeout = registerTimeoutCycle("wrap_timeout", 12000, []() {
+        timeoutRuns++;
+        timeoutRanAt = monotonicMicros();
+    });
+    registerPatternCycle("wrap_pattern", pattern, 2, []() { patternRuns++; });
+    CHECK(interval >= 0 && timeout >= 0);
+
+    // 20 s of 10 ms loop passes
+    for (int i = 0; i < 2000; i++) {
+        VirtualDevice::advanceUs(10000);
+        updateCycles();
+    }
+
+    printf("interval %d, timeout %d (at %+.3f s), pattern %d\n", intervalRuns, timeoutRuns,
+           ((int64_t)timeoutRanAt - (int64_t)start_us) / 1e6, patternRuns);
+    CHECK(inRange(intervalRuns, 199, 200));
+    CHECK(timeoutRuns == 1);
+    CHECK(timeoutRanAt >= start_us + 12000000ULL && timeoutRanAt <= start_us + 12010000ULL);
+    CHECK(inRange(patternRuns, 79, 80));           // 20 s / (200 + 300) ms, two steps each
+
+    const cycle_runtime_t* stats = getCycleStats(interval);
+    CHECK(stats != nullptr);
+    CHECK(stats->last_execution_us > wrap);
+    CHECK(stats->next_execution_us == stats->last_execution_us + 100000ULL);
+    CHECK(getCycleState(timeout) == CYCLE_STATE_COMPLETED);
+}
+
+int main() {
+    VirtualDevice::setConsole(nullptr);
+
+    testTimingHelpers();
+    testCyclesAcrossWrap();
+
+    return finishChecks("clock wrap");
+}
@@ -0,0 +1,240 @@
+#include "virtual_device.h"
+#include "features/camera/code_scanner.h"
+#include "check.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// ===================================================================
+// CODE SCANNER TEST
+// ===================================================================
+//
+// The QR building blocks against published values (format and version
+// bits, codeword counts, the ISO 18004 "HELLO WORLD" EC codewords), then
+// Reed-Solomon correction of random errors, then whole-frame decoding of
+// codes drawn by the reference encoders in sim/code_render.cpp: every
+// version, level and mask, turned, tilted, noisy and unevenly lit, and
+// EAN-13 barcodes both ways up. The desk scene alone must decode nothing.
+//
+
+static const size_t WIDTH = 640;
+static const size_t HEIGHT = 480;
+
+static bool payloadIs(const code_result_t& result, const std::string& text) {
+    return result.length == text.size() && memcmp(result.payload, text.data(), text.size()) == 0;
+}
+
+static void testTables() {
+    CHECK(qrFormatBits(QR_EC_L, 0) == 0x77C4);
+    CHECK(qrFormatBits(QR_EC_M, 0) == 0x5412);
+    CHECK(qrFormatBits(QR_EC_Q, 0) == 0x355F);
+    CHECK(qrFormatBits(QR_EC_H, 0) == 0x1689);
+    CHECK(qrFormatBits(QR_EC_M, 5) == 0x40CE);
+    CHECK(qrVersionBits(7) == 0x07C94);
+    CHECK(qrVersionBits(10) == 0x0A4D3);
+
+    const uint16_t TOTALS[QR_MAX_VERSION] = {26, 44, 70, 100, 134, 172, 196, 242, 292, 346};
+    for (uint8_t version = QR_MIN_VERSION; version <= QR_MAX_VERSION; version++) {
+        CHECK(qrTotalCodewords(version) == TOTALS[version - 1]);
+        for (int level = 0; level < 4; level++) {
+            uint8_t blocks, longBlocks, shortData, ecPerBlock;
+            qrBlockLayout(version, (qr_ec_level_t)level, &blocks, &longBlocks, &shortData, &ecPerBlock);
+            CHECK(blocks * (shortData + ecPerBlock) + longBlocks == TOTALS[version - 1]);
+        }
+    }
+
+    // Timing row, finder corner, dark module, data
+    CHECK(qrIsFunctionModule(1, 10, 6) && qrIsFunctionModule(1, 0, 0) && qrIsFunctionModule(1, 8, 13));
+    CHECK(!qrIsFunctionModule(1, 10, 10) && !qrIsFunctionModule(1, 20, 20));
+    // Version 2 alignment pattern at (18, 18); version 7 version block
+    CHECK(qrIsFunctionModule(2, 16, 16) && qrIsFunctionModule(2, 20, 20) && !qrIsFunctionModule(2, 15, 18));
+    CHECK(qrIsFunctionModule(7, 34, 0) && qrIsFunctionModule(7, 0, 34) && !qrIsFunctionModule(7, 33, 0));
+}
+
+static void testReedSolomon() {
+    // The "HELLO WORLD" 1-M example: data then EC codewords
+    uint8_t hello[26] = {32, 91, 11, 120, 209, 114, 220, 77, 67, 64, 236, 17, 236, 17, 236, 17,
+                         196, 35, 39, 119, 235, 215, 231, 226, 93, 23};
+    uint8_t block[26];
+    memcpy(block, hello, sizeof(block));
+    CHECK(qrCorrectBlock(block, 26, 10) == 0);
+
+    srand(7);
+    for (int trial = 0; trial < 2000; trial++) {
+        memcpy(block, hello, sizeof(block));
+        int errors = 1 + trial % 5;
+        bool used[26] = {false};
+        for (int e = 0; e < errors; e++) {
+            int position;
+            do {
+                position = rand() % 26;
+            } while (used[position]);
+            used[position] = true;
+            block[position] ^= (uint8_t)(1 + rand() % 255);
+        }
+        CHECK(qrCorrectBlock(block, 26, 10) == errors);
+        CHECK(memcmp(block, hello, sizeof(block)) == 0);
+    }
+
+    // Beyond the capacity the block is never "corrected" to the original
+    int refused = 0;
+    for (int trial = 0; trial < 200; trial++) {
+        memcpy(block, hello, sizeof(block));
+        for (int e = 0; e < 8; e++) block[(trial + e * 3) % 26] ^= (uint8_t)(1 + (trial * 7 + e) % 255);
+        int result = qrCorrectBlock(block, 26, 10);
+        if (result < 0) refused++;
+        CHECK(result < 0 || memcmp(block, hello, sizeof(block)) != 0);
+    }
+    CHECK(refused > 150);
+}
+
+static std::string sampleText(size_t length, uint32_t seed) {
+    std::string text;
+    for (size_t i = 0; i < length; i++) text += (char)(' ' + (seed * 31 + i * 17 + i * i) % 95);
+    return text;
+}
+
+static bool decodeDrawn(const std::string& text, int level, int mask, const VirtualDevice::code_placement_t& placement,
+                        uint32_t scene, code_result_t* result, int* versionOut) {
+    std::vector<uint8_t> modules;
+    int dimension = VirtualDevice::encodeQr(text, level, mask, &modules);
+    if (dimension == 0) return false;
+    *versionOut = (dimension - 17) / 4;
+    std::vector<uint8_t> frame(WIDTH * HEIGHT);
+    VirtualDevice::renderDeskScene(&frame[0], WIDTH, HEIGHT, scene);
+    VirtualDevice::drawCode(&frame[0], WIDTH, HEIGHT, modules, dimension, dimension, placement);
+    return codeScan(&frame[0], WIDTH, HEIGHT, WIDTH, result) && result->symbology == CODE_SYMBOLOGY_QR &&
+           payloadIs(*result, text);
+}
+
+static void testQrRoundTrips() {
+    static code_result_t result;
+    // Every version (by length), level and mask, upright and clean
+    const size_t LENGTHS[] = {5, 20, 40, 60, 90, 120, 140, 170, 200, 250};
+    int versionsSeen = 0;
+    for (size_t i = 0; i < sizeof(LENGTHS) / sizeof(LENGTHS[0]); i++) {
+        for (int level = 0; level < 4; level++) {
+            for (int mask = 0; mask < 8; mask++) {
+                std::string text = sampleText(LENGTHS[i] / (level + 1), (uint32_t)(i * 32 + level * 8 + mask));
+                VirtualDevice::code_placement_t p = VirtualDevice::defaultCodePlacement();
+                int version = 0;
+                bool decoded = decodeDrawn(text, level, mask, p, 0, &result, &version);
+                if (!decoded) fprintf(stderr, "  %u bytes, version %d, level %d, mask %d\n",
+                                      (unsigned)text.size(), version, level, mask);
+                CHECK(decoded);
+                CHECK(result.version == version && result.corrected == 0);
+                versionsSeen |= 1 << version;
+            }
+        }
+    }
+    CHECK(versionsSeen == 0x7FE);   // 1-10
+
+    // Turned, tilted, noisy, shaded, smaller and larger
+    int decoded = 0, attempts = 0;
+    for (int angle = 0; angle < 360; angle += 15) {
+        VirtualDevice::code_placement_t p = VirtualDevice::defaultCodePlacement();
+        p.angle = angle;
+        p.tilt = (angle % 45) / 300.0;
+        p.noise = 8;
+        p.gradient = 60;
+        p.seed = (uint32_t)angle;
+        p.moduleSize = 3 + (angle % 4);
+        p.dark = 60;
+        p.light = 190;
+        std::string text = sampleText(30 + angle / 5, (uint32_t)angle);
+        int version = 0;
+        attempts++;
+        if (decodeDrawn(text, angle % 4, angle % 8, p, (uint32_t)angle, &result, &version)) {
+            decoded++;
+        } else {
+            fprintf(stderr, "  angle %d, version %d: not decoded\n", angle, version);
+        }
+    }
+    CHECK(decoded == attempts);
+
+    // Damage: a smudge over part of the data is corrected
+    std::string text = "https://example.com/item/12345";
+    std::vector<uint8_t> modules;
+    int dimension = VirtualDevice::encodeQr(text, QR_EC_H, 3, &modules);
+    for (int y = 12; y < 16; y++) {
+        for (int x = 12; x < 16; x++) modules[(size_t)y * dimension + x] ^= 1;
+    }
+    std::vector<uint8_t> frame(WIDTH * HEIGHT);
+    VirtualDevice::renderDeskScene(&frame[0], WIDTH, HEIGHT, 3);
+    VirtualDevice::drawCode(&frame[0], WIDTH, HEIGHT, modules, dimension, dimension,
+                            VirtualDevice::defaultCodePlacement());
+    CHECK(qrDecode(&frame[0], WIDTH, HEIGHT, WIDTH, &result) && payloadIs(result, text));
+    CHECK(result.corrected > 0);
+}
+
+static void testEan13() {
+    static code_result_t result;
+    const char* CODES[] = {"4006381333931", "0123456789012", "9780201379624", "5901234123457"};
+    for (size_t i = 0; i < sizeof(CODES) / sizeof(CODES[0]); i++) {
+        for (int angle = 0; angle < 360; angle += 90) {
+            std::vector<uint8_t> modules;
+            CHECK(VirtualDevice::encodeEan13(CODES[i], &modules));
+            VirtualDevice::code_placement_t p = VirtualDevice::defaultCodePlacement();
+            p.moduleSize = 3;
+            p.rowsPerModule = 40;
+            p.quietZone = 9;
+            p.angle = angle + 4;
+            p.noise = 6;
+            p.gradient = 40;
+            std::vector<uint8_t> frame(WIDTH * HEIGHT);
+            VirtualDevice::renderDeskScene(&frame[0], WIDTH, HEIGHT, (uint32_t)i);
+            VirtualDevice::drawCode(&frame[0], WIDTH, HEIGHT, modules, (int)modules.size(), 1, p);
+            bool decoded = codeScan(&frame[0], WIDTH, HEIGHT, WIDTH, &result);
+            if (!decoded) fprintf(stderr, "  EAN-13 %s at %d degrees: not decoded\n", CODES[i], angle);
+            CHECK(decoded && result.symbology == CODE_SYMBOLOGY_EAN13 && payloadIs(result, CODES[i]));
+        }
+    }
+
+    // 12 digits get their check digit; a wrong check digit is rejected
+    std::vector<uint8_t> good, bad;
+    CHECK(VirtualDevice::encodeEan13("400638133393", &good));
+    CHECK(VirtualDevice::encodeEan13("4006381333932", &bad));
+    CHECK(!VirtualDevice::encodeEan13("40063813339", &bad) && !VirtualDevice::encodeEan13("40063813339x", &bad));
+    CHECK(VirtualDevice::encodeEan13("4006381333932", &bad));
+    const std::vector<uint8_t>* sets[2] = {&good, &bad};
+    for (int i = 0; i < 2; i++) {
+        VirtualDevice::code_placement_t p = VirtualDevice::defaultCodePlacement();
+        p.moduleSize = 3;
+        p.rowsPerModule = 40;
+        p.quietZone = 9;
+        std::vector<uint8_t> frame(WIDTH * HEIGHT);
+        VirtualDevice::renderDeskScene(&frame[0], WIDTH, HEIGHT, 5);
+        VirtualDevice::drawCode(&frame[0], WIDTH, HEIGHT, *sets[i], (int)sets[i]->size(), 1, p);
+        bool decoded = ean13Decode(&frame[0], WIDTH, HEIGHT, WIDTH, &result);
+        CHECK(i == 0 ? decoded && payloadIs(result, "4006381333931") : !decoded);
+    }
+}
+
+static void testNothingToFind() {
+    static code_result_t result;
+    std::vector<uint8_t> frame(WIDTH * HEIGHT);
+    for (uint32_t scene = 0; scene < 120; scene += 3) {
+        VirtualDevice::renderDeskScene(&frame[0], WIDTH, HEIGHT, scene);
+        CHECK(!codeScan(&frame[0], WIDTH, HEIGHT, WIDTH, &result));
+        CHECK(result.symbology == CODE_SYMBOLOGY_NONE && result.length == 0);
+    }
+    // Flat and tiny frames
+    memset(&frame[0], 128, frame.size());
+    CHECK(!codeScan(&frame[0], WIDTH, HEIGHT, WIDTH, &result));
+    CHECK(!codeScan(&frame[0], 8, 8, 8, &result));
+    CHECK(!codeScan(nullptr, WIDTH, HEIGHT, WIDTH, &result));
+}
+
+int main() {
+    VirtualDevice::setConsole(nullptr);
+
+    testTables();
+    testReedSolomon();
+    testQrRoundTrips();
+    testEan13();
+    testNothingToFind();
+
+    return finishChecks("code scanner");
+}
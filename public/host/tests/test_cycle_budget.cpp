@@ -0,0 +1,225 @@
+#include "virtual_device.h"
+#include "system/clock/timing.h"
+#include "system/cycles/cycle_manager.h"
+#include "check.h"
+#include <stdio.h>
+
+// ===================================================================
+// CYCLE BUDGET SIMULATION
+// ===================================================================
+//
+// Audio capture and a large photo upload at the same priority, on the
+// virtual clock. Audio frames arrive every 10 ms into a DMA ring of four
+// frames, so a frame must be read within 40 ms or it is lost. The upload
+// sends 500 chunks of 2 ms CPU each (a busy or congested link) and keeps
+// sending until cycleShouldYield(). Without a budget it holds the loop
+// for a second and audio overruns; with one, audio keeps its deadline
+// and the upload still finishes. Also checks the defer and demote
+// policies and admission against the utilisation bound.
+//
+
+static const uint64_t AUDIO_FRAME_US = 10000;
+static const uint64_t AUDIO_RING_FRAMES = 4;
+static const uint64_t AUDIO_READ_US = 300;         // CPU per frame read and encoded
+static const uint32_t PHOTO_CHUNKS = 500;
+static const uint64_t LOOP_DELAY_US = 1000;
+
+/**
+ * One run of the simulation
+ */
+typedef struct {
+    uint64_t start_us;
+    uint64_t frames_read;
+    uint64_t frames_dropped;
+    uint64_t max_latency_us;        // Arrival of a frame to its read
+    uint32_t chunks_sent;
+    uint32_t chunk_cost_us;
+    bool one_chunk_per_run;
+    uint64_t upload_done_us;        // 0 while uploading
+    uint64_t upload_cpu_us;
+    char last_cycle;                // 'a' or 'p': which ran last in the pass
+    uint32_t photo_after_audio;     // Passes where the upload ran after audio
+} budget_sim_t;
+
+static budget_sim_t sim;
+
+static uint64_t framesArrived() {
+    return (monotonicMicros() - sim.start_us) / AUDIO_FRAME_US;
+}
+
+static bool audioPending() {
+    return framesArrived() > sim.frames_read + sim.frames_dropped;
+}
+
+static void readAudio() {
+    sim.last_cycle = 'a';
+    uint64_t arrived = framesArrived();
+    uint64_t pending = arrived - sim.frames_read - sim.frames_dropped;
+    if (pending > AUDIO_RING_FRAMES) {
+        sim.frames_dropped += pending - AUDIO_RING_FRAMES;
+    }
+
+    // Oldest frame still in the ring
+    uint64_t oldest = sim.frames_read + sim.frames_dropped;
+    uint64_t arrival_us = sim.start_us + (oldest + 1) * AUDIO_FRAME_US;
+    uint64_t latency_us = monotonicMicros() - arrival_us;
+    if (latency_us > sim.max_latency_us) sim.max_latency_us = latency_us;
+
+    while (sim.frames_read + sim.frames_dropped < arrived) {
+        VirtualDevice::advanceUs(AUDIO_READ_US);
+        sim.frames_read++;
+    }
+}
+
+static bool uploadPending() {
+    return sim.chunks_sent < PHOTO_CHUNKS;
+}
+
+static void uploadPhoto() {
+    if (sim.last_cycle == 'a') sim.photo_after_audio++;
+    sim.last_cycle = 'p';
+    do {
+        VirtualDevice::advanceUs(sim.chunk_cost_us);
+        sim.upload_cpu_us += sim.chunk_cost_us;
+        sim.chunks_sent++;
+    } while (!sim.one_chunk_per_run && uploadPending() && !cycleShouldYield());
+
+    if (!uploadPending()) sim.upload_done_us = monotonicMicros();
+}
+
+/**
+ * Run the loop for a while with the upload registered first (it wins ties)
+ * @return The upload cycle's statistics at the end
+ */
+static cycle_runtime_t runSimulation(const char* label, uint32_t chunk_cost_us, bool one_chunk_per_run,
+                                     uint32_t budget_us, uint32_t period_ms,
+                                     cycle_overrun_policy_t policy, uint64_t duration_us) {
+    sim = budget_sim_t();
+    sim.start_us = monotonicMicros();
+    sim.chunk_cost_us = chunk_cost_us;
+    sim.one_chunk_per_run = one_chunk_per_run;
+
+    cycle_config_t upload = {};
+    upload.name = "DataTransmission";
+    upload.mode = CYCLE_MODE_CONDITION;
+    upload.priority = CYCLE_PRIORITY_HIGH;
+    upload.condition = uploadPending;
+    upload.execute = uploadPhoto;
+    upload.enabled = true;
+    upload.budget_us = budget_us;
+    upload.budget_period_ms = period_ms;
+    upload.overrun_policy = policy;
+    int upload_id = registerCycle(upload);
+    int audio_id = registerConditionCycle("AudioCapture", audioPending, readAudio, CYCLE_PRIORITY_HIGH);
+    CHECK(upload_id >= 0 && audio_id >= 0);
+
+    while (monotonicMicros() - sim.start_us < duration_us) {
+        sim.last_cycle = 0;
+        updateCycles();
+        VirtualDevice::advanceUs(LOOP_DELAY_US);
+    }
+
+    cycle_runtime_t stats = *getCycleStats(upload_id);
+    printf("%-16s audio %4llu read %3llu dropped, max latency %6.1f ms | upload %3u/%u chunks%s, "
+           "%4.1f%% CPU, %u overruns, %u deferred\n",
+           label, (unsigned long long)sim.frames_read, (unsigned long long)sim.frames_dropped,
+           sim.max_latency_us / 1000.0, sim.chunks_sent, PHOTO_CHUNKS,
+           sim.upload_done_us ? "" : " (unfinished)",
+           100.0 * sim.upload_cpu_us / (monotonicMicros() - sim.start_us),
+           (unsigned)stats.overrun_count, (unsigned)stats.deferred_count);
+
+    CHECK(unregisterCycle(upload_id));
+    CHECK(unregisterCycle(audio_id));
+    return stats;
+}
+
+static void testUnbudgetedUploadStarvesAudio() {
+    runSimulation("no budget", 2000, false, 0, 0, CYCLE_OVERRUN_DEFER, 3000000);
+    CHECK(sim.upload_done_us != 0);
+    CHECK(sim.frames_dropped > 90);                 // The upload held the loop for a second
+}
+
+static void testSplitBudgetKeepsAudioDeadlines() {
+    // 4 ms per 10 ms: the upload gets 40% of the CPU, in slices
+    cycle_runtime_t stats = runSimulation("split 4ms/10ms", 2000, false, 4000, 10, CYCLE_OVERRUN_SPLIT, 4000000);
+    CHECK(sim.frames_dropped == 0);
+    CHECK(sim.max_latency_us < 20000);
+    CHECK(sim.upload_done_us != 0);
+    CHECK(sim.upload_done_us - sim.start_us < 3500000);   // 1 s of work at 40%
+    CHECK(stats.deferred_count > 0);
+}
+
+static void testDeferLimitsCpuShare() {
+    // One 6 ms chunk per run, budget 3 ms per 10 ms: the upload averages 30%
+    cycle_runtime_t stats = runSimulation("defer 3ms/10ms", 6000, true, 3000, 10, CYCLE_OVERRUN_DEFER, 2000000);
+    double share = (double)sim.upload_cpu_us / 2000000.0;
+    CHECK(share > 0.25 && share < 0.33);
+    CHECK(stats.overrun_count > 0);
+    CHECK(sim.frames_dropped == 0);
+    CHECK(sim.max_latency_us < 20000);
+}
+
+static void testDemoteRunsLast() {
+    // One 2 ms chunk per run, budget 1 ms per 10 ms: mostly out of budget,
+    // so it runs after audio instead of before it, but it still runs
+    cycle_runtime_t stats = runSimulation("demote 1ms/10ms", 2000, true, 1000, 10, CYCLE_OVERRUN_DEMOTE, 2500000);
+    CHECK(stats.deferred_count > 0);
+    CHECK(sim.photo_after_audio > 0);
+    CHECK(sim.upload_done_us != 0);
+    CHECK(sim.frames_dropped == 0);
+}
+
+static void testAdmission() {
+    CHECK(getCycleUtilizationPpm() == 0);
+
+    cycle_config_t config = {};
+    config.name = "budgeted";
+    config.mode = CYCLE_MODE_INTERVAL;
+    config.interval_ms = 50;
+    config.execute = []() {};
+    config.enabled = true;
+    config.budget_us = 10000;                       // 20% of its 50 ms interval
+
+    int ids[3];
+    for (int i = 0; i < 3; i++) {
+        ids[i] = registerCycle(config);
+        CHECK(ids[i] >= 0);
+    }
+    CHECK(getCycleUtilizationPpm() == 600000);
+    CHECK(registerCycle(config) < 0);               // 80% > 69%
+
+    // Unbudgeted cycles are always admitted
+    int free_id = registerIntervalCycle("unbudgeted", 10, []() {});
+    CHECK(free_id >= 0);
+    CHECK(!setCycleBudget(free_id, 1000, 10));      // +10%
+    CHECK(setCycleBudget(free_id, 900, 100));       // +0.9%
+    CHECK(getCycleUtilizationPpm() == 609000);
+
+    // Shrinking an existing budget is checked without its old share
+    CHECK(setCycleBudget(ids[0], 5000, 0));
+    CHECK(getCycleUtilizationPpm() == 509000);
+
+    CHECK(unregisterCycle(ids[1]));
+    CHECK(registerCycle(config) >= 0);              // Room again
+
+    for (size_t slot = 0; slot < MAX_CYCLES; slot++) {
+        if (cycles[slot].registered) {
+            unregisterCycle(((int)cycles[slot].generation << 8) | (int)slot);
+        }
+    }
+    CHECK(getCycleUtilizationPpm() == 0);
+    CHECK(cycle_count == 0);
+}
+
+int main() {
+    VirtualDevice::setConsole(nullptr);
+    initializeCycleManager();
+
+    testUnbudgetedUploadStarvesAudio();
+    testSplitBudgetKeepsAudioDeadlines();
+    testDeferLimitsCpuShare();
+    testDemoteRunsLast();
+    testAdmission();
+
+    return finishChecks("cycle budget");
+}
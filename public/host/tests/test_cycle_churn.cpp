@@ -0,0 +1,298 @@
+#include "virtual_device.h"
+#include "system/clock/timing.h"
+#include "system/cycles/cycle_manager.h"
+#include "check.h"
+#include <stdio.h>
+#include <vector>
+#include <algorithm>
+
+// ===================================================================
+// CYCLE CHURN TEST
+// ===================================================================
+//
+// Registers and unregisters cycles at random (fixed seed) while the
+// manager runs, as features that come and go would, and checks after
+// every pass that:
+//
+//   - stale IDs never reach a cycle registered later in the same slot
+//   - a callback only runs while its own registration is alive
+//   - each pass runs cycles by priority, then registration order
+//   - disabled and paused cycles are never visited (not even their
+//     condition), and the active count matches
+//   - cycles can unregister themselves and register others mid-pass
+//
+
+static uint32_t rngState = 0x2545F491;
+
+static uint32_t nextRandom() {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+/**
+ * What the test expects of one registration
+ */
+typedef struct {
+    int id;
+    int priority;
+    uint32_t order;             // Registration order
+    bool alive;
+    bool enabled;
+    bool paused;
+    bool self_unregister;       // Unregisters itself on its next run
+    uint32_t runs;
+    uint32_t condition_calls;
+} registration_t;
+
+static std::vector<registration_t> registrations;
+static std::vector<int> staleIds;
+static std::vector<size_t> passOrder;          // Registrations run this pass
+static uint32_t registrationOrder = 0;
+static uint32_t lateRegistrations = 0;
+
+static size_t liveCount() {
+    size_t count = 0;
+    for (size_t i = 0; i < registrations.size(); i++) {
+        if (registrations[i].alive) count++;
+    }
+    return count;
+}
+
+static size_t runnableCount() {
+    size_t count = 0;
+    for (size_t i = 0; i < registrations.size(); i++) {
+        const registration_t& r = registrations[i];
+        if (r.alive && r.enabled && !r.paused) count++;
+    }
+    return count;
+}
+
+static void removeRegistration(size_t token) {
+    registrations[token].alive = false;
+    staleIds.push_back(registrations[token].id);
+}
+
+static int addCycle(int priority, bool enabled);
+
+static void runCycle(size_t token) {
+    registration_t& r = registrations[token];
+    CHECK(r.alive);
+    CHECK(r.enabled && !r.paused);
+    r.runs++;
+    passOrder.push_back(token);
+
+    if (r.self_unregister) {
+        int id = r.id;
+        CHECK(unregisterCycle(id));
+        removeRegistration(token);
+        CHECK(getCycle(id) == nullptr);
+        CHECK(!unregisterCycle(id));
+
+        // Register a replacement from inside the pass; it runs from the next pass
+        if (liveCount() < MAX_CYCLES - 1) {
+            addCycle(nextRandom() % 5, true);
+            lateRegistrations++;
+        }
+    }
+}
+
+static int addCycle(int priority, bool enabled) {
+    size_t token = registrations.size();
+    registration_t r = {};
+    r.priority = priority;
+    r.order = registrationOrder++;
+    r.enabled = enabled;
+    r.self_unregister = nextRandom() % 8 == 0;
+
+    cycle_config_t config = {};
+    config.name = "churn";
+    config.mode = CYCLE_MODE_CONDITION;
+    config.priority = (cycle_priority_t)priority;
+    config.condition = [token]() {
+        registrations[token].condition_calls++;
+        return true;
+    };
+    config.execute = [token]() { runCycle(token); };
+    config.enabled = enabled;
+
+    r.id = registerCycle(config);
+    r.alive = r.id >= 0;
+    registrations.push_back(r);
+    return r.id;
+}
+
+static bool passOrdered() {
+    for (size_t i = 1; i < passOrder.size(); i++) {
+        const registration_t& a = registrations[passOrder[i - 1]];
+        const registration_t& b = registrations[passOrder[i]];
+        if (a.priority > b.priority) return false;
+        if (a.priority == b.priority && a.order > b.order) return false;
+    }
+    return true;
+}
+
+static size_t randomLive() {
+    size_t live = liveCount();
+    if (live == 0) return SIZE_MAX;
+    size_t pick = nextRandom() % live;
+    for (size_t i = 0; i < registrations.size(); i++) {
+        if (!registrations[i].alive) continue;
+        if (pick-- == 0) return i;
+    }
+    return SIZE_MAX;
+}
+
+static void testChurn() {
+    const int PASSES = 20000;
+    uint32_t unregistered = 0;
+    uint32_t staleRejected = 0;
+    bool ordered = true;
+
+    for (int pass = 0; pass < PASSES; pass++) {
+        // A few random operations per pass
+        int operations = 1 + nextRandom() % 3;
+        for (int op = 0; op < operations; op++) {
+            uint32_t action = nextRandom() % 10;
+            size_t token = randomLive();
+
+            if (action < 4) {
+                bool full = liveCount() >= MAX_CYCLES;
+                int id = addCycle(nextRandom() % 5, nextRandom() % 4 != 0);
+                CHECK(full ? id < 0 : id >= 0);
+                if (id < 0) registrations.pop_back();
+            } else if (action < 7 && token != SIZE_MAX) {
+                CHECK(unregisterCycle(registrations[token].id));
+                removeRegistration(token);
+                unregistered++;
+            } else if (action == 7 && token != SIZE_MAX) {
+                registration_t& r = registrations[token];
+                r.enabled = !r.enabled;
+                setCycleEnabled(r.id, r.enabled);
+                if (!r.enabled) r.paused = false;     // Disabling leaves nothing paused
+            } else if (action == 8 && token != SIZE_MAX) {
+                registration_t& r = registrations[token];
+                bool pause = !r.paused;
+                setCyclePaused(r.id, pause);
+                if (pause || r.enabled) r.paused = pause;   // Resuming a disabled cycle does nothing
+            } else if (!staleIds.empty()) {
+                int stale = staleIds[nextRandom() % staleIds.size()];
+                CHECK(getCycle(stale) == nullptr);
+                CHECK(getCycleStats(stale) == nullptr);
+                CHECK(!unregisterCycle(stale));
+                setCycleEnabled(stale, false);         // Must not touch the slot's new owner
+                setCyclePaused(stale, true);
+                staleRejected++;
+            }
+        }
+
+        CHECK(cycle_count == liveCount());
+        CHECK(getActiveCycleCount() == runnableCount());
+
+        // Exactly the cycles runnable before the pass run in it, once each
+        std::vector<size_t> runnable;
+        for (size_t i = 0; i < registrations.size(); i++) {
+            const registration_t& r = registrations[i];
+            if (r.alive && r.enabled && !r.paused) runnable.push_back(i);
+        }
+
+        passOrder.clear();
+        VirtualDevice::advanceUs(1000);
+        updateCycles();
+        if (!passOrdered()) ordered = false;
+
+        std::vector<size_t> ran(passOrder);
+        std::sort(ran.begin(), ran.end());
+        CHECK(ran == runnable);
+    }
+
+    // Conditions always hold: a visit that did not run means a disabled or paused cycle was visited
+    size_t inconsistent = 0;
+    for (size_t i = 0; i < registrations.size(); i++) {
+        if (registrations[i].condition_calls != registrations[i].runs) inconsistent++;
+    }
+
+    printf("%d passes: %u registrations, %u unregistered, %u stale IDs rejected, %u registered mid-pass\n",
+           PASSES, (unsigned)registrations.size(), unregistered, staleRejected, lateRegistrations);
+    CHECK(ordered);
+    CHECK(inconsistent == 0);
+    CHECK(unregistered > 1000);
+    CHECK(staleRejected > 1000);
+    CHECK(lateRegistrations > 100);
+
+    // Clean up
+    for (size_t i = 0; i < registrations.size(); i++) {
+        if (registrations[i].alive) {
+            CHECK(unregisterCycle(registrations[i].id));
+            removeRegistration(i);
+        }
+    }
+    CHECK(cycle_count == 0);
+    CHECK(getActiveCycleCount() == 0);
+}
+
+static void testDisabledCostNothing() {
+    // A full table of disabled cycles: their conditions are never evaluated
+    registrations.clear();
+    for (int i = 0; i < MAX_CYCLES; i++) {
+        CHECK(addCycle(i % 5, false) >= 0);
+        registrations.back().self_unregister = false;
+    }
+    CHECK(addCycle(0, true) < 0);
+    registrations.pop_back();
+
+    for (int pass = 0; pass < 100; pass++) {
+        VirtualDevice::advanceUs(1000);
+        updateCycles();
+    }
+    CHECK(getActiveCycleCount() == 0);
+    for (size_t i = 0; i < registrations.size(); i++) {
+        CHECK(registrations[i].condition_calls == 0);
+    }
+
+    // Enabling one visits only that one
+    registrations[7].enabled = true;
+    setCycleEnabled(registrations[7].id, true);
+    VirtualDevice::advanceUs(1000);
+    updateCycles();
+    CHECK(getActiveCycleCount() == 1);
+    CHECK(registrations[7].runs == 1);
+    CHECK(registrations[6].condition_calls == 0);
+
+    for (size_t i = 0; i < registrations.size(); i++) {
+        CHECK(unregisterCycle(registrations[i].id));
+    }
+    CHECK(cycle_count == 0);
+}
+
+static void testSlotReuseResetsState() {
+    // A reused slot starts with clean statistics and a fresh schedule
+    int first = registerIntervalCycle("first", 10, []() {});
+    for (int i = 0; i < 50; i++) {
+        VirtualDevice::advanceUs(10000);
+        updateCycles();
+    }
+    CHECK(getCycleStats(first)->execution_count == 50);
+    CHECK(unregisterCycle(first));
+
+    int second = registerIntervalCycle("second", 1000, []() {});
+    CHECK(CYCLE_ID_SLOT(second) == CYCLE_ID_SLOT(first));
+    CHECK(second != first);
+    const cycle_runtime_t* stats = getCycleStats(second);
+    CHECK(stats != nullptr);
+    CHECK(stats->execution_count == 0);
+    CHECK(stats->next_execution_us == monotonicMicros() + 1000000ULL);
+    CHECK(unregisterCycle(second));
+}
+
+int main() {
+    VirtualDevice::setConsole(nullptr);
+    initializeCycleManager();
+
+    testChurn();
+    testDisabledCostNothing();
+    testSlotReuseResetsState();
+
+    return finishChecks("cycle churn");
+}
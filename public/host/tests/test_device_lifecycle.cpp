@@ -0,0 +1,377 @@
+#include "virtual_device.h"
+#include "status/device_lifecycle.h"
+#include "system/state_machine/hsm.h"
+#include "system/cycles/cycle_manager.h"
+#include "features/camera/camera.h"
+#include "check.h"
+#include <stdio.h>
+#include <string>
+
+// ===================================================================
+// DEVICE LIFECYCLE TEST
+// ===================================================================
+//
+// The state machine framework on a small machine (entry/exit order
+// across nesting levels, superstate fallback, guards, deferred and
+// posted events, table validation), then the device lifecycle against
+// a specification written out here: every leaf state times every event,
+// with and without an interval session.
+//
+
+// ===================================================================
+// FRAMEWORK
+// ===================================================================
+
+enum { S_OFF, S_ON, S_DIM, S_LIT, S_WARM, S_COOL, S_COUNT };
+enum { E_SWITCH, E_BUTTON, E_TOGGLE, E_SELF, E_CHAIN, E_GUARDED, E_COUNT };
+
+static std::string trace;
+
+static void enterOn(int32_t) { trace += "+ON"; }
+static void exitOn(int32_t) { trace += "-ON"; }
+static void enterOff(int32_t) { trace += "+OFF"; }
+static void exitOff(int32_t) { trace += "-OFF"; }
+static void enterDim(int32_t) { trace += "+DIM"; }
+static void exitDim(int32_t) { trace += "-DIM"; }
+static void enterLit(int32_t) { trace += "+LIT"; }
+static void exitLit(int32_t) { trace += "-LIT"; }
+static void enterWarm(int32_t) { trace += "+WARM"; }
+static void exitWarm(int32_t) { trace += "-WARM"; }
+static void enterCool(int32_t) { trace += "+COOL"; }
+static void exitCool(int32_t) { trace += "-COOL"; }
+static void mark(int32_t) { trace += "*"; }
+static bool argPositive(int32_t arg) { return arg > 0; }
+static void chain(int32_t);
+
+static const hsm_state_t TOY_STATES[S_COUNT] = {
+    {"OFF",  HSM_NO_STATE, enterOff,  exitOff},
+    {"ON",   HSM_NO_STATE, enterOn,   exitOn},
+    {"DIM",  S_ON,         enterDim,  exitDim},
+    {"LIT",  S_ON,         enterLit,  exitLit},
+    {"WARM", S_LIT,        enterWarm, exitWarm},
+    {"COOL", S_LIT,        enterCool, exitCool},
+};
+
+#define UP HSM_UNHANDLED_CELL
+static const hsm_transition_t TOY_TRANSITIONS[S_COUNT][E_COUNT] = {
+    //          SWITCH            BUTTON         TOGGLE         SELF                 CHAIN               GUARDED
+    /* OFF */  {hsmGo(S_DIM),     UP,            UP,            UP,                  UP,                 UP},
+    /* ON */   {hsmGo(S_OFF),     UP,            UP,            UP,                  UP,                 UP},
+    /* DIM */  {UP,               hsmGo(S_WARM), UP,            UP,                  hsmInternal(chain), UP},
+    /* LIT */  {UP,               hsmGo(S_DIM),  UP,            UP,                  UP,                 UP},
+    /* WARM */ {UP,               UP,            hsmGo(S_COOL), hsmGo(S_WARM, mark), UP,
+                hsmChoose(argPositive, S_COOL, HSM_NO_STATE)},
+    /* COOL */ {HSM_IGNORED_CELL, UP,            hsmGo(S_WARM), UP,                  UP,                 UP},
+};
+
+// A superstate as a target
+static const hsm_transition_t BAD_TRANSITIONS[S_COUNT][E_COUNT] = {
+    /* OFF */  {hsmGo(S_LIT), UP, UP, UP, UP, UP},
+    /* ON */   {UP, UP, UP, UP, UP, UP},
+    /* DIM */  {UP, UP, UP, UP, UP, UP},
+    /* LIT */  {UP, UP, UP, UP, UP, UP},
+    /* WARM */ {UP, UP, UP, UP, UP, UP},
+    /* COOL */ {UP, UP, UP, UP, UP, UP},
+};
+#undef UP
+
+static HierarchicalStateMachine<S_COUNT, E_COUNT, 4> toy(TOY_STATES, TOY_TRANSITIONS, S_OFF);
+
+static void chain(int32_t) {
+    trace += "*";
+    CHECK(!toy.dispatch(E_BUTTON));                 // Runs after this event completes
+    CHECK(toy.getState() == S_DIM);
+}
+
+static bool step(uint8_t event, const char* expected_trace, int32_t arg = 0) {
+    trace.clear();
+    bool handled = toy.dispatch(event, arg);
+    if (trace != expected_trace) {
+        fprintf(stderr, "trace \"%s\", expected \"%s\"\n", trace.c_str(), expected_trace);
+        failures++;
+    }
+    return handled;
+}
+
+static void testFramework() {
+    CHECK(toy.validate());
+    CHECK(toy.getState() == S_OFF);
+    CHECK(toy.isLeaf(S_WARM) && !toy.isLeaf(S_LIT) && !toy.isLeaf(S_ON));
+
+    CHECK(step(E_SWITCH, "-OFF+ON+DIM"));
+    CHECK(toy.isIn(S_DIM) && toy.isIn(S_ON) && !toy.isIn(S_LIT) && !toy.isIn(S_OFF));
+
+    // Down a level: exits to ON, enters LIT then WARM
+    CHECK(step(E_BUTTON, "-DIM+LIT+WARM"));
+    CHECK(toy.isIn(S_WARM) && toy.isIn(S_LIT) && toy.isIn(S_ON));
+
+    CHECK(step(E_TOGGLE, "-WARM+COOL"));
+    CHECK(step(E_TOGGLE, "-COOL+WARM"));
+
+    // Self-transition: exit, action, entry
+    CHECK(step(E_SELF, "-WARM*+WARM"));
+
+    // Guard: argument 0 ignores, 1 transitions
+    CHECK(!step(E_GUARDED, "", 0));
+    CHECK(toy.getState() == S_WARM);
+    CHECK(step(E_GUARDED, "-WARM+COOL", 1));
+
+    // COOL ignores SWITCH outright instead of falling back to ON
+    CHECK(!step(E_SWITCH, ""));
+    CHECK(toy.getState() == S_COOL);
+
+    // BUTTON from LIT, SWITCH from ON
+    CHECK(step(E_BUTTON, "-COOL-LIT+DIM"));
+    CHECK(toy.getTransition(S_WARM, E_BUTTON) == &TOY_TRANSITIONS[S_LIT][E_BUTTON]);
+    CHECK(toy.getTransition(S_OFF, E_BUTTON) == nullptr);
+
+    // An event dispatched by an action runs once the first has completed
+    CHECK(step(E_CHAIN, "*-DIM+LIT+WARM"));
+    CHECK(toy.getState() == S_WARM);
+    CHECK(toy.getStats()->deferred == 1);
+
+    CHECK(step(E_SWITCH, "-WARM-LIT-ON+OFF"));
+    CHECK(!step(E_BUTTON, ""));                     // Nobody handles it
+    CHECK(!toy.dispatch(E_COUNT));                  // Out of range
+
+    // Posted events run in order; the queue holds 4
+    toy.resetStats();
+    CHECK(toy.post(E_SWITCH));
+    CHECK(toy.post(E_BUTTON));
+    CHECK(toy.post(E_TOGGLE));
+    CHECK(toy.post(E_TOGGLE));
+    CHECK(!toy.post(E_TOGGLE));
+    CHECK(toy.getStats()->dropped == 1);
+    CHECK(toy.pending() == 4);
+    trace.clear();
+    CHECK(toy.process() == 4);
+    CHECK(trace == "-OFF+ON+DIM-DIM+LIT+WARM-WARM+COOL-COOL+WARM");
+    CHECK(toy.getState() == S_WARM);
+    CHECK(toy.getStats()->handled == 4);
+
+    toy.reset();
+    CHECK(toy.getState() == S_OFF);
+
+    HierarchicalStateMachine<S_COUNT, E_COUNT, 4> bad(TOY_STATES, BAD_TRANSITIONS, S_OFF);
+    CHECK(!bad.validate());
+    HierarchicalStateMachine<S_COUNT, E_COUNT, 4> badInitial(TOY_STATES, TOY_TRANSITIONS, S_ON);
+    CHECK(!badInitial.validate());
+}
+
+// ===================================================================
+// DEVICE LIFECYCLE
+// ===================================================================
+
+static const lifecycle_state_t LEAVES[] = {
+    LIFECYCLE_BOOT, LIFECYCLE_IDLE, LIFECYCLE_CAPTURING, LIFECYCLE_UPLOADING,
+    LIFECYCLE_STREAMING, LIFECYCLE_SLEEPING,
+};
+static const size_t LEAF_COUNT = sizeof(LEAVES) / sizeof(LEAVES[0]);
+
+static const int INTERVAL_MS = 5000;
+
+// Written out from the design, not from the firmware's table. SAME stays
+// put (ignored), INTERNAL stays put but runs an action
+#define B LIFECYCLE_BOOT
+#define I LIFECYCLE_IDLE
+#define C LIFECYCLE_CAPTURING
+#define U LIFECYCLE_UPLOADING
+#define V LIFECYCLE_STREAMING
+#define Z LIFECYCLE_SLEEPING
+#define SAME LIFECYCLE_STATE_COUNT
+#define INTERNAL ((lifecycle_state_t)(LIFECYCLE_STATE_COUNT + 1))
+
+// With an interval session (captureInterval > 0 in CAPTURING and UPLOADING)
+static const lifecycle_state_t SPEC[LEAF_COUNT][LIFECYCLE_EVENT_COUNT] = {
+    //          BOOT_DONE SINGLE    INTERVAL  RESUME  STOP      CAPTURED UP_DONE UP_SKIP DISCONN V_START V_STOP SLEEP WAKE
+    /* BOOT */  {I,       SAME,     SAME,     SAME,   SAME,     SAME,    SAME,   SAME,   SAME,   SAME,   SAME,  SAME, SAME},
+    /* IDLE */  {SAME,    C,        C,        C,      SAME,     SAME,    SAME,   SAME,   SAME,   V,      SAME,  Z,    SAME},
+    /* CAPT */  {SAME,    INTERNAL, INTERNAL, SAME,   I,        U,       SAME,   SAME,   SAME,   V,      SAME,  SAME, SAME},
+    /* UPLD */  {SAME,    SAME,     SAME,     SAME,   INTERNAL, SAME,    C,      C,      C,      SAME,   SAME,  SAME, SAME},
+    /* STRM */  {SAME,    SAME,     SAME,     SAME,   SAME,     SAME,    SAME,   SAME,   SAME,   SAME,   I,     SAME, SAME},
+    /* SLEP */  {SAME,    SAME,     SAME,     SAME,   SAME,     SAME,    SAME,   SAME,   SAME,   SAME,   SAME,  SAME, I},
+};
+
+#undef B
+#undef I
+#undef C
+#undef U
+#undef V
+#undef Z
+
+/**
+ * Expected result without an interval session: a single shot's upload
+ * ends in IDLE, and RESUME has nothing to resume
+ */
+static lifecycle_state_t expected(size_t leaf, lifecycle_event_t event, bool interval) {
+    lifecycle_state_t state = LEAVES[leaf];
+    if (!interval && state == LIFECYCLE_UPLOADING &&
+        (event == LIFECYCLE_EVENT_UPLOAD_DONE || event == LIFECYCLE_EVENT_UPLOAD_SKIP ||
+         event == LIFECYCLE_EVENT_DISCONNECTED)) {
+        return LIFECYCLE_IDLE;
+    }
+    if (!interval && state == LIFECYCLE_IDLE && event == LIFECYCLE_EVENT_PHOTO_RESUME) {
+        return SAME;
+    }
+    return SPEC[leaf][event];
+}
+
+/**
+ * From BOOT to state through the events the firmware would see
+ */
+static void driveTo(lifecycle_state_t state, bool interval) {
+    DeviceLifecycle::reset();
+    captureInterval = 0;
+    if (state == LIFECYCLE_BOOT) return;
+
+    DeviceLifecycle::dispatch(LIFECYCLE_EVENT_BOOT_DONE);
+    switch (state) {
+        case LIFECYCLE_CAPTURING:
+        case LIFECYCLE_UPLOADING:
+            if (interval) {
+                DeviceLifecycle::dispatch(LIFECYCLE_EVENT_PHOTO_INTERVAL, INTERVAL_MS);
+            } else {
+                DeviceLifecycle::dispatch(LIFECYCLE_EVENT_PHOTO_SINGLE);
+            }
+            if (state == LIFECYCLE_UPLOADING) {
+                DeviceLifecycle::dispatch(LIFECYCLE_EVENT_PHOTO_CAPTURED);
+            }
+            break;
+        case LIFECYCLE_STREAMING:
+            DeviceLifecycle::dispatch(LIFECYCLE_EVENT_VIDEO_START);
+            break;
+        case LIFECYCLE_SLEEPING:
+            DeviceLifecycle::dispatch(LIFECYCLE_EVENT_SLEEP);
+            break;
+        default:
+            break;
+    }
+}
+
+static void testLifecycleExhaustive() {
+    CHECK(DeviceLifecycle::validate());
+
+    size_t runs = 0;
+    for (int interval = 0; interval <= 1; interval++) {
+        for (size_t leaf = 0; leaf < LEAF_COUNT; leaf++) {
+            for (int e = 0; e < LIFECYCLE_EVENT_COUNT; e++) {
+                lifecycle_event_t event = (lifecycle_event_t)e;
+                lifecycle_state_t from = LEAVES[leaf];
+                driveTo(from, interval);
+                if (DeviceLifecycle::getState() != from) {
+                    fprintf(stderr, "could not reach %s\n", DeviceLifecycle::getStateName(from));
+                    failures++;
+                    continue;
+                }
+
+                // Interval restores set the session up before RESUME
+                if (event == LIFECYCLE_EVENT_PHOTO_RESUME && interval) captureInterval = INTERVAL_MS;
+                int32_t arg = event == LIFECYCLE_EVENT_PHOTO_INTERVAL ? INTERVAL_MS : 0;
+
+                bool handled = DeviceLifecycle::dispatch(event, arg);
+                lifecycle_state_t want = expected(leaf, event, interval);
+                lifecycle_state_t state = DeviceLifecycle::getState();
+
+                bool matches;
+                if (want == SAME) {
+                    matches = state == from && !handled;
+                } else if (want == INTERNAL) {
+                    matches = state == from && handled;
+                } else {
+                    matches = state == want && handled;
+                }
+                if (!matches) {
+                    fprintf(stderr, "%s in %s (%s interval): now %s, handled %d\n",
+                            DeviceLifecycle::getEventName(event), DeviceLifecycle::getStateName(from),
+                            interval ? "with" : "without", DeviceLifecycle::getStateName(state), handled);
+                    failures++;
+                }
+
+                // Invariants the entry and exit actions keep
+                if (!DeviceLifecycle::isIn(LIFECYCLE_PHOTO) && event != LIFECYCLE_EVENT_PHOTO_RESUME) {
+                    CHECK(captureInterval == 0);
+                }
+                if (!DeviceLifecycle::isIn(LIFECYCLE_UPLOADING)) {
+                    CHECK(fb == nullptr && sent_photo_bytes == 0 && sent_photo_frames == 0);
+                }
+                CHECK(DeviceLifecycle::isReady() == (state != LIFECYCLE_BOOT));
+                runs++;
+            }
+        }
+    }
+    CHECK(runs == 2 * LEAF_COUNT * LIFECYCLE_EVENT_COUNT);
+
+    // The firmware's table, read back, agrees with the specification
+    // (guards not evaluated: the interval column)
+    for (size_t leaf = 0; leaf < LEAF_COUNT; leaf++) {
+        for (int e = 0; e < LIFECYCLE_EVENT_COUNT; e++) {
+            lifecycle_state_t target = DeviceLifecycle::getTarget(LEAVES[leaf], (lifecycle_event_t)e);
+            lifecycle_state_t want = SPEC[leaf][e];
+            if (want == INTERNAL) want = LEAVES[leaf];
+            CHECK(target == want);
+        }
+    }
+}
+
+static void testLifecycleHierarchy() {
+    driveTo(LIFECYCLE_UPLOADING, true);
+    CHECK(DeviceLifecycle::isIn(LIFECYCLE_UPLOADING));
+    CHECK(DeviceLifecycle::isIn(LIFECYCLE_PHOTO));
+    CHECK(DeviceLifecycle::isIn(LIFECYCLE_RUNNING));
+    CHECK(!DeviceLifecycle::isIn(LIFECYCLE_CAPTURING));
+    CHECK(!DeviceLifecycle::isIn(LIFECYCLE_STREAMING));
+
+    // Stop during an upload: the upload finishes, then the session ends
+    CHECK(DeviceLifecycle::dispatch(LIFECYCLE_EVENT_PHOTO_STOP));
+    CHECK(DeviceLifecycle::isIn(LIFECYCLE_UPLOADING) && captureInterval == 0);
+    CHECK(DeviceLifecycle::dispatch(LIFECYCLE_EVENT_UPLOAD_DONE));
+    CHECK(DeviceLifecycle::getState() == LIFECYCLE_IDLE);
+
+    // Video takes over an armed interval session and ends it
+    driveTo(LIFECYCLE_CAPTURING, true);
+    CHECK(captureInterval == INTERVAL_MS);
+    CHECK(DeviceLifecycle::dispatch(LIFECYCLE_EVENT_VIDEO_START));
+    CHECK(DeviceLifecycle::isIn(LIFECYCLE_STREAMING) && captureInterval == 0);
+    CHECK(!DeviceLifecycle::dispatch(LIFECYCLE_EVENT_PHOTO_SINGLE));
+}
+
+static void testLifecycleCycle() {
+    initializeCycleManager();
+    DeviceLifecycle::begin();
+    driveTo(LIFECYCLE_IDLE, false);
+
+    int id = DeviceLifecycle::getCycleId();
+    CHECK(id >= 0);
+    CHECK(getCycle(id)->config.mode == CYCLE_MODE_STATE_MACHINE);
+
+    // Nothing posted: the cycle does not run
+    updateCycles();
+    CHECK(getCycleStats(id)->execution_count == 0);
+
+    // A control write from the BLE task lands on the next pass
+    CHECK(DeviceLifecycle::post(LIFECYCLE_EVENT_PHOTO_INTERVAL, INTERVAL_MS));
+    CHECK(DeviceLifecycle::getState() == LIFECYCLE_IDLE);
+    updateCycles();
+    CHECK(getCycleStats(id)->execution_count == 1);
+    CHECK(DeviceLifecycle::getState() == LIFECYCLE_CAPTURING);
+
+    // The queue holds LIFECYCLE_EVENT_QUEUE_SIZE
+    for (int i = 0; i < LIFECYCLE_EVENT_QUEUE_SIZE; i++) {
+        CHECK(DeviceLifecycle::post(LIFECYCLE_EVENT_PHOTO_SINGLE));
+    }
+    CHECK(!DeviceLifecycle::post(LIFECYCLE_EVENT_PHOTO_STOP));
+    CHECK(DeviceLifecycle::process() == LIFECYCLE_EVENT_QUEUE_SIZE);
+    CHECK(DeviceLifecycle::isIn(LIFECYCLE_CAPTURING) && captureInterval == 0);
+    CHECK(DeviceLifecycle::getStats()->dropped == 1);
+}
+
+int main() {
+    VirtualDevice::setConsole(nullptr);
+
+    testFramework();
+    testLifecycleExhaustive();
+    testLifecycleHierarchy();
+    testLifecycleCycle();
+
+    return finishChecks("device lifecycle");
+}
@@ -0,0 +1,95 @@
+#include "virtual_device.h"
+#include "features/bluetooth/services/ble_services.h"
+#include "features/camera/camera.h"
+#include "system/power_management/duty_cycle_capture.h"
+#include "status/device_lifecycle.h"
+#include "check.h"
+#include <LittleFS.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ===================================================================
+// DUTY-CYCLED CAPTURE TEST
+// ===================================================================
+//
+// The sketch built with duty-cycled capture: a batch is stored across
+// capture-only wakes, then the battery runs flat. RTC memory is gone
+// after the power-on reset, so the batch is found from the files in
+// flash, uploaded once a client connects, and the next batch does not
+// write over it.
+//
+
+/**
+ * Sleep for one interval, then boot from the timer wake
+ * @return true if the device went back to sleep during setup()
+ */
+static bool timerWake() {
+    VirtualDevice::wakeFromSleep(ESP_SLEEP_WAKEUP_TIMER, (uint64_t)DUTY_CYCLE_MIN_INTERVAL_S * 1000000ULL);
+    return VirtualDevice::runSketch(true, 0);
+}
+
+static bool stored(uint32_t seq) {
+    char path[24];
+    snprintf(path, sizeof(path), "/dc_%08lu.jpg", (unsigned long)seq);
+    return LittleFS.exists(path);
+}
+
+static uint32_t photoPackets() {
+    for (size_t i = 0; i < VirtualDevice::streamCount(); i++) {
+        const VirtualDevice::stream_stats_t* s = VirtualDevice::streamStats(i);
+        if (strcmp(VirtualDevice::streamName(s->uuid), "photo") == 0) return s->packets;
+    }
+    return 0;
+}
+
+static void arm() {
+    VirtualDevice::connect();
+    uint8_t interval = DUTY_CYCLE_MIN_INTERVAL_S;
+    CHECK(VirtualDevice::writeCharacteristic(PHOTO_CONTROL_UUID, &interval, 1));
+    CHECK(VirtualDevice::runSketch(false, 20000000));
+}
+
+static void testPowerLoss() {
+    CHECK(!VirtualDevice::runSketch(true, 0));
+    arm();
+    for (int wake = 0; wake < 3; wake++) {
+        CHECK(timerWake());
+    }
+    CHECK(DutyCycleCapture::getStoredPhotoCount() == 3);
+    CHECK(stored(0) && stored(1) && stored(2));
+
+    // Flat battery: only the files are left. The host process keeps the
+    // rest of RAM, so the photo session is dropped here
+    VirtualDevice::powerOnReset();
+    DeviceLifecycle::reset();
+    captureInterval = 0;
+    CHECK(!VirtualDevice::runSketch(true, 0));
+    CHECK(DutyCycleCapture::getStoredPhotoCount() == 3);
+    CHECK(DutyCycleCapture::isFlushPending());
+
+    uint32_t packets = photoPackets();
+    VirtualDevice::connect();
+    CHECK(!VirtualDevice::runSketch(false, 20000000));
+    CHECK(DutyCycleCapture::getStoredPhotoCount() == 0 && !DutyCycleCapture::isFlushPending());
+    CHECK(!stored(0) && !stored(1) && !stored(2));
+    CHECK(photoPackets() > packets);
+
+    // The next batch carries on from the sequence numbers found
+    arm();
+    CHECK(timerWake());
+    CHECK(DutyCycleCapture::getStoredPhotoCount() == 1);
+    CHECK(stored(3) && !stored(0));
+}
+
+int main() {
+    VirtualDevice::setConsole(nullptr);
+    char fsDir[] = "/tmp/test_duty_cycle_XXXXXX";
+    CHECK(mkdtemp(fsDir) != nullptr);
+    VirtualDevice::setFsRoot(fsDir);
+    CHECK(VirtualDevice::loadJpegDir(SAMPLES_DIR) > 0);
+
+    testPowerLoss();
+
+    return finishChecks("duty cycle");
+}
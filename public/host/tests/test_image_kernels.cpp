@@ -0,0 +1,156 @@
+#include "virtual_device.h"
+#include "features/camera/image_kernels.h"
+#include "check.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+// ===================================================================
+// IMAGE KERNELS TEST
+// ===================================================================
+//
+// Each image kernel on hand-checked inputs, then the build's vector
+// versions against the scalar ones on random images of every width from
+// 1 to 80 (so each vector loop runs with every tail length) with padded
+// rows, including all-black and all-white images for the edges of the
+// arithmetic.
+//
+
+static std::vector<uint8_t> randomBytes(size_t length, uint8_t fill) {
+    std::vector<uint8_t> bytes(length, fill);
+    if (fill == 0x55) {
+        for (size_t i = 0; i < length; i++) bytes[i] = (uint8_t)rand();
+    }
+    return bytes;
+}
+
+static void testKnownValues() {
+    // SAD of a block against itself plus one
+    std::vector<uint8_t> a(32 * 16, 10), b(32 * 16, 11);
+    CHECK(imageSad16(&a[0], &b[0], 32) == 256);
+    CHECK(imageSad16Scalar(&a[0], &b[0], 32) == 256);
+    b[5 * 32 + 7] = 0;
+    CHECK(imageSad16(&a[0], &b[0], 32) == 255 + 10);
+
+    // 2x2 means, rounded half up; the odd column and row are dropped
+    const uint8_t square[3 * 5] = {
+        0, 1, 10, 20, 99,
+        1, 1, 30, 41, 99,
+        99, 99, 99, 99, 99,
+    };
+    uint8_t half[2] = {0, 0};
+    imageDownscale2x(square, 5, 5, 3, half, 2);
+    CHECK(half[0] == 1 && half[1] == 25);
+
+    // White, black, pure red, green and blue
+    const uint8_t rgb565[5 * 2] = {0xFF, 0xFF, 0x00, 0x00, 0xF8, 0x00, 0x07, 0xE0, 0x00, 0x1F};
+    uint8_t gray[5];
+    imageRgb565ToGray(rgb565, 5, gray);
+    CHECK(gray[0] == 255 && gray[1] == 0);
+    CHECK(gray[2] == 77 && gray[3] == 149 && gray[4] == 29);
+
+    // YUV422: the Y bytes, whatever the chroma
+    const uint8_t yuv[3 * 2] = {10, 0, 200, 255, 99, 128};
+    imageYuv422ToGray(yuv, 3, gray);
+    CHECK(gray[0] == 10 && gray[1] == 200 && gray[2] == 99);
+
+    // Histogram adds to what is there
+    uint32_t histogram[256];
+    memset(histogram, 0, sizeof(histogram));
+    histogram[3] = 5;
+    imageHistogram(square, 5, 5, 2, histogram);
+    CHECK(histogram[3] == 5 && histogram[1] == 3 && histogram[99] == 2 && histogram[0] == 1);
+
+    // One bright pixel: its own Laplacian and its four neighbours'
+    std::vector<uint8_t> dot(7 * 7, 0);
+    dot[3 * 7 + 3] = 255;
+    CHECK(imageSharpness(&dot[0], 7, 7, 7) == 1020ULL * 1020 + 4 * 255 * 255);
+    std::vector<uint8_t> flat(40 * 40, 200);
+    CHECK(imageSharpness(&flat[0], 40, 40, 40) == 0);
+    CHECK(imageSharpness(&flat[0], 40, 2, 40) == 0);
+
+    // The same dot in each direction: the pixel and its two neighbours on that line
+    uint64_t energy[4];
+    imageDirectionalSharpness(&dot[0], 7, 7, 7, energy);
+    for (int k = 0; k < 4; k++) CHECK(energy[k] == 510ULL * 510 + 2 * 255 * 255);
+
+    // Vertical stripes: flat along the vertical only
+    std::vector<uint8_t> stripes(16 * 16);
+    for (size_t i = 0; i < stripes.size(); i++) stripes[i] = (i % 16) & 1 ? 100 : 0;
+    imageDirectionalSharpness(&stripes[0], 16, 16, 16, energy);
+    CHECK(energy[1] == 0);
+    CHECK(energy[0] == 14ULL * 14 * 200 * 200 && energy[2] == energy[0] && energy[3] == energy[0]);
+}
+
+static void testAgainstScalar() {
+    srand(11);
+    const uint8_t fills[] = {0x55, 0x00, 0xFF};      // Random, black, white
+    for (size_t f = 0; f < sizeof(fills); f++) {
+        for (uint16_t width = 1; width <= 80; width++) {
+            uint16_t height = (uint16_t)(3 + width % 5);
+            size_t stride = width + 13;
+            std::vector<uint8_t> image = randomBytes(stride * height, fills[f]);
+
+            std::vector<uint8_t> fast(stride * height, 0xAA), slow(stride * height, 0xAA);
+            imageDownscale2x(&image[0], stride, width, height, &fast[0], stride);
+            imageDownscale2xScalar(&image[0], stride, width, height, &slow[0], stride);
+            CHECK(fast == slow);
+
+            std::vector<uint8_t> rgb565 = randomBytes((size_t)width * 2, fills[f]);
+            std::vector<uint8_t> grayFast(width + 1, 0xAA), graySlow(width + 1, 0xAA);
+            imageRgb565ToGray(&rgb565[0], width, &grayFast[0]);
+            imageRgb565ToGrayScalar(&rgb565[0], width, &graySlow[0]);
+            CHECK(grayFast == graySlow);
+            std::fill(grayFast.begin(), grayFast.end(), 0xAA);
+            std::fill(graySlow.begin(), graySlow.end(), 0xAA);
+            imageYuv422ToGray(&rgb565[0], width, &grayFast[0]);
+            imageYuv422ToGrayScalar(&rgb565[0], width, &graySlow[0]);
+            CHECK(grayFast == graySlow);
+
+            uint32_t histogramFast[256], histogramSlow[256];
+            memset(histogramFast, 0, sizeof(histogramFast));
+            memset(histogramSlow, 0, sizeof(histogramSlow));
+            imageHistogram(&image[0], stride, width, height, histogramFast);
+            imageHistogramScalar(&image[0], stride, width, height, histogramSlow);
+            CHECK(memcmp(histogramFast, histogramSlow, sizeof(histogramFast)) == 0);
+
+            CHECK(imageSharpness(&image[0], stride, width, height) ==
+                  imageSharpnessScalar(&image[0], stride, width, height));
+
+            uint64_t energyFast[4], energySlow[4];
+            imageDirectionalSharpness(&image[0], stride, width, height, energyFast);
+            imageDirectionalSharpnessScalar(&image[0], stride, width, height, energySlow);
+            CHECK(memcmp(energyFast, energySlow, sizeof(energyFast)) == 0);
+        }
+
+        std::vector<uint8_t> a = randomBytes(48 * 20, fills[f]), b = randomBytes(48 * 20, 0x55);
+        for (size_t offset = 0; offset < 32; offset++) {
+            CHECK(imageSad16(&a[offset], &b[offset], 48) == imageSad16Scalar(&a[offset], &b[offset], 48));
+        }
+    }
+
+    // A VGA frame: sums large enough to need the 64-bit total
+    std::vector<uint8_t> vga(640 * 480);
+    for (size_t i = 0; i < vga.size(); i++) vga[i] = (i + i / 640) & 1 ? 255 : 0;
+    uint64_t checkerboard = imageSharpness(&vga[0], 640, 640, 480);
+    CHECK(checkerboard == imageSharpnessScalar(&vga[0], 640, 640, 480));
+    CHECK(checkerboard == 638ULL * 478 * 1020 * 1020);
+    uint64_t energyFast[4], energySlow[4];
+    imageDirectionalSharpness(&vga[0], 640, 640, 480, energyFast);
+    imageDirectionalSharpnessScalar(&vga[0], 640, 640, 480, energySlow);
+    CHECK(memcmp(energyFast, energySlow, sizeof(energyFast)) == 0);
+    CHECK(energyFast[0] == 638ULL * 478 * 510 * 510 && energyFast[2] == 0);
+}
+
+int main() {
+    VirtualDevice::setConsole(nullptr);
+
+    testKnownValues();
+    testAgainstScalar();
+
+    char name[48];
+    snprintf(name, sizeof(name), "image kernels (%s)", imageKernelsBackend());
+    return finishChecks(name);
+}
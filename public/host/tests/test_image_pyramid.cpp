@@ -0,0 +1,107 @@
+#include "virtual_device.h"
+#include "features/camera/image_pyramid.h"
+#include "features/camera/image_kernels.h"
+#include "check.h"
+#include <img_converters.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+// ===================================================================
+// IMAGE PYRAMID TEST
+// ===================================================================
+//
+// Every level against repeated imageDownscale2x, for grayscale and YUV422
+// frames at even, odd and not-multiple-of-8 sizes; storage size and the
+// too-small cases; imagePyramidFit; and the host fmt2jpg the pyramid
+// photo encodes with.
+//
+
+static bool sameLevel(const image_level_t& level, const std::vector<uint8_t>& expected, size_t width, size_t height) {
+    if (level.width != width || level.height != height) return false;
+    for (size_t y = 0; y < height; y++) {
+        if (memcmp(level.pixels + y * level.stride, &expected[y * width], width) != 0) return false;
+    }
+    return true;
+}
+
+static void testLevels(uint16_t width, uint16_t height) {
+    std::vector<uint8_t> frame((size_t)width * height), yuv((size_t)width * height * 2);
+    VirtualDevice::renderDeskScene(&frame[0], width, height, width + height);
+    for (size_t i = 0; i < frame.size(); i++) {
+        yuv[2 * i] = frame[i];
+        yuv[2 * i + 1] = (uint8_t)(i * 37);    // Chroma must not leak into the luma
+    }
+
+    // The reference: halve, halve again, halve again
+    std::vector<uint8_t> expected[IMAGE_PYRAMID_LEVELS];
+    expected[0] = frame;
+    for (int k = 1; k < IMAGE_PYRAMID_LEVELS; k++) {
+        size_t w = width >> (k - 1), h = height >> (k - 1);
+        expected[k].resize((w / 2) * (h / 2));
+        imageDownscale2xScalar(&expected[k - 1][0], w, (uint16_t)w, (uint16_t)h, &expected[k][0], w / 2);
+    }
+
+    for (int format = 0; format < 2; format++) {
+        bool yuv422 = format == 1;
+        size_t size = imagePyramidSize(width, height, yuv422);
+        size_t levels = 0;
+        for (int k = 1; k < IMAGE_PYRAMID_LEVELS; k++) levels += (size_t)(width >> k) * (height >> k);
+        CHECK(size == levels + (yuv422 ? (size_t)width * height : 0));
+
+        std::vector<uint8_t> storage(size + 1, 0xA5);
+        image_pyramid_t pyramid;
+        const uint8_t* source = yuv422 ? &yuv[0] : &frame[0];
+        CHECK(imagePyramidBuild(source, width, height, yuv422, &storage[0], size, &pyramid));
+        for (int k = 0; k < IMAGE_PYRAMID_LEVELS; k++) {
+            CHECK(sameLevel(pyramid.level[k], expected[k], width >> k, height >> k));
+        }
+        CHECK(yuv422 ? pyramid.level[0].pixels == &storage[0] : pyramid.level[0].pixels == &frame[0]);
+        CHECK(storage[size] == 0xA5);    // Nothing past the end
+
+        CHECK(!imagePyramidBuild(source, width, height, yuv422, &storage[0], size - 1, &pyramid));
+    }
+}
+
+static void testFit() {
+    std::vector<uint8_t> frame(640 * 480), storage(imagePyramidSize(640, 480, false));
+    VirtualDevice::renderDeskScene(&frame[0], 640, 480, 0);
+    image_pyramid_t pyramid;
+    CHECK(imagePyramidBuild(&frame[0], 640, 480, false, &storage[0], storage.size(), &pyramid));
+    CHECK(imagePyramidFit(pyramid, 640 * 480) == 0);
+    CHECK(imagePyramidFit(pyramid, 640 * 480 - 1) == 1);
+    CHECK(imagePyramidFit(pyramid, 200 * 150) == 2);
+    CHECK(imagePyramidFit(pyramid, 80 * 60) == 3);
+    CHECK(imagePyramidFit(pyramid, 1) == 3);
+
+    // Too small for three halvings
+    uint8_t tiny[7 * 16];
+    memset(tiny, 0, sizeof(tiny));
+    uint8_t room[64];
+    CHECK(!imagePyramidBuild(tiny, 7, 16, false, room, sizeof(room), &pyramid));
+    CHECK(!imagePyramidBuild(tiny, 16, 7, false, room, sizeof(room), &pyramid));
+}
+
+static void testEncode() {
+    std::vector<uint8_t> frame(160 * 120);
+    VirtualDevice::renderDeskScene(&frame[0], 160, 120, 1);
+    uint8_t* jpeg = nullptr;
+    size_t length = 0;
+    CHECK(fmt2jpg(&frame[0], frame.size(), 160, 120, PIXFORMAT_GRAYSCALE, 80, &jpeg, &length));
+    CHECK(jpeg && length > 600 && jpeg[0] == 0xFF && jpeg[1] == 0xD8 && jpeg[length - 1] == 0xD9);
+    free(jpeg);
+    CHECK(!fmt2jpg(&frame[0], frame.size() - 1, 160, 120, PIXFORMAT_GRAYSCALE, 80, &jpeg, &length));
+    CHECK(!fmt2jpg(&frame[0], frame.size(), 80, 120, PIXFORMAT_RGB565, 80, &jpeg, &length));
+}
+
+int main() {
+    VirtualDevice::setConsole(nullptr);
+    testLevels(640, 480);
+    testLevels(320, 240);
+    testLevels(100, 75);       // Not a multiple of 8: rows and columns dropped on the way
+    testLevels(17, 9);
+    testFit();
+    testEncode();
+    return finishChecks("image pyramid");
+}
@@ -0,0 +1,236 @@
+#include "virtual_device.h"
+#include "stream_reassembly.h"
+#include "features/bluetooth/ble_frame_format.h"
+#include "features/camera/jpeg_header.h"
+#include "check.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+// ===================================================================
+// JPEG HEADER TEST
+// ===================================================================
+//
+// Header parsing on well-formed and broken JPEGs, when JpegHeaderCompactor
+// sends an image whole or compact (first image, new tables, new stream,
+// refresh), read() at every offset and size, and the client side: compact
+// images rebuilt byte for byte, or reported incomplete while the header
+// is unknown.
+//
+
+static void appendSegment(std::vector<uint8_t>& jpeg, uint8_t marker, size_t payload, uint8_t fill) {
+    jpeg.push_back(0xFF);
+    jpeg.push_back(marker);
+    jpeg.push_back((uint8_t)((payload + 2) >> 8));
+    jpeg.push_back((uint8_t)(payload + 2));
+    for (size_t i = 0; i < payload; i++) jpeg.push_back((uint8_t)(fill + i));
+}
+
+/**
+ * SOI, APP0, DQT (quality-dependent), SOF0, DHT, SOS, entropy data, EOI
+ * @param headerLength Set to the length up to the end of SOS
+ */
+static std::vector<uint8_t> makeJpeg(uint8_t quality, size_t entropy, uint8_t seed, size_t* headerLength) {
+    std::vector<uint8_t> jpeg;
+    jpeg.push_back(0xFF);
+    jpeg.push_back(0xD8);
+    appendSegment(jpeg, 0xE0, 14, 0x10);
+    appendSegment(jpeg, 0xDB, 65, quality);
+    appendSegment(jpeg, 0xC0, 15, 0x20);
+    appendSegment(jpeg, 0xC4, 179, 0x30);
+    appendSegment(jpeg, 0xDA, 10, 0x40);
+    if (headerLength) *headerLength = jpeg.size();
+    for (size_t i = 0; i < entropy; i++) {
+        uint8_t byte = (uint8_t)(seed * 31 + i * 7);
+        jpeg.push_back(byte);
+        if (byte == 0xFF) jpeg.push_back(0x00);     // Stuffing
+    }
+    jpeg.push_back(0xFF);
+    jpeg.push_back(0xD9);
+    return jpeg;
+}
+
+/**
+ * The wire bytes of the planned image, read in pieces of at most step
+ */
+static std::vector<uint8_t> readAll(const JpegHeaderCompactor& compactor, const std::vector<uint8_t>& jpeg,
+                                    size_t step) {
+    std::vector<uint8_t> wire;
+    std::vector<uint8_t> piece(step);
+    size_t total = compactor.length(jpeg.size());
+    while (wire.size() < total) {
+        size_t n = compactor.read(&jpeg[0], jpeg.size(), wire.size(), &piece[0], step);
+        if (n == 0) break;
+        wire.insert(wire.end(), piece.begin(), piece.begin() + n);
+    }
+    return wire;
+}
+
+static void testHeaderLength() {
+    size_t header = 0;
+    std::vector<uint8_t> jpeg = makeJpeg(10, 500, 1, &header);
+    CHECK(jpegHeaderLength(&jpeg[0], jpeg.size()) == header);
+    CHECK(jpegHeaderLength(&jpeg[0], header) == header);
+    CHECK(jpegHeaderLength(&jpeg[0], header - 1) == 0);
+    CHECK(jpegHeaderLength(nullptr, 100) == 0);
+
+    // Not a JPEG
+    std::vector<uint8_t> broken = jpeg;
+    broken[1] = 0xD9;
+    CHECK(jpegHeaderLength(&broken[0], broken.size()) == 0);
+
+    // Segment too short to hold its length
+    broken = jpeg;
+    broken[4] = 0x00;
+    broken[5] = 0x01;
+    CHECK(jpegHeaderLength(&broken[0], broken.size()) == 0);
+
+    // Garbage where a marker should be
+    broken = jpeg;
+    broken[2] = 0x12;
+    CHECK(jpegHeaderLength(&broken[0], broken.size()) == 0);
+
+    // Restart marker before SOS
+    broken = jpeg;
+    broken[3] = 0xD0;
+    CHECK(jpegHeaderLength(&broken[0], broken.size()) == 0);
+
+    // Fill bytes before a marker are part of the header
+    std::vector<uint8_t> filled = jpeg;
+    filled.insert(filled.begin() + 2, 0xFF);
+    CHECK(jpegHeaderLength(&filled[0], filled.size()) == header + 1);
+
+    // The ID follows the tables
+    std::vector<uint8_t> other = makeJpeg(25, 500, 1, nullptr);
+    CHECK(jpegHeaderId(&jpeg[0], header) == jpegHeaderId(&makeJpeg(10, 900, 7, nullptr)[0], header));
+    CHECK(jpegHeaderId(&jpeg[0], header) != jpegHeaderId(&other[0], header));
+}
+
+static void testCompactor() {
+    size_t header = 0;
+    std::vector<uint8_t> a = makeJpeg(10, 700, 1, &header);
+    std::vector<uint8_t> b = makeJpeg(10, 650, 2, nullptr);
+    std::vector<uint8_t> requality = makeJpeg(25, 600, 3, nullptr);
+    uint32_t id = jpegHeaderId(&a[0], header);
+
+    // Before any plan(): pass-through
+    JpegHeaderCompactor compactor;
+    CHECK(!compactor.isCompact());
+    CHECK(compactor.length(a.size()) == a.size());
+    CHECK(readAll(compactor, a, 400) == a);
+
+    // First image of a stream goes whole, the next one compact
+    CHECK(!compactor.plan(&a[0], a.size(), 1));
+    CHECK(readAll(compactor, a, 400) == a);
+    CHECK(compactor.plan(&b[0], b.size(), 1));
+    CHECK(compactor.length(b.size()) == b.size() - header + BLE_JPEG_COMPACT_PREFIX_SIZE);
+
+    // Wire bytes: prefix, then everything after the header, at any step
+    std::vector<uint8_t> expected(BLE_JPEG_COMPACT_PREFIX_SIZE);
+    bleWriteJpegCompactPrefix(&expected[0], id);
+    expected.insert(expected.end(), b.begin() + header, b.end());
+    for (size_t step = 1; step <= 16; step++) {
+        CHECK(readAll(compactor, b, step) == expected);
+    }
+    CHECK(readAll(compactor, b, 400) == expected);
+    uint8_t out[8];
+    CHECK(compactor.read(&b[0], b.size(), compactor.length(b.size()), out, sizeof(out)) == 0);
+    CHECK(bleIsJpegCompact(&expected[0], expected.size()));
+    CHECK(bleJpegCompactId(&expected[0]) == id);
+
+    // New tables, new stream: whole again
+    CHECK(!compactor.plan(&requality[0], requality.size(), 1));
+    CHECK(compactor.plan(&requality[0], requality.size(), 1));
+    CHECK(!compactor.plan(&requality[0], requality.size(), 2));
+    CHECK(compactor.plan(&requality[0], requality.size(), 2));
+
+    // Something that is not a JPEG passes through, and the next image is whole
+    std::vector<uint8_t> raw(300, 0x55);
+    CHECK(!compactor.plan(&raw[0], raw.size(), 2));
+    CHECK(readAll(compactor, raw, 64) == raw);
+    CHECK(!compactor.plan(&requality[0], requality.size(), 2));
+
+    // reset(): whole
+    compactor.reset();
+    CHECK(!compactor.plan(&requality[0], requality.size(), 2));
+
+    const jpeg_compaction_stats_t& s = compactor.stats();
+    CHECK(s.images == 9);
+    CHECK(s.compacted == 3);
+    CHECK(s.headers == 5);
+    CHECK(s.bytes_saved == 3 * (header - BLE_JPEG_COMPACT_PREFIX_SIZE));
+
+    // Refresh: one whole image, then three compact
+    JpegHeaderCompactor refreshing(3);
+    for (int i = 0; i < 12; i++) {
+        CHECK(refreshing.plan(&a[0], a.size(), 1) == (i % 4 != 0));
+    }
+}
+
+typedef struct {
+    std::vector<std::vector<uint8_t> > images;
+    std::vector<bool> complete;
+} received_t;
+
+static void collect(void* ctx, uint32_t number, const uint8_t* data, size_t length, bool complete) {
+    (void)number;
+    received_t* received = (received_t*)ctx;
+    received->images.push_back(std::vector<uint8_t>(data, data + length));
+    received->complete.push_back(complete);
+}
+
+static void send(ImageReassembler& reassembler, const JpegHeaderCompactor& compactor, const std::vector<uint8_t>& jpeg,
+                 bool dropFirstChunk) {
+    uint8_t packet[BLE_FRAME_HEADER_SIZE + 100];
+    size_t total = compactor.length(jpeg.size());
+    uint16_t index = 0;
+    for (size_t sent = 0; sent < total; index++) {
+        bleWriteFrameHeader(packet, index, BLE_FRAME_TYPE_VIDEO);
+        size_t n = compactor.read(&jpeg[0], jpeg.size(), sent, &packet[BLE_FRAME_HEADER_SIZE], 100);
+        if (!(dropFirstChunk && index == 0)) reassembler.push(packet, BLE_FRAME_HEADER_SIZE + n);
+        sent += n;
+    }
+    bleWriteEndMarker(packet, BLE_FRAME_TYPE_VIDEO);
+    reassembler.push(packet, BLE_FRAME_HEADER_SIZE);
+}
+
+static void testClient() {
+    std::vector<std::vector<uint8_t> > frames;
+    for (uint8_t i = 0; i < 6; i++) frames.push_back(makeJpeg(i < 3 ? 25 : 30, 400 + i * 37, i, nullptr));
+
+    JpegHeaderCompactor compactor;
+    ImageReassembler reassembler(BLE_FRAME_TYPE_VIDEO);
+    received_t received;
+    reassembler.setCallback(collect, &received);
+
+    // The header of frame 0 never arrives: frames 1 and 2 cannot be rebuilt.
+    // Frame 3 brings new tables, 4 and 5 use them
+    for (size_t i = 0; i < frames.size(); i++) {
+        compactor.plan(&frames[i][0], frames[i].size(), 1);
+        send(reassembler, compactor, frames[i], i == 0);
+    }
+
+    CHECK(received.images.size() == frames.size());
+    CHECK(!received.complete[0] && !received.complete[1] && !received.complete[2]);
+    CHECK(bleIsJpegCompact(&received.images[1][0], received.images[1].size()));
+    for (size_t i = 3; i < frames.size() && i < received.images.size(); i++) {
+        CHECK(received.complete[i]);
+        CHECK(received.images[i] == frames[i]);
+    }
+
+    const image_stream_stats_t& s = reassembler.stats();
+    CHECK(s.compacted == 2);
+    CHECK(s.unknown_tables == 2);
+    CHECK(s.complete == 3);
+    CHECK(s.bytes > s.wire_bytes);
+}
+
+int main() {
+    VirtualDevice::setConsole(nullptr);
+
+    testHeaderLength();
+    testCompactor();
+    testClient();
+
+    return finishChecks("jpeg header");
+}
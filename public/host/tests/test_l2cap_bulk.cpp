@@ -0,0 +1,284 @@
+#include "virtual_device.h"
+#include "l2cap_bulk.h"
+#include "features/bluetooth/ble_frame_format.h"
+#include "hal/constants.h"
+#include "check.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+// ===================================================================
+// L2CAP BULK TEST
+// ===================================================================
+//
+// The bulk channel's K-frame segmentation and credit flow control, with
+// the device's sender and a client's receiver on either end of a socket
+// pair (one PDU per packet): SDUs of every awkward length arrive intact,
+// the sender stops when the credits run out and resumes when they come
+// back, and the receiver closes the channel on each protocol error. Then
+// the sample photo as the firmware frames it, for the header overhead
+// against photo notifications.
+//
+
+static const uint16_t DEVICE_CID = 0x0040;     // The client's CID the device sends to
+static const uint16_t MPS = 247;               // 251-byte LL payload less the L2CAP header
+
+/**
+ * Device and client ends of a socket pair, each running its half of the channel
+ */
+class Link {
+public:
+    Link(uint16_t mtu, uint16_t credits) : buffer(mtu), pdu(l2capMaxPdu(MPS)), identifier(1), errors(0) {
+        fd[0] = fd[1] = -1;
+        bool paired = socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fd) == 0;
+        CHECK(paired);
+        for (int i = 0; i < 2 && paired; i++) fcntl(fd[i], F_SETFL, fcntl(fd[i], F_GETFL) | O_NONBLOCK);
+        CHECK(sender.open(DEVICE_CID, mtu, MPS, credits));
+        CHECK(receiver.open(DEVICE_CID, mtu, MPS, credits, &buffer[0]));
+    }
+
+    ~Link() {
+        for (int i = 0; i < 2; i++) {
+            if (fd[i] >= 0) close(fd[i]);
+        }
+    }
+
+    /** Device: K-frames out while credits last. @return PDUs sent */
+    size_t deviceSend() {
+        size_t sent = 0, length;
+        while ((length = sender.nextPdu(&pdu[0], pdu.size())) > 0) {
+            CHECK(send(fd[0], &pdu[0], length, 0) == (ssize_t)length);
+            sent++;
+        }
+        return sent;
+    }
+
+    /** Device: credit packets in */
+    void deviceReceive() {
+        ssize_t length;
+        while ((length = recv(fd[0], &pdu[0], pdu.size(), 0)) > 0) sender.receive(&pdu[0], (size_t)length);
+    }
+
+    /** Client: K-frames in, complete SDUs kept, credits back when due */
+    void clientReceive() {
+        ssize_t length;
+        while ((length = recv(fd[1], &pdu[0], pdu.size(), 0)) > 0) {
+            int result = receiver.receive(&pdu[0], (size_t)length);
+            if (result == L2capBulkReceiver::RECEIVE_ERROR) errors++;
+            if (result == L2capBulkReceiver::RECEIVE_SDU) {
+                sdus.push_back(std::vector<uint8_t>(receiver.sdu(), receiver.sdu() + receiver.sduLength()));
+            }
+            uint8_t credit[L2CAP_CREDIT_PDU_SIZE];
+            size_t creditLength = receiver.creditPdu(credit, identifier++);
+            if (creditLength) CHECK(send(fd[1], credit, creditLength, 0) == (ssize_t)creditLength);
+        }
+    }
+
+    /** Send every SDU through, the way the upload cycle would */
+    void transfer(const std::vector<std::vector<uint8_t> >& data) {
+        for (size_t i = 0; i < data.size(); i++) {
+            int passes = 0;
+            while (!sender.write(data[i].empty() ? nullptr : &data[i][0], data[i].size()) && passes++ < 1000) {
+                deviceSend();
+                clientReceive();
+                deviceReceive();
+            }
+        }
+        for (int passes = 0; sender.busy() && passes < 1000; passes++) {
+            deviceSend();
+            clientReceive();
+            deviceReceive();
+        }
+        clientReceive();
+    }
+
+    int fd[2];
+    L2capBulkSender sender;
+    L2capBulkReceiver receiver;
+    std::vector<uint8_t> buffer;
+    std::vector<uint8_t> pdu;
+    std::vector<std::vector<uint8_t> > sdus;
+    uint8_t identifier;
+    int errors;
+};
+
+static void testLengths() {
+    // Around each K-frame boundary, the empty SDU and the MTU itself
+    const uint16_t mtu = 2048;
+    const size_t lengths[] = {0, 1, MPS - 3, MPS - 2, MPS - 1, MPS, 2 * MPS - 2, 2 * MPS - 1, 1000, mtu - 1, mtu};
+    std::vector<std::vector<uint8_t> > data;
+    size_t frames = 0;
+    for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+        std::vector<uint8_t> sdu(lengths[i]);
+        for (size_t j = 0; j < sdu.size(); j++) sdu[j] = (uint8_t)(j * 7 + i);
+        data.push_back(sdu);
+        frames += l2capSduFrames(lengths[i], MPS);
+    }
+    CHECK(l2capSduFrames(0, MPS) == 1 && l2capSduFrames(MPS - 2, MPS) == 1 && l2capSduFrames(MPS - 1, MPS) == 2);
+
+    // Four credits: most SDUs wait for credits part way through
+    Link link(mtu, 4);
+    link.transfer(data);
+    CHECK(link.errors == 0);
+    CHECK(link.sdus == data);
+    CHECK(link.sender.sdusSent() == data.size());
+    CHECK(link.sender.pdusSent() == frames);
+    CHECK(link.receiver.credits() == 4 && link.sender.credits() == 4);    // All handed back
+
+    // Over the MTU, or while the last SDU is still going out
+    std::vector<uint8_t> big(mtu + 1);
+    CHECK(!link.sender.write(&big[0], big.size()));
+    CHECK(link.sender.write(&big[0], 600));
+    CHECK(!link.sender.write(&big[0], 1));
+}
+
+static void testCredits() {
+    Link link(2048, 2);
+    std::vector<uint8_t> sdu(5 * MPS - 2 - 10);    // Five K-frames
+    for (size_t i = 0; i < sdu.size(); i++) sdu[i] = (uint8_t)i;
+    CHECK(l2capSduFrames(sdu.size(), MPS) == 5);
+    CHECK(link.sender.write(&sdu[0], sdu.size()));
+
+    // Two credits, two K-frames, then nothing until the client has read them
+    CHECK(link.deviceSend() == 2);
+    CHECK(link.sender.stalled() && link.sender.credits() == 0);
+    CHECK(link.deviceSend() == 0);
+    link.deviceReceive();
+    CHECK(link.sender.stalled());
+
+    link.clientReceive();
+    CHECK(link.receiver.credits() == 2);   // One back after each K-frame (half of two)
+    link.deviceReceive();
+    CHECK(!link.sender.stalled() && link.sender.credits() == 2);
+    CHECK(link.deviceSend() == 2);
+    link.clientReceive();
+    link.deviceReceive();
+    CHECK(link.deviceSend() == 1);
+    CHECK(!link.sender.busy());
+    link.clientReceive();
+    CHECK(link.sdus.size() == 1 && link.sdus[0] == sdu);
+
+    // Credits past 65535 close the channel
+    uint8_t credit[L2CAP_CREDIT_PDU_SIZE];
+    l2capWriteCredit(credit, 9, DEVICE_CID, L2CAP_MAX_CREDITS);
+    CHECK(!link.sender.receive(credit, sizeof(credit)));
+    CHECK(!link.sender.isOpen());
+
+    // Credits for another channel are not ours
+    L2capBulkSender other;
+    CHECK(other.open(DEVICE_CID + 1, 2048, MPS, 0));
+    l2capWriteCredit(credit, 10, DEVICE_CID, 5);
+    CHECK(other.receive(credit, sizeof(credit)) && other.credits() == 0);
+}
+
+static void testProtocolErrors() {
+    uint8_t buffer[100];
+    uint8_t pdu[L2CAP_HEADER_SIZE + L2CAP_SDU_LENGTH_SIZE + 64];
+    L2capBulkReceiver receiver;
+
+    // [length, cid] + payload, payload starting with the SDU length
+    struct Case {
+        uint16_t mtu, mps, credits;
+        uint16_t payload;       // K-frame payload length (SDU length included)
+        uint16_t sduLength;
+        bool ok;
+    } cases[] = {
+        {100, 64, 1, 12, 10, true},     // The whole SDU
+        {100, 64, 0, 12, 10, false},    // No credit for it
+        {100, 23, 1, 25, 23, false},    // Over the MPS
+        {30, 64, 2, 12, 31, false},     // SDU over the MTU
+        {100, 64, 1, 12, 5, false},     // More than the SDU length
+        {100, 64, 1, 1, 0, false},      // No room for the SDU length
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        const Case& c = cases[i];
+        CHECK(receiver.open(DEVICE_CID, c.mtu, c.mps, c.credits, buffer));
+        memset(pdu, 0, sizeof(pdu));
+        pdu[0] = c.payload & 0xFF;
+        pdu[1] = c.payload >> 8;
+        pdu[2] = DEVICE_CID & 0xFF;
+        pdu[3] = DEVICE_CID >> 8;
+        pdu[4] = c.sduLength & 0xFF;
+        pdu[5] = c.sduLength >> 8;
+        int result = receiver.receive(pdu, L2CAP_HEADER_SIZE + c.payload);
+        CHECK(result == (c.ok ? L2capBulkReceiver::RECEIVE_SDU : L2capBulkReceiver::RECEIVE_ERROR));
+        CHECK(receiver.isOpen() == c.ok);
+    }
+
+    // A length field that disagrees with the packet
+    CHECK(receiver.open(DEVICE_CID, 100, 64, 4, buffer));
+    pdu[0] = 20;
+    CHECK(receiver.receive(pdu, L2CAP_HEADER_SIZE + 12) == L2capBulkReceiver::RECEIVE_ERROR);
+
+    // Another channel's K-frame is left alone
+    CHECK(receiver.open(DEVICE_CID + 1, 100, 64, 4, buffer));
+    pdu[0] = 12;
+    CHECK(receiver.receive(pdu, L2CAP_HEADER_SIZE + 12) == L2capBulkReceiver::RECEIVE_MORE);
+    CHECK(receiver.isOpen() && receiver.credits() == 4);
+
+    // Below the spec's minimum MTU / MPS
+    L2capBulkSender sender;
+    CHECK(!sender.open(DEVICE_CID, L2CAP_MIN_MTU - 1, MPS, 1));
+    CHECK(!sender.open(DEVICE_CID, 100, L2CAP_MIN_MTU - 1, 1));
+    CHECK(!receiver.open(DEVICE_CID, 100, 64, 1, nullptr));
+}
+
+// The sample photo framed as the upload cycle does: [index, type] + chunk, then the end marker
+static std::vector<std::vector<uint8_t> > photoFrames(const std::vector<uint8_t>& jpeg, size_t chunk) {
+    std::vector<std::vector<uint8_t> > frames;
+    uint16_t index = 0;
+    for (size_t offset = 0; offset < jpeg.size(); offset += chunk, index++) {
+        size_t length = jpeg.size() - offset < chunk ? jpeg.size() - offset : chunk;
+        std::vector<uint8_t> frame(BLE_FRAME_HEADER_SIZE + length);
+        bleWriteFrameHeader(&frame[0], index, BLE_FRAME_TYPE_PHOTO);
+        memcpy(&frame[BLE_FRAME_HEADER_SIZE], &jpeg[offset], length);
+        frames.push_back(frame);
+    }
+    std::vector<uint8_t> end(BLE_FRAME_HEADER_SIZE);
+    bleWriteEndMarker(&end[0], BLE_FRAME_TYPE_PHOTO);
+    frames.push_back(end);
+    return frames;
+}
+
+static void testSamplePhoto() {
+    std::vector<uint8_t> jpeg = readFile(SAMPLE_JPEG);
+    CHECK(!jpeg.empty());
+    if (jpeg.empty()) return;
+
+    std::vector<std::vector<uint8_t> > frames = photoFrames(jpeg, L2CAP_BULK_SDU_SIZE - BLE_FRAME_HEADER_SIZE);
+    Link link(L2CAP_BULK_SDU_SIZE, 8);
+    link.transfer(frames);
+    CHECK(link.errors == 0);
+    CHECK(link.sdus == frames);
+
+    std::vector<uint8_t> photo;
+    for (size_t i = 0; i + 1 < link.sdus.size(); i++) {
+        photo.insert(photo.end(), link.sdus[i].begin() + BLE_FRAME_HEADER_SIZE, link.sdus[i].end());
+    }
+    CHECK(photo == jpeg);
+    CHECK(bleIsEndMarker(&link.sdus.back()[0], link.sdus.back().size()));
+
+    // Header bytes above the link layer: L2CAP + ATT + frame header per notification,
+    // against L2CAP per K-frame + SDU length + frame header per SDU
+    size_t notifications = photoFrames(jpeg, PHOTO_CHUNK_SIZE).size();
+    size_t gattOverhead = notifications * (L2CAP_HEADER_SIZE + 3 + BLE_FRAME_HEADER_SIZE);
+    size_t cocOverhead = link.sender.pdusSent() * L2CAP_HEADER_SIZE +
+                         frames.size() * (L2CAP_SDU_LENGTH_SIZE + BLE_FRAME_HEADER_SIZE);
+    CHECK(cocOverhead < gattOverhead);
+    printf("l2cap bulk: %u-byte sample in %u SDUs / %u K-frames, %u header bytes (%u as %u notifications)\n",
+           (unsigned)jpeg.size(), (unsigned)frames.size(), (unsigned)link.sender.pdusSent(), (unsigned)cocOverhead,
+           (unsigned)gattOverhead, (unsigned)notifications);
+}
+
+int main() {
+    VirtualDevice::setConsole(nullptr);
+    testLengths();
+    testCredits();
+    testProtocolErrors();
+    testSamplePhoto();
+    return finishChecks("l2cap bulk");
+}
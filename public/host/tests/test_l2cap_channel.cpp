@@ -0,0 +1,300 @@
+#include "virtual_device.h"
+#include "features/bluetooth/l2cap_channel.h"
+#include "features/bluetooth/services/ble_services.h"
+#include "features/camera/camera.h"
+#include "system/power_management/duty_cycle_capture.h"
+#include "host/ble_hs.h"
+#include "host/ble_l2cap.h"
+#include "check.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// ===================================================================
+// L2CAP CHANNEL TEST
+// ===================================================================
+//
+// The shipped bulk channel (features/bluetooth/l2cap_channel.cpp, built
+// with L2CAP_BULK_CHANNEL) and the cycles that upload through it, over
+// a stand-in for NimBLE's channel calls below. The client runs out of
+// credits every few SDUs (BLE_HS_ESTALLED) and the host now and then
+// has no mbufs, so sendPhotoFrame() turns frames down. Every frame must
+// still arrive once and in order, and nothing may be sent while the
+// channel is stalled: first a live photo, then a duty-cycled batch read
+// back from flash.
+//
+
+static const uint16_t CLIENT_MTU = 512;        // SDU MTU: a dozen SDUs for a sample photo
+static const uint32_t STALL_EVERY = 4;         // Sends taken but out of credits
+static const uint32_t REFUSE_EVERY = 7;        // Sends turned down by the host
+static const uint32_t NO_MBUF_EVERY = 11;      // Allocations that fail
+
+static int channelToken;
+static struct ble_l2cap_chan* const CHANNEL = reinterpret_cast<struct ble_l2cap_chan*>(&channelToken);
+
+// ===================================================================
+// NIMBLE STAND-IN
+// ===================================================================
+
+static ble_l2cap_event_fn* server = nullptr;
+static uint16_t serverPsm = 0;
+static struct os_mbuf* receiveBuffer = nullptr;
+static int mbufsHeld = 0;
+static uint32_t allocations = 0;
+static uint32_t sends = 0;
+static bool stalled = false;
+static std::vector<std::vector<uint8_t>> sdus;     // Taken, in order
+
+struct os_mbuf* os_msys_get_pkthdr(uint16_t dsize, uint16_t user_hdr_len) {
+    (void)dsize;
+    (void)user_hdr_len;
+    if (++allocations % NO_MBUF_EVERY == 0) return nullptr;
+    struct os_mbuf* om = (struct os_mbuf*)calloc(1, sizeof(struct os_mbuf));
+    mbufsHeld++;
+    return om;
+}
+
+int os_mbuf_append(struct os_mbuf* om, const void* data, uint16_t len) {
+    uint8_t* grown = (uint8_t*)realloc(om->om_data, om->om_len + len);
+    if (!grown) return BLE_HS_ENOMEM;
+    memcpy(grown + om->om_len, data, len);
+    om->om_data = grown;
+    om->om_len += len;
+    return 0;
+}
+
+int os_mbuf_free_chain(struct os_mbuf* om) {
+    if (!om) return 0;
+    free(om->om_data);
+    free(om);
+    mbufsHeld--;
+    return 0;
+}
+
+int ble_l2cap_create_server(uint16_t psm, uint16_t mtu, ble_l2cap_event_fn* cb, void* cb_arg) {
+    (void)mtu;
+    (void)cb_arg;
+    server = cb;
+    serverPsm = psm;
+    return 0;
+}
+
+int ble_l2cap_recv_ready(struct ble_l2cap_chan* chan, struct os_mbuf* sdu_rx) {
+    CHECK(chan == CHANNEL);
+    os_mbuf_free_chain(receiveBuffer);
+    receiveBuffer = sdu_rx;
+    return 0;
+}
+
+int ble_l2cap_get_chan_info(struct ble_l2cap_chan* chan, struct ble_l2cap_chan_info* chan_info) {
+    CHECK(chan == CHANNEL);
+    memset(chan_info, 0, sizeof(*chan_info));
+    chan_info->psm = serverPsm;
+    chan_info->peer_l2cap_mtu = 247;
+    chan_info->peer_coc_mtu = CLIENT_MTU;
+    return 0;
+}
+
+int ble_l2cap_send(struct ble_l2cap_chan* chan, struct os_mbuf* sdu_tx) {
+    CHECK(chan == CHANNEL);
+    CHECK(!stalled);
+    if (++sends % REFUSE_EVERY == 0) return BLE_HS_ENOMEM;
+
+    sdus.push_back(std::vector<uint8_t>(sdu_tx->om_data, sdu_tx->om_data + sdu_tx->om_len));
+    os_mbuf_free_chain(sdu_tx);
+    if (sends % STALL_EVERY == 0) {
+        stalled = true;
+        return BLE_HS_ESTALLED;
+    }
+    return 0;
+}
+
+static int channelEvent(int type) {
+    struct ble_l2cap_event event;
+    memset(&event, 0, sizeof(event));
+    event.type = type;
+    switch (type) {
+        case BLE_L2CAP_EVENT_COC_ACCEPT:
+            event.accept.chan = CHANNEL;
+            event.accept.peer_sdu_size = CLIENT_MTU;
+            break;
+        case BLE_L2CAP_EVENT_COC_CONNECTED:
+            event.connect.chan = CHANNEL;
+            break;
+        case BLE_L2CAP_EVENT_COC_DISCONNECTED:
+            event.disconnect.chan = CHANNEL;
+            break;
+        case BLE_L2CAP_EVENT_COC_TX_UNSTALLED:
+            event.tx_unstalled.chan = CHANNEL;
+            break;
+    }
+    return server(&event, nullptr);
+}
+
+// ===================================================================
+// CLIENT
+// ===================================================================
+
+static std::vector<std::vector<uint8_t>> samples;
+
+static void loadSamples() {
+    DIR* d = opendir(SAMPLES_DIR);
+    if (!d) return;
+    while (struct dirent* entry = readdir(d)) {
+        size_t n = strlen(entry->d_name);
+        if (n > 4 && strcmp(entry->d_name + n - 4, ".jpg") == 0) {
+            samples.push_back(readFile((std::string(SAMPLES_DIR) + "/" + entry->d_name).c_str()));
+        }
+    }
+    closedir(d);
+}
+
+static void openChannel() {
+    int8_t command = PHOTO_BULK_CHANNEL;
+    CHECK(VirtualDevice::writeCharacteristic(PHOTO_CONTROL_UUID, (uint8_t*)&command, 1));
+    CHECK(channelEvent(BLE_L2CAP_EVENT_COC_ACCEPT) == 0);
+    CHECK(channelEvent(BLE_L2CAP_EVENT_COC_CONNECTED) == 0);
+    CHECK(L2capChannel::isOpen());
+    CHECK(photoFrameChunkSize() == CLIENT_MTU - BLE_FRAME_HEADER_SIZE);
+}
+
+/**
+ * The link goes: the stack closes the channel and drops what it held
+ */
+static void closeChannel() {
+    channelEvent(BLE_L2CAP_EVENT_COC_DISCONNECTED);
+    os_mbuf_free_chain(receiveBuffer);
+    receiveBuffer = nullptr;
+    stalled = false;
+    CHECK(!L2capChannel::isOpen());
+}
+
+static size_t endMarkers() {
+    size_t count = 0;
+    for (size_t i = 0; i < sdus.size(); i++) {
+        if (bleIsEndMarker(sdus[i].data(), sdus[i].size())) count++;
+    }
+    return count;
+}
+
+/**
+ * Run the sketch until this many images have ended on the channel (or
+ * it goes to sleep), handing credits back whenever the client ran out
+ */
+static void runUploads(size_t images) {
+    for (int pass = 0; pass < 200 && endMarkers() < images; pass++) {
+        if (stalled) {
+            // Turned down while stalled: nothing dropped, nothing sent, the loop carries on
+            uint32_t before = sends;
+            size_t taken = sdus.size();
+            CHECK(!VirtualDevice::runSketch(false, 200000));
+            CHECK(sends == before && sdus.size() == taken);
+            stalled = false;
+            channelEvent(BLE_L2CAP_EVENT_COC_TX_UNSTALLED);
+        }
+        if (VirtualDevice::runSketch(false, 100000)) return;
+    }
+}
+
+/**
+ * Split the SDUs into images: frames numbered from 0 without a gap or a
+ * repeat, each at most the client's MTU, then an end marker (a start
+ * header ahead, with PHOTO_START_HEADER, is skipped)
+ * @return The photo bytes of each image
+ */
+static std::vector<std::vector<uint8_t>> reassemble() {
+    std::vector<std::vector<uint8_t>> images(1);
+    uint16_t next = 0;
+    for (size_t i = 0; i < sdus.size(); i++) {
+        const std::vector<uint8_t>& sdu = sdus[i];
+        CHECK(sdu.size() >= BLE_FRAME_HEADER_SIZE && sdu.size() <= CLIENT_MTU);
+        if (bleIsEndMarker(sdu.data(), sdu.size())) {
+            images.push_back(std::vector<uint8_t>());
+            next = 0;
+            continue;
+        }
+        if (bleIsPhotoStart(sdu.data(), sdu.size())) continue;
+        CHECK(sdu[2] == BLE_FRAME_TYPE_PHOTO);
+        CHECK((uint16_t)(sdu[0] | sdu[1] << 8) == next);
+        next++;
+        images.back().insert(images.back().end(), sdu.begin() + BLE_FRAME_HEADER_SIZE, sdu.end());
+    }
+    CHECK(images.back().empty());
+    images.pop_back();
+    return images;
+}
+
+static bool isSample(const std::vector<uint8_t>& image) {
+    for (size_t i = 0; i < samples.size(); i++) {
+        if (image == samples[i]) return true;
+    }
+    return false;
+}
+
+// ===================================================================
+// TESTS
+// ===================================================================
+
+static void testLivePhoto() {
+    CHECK(!VirtualDevice::runSketch(true, 0));
+    CHECK(server != nullptr && serverPsm == L2CAP_BULK_PSM);
+    VirtualDevice::connect();
+
+    // Only a client that asked on photo control gets the channel
+    CHECK(channelEvent(BLE_L2CAP_EVENT_COC_ACCEPT) == BLE_HS_EREJECT);
+    openChannel();
+
+    int8_t command = PHOTO_SINGLE_SHOT;
+    CHECK(VirtualDevice::writeCharacteristic(PHOTO_CONTROL_UUID, (uint8_t*)&command, 1));
+    runUploads(1);
+    CHECK(endMarkers() == 1);
+    std::vector<std::vector<uint8_t>> images = reassemble();
+    CHECK(images.size() == 1 && isSample(images[0]));
+    CHECK(sends > sdus.size());         // Some were turned down and sent again
+    printf("live photo: %zu SDUs in %u sends\n", sdus.size(), (unsigned)sends);
+    closeChannel();
+}
+
+static void testStoredBatch() {
+    // Capture-only wakes store the batch; the flush wake stays up for a client
+    uint8_t interval = DUTY_CYCLE_MIN_INTERVAL_S;
+    CHECK(VirtualDevice::writeCharacteristic(PHOTO_CONTROL_UUID, &interval, 1));
+    CHECK(VirtualDevice::runSketch(false, 20000000));
+    for (int wake = 1; wake < DUTY_CYCLE_FLUSH_EVERY; wake++) {
+        VirtualDevice::wakeFromSleep(ESP_SLEEP_WAKEUP_TIMER, (uint64_t)DUTY_CYCLE_MIN_INTERVAL_S * 1000000ULL);
+        CHECK(VirtualDevice::runSketch(true, 0));
+    }
+    VirtualDevice::wakeFromSleep(ESP_SLEEP_WAKEUP_TIMER, (uint64_t)DUTY_CYCLE_MIN_INTERVAL_S * 1000000ULL);
+    CHECK(!VirtualDevice::runSketch(true, 0));
+    CHECK(DutyCycleCapture::getStoredPhotoCount() == DUTY_CYCLE_FLUSH_EVERY);
+
+    sdus.clear();
+    sends = 0;
+    VirtualDevice::connect();
+    openChannel();
+    runUploads(DUTY_CYCLE_FLUSH_EVERY);
+    CHECK(DutyCycleCapture::getStoredPhotoCount() == 0);
+    std::vector<std::vector<uint8_t>> images = reassemble();
+    CHECK(images.size() == DUTY_CYCLE_FLUSH_EVERY);
+    for (size_t i = 0; i < images.size(); i++) CHECK(isSample(images[i]));
+    printf("stored batch: %zu photos, %zu SDUs in %u sends\n", images.size(), sdus.size(), (unsigned)sends);
+    closeChannel();
+}
+
+int main() {
+    VirtualDevice::setConsole(nullptr);
+    char fsDir[] = "/tmp/test_l2cap_channel_XXXXXX";
+    CHECK(mkdtemp(fsDir) != nullptr);
+    VirtualDevice::setFsRoot(fsDir);
+    CHECK(VirtualDevice::loadJpegDir(SAMPLES_DIR) > 0);
+    loadSamples();
+
+    testLivePhoto();
+    testStoredBatch();
+    CHECK(mbufsHeld == 0);
+
+    return finishChecks("l2cap channel");
+}
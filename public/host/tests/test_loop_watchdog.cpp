@@ -0,0 +1,207 @@
+#include "virtual_device.h"
+#include "system/clock/timing.h"
+#include "system/cycles/cycle_manager.h"
+#include "system/cycles/loop_watchdog.h"
+#include "check.h"
+#include <stdio.h>
+#include <string.h>
+
+// ===================================================================
+// LOOP WATCHDOG TEST
+// ===================================================================
+//
+// The host has no watchdog task, so blocking cycles sample the watchdog
+// themselves: every LOOP_WATCHDOG_CHECK_MS of virtual time they spend,
+// check() runs as the task on the other core would. Checks that a pass
+// over the threshold is caught once, blamed on the cycle that was
+// executing (or checking its condition), counted on that cycle and in
+// printCycleManagerStats(), and that short passes and sleep gaps are not
+// stalls.
+//
+
+static uint32_t batteryBlockMs = 0;
+static uint32_t photoBlockMs = 0;
+static uint32_t conditionBlockMs = 0;
+
+/**
+ * Spend time inside a cycle while the watchdog samples
+ */
+static void blockFor(uint32_t ms) {
+    for (uint32_t spent = 0; spent < ms; spent += LOOP_WATCHDOG_CHECK_MS) {
+        VirtualDevice::advanceUs(LOOP_WATCHDOG_CHECK_MS * 1000ULL);
+        LoopWatchdog::check();
+    }
+}
+
+static uint32_t stallCount(int cycle_id) {
+    uint32_t count, max_ms;
+    LoopWatchdog::getCycleStalls(cycle_id, &count, &max_ms);
+    return count;
+}
+
+static uint32_t longestStall(int cycle_id) {
+    uint32_t count, max_ms;
+    LoopWatchdog::getCycleStalls(cycle_id, &count, &max_ms);
+    return max_ms;
+}
+
+/**
+ * One loop() pass followed by the loop delay, sampled like the device
+ */
+static void loopPass() {
+    updateCycles();
+    LoopWatchdog::check();
+    blockFor(LOOP_WATCHDOG_CHECK_MS);
+}
+
+static void testStallAttribution() {
+    int audio_id = registerIntervalCycle("AudioCapture", 10, []() {}, CYCLE_PRIORITY_HIGH);
+    int battery_id = registerIntervalCycle("BatteryUpdate", 100, []() {
+        blockFor(batteryBlockMs);
+    }, CYCLE_PRIORITY_LOW);
+    int photo_id = registerIntervalCycle("PhotoCapture", 100, []() {
+        blockFor(photoBlockMs);
+    });
+    CHECK(audio_id >= 0 && battery_id >= 0 && photo_id >= 0);
+
+    // Passes under the threshold are not stalls
+    batteryBlockMs = LOOP_WATCHDOG_THRESHOLD_MS - 3 * LOOP_WATCHDOG_CHECK_MS;
+    for (int i = 0; i < 50; i++) loopPass();
+    CHECK(LoopWatchdog::getStallCount() == 0);
+    CHECK(getExecutingCycleId() == -1);
+    CHECK((getCyclePassSequence() & 1) == 0);
+
+    // readBatteryVoltage() blocks for a second
+    batteryBlockMs = 1000;
+    loopPass();
+    batteryBlockMs = 0;
+    for (int i = 0; i < 10; i++) loopPass();
+
+    loop_stall_t stall;
+    CHECK(LoopWatchdog::getStallCount() == 1);
+    CHECK(LoopWatchdog::getLastStall(&stall));
+    CHECK(stall.cycle_id == battery_id);
+    CHECK(strcmp(stall.cycle_name, "BatteryUpdate") == 0);
+    CHECK(stall.ended);
+    CHECK(!stall.backtrace);                        // No backtrace on the host
+    printf("stall in '%s': %lu ms\n", stall.cycle_name, (unsigned long)stall.duration_ms);
+    CHECK(stall.duration_ms + LOOP_WATCHDOG_CHECK_MS >= 1000 && stall.duration_ms <= 1000);
+    CHECK(stallCount(battery_id) == 1);
+    CHECK(longestStall(battery_id) == stall.duration_ms);
+    CHECK(stallCount(audio_id) == 0);
+
+    // take_photo() retries twice: two stalls on the photo cycle
+    photoBlockMs = 400;
+    loopPass();
+    loopPass();
+    photoBlockMs = 0;
+    for (int i = 0; i < 10; i++) loopPass();
+    CHECK(LoopWatchdog::getStallCount() == 3);
+    CHECK(stallCount(photo_id) == 2);
+    CHECK(longestStall(photo_id) < stall.duration_ms);
+    CHECK(LoopWatchdog::getMaxStallMs() == stall.duration_ms);
+    CHECK(LoopWatchdog::getLastStall(&stall));
+    CHECK(stall.cycle_id == photo_id);
+
+    // Statistics appear in the cycle manager report
+    char buffer[8192];
+    FILE* out = fmemopen(buffer, sizeof(buffer), "w");
+    VirtualDevice::setConsole(out);
+    printCycleManagerStats();
+    VirtualDevice::setConsole(nullptr);
+    fclose(out);
+    CHECK(strstr(buffer, "1 loop stalls") != nullptr);
+    CHECK(strstr(buffer, "2 loop stalls") != nullptr);
+    CHECK(strstr(buffer, "Loop stalls: 3 over") != nullptr);
+    CHECK(strstr(buffer, "in 'BatteryUpdate'") != nullptr);
+
+    // Per-cycle counts reset with the cycle's statistics
+    resetCycleStats(photo_id);
+    CHECK(stallCount(photo_id) == 0);
+
+    CHECK(unregisterCycle(audio_id));
+    CHECK(unregisterCycle(battery_id));
+    CHECK(unregisterCycle(photo_id));
+}
+
+static void testStallInCondition() {
+    LoopWatchdog::reset();
+
+    // Logging from a condition on a congested console
+    int condition_id = registerConditionCycle("AudioCapture", []() {
+        blockFor(conditionBlockMs);
+        return false;
+    }, []() {}, CYCLE_PRIORITY_HIGH);
+    CHECK(condition_id >= 0);
+
+    conditionBlockMs = 400;
+    loopPass();
+    conditionBlockMs = 0;
+    loopPass();
+
+    loop_stall_t stall;
+    CHECK(LoopWatchdog::getStallCount() == 1);
+    CHECK(LoopWatchdog::getLastStall(&stall));
+    CHECK(stall.cycle_id == condition_id);
+    CHECK(strcmp(stall.cycle_name, "AudioCapture") == 0);
+    CHECK(getExecutingCycleId() == -1);
+    CHECK(stallCount(condition_id) == 1);
+
+    // The snapshot the watchdog reads between cycles
+    cycle_activity_t activity;
+    getCycleActivity(&activity);
+    CHECK(activity.cycle_id == -1 && activity.cycle_name == nullptr);
+    CHECK((activity.pass_sequence & 1) == 0 && activity.pass_sequence == getCyclePassSequence());
+
+    // The stalls go with the cycle; a new cycle in its slot starts without them
+    CHECK(unregisterCycle(condition_id));
+    CHECK(stallCount(condition_id) == 0);
+    int reused_id = registerConditionCycle("Reused", []() { return false; }, []() {});
+    CHECK(reused_id >= 0 && reused_id != condition_id);
+    CHECK(stallCount(reused_id) == 0);
+    CHECK(unregisterCycle(reused_id));
+}
+
+static void testSleepGapIsNotAStall() {
+    LoopWatchdog::reset();
+
+    // Light sleep inside a cycle: the watchdog task did not run either
+    int sleep_id = registerTimeoutCycle("LightSleep", 1, []() {
+        VirtualDevice::advanceUs(5000000);
+        LoopWatchdog::check();
+        blockFor(2 * LOOP_WATCHDOG_CHECK_MS);
+    });
+    CHECK(sleep_id >= 0);
+    for (int i = 0; i < 5; i++) loopPass();
+    CHECK(LoopWatchdog::getStallCount() == 0);
+
+    // A stall that is still going on shows up before the pass ends
+    int long_id = registerTimeoutCycle("Stuck", 1, []() {
+        blockFor(600);
+        loop_stall_t stall;
+        CHECK(LoopWatchdog::getLastStall(&stall));
+        CHECK(!stall.ended);
+        CHECK(stall.duration_ms >= 500);
+        CHECK(LoopWatchdog::getStallCount() == 1);
+    });
+    CHECK(long_id >= 0);
+    for (int i = 0; i < 5; i++) loopPass();
+    CHECK(LoopWatchdog::getStallCount() == 1);
+
+    LoopWatchdog::reset();
+    loop_stall_t stall;
+    CHECK(!LoopWatchdog::getLastStall(&stall));
+    CHECK(LoopWatchdog::getMaxStallMs() == 0);
+}
+
+int main() {
+    VirtualDevice::setConsole(nullptr);
+    initializeCycleManager();
+    CHECK(LoopWatchdog::begin());
+
+    testStallAttribution();
+    testStallInCondition();
+    testSleepGapIsNotAStall();
+
+    return finishChecks("loop watchdog");
+}
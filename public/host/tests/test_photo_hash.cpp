@@ -0,0 +1,273 @@
+#include "virtual_device.h"
+#include "stream_reassembly.h"
+#include "features/bluetooth/ble_frame_format.h"
+#include "features/camera/photo_hash.h"
+#include "check.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+// ===================================================================
+// PHOTO HASH TEST
+// ===================================================================
+//
+// The DC-only decode of the checked-in sample capture (pinned against
+// libjpeg's 1/8 scale decode) and its cost, block means of JPEGs of known
+// content at several qualities and restart intervals, how far the hash
+// moves for the same scene against a different one, truncated and
+// corrupted input, and the start header on the wire and in the client's
+// reassembler.
+//
+
+// The sample capture's 1/8 scale image (FNV-1a of libjpeg's DC decode) and hash
+#define SAMPLE_DC_FNV 0x7bbeab4cu
+#define SAMPLE_HASH 0x8ccce2e1e1f1eb8fULL
+
+static uint32_t fnv1a(const uint8_t* data, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static uint64_t hashOf(const std::vector<uint8_t>& jpeg) {
+    uint64_t hash = 0;
+    CHECK(photoHashJpeg(&jpeg[0], jpeg.size(), &hash));
+    return hash;
+}
+
+static void testSample() {
+    std::vector<uint8_t> jpeg = readFile(SAMPLE_JPEG);
+    CHECK(jpeg.size() == 5472);
+    if (jpeg.empty()) return;
+
+    // QVGA 4:2:2: 40x30 luma blocks, each equal to libjpeg's scale 1/8 output
+    uint8_t dc[40 * 30];
+    uint16_t blocksWide = 0, blocksHigh = 0;
+    CHECK(jpegDcImage(&jpeg[0], jpeg.size(), dc, sizeof(dc), &blocksWide, &blocksHigh));
+    CHECK(blocksWide == 40 && blocksHigh == 30);
+    CHECK(fnv1a(dc, sizeof(dc)) == SAMPLE_DC_FNV);
+    CHECK(!jpegDcImage(&jpeg[0], jpeg.size(), dc, sizeof(dc) - 1, &blocksWide, &blocksHigh));
+
+    uint64_t hash = hashOf(jpeg);
+    CHECK(hash == SAMPLE_HASH);
+    CHECK(photoHashGray(dc, 40, 40, 30) == hash);
+
+    const int runs = 200;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < runs; i++) photoHashJpeg(&jpeg[0], jpeg.size(), &hash);
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / runs;
+    printf("photo hash: sample %016llx, %.1f us per hash\n", (unsigned long long)hash, us);
+    CHECK(us < 5000);
+
+    // Truncated anywhere: refused, never read past the end
+    for (size_t length = 0; length < jpeg.size() - 64; length += 7) {
+        std::vector<uint8_t> cut(jpeg.begin(), jpeg.begin() + length);
+        CHECK(!photoHashJpeg(cut.empty() ? nullptr : &cut[0], cut.size(), &hash));
+    }
+
+    // Corrupted bytes: any answer, but no crash
+    uint32_t state = 12345;
+    for (int trial = 0; trial < 2000; trial++) {
+        std::vector<uint8_t> broken = jpeg;
+        for (int i = 0; i < 4; i++) {
+            state = state * 1103515245u + 12345u;
+            broken[(state >> 8) % broken.size()] = (uint8_t)(state >> 24);
+        }
+        photoHashJpeg(&broken[0], broken.size(), &hash);
+        jpegDcImage(&broken[0], broken.size(), dc, sizeof(dc), &blocksWide, &blocksHigh);
+    }
+
+    // Progressive JPEGs are refused
+    std::vector<uint8_t> progressive = jpeg;
+    for (size_t i = 2; i + 1 < progressive.size(); i++) {
+        if (progressive[i] == 0xFF && progressive[i + 1] == 0xC0) {
+            progressive[i + 1] = 0xC2;
+            break;
+        }
+    }
+    CHECK(!photoHashJpeg(&progressive[0], progressive.size(), &hash));
+}
+
+static void testBlockMeans() {
+    // Odd sizes: the last column and row of blocks are padded
+    const size_t width = 637, height = 477;
+    std::vector<uint8_t> frame(width * height), jpeg;
+    VirtualDevice::renderDeskScene(&frame[0], width, height, 7);
+    const size_t blocksWide = (width + 7) / 8, blocksHigh = (height + 7) / 8;
+    std::vector<uint8_t> dc(blocksWide * blocksHigh);
+
+    const int qualities[] = {10, 50, 90};
+    const uint16_t restarts[] = {0, 1, 13};
+    for (size_t q = 0; q < sizeof(qualities) / sizeof(qualities[0]); q++) {
+        for (size_t r = 0; r < sizeof(restarts) / sizeof(restarts[0]); r++) {
+            VirtualDevice::encodeJpeg(&frame[0], width, height, qualities[q], restarts[r], &jpeg);
+            uint16_t w = 0, h = 0;
+            CHECK(jpegDcImage(&jpeg[0], jpeg.size(), &dc[0], dc.size(), &w, &h));
+            CHECK(w == blocksWide && h == blocksHigh);
+
+            // DC quantization: the mean is off by at most q0 / 16, plus rounding
+            int scale = qualities[q] < 50 ? 5000 / qualities[q] : 200 - 2 * qualities[q];
+            double tolerance = (16 * scale + 50) / 100 / 16.0 + 1.0;
+            double worst = 0;
+            for (size_t by = 0; by < blocksHigh; by++) {
+                for (size_t bx = 0; bx < blocksWide; bx++) {
+                    double sum = 0;
+                    for (size_t y = by * 8; y < by * 8 + 8; y++) {
+                        for (size_t x = bx * 8; x < bx * 8 + 8; x++) {
+                            sum += frame[(y < height ? y : height - 1) * width + (x < width ? x : width - 1)];
+                        }
+                    }
+                    double error = fabs(dc[by * blocksWide + bx] - sum / 64);
+                    if (error > worst) worst = error;
+                }
+            }
+            CHECK(worst <= tolerance);
+        }
+    }
+}
+
+static void testDistances() {
+    const size_t width = 320, height = 240;
+    std::vector<uint8_t> frame(width * height), changed(width * height), jpeg;
+    VirtualDevice::renderDeskScene(&frame[0], width, height, 0);
+
+    VirtualDevice::encodeJpeg(&frame[0], width, height, 90, 0, &jpeg);
+    uint64_t reference = hashOf(jpeg);
+
+    // A 1/8 probe frame (block means) hashes like the JPEG
+    uint8_t probe[40 * 30];
+    for (size_t by = 0; by < 30; by++) {
+        for (size_t bx = 0; bx < 40; bx++) {
+            int sum = 0;
+            for (size_t y = by * 8; y < by * 8 + 8; y++) {
+                for (size_t x = bx * 8; x < bx * 8 + 8; x++) sum += frame[y * width + x];
+            }
+            probe[by * 40 + bx] = (uint8_t)((sum + 32) / 64);
+        }
+    }
+    CHECK(photoHashDistance(reference, photoHashGray(probe, 40, 40, 30)) <= 2);
+
+    // The same scene: another quality, brighter, lower contrast, sensor noise
+    VirtualDevice::encodeJpeg(&frame[0], width, height, 15, 0, &jpeg);
+    int quality = photoHashDistance(reference, hashOf(jpeg));
+    for (size_t i = 0; i < frame.size(); i++) changed[i] = (uint8_t)(frame[i] > 225 ? 255 : frame[i] + 30);
+    VirtualDevice::encodeJpeg(&changed[0], width, height, 90, 0, &jpeg);
+    int brighter = photoHashDistance(reference, hashOf(jpeg));
+    for (size_t i = 0; i < frame.size(); i++) changed[i] = (uint8_t)(64 + frame[i] / 2);
+    VirtualDevice::encodeJpeg(&changed[0], width, height, 90, 0, &jpeg);
+    int contrast = photoHashDistance(reference, hashOf(jpeg));
+    uint32_t state = 1;
+    for (size_t i = 0; i < frame.size(); i++) {
+        state = state * 1103515245u + 12345u;
+        int value = frame[i] + (int)((state >> 16) % 13) - 6;
+        changed[i] = (uint8_t)(value < 0 ? 0 : value > 255 ? 255 : value);
+    }
+    VirtualDevice::encodeJpeg(&changed[0], width, height, 90, 0, &jpeg);
+    int noise = photoHashDistance(reference, hashOf(jpeg));
+
+    // A different scene: the sample capture, and the desk mirrored
+    int other = photoHashDistance(reference, hashOf(readFile(SAMPLE_JPEG)));
+    for (size_t y = 0; y < height; y++) {
+        for (size_t x = 0; x < width; x++) changed[y * width + x] = frame[y * width + width - 1 - x];
+    }
+    VirtualDevice::encodeJpeg(&changed[0], width, height, 90, 0, &jpeg);
+    int mirrored = photoHashDistance(reference, hashOf(jpeg));
+
+    printf("photo hash: same scene at quality 15 %d bits, +30 brightness %d, half contrast %d, noise %d; "
+           "other scene %d, mirrored %d\n", quality, brighter, contrast, noise, other, mirrored);
+    CHECK(quality <= 4 && brighter <= 4 && contrast <= 4 && noise <= 4);
+    CHECK(other >= 20 && mirrored >= 20);
+}
+
+typedef struct {
+    int delivered;
+    int complete;
+    bool hashed;
+    uint64_t hash;
+    const ImageReassembler* source;
+} collected_t;
+
+static void collect(void* ctx, uint32_t number, const uint8_t* data, size_t length, bool complete) {
+    (void)number;
+    (void)data;
+    (void)length;
+    collected_t* c = (collected_t*)ctx;
+    c->delivered++;
+    if (complete) c->complete++;
+    c->hashed = c->source->startHash(&c->hash);
+}
+
+static void sendPhoto(ImageReassembler& reassembler, const std::vector<uint8_t>& jpeg, uint64_t hash,
+                      uint32_t announced, size_t stopAfter) {
+    uint8_t packet[BLE_FRAME_HEADER_SIZE + 100];
+    bleWritePhotoStart(packet, BLE_FRAME_TYPE_PHOTO, BLE_PHOTO_START_HASH, hash, announced);
+    CHECK(bleIsPhotoStart(packet, BLE_PHOTO_START_SIZE));
+    reassembler.push(packet, BLE_PHOTO_START_SIZE);
+
+    uint16_t index = 0;
+    for (size_t offset = 0; offset < jpeg.size() && offset < stopAfter; offset += 100, index++) {
+        size_t chunk = jpeg.size() - offset < 100 ? jpeg.size() - offset : 100;
+        bleWriteFrameHeader(packet, index, BLE_FRAME_TYPE_PHOTO);
+        memcpy(&packet[BLE_FRAME_HEADER_SIZE], &jpeg[offset], chunk);
+        reassembler.push(packet, BLE_FRAME_HEADER_SIZE + chunk);
+    }
+    if (stopAfter >= jpeg.size()) {
+        bleWriteEndMarker(packet, BLE_FRAME_TYPE_PHOTO);
+        reassembler.push(packet, BLE_FRAME_HEADER_SIZE);
+    }
+}
+
+static void testStartHeader() {
+    uint8_t header[BLE_PHOTO_START_SIZE];
+    bleWritePhotoStart(header, BLE_FRAME_TYPE_PHOTO, BLE_PHOTO_START_HASH, 0x0123456789ABCDEFULL, 0xA1B2C3D4);
+    CHECK(header[0] == 0xFE && header[1] == 0xFF && header[2] == BLE_FRAME_TYPE_PHOTO);
+    CHECK(header[3] == BLE_PHOTO_START_HASH && header[4] == 0xEF && header[11] == 0x01 && header[12] == 0xD4);
+    CHECK(blePhotoStartHash(header) == 0x0123456789ABCDEFULL);
+    CHECK(blePhotoStartLength(header) == 0xA1B2C3D4);
+    CHECK(!bleIsPhotoStart(header, BLE_PHOTO_START_SIZE - 1));
+    CHECK(!bleIsEndMarker(header, BLE_PHOTO_START_SIZE));
+
+    std::vector<uint8_t> jpeg = readFile(SAMPLE_JPEG);
+    if (jpeg.empty()) return;
+    uint64_t hash = hashOf(jpeg);
+
+    ImageReassembler reassembler(BLE_FRAME_TYPE_PHOTO);
+    collected_t c = {0, 0, false, 0, &reassembler};
+    reassembler.setCallback(collect, &c);
+
+    // Whole: complete, with its hash
+    sendPhoto(reassembler, jpeg, hash, (uint32_t)jpeg.size(), jpeg.size());
+    CHECK(c.delivered == 1 && c.complete == 1 && c.hashed && c.hash == hash);
+
+    // Skipped after 1 KB: delivered incomplete when the next one starts
+    sendPhoto(reassembler, jpeg, hash ^ 1, (uint32_t)jpeg.size(), 1000);
+    CHECK(c.delivered == 1);
+    sendPhoto(reassembler, jpeg, hash, (uint32_t)jpeg.size(), jpeg.size());
+    CHECK(c.delivered == 3 && c.complete == 2 && c.hash == hash);
+
+    // Fewer bytes than announced: incomplete
+    sendPhoto(reassembler, jpeg, hash, (uint32_t)jpeg.size() + 1, jpeg.size());
+    CHECK(c.delivered == 4 && c.complete == 2);
+
+    const image_stream_stats_t& s = reassembler.stats();
+    CHECK(s.start_headers == 4);
+    CHECK(s.unterminated == 1);
+    CHECK(s.malformed == 0);
+}
+
+int main() {
+    VirtualDevice::setConsole(nullptr);
+
+    testSample();
+    testBlockMeans();
+    testDistances();
+    testStartHeader();
+
+    return finishChecks("photo hash");
+}
@@ -0,0 +1,209 @@
+#include "virtual_device.h"
+#include "features/camera/photo_hash.h"
+#include "features/camera/photo_quality.h"
+#include "features/camera/image_kernels.h"
+#include "check.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+// ===================================================================
+// PHOTO QUALITY TEST
+// ===================================================================
+//
+// The luma shrunk from JPEG coefficients against box means of the frame
+// it was encoded from, the automatic shrink factor per resolution and the
+// work buffer limit, blur along one direction (which the 4-neighbour
+// Laplacian misses), clipped exposure, and the checked-in sample capture.
+//
+
+// constants.h defaults
+static const photo_quality_config_t DEFAULTS = {0, 140, 16, 240, 25};
+
+// Box blur of the given length along x only
+static void blurHorizontal(const std::vector<uint8_t>& frame, size_t width, size_t height, int length,
+                           std::vector<uint8_t>* out) {
+    out->resize(frame.size());
+    for (size_t y = 0; y < height; y++) {
+        for (size_t x = 0; x < width; x++) {
+            int sum = 0;
+            for (int i = 0; i < length; i++) {
+                long sx = (long)x + i - length / 2;
+                sx = sx < 0 ? 0 : sx >= (long)width ? (long)width - 1 : sx;
+                sum += frame[y * width + sx];
+            }
+            (*out)[y * width + x] = (uint8_t)((sum + length / 2) / length);
+        }
+    }
+}
+
+static void testDownscale() {
+    const size_t width = 320, height = 240;
+    std::vector<uint8_t> frame(width * height), jpeg;
+    VirtualDevice::renderDeskScene(&frame[0], width, height, 3);
+    VirtualDevice::encodeJpeg(&frame[0], width, height, 95, 0, &jpeg);
+
+    std::vector<uint8_t> out(width * height);
+    const uint8_t factors[] = {2, 4, 8};
+    for (size_t f = 0; f < sizeof(factors) / sizeof(factors[0]); f++) {
+        uint8_t factor = factors[f];
+        uint16_t w = 0, h = 0;
+        CHECK(jpegLumaDownscale(&jpeg[0], jpeg.size(), factor, &out[0], out.size(), &w, &h));
+        CHECK(w == width / factor && h == height / factor);
+        if (w != width / factor || h != height / factor) continue;
+
+        // High quality: each pixel close to the mean of its square
+        double total = 0, worst = 0;
+        for (size_t oy = 0; oy < h; oy++) {
+            for (size_t ox = 0; ox < w; ox++) {
+                int sum = 0;
+                for (size_t y = oy * factor; y < (oy + 1) * factor; y++) {
+                    for (size_t x = ox * factor; x < (ox + 1) * factor; x++) sum += frame[y * width + x];
+                }
+                double error = fabs(out[oy * w + ox] - sum / (double)(factor * factor));
+                total += error;
+                if (error > worst) worst = error;
+            }
+        }
+        CHECK(total / (w * h) < 1.5);
+        CHECK(worst < 12);
+
+        // Factor 8 is the DC image
+        if (factor == 8) {
+            std::vector<uint8_t> dc(w * h);
+            uint16_t bw = 0, bh = 0;
+            CHECK(jpegDcImage(&jpeg[0], jpeg.size(), &dc[0], dc.size(), &bw, &bh));
+            int differ = 0;
+            for (size_t i = 0; i < dc.size(); i++) differ += abs(dc[i] - out[i]) > 1;
+            CHECK(differ == 0);
+        }
+        CHECK(!jpegLumaDownscale(&jpeg[0], jpeg.size(), factor, &out[0], (size_t)w * h - 1, &w, &h));
+    }
+    uint16_t w, h;
+    CHECK(!jpegLumaDownscale(&jpeg[0], jpeg.size(), 3, &out[0], out.size(), &w, &h));
+    CHECK(!jpegLumaDownscale(&jpeg[0], jpeg.size() / 2, 2, &out[0], out.size(), &w, &h));
+}
+
+static void testFactors() {
+    // The least shrink that fits PHOTO_QUALITY_WORK_SIZE, whatever the buffer
+    const struct {
+        size_t width, height;
+        uint8_t factor;
+    } sizes[] = {{320, 240, 2}, {640, 480, 4}, {800, 600, 4}, {1600, 1200, 8}};
+    std::vector<uint8_t> work(800 * 600);
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        std::vector<uint8_t> frame(sizes[s].width * sizes[s].height), jpeg;
+        VirtualDevice::renderDeskScene(&frame[0], sizes[s].width, sizes[s].height, 1);
+        VirtualDevice::encodeJpeg(&frame[0], sizes[s].width, sizes[s].height, 80, 0, &jpeg);
+        photo_quality_t quality;
+        CHECK(photoQualityJpeg(&jpeg[0], jpeg.size(), DEFAULTS, &work[0], work.size(), &quality));
+        CHECK(quality.factor == sizes[s].factor);
+        CHECK(quality.flags == 0);
+
+        // A fixed factor may use the whole buffer
+        photo_quality_config_t fixed = DEFAULTS;
+        fixed.factor = 2;
+        CHECK(photoQualityJpeg(&jpeg[0], jpeg.size(), fixed, &work[0], work.size(), &quality));
+        CHECK(quality.factor == 2);
+    }
+
+    // UXGA by 8 is 200x150: a smaller buffer cannot hold any factor
+    std::vector<uint8_t> frame(1600 * 1200), jpeg;
+    VirtualDevice::renderDeskScene(&frame[0], 1600, 1200, 1);
+    VirtualDevice::encodeJpeg(&frame[0], 1600, 1200, 80, 0, &jpeg);
+    photo_quality_t quality;
+    CHECK(!photoQualityJpeg(&jpeg[0], jpeg.size(), DEFAULTS, &work[0], PHOTO_QUALITY_WORK_SIZE - 1, &quality));
+}
+
+static void testDirectionalBlur() {
+    const size_t width = 200, height = 150;
+    std::vector<uint8_t> frame(width * height), blurred;
+    VirtualDevice::renderDeskScene(&frame[0], width, height, 5);
+
+    photo_quality_t sharp, smeared;
+    photoQualityGray(&frame[0], width, width, height, DEFAULTS, &sharp);
+    CHECK(sharp.flags == 0 && sharp.factor == 1);
+
+    // Smeared along x: the horizontal second difference collapses, the
+    // vertical one does not, and neither does the Laplacian
+    blurHorizontal(frame, width, height, 7, &blurred);
+    photoQualityGray(&blurred[0], width, width, height, DEFAULTS, &smeared);
+    CHECK(smeared.flags == PHOTO_QUALITY_BLURRY);
+    CHECK(smeared.direction == 0);
+    CHECK(smeared.sharpness * 4 < sharp.sharpness);
+
+    uint64_t interior = (uint64_t)(width - 2) * (height - 2);
+    uint64_t laplacianSharp = imageSharpness(&frame[0], width, width, height) / interior;
+    uint64_t laplacianSmeared = imageSharpness(&blurred[0], width, width, height) / interior;
+    CHECK(laplacianSmeared * 3 > laplacianSharp);
+
+    // The same smear along y, through the transpose
+    std::vector<uint8_t> transposed(frame.size());
+    for (size_t y = 0; y < height; y++) {
+        for (size_t x = 0; x < width; x++) transposed[x * height + y] = blurred[y * width + x];
+    }
+    photo_quality_t turned;
+    photoQualityGray(&transposed[0], height, height, width, DEFAULTS, &turned);
+    CHECK(turned.flags == PHOTO_QUALITY_BLURRY && turned.direction == 1);
+
+    // Too small to score: zeros, no flags raised on garbage
+    photo_quality_t tiny;
+    photoQualityGray(&frame[0], width, 2, 2, DEFAULTS, &tiny);
+    CHECK(tiny.sharpness == 0 && tiny.flags == 0);
+}
+
+static void testExposure() {
+    const size_t width = 200, height = 150;
+    std::vector<uint8_t> frame(width * height), changed(width * height);
+    VirtualDevice::renderDeskScene(&frame[0], width, height, 2);
+
+    photo_quality_t quality;
+    for (size_t i = 0; i < frame.size(); i++) changed[i] = (uint8_t)(frame[i] / 10);
+    photoQualityGray(&changed[0], width, width, height, DEFAULTS, &quality);
+    CHECK(quality.flags & PHOTO_QUALITY_DARK);
+    CHECK(!(quality.flags & PHOTO_QUALITY_BRIGHT));
+    CHECK(quality.dark_percent > 25 && quality.mean < 20);
+
+    for (size_t i = 0; i < frame.size(); i++) changed[i] = (uint8_t)(frame[i] * 3 > 255 ? 255 : frame[i] * 3);
+    photoQualityGray(&changed[0], width, width, height, DEFAULTS, &quality);
+    CHECK(quality.flags & PHOTO_QUALITY_BRIGHT);
+    CHECK(!(quality.flags & PHOTO_QUALITY_DARK));
+
+    // Flat mid-gray: exposed fine, but no detail at all
+    memset(&changed[0], 128, changed.size());
+    photoQualityGray(&changed[0], width, width, height, DEFAULTS, &quality);
+    CHECK(quality.flags == PHOTO_QUALITY_BLURRY && quality.mean == 128 && quality.sharpness == 0);
+}
+
+static void testSample() {
+    std::vector<uint8_t> jpeg = readFile(SAMPLE_JPEG);
+    CHECK(!jpeg.empty());
+    if (jpeg.empty()) return;
+
+    // QVGA, out of focus: scored by 2 and rejected
+    static uint8_t work[PHOTO_QUALITY_WORK_SIZE];
+    photo_quality_t quality;
+    CHECK(photoQualityJpeg(&jpeg[0], jpeg.size(), DEFAULTS, work, sizeof(work), &quality));
+    CHECK(quality.factor == 2);
+    CHECK(quality.flags == PHOTO_QUALITY_BLURRY);
+    printf("photo quality: sample sharpness %u (direction %u), mean %u\n", (unsigned)quality.sharpness,
+           (unsigned)quality.direction, (unsigned)quality.mean);
+
+    // Truncated anywhere: refused, never read past the end
+    for (size_t length = 0; length < jpeg.size() - 64; length += 11) {
+        std::vector<uint8_t> cut(jpeg.begin(), jpeg.begin() + length);
+        CHECK(!photoQualityJpeg(cut.empty() ? nullptr : &cut[0], cut.size(), DEFAULTS, work, sizeof(work), &quality));
+    }
+}
+
+int main() {
+    VirtualDevice::setConsole(nullptr);
+    testDownscale();
+    testFactors();
+    testDirectionalBlur();
+    testExposure();
+    testSample();
+    return finishChecks("photo quality");
+}
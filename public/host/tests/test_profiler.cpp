@@ -0,0 +1,123 @@
+#include "virtual_device.h"
+#include "system/clock/profiler.h"
+#include "check.h"
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+
+// ===================================================================
+// PROFILER TEST
+// ===================================================================
+//
+// Profiler sites on the host counter (rdtsc or steady_clock): scopes
+// measure real time, sites are constant-initialized and register on
+// first use, and ticks taken before a tick-rate change (setPowerMode()
+// on the device) keep the rate they were taken at.
+//
+
+// Sites are literal types: no guard or constructor runs for them
+static constexpr profile_site_t probe("probe");
+static_assert(probe.count == 0 && probe.total_ticks == 0 && !probe.registered,
+              "profile_site_t must be constant-initialized");
+
+static void busyWaitUs(int64_t us) {
+    typedef std::chrono::steady_clock clock;
+    clock::time_point start = clock::now();
+    while (std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - start).count() < us) {
+    }
+}
+
+static void profiledWork() {
+    PROFILE_FUNCTION();
+    busyWaitUs(200);
+}
+
+static void testScopes() {
+    CHECK(Profiler::findSite("busy") == nullptr);
+
+    for (int i = 0; i < 5; i++) {
+        PROFILE_SCOPE("busy");
+        busyWaitUs(1000);
+        profiledWork();                             // Nested site
+    }
+
+    const profile_site_t* busy = Profiler::findSite("busy");
+    const profile_site_t* work = Profiler::findSite("profiledWork");
+    CHECK(busy != nullptr);
+    CHECK(work != nullptr);
+    CHECK(Profiler::getSiteCount() == 2);
+    if (!busy || !work) return;
+
+    printf("tick rate %lu/us, busy avg %.1f us, max %.1f us, profiledWork avg %.1f us\n",
+           (unsigned long)Profiler::getTickRate(), Profiler::totalNs(busy) / 5000.0,
+           Profiler::maxNs(busy) / 1000.0, Profiler::totalNs(work) / 5000.0);
+    CHECK(busy->count == 5);
+    CHECK(work->count == 5);
+    CHECK(Profiler::totalNs(busy) >= 5 * 1200000ULL);
+    CHECK(Profiler::totalNs(busy) < 5 * 50000000ULL);
+    CHECK(Profiler::totalNs(work) >= 5 * 200000ULL);
+    CHECK(Profiler::totalNs(work) < Profiler::totalNs(busy));
+    CHECK(Profiler::maxNs(busy) >= 1200000);
+
+    Profiler::reset();
+    CHECK(busy->count == 0);
+    CHECK(Profiler::totalNs(busy) == 0);
+    CHECK(Profiler::getSiteCount() == 2);           // Still registered
+}
+
+static void testTickRateChange() {
+    uint32_t hostRate = Profiler::getTickRate();
+    static profile_site_t site("rate_change");
+
+    // 240 MHz: 1 ms, then 80 MHz (setPowerMode): another 1 ms
+    Profiler::setTickRate(240);
+    Profiler::record(&site, 240000);
+    CHECK(site.registered);
+    CHECK(Profiler::findSite("rate_change") == &site);
+    CHECK(Profiler::totalNs(&site) == 1000000);
+
+    Profiler::setTickRate(80);
+    CHECK(site.total_ticks == 0);
+    CHECK(site.folded_ns == 1000000);
+    Profiler::record(&site, 80000);
+    Profiler::record(&site, 40000);
+    CHECK(site.count == 3);
+    CHECK(Profiler::totalNs(&site) == 2500000);
+    CHECK(Profiler::maxNs(&site) == 1000000);       // The 240 MHz pass
+    Profiler::record(&site, 160000);
+    CHECK(Profiler::maxNs(&site) == 2000000);
+    CHECK(Profiler::ticksToUs(160000) == 2000.0f);
+
+    // Rate 0 is ignored
+    Profiler::setTickRate(0);
+    CHECK(Profiler::getTickRate() == 80);
+
+    Profiler::setTickRate(hostRate);
+    CHECK(Profiler::totalNs(&site) == 4500000);
+}
+
+static void testReport() {
+    // The report goes to the console
+    char buffer[4096];
+    FILE* out = fmemopen(buffer, sizeof(buffer), "w");
+    VirtualDevice::setConsole(out);
+    Profiler::printReport(true);
+    VirtualDevice::setConsole(nullptr);
+    fclose(out);
+
+    CHECK(strstr(buffer, "=== Profiler ===") != nullptr);
+    CHECK(strstr(buffer, "rate_change") != nullptr);
+    CHECK(strstr(buffer, "busy ") == nullptr);      // Reset before: no passes
+    CHECK(Profiler::findSite("rate_change")->count == 0);
+}
+
+int main() {
+    VirtualDevice::setConsole(nullptr);
+    Profiler::begin();                              // As setup() does: calibration is not timed
+
+    testScopes();
+    testTickRateChange();
+    testReport();
+
+    return finishChecks("profiler");
+}
@@ -0,0 +1,78 @@
+#include "virtual_device.h"
+#include "features/bluetooth/services/ble_services.h"
+#include "features/camera/camera.h"
+#include "system/clock/timing.h"
+#include "system/power_management/duty_cycle_capture.h"
+#include "system/power_management/retained_state.h"
+#include "status/device_lifecycle.h"
+#include "check.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// ===================================================================
+// RETAINED STATE TEST
+// ===================================================================
+//
+// The whole sketch (setup() and loop()) built with duty-cycled capture,
+// through a batch of deep sleeps: a client asks for a long interval,
+// the capture-only wakes store their photos, and the flush wake uploads
+// them. The retained block is as old as the last full boot by then; it
+// must not take a second photo of the scene the wake has just stored.
+//
+
+/**
+ * Sleep for one interval, then boot from the timer wake
+ * @return true if the device went back to sleep during setup()
+ */
+static bool timerWake() {
+    VirtualDevice::wakeFromSleep(ESP_SLEEP_WAKEUP_TIMER, (uint64_t)DUTY_CYCLE_MIN_INTERVAL_S * 1000000ULL);
+    return VirtualDevice::runSketch(true, 0);
+}
+
+static uint32_t framesCaptured() {
+    return VirtualDevice::stats()->frames_captured;
+}
+
+static void testFlushWake() {
+    // Cold boot; the client asks for an interval long enough to sleep through
+    CHECK(!VirtualDevice::runSketch(true, 0));
+    CHECK(!RetainedState::isWarmBoot());
+    VirtualDevice::connect();
+    uint8_t interval = DUTY_CYCLE_MIN_INTERVAL_S;
+    CHECK(VirtualDevice::writeCharacteristic(PHOTO_CONTROL_UUID, &interval, 1));
+    CHECK(VirtualDevice::runSketch(false, 20000000));
+    CHECK(RetainedState::get()->capturing_photos);
+    CHECK(DutyCycleCapture::getStoredPhotoCount() == 0);
+
+    for (int wake = 1; wake < DUTY_CYCLE_FLUSH_EVERY; wake++) {
+        CHECK(timerWake());
+    }
+    CHECK(DutyCycleCapture::getStoredPhotoCount() == DUTY_CYCLE_FLUSH_EVERY - 1);
+
+    // The flush wake stores its photo and carries on with the boot
+    CHECK(!timerWake());
+    CHECK(RetainedState::isWarmBoot() && DutyCycleCapture::isFlushWake());
+    CHECK(DutyCycleCapture::getStoredPhotoCount() == DUTY_CYCLE_FLUSH_EVERY);
+    CHECK(DeviceLifecycle::isIn(LIFECYCLE_PHOTO) && captureInterval == DUTY_CYCLE_MIN_INTERVAL_S * 1000);
+    CHECK(getElapsedTime(lastCaptureTime) < (unsigned long)captureInterval);
+
+    // The batch goes out and the device sleeps until the next photo is
+    // due, without taking another on the way
+    uint32_t frames = framesCaptured();
+    VirtualDevice::connect();
+    CHECK(VirtualDevice::runSketch(false, 20000000));
+    CHECK(framesCaptured() == frames);
+    CHECK(DutyCycleCapture::getStoredPhotoCount() == 0);
+}
+
+int main() {
+    VirtualDevice::setConsole(nullptr);
+    char fsDir[] = "/tmp/test_retained_state_XXXXXX";
+    CHECK(mkdtemp(fsDir) != nullptr);
+    VirtualDevice::setFsRoot(fsDir);
+    CHECK(VirtualDevice::loadJpegDir(SAMPLES_DIR) > 0);
+
+    testFlushWake();
+
+    return finishChecks("retained state");
+}
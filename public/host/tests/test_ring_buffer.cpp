@@ -0,0 +1,238 @@
+#include "virtual_device.h"
+#include "system/memory/ring_buffer.h"
+#include "system/cycles/cycle_manager.h"
+#include "check.h"
+#include <stdio.h>
+#include <deque>
+#include <thread>
+#include <vector>
+
+// ===================================================================
+// RING BUFFER TEST
+// ===================================================================
+//
+// RingBuffer<T, N> against a std::deque reference: single and batch
+// push/pop, spans at the wrap, overwriting histories, a ring drained by
+// a CYCLE_MODE_CIRCULAR_BUFFER cycle, and one producer thread against
+// one consumer thread (every element arrives once, in order).
+//
+
+static uint32_t rngState = 0x9E3779B9;
+
+static uint32_t nextRandom() {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+static_assert(RingBuffer<uint8_t, 16>::capacity() == 16, "capacity is N");
+
+static void testSingle() {
+    RingBuffer<int, 8> ring;
+    CHECK(ring.empty());
+    for (int i = 0; i < 8; i++) {
+        CHECK(ring.push(i));
+    }
+    CHECK(ring.full());
+    CHECK(!ring.push(8));
+    CHECK(ring.size() == 8);
+
+    int value = -1;
+    for (int i = 0; i < 8; i++) {
+        CHECK(ring.pop(&value) && value == i);
+    }
+    CHECK(!ring.pop(&value));
+    CHECK(ring.empty());
+
+    // Many times around the ring
+    for (int i = 0; i < 1000; i++) {
+        CHECK(ring.push(i));
+        CHECK(ring.push(-i));
+        CHECK(ring.pop(&value) && value == i);
+        CHECK(ring.pop(&value) && value == -i);
+    }
+    ring.push(1);
+    ring.clear();
+    CHECK(ring.empty());
+}
+
+static void testBatchAgainstReference() {
+    RingBuffer<uint32_t, 64> ring;
+    std::deque<uint32_t> reference;
+    uint32_t next = 0;
+    uint32_t in[100];
+    uint32_t out[100];
+    bool matches = true;
+
+    for (int round = 0; round < 20000; round++) {
+        size_t count = nextRandom() % 100;
+        if (nextRandom() % 2) {
+            for (size_t i = 0; i < count; i++) in[i] = next + i;
+            size_t pushed = ring.push(in, count);
+            size_t room = 64 - reference.size();
+            if (pushed != (count < room ? count : room)) matches = false;
+            for (size_t i = 0; i < pushed; i++) reference.push_back(next++);
+        } else {
+            size_t popped = ring.pop(out, count);
+            if (popped != (count < reference.size() ? count : reference.size())) matches = false;
+            for (size_t i = 0; i < popped; i++) {
+                if (out[i] != reference.front()) matches = false;
+                reference.pop_front();
+            }
+        }
+        if (ring.size() != reference.size()) matches = false;
+    }
+    CHECK(matches);
+    CHECK(next > 100000);                           // Wrapped many times
+}
+
+static void testSpans() {
+    RingBuffer<uint16_t, 16> ring;
+
+    // Move the position to 12 so the next fill wraps
+    uint16_t scratch[12];
+    CHECK(ring.push(scratch, 12) == 12);
+    CHECK(ring.pop(scratch, 12) == 12);
+
+    size_t count = 0;
+    uint16_t* write = ring.writeSpan(&count);
+    CHECK(write != nullptr && count == 4);          // Up to the end of the array
+    for (size_t i = 0; i < count; i++) write[i] = (uint16_t)(100 + i);
+    ring.commit(count);
+    write = ring.writeSpan(&count);
+    CHECK(count == 12);                             // From the start, up to the tail
+    for (size_t i = 0; i < 6; i++) write[i] = (uint16_t)(104 + i);
+    ring.commit(6);
+    CHECK(ring.size() == 10);
+
+    const uint16_t* read = ring.readSpan(&count);
+    CHECK(read != nullptr && count == 4);
+    CHECK(read[0] == 100 && read[3] == 103);
+    ring.consume(4);
+    read = ring.readSpan(&count);
+    CHECK(count == 6 && read[0] == 104 && read[5] == 109);
+    ring.consume(6);
+    CHECK(ring.readSpan(&count) == nullptr && count == 0);
+
+    // Full: no write span
+    for (int i = 0; i < 16; i++) ring.push((uint16_t)i);
+    CHECK(ring.writeSpan(&count) == nullptr && count == 0);
+}
+
+static void testOverwrite() {
+    // A history keeps the newest N readings
+    RingBuffer<float, 8> history;
+    for (int i = 1; i <= 5; i++) history.pushOverwrite(i * 1.0f);
+    CHECK(history.size() == 5);
+    CHECK(history.at(0) == 1.0f && history.at(4) == 5.0f);
+
+    for (int i = 6; i <= 20; i++) history.pushOverwrite(i * 1.0f);
+    CHECK(history.size() == 8);
+    CHECK(history.at(0) == 13.0f);
+    CHECK(history.at(7) == 20.0f);
+}
+
+static void testRingBufferCycle() {
+    initializeCycleManager();
+    static RingBuffer<int, 16> ring;
+    std::vector<int> received;
+    std::vector<size_t> spans;
+
+    int id = registerRingBufferCycle<int, 16>("drain", &ring, 4, [&](const int* items, size_t count) {
+        spans.push_back(count);
+        for (size_t i = 0; i < count; i++) received.push_back(items[i]);
+        ring.push(1000);                            // Pushed while draining: next pass
+    });
+    CHECK(id >= 0);
+
+    // Three waiting: below the batch, the cycle does not run
+    for (int i = 0; i < 3; i++) ring.push(i);
+    updateCycles();
+    CHECK(received.empty());
+    CHECK(getCycleStats(id)->execution_count == 0);
+
+    ring.push(3);
+    updateCycles();
+    CHECK(received.size() == 4 && received[3] == 3);
+    CHECK(spans.size() == 1);
+    CHECK(ring.size() == 1);                        // The element pushed from consume()
+
+    // Across the wrap: two spans in one run (5 elements so far, move to 10)
+    ring.clear();
+    int scratch[5];
+    ring.push(scratch, 5);
+    ring.pop(scratch, 5);
+    for (int i = 0; i < 10; i++) ring.push(100 + i);
+    received.clear();
+    spans.clear();
+    updateCycles();
+    CHECK(spans.size() == 2 && spans[0] == 6 && spans[1] == 4);
+    CHECK(received.size() == 10 && received[0] == 100 && received[9] == 109);
+    CHECK(getCycleStats(id)->execution_count == 2);
+
+    CHECK(unregisterCycle(id));
+}
+
+static void testTwoThreads() {
+    static RingBuffer<uint32_t, 256> ring;
+    const uint32_t COUNT = 2000000;
+
+    // Both sides yield when they cannot progress, for machines with one core
+    std::thread producer([&]() {
+        uint32_t next = 0;
+        uint32_t batch[32];
+        while (next < COUNT) {
+            uint32_t before = next;
+            if (next % 3 == 0) {
+                if (ring.push(next)) next++;
+            } else {
+                size_t count = 1 + next % 32;
+                if (count > COUNT - next) count = COUNT - next;
+                for (size_t i = 0; i < count; i++) batch[i] = next + (uint32_t)i;
+                next += (uint32_t)ring.push(batch, count);
+            }
+            if (next == before) std::this_thread::yield();
+        }
+    });
+
+    uint32_t expected = 0;
+    bool ordered = true;
+    while (expected < COUNT) {
+        uint32_t before = expected;
+        if (expected % 2 == 0) {
+            size_t count;
+            const uint32_t* span = ring.readSpan(&count);
+            for (size_t i = 0; i < count; i++) {
+                if (span[i] != expected + i) ordered = false;
+            }
+            expected += (uint32_t)count;
+            ring.consume(count);
+        } else {
+            uint32_t value;
+            if (ring.pop(&value)) {
+                if (value != expected) ordered = false;
+                expected++;
+            }
+        }
+        if (expected == before) std::this_thread::yield();
+    }
+    producer.join();
+
+    CHECK(ordered);
+    CHECK(expected == COUNT);
+    CHECK(ring.empty());
+}
+
+int main() {
+    VirtualDevice::setConsole(nullptr);
+
+    testSingle();
+    testBatchAgainstReference();
+    testSpans();
+    testOverwrite();
+    testRingBufferCycle();
+    testTwoThreads();
+
+    return finishChecks("ring buffer");
+}
@@ -0,0 +1,197 @@
+#include "virtual_device.h"
+#include "system/clock/timing.h"
+#include "system/clock/timer_service.h"
+#include "check.h"
+#include <stdio.h>
+
+// ===================================================================
+// TIMER SERVICE TEST
+// ===================================================================
+//
+// Drives TimerService on the virtual clock: one-shot, periodic and
+// deadline timers, stale handles after release and slot reuse, heap
+// order with every slot in use, and callbacks that touch their own
+// timer from inside update().
+//
+
+static void step(uint64_t us) {
+    VirtualDevice::advanceUs(us);
+    TimerService::update();
+}
+
+static void testOneShot() {
+    timer_handle_t timer = TimerService::createOneShot("one_shot", 100);
+    CHECK(timer != TIMER_HANDLE_NONE);
+    CHECK(TimerService::isArmed(timer));
+    CHECK(TimerService::remainingUs(timer) == 100000);
+
+    step(99000);
+    CHECK(!TimerService::consume(timer));
+    step(1000);
+    CHECK(!TimerService::isArmed(timer));
+    CHECK(TimerService::consume(timer));
+    CHECK(!TimerService::consume(timer));          // Once per firing
+
+    step(500000);
+    CHECK(!TimerService::consume(timer));          // Does not fire again
+
+    CHECK(TimerService::restart(timer));
+    step(100000);
+    CHECK(TimerService::consume(timer));
+
+    CHECK(TimerService::restart(timer));
+    CHECK(TimerService::cancel(timer));
+    step(200000);
+    CHECK(!TimerService::consume(timer));
+    CHECK(!TimerService::isArmed(timer));
+
+    TimerService::release(&timer);
+    CHECK(timer == TIMER_HANDLE_NONE);
+}
+
+static void testPeriodic() {
+    uint64_t start_us = monotonicMicros();
+    timer_handle_t timer = TimerService::createPeriodic("periodic", 50);
+    CHECK(TimerService::createPeriodic("zero", 0) == TIMER_HANDLE_NONE);
+
+    // Polled every 7 ms: 10 firings in 500 ms, phase stays on the 50 ms grid
+    int fired = 0;
+    for (int i = 0; i < 72; i++) {
+        step(7000);
+        if (TimerService::consume(timer)) fired++;
+    }
+    CHECK(fired == 10);
+    uint64_t next_us = TimerService::nextDeadlineUs();
+    CHECK((next_us - start_us) % 50000 == 0);
+
+    // A stalled loop: missed periods fire once, the grid is kept
+    step(230000);
+    CHECK(TimerService::consume(timer));
+    CHECK(!TimerService::consume(timer));
+    CHECK((TimerService::nextDeadlineUs() - start_us) % 50000 == 0);
+    CHECK(TimerService::remainingUs(timer) <= 50000);
+
+    TimerService::release(&timer);
+}
+
+static void testDeadline() {
+    uint64_t deadline_us = monotonicMicros() + 2500000ULL;
+    timer_handle_t timer = TimerService::createDeadline("deadline", deadline_us);
+    CHECK(TimerService::nextDeadlineUs() == deadline_us);
+
+    step(2499999);
+    CHECK(!TimerService::consume(timer));
+    step(1);
+    CHECK(TimerService::consume(timer));
+
+    // Already in the past: fires on the next update()
+    CHECK(TimerService::restart(timer, monotonicMicros() - 1000));
+    TimerService::update();
+    CHECK(TimerService::consume(timer));
+
+    TimerService::release(&timer);
+    CHECK(TimerService::nextDeadlineUs() == UINT64_MAX);
+}
+
+static void testStaleHandles() {
+    timer_handle_t first = TimerService::createOneShot("first", 10);
+    timer_handle_t copy = first;
+    TimerService::release(&first);
+
+    // The slot is reused; the old handle must not reach the new timer
+    timer_handle_t second = TimerService::createOneShot("second", 10);
+    CHECK(second != TIMER_HANDLE_NONE);
+    CHECK(second != copy);
+    CHECK((second & 0xFFFF) == (copy & 0xFFFF));
+
+    step(10000);
+    CHECK(!TimerService::consume(copy));
+    CHECK(!TimerService::restart(copy));
+    CHECK(!TimerService::cancel(copy));
+    CHECK(!TimerService::isArmed(copy));
+    TimerService::release(&copy);                   // Stale: a no-op
+    CHECK(TimerService::consume(second));
+
+    CHECK(!TimerService::consume(TIMER_HANDLE_NONE));
+    CHECK(!TimerService::consume(0xFFFF0000u | (MAX_SERVICE_TIMERS + 1)));
+    TimerService::release(&second);
+    CHECK(TimerService::getTimerCount() == 0);
+}
+
+static void testHeapOrder() {
+    // Every slot, created in scrambled order: they must fire in deadline order
+    timer_handle_t handles[MAX_SERVICE_TIMERS];
+    uint32_t delays[MAX_SERVICE_TIMERS];
+    for (int i = 0; i < MAX_SERVICE_TIMERS; i++) {
+        delays[i] = 10 + (uint32_t)((i * 7) % MAX_SERVICE_TIMERS) * 10;
+        handles[i] = TimerService::createOneShot("heap", delays[i]);
+        CHECK(handles[i] != TIMER_HANDLE_NONE);
+    }
+    CHECK(TimerService::getTimerCount() == MAX_SERVICE_TIMERS);
+    CHECK(TimerService::createOneShot("overflow", 10) == TIMER_HANDLE_NONE);
+
+    // Cancel and re-arm a few in the middle of the heap
+    CHECK(TimerService::cancel(handles[5]));
+    CHECK(TimerService::cancel(handles[11]));
+    CHECK(TimerService::restart(handles[5]));
+
+    int firedCount = 0;
+    bool ordered = true;
+    for (uint32_t ms = 1; ms <= 300; ms++) {
+        step(1000);
+        for (int i = 0; i < MAX_SERVICE_TIMERS; i++) {
+            if (TimerService::consume(handles[i])) {
+                firedCount++;
+                if (delays[i] != ms) ordered = false;
+            }
+        }
+    }
+    CHECK(firedCount == MAX_SERVICE_TIMERS - 1);
+    CHECK(ordered);
+
+    for (int i = 0; i < MAX_SERVICE_TIMERS; i++) {
+        TimerService::release(&handles[i]);
+    }
+    CHECK(TimerService::getTimerCount() == 0);
+}
+
+static int callbackRuns = 0;
+static timer_handle_t selfReleasing = TIMER_HANDLE_NONE;
+
+static void countCallback(void* arg) {
+    (*(int*)arg)++;
+}
+
+static void releaseSelf(void*) {
+    callbackRuns++;
+    TimerService::release(&selfReleasing);
+}
+
+static void testCallbacks() {
+    int periodicRuns = 0;
+    timer_handle_t periodic = TimerService::createPeriodic("callback", 20, countCallback, &periodicRuns);
+    selfReleasing = TimerService::createPeriodic("self_release", 30, releaseSelf);
+
+    step(100000);
+    CHECK(periodicRuns == 1);                       // One stall: fires once
+    for (int i = 0; i < 10; i++) step(20000);
+    CHECK(periodicRuns == 11);
+    CHECK(callbackRuns == 1);
+    CHECK(selfReleasing == TIMER_HANDLE_NONE);
+    CHECK(TimerService::getTimerCount() == 1);
+
+    TimerService::release(&periodic);
+}
+
+int main() {
+    VirtualDevice::setConsole(nullptr);
+
+    testOneShot();
+    testPeriodic();
+    testDeadline();
+    testStaleHandles();
+    testHeapOrder();
+    testCallbacks();
+
+    return finishChecks("timer service");
+}
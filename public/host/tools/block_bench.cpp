@@ -0,0 +1,197 @@
+#include "virtual_device.h"
+#include "features/camera/block_codec.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <chrono>
+#include <vector>
+
+// ===================================================================
+// BLOCK BENCH
+// ===================================================================
+//
+// The block codec (firmware/src/features/camera/block_codec.h) on the
+// simulator's desk scene: kernel throughput (16x16 SAD, 8x8 forward DCT,
+// 8x8 inverse DCT), then a run of frames coded as key frames every frame
+// next to conditional replenishment, with a BlockDecoder checking every
+// frame against the encoder's reference and the PSNR of what the client
+// sees.
+//
+//   block_bench [--frames N] [--size WxH] [--quality Q] [--threshold T]
+//               [--refresh R] [--seconds S]
+//
+
+typedef std::chrono::steady_clock bench_clock;
+
+static double secondsSince(bench_clock::time_point start) {
+    return std::chrono::duration<double>(bench_clock::now() - start).count();
+}
+
+// Keeps results alive so the timed loops are not optimized away
+static volatile uint32_t sink;
+
+/**
+ * Run kernel over the blocks of image until seconds have passed
+ * @return Blocks per second
+ */
+template <typename Kernel>
+static double timeKernel(double seconds, size_t blocks, Kernel kernel) {
+    bench_clock::time_point start = bench_clock::now();
+    size_t done = 0;
+    double elapsed = 0;
+    do {
+        for (size_t i = 0; i < blocks; i++) kernel(i);
+        done += blocks;
+        elapsed = secondsSince(start);
+    } while (elapsed < seconds);
+    return done / elapsed;
+}
+
+static void benchKernels(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b, size_t width,
+                         size_t height, double seconds) {
+    size_t blocksX = width / BLOCK_SIZE;
+    size_t blocks = blocksX * (height / BLOCK_SIZE);
+    size_t dctX = width / 8;
+    size_t dcts = dctX * (height / 8);
+    std::vector<uint8_t> out(a.size());
+    int32_t coefficients[64];
+    blockForwardDct8(&a[0], width, coefficients);
+
+    double sad = timeKernel(seconds, blocks, [&](size_t i) {
+        size_t offset = (i / blocksX) * BLOCK_SIZE * width + (i % blocksX) * BLOCK_SIZE;
+        sink += blockSad16(&a[offset], &b[offset], width);
+    });
+    double forward = timeKernel(seconds, dcts, [&](size_t i) {
+        size_t offset = (i / dctX) * 8 * width + (i % dctX) * 8;
+        blockForwardDct8(&a[offset], width, coefficients);
+        sink += (uint32_t)coefficients[0];
+    });
+    double inverse = timeKernel(seconds, dcts, [&](size_t i) {
+        size_t offset = (i / dctX) * 8 * width + (i % dctX) * 8;
+        coefficients[0] = (int32_t)i;
+        blockInverseDct8(coefficients, &out[offset], width);
+    });
+    sink += out[0];
+
+    printf("Kernels:\n");
+    printf("  sad 16x16      %8.2f M blocks/s  %6.1f ns/block\n", sad / 1e6, 1e9 / sad);
+    printf("  forward dct 8x8 %7.2f M blocks/s  %6.1f ns/block\n", forward / 1e6, 1e9 / forward);
+    printf("  inverse dct 8x8 %7.2f M blocks/s  %6.1f ns/block\n", inverse / 1e6, 1e9 / inverse);
+}
+
+static double psnr(const uint8_t* a, const uint8_t* b, size_t length) {
+    double sum = 0;
+    for (size_t i = 0; i < length; i++) {
+        double d = (double)a[i] - b[i];
+        sum += d * d;
+    }
+    if (sum == 0) return 99.0;
+    return 10 * log10(255.0 * 255.0 * length / sum);
+}
+
+int main(int argc, char** argv) {
+    unsigned frames = 150;
+    unsigned width = 160, height = 112;
+    unsigned quality = 50;
+    unsigned threshold = 2560;
+    unsigned refresh = 50;
+    double seconds = 0.5;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = (unsigned)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%ux%u", &width, &height) != 2) width = 0;
+        } else if (strcmp(argv[i], "--quality") == 0 && i + 1 < argc) {
+            quality = (unsigned)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold = (unsigned)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--refresh") == 0 && i + 1 < argc) {
+            refresh = (unsigned)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else {
+            fprintf(stderr,
+                    "usage: %s [--frames N] [--size WxH] [--quality Q] [--threshold T] [--refresh R] "
+                    "[--seconds S]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+    if (width == 0 || width % BLOCK_SIZE || height == 0 || height % BLOCK_SIZE || width > BLOCK_MAX_WIDTH ||
+        height > BLOCK_MAX_HEIGHT || quality < 1 || quality > 100 || frames == 0) {
+        fprintf(stderr, "--size must be multiples of 16 up to %ux%u, --quality 1..100, --frames > 0\n",
+                BLOCK_MAX_WIDTH, BLOCK_MAX_HEIGHT);
+        return 2;
+    }
+    VirtualDevice::setConsole(nullptr);
+
+    size_t pixels = (size_t)width * height;
+    std::vector<uint8_t> frame(pixels), previous(pixels);
+    VirtualDevice::renderDeskScene(&previous[0], width, height, 0);
+    VirtualDevice::renderDeskScene(&frame[0], width, height, 50);
+    benchKernels(frame, previous, width, height, seconds);
+
+    block_codec_config_t config;
+    config.width = (uint16_t)width;
+    config.height = (uint16_t)height;
+    config.quality = (uint8_t)quality;
+    config.sad_threshold = threshold;
+    config.refresh_frames = (uint16_t)refresh;
+
+    // Every block every frame: what the stream costs without replenishment
+    block_codec_config_t intraConfig = config;
+    intraConfig.sad_threshold = 0;
+    std::vector<uint8_t> intraReference(pixels);
+    BlockEncoder intra;
+    intra.begin(intraConfig, &intraReference[0]);
+
+    std::vector<uint8_t> reference(pixels), client(pixels);
+    BlockEncoder encoder;
+    BlockDecoder decoder;
+    encoder.begin(config, &reference[0]);
+    decoder.begin(config.width, config.height, &client[0]);
+
+    std::vector<uint8_t> coded(blockFrameMaxSize(config.width, config.height));
+    uint64_t intraBytes = 0;
+    size_t largest = 0;
+    unsigned matches = 0;
+    double psnrSum = 0, psnrMin = 99.0;
+    double encodeSeconds = 0;
+    for (unsigned i = 0; i < frames; i++) {
+        VirtualDevice::renderDeskScene(&frame[0], width, height, i);
+
+        intra.requestKeyFrame();
+        intraBytes += intra.encode(&frame[0], &coded[0], coded.size());
+
+        bench_clock::time_point start = bench_clock::now();
+        size_t length = encoder.encode(&frame[0], &coded[0], coded.size());
+        encodeSeconds += secondsSince(start);
+        if (length > largest) largest = length;
+
+        if (decoder.decode(&coded[0], length) && client == reference) matches++;
+        double p = psnr(&frame[0], &client[0], pixels);
+        psnrSum += p;
+        if (p < psnrMin) psnrMin = p;
+    }
+
+    const block_codec_stats_t& s = encoder.stats();
+    printf("Desk scene: %u frames at %ux%u, quality %u, threshold %u, refresh %u\n", frames, width, height,
+           quality, threshold, refresh);
+    printf("  every block:  %8llu bytes  %7.0f bytes/frame\n", (unsigned long long)intraBytes,
+           (double)intraBytes / frames);
+    printf("  replenished:  %8llu bytes  %7.0f bytes/frame  (largest %u, %u key frames)\n",
+           (unsigned long long)s.bytes, (double)s.bytes / frames, (unsigned)largest, s.key_frames);
+    printf("  blocks sent:  %u of %u (%.1f%%)\n", s.blocks_sent, s.blocks, 100.0 * s.blocks_sent / s.blocks);
+    printf("  reduction:    %.1fx\n", s.bytes ? (double)intraBytes / s.bytes : 0.0);
+    printf("  encode:       %.3f ms/frame\n", encodeSeconds * 1000 / frames);
+    printf("  psnr:         %.1f dB mean, %.1f dB worst frame\n", psnrSum / frames, psnrMin);
+    printf("  decoder:      %u/%u frames match the encoder reference\n", matches, frames);
+    if (matches != frames) {
+        printf("block bench: decoder and encoder reference diverged\n");
+        return 1;
+    }
+    printf("block bench: decoder matches encoder reference\n");
+    return 0;
+}
@@ -0,0 +1,199 @@
+#include "virtual_device.h"
+#include "features/camera/code_scanner.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// ===================================================================
+// CODE BENCH
+// ===================================================================
+//
+// The code scanner (firmware/src/features/camera/code_scanner.h) on
+// sample frames: QR codes of every level across versions 1-10 and EAN-13
+// barcodes, drawn by the reference encoders onto the desk scene at
+// random sizes, angles, tilt, lighting and noise, plus frames with no
+// code (the cost of the fallback to a photo). Reports the decode rate and
+// time per frame for each kind, and the bytes a scan notifies against
+// the JPEG it replaces. A wrong payload or a decode on a frame without a
+// code is a failure (exit status 1).
+//
+//   code_bench [--frames N] [--size WxH] [--seed S] [--jpeg-dir DIR]
+//
+
+typedef std::chrono::steady_clock bench_clock;
+
+typedef struct {
+    const char* name;
+    unsigned frames;
+    unsigned decoded;
+    unsigned wrong;
+    double totalMs;
+    double worstMs;
+    uint64_t payloadBytes;
+} kind_stats_t;
+
+static uint32_t nextRandom(uint32_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static double uniform(uint32_t* state, double low, double high) {
+    return low + (high - low) * (nextRandom(state) % 10000) / 10000.0;
+}
+
+/**
+ * Average size of the JPEG files in a directory (0 if none)
+ */
+static double averageJpegBytes(const char* dir) {
+    DIR* d = opendir(dir);
+    if (!d) return 0;
+    uint64_t total = 0;
+    unsigned count = 0;
+    while (struct dirent* entry = readdir(d)) {
+        const char* dot = strrchr(entry->d_name, '.');
+        if (!dot || (strcasecmp(dot, ".jpg") != 0 && strcasecmp(dot, ".jpeg") != 0)) continue;
+        FILE* fp = fopen((std::string(dir) + "/" + entry->d_name).c_str(), "rb");
+        if (!fp) continue;
+        fseek(fp, 0, SEEK_END);
+        total += (uint64_t)ftell(fp);
+        fclose(fp);
+        count++;
+    }
+    closedir(d);
+    return count ? (double)total / count : 0;
+}
+
+int main(int argc, char** argv) {
+    unsigned frames = 300, width = 640, height = 480, seed = 1;
+    const char* jpegDir = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = (unsigned)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%ux%u", &width, &height) != 2) width = 0;
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (unsigned)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--jpeg-dir") == 0 && i + 1 < argc) {
+            jpegDir = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [--frames N] [--size WxH] [--seed S] [--jpeg-dir DIR]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (width < 320 || height < 240 || width > 1024 || height > 1024 || frames == 0) {
+        fprintf(stderr, "--size must be 320x240 to 1024x1024, --frames at least 1\n");
+        return 2;
+    }
+    VirtualDevice::setConsole(nullptr);
+
+    kind_stats_t kinds[3] = {
+        {"QR", 0, 0, 0, 0, 0, 0},
+        {"EAN-13", 0, 0, 0, 0, 0, 0},
+        {"no code", 0, 0, 0, 0, 0, 0},
+    };
+    std::vector<uint8_t> frame((size_t)width * height), modules;
+    static code_result_t result;
+    uint32_t state = seed * 2654435761U + 1;
+    unsigned versions[QR_MAX_VERSION + 1] = {0};
+
+    for (unsigned n = 0; n < frames; n++) {
+        VirtualDevice::renderDeskScene(&frame[0], width, height, n);
+        int kind = n % 5 < 3 ? 0 : (n % 5 == 3 ? 1 : 2);
+        std::string expected;
+
+        VirtualDevice::code_placement_t p = VirtualDevice::defaultCodePlacement();
+        p.centerX = width * uniform(&state, 0.4, 0.6);
+        p.centerY = height * uniform(&state, 0.4, 0.6);
+        p.angle = uniform(&state, 0, 360);
+        p.tilt = uniform(&state, 0, 0.08);
+        p.noise = (int)(nextRandom(&state) % 9);
+        p.gradient = (int)uniform(&state, -50, 50);
+        p.dark = 30 + (int)(nextRandom(&state) % 40);
+        p.light = 170 + (int)(nextRandom(&state) % 60);
+        p.seed = n;
+
+        if (kind == 0) {
+            int level = (int)(nextRandom(&state) % 4);
+            size_t length = 4 + nextRandom(&state) % (200 / (level + 1));
+            for (size_t i = 0; i < length; i++) expected += (char)(' ' + nextRandom(&state) % 95);
+            int dimension = VirtualDevice::encodeQr(expected, level, (int)(nextRandom(&state) % 8), &modules);
+            versions[(dimension - 17) / 4]++;
+            // Fill 30-70% of the frame height
+            p.moduleSize = height * uniform(&state, 0.3, 0.7) / (dimension + 8);
+            if (p.moduleSize < 2.5) p.moduleSize = 2.5;
+            VirtualDevice::drawCode(&frame[0], width, height, modules, dimension, dimension, p);
+        } else if (kind == 1) {
+            for (int i = 0; i < 12; i++) expected += (char)('0' + nextRandom(&state) % 10);
+            VirtualDevice::encodeEan13(expected, &modules);
+            int sum = 0;
+            for (int i = 0; i < 12; i++) sum += (expected[i] - '0') * (i % 2 ? 3 : 1);
+            expected += (char)('0' + (10 - sum % 10) % 10);
+            // Mostly along the rows or columns, as a barcode is held up
+            p.angle = (nextRandom(&state) % 4) * 90 + uniform(&state, -10, 10);
+            p.moduleSize = width * uniform(&state, 0.35, 0.6) / 113;
+            p.rowsPerModule = 40;
+            p.quietZone = 9;
+            VirtualDevice::drawCode(&frame[0], width, height, modules, (int)modules.size(), 1, p);
+        }
+
+        bench_clock::time_point start = bench_clock::now();
+        bool decoded = codeScan(&frame[0], (uint16_t)width, (uint16_t)height, width, &result);
+        double ms = std::chrono::duration<double, std::milli>(bench_clock::now() - start).count();
+
+        kind_stats_t& k = kinds[kind];
+        k.frames++;
+        k.totalMs += ms;
+        if (ms > k.worstMs) k.worstMs = ms;
+        if (!decoded) continue;
+        bool right = kind != 2 && result.length == expected.size() &&
+                     memcmp(result.payload, expected.data(), expected.size()) == 0;
+        if (right) {
+            k.decoded++;
+            k.payloadBytes += result.length;
+        } else {
+            k.wrong++;
+        }
+    }
+
+    printf("Code scanner: %u frames %ux%u (seed %u), QR versions", frames, width, height, seed);
+    for (int v = QR_MIN_VERSION; v <= QR_MAX_VERSION; v++) {
+        if (versions[v]) printf(" %d:%u", v, versions[v]);
+    }
+    printf("\n\n%-8s %7s %8s %6s %9s %9s %10s\n", "kind", "frames", "decoded", "wrong", "ms/frame", "worst ms",
+           "bytes/scan");
+    unsigned wrong = 0;
+    uint64_t payloadBytes = 0;
+    unsigned decodedTotal = 0;
+    for (int i = 0; i < 3; i++) {
+        const kind_stats_t& k = kinds[i];
+        if (!k.frames) continue;
+        printf("%-8s %7u %7.1f%% %6u %9.2f %9.2f %10.1f\n", k.name, k.frames, 100.0 * k.decoded / k.frames, k.wrong,
+               k.totalMs / k.frames, k.worstMs, k.decoded ? (double)k.payloadBytes / k.decoded : 0.0);
+        wrong += k.wrong;
+        payloadBytes += k.payloadBytes;
+        decodedTotal += k.decoded;
+    }
+
+    if (jpegDir) {
+        double jpeg = averageJpegBytes(jpegDir);
+        if (jpeg > 0 && decodedTotal) {
+            double scan = (double)payloadBytes / decodedTotal;
+            printf("\nA decoded scan notifies %.0f bytes for a %.0f-byte photo (%.0fx less)\n", scan, jpeg,
+                   jpeg / scan);
+        }
+    }
+
+    if (wrong) {
+        printf("code bench: %u wrong or false decodes\n", wrong);
+        return 1;
+    }
+    printf("code bench: no false decodes\n");
+    return 0;
+}
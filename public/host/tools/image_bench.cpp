@@ -0,0 +1,186 @@
+#include "virtual_device.h"
+#include "features/camera/image_kernels.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <chrono>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define IMAGE_BENCH_TSC
+#endif
+
+// ===================================================================
+// IMAGE BENCH
+// ===================================================================
+//
+// Throughput of the image kernels (firmware/src/features/camera/
+// image_kernels.h), the build's vector version next to the scalar one, on
+// the virtual camera's desk scene. Reports megapixels per second and, on
+// x86, pixels per TSC cycle (the TSC counts at the nominal clock, so this
+// is approximate under turbo). Every vector result is compared with the
+// scalar one (exit status 1 on a difference).
+//
+//   image_bench [--size WxH] [--seconds S]
+//
+
+typedef std::chrono::steady_clock bench_clock;
+
+// Keeps results alive so the timed loops are not optimized away
+static volatile uint64_t sink;
+
+typedef struct {
+    double pixelsPerSecond;
+    double pixelsPerCycle;      // 0 without a cycle counter
+} rate_t;
+
+static inline uint64_t cycles() {
+#ifdef IMAGE_BENCH_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Run kernel (one pass over pixelsPerRun pixels) until seconds have passed
+ */
+template <typename Kernel>
+static rate_t timeKernel(double seconds, size_t pixelsPerRun, Kernel kernel) {
+    bench_clock::time_point start = bench_clock::now();
+    uint64_t startCycles = cycles();
+    size_t runs = 0;
+    double elapsed = 0;
+    do {
+        kernel();
+        runs++;
+        elapsed = std::chrono::duration<double>(bench_clock::now() - start).count();
+    } while (elapsed < seconds);
+    uint64_t spent = cycles() - startCycles;
+
+    rate_t rate;
+    rate.pixelsPerSecond = (double)runs * pixelsPerRun / elapsed;
+    rate.pixelsPerCycle = spent ? (double)runs * pixelsPerRun / spent : 0;
+    return rate;
+}
+
+static void report(const char* name, rate_t fast, rate_t slow) {
+    printf("%-16s %9.1f Mpx/s", name, fast.pixelsPerSecond / 1e6);
+    if (fast.pixelsPerCycle > 0) printf(" %6.2f px/cycle", fast.pixelsPerCycle);
+    printf("   scalar %8.1f Mpx/s", slow.pixelsPerSecond / 1e6);
+    if (slow.pixelsPerCycle > 0) printf(" %6.2f px/cycle", slow.pixelsPerCycle);
+    printf("   %5.1fx\n", fast.pixelsPerSecond / slow.pixelsPerSecond);
+}
+
+int main(int argc, char** argv) {
+    unsigned width = 640, height = 480;
+    double seconds = 0.5;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%ux%u", &width, &height) != 2) width = 0;
+        } else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [--size WxH] [--seconds S]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (width < 16 || height < 16 || width > 4096 || height > 4096) {
+        fprintf(stderr, "--size must be 16x16 to 4096x4096\n");
+        return 2;
+    }
+    VirtualDevice::setConsole(nullptr);
+
+    size_t pixels = (size_t)width * height;
+    std::vector<uint8_t> frame(pixels), previous(pixels);
+    VirtualDevice::renderDeskScene(&previous[0], width, height, 0);
+    VirtualDevice::renderDeskScene(&frame[0], width, height, 50);
+    std::vector<uint8_t> rgb565(pixels * 2);
+    for (size_t i = 0; i < pixels; i++) {
+        uint16_t pixel = (uint16_t)(((frame[i] >> 3) << 11) | ((previous[i] >> 2) << 5) | (frame[i] >> 3));
+        rgb565[2 * i] = (uint8_t)(pixel >> 8);
+        rgb565[2 * i + 1] = (uint8_t)pixel;
+    }
+    std::vector<uint8_t> outFast(pixels), outSlow(pixels);
+    size_t blocksX = width / 16, blocks = blocksX * (height / 16);
+    bool match = true;
+
+    printf("Image kernels: %s, %ux%u desk scene, %.2f s per run\n", imageKernelsBackend(), width, height, seconds);
+
+    // SAD over every 16x16 block
+    uint64_t sadFast = 0, sadSlow = 0;
+    rate_t fast = timeKernel(seconds, blocks * 256, [&]() {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < blocks; i++) {
+            size_t offset = (i / blocksX) * 16 * width + (i % blocksX) * 16;
+            sum += imageSad16(&frame[offset], &previous[offset], width);
+        }
+        sadFast = sum;
+    });
+    rate_t slow = timeKernel(seconds, blocks * 256, [&]() {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < blocks; i++) {
+            size_t offset = (i / blocksX) * 16 * width + (i % blocksX) * 16;
+            sum += imageSad16Scalar(&frame[offset], &previous[offset], width);
+        }
+        sadSlow = sum;
+    });
+    report("sad 16x16", fast, slow);
+    match &= sadFast == sadSlow;
+
+    // Source pixels read
+    fast = timeKernel(seconds, pixels, [&]() {
+        imageDownscale2x(&frame[0], width, width, height, &outFast[0], width / 2);
+    });
+    slow = timeKernel(seconds, pixels, [&]() {
+        imageDownscale2xScalar(&frame[0], width, width, height, &outSlow[0], width / 2);
+    });
+    report("downscale 2x", fast, slow);
+    match &= outFast == outSlow;
+
+    fast = timeKernel(seconds, pixels, [&]() { imageRgb565ToGray(&rgb565[0], pixels, &outFast[0]); });
+    slow = timeKernel(seconds, pixels, [&]() { imageRgb565ToGrayScalar(&rgb565[0], pixels, &outSlow[0]); });
+    report("rgb565 to gray", fast, slow);
+    match &= outFast == outSlow;
+
+    // rgb565 doubles as YUV422: two bytes per pixel
+    fast = timeKernel(seconds, pixels, [&]() { imageYuv422ToGray(&rgb565[0], pixels, &outFast[0]); });
+    slow = timeKernel(seconds, pixels, [&]() { imageYuv422ToGrayScalar(&rgb565[0], pixels, &outSlow[0]); });
+    report("yuv422 to gray", fast, slow);
+    match &= outFast == outSlow;
+
+    uint32_t histogramFast[256], histogramSlow[256];
+    fast = timeKernel(seconds, pixels, [&]() {
+        memset(histogramFast, 0, sizeof(histogramFast));
+        imageHistogram(&frame[0], width, width, height, histogramFast);
+    });
+    slow = timeKernel(seconds, pixels, [&]() {
+        memset(histogramSlow, 0, sizeof(histogramSlow));
+        imageHistogramScalar(&frame[0], width, width, height, histogramSlow);
+    });
+    report("histogram", fast, slow);
+    match &= memcmp(histogramFast, histogramSlow, sizeof(histogramFast)) == 0;
+
+    uint64_t sharpFast = 0, sharpSlow = 0;
+    fast = timeKernel(seconds, pixels, [&]() { sharpFast = imageSharpness(&frame[0], width, width, height); });
+    slow = timeKernel(seconds, pixels, [&]() { sharpSlow = imageSharpnessScalar(&frame[0], width, width, height); });
+    report("sharpness", fast, slow);
+    match &= sharpFast == sharpSlow;
+
+    uint64_t energyFast[4], energySlow[4];
+    fast = timeKernel(seconds, pixels, [&]() { imageDirectionalSharpness(&frame[0], width, width, height, energyFast); });
+    slow = timeKernel(seconds, pixels, [&]() {
+        imageDirectionalSharpnessScalar(&frame[0], width, width, height, energySlow);
+    });
+    report("directional sharpness", fast, slow);
+    match &= memcmp(energyFast, energySlow, sizeof(energyFast)) == 0;
+
+    sink = sadFast + sharpFast + outFast[0] + histogramFast[0];
+    if (!match) {
+        printf("image bench: vector and scalar results differ\n");
+        return 1;
+    }
+    printf("image bench: vector and scalar results match\n");
+    return 0;
+}
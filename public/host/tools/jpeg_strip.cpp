@@ -0,0 +1,184 @@
+#include "stream_reassembly.h"
+#include "features/bluetooth/ble_frame_format.h"
+#include "features/camera/jpeg_header.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// ===================================================================
+// JPEG STRIP
+// ===================================================================
+//
+// What JPEG_HEADER_COMPACTION saves on real captures, and proof that the
+// client gets every image back byte for byte:
+//
+//   jpeg_strip --jpeg-dir public/tests --images 30
+//
+// The captures are sent in turn as one stream of --images images, through
+// the firmware's JpegHeaderCompactor and the photo chunking, into the
+// host ImageReassembler that puts the cached headers back. Each rebuilt
+// image is compared with its capture.
+//
+
+typedef struct {
+    std::string name;
+    std::vector<uint8_t> data;
+} capture_t;
+
+typedef struct {
+    const std::vector<capture_t>* captures;
+    size_t next;                // Capture expected next
+    uint32_t exact;
+    uint32_t mismatches;
+} reconstruction_t;
+
+static bool isJpegName(const char* name) {
+    const char* dot = strrchr(name, '.');
+    return dot && (strcasecmp(dot, ".jpg") == 0 || strcasecmp(dot, ".jpeg") == 0);
+}
+
+static bool loadFile(const std::string& path, std::vector<uint8_t>* data) {
+    FILE* fp = fopen(path.c_str(), "rb");
+    if (!fp) return false;
+    uint8_t buffer[4096];
+    size_t n;
+    data->clear();
+    while ((n = fread(buffer, 1, sizeof(buffer), fp)) > 0) data->insert(data->end(), buffer, buffer + n);
+    fclose(fp);
+    return true;
+}
+
+static bool loadCaptures(const char* dir, std::vector<capture_t>* captures) {
+    DIR* d = opendir(dir);
+    if (!d) return false;
+    std::vector<std::string> names;
+    while (struct dirent* entry = readdir(d)) {
+        if (isJpegName(entry->d_name)) names.push_back(entry->d_name);
+    }
+    closedir(d);
+    std::sort(names.begin(), names.end());
+
+    for (size_t i = 0; i < names.size(); i++) {
+        capture_t capture;
+        capture.name = names[i];
+        if (!loadFile(std::string(dir) + "/" + names[i], &capture.data)) continue;
+        captures->push_back(capture);
+    }
+    return true;
+}
+
+static void checkImage(void* ctx, uint32_t number, const uint8_t* data, size_t length, bool complete) {
+    (void)number;
+    reconstruction_t* check = (reconstruction_t*)ctx;
+    const capture_t& capture = (*check->captures)[check->next++ % check->captures->size()];
+    if (complete && length == capture.data.size() && memcmp(data, &capture.data[0], length) == 0) {
+        check->exact++;
+    } else {
+        check->mismatches++;
+        fprintf(stderr, "jpeg_strip: %s came back as %u bytes%s\n", capture.name.c_str(), (unsigned)length,
+                complete ? "" : " (incomplete)");
+    }
+}
+
+static void usage(const char* argv0) {
+    fprintf(stderr,
+            "Usage: %s --jpeg-dir DIR [options]\n"
+            "  --images N         Images in the stream, captures in turn (default 30)\n"
+            "  --refresh N        Whole image at least every N (default 30, as the firmware; 0 = never)\n"
+            "  --chunk N          Bytes per notification after the frame header (default 400)\n",
+            argv0);
+}
+
+int main(int argc, char** argv) {
+    const char* dir = nullptr;
+    size_t images = 30;
+    uint16_t refresh = 30;
+    size_t chunk = 400;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) { usage(argv[0]); return 0; }
+        if (!value) { usage(argv[0]); return 2; }
+        i++;
+
+        if (strcmp(arg, "--jpeg-dir") == 0) dir = value;
+        else if (strcmp(arg, "--images") == 0) images = strtoul(value, nullptr, 10);
+        else if (strcmp(arg, "--refresh") == 0) refresh = (uint16_t)strtoul(value, nullptr, 10);
+        else if (strcmp(arg, "--chunk") == 0) chunk = strtoul(value, nullptr, 10);
+        else { usage(argv[0]); return 2; }
+    }
+    if (!dir || images == 0 || chunk == 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::vector<capture_t> captures;
+    if (!loadCaptures(dir, &captures) || captures.empty()) {
+        fprintf(stderr, "jpeg_strip: no JPEGs in %s\n", dir);
+        return 1;
+    }
+
+    printf("=== JPEG Header Compaction ===\n");
+    for (size_t i = 0; i < captures.size(); i++) {
+        const std::vector<uint8_t>& data = captures[i].data;
+        size_t header = jpegHeaderLength(&data[0], data.size());
+        if (header == 0) {
+            printf("%-40s %6u bytes, no baseline header (sent whole)\n", captures[i].name.c_str(),
+                   (unsigned)data.size());
+            continue;
+        }
+        printf("%-40s %6u bytes, header %u (%.1f%%), table %08x\n", captures[i].name.c_str(),
+               (unsigned)data.size(), (unsigned)header, 100.0 * header / data.size(),
+               (unsigned)jpegHeaderId(&data[0], header));
+    }
+
+    // Stream the captures as the DataTransmission cycle does
+    JpegHeaderCompactor compactor(refresh);
+    ImageReassembler reassembler(BLE_FRAME_TYPE_PHOTO);
+    reconstruction_t check = {&captures, 0, 0, 0};
+    reassembler.setCallback(checkImage, &check);
+
+    std::vector<uint8_t> packet(BLE_FRAME_HEADER_SIZE + chunk);
+    uint64_t plainBytes = 0, wireBytes = 0;
+    uint32_t plainPackets = 0, wirePackets = 0;
+    for (size_t n = 0; n < images; n++) {
+        const std::vector<uint8_t>& data = captures[n % captures.size()].data;
+        compactor.plan(&data[0], data.size(), 1);
+
+        size_t total = compactor.length(data.size());
+        uint16_t index = 0;
+        for (size_t sent = 0; sent < total; index++) {
+            bleWriteFrameHeader(&packet[0], index, BLE_FRAME_TYPE_PHOTO);
+            size_t length = compactor.read(&data[0], data.size(), sent, &packet[BLE_FRAME_HEADER_SIZE], chunk);
+            reassembler.push(&packet[0], BLE_FRAME_HEADER_SIZE + length);
+            sent += length;
+            wireBytes += BLE_FRAME_HEADER_SIZE + length;
+            wirePackets++;
+        }
+        bleWriteEndMarker(&packet[0], BLE_FRAME_TYPE_PHOTO);
+        reassembler.push(&packet[0], BLE_FRAME_HEADER_SIZE);
+        wireBytes += BLE_FRAME_HEADER_SIZE;
+        wirePackets++;
+
+        plainPackets += (uint32_t)((data.size() + chunk - 1) / chunk) + 1;
+        plainBytes += data.size() + BLE_FRAME_HEADER_SIZE * ((data.size() + chunk - 1) / chunk + 1);
+    }
+    reassembler.flush();
+
+    const jpeg_compaction_stats_t& c = compactor.stats();
+    const image_stream_stats_t& r = reassembler.stats();
+    printf("Stream: %u images, %u compact, %u whole (refresh %u)\n", c.images, c.compacted, c.headers,
+           (unsigned)refresh);
+    printf("Wire: %llu -> %llu bytes (%.1f%% saved), %u -> %u notifications\n", (unsigned long long)plainBytes,
+           (unsigned long long)wireBytes, plainBytes ? 100.0 * (plainBytes - wireBytes) / plainBytes : 0.0,
+           plainPackets, wirePackets);
+    printf("Client: %u images rebuilt from cached headers, %u with unknown tables\n", r.compacted, r.unknown_tables);
+    printf("Reconstruction: %u images byte-exact, %u mismatches\n", check.exact, check.mismatches);
+    return check.mismatches == 0 && check.exact == images ? 0 : 1;
+}
@@ -0,0 +1,215 @@
+#include "ble_link_model.h"
+#include "packet_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// ===================================================================
+// LINK SWEEP
+// ===================================================================
+//
+// Replays the notifications of a packet log (recorded without the link
+// model, so its timestamps are the firmware's send times) through every
+// combination of the given link parameters and prints goodput, latency
+// and drops per stream for each.
+//
+//   link_sweep --log packets.log --interval 7.5,15,30,50 --ppe 2,4,6
+//              --mtu 185,247,517 --phy 1M,2M --loss 0,0.02
+//
+// With --backpressure block, time a send waits for queue space delays
+// every later send, as a blocked notify() would stall the firmware loop.
+//
+
+static const char* STREAM_NAMES[] = {"audio", "photo", "device_status", "video", "video_status", "hotspot_status", "battery"};
+static const size_t STREAM_COUNT = sizeof(STREAM_NAMES) / sizeof(STREAM_NAMES[0]);
+
+typedef struct {
+    uint64_t time_us;
+    uint8_t stream;
+    std::vector<uint8_t> data;
+} offered_packet_t;
+
+static uint8_t streamId(const std::string& name) {
+    for (size_t i = 0; i < STREAM_COUNT; i++) {
+        if (name == STREAM_NAMES[i]) return (uint8_t)i;
+    }
+    return BLE_LINK_MAX_STREAMS - 1;
+}
+
+static bool parseList(const char* text, std::vector<double>* out) {
+    out->clear();
+    const char* p = text;
+    while (*p) {
+        char* end;
+        double value = strtod(p, &end);
+        if (end == p) return false;
+        out->push_back(value);
+        p = *end == ',' ? end + 1 : end;
+        if (*end != ',' && *end != '\0') return false;
+    }
+    return !out->empty();
+}
+
+static bool parsePhyList(const char* text, std::vector<ble_phy_t>* out) {
+    out->clear();
+    std::string list(text);
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t comma = list.find(',', start);
+        std::string item = list.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        ble_phy_t phy;
+        if (!BleLinkModel::parsePhy(item.c_str(), &phy)) return false;
+        out->push_back(phy);
+        if (comma == std::string::npos) break;
+        start = comma + 1;
+    }
+    return !out->empty();
+}
+
+static void usage(const char* argv0) {
+    fprintf(stderr,
+            "Usage: %s --log FILE [options]\n"
+            "  --interval LIST       Connection intervals in ms (default 30)\n"
+            "  --ppe LIST            LL PDUs per connection event (default 6)\n"
+            "  --mtu LIST            ATT MTU (default 247)\n"
+            "  --ll-octets LIST      LL payload per PDU (default 251)\n"
+            "  --phy LIST            1M, 2M, S2, S8 (default 1M)\n"
+            "  --loss LIST           PDU error rate (default 0)\n"
+            "  --burst IN,OUT,P      Burst loss for every run (default off)\n"
+            "  --queue LIST          Notification queue depth (default 20)\n"
+            "  --backpressure MODE   drop (default) or block\n"
+            "  --seed N              Loss random seed (default 1)\n"
+            "  --stream NAME         Only report this stream\n",
+            argv0);
+}
+
+int main(int argc, char** argv) {
+    const char* logPath = nullptr;
+    const char* onlyStream = nullptr;
+    ble_link_config_t base = BleLinkModel::defaultConfig();
+    std::vector<double> intervals(1, base.conn_interval_ms);
+    std::vector<double> ppes(1, base.packets_per_event);
+    std::vector<double> mtus(1, base.mtu);
+    std::vector<double> llOctets(1, base.ll_octets);
+    std::vector<double> losses(1, base.loss);
+    std::vector<double> queues(1, base.queue_packets);
+    std::vector<ble_phy_t> phys(1, base.phy);
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0 || !value) {
+            usage(argv[0]);
+            return strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0 ? 0 : 2;
+        }
+        i++;
+
+        bool ok = true;
+        if (strcmp(arg, "--log") == 0) logPath = value;
+        else if (strcmp(arg, "--interval") == 0) ok = parseList(value, &intervals);
+        else if (strcmp(arg, "--ppe") == 0) ok = parseList(value, &ppes);
+        else if (strcmp(arg, "--mtu") == 0) ok = parseList(value, &mtus);
+        else if (strcmp(arg, "--ll-octets") == 0) ok = parseList(value, &llOctets);
+        else if (strcmp(arg, "--phy") == 0) ok = parsePhyList(value, &phys);
+        else if (strcmp(arg, "--loss") == 0) ok = parseList(value, &losses);
+        else if (strcmp(arg, "--queue") == 0) ok = parseList(value, &queues);
+        else if (strcmp(arg, "--burst") == 0)
+            ok = sscanf(value, "%f,%f,%f", &base.burst_enter, &base.burst_exit, &base.burst_loss) == 3;
+        else if (strcmp(arg, "--backpressure") == 0) {
+            base.block_when_full = strcmp(value, "block") == 0;
+            ok = base.block_when_full || strcmp(value, "drop") == 0;
+        } else if (strcmp(arg, "--seed") == 0) base.seed = (uint32_t)strtoul(value, nullptr, 10);
+        else if (strcmp(arg, "--stream") == 0) onlyStream = value;
+        else ok = false;
+
+        if (!ok) {
+            fprintf(stderr, "link_sweep: bad option %s %s\n", arg, value);
+            return 2;
+        }
+    }
+
+    if (!logPath) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    // Offered load
+    PacketLogReader reader;
+    if (!reader.open(logPath)) {
+        fprintf(stderr, "link_sweep: cannot open %s\n", logPath);
+        return 1;
+    }
+    std::vector<offered_packet_t> offered;
+    packet_record_t record;
+    while (reader.next(&record)) {
+        offered_packet_t packet = {record.time_us, streamId(record.stream), record.data};
+        offered.push_back(packet);
+    }
+    if (offered.empty()) {
+        fprintf(stderr, "link_sweep: no packets in %s\n", logPath);
+        return 1;
+    }
+    uint64_t start_us = offered.front().time_us;
+    uint64_t end_us = offered.back().time_us;
+    fprintf(stderr, "link_sweep: %u packets over %.1f s\n", (unsigned)offered.size(), (end_us - start_us) / 1e6);
+
+    printf("%9s %4s %4s %4s %3s %6s %6s %-14s %8s %7s %7s %12s %8s %8s %8s %9s\n",
+           "interval", "ppe", "mtu", "ll", "phy", "loss", "queue", "stream",
+           "deliv", "drop", "trunc", "goodput B/s", "p50 ms", "p99 ms", "max ms", "stall ms");
+
+    size_t runs = 0;
+    for (size_t a = 0; a < intervals.size(); a++)
+    for (size_t b = 0; b < ppes.size(); b++)
+    for (size_t c = 0; c < mtus.size(); c++)
+    for (size_t d = 0; d < llOctets.size(); d++)
+    for (size_t e = 0; e < phys.size(); e++)
+    for (size_t f = 0; f < losses.size(); f++)
+    for (size_t g = 0; g < queues.size(); g++) {
+        ble_link_config_t config = base;
+        config.conn_interval_ms = (float)intervals[a];
+        config.packets_per_event = (uint8_t)ppes[b];
+        config.mtu = (uint16_t)mtus[c];
+        config.ll_octets = (uint16_t)llOctets[d];
+        config.phy = phys[e];
+        config.loss = (float)losses[f];
+        config.queue_packets = (uint16_t)queues[g];
+
+        BleLinkModel link(config);
+        link.connect(start_us);
+
+        // Blocked sends push the rest of the trace back
+        uint64_t shift = 0;
+        for (size_t i = 0; i < offered.size(); i++) {
+            const offered_packet_t& packet = offered[i];
+            uint64_t now = packet.time_us + shift;
+            link.service(now);
+            if (link.send(packet.stream, now, packet.data.data(), packet.data.size()) == BLE_LINK_FULL) {
+                uint64_t ready = link.waitForSpace(packet.stream, now);
+                shift += ready - now;
+                link.send(packet.stream, ready, packet.data.data(), packet.data.size());
+            }
+        }
+        link.service(end_us + shift);
+        double elapsed_s = (end_us + shift - start_us) / 1e6;
+
+        for (uint8_t s = 0; s < BLE_LINK_MAX_STREAMS; s++) {
+            const ble_link_stream_stats_t& stats = link.streamStats(s);
+            if (stats.queued == 0) continue;
+            const char* name = s < STREAM_COUNT ? STREAM_NAMES[s] : "other";
+            if (onlyStream && strcmp(onlyStream, name) != 0) continue;
+            printf("%9.2f %4u %4u %4u %3s %6.3f %6u %-14s %8u %7u %7u %12.1f %8.1f %8.1f %8.1f %9.1f\n",
+                   config.conn_interval_ms, config.packets_per_event, config.mtu, link.getConfig().ll_octets,
+                   BleLinkModel::phyName(config.phy), config.loss, config.queue_packets, name,
+                   stats.delivered, stats.dropped, stats.truncated,
+                   elapsed_s > 0 ? stats.bytes_delivered / elapsed_s : 0.0,
+                   link.latencyPercentile(s, 50) / 1000.0, link.latencyPercentile(s, 99) / 1000.0,
+                   link.latencyPercentile(s, 100) / 1000.0, stats.blocked_us / 1000.0);
+        }
+        runs++;
+    }
+
+    fprintf(stderr, "link_sweep: %u configurations\n", (unsigned)runs);
+    return 0;
+}
@@ -0,0 +1,161 @@
+#include "virtual_device.h"
+#include "features/camera/image_pyramid.h"
+#include "features/camera/image_kernels.h"
+#include "features/camera/photo_hash.h"
+#include <img_converters.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+// ===================================================================
+// PYRAMID BENCH
+// ===================================================================
+//
+// The pyramid photo path (firmware/src/features/camera/image_pyramid.h)
+// on the virtual camera's desk scene: building all levels in one pass
+// from a grayscale and a YUV422 frame, against three separate halving
+// passes; then, per level, the JPEG encode time and size (fmt2jpg, the
+// simulator's encoder on the host). For comparison it times what the
+// JPEG path needs for the same analysis input: a shrunk luma decode of
+// the full-size JPEG. Every level must equal repeated imageDownscale2x
+// (exit status 1 otherwise).
+//
+//   pyramid_bench [--size WxH] [--seconds S] [--quality Q]
+//
+
+typedef std::chrono::steady_clock bench_clock;
+
+/**
+ * Mean time of run() in microseconds, repeated until seconds have passed
+ */
+template <typename Run>
+static double timeRun(double seconds, Run run) {
+    bench_clock::time_point start = bench_clock::now();
+    size_t runs = 0;
+    double elapsed = 0;
+    do {
+        run();
+        runs++;
+        elapsed = std::chrono::duration<double>(bench_clock::now() - start).count();
+    } while (elapsed < seconds);
+    return elapsed * 1e6 / runs;
+}
+
+static bool sameLevels(const image_pyramid_t& a, const image_pyramid_t& b) {
+    for (int k = 0; k < IMAGE_PYRAMID_LEVELS; k++) {
+        const image_level_t& x = a.level[k];
+        const image_level_t& y = b.level[k];
+        if (x.width != y.width || x.height != y.height) return false;
+        for (size_t row = 0; row < x.height; row++) {
+            if (memcmp(x.pixels + row * x.stride, y.pixels + row * y.stride, x.width) != 0) return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    unsigned width = 640, height = 480, quality = 80;
+    double seconds = 0.5;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%ux%u", &width, &height) != 2) width = 0;
+        } else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--quality") == 0 && i + 1 < argc) {
+            quality = (unsigned)atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [--size WxH] [--seconds S] [--quality Q]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (width < 16 || height < 16 || width > 4096 || height > 4096 || quality < 1 || quality > 100) {
+        fprintf(stderr, "--size must be 16x16 to 4096x4096, --quality 1-100\n");
+        return 2;
+    }
+    VirtualDevice::setConsole(nullptr);
+
+    size_t pixels = (size_t)width * height;
+    std::vector<uint8_t> gray(pixels), yuv(pixels * 2);
+    VirtualDevice::renderDeskScene(&gray[0], width, height, 20);
+    for (size_t i = 0; i < pixels; i++) {
+        yuv[2 * i] = gray[i];
+        yuv[2 * i + 1] = 128;
+    }
+    std::vector<uint8_t> grayStorage(imagePyramidSize(width, height, false));
+    std::vector<uint8_t> yuvStorage(imagePyramidSize(width, height, true));
+    std::vector<uint8_t> passStorage(grayStorage.size());
+
+    printf("Pyramid: %s, %ux%u desk scene, levels", imageKernelsBackend(), width, height);
+    for (int k = 0; k < IMAGE_PYRAMID_LEVELS; k++) printf(" %ux%u", width >> k, height >> k);
+    printf("\n\n");
+
+    // Build: one pass (grayscale, YUV422) against a pass per level
+    image_pyramid_t fromGray, fromYuv, byPasses;
+    double grayUs = timeRun(seconds, [&]() {
+        imagePyramidBuild(&gray[0], width, height, false, &grayStorage[0], grayStorage.size(), &fromGray);
+    });
+    double yuvUs = timeRun(seconds, [&]() {
+        imagePyramidBuild(&yuv[0], width, height, true, &yuvStorage[0], yuvStorage.size(), &fromYuv);
+    });
+    double passesUs = timeRun(seconds, [&]() {
+        byPasses.level[0] = {&gray[0], (uint16_t)width, (uint16_t)height, width};
+        uint8_t* next = &passStorage[0];
+        for (int k = 1; k < IMAGE_PYRAMID_LEVELS; k++) {
+            const image_level_t& above = byPasses.level[k - 1];
+            image_level_t& level = byPasses.level[k];
+            level = {next, (uint16_t)(above.width / 2), (uint16_t)(above.height / 2), (size_t)(above.width / 2)};
+            imageDownscale2x(above.pixels, above.stride, above.width, above.height, next, level.stride);
+            next += (size_t)level.width * level.height;
+        }
+    });
+    printf("build                        us/frame   Mpx/s\n");
+    printf("  one pass, grayscale      %10.1f %7.1f\n", grayUs, pixels / grayUs);
+    printf("  one pass, YUV422         %10.1f %7.1f\n", yuvUs, pixels / yuvUs);
+    printf("  pass per level           %10.1f %7.1f\n", passesUs, pixels / passesUs);
+    printf("  storage: %u bytes grayscale, %u YUV422 (frame %u / %u)\n\n", (unsigned)grayStorage.size(),
+           (unsigned)yuvStorage.size(), (unsigned)pixels, (unsigned)pixels * 2);
+    bool match = sameLevels(fromGray, byPasses) && sameLevels(fromYuv, byPasses);
+
+    // Encode each level as the pyramid photo does
+    printf("encode (quality %u)    size       us   bytes\n", quality);
+    size_t fullLength = 0;
+    std::vector<uint8_t> full;
+    for (int k = 0; k < IMAGE_PYRAMID_LEVELS; k++) {
+        const image_level_t& level = fromGray.level[k];
+        uint8_t* jpeg = nullptr;
+        size_t length = 0;
+        double us = timeRun(seconds / IMAGE_PYRAMID_LEVELS, [&]() {
+            free(jpeg);
+            jpeg = nullptr;
+            fmt2jpg((uint8_t*)level.pixels, (size_t)level.width * level.height, level.width, level.height,
+                    PIXFORMAT_GRAYSCALE, (uint8_t)quality, &jpeg, &length);
+        });
+        printf("  level %d           %4ux%-4u %8.1f %7u\n", k, level.width, level.height, us, (unsigned)length);
+        if (k == 0 && jpeg) {
+            full.assign(jpeg, jpeg + length);
+            fullLength = length;
+        }
+        free(jpeg);
+        match &= length > 0;
+    }
+
+    // The JPEG path: the same 1/4 luma from the full-size JPEG
+    if (fullLength) {
+        std::vector<uint8_t> shrunk((size_t)(width + 7) / 8 * 2 * ((height + 7) / 8 * 2));
+        uint16_t w = 0, h = 0;
+        bool decoded = false;
+        double us = timeRun(seconds, [&]() {
+            decoded = jpegLumaDownscale(&full[0], full.size(), 4, &shrunk[0], shrunk.size(), &w, &h);
+        });
+        printf("\n1/4 luma from the level 0 JPEG: %.1f us (%s)\n", us, decoded ? "jpegLumaDownscale" : "failed");
+    }
+
+    if (!match) {
+        printf("pyramid bench: levels DIFFER from repeated halving\n");
+        return 1;
+    }
+    printf("pyramid bench: one pass matches repeated halving\n");
+    return 0;
+}
@@ -0,0 +1,239 @@
+#include "virtual_device.h"
+#include "features/camera/photo_quality.h"
+#include "check.h"
+#include <dirent.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// ===================================================================
+// QUALITY BENCH
+// ===================================================================
+//
+// The photo quality gate (firmware/src/features/camera/photo_quality.h)
+// on desk scene JPEGs with motion blur of known length at random angles,
+// and underexposed and overexposed ones. For each shrink factor it
+// reports the sharpness of each kind, the threshold halfway (geometric)
+// between the sharp frames and those blurred by --blur-limit pixels or
+// more, and the time per score. Then it runs the defaults (those of
+// constants.h unless overridden) and the JPEGs in --jpeg-dir: a sharp,
+// well exposed frame rejected, or one blurred past the limit or clipped
+// accepted, is a failure (exit status 1).
+//
+//   quality_bench [--frames N] [--size WxH] [--quality Q] [--blur-limit PX]
+//                 [--factor F] [--min-sharpness S] [--jpeg-dir DIR]
+//
+
+typedef std::chrono::steady_clock bench_clock;
+
+typedef struct {
+    const char* name;
+    double blur;                // Motion blur length in pixels
+    double gain;                // Exposure
+    uint8_t clipped;            // Exposure flag the gate should raise
+} scene_kind_t;
+
+static const scene_kind_t KINDS[] = {
+    {"sharp", 0, 1.0, 0},
+    {"blur 2 px", 2, 1.0, 0},
+    {"blur 4 px", 4, 1.0, 0},
+    {"blur 6 px", 6, 1.0, 0},
+    {"blur 8 px", 8, 1.0, 0},
+    {"blur 12 px", 12, 1.0, 0},
+    {"blur 16 px", 16, 1.0, 0},
+    {"dark", 0, 0.12, PHOTO_QUALITY_DARK},
+    {"bright", 0, 2.6, PHOTO_QUALITY_BRIGHT},
+};
+static const int KIND_COUNT = sizeof(KINDS) / sizeof(KINDS[0]);
+
+static uint32_t nextRandom(uint32_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+/**
+ * Motion blur of the given length along angle (radians), then exposure
+ * gain and fresh sensor noise, as the sensor would see it
+ */
+static void expose(const std::vector<uint8_t>& scene, size_t width, size_t height, double length, double angle,
+                   double gain, uint32_t* state, std::vector<uint8_t>* out) {
+    out->resize(scene.size());
+    int taps = length < 1 ? 1 : (int)ceil(length) + 1;
+    double dx = cos(angle), dy = sin(angle);
+    for (size_t y = 0; y < height; y++) {
+        for (size_t x = 0; x < width; x++) {
+            double sum = 0;
+            for (int i = 0; i < taps; i++) {
+                double t = taps == 1 ? 0 : (i / (double)(taps - 1) - 0.5) * length;
+                long sx = lround(x + t * dx), sy = lround(y + t * dy);
+                sx = sx < 0 ? 0 : sx >= (long)width ? (long)width - 1 : sx;
+                sy = sy < 0 ? 0 : sy >= (long)height ? (long)height - 1 : sy;
+                sum += scene[sy * width + sx];
+            }
+            int value = (int)lround(sum / taps * gain) + (int)(nextRandom(state) % 5) - 2;
+            (*out)[y * width + x] = (uint8_t)(value < 0 ? 0 : value > 255 ? 255 : value);
+        }
+    }
+}
+
+static const char* flagNames(uint8_t flags) {
+    static char text[32];
+    text[0] = 0;
+    if (flags & PHOTO_QUALITY_BLURRY) strcat(text, " blurry");
+    if (flags & PHOTO_QUALITY_DARK) strcat(text, " dark");
+    if (flags & PHOTO_QUALITY_BRIGHT) strcat(text, " bright");
+    return flags ? text + 1 : "ok";
+}
+
+int main(int argc, char** argv) {
+    unsigned frames = 40, width = 320, height = 240, quality = 80;
+    double blurLimit = 6;
+    // constants.h: PHOTO_QUALITY_FACTOR, _MIN_SHARPNESS, _DARK_LEVEL, _BRIGHT_LEVEL, _MAX_CLIPPED_PERCENT
+    photo_quality_config_t config = {0, 140, 16, 240, 25};
+    const char* jpegDir = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = (unsigned)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%ux%u", &width, &height) != 2) width = 0;
+        } else if (strcmp(argv[i], "--quality") == 0 && i + 1 < argc) {
+            quality = (unsigned)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--blur-limit") == 0 && i + 1 < argc) {
+            blurLimit = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--factor") == 0 && i + 1 < argc) {
+            config.factor = (uint8_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--min-sharpness") == 0 && i + 1 < argc) {
+            config.min_sharpness = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--jpeg-dir") == 0 && i + 1 < argc) {
+            jpegDir = argv[++i];
+        } else {
+            fprintf(stderr,
+                    "usage: %s [--frames N] [--size WxH] [--quality Q] [--blur-limit PX] [--factor F] "
+                    "[--min-sharpness S] [--jpeg-dir DIR]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+    if (width < 80 || height < 64 || width > 1600 || height > 1200 || frames == 0 || quality < 1 || quality > 100 ||
+        (config.factor != 0 && config.factor != 2 && config.factor != 4 && config.factor != 8)) {
+        fprintf(stderr,
+                "--size must be 80x64 to 1600x1200, --frames at least 1, --quality 1-100, --factor 0 (auto), 2, 4 or 8\n");
+        return 2;
+    }
+    VirtualDevice::setConsole(nullptr);
+
+    // Room for factor 2 at any --size
+    static uint8_t work[800 * 600];
+
+    // Every frame of every kind, encoded once
+    std::vector<std::vector<uint8_t> > jpegs[KIND_COUNT];
+    std::vector<uint8_t> scene((size_t)width * height), exposed;
+    uint32_t state = 12345;
+    uint64_t jpegBytes = 0;
+    for (unsigned n = 0; n < frames; n++) {
+        VirtualDevice::renderDeskScene(&scene[0], width, height, n * 7);
+        double angle = (nextRandom(&state) % 3600) * M_PI / 1800;
+        for (int k = 0; k < KIND_COUNT; k++) {
+            // Blur lengths are at 320x240; larger frames blur by as many of their pixels
+            double length = KINDS[k].blur * width / 320;
+            expose(scene, width, height, length, angle, KINDS[k].gain, &state, &exposed);
+            jpegs[k].push_back(std::vector<uint8_t>());
+            VirtualDevice::encodeJpeg(&exposed[0], width, height, (int)quality, 0, &jpegs[k].back());
+            jpegBytes += jpegs[k].back().size();
+        }
+    }
+    printf("Photo quality: %u frames %ux%u per kind, JPEG quality %u (%.0f bytes average), blur limit %.0f px\n",
+           frames, width, height, quality, (double)jpegBytes / (frames * KIND_COUNT), blurLimit);
+
+    // Sharpness of each kind at each factor
+    for (uint8_t factor = 2; factor <= 8; factor *= 2) {
+        photo_quality_config_t probe = config;
+        probe.factor = factor;
+        printf("\nfactor %u %-11s %9s %9s %9s\n", factor, "", "min", "median", "max");
+        double sharpMin = 1e18, blurredMax = 0, seconds = 0;
+        unsigned scored = 0;
+        for (int k = 0; k < KIND_COUNT; k++) {
+            std::vector<uint32_t> values;
+            for (size_t i = 0; i < jpegs[k].size(); i++) {
+                photo_quality_t q;
+                bench_clock::time_point start = bench_clock::now();
+                bool ok = photoQualityJpeg(&jpegs[k][i][0], jpegs[k][i].size(), probe, work, sizeof(work), &q);
+                seconds += std::chrono::duration<double>(bench_clock::now() - start).count();
+                scored++;
+                if (ok) values.push_back(q.sharpness);
+            }
+            if (values.empty()) continue;
+            std::sort(values.begin(), values.end());
+            printf("  %-18s %9u %9u %9u\n", KINDS[k].name, values.front(), values[values.size() / 2], values.back());
+            if (KINDS[k].clipped) continue;
+            if (KINDS[k].blur == 0 && values.front() < sharpMin) sharpMin = values.front();
+            if (KINDS[k].blur >= blurLimit && values.back() > blurredMax) blurredMax = values.back();
+        }
+        printf("  threshold %.0f (sharp / blurred %.2fx), %.1f us per score\n", sqrt(sharpMin * blurredMax),
+               blurredMax > 0 ? sharpMin / blurredMax : 0.0, seconds * 1e6 / scored);
+    }
+
+    // The gate as configured
+    printf("\nGate: factor %s, min sharpness %u, clipped at <= %u or >= %u over %u%%\n",
+           config.factor ? (config.factor == 2 ? "2" : config.factor == 4 ? "4" : "8") : "auto", config.min_sharpness,
+           config.dark_level, config.bright_level, config.max_clipped_percent);
+    unsigned wrong = 0;
+    for (int k = 0; k < KIND_COUNT; k++) {
+        unsigned flagged = 0, mistaken = 0;
+        for (size_t i = 0; i < jpegs[k].size(); i++) {
+            photo_quality_t q;
+            if (!photoQualityJpeg(&jpegs[k][i][0], jpegs[k][i].size(), config, work, sizeof(work), &q)) {
+                mistaken++;
+                continue;
+            }
+            if (q.flags) flagged++;
+            uint8_t exposure = q.flags & (PHOTO_QUALITY_DARK | PHOTO_QUALITY_BRIGHT);
+            bool blurry = (q.flags & PHOTO_QUALITY_BLURRY) != 0;
+            if (exposure != KINDS[k].clipped) {
+                mistaken++;
+            } else if (!KINDS[k].clipped && KINDS[k].blur == 0 && blurry) {
+                mistaken++;
+            } else if (!KINDS[k].clipped && KINDS[k].blur >= blurLimit && !blurry) {
+                mistaken++;
+            }
+        }
+        printf("  %-18s %5.1f%% rejected%s\n", KINDS[k].name, 100.0 * flagged / jpegs[k].size(),
+               mistaken ? " (WRONG)" : "");
+        wrong += mistaken;
+    }
+
+    if (jpegDir) {
+        DIR* d = opendir(jpegDir);
+        if (d) {
+            printf("\n%-40s %6s %9s %4s %5s %6s %6s\n", "sample", "factor", "sharpness", "dir", "mean", "dark", "bright");
+            while (struct dirent* entry = readdir(d)) {
+                const char* dot = strrchr(entry->d_name, '.');
+                if (!dot || (strcasecmp(dot, ".jpg") != 0 && strcasecmp(dot, ".jpeg") != 0)) continue;
+                std::vector<uint8_t> jpeg = readFile((std::string(jpegDir) + "/" + entry->d_name).c_str());
+                photo_quality_t q;
+                if (jpeg.empty() || !photoQualityJpeg(&jpeg[0], jpeg.size(), config, work, sizeof(work), &q)) {
+                    printf("%-40s not a baseline JPEG\n", entry->d_name);
+                    continue;
+                }
+                printf("%-40s %6u %9u %4u %5u %5u%% %5u%%  %s\n", entry->d_name, q.factor, q.sharpness, q.direction,
+                       q.mean, q.dark_percent, q.bright_percent, flagNames(q.flags));
+            }
+            closedir(d);
+        }
+    }
+
+    if (wrong) {
+        printf("quality bench: %u frames on the wrong side of the gate\n", wrong);
+        return 1;
+    }
+    printf("quality bench: every frame on the right side of the gate\n");
+    return 0;
+}
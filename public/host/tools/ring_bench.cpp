@@ -0,0 +1,191 @@
+#include "system/memory/ring_buffer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+// ===================================================================
+// RING BENCH
+// ===================================================================
+//
+// Throughput of the firmware's RingBuffer<T, N> with one producer thread
+// and one consumer thread, for single push()/pop(), batch push()/pop()
+// and readSpan()/consume(), next to a mutex-guarded std::deque. Elements
+// are 4-byte words and 40-byte records (an encoded audio frame header
+// plus payload pointer, roughly).
+//
+//   ring_bench [--seconds S] [--batch B]
+//
+
+typedef struct {
+    uint32_t sequence;
+    uint32_t payload[9];
+} record_t;
+
+static const size_t RING_SIZE = 1024;
+
+typedef std::chrono::steady_clock bench_clock;
+
+static double secondsSince(bench_clock::time_point start) {
+    return std::chrono::duration<double>(bench_clock::now() - start).count();
+}
+
+template <typename T>
+static void setSequence(T* item, uint32_t sequence);
+template <>
+void setSequence<uint32_t>(uint32_t* item, uint32_t sequence) { *item = sequence; }
+template <>
+void setSequence<record_t>(record_t* item, uint32_t sequence) { item->sequence = sequence; }
+
+template <typename T>
+static uint32_t getSequence(const T& item);
+template <>
+uint32_t getSequence<uint32_t>(const uint32_t& item) { return item; }
+template <>
+uint32_t getSequence<record_t>(const record_t& item) { return item.sequence; }
+
+typedef enum {
+    MODE_SINGLE,
+    MODE_BATCH,
+    MODE_SPAN,
+    MODE_MUTEX_DEQUE
+} bench_mode_t;
+
+static const char* MODE_NAMES[] = {"single", "batch", "span", "mutex deque"};
+
+/**
+ * Run producer and consumer for a while
+ * @return Elements per second (0 if an element arrived out of order)
+ */
+template <typename T>
+static double runBench(bench_mode_t mode, double seconds, size_t batch) {
+    static RingBuffer<T, RING_SIZE> ring;
+    static std::deque<T> deque;
+    static std::mutex dequeMutex;
+    ring.clear();
+    deque.clear();
+
+    std::atomic<bool> stop(false);
+    uint32_t produced = 0;
+
+    std::thread producer([&]() {
+        T items[RING_SIZE];
+        memset(items, 0, sizeof(items));
+        uint32_t next = 0;
+        while (!stop) {
+            uint32_t before = next;
+            switch (mode) {
+                case MODE_SINGLE:
+                    setSequence(&items[0], next);
+                    if (ring.push(items[0])) next++;
+                    break;
+                case MODE_BATCH:
+                case MODE_SPAN:
+                    for (size_t i = 0; i < batch; i++) setSequence(&items[i], next + (uint32_t)i);
+                    next += (uint32_t)ring.push(items, batch);
+                    break;
+                case MODE_MUTEX_DEQUE: {
+                    std::lock_guard<std::mutex> lock(dequeMutex);
+                    if (deque.size() < RING_SIZE) {
+                        setSequence(&items[0], next++);
+                        deque.push_back(items[0]);
+                    }
+                    break;
+                }
+            }
+            // Full: let the consumer run (matters with fewer cores than threads)
+            if (next == before) std::this_thread::yield();
+        }
+        produced = next;
+    });
+
+    bench_clock::time_point start = bench_clock::now();
+    uint32_t expected = 0;
+    bool ordered = true;
+    T items[RING_SIZE];
+    while (secondsSince(start) < seconds) {
+        for (int spin = 0; spin < 1024; spin++) {
+            uint32_t before = expected;
+            switch (mode) {
+                case MODE_SINGLE:
+                    if (ring.pop(&items[0])) {
+                        ordered &= getSequence(items[0]) == expected++;
+                    }
+                    break;
+                case MODE_BATCH: {
+                    size_t count = ring.pop(items, batch);
+                    for (size_t i = 0; i < count; i++) ordered &= getSequence(items[i]) == expected++;
+                    break;
+                }
+                case MODE_SPAN: {
+                    size_t count;
+                    const T* span = ring.readSpan(&count);
+                    for (size_t i = 0; i < count; i++) ordered &= getSequence(span[i]) == expected++;
+                    ring.consume(count);
+                    break;
+                }
+                case MODE_MUTEX_DEQUE: {
+                    std::lock_guard<std::mutex> lock(dequeMutex);
+                    if (!deque.empty()) {
+                        ordered &= getSequence(deque.front()) == expected++;
+                        deque.pop_front();
+                    }
+                    break;
+                }
+            }
+            if (expected == before) std::this_thread::yield();
+        }
+    }
+    double elapsed = secondsSince(start);
+    stop = true;
+    producer.join();
+
+    if (!ordered || expected > produced) return 0;
+    return expected / elapsed;
+}
+
+template <typename T>
+static bool benchType(const char* type_name, double seconds, size_t batch) {
+    bool ok = true;
+    for (int mode = MODE_SINGLE; mode <= MODE_MUTEX_DEQUE; mode++) {
+        double rate = runBench<T>((bench_mode_t)mode, seconds, batch);
+        printf("%-9s %-12s %8.2f M items/s  %8.1f MB/s\n", type_name, MODE_NAMES[mode],
+               rate / 1e6, rate * sizeof(T) / 1e6);
+        if (rate == 0) ok = false;
+    }
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    double seconds = 1.0;
+    size_t batch = 32;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            batch = (size_t)atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [--seconds S] [--batch B]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (batch < 1 || batch > RING_SIZE) {
+        fprintf(stderr, "--batch must be 1..%u\n", (unsigned)RING_SIZE);
+        return 2;
+    }
+
+    printf("RingBuffer<T, %u>, 1 producer + 1 consumer thread, batch %u, %.1f s per run\n",
+           (unsigned)RING_SIZE, (unsigned)batch, seconds);
+    bool ok = benchType<uint32_t>("uint32_t", seconds, batch);
+    ok &= benchType<record_t>("record_t", seconds, batch);
+    if (!ok) {
+        printf("ring bench: elements out of order\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,252 @@
+#include "packet_log.h"
+#include "stream_reassembly.h"
+#include "features/bluetooth/ble_frame_format.h"
+#include "features/camera/code_scanner.h"
+#include "features/camera/photo_hash.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <chrono>
+#include <string>
+
+// ===================================================================
+// STREAM DECODE
+// ===================================================================
+//
+// Reassembles the audio, photo and video streams of a packet log (from
+// virtual_device --log or a capture script) and reports what was lost:
+//
+//   stream_decode --log packets.log --out capture/
+//
+// writes capture/audio.wav, capture/photo_0000.jpg, ... and
+// capture/video_0000.jpg, .... Block video frames (BLE_FRAME_TYPE_BLOCKS)
+// are written as they were coded, capture/blocks_0000.blk, .... Scanned
+// codes (BLE_FRAME_TYPE_CODE, on the photo characteristic) are printed
+// and written as text, capture/code_0000.txt, ....
+// Incomplete images are written with a _partial suffix.
+//
+
+typedef struct {
+    const char* dir;
+    const char* prefix;
+    const char* extension;
+    uint32_t written;
+    bool quiet;
+    const ImageReassembler* source;     // For the start header's hash
+    bool hashed;
+    uint64_t lastHash;
+} image_output_t;
+
+static void writeImage(void* ctx, uint32_t number, const uint8_t* data, size_t length, bool complete) {
+    image_output_t* output = (image_output_t*)ctx;
+    if (!output->dir) return;
+
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s_%04u%s.%s", output->dir, output->prefix, (unsigned)number,
+             complete ? "" : "_partial", output->extension);
+    FILE* fp = fopen(path, "wb");
+    if (!fp) {
+        fprintf(stderr, "stream_decode: cannot write %s\n", path);
+        return;
+    }
+    if (length) fwrite(data, 1, length, fp);
+    fclose(fp);
+    output->written++;
+    if (output->quiet) return;
+    printf("%s: %u bytes%s", path, (unsigned)length, complete ? "" : " (incomplete)");
+    uint64_t hash;
+    if (output->source && output->source->startHash(&hash)) {
+        printf(", hash %016llx", (unsigned long long)hash);
+        if (output->hashed) printf(" (%d bits from the last)", photoHashDistance(hash, output->lastHash));
+        output->hashed = true;
+        output->lastHash = hash;
+    }
+    uint8_t flags = output->source ? output->source->startFlags() : 0;
+    if (flags & BLE_PHOTO_START_SCORED) {
+        if (!(flags & (BLE_PHOTO_START_BLURRY | BLE_PHOTO_START_DARK | BLE_PHOTO_START_BRIGHT))) printf(", quality ok");
+        if (flags & BLE_PHOTO_START_BLURRY) printf(", blurry");
+        if (flags & BLE_PHOTO_START_DARK) printf(", dark");
+        if (flags & BLE_PHOTO_START_BRIGHT) printf(", bright");
+    }
+    printf("\n");
+}
+
+static void writeCode(void* ctx, uint32_t number, const uint8_t* data, size_t length, bool complete) {
+    image_output_t* output = (image_output_t*)ctx;
+    if (!complete) {
+        writeImage(ctx, number, data, length, complete);
+        return;
+    }
+    // [symbology] + text
+    if (!output->quiet) {
+        printf("code %u: %s \"%.*s\"\n", (unsigned)number, data[0] == CODE_SYMBOLOGY_QR ? "QR" : "EAN-13", (int)(length - 1),
+               (const char*)data + 1);
+    }
+    writeImage(ctx, number, data + 1, length - 1, complete);
+}
+
+static void printImageStats(const char* name, const image_stream_stats_t& s) {
+    if (s.packets == 0) return;
+    printf("%-6s %u packets, %u images (%u complete), %llu bytes\n", name, s.packets, s.images, s.complete,
+           (unsigned long long)s.bytes);
+    printf("       missing chunks %u, duplicates %u, out of order %u, unterminated %u, stray end markers %u, malformed %u\n",
+           s.missing_chunks, s.duplicates, s.out_of_order, s.unterminated, s.stray_end_markers, s.malformed);
+    if (s.compacted > 0 || s.unknown_tables > 0) {
+        printf("       %u compact (%llu bytes received), %u with unknown tables\n", s.compacted,
+               (unsigned long long)s.wire_bytes, s.unknown_tables);
+    }
+    if (s.start_headers > 0) printf("       %u start headers (hash and length)\n", s.start_headers);
+}
+
+static void usage(const char* argv0) {
+    fprintf(stderr,
+            "Usage: %s --log FILE [options]\n"
+            "  --out DIR          Write audio.wav and images here (default: report only)\n"
+            "  --codec CODEC      pcm, mulaw (default) or opus, as built into the firmware\n"
+            "  --rate HZ          Sample rate (default: the firmware's rate for the codec)\n"
+            "  --reorder N        Audio frames held back to reorder late packets (default 4)\n"
+            "  --no-conceal       Leave gaps out of the audio instead of filling them with silence\n"
+            "  --quiet            Only print the summary\n",
+            argv0);
+}
+
+int main(int argc, char** argv) {
+    const char* logPath = nullptr;
+    const char* outDir = nullptr;
+    audio_codec_t codec = AUDIO_CODEC_MULAW;
+    uint32_t rate = 0;
+    size_t reorder = 4;
+    bool conceal = true;
+    bool quiet = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (strcmp(arg, "--no-conceal") == 0) { conceal = false; continue; }
+        if (strcmp(arg, "--quiet") == 0) { quiet = true; continue; }
+        if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) { usage(argv[0]); return 0; }
+        if (!value) { usage(argv[0]); return 2; }
+        i++;
+
+        bool ok = true;
+        if (strcmp(arg, "--log") == 0) logPath = value;
+        else if (strcmp(arg, "--out") == 0) outDir = value;
+        else if (strcmp(arg, "--codec") == 0) ok = AudioDecoder::parseCodec(value, &codec);
+        else if (strcmp(arg, "--rate") == 0) rate = (uint32_t)strtoul(value, nullptr, 10);
+        else if (strcmp(arg, "--reorder") == 0) reorder = strtoul(value, nullptr, 10);
+        else ok = false;
+
+        if (!ok) {
+            fprintf(stderr, "stream_decode: bad option %s %s\n", arg, value);
+            return 2;
+        }
+    }
+    if (!logPath) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if (outDir && mkdir(outDir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "stream_decode: cannot create %s\n", outDir);
+        return 1;
+    }
+
+    PacketLogReader reader;
+    if (!reader.open(logPath)) {
+        fprintf(stderr, "stream_decode: cannot open %s\n", logPath);
+        return 1;
+    }
+
+    std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+
+    AudioReassembler audio(reorder);
+    AudioDecoder decoder(codec, rate);
+    decoder.setConcealment(conceal);
+    audio.setCallbacks(AudioDecoder::onFrame, AudioDecoder::onGap, &decoder);
+
+    image_output_t photoOut = {outDir, "photo", "jpg", 0, quiet, nullptr, false, 0};
+    image_output_t videoOut = {outDir, "video", "jpg", 0, quiet, nullptr, false, 0};
+    image_output_t blocksOut = {outDir, "blocks", "blk", 0, quiet, nullptr, false, 0};
+    image_output_t codesOut = {outDir, "code", "txt", 0, quiet, nullptr, false, 0};
+    ImageReassembler photos(BLE_FRAME_TYPE_PHOTO);
+    ImageReassembler video(BLE_FRAME_TYPE_VIDEO);
+    ImageReassembler blocks(BLE_FRAME_TYPE_BLOCKS);
+    photos.setCallback(writeImage, &photoOut);
+    photoOut.source = &photos;
+    video.setCallback(writeImage, &videoOut);
+    ImageReassembler codes(BLE_FRAME_TYPE_CODE);
+    blocks.setCallback(writeImage, &blocksOut);
+    codes.setCallback(writeCode, &codesOut);
+
+    packet_record_t record;
+    uint64_t firstUs = 0, lastUs = 0;
+    uint32_t records = 0, other = 0;
+    while (reader.next(&record)) {
+        if (records++ == 0) firstUs = record.time_us;
+        lastUs = record.time_us;
+        const uint8_t* data = record.data.empty() ? nullptr : &record.data[0];
+
+        if (record.stream == "audio") audio.push(data, record.data.size());
+        else if (record.stream == "photo") {
+            // A code scan answers on the photo characteristic with its own type
+            bool isCode = record.data.size() >= BLE_FRAME_HEADER_SIZE && data[2] == BLE_FRAME_TYPE_CODE;
+            (isCode ? codes : photos).push(data, record.data.size());
+        }
+        else if (record.stream == "video") {
+            // Both video modes share the characteristic; the header says which
+            bool isBlocks = record.data.size() >= BLE_FRAME_HEADER_SIZE && data[2] == BLE_FRAME_TYPE_BLOCKS;
+            (isBlocks ? blocks : video).push(data, record.data.size());
+        }
+        else other++;
+    }
+    audio.flush();
+    photos.flush();
+    video.flush();
+    blocks.flush();
+    codes.flush();
+
+    double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+
+    // Outputs
+    const audio_stream_stats_t& a = audio.stats();
+    std::string audioPath;
+    if (outDir && a.frames > 0) {
+        if (AudioDecoder::canDecode(codec)) {
+            audioPath = std::string(outDir) + "/audio.wav";
+            if (!decoder.writeWav(audioPath.c_str())) fprintf(stderr, "stream_decode: cannot write %s\n", audioPath.c_str());
+        } else {
+            audioPath = std::string(outDir) + "/audio.opus-frames";
+            if (!decoder.writeRawFrames(audioPath.c_str())) fprintf(stderr, "stream_decode: cannot write %s\n", audioPath.c_str());
+        }
+    }
+
+    // Report
+    printf("=== Stream Decode ===\n");
+    printf("Log: %u packets over %.3f s (%u other, %u malformed lines)\n", records, (lastUs - firstUs) / 1e6, other,
+           (unsigned)reader.malformedLines());
+    if (a.packets > 0) {
+        double audioSeconds = decoder.samples().size() / (double)decoder.sampleRate();
+        printf("audio  %u packets, %u frames (%u split), %llu payload bytes, codec %s\n", a.packets, a.frames,
+               a.chunked_frames, (unsigned long long)a.payload_bytes, AudioDecoder::codecName(codec));
+        printf("       missing %u, duplicates %u, out of order %u (late %u), incomplete %u, restarts %u, malformed %u\n",
+               a.missing_frames, a.duplicates, a.out_of_order, a.late_frames, a.incomplete_frames, a.restarts,
+               a.malformed);
+        if (AudioDecoder::canDecode(codec)) {
+            printf("       %.2f s at %u Hz (%.2f s concealed), %u decode errors\n", audioSeconds,
+                   decoder.sampleRate(), decoder.concealedSamples() / (double)decoder.sampleRate(),
+                   decoder.decodeErrors());
+            if (elapsedMs > 0) printf("       decoded at %.0fx real time\n", audioSeconds * 1000.0 / elapsedMs);
+        } else {
+            printf("       built without libopus: frames kept undecoded\n");
+        }
+        if (!audioPath.empty()) printf("       -> %s\n", audioPath.c_str());
+    }
+    printImageStats("photo", photos.stats());
+    printImageStats("video", video.stats());
+    printImageStats("blocks", blocks.stats());
+    printImageStats("code", codes.stats());
+    printf("Time: %.1f ms\n", elapsedMs);
+    return 0;
+}
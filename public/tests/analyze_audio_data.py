@@ -2,24 +2,31 @@
 """
 Audio Data Analysis Tool
 Analyzes the raw audio data to understand what's actually being captured.
+Packets are reassembled and decoded by stream_decode (public/host).
 """
 
 import asyncio
 import sys
 import time
 import struct
+import wave
 import numpy as np
 from bleak import BleakClient, BleakScanner
+from packet_log import PacketLogWriter, decode
 
 # BLE Configuration
 DEVICE_NAME = "OpenGlass"
 AUDIO_CHARACTERISTIC_UUID = "19B10001-E8F2-537E-4F6C-D104768A1214"
+CODEC = "mulaw"  # As built into the firmware (CODEC_* in hal/constants.h)
 
 class AudioDataAnalyzer:
     def __init__(self):
         self.device = None
-        self.raw_frames = []
         self.frame_count = 0
+        stamp = int(time.time())
+        self.log_path = f"audio_analysis_{stamp}.log"
+        self.decode_dir = f"audio_analysis_{stamp}"
+        self.log = PacketLogWriter(self.log_path)
         
     async def find_device(self):
         """Find the OpenGlass device"""
@@ -38,30 +45,13 @@ class AudioDataAnalyzer:
     def audio_callback(self, sender, data):
         """Collect raw audio data for analysis"""
         self.frame_count += 1
-        self.raw_frames.append(data)
+        self.log.write(AUDIO_CHARACTERISTIC_UUID, data)
         
-        # Show first few frames in detail
+        # Show first few packets
         if self.frame_count <= 5:
-            print(f"\n📊 Frame {self.frame_count}:")
+            print(f"\n📊 Packet {self.frame_count}:")
             print(f"   Size: {len(data)} bytes")
-            print(f"   Raw hex: {data.hex()}")
-            
-            if len(data) >= 3:
-                header = data[:3]
-                payload = data[3:]
-                print(f"   Header: {header.hex()}")
-                print(f"   Payload: {payload[:16].hex()}... ({len(payload)} bytes)")
-                
-                # Analyze payload as 16-bit samples
-                if len(payload) >= 8:
-                    samples = struct.unpack('<4h', payload[:8])  # Little-endian 16-bit
-                    print(f"   First 4 samples: {samples}")
-                    
-                    # Check if all samples are the same (static)
-                    if len(set(samples)) == 1:
-                        print(f"   ⚠️  All samples identical: {samples[0]}")
-                    else:
-                        print(f"   ✅ Sample variation detected")
+            print(f"   Raw hex: {data[:32].hex()}...")
     
     async def analyze_audio_stream(self, duration=10):
         """Analyze the audio stream"""
@@ -93,25 +83,26 @@ class AudioDataAnalyzer:
         print("DETAILED AUDIO DATA ANALYSIS")
         print(f"{'='*60}")
         
-        if not self.raw_frames:
+        self.log.close()
+        if self.frame_count == 0:
             print("❌ No data collected!")
             return
         
-        print(f"📊 Total frames analyzed: {len(self.raw_frames)}")
+        print(f"📊 Total packets analyzed: {self.frame_count}")
         
-        # Extract all audio payloads
-        all_payloads = []
-        for frame in self.raw_frames:
-            if len(frame) > 3:
-                all_payloads.append(frame[3:])
+        # Reassemble and decode (gaps, duplicates and reordering are reported)
+        report = decode(self.log_path, self.decode_dir, CODEC)
+        if report is None:
+            return
+        print(report)
         
-        if not all_payloads:
+        try:
+            with wave.open(f"{self.decode_dir}/audio.wav", 'rb') as wav_file:
+                combined_audio = wav_file.readframes(wav_file.getnframes())
+        except FileNotFoundError:
             print("❌ No audio payloads found!")
             return
-        
-        # Combine all payloads
-        combined_audio = b''.join(all_payloads)
-        print(f"📏 Total audio data: {len(combined_audio)} bytes")
+        print(f"📏 Total decoded audio: {len(combined_audio)} bytes")
         
         # Convert to 16-bit samples
         if len(combined_audio) % 2 == 0:
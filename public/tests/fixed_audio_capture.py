@@ -2,6 +2,7 @@
 """
 Fixed Audio Capture Script
 Addresses DC offset and sample format issues to produce clear audio.
+Frames are reassembled and decoded by stream_decode (public/host).
 """
 
 import asyncio
@@ -11,22 +12,27 @@ import wave
 import struct
 import numpy as np
 from bleak import BleakClient, BleakScanner
+from packet_log import PacketLogWriter, decode
 
 # BLE Configuration
 DEVICE_NAME = "OpenGlass"
 AUDIO_CHARACTERISTIC_UUID = "19B10001-E8F2-537E-4F6C-D104768A1214"
 
-# Audio Configuration
-SAMPLE_RATE = 16000
+# Audio Configuration (sample rate comes from the decoded stream)
 SAMPLE_WIDTH = 2
 CHANNELS = 1
+CODEC = "mulaw"  # As built into the firmware (CODEC_* in hal/constants.h)
 
 class FixedAudioCapture:
     def __init__(self, duration=10):
         self.device = None
-        self.audio_data = []
         self.duration = duration
-        self.output_file = f"fixed_audio_{int(time.time())}.wav"
+        stamp = int(time.time())
+        self.output_file = f"fixed_audio_{stamp}.wav"
+        self.log_path = f"fixed_audio_{stamp}.log"
+        self.decode_dir = f"fixed_audio_{stamp}"
+        self.log = PacketLogWriter(self.log_path)
+        self.sample_rate = 8000
         
     async def find_device(self):
         """Find the OpenGlass device"""
@@ -43,19 +49,25 @@ class FixedAudioCapture:
         return False
     
     def audio_callback(self, sender, data):
-        """Handle incoming audio data"""
-        if len(data) > 3:
-            # Skip 3-byte header and store audio payload
-            self.audio_data.append(data[3:])
+        """Record incoming audio packets"""
+        self.log.write(AUDIO_CHARACTERISTIC_UUID, data)
     
     def process_audio_data(self):
-        """Process and fix the audio data"""
-        if not self.audio_data:
-            print("❌ No audio data to process!")
+        """Decode the captured packets and fix the audio data"""
+        self.log.close()
+        report = decode(self.log_path, self.decode_dir, CODEC)
+        if report is None:
             return None
+        print(report)
         
-        # Combine all audio data
-        combined_audio = b''.join(self.audio_data)
+        decoded_path = f"{self.decode_dir}/audio.wav"
+        try:
+            with wave.open(decoded_path, 'rb') as wav_file:
+                self.sample_rate = wav_file.getframerate()
+                combined_audio = wav_file.readframes(wav_file.getnframes())
+        except FileNotFoundError:
+            print("❌ No audio data to process!")
+            return None
         
         # Convert to 16-bit samples
         samples = struct.unpack(f'<{len(combined_audio)//2}h', combined_audio)
@@ -103,17 +115,17 @@ class FixedAudioCapture:
             with wave.open(self.output_file, 'wb') as wav_file:
                 wav_file.setnchannels(CHANNELS)
                 wav_file.setsampwidth(SAMPLE_WIDTH)
-                wav_file.setframerate(SAMPLE_RATE)
+                wav_file.setframerate(self.sample_rate)
                 wav_file.writeframes(audio_data)
             
             # Calculate actual duration
-            duration_seconds = len(audio_data) / (SAMPLE_RATE * SAMPLE_WIDTH * CHANNELS)
+            duration_seconds = len(audio_data) / (self.sample_rate * SAMPLE_WIDTH * CHANNELS)
             file_size_kb = len(audio_data) / 1024
             
             print(f"\n🎵 Fixed audio saved: {self.output_file}")
             print(f"📊 File size: {file_size_kb:.1f} KB")
             print(f"⏱️  Duration: {duration_seconds:.1f} seconds")
-            print(f"🎧 Format: {SAMPLE_RATE} Hz, {SAMPLE_WIDTH*8}-bit, Mono")
+            print(f"🎧 Format: {self.sample_rate} Hz, {SAMPLE_WIDTH*8}-bit, Mono")
             
             return True
             
@@ -0,0 +1,71 @@
+#!/usr/bin/env python3
+"""
+Packet Log Helper
+Records BLE notifications in the packet log format of the host tools
+(public/host/README.md) and decodes them with stream_decode, so capture
+scripts do not parse the frame headers themselves.
+"""
+
+import os
+import shutil
+import subprocess
+import time
+
+# Stream names used in packet logs, by characteristic UUID
+STREAM_NAMES = {
+    "19B10001-E8F2-537E-4F6C-D104768A1214": "audio",
+    "19B10005-E8F2-537E-4F6C-D104768A1214": "photo",
+    "19B10007-E8F2-537E-4F6C-D104768A1214": "device_status",
+    "19B10008-E8F2-537E-4F6C-D104768A1214": "video",
+    "19B1000A-E8F2-537E-4F6C-D104768A1214": "video_status",
+    "19B1000C-E8F2-537E-4F6C-D104768A1214": "hotspot_status",
+}
+
+HOST_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "host")
+
+
+class PacketLogWriter:
+    """Appends one line per notification: time_us characteristic length hex"""
+
+    def __init__(self, path):
+        self.path = path
+        self.file = open(path, "w")
+        self.start = time.monotonic()
+        self.file.write("# time_us characteristic length data\n")
+
+    def write(self, uuid, data):
+        name = STREAM_NAMES.get(str(uuid).upper(), str(uuid))
+        time_us = int((time.monotonic() - self.start) * 1e6)
+        self.file.write(f"{time_us} {name} {len(data)} {bytes(data).hex()}\n")
+
+    def close(self):
+        self.file.close()
+
+
+def find_stream_decode():
+    """stream_decode from $STREAM_DECODE, PATH or a build in public/host"""
+    candidates = [os.environ.get("STREAM_DECODE"), shutil.which("stream_decode")]
+    for build in ("build", "_gate_build"):
+        candidates.append(os.path.join(HOST_DIR, build, "stream_decode"))
+    for path in candidates:
+        if path and os.path.isfile(path) and os.access(path, os.X_OK):
+            return path
+    return None
+
+
+def decode(log_path, out_dir, codec="mulaw"):
+    """
+    Reassemble a packet log into out_dir (audio.wav, photo_NNNN.jpg, ...)
+    Returns the stream_decode report, or None if the tool is not built.
+    """
+    tool = find_stream_decode()
+    if not tool:
+        print("❌ stream_decode not found - build it with:")
+        print(f"   cmake -S {HOST_DIR} -B {HOST_DIR}/build && cmake --build {HOST_DIR}/build")
+        return None
+    result = subprocess.run([tool, "--log", log_path, "--out", out_dir, "--codec", codec, "--quiet"],
+                            capture_output=True, text=True)
+    if result.returncode != 0:
+        print(f"❌ stream_decode failed: {result.stderr.strip()}")
+        return None
+    return result.stdout
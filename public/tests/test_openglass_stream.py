@@ -3,6 +3,7 @@ import asyncio
 import sys
 import time
 from bleak import BleakClient, BleakScanner
+from packet_log import PacketLogWriter, decode
 
 # OpenGlass UUIDs
 SERVICE_UUID = "19B10000-E8F2-537E-4F6C-D104768A1214"
@@ -14,10 +15,11 @@ VIDEO_STATUS_UUID = "19B1000A-E8F2-537E-4F6C-D104768A1214"
 class OpenGlassStreamClient:
     def __init__(self):
         self.client = None
-        self.video_data = bytearray()
-        self.video_frames = 0
-        self.receiving_video = False
         self.total_frames_received = 0
+        stamp = int(time.time())
+        self.log_path = f"video_stream_{stamp}.log"
+        self.decode_dir = f"video_stream_{stamp}"
+        self.log = PacketLogWriter(self.log_path)
         self.streaming_active = False
         self.start_time = None
         
@@ -82,54 +84,24 @@ class OpenGlassStreamClient:
             return False
     
     def video_data_handler(self, sender, data):
-        """Handle incoming video data"""
-        if len(data) < 3:
-            print(f"Invalid video data packet: {len(data)} bytes")
-            return
-            
-        # Check for end marker
-        if data[0] == 0xFF and data[1] == 0xFF:
-            frame_type = data[2]
-            if frame_type == 0x02:  # Streaming frame
-                print(f"Video frame complete! Received {len(self.video_data)} bytes in {self.video_frames} frames")
-                
-                # Save video frame to file
-                if len(self.video_data) > 0:
-                    filename = f"video_frame_{self.total_frames_received:04d}.jpg"
-                    with open(filename, "wb") as f:
-                        f.write(self.video_data)
-                    print(f"Video frame saved to {filename}")
-                
-                # Reset for next frame
-                self.video_data = bytearray()
-                self.video_frames = 0
-                self.total_frames_received += 1
-                self.receiving_video = False
-                
-                # Calculate FPS if streaming
-                if self.start_time and self.total_frames_received > 0:
-                    elapsed = time.time() - self.start_time
-                    fps = self.total_frames_received / elapsed
-                    print(f"Average FPS: {fps:.2f} ({self.total_frames_received} frames in {elapsed:.1f}s)")
-            return
-            
-        # Extract frame number, frame type, and data
-        frame_number = data[0] | (data[1] << 8)
-        frame_type = data[2]
-        frame_data = data[3:]
-        
-        frame_type_str = "streaming" if frame_type == 0x02 else "photo"
-        print(f"Received {frame_type_str} frame {frame_number}: {len(frame_data)} bytes")
+        """Record video packets; frames are reassembled by stream_decode afterwards"""
+        self.log.write(VIDEO_DATA_UUID, data)
         
-        if not self.receiving_video:
-            print("Starting video frame reception...")
-            self.receiving_video = True
-            self.video_data = bytearray()
-            self.video_frames = 0
-            
-        # Append frame data
-        self.video_data.extend(frame_data)
-        self.video_frames += 1
+        # End marker [0xFF, 0xFF, 0x02] closes a frame
+        if len(data) == 3 and data[0] == 0xFF and data[1] == 0xFF:
+            self.total_frames_received += 1
+            if self.start_time:
+                elapsed = time.time() - self.start_time
+                fps = self.total_frames_received / elapsed
+                print(f"Frame {self.total_frames_received} complete | Average FPS: {fps:.2f}")
+    
+    def save_frames(self):
+        """Reassemble the recorded frames into video_NNNN.jpg files"""
+        self.log.close()
+        report = decode(self.log_path, self.decode_dir)
+        if report:
+            print(report)
+            print(f"Frames saved to {self.decode_dir}/")
     
     def video_status_handler(self, sender, data):
         """Handle video status updates"""
@@ -252,6 +224,7 @@ async def main():
         print(f"Error: {e}")
     finally:
         await client.disconnect()
+        client.save_frames()
 
 if __name__ == "__main__":
     print("OpenGlass Video Streaming Test")